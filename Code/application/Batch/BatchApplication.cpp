@@ -16,8 +16,12 @@
 #include "ArgumentList.h"
 #include "BatchApplication.h"
 #include "ConfigurationSettingsImp.h"
+#include "Filename.h"
 #include "InstallerServicesImp.h"
+#include "ObjectResource.h"
+#include "PlugInArgList.h"
 #include "PlugInManagerServicesImp.h"
+#include "PlugInResource.h"
 #include "ProgressBriefConsole.h"
 #include "ProgressConsole.h"
 #include "SessionManagerImp.h"
@@ -25,6 +29,7 @@
 #include <QtCore/QDirIterator>
 #include <QtCore/QFile>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 
 #include <vector>
 using namespace std;
@@ -104,6 +109,88 @@ int BatchApplication::test(int argc, char** argv)
    return -1;
 }
 
+int BatchApplication::benchmark(int argc, char** argv)
+{
+   // Initialize the application
+   int iReturn = Application::run(argc, argv);
+   if (iReturn == -1)
+   {
+      return -1;
+   }
+
+   // Set the application to run in batch mode
+   ApplicationServicesImp* pApp = ApplicationServicesImp::instance();
+   if (pApp != NULL)
+   {
+      pApp->setBatch();
+   }
+
+   ArgumentList* pArgumentList = ArgumentList::instance();
+   if (pArgumentList == NULL)
+   {
+      return -1;
+   }
+
+   mpProgress = new ProgressBriefConsole(false);
+
+   bool bSuccess = false;
+   {
+      ExecutableResource benchmarkSuite("Benchmark Suite", string(), mpProgress, true);
+      if (benchmarkSuite->getPlugIn() == NULL)
+      {
+         reportError("The Benchmark Suite plug-in is not available.");
+      }
+      else
+      {
+         string outputFilename = pArgumentList->getOption("benchmark");
+         if (outputFilename.empty() == true)
+         {
+            outputFilename = "benchmark.json";
+         }
+
+         FactoryResource<Filename> pOutputFilename;
+         pOutputFilename->setFullPathAndName(outputFilename);
+         benchmarkSuite->getInArgList().setPlugInArgValue("Output Filename", pOutputFilename.get());
+
+         // The size is given as rows x columns x bands, e.g. 1024x1024x64
+         unsigned int dimensions[3];
+         const char* pDimensionNames[] = { "Rows", "Columns", "Bands" };
+         QStringList size = QString::fromStdString(pArgumentList->getOption("benchmarkSize")).split("x",
+            QString::SkipEmptyParts);
+         for (int i = 0; i < size.count() && i < 3; ++i)
+         {
+            bool ok = false;
+            dimensions[i] = size[i].toUInt(&ok);
+            if (ok == true && dimensions[i] > 0)
+            {
+               benchmarkSuite->getInArgList().setPlugInArgValue(pDimensionNames[i], &dimensions[i]);
+            }
+         }
+
+         bool ok = false;
+         unsigned int iterations = QString::fromStdString(pArgumentList->getOption("benchmarkIterations")).toUInt(&ok);
+         if (ok == true && iterations > 0)
+         {
+            benchmarkSuite->getInArgList().setPlugInArgValue("Iterations", &iterations);
+         }
+
+         string cases = pArgumentList->getOption("benchmarkCases");
+         benchmarkSuite->getInArgList().setPlugInArgValue("Cases", &cases);
+
+         string sampleFiles = pArgumentList->getOption("benchmarkFiles");
+         benchmarkSuite->getInArgList().setPlugInArgValue("Sample Files", &sampleFiles);
+
+         bSuccess = benchmarkSuite->execute();
+      }
+   }
+
+   // Close the session to cleanup created objects
+   SessionManagerImp::instance()->close();
+   delete dynamic_cast<ProgressBriefConsole*>(mpProgress);
+
+   return (bSuccess == true ? 0 : -1);
+}
+
 int BatchApplication::run(int argc, char** argv)
 {
    // Generate the XML files
@@ -25,6 +25,7 @@ public:
    bool isKindOf(const std::string& className) const;
 
    int run(int argc, char** argv);
+   int benchmark(int argc, char** argv);
    int test(int argc, char** argv);
    int version(int argc, char** argv);
 
@@ -19,6 +19,7 @@
 #include "InstallerServicesImp.h"
 #include "StringUtilities.h"
 #include "SystemServicesImp.h"
+#include "TracerImp.h"
 
 #include <string>
 #include <iostream>
@@ -50,6 +51,12 @@ int main(int argc, char** argv)
    pArgumentList->registerOption("generate");
    pArgumentList->registerOption("processors");
    pArgumentList->registerOption("version");
+   pArgumentList->registerOption("benchmark");
+   pArgumentList->registerOption("benchmarkCases");
+   pArgumentList->registerOption("benchmarkFiles");
+   pArgumentList->registerOption("benchmarkIterations");
+   pArgumentList->registerOption("benchmarkSize");
+   pArgumentList->registerOption("trace");
    pArgumentList->registerOption("showHiddenExtensions");
    pArgumentList->registerOption("help");
    pArgumentList->registerOption("h");
@@ -172,17 +179,36 @@ int main(int argc, char** argv)
       //cout << "     " << dlm << "testAll     Runs the full set of system tests" << endl;
       cout << "     " << dlm << "showHiddenExtensions  Show hidden extensions when listing installed extensions" << endl;
       cout << "     " << dlm << "version               Displays a message listing the version of each Plug-In" << endl;
+      cout << "     " << dlm << "benchmark             Runs the benchmark suite and writes the results to the given JSON file" <<
+         endl;
+      cout << "     " << dlm << "benchmarkCases        Comma separated list of the benchmark cases to run" << endl;
+      cout << "     " << dlm << "benchmarkFiles        Semicolon separated list of the files used by the import " <<
+         "benchmark cases" << endl;
+      cout << "     " << dlm << "benchmarkIterations   Number of timed runs of each benchmark case" << endl;
+      cout << "     " << dlm << "benchmarkSize         Size of the generated benchmark cubes, e.g. 512x512x16" << endl;
+      cout << "     " << dlm << "trace                 Records a trace of the run and writes it to the given Chrome " <<
+         "trace JSON file" << endl;
       cout << "     " << dlm << "help                  Displays this help message" << endl;
       SystemServicesImp::instance()->WriteLogInfo(string(APP_NAME) + " Batch shutdown");
       return 0;
    }
 
+   bool trace = pArgumentList->exists("trace");
+   if (trace)
+   {
+      TracerImp::instance()->setEnabled(true);
+   }
+
    // Run the application
    int iSuccess = -1;
    if (pArgumentList->exists("version") == true)
    {
       iSuccess = batchApp.version(argc, argv);
    }
+   else if (pArgumentList->exists("benchmark") == true)
+   {
+      iSuccess = batchApp.benchmark(argc, argv);
+   }
    else if (pArgumentList->exists("test") == true)
    {
       iSuccess = batchApp.test(argc, argv);
@@ -192,6 +218,29 @@ int main(int argc, char** argv)
       iSuccess = batchApp.run(argc, argv);
    }
 
+   if (trace)
+   {
+      TracerImp* pTracer = TracerImp::instance();
+      pTracer->setEnabled(false);
+
+      string traceFilename = pArgumentList->getOption("trace");
+      if (traceFilename.empty())
+      {
+         traceFilename = "trace.json";
+      }
+
+      if (pTracer->writeChromeTrace(traceFilename))
+      {
+         cout << "Trace written to " << traceFilename << endl;
+      }
+      else
+      {
+         batchApp.reportError("Unable to write the trace file " + traceFilename);
+      }
+
+      cout << endl << pTracer->getSummary() << endl;
+   }
+
    // Display developer's release information again if necessary
    if (bProductionRelease == false)
    {
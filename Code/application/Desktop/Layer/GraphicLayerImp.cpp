@@ -856,8 +856,16 @@ int GraphicLayerImp::selectObjects(const LocationType& corner1, const LocationTy
    double maxy = max(corner1.mY, corner2.mY);
    deselectAllObjects();
 
-   list<GraphicObject*> objects = getObjects();
-   for (list<GraphicObject*>::iterator it = objects.begin(); it != objects.end(); ++it)
+   GraphicGroupImp* pGroup = dynamic_cast<GraphicGroupImp*>(getGroup());
+   if (pGroup == NULL)
+   {
+      return 0;
+   }
+
+   // Only objects which intersect the selection box can be contained in it
+   vector<GraphicObject*> objects;
+   pGroup->getObjectsInRegion(LocationType(minx, miny), LocationType(maxx, maxy), objects);
+   for (vector<GraphicObject*>::iterator it = objects.begin(); it != objects.end(); ++it)
    {
       GraphicObjectImp* pObject = dynamic_cast<GraphicObjectImp*>(*it);
       if (pObject != NULL)
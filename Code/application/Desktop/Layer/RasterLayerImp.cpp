@@ -7,6 +7,7 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include <QtCore/QTimer>
 #include <QtGui/QAction>
 #include <QtGui/QApplication>
 #include <QtGui/QInputDialog>
@@ -78,6 +79,8 @@ RasterLayerImp::RasterLayerImp(const string& id, const string& layerName, DataEl
    mOriginalGreenStretchValues(2),
    mOriginalBlueStretchValues(2),
    mpAnimation(NULL),
+   mAnimationFrame(0),
+   mTileRefreshPending(false),
    mpSeparatorAction(NULL),
    mpDisplayModeMenu(NULL),
    mpGrayscaleAction(NULL),
@@ -436,6 +439,19 @@ void RasterLayerImp::draw()
       {
          applyFastContrastStretch();
       }
+
+      // Generate the next animation frame once control returns to the event loop
+      if (mPrefetchBand.isValid() == true)
+      {
+         QTimer::singleShot(0, this, SLOT(prefetchTiles()));
+      }
+
+      // Display the tiles which are generated in the background as they become available
+      if ((mTileRefreshPending == false) && (mpImage->hasPendingTiles() == true))
+      {
+         mTileRefreshPending = true;
+         QTimer::singleShot(50, this, SLOT(refreshGeneratedTiles()));
+      }
    }
 
    // Draw the pixel values
@@ -1770,10 +1786,15 @@ QString RasterLayerImp::getStretchUnitsAsString(const RasterChannelType& eColor)
 
 double RasterLayerImp::convertStretchValue(const RasterChannelType& eColor, const RegionUnits& eUnits,
                                            double dStretchValue, const RegionUnits& eNewUnits) const
+{
+   return convertStretchValue(getStatistics(eColor), eUnits, dStretchValue, eNewUnits);
+}
+
+double RasterLayerImp::convertStretchValue(Statistics* pStatistics, const RegionUnits& eUnits, double dStretchValue,
+                                           const RegionUnits& eNewUnits) const
 {
    double dNewValue = 0.0;
 
-   Statistics* pStatistics = getStatistics(eColor);
    if (pStatistics == NULL)
    {
       return dNewValue;
@@ -3214,6 +3235,17 @@ void RasterLayerImp::generateImage()
 
       bool applyFastContrastStretch = canApplyFastContrastStretch();
 
+      // calculate the statistics of the displayed bands together so the data is only read once
+      if (applyFastContrastStretch && pRedElement != NULL && pRedElement == pGreenElement &&
+         pRedElement == pBlueElement)
+      {
+         vector<DimensionDescriptor> bands;
+         bands.push_back(mRedBand);
+         bands.push_back(mGreenBand);
+         bands.push_back(mBlueBand);
+         pRedElement->calculateStatistics(bands, eComponent);
+      }
+
       Statistics* pStatistics = getStatistics(RED);
       if (pStatistics != NULL)
       {
@@ -4179,11 +4211,93 @@ void RasterLayerImp::updateFromMovie()
          static_cast<const RasterDataDescriptor*>(getDataElement()->getDataDescriptor());
       if (pDescriptor != NULL)
       {
+         // Prefetch the band in the direction the animation is moving
+         mPrefetchBand = DimensionDescriptor();
+         if ((frameNumber > mAnimationFrame) && (frameNumber + 1 < pDescriptor->getBandCount()))
+         {
+            mPrefetchBand = pDescriptor->getActiveBand(frameNumber + 1);
+         }
+         else if ((frameNumber < mAnimationFrame) && (frameNumber > 0))
+         {
+            mPrefetchBand = pDescriptor->getActiveBand(frameNumber - 1);
+         }
+
+         mAnimationFrame = frameNumber;
          setDisplayedBand(GRAY, pDescriptor->getActiveBand(frameNumber));
       }
    }
 }
 
+void RasterLayerImp::prefetchTiles()
+{
+   DimensionDescriptor band = mPrefetchBand;
+   mPrefetchBand = DimensionDescriptor();
+
+   // GPU images are stretched by the display program, so the fast contrast stretch does not affect their tiles
+   bool usingGpu = false;
+#if defined(CG_SUPPORTED)
+   usingGpu = (dynamic_cast<GpuImage*>(mpImage) != NULL);
+#endif
+
+   if ((mpImage == NULL) || (band.isValid() == false) || (mbRegenerate == true) ||
+      (getDisplayMode() != GRAYSCALE_MODE) || ((canApplyFastContrastStretch() == true) && (usingGpu == false)))
+   {
+      return;
+   }
+
+   RasterElement* pRasterElement = getDisplayedRasterElement(GRAY);
+   if (pRasterElement == NULL)
+   {
+      return;
+   }
+
+   // Compute the stretch values for the band the same way generateImage() will when it is displayed
+   Statistics* pStatistics = pRasterElement->getStatistics(band);
+   if (pStatistics == NULL)
+   {
+      return;
+   }
+
+   double dLower = 0.0;
+   double dUpper = 0.0;
+   getStretchValues(GRAY, dLower, dUpper);
+
+   RegionUnits eUnits = getStretchUnits(GRAY);
+   vector<double> stretchValues;
+   stretchValues.push_back(convertStretchValue(pStatistics, eUnits, dLower, RAW_VALUE));
+   stretchValues.push_back(convertStretchValue(pStatistics, eUnits, dUpper, RAW_VALUE));
+
+   ViewImp* pViewImp = dynamic_cast<ViewImp*>(getView());
+   if (pViewImp != NULL)
+   {
+      GlContextSave contextSave(pViewImp);
+      mpImage->prefetchBand(band, stretchValues, pStatistics->getBadValues());
+   }
+}
+
+void RasterLayerImp::refreshGeneratedTiles()
+{
+   mTileRefreshPending = false;
+   if ((mpImage == NULL) || (mpImage->hasPendingTiles() == false))
+   {
+      return;
+   }
+
+   if (mpImage->hasGeneratedTiles() == false)
+   {
+      mTileRefreshPending = true;
+      QTimer::singleShot(50, this, SLOT(refreshGeneratedTiles()));
+      return;
+   }
+
+   // Drawing the layer displays the generated tiles and checks for more
+   View* pView = getView();
+   if (pView != NULL)
+   {
+      pView->refresh();
+   }
+}
+
 void RasterLayerImp::movieDeleted(Subject& subject, const string& signal, const boost::any& v)
 {
    Animation* pAnimation = dynamic_cast<Animation*> (&subject);
@@ -199,6 +199,8 @@ protected:
    virtual void applyFastContrastStretch();
    void applyFastContrastStretch(RasterChannelType element);
    virtual Statistics* getStatistics(RasterChannelType eColor) const;
+   double convertStretchValue(Statistics* pStatistics, const RegionUnits& eUnits, double dStretchValue,
+      const RegionUnits& eNewUnits) const;
    double percentileToRaw(double value, const double* pdPercentiles) const;
    double rawToPercentile(double value, const double* pdPercentiles) const;
 
@@ -212,6 +214,8 @@ protected slots:
    void updateDisplayModeAction(const DisplayMode& displayMode);
    void changeStretch(QAction* pAction);
    void displayAs(QAction* pAction);
+   void prefetchTiles();
+   void refreshGeneratedTiles();
 
 private:
    RasterLayerImp(const RasterLayerImp& rhs);
@@ -272,6 +276,9 @@ private:
 
    std::vector<ImageFilterDescriptor*> mEnabledFilters;
    Animation* mpAnimation;
+   unsigned int mAnimationFrame;
+   DimensionDescriptor mPrefetchBand;
+   bool mTileRefreshPending;
 
    // Context menu items
    QAction* mpSeparatorAction;
@@ -0,0 +1,278 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "BitMask.h"
+#include "DataAccessorImpl.h"
+#include "ModelServices.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "switchOnEncoding.h"
+#include "ThresholdIndex.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+   template<typename T, typename Value>
+   void readValues(T* pData, DataAccessor& da, unsigned int numRows, unsigned int numColumns,
+      const vector<int>& badValues, const QAtomicInt& abort, vector<pair<Value, unsigned int> >& values,
+      bool& success)
+   {
+      success = false;
+      for (unsigned int uiRow = 0; uiRow < numRows; ++uiRow)
+      {
+         if (abort != 0)
+         {
+            return;
+         }
+
+         VERIFYNRV(da.isValid());
+         for (unsigned int uiColumn = 0; uiColumn < numColumns; ++uiColumn)
+         {
+            double value = ModelServices::getDataValue(*(reinterpret_cast<T*>(da->getColumn())), COMPLEX_MAGNITUDE);
+
+            // NaN and bad values never pass a threshold
+            if (value == value &&
+               find(badValues.begin(), badValues.end(), static_cast<int>(value + 0.5)) == badValues.end())
+            {
+               values.push_back(make_pair(static_cast<Value>(value), uiRow * numColumns + uiColumn));
+            }
+
+            da->nextColumn();
+         }
+
+         da->nextRow();
+      }
+
+      success = true;
+   }
+
+   template<typename Value>
+   bool sortValues(DataAccessor& da, EncodingType dataType, unsigned int numRows, unsigned int numColumns,
+      const vector<int>& badValues, const QAtomicInt& abort, vector<Value>& sortedValues,
+      vector<unsigned int>& pixels)
+   {
+      vector<pair<Value, unsigned int> > values;
+      values.reserve(static_cast<typename vector<pair<Value, unsigned int> >::size_type>(numRows) * numColumns);
+
+      void* pData = NULL;
+      bool success = false;
+      switchOnEncoding(dataType, readValues, pData, da, numRows, numColumns, badValues, abort, values, success);
+      if (success == false)
+      {
+         return false;
+      }
+
+      sort(values.begin(), values.end());
+
+      sortedValues.reserve(values.size());
+      pixels.reserve(values.size());
+      for (typename vector<pair<Value, unsigned int> >::const_iterator iter = values.begin();
+         iter != values.end(); ++iter)
+      {
+         sortedValues.push_back(iter->first);
+         pixels.push_back(iter->second);
+      }
+
+      return true;
+   }
+
+   template<typename Value>
+   void getBounds(const vector<Value>& values, double threshold, unsigned int& lower, unsigned int& upper)
+   {
+      lower = static_cast<unsigned int>(lower_bound(values.begin(), values.end(), threshold) - values.begin());
+      upper = static_cast<unsigned int>(upper_bound(values.begin(), values.end(), threshold) - values.begin());
+   }
+
+   bool isInRanges(const ThresholdIndex::Ranges& ranges, unsigned int position)
+   {
+      for (ThresholdIndex::Ranges::const_iterator iter = ranges.begin(); iter != ranges.end(); ++iter)
+      {
+         if (position >= iter->first && position < iter->second)
+         {
+            return true;
+         }
+      }
+
+      return false;
+   }
+}
+
+ThresholdIndex::ThresholdIndex(RasterElement* pElement, const vector<int>& badValues) :
+   mAccessor(NULL, NULL),
+   mRows(0),
+   mColumns(0),
+   mBadValues(badValues),
+   mAbort(0),
+   mComplete(false)
+{
+   if (pElement != NULL)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      if (pDescriptor != NULL)
+      {
+         mAccessor = pElement->getDataAccessor();
+         mDataType = pDescriptor->getDataType();
+         mRows = pDescriptor->getRowCount();
+         mColumns = pDescriptor->getColumnCount();
+      }
+   }
+}
+
+ThresholdIndex::~ThresholdIndex()
+{
+   mAbort.fetchAndStoreOrdered(1);
+   wait();
+}
+
+const vector<int>& ThresholdIndex::getBadValues() const
+{
+   return mBadValues;
+}
+
+bool ThresholdIndex::isReady() const
+{
+   return isFinished() && mComplete;
+}
+
+void ThresholdIndex::getRanges(PassArea passArea, double firstThreshold, double secondThreshold,
+                               Ranges& ranges) const
+{
+   ranges.clear();
+
+   // A NaN threshold fails every comparison so none of the pixels it bounds pass
+   bool firstValid = (firstThreshold == firstThreshold);
+   bool secondValid = (secondThreshold == secondThreshold);
+
+   unsigned int numPixels = static_cast<unsigned int>(mPixels.size());
+   unsigned int firstLower = 0;
+   unsigned int firstUpper = 0;
+   unsigned int secondLower = 0;
+   unsigned int secondUpper = 0;
+   if (mSingleValues.empty() == false)
+   {
+      getBounds(mSingleValues, firstThreshold, firstLower, firstUpper);
+      getBounds(mSingleValues, secondThreshold, secondLower, secondUpper);
+   }
+   else
+   {
+      getBounds(mDoubleValues, firstThreshold, firstLower, firstUpper);
+      getBounds(mDoubleValues, secondThreshold, secondLower, secondUpper);
+   }
+
+   switch (passArea)
+   {
+   case LOWER:
+      if (firstValid)
+      {
+         ranges.push_back(make_pair(0U, firstUpper));
+      }
+      break;
+   case UPPER:
+      if (firstValid)
+      {
+         ranges.push_back(make_pair(firstLower, numPixels));
+      }
+      break;
+   case MIDDLE:
+      if (firstValid && secondValid)
+      {
+         ranges.push_back(make_pair(firstLower, secondUpper));
+      }
+      break;
+   case OUTSIDE:
+      if (firstValid)
+      {
+         ranges.push_back(make_pair(0U, firstUpper));
+      }
+
+      if (secondValid)
+      {
+         ranges.push_back(make_pair(secondLower, numPixels));
+      }
+      break;
+   default:
+      break;
+   }
+
+   for (Ranges::iterator iter = ranges.begin(); iter != ranges.end();)
+   {
+      if (iter->first >= iter->second)
+      {
+         iter = ranges.erase(iter);
+      }
+      else
+      {
+         ++iter;
+      }
+   }
+}
+
+void ThresholdIndex::updateMask(BitMask* pMask, const Ranges& oldRanges, const Ranges& newRanges) const
+{
+   VERIFYNRV(pMask != NULL);
+   VERIFYNRV(isReady());
+
+   // Split the sorted pixels at every range boundary and only visit the segments whose state changes
+   vector<unsigned int> boundaries;
+   for (Ranges::const_iterator iter = oldRanges.begin(); iter != oldRanges.end(); ++iter)
+   {
+      boundaries.push_back(iter->first);
+      boundaries.push_back(iter->second);
+   }
+
+   for (Ranges::const_iterator iter = newRanges.begin(); iter != newRanges.end(); ++iter)
+   {
+      boundaries.push_back(iter->first);
+      boundaries.push_back(iter->second);
+   }
+
+   sort(boundaries.begin(), boundaries.end());
+   boundaries.erase(unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+   for (vector<unsigned int>::size_type i = 1; i < boundaries.size(); ++i)
+   {
+      bool oldState = isInRanges(oldRanges, boundaries[i - 1]);
+      bool newState = isInRanges(newRanges, boundaries[i - 1]);
+      if (oldState == newState)
+      {
+         continue;
+      }
+
+      for (unsigned int position = boundaries[i - 1]; position < boundaries[i]; ++position)
+      {
+         unsigned int pixel = mPixels[position];
+         pMask->setPixel(pixel % mColumns, pixel / mColumns, newState);
+      }
+   }
+}
+
+void ThresholdIndex::run()
+{
+   if (mAccessor.isValid() == false || mRows == 0 || mColumns == 0)
+   {
+      return;
+   }
+
+   // Values of these encodings are exactly representable in single precision, which halves the size of the index
+   bool singlePrecision = (mDataType == INT1UBYTE || mDataType == INT1SBYTE || mDataType == INT2UBYTES ||
+      mDataType == INT2SBYTES || mDataType == FLT4BYTES);
+   if (singlePrecision)
+   {
+      mComplete = sortValues(mAccessor, mDataType, mRows, mColumns, mBadValues, mAbort, mSingleValues, mPixels);
+   }
+   else
+   {
+      mComplete = sortValues(mAccessor, mDataType, mRows, mColumns, mBadValues, mAbort, mDoubleValues, mPixels);
+   }
+}
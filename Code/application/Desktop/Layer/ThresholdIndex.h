@@ -0,0 +1,125 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef THRESHOLDINDEX_H
+#define THRESHOLDINDEX_H
+
+#include "DataAccessor.h"
+#include "TypesFile.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QThread>
+
+#include <utility>
+#include <vector>
+
+class BitMask;
+class RasterElement;
+
+/**
+ * The pixels of a raster element band sorted by value.
+ *
+ * The index is built on a background thread when start() is called. Once it is
+ * ready, the pixels which pass a threshold are a few contiguous ranges of the
+ * sorted pixels, so a threshold mask can be updated by toggling only the pixels
+ * whose values lie between the old and the new thresholds instead of rescanning
+ * the whole band. Pixels which are NaN or a bad value never pass a threshold and
+ * are not indexed. Values of encodings which fit exactly in a float are stored in
+ * single precision, so the index of those bands uses eight bytes per pixel.
+ */
+class ThresholdIndex : public QThread
+{
+public:
+   /**
+    * Ranges of positions in the sorted pixels as [first, last) pairs.
+    */
+   typedef std::vector<std::pair<unsigned int, unsigned int> > Ranges;
+
+   /**
+    * Creates an index of the pixels read through the default data accessor.
+    *
+    * The accessor is created on the calling thread. The values are not read
+    * until start() is called.
+    *
+    * @param pElement
+    *        The raster element to index.
+    * @param badValues
+    *        The bad values of the element which are excluded from the index.
+    */
+   ThresholdIndex(RasterElement* pElement, const std::vector<int>& badValues);
+
+   /**
+    * Stops building the index and waits for the thread to finish.
+    */
+   ~ThresholdIndex();
+
+   /**
+    * Returns the bad values which were excluded from the index.
+    */
+   const std::vector<int>& getBadValues() const;
+
+   /**
+    * Queries whether the index has been completely built.
+    *
+    * @return \c True if the thread has finished and the index contains every
+    *         valid pixel, \c false otherwise.
+    */
+   bool isReady() const;
+
+   /**
+    * Gets the positions of the sorted pixels which pass a threshold.
+    *
+    * The comparisons match ThresholdLayer, so values equal to a threshold pass.
+    *
+    * @param passArea
+    *        The pass area of the threshold.
+    * @param firstThreshold
+    *        The first threshold as a raw value.
+    * @param secondThreshold
+    *        The second threshold as a raw value, used by MIDDLE and OUTSIDE.
+    * @param ranges
+    *        Populated with the non-empty ranges of passing pixels.
+    */
+   void getRanges(PassArea passArea, double firstThreshold, double secondThreshold, Ranges& ranges) const;
+
+   /**
+    * Changes a mask from one set of passing pixels to another.
+    *
+    * Only the pixels in exactly one of the two sets of ranges are modified.
+    *
+    * @param pMask
+    *        The mask, which must contain exactly the pixels in \c oldRanges.
+    * @param oldRanges
+    *        The ranges currently set in the mask.
+    * @param newRanges
+    *        The ranges to set in the mask.
+    */
+   void updateMask(BitMask* pMask, const Ranges& oldRanges, const Ranges& newRanges) const;
+
+protected:
+   void run();
+
+private:
+   ThresholdIndex(const ThresholdIndex& rhs);
+   ThresholdIndex& operator=(const ThresholdIndex& rhs);
+
+   DataAccessor mAccessor;
+   EncodingType mDataType;
+   unsigned int mRows;
+   unsigned int mColumns;
+   std::vector<int> mBadValues;
+
+   QAtomicInt mAbort;
+   bool mComplete;
+   std::vector<float> mSingleValues;
+   std::vector<double> mDoubleValues;
+   std::vector<unsigned int> mPixels;
+};
+
+#endif
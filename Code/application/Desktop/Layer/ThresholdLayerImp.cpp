@@ -22,6 +22,7 @@
 #include "Statistics.h"
 #include "switchOnEncoding.h"
 #include "SymbolRegionDrawer.h"
+#include "ThresholdIndex.h"
 #include "ThresholdLayer.h"
 #include "ThresholdLayerImp.h"
 #include "ThresholdLayerUndo.h"
@@ -106,7 +107,12 @@ private:
 };
 
 ThresholdLayerImp::ThresholdLayerImp(const string& id, const string& layerName, DataElement* pElement) :
-   LayerImp(id, layerName, pElement)
+   LayerImp(id, layerName, pElement),
+   mpIndex(NULL),
+   mbMaskValid(false),
+   meMaskPassArea(LOWER),
+   mdMaskFirstThreshold(0.0),
+   mdMaskSecondThreshold(0.0)
 {
    mbModified = true;
 
@@ -147,7 +153,9 @@ ThresholdLayerImp::ThresholdLayerImp(const string& id, const string& layerName,
 }
 
 ThresholdLayerImp::~ThresholdLayerImp()
-{}
+{
+   resetIndex();
+}
 
 const string& ThresholdLayerImp::getObjectType() const
 {
@@ -193,6 +201,7 @@ ThresholdLayerImp& ThresholdLayerImp::operator=(const ThresholdLayerImp& thresho
       mdSecondThreshold = thresholdLayer.mdSecondThreshold;
       mColor = thresholdLayer.mColor;
       mSymbol = thresholdLayer.mSymbol;
+      mbModified = true;
    }
 
    return *this;
@@ -786,30 +795,59 @@ const BitMask* ThresholdLayerImp::getSelectedPixels() const
             unsigned int uiNumColumns = pDescriptor->getColumnCount();
             unsigned int uiNumRows = pDescriptor->getRowCount();
 
-            DataAccessor da = pRasterElement->getDataAccessor();
-            if (da.isValid() == false)
+            vector<int> badValues;
+
+            Statistics* pStatistics = pRasterElement->getStatistics();
+            if (pStatistics != NULL)
             {
-               return NULL;
+               badValues = pStatistics->getBadValues();
             }
 
-            void* pData = NULL;
+            // Once the sorted index is available, only the pixels between the previous and the
+            // current thresholds are toggled instead of scanning the entire raster
+            ThresholdIndex* pIndex = getIndex(pRasterElement, badValues);
+            if (pIndex != NULL && pIndex->isReady())
+            {
+               ThresholdIndex::Ranges oldRanges;
+               if (mbMaskValid)
+               {
+                  pIndex->getRanges(meMaskPassArea, mdMaskFirstThreshold, mdMaskSecondThreshold, oldRanges);
+               }
+               else
+               {
+                  mpMask->clear();
+               }
+
+               ThresholdIndex::Ranges newRanges;
+               pIndex->getRanges(mePassArea, mdFirstThreshold, mdSecondThreshold, newRanges);
+               pIndex->updateMask(mpMask.get(), oldRanges, newRanges);
+            }
+            else
+            {
+               DataAccessor da = pRasterElement->getDataAccessor();
+               if (da.isValid() == false)
+               {
+                  return NULL;
+               }
 
-            EncodingType eType = pDescriptor->getDataType();
+               void* pData = NULL;
 
-            double dFirstThreshold = mdFirstThreshold;
-            double dSecondThreshold = mdSecondThreshold;
+               EncodingType eType = pDescriptor->getDataType();
 
-            vector<int> badValues;
+               double dFirstThreshold = mdFirstThreshold;
+               double dSecondThreshold = mdSecondThreshold;
 
-            Statistics* pStatistics = pRasterElement->getStatistics();
-            if (pStatistics != NULL)
-            {
-               badValues = pStatistics->getBadValues();
+               mpMask->clear();
+
+               DrawUtil::BitMaskPixelDrawer drawer(mpMask.get());
+               switchOnEncoding(eType, fillRegion, pData, da, drawer, dFirstThreshold, dSecondThreshold, uiNumRows,
+                  uiNumColumns, mePassArea, badValues);
             }
 
-            DrawUtil::BitMaskPixelDrawer drawer(mpMask.get());
-            switchOnEncoding(eType, fillRegion, pData, da, drawer, dFirstThreshold, dSecondThreshold, uiNumRows,
-               uiNumColumns, mePassArea, badValues);
+            mbMaskValid = true;
+            meMaskPassArea = mePassArea;
+            mdMaskFirstThreshold = mdFirstThreshold;
+            mdMaskSecondThreshold = mdSecondThreshold;
          }
       }
 
@@ -819,6 +857,49 @@ const BitMask* ThresholdLayerImp::getSelectedPixels() const
    return mpMask.get();
 }
 
+void ThresholdLayerImp::onElementModified()
+{
+   // The data values may have changed so the mask and the index must be rebuilt
+   resetIndex();
+   mbMaskValid = false;
+   mbModified = true;
+}
+
+ThresholdIndex* ThresholdLayerImp::getIndex(RasterElement* pRasterElement, const vector<int>& badValues) const
+{
+   if (mpIndex != NULL && mpIndex->getBadValues() != badValues)
+   {
+      // The mask was created with the previous bad values so it cannot be updated incrementally
+      resetIndex();
+      mbMaskValid = false;
+   }
+
+   if (mpIndex == NULL && pRasterElement != NULL)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pRasterElement->getDataDescriptor());
+      VERIFYRV(pDescriptor != NULL, NULL);
+
+      uint64_t numPixels = static_cast<uint64_t>(pDescriptor->getRowCount()) * pDescriptor->getColumnCount();
+      unsigned int pixelLimit = ThresholdLayer::getSettingIndexedPixelLimit();
+      if (numPixels == 0 || numPixels > pixelLimit)
+      {
+         return NULL;
+      }
+
+      mpIndex = new ThresholdIndex(pRasterElement, badValues);
+      mpIndex->start(QThread::LowPriority);
+   }
+
+   return mpIndex;
+}
+
+void ThresholdLayerImp::resetIndex() const
+{
+   delete mpIndex;
+   mpIndex = NULL;
+}
+
 bool ThresholdLayerImp::toXml(XMLWriter* pXml) const
 {
    if (!LayerImp::toXml(pXml))
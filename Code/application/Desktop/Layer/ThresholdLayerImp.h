@@ -17,7 +17,9 @@
 #include <QtGui/QColor>
 
 class BitMask;
+class RasterElement;
 class Statistics;
+class ThresholdIndex;
 
 class ThresholdLayerImp: public LayerImp
 {
@@ -88,8 +90,13 @@ protected:
    double percentileToRaw(double value, const double* pdPercentiles) const;
    double rawToPercentile(double value, const double* pdPercentiles) const;
 
+   void onElementModified();
+
 private:
    ThresholdLayerImp(const ThresholdLayerImp& rhs);
+   ThresholdIndex* getIndex(RasterElement* pRasterElement, const std::vector<int>& badValues) const;
+   void resetIndex() const;
+
    RegionUnits meRegionUnits;
    PassArea mePassArea;
    double mdFirstThreshold;
@@ -100,6 +107,14 @@ private:
    mutable bool mbModified;
    mutable FactoryResource<BitMask> mpMask;
 
+   // The index is only used for rasters within ThresholdLayer::getSettingIndexedPixelLimit(). The mask
+   // pass area and thresholds describe the pixels set in mpMask so the index can update it incrementally.
+   mutable ThresholdIndex* mpIndex;
+   mutable bool mbMaskValid;
+   mutable PassArea meMaskPassArea;
+   mutable double mdMaskFirstThreshold;
+   mutable double mdMaskSecondThreshold;
+
    static unsigned int msThresholdLayers;
 };
 
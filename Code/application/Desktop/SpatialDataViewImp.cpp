@@ -31,6 +31,7 @@
 #include "glCommon.h"
 #include "GraphicGroupImp.h"
 #include "HistogramWindow.h"
+#include "Image.h"
 #include "LatLonLayer.h"
 #include "LayerListAdapter.h"
 #include "LayerUndo.h"
@@ -1400,6 +1401,9 @@ QImage SpatialDataViewImp::getLayerImage(Layer* pLayer, ColorType& transparent,
       return QImage();
    }
 
+   // The image is read as soon as the layer is drawn, so raster layers cannot display tiles as they are generated
+   Image::SynchronousDraw synchronousDraw;
+
    QColor clrBackground = getBackgroundColor();
    if (!transparent.isValid())
    {
@@ -22,6 +22,7 @@
 #include "FontImp.h"
 #include "GeocoordLinkFunctor.h"
 #include "glCommon.h"
+#include "Image.h"
 #include "ImageResolutionWidget.h"
 #include "MouseModeImp.h"
 #include "PropertiesView.h"
@@ -734,6 +735,9 @@ QImage ViewImp::getCurrentImage()
 
 bool ViewImp::getCurrentImage(QImage &image)
 {
+   // The image is read as soon as it is drawn, so raster layers cannot display tiles as they are generated
+   Image::SynchronousDraw synchronousDraw;
+
    if (QGLFramebufferObject::hasOpenGLFramebufferObjects())
    {
       int curWidth = width();
@@ -33,6 +33,7 @@
 #include "PlugInManagerServicesImp.h"
 #include "PlugInRegistration.h"
 #include "SessionManagerImp.h"
+#include "TracerImp.h"
 #include "UtilityServicesImp.h"
 #include "WizardUtilities.h"
 
@@ -77,6 +78,7 @@ Application::~Application()
    UtilityServicesImp::destroy();
    SessionManagerImp::destroy();
    MessageLogMgrImp::destroy();
+   TracerImp::destroy();
 }
 
 int Application::run(int argc, char** argv)
@@ -135,6 +135,7 @@
 #include "TiePointLayer.h"
 #include "TiePointToolbar.h"
 #include "ToolBarAdapter.h"
+#include "Tracer.h"
 #include "Undo.h"
 #include "UndoButton.h"
 #include "UndoStack.h"
@@ -158,6 +159,7 @@
 #include <boost/bind.hpp>
 
 #include <algorithm>
+#include <fstream>
 #include <functional>
 #include <string>
 #include <vector>
@@ -672,6 +674,20 @@ ApplicationWindow::ApplicationWindow(QWidget* pSplash) :
    pUpdate_Wizards_Action->setStatusTip("Checks for new wizards in the wizard directory");
    VERIFYNR(connect(pUpdate_Wizards_Action, SIGNAL(triggered()), this, SLOT(updateWizardCommands())));
 
+   // Tracing
+   QAction* pRecord_Trace_Action = new QAction("Record &Trace", this);
+   pRecord_Trace_Action->setAutoRepeat(false);
+   pRecord_Trace_Action->setCheckable(true);
+   pRecord_Trace_Action->setToolTip("Record Trace");
+   pRecord_Trace_Action->setStatusTip("Records the time spent executing plug-ins, paging data and running threads");
+   VERIFYNR(connect(pRecord_Trace_Action, SIGNAL(toggled(bool)), this, SLOT(enableTracing(bool))));
+
+   QAction* pSave_Trace_Action = new QAction("Save Trace...", this);
+   pSave_Trace_Action->setAutoRepeat(false);
+   pSave_Trace_Action->setToolTip("Save Trace");
+   pSave_Trace_Action->setStatusTip("Saves the recorded trace as a Chrome trace file or a summary text file");
+   VERIFYNR(connect(pSave_Trace_Action, SIGNAL(triggered()), this, SLOT(saveTrace())));
+
    // Options
    QAction* pOptions_Action = new QAction("&Options...", this);
    pOptions_Action->setAutoRepeat(false);
@@ -1159,6 +1175,9 @@ ApplicationWindow::ApplicationWindow(QWidget* pSplash) :
    m_pTools->addSeparator();
    mpMenuBar->insertCommand(pUpdate_Wizards_Action, m_pTools, toolsContext);
    m_pTools->addSeparator();
+   mpMenuBar->insertCommand(pRecord_Trace_Action, m_pTools, toolsContext);
+   mpMenuBar->insertCommand(pSave_Trace_Action, m_pTools, toolsContext);
+   m_pTools->addSeparator();
    mpMenuBar->insertCommand(pOptions_Action, m_pTools, toolsContext);
 
    // Help menu
@@ -3581,6 +3600,56 @@ void ApplicationWindow::invokeOptionsDlg()
    dlgOptions.exec();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+// Trace actions
+
+void ApplicationWindow::enableTracing(bool bEnable)
+{
+   Service<Tracer> pTracer;
+   if (bEnable)
+   {
+      pTracer->clear();
+   }
+
+   pTracer->setEnabled(bEnable);
+}
+
+void ApplicationWindow::saveTrace()
+{
+   QString selectedFilter;
+   QString filename = QFileDialog::getSaveFileName(this, "Save Trace", QString(),
+      "Chrome Trace Files (*.json);;Summary Files (*.txt)", &selectedFilter);
+   if (filename.isEmpty())
+   {
+      return;
+   }
+
+   QFileInfo fileInfo(filename);
+   if (fileInfo.suffix().isEmpty())
+   {
+      filename += (selectedFilter.contains("*.txt") ? ".txt" : ".json");
+      fileInfo.setFile(filename);
+   }
+
+   Service<Tracer> pTracer;
+   bool success = false;
+   if (fileInfo.suffix().toLower() == "txt")
+   {
+      ofstream summary(filename.toStdString().c_str());
+      summary << pTracer->getSummary();
+      success = summary.good();
+   }
+   else
+   {
+      success = pTracer->writeChromeTrace(filename.toStdString());
+   }
+
+   if (success == false)
+   {
+      QMessageBox::critical(this, QString::fromStdString(APP_NAME), "Unable to save the trace to " + filename + ".");
+   }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 // Window actions
 
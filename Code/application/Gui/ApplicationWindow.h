@@ -267,6 +267,10 @@ protected slots:
    // Options actions
    void invokeOptionsDlg();
 
+   // Trace actions
+   void enableTracing(bool bEnable);
+   void saveTrace();
+
    // Window actions
    void linkWindows();
    void linkAllSpatialDataWindows();
@@ -21,14 +21,166 @@
 #include "RasterDataDescriptor.h"
 #include "Statistics.h"
 #include "switchOnEncoding.h"
+#include "ThreadPool.h"
 #include "Tile.h"
 #include "UtilityServicesImp.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace mta;
 
+namespace
+{
+   // A copy of the image data with its own stretch tables, so that a tile can be
+   // generated in the background while the image replaces or deletes its tables
+   class ImageSnapshot
+   {
+   public:
+      explicit ImageSnapshot(const Image::ImageData& info) :
+         mInfo(info)
+      {
+         copyTables(info);
+      }
+
+      ImageSnapshot(const ImageSnapshot& rhs) :
+         mInfo(rhs.mInfo)
+      {
+         copyTables(rhs.mInfo);
+      }
+
+      Image::ImageData mInfo;
+
+   private:
+      ImageSnapshot& operator=(const ImageSnapshot& rhs);
+
+      void copyTables(const Image::ImageData& info)
+      {
+         // Image::prepareScale() sizes the tables for the color map or for 8-bit values
+         size_t tableSize = 256;
+         if ((info.mKey.mStretchPoints2.empty() == true) && (info.mKey.mColorMap.empty() == false))
+         {
+            tableSize = info.mKey.mColorMap.size();
+         }
+
+         if (info.mpExponentialMultipliers != NULL)
+         {
+            mExponentialMultipliers.assign(info.mpExponentialMultipliers, info.mpExponentialMultipliers + tableSize);
+            mInfo.mpExponentialMultipliers = &mExponentialMultipliers[0];
+         }
+
+         if (info.mpLogarithmicMultipliers != NULL)
+         {
+            mLogarithmicMultipliers.assign(info.mpLogarithmicMultipliers, info.mpLogarithmicMultipliers + tableSize);
+            mInfo.mpLogarithmicMultipliers = &mLogarithmicMultipliers[0];
+         }
+
+         for (int i = 0; i < 3; ++i)
+         {
+            if (info.mpEqualizationValues[i] != NULL)
+            {
+               mEqualizationValues[i].assign(info.mpEqualizationValues[i], info.mpEqualizationValues[i] + tableSize);
+               mInfo.mpEqualizationValues[i] = &mEqualizationValues[i][0];
+            }
+         }
+      }
+
+      vector<double> mExponentialMultipliers;
+      vector<double> mLogarithmicMultipliers;
+      vector<unsigned int> mEqualizationValues[3];
+   };
+}
+
+// Generates tiles on the thread pool. Requests are replaced each time the image is drawn, so tiles
+// which are no longer visible are never started, and the generated texture data is handed back to
+// the image to be loaded into textures on the main thread. A low priority queue uses a single worker
+// and only starts a tile while the more urgent queue has no tiles waiting to start.
+class Image::TileQueue
+{
+public:
+   struct Request
+   {
+      unsigned int mGeneration;
+      unsigned int mTileIndex;
+      unsigned int mZoomIndex;
+      bool mPreview;
+      double mDistance;
+      LocationType mPos;
+      LocationType mTexSize;
+      LocationType mGeomSize;
+      GLenum mFormat;
+   };
+
+   struct Result
+   {
+      unsigned int mTileIndex;
+      unsigned int mZoomIndex;
+      vector<unsigned char> mData;
+   };
+
+   explicit TileQueue(const TileQueue* pUrgentQueue = NULL);
+   ~TileQueue();
+
+   bool isCurrent(const ImageKey& key) const;
+   void setImageData(const ImageData& info);
+   void cancel();
+   void setRequests(vector<Request>& requests);
+   void resume();
+   void takeResults(vector<Result>& results);
+   bool isPending() const;
+   bool hasResults() const;
+   bool hasQueuedRequests() const;
+
+private:
+   TileQueue(const TileQueue& rhs);
+   TileQueue& operator=(const TileQueue& rhs);
+
+   class Runner : public mta::ThreadCommand
+   {
+   public:
+      explicit Runner(TileQueue& queue) : mQueue(queue) {}
+      void run()
+      {
+         mQueue.runRequests();
+      }
+
+   private:
+      Runner& operator=(const Runner& rhs);
+      TileQueue& mQueue;
+   };
+
+   static bool isLessUrgent(const Request& lhs, const Request& rhs);
+   bool isQueued(const Request& request) const;
+   void startRunners();
+   void runRequests();
+   static bool generateTile(const Request& request, ImageSnapshot& snapshot, vector<unsigned char>& data);
+
+   mutable DMutex mMutex;
+   const TileQueue* mpUrgentQueue;
+   ImageSnapshot* mpSnapshot;
+   unsigned int mGeneration;
+   vector<Request> mRequests;
+   vector<Request> mActiveRequests;
+   vector<Result> mResults;
+   unsigned int mRunnerCount;
+   unsigned int mMaxRunnerCount;
+   Runner mRunner;
+   TaskGroup mTasks;
+};
+
 vector<ColorType> Image::sDefaultColorMap;
 unsigned int Image::TileSet::sNextId = 0;
+unsigned int Image::sSynchronousDraws = 0;
+
+Image::SynchronousDraw::SynchronousDraw()
+{
+   ++Image::sSynchronousDraws;
+}
+
+Image::SynchronousDraw::~SynchronousDraw()
+{
+   --Image::sSynchronousDraws;
+}
 
 Image::Image() :
    mInfo(0, DimensionDescriptor(), DimensionDescriptor(), DimensionDescriptor(), LINEAR, std::vector<double>(),
@@ -37,7 +189,10 @@ Image::Image() :
    mNumTilesX(0),
    mNumTilesY(0),
    mpTiles(NULL),
-   mAlpha(255)
+   mpPinnedTiles(NULL),
+   mAlpha(255),
+   mpTileQueue(NULL),
+   mpPrefetchQueue(NULL)
 {}
 
 // Grayscale
@@ -79,6 +234,9 @@ void Image::initialize(int sizeX, int sizeY, DimensionDescriptor channel, unsign
       }
    }
 
+   // Tiles being generated in the background used the previous stretch, so they are discarded
+   cancelQueuedTiles();
+
    setActiveTileSet(mInfo.mKey);
    createTiles();
 }
@@ -121,6 +279,9 @@ void Image::initialize(int sizeX, int sizeY, DimensionDescriptor channel, unsign
       }
    }
 
+   // Tiles being generated in the background used the previous stretch, so they are discarded
+   cancelQueuedTiles();
+
    setActiveTileSet(mInfo.mKey);
    createTiles();
 }
@@ -163,6 +324,9 @@ void Image::initialize(int sizeX, int sizeY, DimensionDescriptor channel, unsign
          mInfo.mpEqualizationValues[i] = NULL;
       }
    }
+   // Tiles being generated in the background used the previous stretch, so they are discarded
+   cancelQueuedTiles();
+
    setActiveTileSet(mInfo.mKey);
    createTiles();
 }
@@ -204,6 +368,9 @@ void Image::initialize(int sizeX, int sizeY, DimensionDescriptor channel, unsign
          mInfo.mpEqualizationValues[i] = NULL;
       }
    }
+   // Tiles being generated in the background used the previous stretch, so they are discarded
+   cancelQueuedTiles();
+
    setActiveTileSet(mInfo.mKey);
    createTiles();
 }
@@ -248,6 +415,9 @@ void Image::initialize(int sizeX, int sizeY, DimensionDescriptor band1, Dimensio
          mInfo.mpEqualizationValues[i] = NULL;
       }
    }
+   // Tiles being generated in the background used the previous stretch, so they are discarded
+   cancelQueuedTiles();
+
    setActiveTileSet(mInfo.mKey);
    createTiles();
 }
@@ -291,6 +461,9 @@ void Image::initialize(int sizeX, int sizeY, DimensionDescriptor band1, Dimensio
          mInfo.mpEqualizationValues[i] = NULL;
       }
    }
+   // Tiles being generated in the background used the previous stretch, so they are discarded
+   cancelQueuedTiles();
+
    setActiveTileSet(mInfo.mKey);
    createTiles();
 }
@@ -337,12 +510,19 @@ void Image::initialize(int sizeX, int sizeY, DimensionDescriptor band1, Dimensio
          mInfo.mpEqualizationValues[i] = NULL;
       }
    }
+   // Tiles being generated in the background used the previous stretch, so they are discarded
+   cancelQueuedTiles();
+
    setActiveTileSet(mInfo.mKey);
    createTiles();
 }
 
 Image::~Image()
 {
+   // the prefetch queue yields to the tile queue, so it is deleted first
+   delete mpPrefetchQueue;
+   delete mpTileQueue;
+
    if (mInfo.mpExponentialMultipliers != NULL)
    {
       delete [] mInfo.mpExponentialMultipliers;
@@ -412,15 +592,47 @@ void Image::draw(GLfloat textureMode)
       return;
    }
 
+   bool backgroundTiles = (sSynchronousDraws == 0) && (canGenerateTilesInBackground() == true);
+   if (backgroundTiles == true)
+   {
+      prepareTileQueue();
+      setGeneratedTiles();
+   }
+
+   setPrefetchedTiles();
+
    vector<unsigned int> tileZoomIndices;
    vector<Tile*> tilesToDraw = getTilesToDraw();
    vector<Tile*> tilesToUpdate = getTilesToUpdate(tilesToDraw, tileZoomIndices);
 
-   if (tilesToUpdate.empty() == false)
+   // record the visible tiles so that they can be prefetched for another band
+   mDrawnTiles.clear();
+   mDrawnTiles.reserve(tilesToDraw.size());
+   for (vector<Tile*>::const_iterator iter = tilesToDraw.begin(); iter != tilesToDraw.end(); ++iter)
+   {
+      Tile* pTile = *iter;
+      if (pTile != NULL)
+      {
+         mDrawnTiles.push_back(std::make_pair(getTileIndex(pTile), pTile->getTextureIndex()));
+      }
+   }
+
+   if (backgroundTiles == true)
+   {
+      // Queue the tiles even if there are none so that the tiles for the previous view are not generated
+      queueTiles(*mpTileQueue, tilesToUpdate, tileZoomIndices, true);
+   }
+   else if (tilesToUpdate.empty() == false)
    {
       updateTiles(tilesToUpdate, tileZoomIndices);
    }
 
+   // Prefetched tiles are only generated once the visible tiles have all been started
+   if (mpPrefetchQueue != NULL)
+   {
+      mpPrefetchQueue->resume();
+   }
+
    // move the center of the whole image to the origin
    // this is necessary because the tiles are placed in the image
    // beginning at the origin moving into the (+,+) quadrant
@@ -568,6 +780,7 @@ private:
                pRasterDescriptor->getActiveColumn(posX+geomSizeX-1), geomSizeX);
             pRequest->setBands(mInfo.mKey.mBand1,
                mInfo.mKey.mBand1, 1);
+            pRequest->setTiled(true);
 
             DataAccessor da = pRasterElement->getDataAccessor(pRequest.release());
             if (!da.isValid())
@@ -698,6 +911,7 @@ private:
                pRasterDescriptor->getActiveColumn(posX + geomSizeX - 1), geomSizeX);
             pRequest->setBands(mInfo.mKey.mBand1,
                mInfo.mKey.mBand1, 1);
+            pRequest->setTiled(true);
 
             DataAccessor da = pRasterElement->getDataAccessor(pRequest.release());
             if (!da.isValid())
@@ -861,6 +1075,7 @@ private:
                pRedRequest->setColumns(pRedRasterDescriptor->getActiveColumn(posX), 
                   pRedRasterDescriptor->getActiveColumn(posX+geomSizeX-1), geomSizeX);
                pRedRequest->setBands(mInfo.mKey.mBand1, mInfo.mKey.mBand1, 1);
+               pRedRequest->setTiled(true);
 
                daRed = pRedRasterElement->getDataAccessor(pRedRequest.release());
                if (!daRed.isValid())
@@ -884,6 +1099,7 @@ private:
                pGreenRequest->setColumns(pGreenRasterDescriptor->getActiveColumn(posX), 
                   pGreenRasterDescriptor->getActiveColumn(posX+geomSizeX-1), geomSizeX);
                pGreenRequest->setBands(mInfo.mKey.mBand2, mInfo.mKey.mBand2, 1);
+               pGreenRequest->setTiled(true);
 
                daGreen = pGreenRasterElement->getDataAccessor(pGreenRequest.release());
                if (!daGreen.isValid())
@@ -907,6 +1123,7 @@ private:
                pBlueRequest->setColumns(pBlueRasterDescriptor->getActiveColumn(posX), 
                   pBlueRasterDescriptor->getActiveColumn(posX+geomSizeX-1), geomSizeX);
                pBlueRequest->setBands(mInfo.mKey.mBand3, mInfo.mKey.mBand3, 1);
+               pBlueRequest->setTiled(true);
 
                daBlue = pBlueRasterElement->getDataAccessor(pBlueRequest.release());
                if (!daBlue.isValid())
@@ -1131,6 +1348,419 @@ void Image::updateTiles(vector<Tile*>& tilesToUpdate, vector<unsigned int>& tile
    tilingAlgorithm.run();
 }
 
+bool Image::canGenerateTilesInBackground() const
+{
+   return true;
+}
+
+bool Image::hasPendingTiles() const
+{
+   return (mpTileQueue != NULL) && (mpTileQueue->isPending() == true);
+}
+
+bool Image::hasGeneratedTiles() const
+{
+   return (mpTileQueue != NULL) && (mpTileQueue->hasResults() == true);
+}
+
+void Image::cancelQueuedTiles()
+{
+   if (mpTileQueue != NULL)
+   {
+      mpTileQueue->cancel();
+   }
+
+   if (mpPrefetchQueue != NULL)
+   {
+      mpPrefetchQueue->cancel();
+   }
+}
+
+unsigned int Image::getTileIndex(const Tile* pTile) const
+{
+   LocationType pos = pTile->getPos();
+   return static_cast<unsigned int>(pos.mY / mInfo.mTileSizeY) * mNumTilesX +
+      static_cast<unsigned int>(pos.mX / mInfo.mTileSizeX);
+}
+
+bool Image::isTileSetInUse(const TileSet& tileSet) const
+{
+   const vector<Tile*>* pTiles = &(tileSet.getTiles());
+   return ((pTiles == mpTiles) || (pTiles == mpPinnedTiles));
+}
+
+void Image::prepareTileQueue()
+{
+   if (mpTileQueue == NULL)
+   {
+      mpTileQueue = new TileQueue();
+   }
+
+   if (mpTileQueue->isCurrent(mInfo.mKey) == true)
+   {
+      return;
+   }
+
+   prepareScaleTables();
+   mpTileQueue->setImageData(mInfo);
+}
+
+void Image::prepareScaleTables()
+{
+   // Create the stretch tables here since the tiles are generated from a copy of them
+   ScaleStruct scaleData;
+   if (mInfo.mKey.mStretchPoints2.empty() == false)
+   {
+      prepareScale(mInfo, mInfo.mKey.mStretchPoints1, scaleData, 0);
+      prepareScale(mInfo, mInfo.mKey.mStretchPoints2, scaleData, 1);
+      prepareScale(mInfo, mInfo.mKey.mStretchPoints3, scaleData, 2);
+   }
+   else if (mInfo.mKey.mColorMap.empty() == false)
+   {
+      prepareScale(mInfo, mInfo.mKey.mStretchPoints1, scaleData, 0,
+         static_cast<int>(mInfo.mKey.mColorMap.size()) - 1);
+   }
+   else
+   {
+      prepareScale(mInfo, mInfo.mKey.mStretchPoints1, scaleData, 0);
+   }
+}
+
+void Image::setGeneratedTiles()
+{
+   vector<TileQueue::Result> results;
+   mpTileQueue->takeResults(results);
+
+   for (vector<TileQueue::Result>::iterator iter = results.begin(); iter != results.end(); ++iter)
+   {
+      if ((iter->mTileIndex < mpTiles->size()) && (iter->mData.empty() == false))
+      {
+         Tile* pTile = mpTiles->at(iter->mTileIndex);
+         if (pTile != NULL)
+         {
+            pTile->setupTexture(iter->mZoomIndex, &iter->mData[0]);
+         }
+      }
+   }
+}
+
+void Image::setPrefetchedTiles()
+{
+   if (mpPrefetchQueue == NULL)
+   {
+      return;
+   }
+
+   vector<TileQueue::Result> results;
+   mpPrefetchQueue->takeResults(results);
+
+   // The prefetched tile set may have been replaced since its tiles were queued
+   map<ImageKey, TileSet>::iterator pTileSet = mTileSets.find(mPrefetchKey);
+   if (pTileSet != mTileSets.end())
+   {
+      vector<Tile*>& tiles = pTileSet->second.getTiles();
+      for (vector<TileQueue::Result>::iterator iter = results.begin(); iter != results.end(); ++iter)
+      {
+         if ((iter->mTileIndex < tiles.size()) && (iter->mData.empty() == false))
+         {
+            Tile* pTile = tiles.at(iter->mTileIndex);
+            if (pTile != NULL)
+            {
+               pTile->setupTexture(iter->mZoomIndex, &iter->mData[0]);
+            }
+         }
+      }
+   }
+
+   // Once the prefetched band is displayed its remaining tiles are generated as visible tiles
+   if (mPrefetchKey == mInfo.mKey)
+   {
+      mpPrefetchQueue->cancel();
+   }
+}
+
+void Image::queueTiles(TileQueue& queue, const vector<Tile*>& tilesToUpdate,
+                       const vector<unsigned int>& tileZoomIndices, bool preview)
+{
+   vector<TileQueue::Request> requests;
+   requests.reserve(tilesToUpdate.size());
+   for (vector<Tile*>::size_type i = 0; i < tilesToUpdate.size(); ++i)
+   {
+      Tile* pTile = tilesToUpdate[i];
+      if (pTile == NULL)
+      {
+         continue;
+      }
+
+      TileQueue::Request request;
+      request.mGeneration = 0;
+      request.mTileIndex = getTileIndex(pTile);
+      request.mZoomIndex = tileZoomIndices[i];
+      request.mPos = pTile->getPos();
+      request.mTexSize = pTile->getTexSize();
+      request.mGeomSize = pTile->getGeomSize();
+      request.mFormat = pTile->getTexFormat();
+
+      // A tile with nothing to display is first generated at the lowest resolution, which is quick to
+      // create, and its zoom level is only known once it has a texture, so it is refined when drawn again
+      unsigned int readyIndex = request.mZoomIndex;
+      request.mPreview = (preview == true) && (pTile->getReadyTextureIndex(readyIndex) == false);
+      if (request.mPreview == true)
+      {
+         request.mZoomIndex = Tile::MAX_TEXTURE_INDEX;
+      }
+
+      LocationType center = request.mPos + request.mGeomSize * 0.5;
+      request.mDistance = sqrt(pow(center.mX - mDrawCenter.mX, 2) + pow(center.mY - mDrawCenter.mY, 2));
+      requests.push_back(request);
+   }
+
+   queue.setRequests(requests);
+}
+
+//------------ Image::TileQueue ---------------//
+
+namespace
+{
+   // Holds the texture data of a tile instead of loading it into a texture,
+   // since textures can only be loaded on the main thread
+   class GeneratedTile : public Tile
+   {
+   public:
+      explicit GeneratedTile(vector<unsigned char>& data) :
+         mData(data)
+      {}
+
+      void setupTexture(unsigned int index, unsigned char* pTextureData)
+      {
+         const int factor = computeReductionFactor(index);
+         const LocationType texSize = getTexSize();
+         const size_t size = static_cast<size_t>(texSize.mX / factor) * static_cast<size_t>(texSize.mY / factor) *
+            getChannelCount(getTexFormat());
+         mData.assign(pTextureData, pTextureData + size);
+      }
+
+   private:
+      GeneratedTile& operator=(const GeneratedTile& rhs);
+      vector<unsigned char>& mData;
+   };
+}
+
+Image::TileQueue::TileQueue(const TileQueue* pUrgentQueue) :
+   mpUrgentQueue(pUrgentQueue),
+   mpSnapshot(NULL),
+   mGeneration(0),
+   mRunnerCount(0),
+   mMaxRunnerCount(1),
+   mRunner(*this)
+{
+   // Leave a worker for the algorithms which the user is waiting on
+   unsigned int workerCount = ThreadPool::instance().getWorkerCount();
+   if ((mpUrgentQueue == NULL) && (workerCount > 1))
+   {
+      mMaxRunnerCount = workerCount - 1;
+   }
+}
+
+Image::TileQueue::~TileQueue()
+{
+   cancel();
+   mTasks.wait();
+}
+
+bool Image::TileQueue::isCurrent(const ImageKey& key) const
+{
+   MutexLock lock(mMutex);
+   return (mpSnapshot != NULL) && (mpSnapshot->mInfo.mKey == key);
+}
+
+void Image::TileQueue::setImageData(const ImageData& info)
+{
+   cancel();
+
+   MutexLock lock(mMutex);
+   mpSnapshot = new ImageSnapshot(info);
+}
+
+void Image::TileQueue::cancel()
+{
+   // The tiles which are being generated finish, but their results are discarded
+   MutexLock lock(mMutex);
+   delete mpSnapshot;
+   mpSnapshot = NULL;
+   ++mGeneration;
+   mRequests.clear();
+   mResults.clear();
+}
+
+void Image::TileQueue::setRequests(vector<Request>& requests)
+{
+   MutexLock lock(mMutex);
+   mRequests.clear();
+   if (mpSnapshot == NULL)
+   {
+      return;
+   }
+
+   for (vector<Request>::iterator iter = requests.begin(); iter != requests.end(); ++iter)
+   {
+      iter->mGeneration = mGeneration;
+      if (isQueued(*iter) == false)
+      {
+         mRequests.push_back(*iter);
+      }
+   }
+
+   // The most urgent request is at the back of the queue
+   sort(mRequests.begin(), mRequests.end(), isLessUrgent);
+   startRunners();
+}
+
+void Image::TileQueue::resume()
+{
+   MutexLock lock(mMutex);
+   startRunners();
+}
+
+void Image::TileQueue::startRunners()
+{
+   if ((mpSnapshot == NULL) || ((mpUrgentQueue != NULL) && (mpUrgentQueue->hasQueuedRequests() == true)))
+   {
+      return;
+   }
+
+   while ((mRunnerCount < mMaxRunnerCount) && (mRunnerCount < mRequests.size()))
+   {
+      ++mRunnerCount;
+      mTasks.run(mRunner);
+   }
+}
+
+void Image::TileQueue::takeResults(vector<Result>& results)
+{
+   MutexLock lock(mMutex);
+   results.swap(mResults);
+}
+
+bool Image::TileQueue::isPending() const
+{
+   MutexLock lock(mMutex);
+   return (mRequests.empty() == false) || (mResults.empty() == false) || (mActiveRequests.empty() == false);
+}
+
+bool Image::TileQueue::hasResults() const
+{
+   MutexLock lock(mMutex);
+   return (mResults.empty() == false);
+}
+
+bool Image::TileQueue::hasQueuedRequests() const
+{
+   MutexLock lock(mMutex);
+   return (mRequests.empty() == false);
+}
+
+bool Image::TileQueue::isLessUrgent(const Request& lhs, const Request& rhs)
+{
+   // Tiles with nothing to display come first, then the tiles closest to the center of the view
+   if (lhs.mPreview != rhs.mPreview)
+   {
+      return rhs.mPreview;
+   }
+
+   return lhs.mDistance > rhs.mDistance;
+}
+
+bool Image::TileQueue::isQueued(const Request& request) const
+{
+   for (vector<Request>::const_iterator iter = mActiveRequests.begin(); iter != mActiveRequests.end(); ++iter)
+   {
+      if ((iter->mGeneration == request.mGeneration) && (iter->mTileIndex == request.mTileIndex) &&
+         (iter->mZoomIndex == request.mZoomIndex))
+      {
+         return true;
+      }
+   }
+
+   for (vector<Result>::const_iterator iter = mResults.begin(); iter != mResults.end(); ++iter)
+   {
+      if ((iter->mTileIndex == request.mTileIndex) && (iter->mZoomIndex == request.mZoomIndex))
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+void Image::TileQueue::runRequests()
+{
+   for (;;)
+   {
+      // A low priority queue stops when more urgent tiles are waiting and is resumed by the next draw
+      bool yield = (mpUrgentQueue != NULL) && (mpUrgentQueue->hasQueuedRequests() == true);
+
+      Request request;
+      ImageSnapshot* pSnapshot = NULL;
+      {
+         MutexLock lock(mMutex);
+         if ((yield == true) || (mRequests.empty() == true) || (mpSnapshot == NULL))
+         {
+            --mRunnerCount;
+            return;
+         }
+
+         request = mRequests.back();
+         mRequests.pop_back();
+         mActiveRequests.push_back(request);
+         pSnapshot = new ImageSnapshot(*mpSnapshot);
+      }
+
+      Result result;
+      result.mTileIndex = request.mTileIndex;
+      result.mZoomIndex = request.mZoomIndex;
+      bool success = generateTile(request, *pSnapshot, result.mData);
+      delete pSnapshot;
+
+      MutexLock lock(mMutex);
+      for (vector<Request>::iterator iter = mActiveRequests.begin(); iter != mActiveRequests.end(); ++iter)
+      {
+         if ((iter->mGeneration == request.mGeneration) && (iter->mTileIndex == request.mTileIndex) &&
+            (iter->mZoomIndex == request.mZoomIndex))
+         {
+            mActiveRequests.erase(iter);
+            break;
+         }
+      }
+
+      if ((success == true) && (request.mGeneration == mGeneration))
+      {
+         mResults.push_back(Result());
+         mResults.back().mTileIndex = result.mTileIndex;
+         mResults.back().mZoomIndex = result.mZoomIndex;
+         mResults.back().mData.swap(result.mData);
+      }
+   }
+}
+
+bool Image::TileQueue::generateTile(const Request& request, ImageSnapshot& snapshot, vector<unsigned char>& data)
+{
+   GeneratedTile tile(data);
+   tile.setTexFormat(request.mFormat);
+   tile.setTexSize(static_cast<int>(request.mTexSize.mX), static_cast<int>(request.mTexSize.mY));
+   tile.setGeomSize(static_cast<int>(request.mGeomSize.mX), static_cast<int>(request.mGeomSize.mY));
+   tile.setPos(static_cast<int>(request.mPos.mX), static_cast<int>(request.mPos.mY));
+
+   // The algorithm runs on this thread, which is the main thread of the algorithm,
+   // so the generated tile receives its texture data on this thread as well
+   vector<Tile*> tiles(1, &tile);
+   vector<unsigned int> tileZoomIndices(1, request.mZoomIndex);
+   TileInput tileInput(tiles, tileZoomIndices, snapshot.mInfo);
+   TileOutput tileOutput;
+   mta::MultiThreadedAlgorithm<TileInput, TileOutput, TileThread> tilingAlgorithm(1, tileInput, tileOutput, NULL);
+   return (tilingAlgorithm.run() == mta::SUCCESS) && (data.empty() == false);
+}
+
 bool Image::prepareScale(ImageData& info, vector<double>& stretchPoints, ScaleStruct& data, unsigned int color,
                          int maxValue)
 {
@@ -1288,19 +1918,43 @@ void Image::setActiveTileSet(const ImageKey &key)
    map<ImageKey, TileSet>::iterator it = mTileSets.find(key);
    if (it == mTileSets.end())
    {
-      // delete oldest tileset if necessary
+      // Texture memory is bounded by the global texture cache, so a tileset whose
+      // textures have all been evicted costs nothing to recreate. Delete those
+      // before deleting the oldest tileset, which may still hold textures.
+      if (mTileSets.size() > maxNumTileSets)
+      {
+         map<ImageKey, TileSet>::iterator pTileSet = mTileSets.begin();
+         while (pTileSet != mTileSets.end())
+         {
+            if ((isTileSetInUse(pTileSet->second) == false) && (pTileSet->second.hasTextures() == false))
+            {
+               mTileSets.erase(pTileSet++);
+            }
+            else
+            {
+               ++pTileSet;
+            }
+         }
+      }
+
+      // delete oldest tileset if necessary, but never the one being displayed
       if (mTileSets.size() > maxNumTileSets)
       {
-         map<ImageKey, TileSet>::iterator oldest = mTileSets.begin();
+         map<ImageKey, TileSet>::iterator oldest = mTileSets.end();
          map<ImageKey, TileSet>::iterator pTileSet = mTileSets.begin();
          for (pTileSet = mTileSets.begin(); pTileSet != mTileSets.end(); ++pTileSet)
          {
-            if ((*pTileSet).second.getId() < (*oldest).second.getId())
+            if ((isTileSetInUse(pTileSet->second) == false) &&
+               ((oldest == mTileSets.end()) || ((*pTileSet).second.getId() < (*oldest).second.getId())))
             {
                oldest = pTileSet;
             }
          }
-         mTileSets.erase(oldest);
+
+         if (oldest != mTileSets.end())
+         {
+            mTileSets.erase(oldest);
+         }
       }
       TileSet tileSet;
       mTileSets.insert(std::pair<const ImageKey, TileSet>(key, tileSet));
@@ -1435,6 +2089,83 @@ void Image::generateAllFullResTextures()
    updateTiles(tileToUpdate, zoomIndex);
 }
 
+bool Image::prefetchBand(DimensionDescriptor band, const vector<double>& stretchPoints, const vector<int>& badValues)
+{
+   // Only single band images are prefetched. Equalization values are computed for the displayed
+   // band and a different bad value state would require a different texture format.
+   if ((mpTiles == NULL) || (mDrawnTiles.empty() == true) || (band.isValid() == false) ||
+      (band == mInfo.mKey.mBand1) || (mInfo.mKey.mStretchPoints2.empty() == false) ||
+      (mInfo.mKey.mType == EQUALIZATION) || (badValues.empty() != mInfo.mKey.mBadValues1.empty()))
+   {
+      return false;
+   }
+
+   // The prefetched tile set may replace another one, so keep the displayed tiles
+   ImageKey displayedKey = mInfo.mKey;
+   mpPinnedTiles = mpTiles;
+   mInfo.mKey.mBand1 = band;
+   mInfo.mKey.mStretchPoints1 = stretchPoints;
+   mInfo.mKey.mBadValues1 = badValues;
+
+   setActiveTileSet(mInfo.mKey);
+   createTiles();
+
+   vector<Tile*> tilesToUpdate;
+   vector<unsigned int> tileZoomIndices;
+   vector<std::pair<unsigned int, unsigned int> >::const_iterator iter;
+   for (iter = mDrawnTiles.begin(); iter != mDrawnTiles.end(); ++iter)
+   {
+      if (iter->first < mpTiles->size())
+      {
+         Tile* pTile = mpTiles->at(iter->first);
+         if ((pTile != NULL) && (pTile->isTextureReady(iter->second) == false))
+         {
+            tilesToUpdate.push_back(pTile);
+            tileZoomIndices.push_back(iter->second);
+         }
+      }
+   }
+
+   if ((tilesToUpdate.empty() == false) && (sSynchronousDraws == 0) && (canGenerateTilesInBackground() == true))
+   {
+      // Generate the tiles in the background behind the visible tiles, they are loaded into
+      // their textures by the next draw, and a new prefetch replaces the queued tiles
+      if (mpTileQueue == NULL)
+      {
+         mpTileQueue = new TileQueue();
+      }
+
+      if (mpPrefetchQueue == NULL)
+      {
+         mpPrefetchQueue = new TileQueue(mpTileQueue);
+      }
+
+      if (mpPrefetchQueue->isCurrent(mInfo.mKey) == false)
+      {
+         prepareScaleTables();
+         mpPrefetchQueue->setImageData(mInfo);
+         mPrefetchKey = mInfo.mKey;
+      }
+
+      queueTiles(*mpPrefetchQueue, tilesToUpdate, tileZoomIndices, false);
+   }
+   else if (tilesToUpdate.empty() == false)
+   {
+      // no progress is reported since the user is not waiting on these tiles
+      TileInput tileInput(tilesToUpdate, tileZoomIndices, mInfo);
+      TileOutput tileOutput;
+      mta::MultiThreadedAlgorithm<TileInput, TileOutput, TileThread> tilingAlgorithm
+         (getNumRequiredThreads(tilesToUpdate.size()), tileInput, tileOutput, NULL);
+      tilingAlgorithm.run();
+   }
+
+   mInfo.mKey = displayedKey;
+   setActiveTileSet(mInfo.mKey);
+   mpPinnedTiles = NULL;
+
+   return (tilesToUpdate.empty() == false);
+}
+
 const Image::ImageData& Image::getImageData() const
 {
    return mInfo;
@@ -1450,6 +2181,35 @@ const vector<Tile*>* Image::getActiveTiles() const
    return mpTiles;
 }
 
+vector<Tile*> Image::getDrawnTiles(vector<unsigned int>& tileZoomIndices) const
+{
+   vector<Tile*> tiles;
+   tileZoomIndices.clear();
+   if (mpTiles == NULL)
+   {
+      return tiles;
+   }
+
+   tiles.reserve(mDrawnTiles.size());
+   tileZoomIndices.reserve(mDrawnTiles.size());
+
+   vector<std::pair<unsigned int, unsigned int> >::const_iterator iter;
+   for (iter = mDrawnTiles.begin(); iter != mDrawnTiles.end(); ++iter)
+   {
+      if (iter->first < mpTiles->size())
+      {
+         Tile* pTile = mpTiles->at(iter->first);
+         if (pTile != NULL)
+         {
+            tiles.push_back(pTile);
+            tileZoomIndices.push_back(iter->second);
+         }
+      }
+   }
+
+   return tiles;
+}
+
 const map<ImageKey, Image::TileSet>& Image::getTileSets() const
 {
    return mTileSets;
@@ -1495,6 +2255,21 @@ void Image::TileSet::clearTiles()
    mTiles.clear();
 }
 
+bool Image::TileSet::hasTextures() const
+{
+   vector<Tile*>::const_iterator iter;
+   for (iter = mTiles.begin(); iter != mTiles.end(); ++iter)
+   {
+      Tile* pTile = *iter;
+      if ((pTile != NULL) && (pTile->hasTextures() == true))
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
 vector<Tile*> Image::getTilesToDraw()
 {
    int numTiles = mpTiles->size();
@@ -560,6 +560,7 @@ public:
       ~TileSet();
 
       void clearTiles();
+      bool hasTextures() const;
 
       unsigned int getId() const
       {
@@ -590,6 +591,19 @@ public:
       }
    };
 
+   // While an instance exists, every image generates the tiles it draws before drawing them
+   // instead of in the background, e.g. while a view is rendered into an image which is saved
+   class SynchronousDraw
+   {
+   public:
+      SynchronousDraw();
+      ~SynchronousDraw();
+
+   private:
+      SynchronousDraw(const SynchronousDraw& rhs);
+      SynchronousDraw& operator=(const SynchronousDraw& rhs);
+   };
+
    Image();
 
    // Grayscale
@@ -689,6 +703,22 @@ public:
    bool generateFullResTexture();
    void generateAllFullResTextures();
 
+   // Tiles which are not ready when the image is drawn are generated in the background, nearest the
+   // center of the view first, and a texture of another zoom level is drawn in their place. These
+   // return whether any tiles are still being generated and whether any generated tiles are waiting
+   // for the next draw to display them.
+   bool hasPendingTiles() const;
+   bool hasGeneratedTiles() const;
+
+   // Speculatively generates the textures which would be drawn if the image displayed
+   // a different band, e.g. the next frame of an animation. Only the tiles which were
+   // drawn most recently are generated, at the same zoom level, and the generated
+   // textures are held in the global texture cache like any other tile. When tiles can
+   // be generated in the background they are queued behind the visible tiles and loaded
+   // into their textures by the next draw, otherwise they are generated before returning.
+   virtual bool prefetchBand(DimensionDescriptor band, const std::vector<double>& stretchPoints,
+      const std::vector<int>& badValues);
+
    const ImageData& getImageData() const;
 
 protected:
@@ -700,21 +730,41 @@ protected:
    virtual void setActiveTileSet(const ImageKey &key);
    virtual unsigned int getMaxNumTileSets() const;
    std::vector<Tile*> getTilesToDraw();
+   std::vector<Tile*> getDrawnTiles(std::vector<unsigned int>& tileZoomIndices) const;
    virtual std::vector<Tile*> getTilesToUpdate(const std::vector<Tile*>& tilesToDraw,
       std::vector<unsigned int>& tileZoomIndices);
+   virtual bool canGenerateTilesInBackground() const;
 
    ImageData mInfo;
 
 private:
+   class TileQueue;
+
    int mNumTilesX;
    int mNumTilesY;
    std::map<ImageKey, TileSet> mTileSets;
    std::vector<Tile*>* mpTiles;
+   const std::vector<Tile*>* mpPinnedTiles;   // displayed tiles which must survive a prefetch
    unsigned int mAlpha;
    LocationType mDrawCenter;
+   std::vector<std::pair<unsigned int, unsigned int> > mDrawnTiles;   // tile index and zoom index
+   TileQueue* mpTileQueue;
+   TileQueue* mpPrefetchQueue;   // generates tiles for prefetchBand() behind the visible tiles
+   ImageKey mPrefetchKey;
 
    void createTiles();
    static std::vector<ColorType> sDefaultColorMap;
+   static unsigned int sSynchronousDraws;
+
+   unsigned int getTileIndex(const Tile* pTile) const;
+   bool isTileSetInUse(const TileSet& tileSet) const;
+   void cancelQueuedTiles();
+   void prepareTileQueue();
+   void prepareScaleTables();
+   void setGeneratedTiles();
+   void setPrefetchedTiles();
+   void queueTiles(TileQueue& queue, const std::vector<Tile*>& tilesToUpdate,
+      const std::vector<unsigned int>& tileZoomIndices, bool preview);
 
    Tile* selectNearbyTile() const;
 };
@@ -11,103 +11,220 @@
 #include "Textures.h"
 #include "glCommon.h"
 
-#include <algorithm>
+const TextureCacheEntry* TextureCacheEntry::spNewest = NULL;
+const TextureCacheEntry* TextureCacheEntry::spOldest = NULL;
+uint64_t TextureCacheEntry::sTextureCacheSetting = 0;
+uint64_t TextureCacheEntry::sTextureCacheSize = 0;
+uint64_t TextureCacheEntry::sTotalSize = 0;
+uint64_t TextureCacheEntry::sLastUsedCounter = 0;
+TextureCacheStatistics TextureCacheEntry::sStatistics;
 
-std::vector<TextureImpl*> TextureImpl::sAllTextures;
-uint64_t TextureImpl::sTextureCacheSize = 0;
-uint64_t TextureImpl::sTotalSize = 0;
-uint64_t TextureImpl::sLastUsedCounter = 0;
-
-TextureImpl::TextureImpl() :
-   mHandle(0),
-   mSize(0),
+TextureCacheEntry::TextureCacheEntry() :
+   mCached(false),
+   mCacheSize(0),
    mLastUsed(0),
-   mReferenceCount(1)
+   mpNewer(NULL),
+   mpOlder(NULL)
 {}
 
-TextureImpl::~TextureImpl()
+TextureCacheEntry::~TextureCacheEntry()
 {
-   deleteTexture();
-   std::vector<TextureImpl*>::iterator it = std::find(sAllTextures.begin(), sAllTextures.end(), this);
-   if (it != sAllTextures.end())
-   {
-      sAllTextures.erase(it);
-   }
+   removeFromCache();
 }
 
-bool TextureImpl::isAllocated() const
+bool TextureCacheEntry::isCached() const
 {
-   updateLastUsed();
-   return mHandle != 0;
+   return mCached;
+}
+
+uint64_t TextureCacheEntry::lastUsed() const
+{
+   return mLastUsed;
+}
+
+unsigned int TextureCacheEntry::getCacheSize() const
+{
+   return mCacheSize;
 }
 
-void TextureImpl::updateLastUsed() const
+void TextureCacheEntry::markUsed() const
 {
    ++sLastUsedCounter; //the start value of sLastUsedCounter, 0, is reserved.
    mLastUsed = sLastUsedCounter;
+
+   if (spNewest != this)
+   {
+      unlink();
+      link();
+   }
 }
 
-uint64_t TextureImpl::getTextureCacheSize()
+void TextureCacheEntry::link() const
 {
-   if (sTextureCacheSize == 0)
+   mpOlder = spNewest;
+   mpNewer = NULL;
+   if (spNewest != NULL)
+   {
+      spNewest->mpNewer = this;
+   }
+   spNewest = this;
+   if (spOldest == NULL)
+   {
+      spOldest = this;
+   }
+}
+
+void TextureCacheEntry::unlink() const
+{
+   if (mpNewer != NULL)
+   {
+      mpNewer->mpOlder = mpOlder;
+   }
+   else if (spNewest == this)
+   {
+      spNewest = mpOlder;
+   }
+
+   if (mpOlder != NULL)
    {
-      sTextureCacheSize = static_cast<uint64_t>(ConfigurationSettings::getSettingGpuTextureCacheSize()) * 1024 * 1024;
+      mpOlder->mpNewer = mpNewer;
+   }
+   else if (spOldest == this)
+   {
+      spOldest = mpNewer;
+   }
+
+   mpNewer = NULL;
+   mpOlder = NULL;
+}
+
+uint64_t TextureCacheEntry::getTextureCacheSize()
+{
+   // Re-read the setting so that a change made in the options takes effect
+   // without restarting, but keep any reduction made after a failed allocation
+   // until the setting itself changes.
+   uint64_t settingSize =
+      static_cast<uint64_t>(ConfigurationSettings::getSettingGpuTextureCacheSize()) * 1024 * 1024;
+   if (settingSize != sTextureCacheSetting)
+   {
+      sTextureCacheSetting = settingSize;
+      sTextureCacheSize = settingSize;
    }
    return sTextureCacheSize;
 }
 
-void TextureImpl::downsizeTextureCache()
+void TextureCacheEntry::reserveCacheSpace(unsigned int size)
 {
+   sTotalSize += size;
+   evictOldEntries();
+   sTotalSize -= size;
+}
+
+bool TextureCacheEntry::reduceCacheBudget()
+{
+   const uint64_t minTextureCache = 100 * 1024 * 1024; //100 MB, no particular reason this was chosen as the min
+   if (getTextureCacheSize() <= minTextureCache)
+   {
+      return false;
+   }
+
    sTextureCacheSize /= 2;
+   evictOldEntries();
+   return true;
+}
+
+void TextureCacheEntry::recordHit()
+{
+   ++sStatistics.mHits;
+}
+
+void TextureCacheEntry::addToCache(unsigned int size)
+{
+   removeFromCache();
+
+   ++sStatistics.mMisses;
+   mCached = true;
+   mCacheSize = size;
+   sTotalSize += size;
+   markUsed();
+}
+
+void TextureCacheEntry::removeFromCache()
+{
+   if (mCached == true)
+   {
+      sTotalSize -= mCacheSize;
+      unlink();
+   }
+
+   mCached = false;
+   mCacheSize = 0;
+   mLastUsed = 0;
+}
+
+void TextureCacheEntry::evictOldEntries()
+{
+   uint64_t textureCacheSize = getTextureCacheSize();
+   while (sTotalSize > textureCacheSize && spOldest != NULL)
+   {
+      // The list only holds entries which are allocated and entries are only ever
+      // evicted from the GL thread, so casting away the const here is safe.
+      TextureCacheEntry* pOldest = const_cast<TextureCacheEntry*>(spOldest);
+      pOldest->evict();
+      pOldest->removeFromCache();
+      ++sStatistics.mEvictions;
+   }
+}
+
+TextureCacheStatistics TextureCacheEntry::getCacheStatistics()
+{
+   TextureCacheStatistics statistics = sStatistics;
+   statistics.mBytesUsed = sTotalSize;
+   statistics.mBytesBudget = getTextureCacheSize();
+   return statistics;
+}
+
+void TextureCacheEntry::resetCacheStatistics()
+{
+   sStatistics = TextureCacheStatistics();
+}
+
+TextureImpl::TextureImpl() :
+   mHandle(0),
+   mReferenceCount(1),
+   mUploading(false)
+{}
+
+TextureImpl::~TextureImpl()
+{
+   deleteTexture();
+}
+
+bool TextureImpl::isAllocated() const
+{
+   // Checking for a texture does not count as a use; only binding
+   // the texture moves it to the front of the cache.
+   return mHandle != 0;
 }
 
 void TextureImpl::genTexture(int size)
 {
-   static int sGenCount = 0;
-   ++sGenCount;
-   if (sGenCount % 20 == 0)
-   {
-      // by modding > 1, we ensure that we don't purge
-      // the texture cache to enforce the cache
-      // max every time we gen a new texture.  That
-      // is a performance optimization.
-      // we don't mod by 100 or so, because what ever
-      // value we mod by is the amount of textures
-      // that could overfill the max texture cache size.
-      // 20 was chosen as a good compromise, but could
-      // be adjusted as hardware changes.
-      deleteOldTextures();
-   }
-   //call this after deleteOldTextures because doing
-   //it before causes it to be the oldest texture
-   //in the heap. Putting this here also ensures
-   //this texture isn't the reason we go over the
-   //cache limit.
+   // Evicting from the tail of the list is cheap, so the budget is enforced
+   // for every new texture. This is done before the texture is created so
+   // that this texture is never the one which is evicted.
    deleteTexture();
+   reserveCacheSpace(size);
 
    glGenTextures(1, &mHandle); 
-   if (mHandle == 0)
+   while (mHandle == 0 && reduceCacheBudget() == true)
    {
-      const uint64_t minTextureCache = 100 * 1024 * 1024; //100 MB, no particular reason this was chosen as the min
-      deleteOldTextures();
       glGenTextures(1, &mHandle); 
-      while (mHandle == 0 && getTextureCacheSize() > minTextureCache)
-      {
-         downsizeTextureCache();
-         deleteOldTextures();
-         glGenTextures(1, &mHandle); 
-      }
    }
 
    if (mHandle != 0)
    {
-      if (std::find(sAllTextures.begin(), sAllTextures.end(), this) == sAllTextures.end())
-      {
-         sAllTextures.push_back(this);
-      }
-      updateLastUsed(); 
-      mSize = size;
-      sTotalSize += size;
+      mUploading = true;
+      addToCache(size);
    }
 }
 
@@ -116,11 +233,15 @@ void TextureImpl::deleteTexture()
    if (mHandle != 0) 
    {
       glDeleteTextures(1, &mHandle);
-      sTotalSize -= mSize;
    }
+   removeFromCache();
    mHandle = 0; 
-   mLastUsed = 0;
-   mSize = 0;
+   mUploading = false;
+}
+
+void TextureImpl::evict()
+{
+   deleteTexture();
 }
 
 void TextureImpl::bind() const
@@ -128,18 +249,23 @@ void TextureImpl::bind() const
    if (mHandle != 0)
    {
       glBindTexture(GL_TEXTURE_2D, mHandle);
-      updateLastUsed();
-   }
-}
 
-uint64_t TextureImpl::lastUsed() const
-{
-   return mLastUsed;
+      // The first bind uploads the texture data and was already counted as a miss
+      if (mUploading == true)
+      {
+         mUploading = false;
+      }
+      else
+      {
+         recordHit();
+      }
+      markUsed();
+   }
 }
 
 int TextureImpl::getSize() const
 {
-   return mSize;
+   return static_cast<int>(getCacheSize());
 }
 
 void TextureImpl::incrementRefCount() const
@@ -156,28 +282,6 @@ void TextureImpl::decrementRefCount()
    }
 }
 
-bool TextureImplGr(const TextureImpl *pLhs, const TextureImpl *pRhs)
-{
-   return pLhs->lastUsed() > pRhs->lastUsed();
-}
-
-void TextureImpl::deleteOldTextures()
-{
-   uint64_t textureCacheSize = getTextureCacheSize();
-   if (sTotalSize > textureCacheSize)
-   {
-      std::make_heap(sAllTextures.begin(), sAllTextures.end(), TextureImplGr);
-
-      while (sTotalSize > textureCacheSize)
-      {
-         TextureImpl* pTexture = sAllTextures.front();
-         std::pop_heap(sAllTextures.begin(), sAllTextures.end(), TextureImplGr);
-         sAllTextures.pop_back();
-         pTexture->deleteTexture();
-      }
-   }
-}
-
 Texture::Texture() :
    mpImpl(new TextureImpl)
 {
@@ -191,9 +295,9 @@ Texture::Texture(const Texture& rhs) :
 
 Texture& Texture::operator=(const Texture& rhs)
 {
+   rhs.mpImpl->incrementRefCount();
    mpImpl->decrementRefCount();
    mpImpl = rhs.mpImpl;
-   mpImpl->incrementRefCount();
    return *this;
 }
 
@@ -221,3 +325,13 @@ uint64_t Texture::lastUsed() const
 {
    return mpImpl->lastUsed();
 }
+
+TextureCacheStatistics Texture::getCacheStatistics()
+{
+   return TextureCacheEntry::getCacheStatistics();
+}
+
+void Texture::resetCacheStatistics()
+{
+   TextureCacheEntry::resetCacheStatistics();
+}
@@ -14,7 +14,80 @@
 #include <time.h>
 #include <vector>
 
-class TextureImpl
+class TextureCacheStatistics
+{
+public:
+   TextureCacheStatistics() :
+      mHits(0),
+      mMisses(0),
+      mEvictions(0),
+      mBytesUsed(0),
+      mBytesBudget(0)
+   {}
+
+   uint64_t mHits;         // textures which were bound while still resident
+   uint64_t mMisses;       // textures which had to be generated
+   uint64_t mEvictions;    // textures deleted to keep the cache within its budget
+   uint64_t mBytesUsed;
+   uint64_t mBytesBudget;
+};
+
+// All texture memory used by images shares a single, process-wide cache which is
+// bounded by the GpuTextureCacheSize setting. Each allocation is an entry in a list
+// ordered from most to least recently used so that enforcing the budget only needs
+// to evict entries from the tail of the list. Entries are only ever created, used
+// and evicted from the GL thread.
+class TextureCacheEntry
+{
+public:
+   TextureCacheEntry();
+   virtual ~TextureCacheEntry();
+
+   bool isCached() const;
+   uint64_t lastUsed() const;
+   unsigned int getCacheSize() const;
+
+   static TextureCacheStatistics getCacheStatistics();
+   static void resetCacheStatistics();
+
+protected:
+   // Evicts the least recently used entries until an allocation of the given size fits in the budget
+   static void reserveCacheSpace(unsigned int size);
+   // Halves the budget after a failed allocation, returns false if it is already at the minimum
+   static bool reduceCacheBudget();
+   static void recordHit();
+
+   void addToCache(unsigned int size);
+   void removeFromCache();
+   void markUsed() const;
+
+   // Frees the memory held by the entry. Implementations must call removeFromCache().
+   virtual void evict() = 0;
+
+private:
+   TextureCacheEntry(const TextureCacheEntry& rhs);
+   TextureCacheEntry& operator=(const TextureCacheEntry& rhs);
+
+   void link() const;
+   void unlink() const;
+   static void evictOldEntries();
+   static uint64_t getTextureCacheSize();
+
+   bool mCached;
+   unsigned int mCacheSize;
+   mutable uint64_t mLastUsed;
+   mutable const TextureCacheEntry* mpNewer;
+   mutable const TextureCacheEntry* mpOlder;
+   static const TextureCacheEntry* spNewest;
+   static const TextureCacheEntry* spOldest;
+   static uint64_t sTextureCacheSetting;
+   static uint64_t sTextureCacheSize;
+   static uint64_t sTotalSize;
+   static uint64_t sLastUsedCounter;
+   static TextureCacheStatistics sStatistics;
+};
+
+class TextureImpl : public TextureCacheEntry
 {
 public:
    TextureImpl();
@@ -24,24 +97,17 @@ public:
    void genTexture(int size);
    void deleteTexture();
    void bind() const;
-   uint64_t lastUsed() const;
    int getSize() const;
    void incrementRefCount() const;
    void decrementRefCount();
 
+protected:
+   void evict();
+
 private:
-   void updateLastUsed() const;
-   static void deleteOldTextures();
-   static uint64_t getTextureCacheSize(); 
-   static void downsizeTextureCache();
    unsigned int mHandle;
-   unsigned int mSize;
-   mutable uint64_t mLastUsed;
    mutable unsigned int mReferenceCount;
-   static std::vector<TextureImpl*> sAllTextures;
-   static uint64_t sTextureCacheSize;
-   static uint64_t sTotalSize;
-   static uint64_t sLastUsedCounter;
+   mutable bool mUploading;
 };
 
 class Texture
@@ -57,6 +123,9 @@ public:
    void bind();
    uint64_t lastUsed() const;
 
+   static TextureCacheStatistics getCacheStatistics();
+   static void resetCacheStatistics();
+
 private:
    TextureImpl* mpImpl;
 };
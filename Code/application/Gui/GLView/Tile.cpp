@@ -11,6 +11,7 @@
 #include "DrawUtil.h"
 
 const int Tile::INIT_TILE_SIZE = 512;
+const unsigned int Tile::MAX_TEXTURE_INDEX = 3;
 
 Tile::Tile() :
    mTexFormat(GL_RGB),
@@ -47,9 +48,9 @@ unsigned int Tile::getTextureIndex() const
       pixelSize *= 2.0;
    }
 
-   if (index > 3)
+   if (index > MAX_TEXTURE_INDEX)
    {
-      index = 3;
+      index = MAX_TEXTURE_INDEX;
    }
 
    return index;
@@ -65,10 +66,48 @@ bool Tile::isTextureReady(unsigned int index) const
    return mTextures[index].isAllocated();
 }
 
+bool Tile::hasTextures() const
+{
+   for (std::vector<Texture>::const_iterator iter = mTextures.begin(); iter != mTextures.end(); ++iter)
+   {
+      if (iter->isAllocated() == true)
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+bool Tile::getReadyTextureIndex(unsigned int& index) const
+{
+   // Prefer the requested texture, then the closest one with more detail, then the closest one with less detail
+   for (unsigned int finer = index + 1; finer > 0; --finer)
+   {
+      if (isTextureReady(finer - 1) == true)
+      {
+         index = finer - 1;
+         return true;
+      }
+   }
+
+   for (unsigned int coarser = index + 1; coarser <= MAX_TEXTURE_INDEX; ++coarser)
+   {
+      if (isTextureReady(coarser) == true)
+      {
+         index = coarser;
+         return true;
+      }
+   }
+
+   return false;
+}
+
 void Tile::draw(GLfloat textureMode)
 {
+   // A texture of another zoom level is drawn while the texture for this zoom level is generated
    unsigned int index = getTextureIndex();
-   if (mTextures.size() <= index)
+   if (getReadyTextureIndex(index) == false)
    {
       return;
    }
@@ -135,19 +174,7 @@ void Tile::setupTexture(unsigned int index, unsigned char* pTextureData)
    mXcoords[3] = -(mTexSizeX / 2);
    mYcoords[3] = -(mTexSizeY / 2) + mGeomSizeY;
 
-   int channels = 1;
-   if (mTexFormat == GL_RGB)
-   {
-      channels = 3;
-   }
-   else if (mTexFormat == GL_RGBA)
-   {
-      channels = 4;
-   }
-   else if (mTexFormat == GL_LUMINANCE_ALPHA)
-   {
-      channels = 2;
-   }
+   int channels = getChannelCount(mTexFormat);
 
    glEnable(GL_TEXTURE_2D);
    const int factor = computeReductionFactor(index);
@@ -167,6 +194,24 @@ void Tile::setupTexture(unsigned int index, unsigned char* pTextureData)
    glFlush();
 }
 
+int Tile::getChannelCount(GLenum format)
+{
+   if (format == GL_RGB)
+   {
+      return 3;
+   }
+   else if (format == GL_RGBA)
+   {
+      return 4;
+   }
+   else if (format == GL_LUMINANCE_ALPHA)
+   {
+      return 2;
+   }
+
+   return 1;
+}
+
 void Tile::setAlpha(unsigned int alpha)
 {
    mAlpha = alpha;
@@ -65,6 +65,8 @@ public:
    }
 
    virtual bool isTextureReady(unsigned int index) const;
+   bool hasTextures() const;
+   bool getReadyTextureIndex(unsigned int& index) const;
    virtual void setupTexture(unsigned int index, unsigned char* pTextureData);
    void draw(GLfloat textureMode);
    unsigned int getTextureIndex() const;
@@ -77,6 +79,10 @@ public:
       return 1 << index;
    }
 
+   static int getChannelCount(GLenum format);
+
+   static const unsigned int MAX_TEXTURE_INDEX;
+
 protected:
    void setXCoords(const std::vector<GLfloat>& xCoords);
    void setYCoords(const std::vector<GLfloat>& yCoords);
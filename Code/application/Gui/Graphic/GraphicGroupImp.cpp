@@ -26,6 +26,7 @@
 #include "GraphicLayerImp.h"
 #include "GraphicLayerUndo.h"
 #include "GraphicObjectFactory.h"
+#include "PerspectiveView.h"
 #include "SessionManager.h"
 #include "StringUtilities.h"
 #include "TextObject.h"
@@ -41,10 +42,24 @@ using namespace std;
 
 XERCES_CPP_NAMESPACE_USE
 
+namespace
+{
+   // Groups with fewer objects are searched directly since building the index costs more than it saves
+   const size_t sMinIndexedObjects = 128;
+
+   // Distance in screen pixels outside of an object's extents which can still hit the object
+   const double sHitMargin = 8.0;
+
+   // Distance in screen pixels outside of the viewport in which objects are still drawn, so wide lines
+   // and symbols which extend beyond their object's extents are not culled
+   const int sCullMargin = 64;
+}
+
 GraphicGroupImp::GraphicGroupImp(const string& id, GraphicObjectType type, GraphicLayer* pLayer,
                                  LocationType pixelCoord) :
    GraphicObjectImp(id, type, pLayer, pixelCoord),
-   mbNeedsLayout(true)
+   mbNeedsLayout(true),
+   mIndexDirty(true)
 {
 }
 
@@ -92,14 +107,24 @@ void GraphicGroupImp::draw(double zoomFactor) const
       pParentWidget = dynamic_cast<ViewImp*>(pLayer->getView());
    }
 
+   // Only draw the objects which can be visible in the current viewport
+   vector<GraphicObject*> objects;
+   LocationType llCorner;
+   LocationType urCorner;
+   if (getIndex() != NULL && getVisibleExtents(llCorner, urCorner) == true)
+   {
+      mIndex.query(llCorner, urCorner, objects);
+   }
+   else
+   {
+      objects.assign(mObjects.begin(), mObjects.end());
+   }
+
    int iBadObjects = 0;
 
-   list<GraphicObject*>::const_iterator iter;
-   iter = mObjects.begin();
-   while (iter != mObjects.end())
+   for (vector<GraphicObject*>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter)
    {
       GraphicObject* pObject = *iter;
-      ++iter;
       GraphicObjectImp* pObjectImp = dynamic_cast<GraphicObjectImp*>(pObject);
       if (pObject != NULL && pObjectImp != NULL)
       {
@@ -199,49 +224,14 @@ void GraphicGroupImp::updateBoundingBox()
          continue;
       }
 
-      LocationType llCorner = pObject->getLlCorner();
-      LocationType urCorner = pObject->getUrCorner();
-      LocationType center((llCorner.mX + urCorner.mX) / 2.0, (llCorner.mY + urCorner.mY) / 2.0);
+      LocationType llCorner;
+      LocationType urCorner;
+      GraphicObjectIndex::getExtents(pObject, llCorner, urCorner);
 
-      double angle = pObject->getRotation();
-      double cosTheta = cos(PI / 180.0 * angle);
-      double sinTheta = sin(PI / 180.0 * angle);
-
-      vector<LocationType> corners;
-      corners.push_back(llCorner);
-      corners.push_back(LocationType(llCorner.mX, urCorner.mY));
-      corners.push_back(urCorner);
-      corners.push_back(LocationType(urCorner.mX, llCorner.mY));
-
-      vector<LocationType>::const_iterator pit;
-      for (pit = corners.begin(); pit != corners.end(); ++pit)
-      {
-         LocationType realPoint
-         (
-            center.mX + (pit->mX - center.mX) * cosTheta - (pit->mY - center.mY) * sinTheta,
-            center.mY + (pit->mX - center.mX) * sinTheta + (pit->mY - center.mY) * cosTheta
-         );
-
-         if (realPoint.mX > dMaxX)
-         {
-            dMaxX = realPoint.mX;
-         }
-
-         if (realPoint.mX < dMinX)
-         {
-            dMinX = realPoint.mX;
-         }
-
-         if (realPoint.mY > dMaxY)
-         {
-            dMaxY = realPoint.mY;
-         }
-
-         if (realPoint.mY < dMinY)
-         {
-            dMinY = realPoint.mY;
-         }
-      }
+      dMinX = min(dMinX, llCorner.mX);
+      dMinY = min(dMinY, llCorner.mY);
+      dMaxX = max(dMaxX, urCorner.mX);
+      dMaxY = max(dMaxY, urCorner.mY);
    }
 
    LocationType groupLlCorner;
@@ -359,6 +349,7 @@ void GraphicGroupImp::updateLayout()
    for_each(mObjects.begin(), mObjects.end(), ConnectObject(this));
 
    mbNeedsLayout = false;
+   mIndexDirty = true;
    mLlCorner = llCorner;
    mUrCorner = urCorner;
 }
@@ -390,8 +381,20 @@ bool GraphicGroupImp::hit(LocationType pixelCoord) const
 
 GraphicObject* GraphicGroupImp::hitObject(const LocationType& pixelCoord) const
 {
-   list<GraphicObject*>::const_reverse_iterator iter;
-   for (iter = mObjects.rbegin(); iter != mObjects.rend(); ++iter)
+   vector<GraphicObject*> objects;
+   double margin = 0.0;
+   if (getIndex() != NULL && getHitMargin(margin) == true)
+   {
+      mIndex.query(LocationType(pixelCoord.mX - margin, pixelCoord.mY - margin),
+         LocationType(pixelCoord.mX + margin, pixelCoord.mY + margin), objects);
+   }
+   else
+   {
+      objects.assign(mObjects.begin(), mObjects.end());
+   }
+
+   vector<GraphicObject*>::const_reverse_iterator iter;
+   for (iter = objects.rbegin(); iter != objects.rend(); ++iter)
    {
       GraphicObject* pObject = *iter;
       GraphicObjectImp* pObjectImp = dynamic_cast<GraphicObjectImp*>(pObject);
@@ -428,6 +431,103 @@ GraphicObject* GraphicGroupImp::hitObject(const LocationType& pixelCoord) const
    return NULL;
 }
 
+const GraphicObjectIndex* GraphicGroupImp::getIndex() const
+{
+   if (mIndexDirty == true)
+   {
+      if (mObjects.size() < sMinIndexedObjects)
+      {
+         mIndex.clear();
+      }
+      else
+      {
+         mIndex.build(mObjects);
+      }
+
+      mIndexDirty = false;
+   }
+
+   if (mObjects.size() < sMinIndexedObjects)
+   {
+      return NULL;
+   }
+
+   return &mIndex;
+}
+
+bool GraphicGroupImp::getHitMargin(double& margin) const
+{
+   GraphicLayer* pLayer = getLayer();
+   if (pLayer == NULL)
+   {
+      return false;
+   }
+
+   // The screen size of the objects varies across a pitched view
+   PerspectiveView* pPerspectiveView = dynamic_cast<PerspectiveView*>(pLayer->getView());
+   if (pPerspectiveView != NULL && pPerspectiveView->getPitch() != 0.0)
+   {
+      return false;
+   }
+
+   LocationType pixelSize = getPixelSize();
+   double scale = min(pLayer->getXScaleFactor(), pLayer->getYScaleFactor());
+   double size = min(pixelSize.mX, pixelSize.mY) * scale;
+   if (size <= 0.0)
+   {
+      return false;
+   }
+
+   margin = sHitMargin / size;
+   return true;
+}
+
+bool GraphicGroupImp::getVisibleExtents(LocationType& llCorner, LocationType& urCorner) const
+{
+   // Labels are drawn in screen coordinates and can extend well beyond their object
+   GraphicLayer* pLayer = getLayer();
+   if (pLayer == NULL || pLayer->getShowLabels() == true)
+   {
+      return false;
+   }
+
+   double modelMatrix[16];
+   double projectionMatrix[16];
+   int viewPort[4];
+   glGetIntegerv(GL_VIEWPORT, viewPort);
+   glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
+   glGetDoublev(GL_MODELVIEW_MATRIX, modelMatrix);
+
+   // The visible region of a perspective projection is not bounded in the plane of the objects
+   if (projectionMatrix[3] != 0.0 || projectionMatrix[7] != 0.0 || projectionMatrix[11] != 0.0 ||
+      projectionMatrix[15] != 1.0)
+   {
+      return false;
+   }
+
+   double xPixels[2] = { viewPort[0] - sCullMargin, viewPort[0] + viewPort[2] + sCullMargin };
+   double yPixels[2] = { viewPort[1] - sCullMargin, viewPort[1] + viewPort[3] + sCullMargin };
+
+   llCorner = LocationType(1e30, 1e30);
+   urCorner = LocationType(-1e30, -1e30);
+   for (int i = 0; i < 4; ++i)
+   {
+      LocationType corner;
+      if (DrawUtil::unProjectToZero(xPixels[i / 2], yPixels[i % 2], modelMatrix, projectionMatrix, viewPort,
+         &corner.mX, &corner.mY) == false)
+      {
+         return false;
+      }
+
+      llCorner.mX = min(llCorner.mX, corner.mX);
+      llCorner.mY = min(llCorner.mY, corner.mY);
+      urCorner.mX = max(urCorner.mX, corner.mX);
+      urCorner.mY = max(urCorner.mY, corner.mY);
+   }
+
+   return true;
+}
+
 void GraphicGroupImp::updateGeo()
 {
    for (list<GraphicObject*>::iterator iter = mObjects.begin(); iter != mObjects.end(); ++iter)
@@ -492,6 +592,7 @@ void GraphicGroupImp::insertObject(GraphicObject* pObject)
       if (pObject->isVisible())
       {
          mObjects.push_back(pObject);
+         mIndexDirty = true;
       }
       ConnectObject(this)(pObject);
       notify(SIGNAL_NAME(GraphicGroup, ObjectAdded), boost::any(pObject));
@@ -505,6 +606,7 @@ void GraphicGroupImp::insertObjects(list<GraphicObject*>& objects)
 {
    for_each(objects.begin(), objects.end(), ConnectObject(this));
    mObjects.splice(mObjects.end(), objects);
+   mIndexDirty = true;
 
    for (list<GraphicObject*>::iterator iter = objects.begin(); iter != objects.end(); ++iter)
    {
@@ -520,6 +622,7 @@ void GraphicGroupImp::insertObjects(const list<GraphicObject*>& objects)
    list<GraphicObject*> localCopy = objects;
    for_each(localCopy.begin(), localCopy.end(), ConnectObject(this));
    mObjects.splice(mObjects.end(), localCopy);
+   mIndexDirty = true;
 
    for (list<GraphicObject*>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter)
    {
@@ -557,6 +660,19 @@ const list<GraphicObject*>& GraphicGroupImp::getObjects() const
    return mObjects;
 }
 
+void GraphicGroupImp::getObjectsInRegion(const LocationType& llCorner, const LocationType& urCorner,
+                                         vector<GraphicObject*>& objects) const
+{
+   if (getIndex() != NULL)
+   {
+      mIndex.query(llCorner, urCorner, objects);
+   }
+   else
+   {
+      objects.assign(mObjects.begin(), mObjects.end());
+   }
+}
+
 bool GraphicGroupImp::moveObjectToBack(GraphicObject* pObject)
 {
    if (pObject == NULL)
@@ -569,6 +685,7 @@ bool GraphicGroupImp::moveObjectToBack(GraphicObject* pObject)
    {
       mObjects.erase(iter);
       mObjects.push_front(pObject);
+      mIndexDirty = true;
       return true;
    }
 
@@ -587,6 +704,7 @@ bool GraphicGroupImp::moveObjectToFront(GraphicObject* pObject)
    {
       mObjects.erase(iter);
       mObjects.push_back(pObject);
+      mIndexDirty = true;
       return true;
    }
 
@@ -620,6 +738,7 @@ void GraphicGroupImp::setObjectStackingIndex(GraphicObject* pObject, int index)
          index--;
       }
       mObjects.insert(iter, pObject);
+      mIndexDirty = true;
    }
 }
 
@@ -641,6 +760,7 @@ bool GraphicGroupImp::removeObject(GraphicObject* pObject, bool bDelete)
    if (it != mObjects.end())
    {
       mObjects.erase(it);
+      mIndexDirty = true;
       DisconnectObject(this)(pObject);
       notify(SIGNAL_NAME(GraphicGroup, ObjectRemoved), boost::any(pObject));
 
@@ -696,6 +816,7 @@ void GraphicGroupImp::removeAllObjects(bool bDelete)
    }
 
    for_each(mObjects.begin(), mObjects.end(), DisconnectObject(this));
+   mIndexDirty = true;
 
    // Remove each object while iterating the loop to avoid stale pointers within mObjects.
    // The stale pointers can cause crashes if code attached to GraphicGroup, ObjectRemoved calls methods on this class.
@@ -1095,8 +1216,13 @@ void GraphicGroupImp::updateFromProperty(GraphicProperty* pProperty)
 {
    if (dynamic_cast<BoundingBoxProperty*>(pProperty) != NULL)
    {
+      mIndexDirty = true;
       updateBoundingBox();
    }
+   else if (dynamic_cast<RotationProperty*>(pProperty) != NULL)
+   {
+      mIndexDirty = true;
+   }
 
    notify(SIGNAL_NAME(GraphicGroup, ObjectChanged), boost::any(pProperty));
 }
@@ -11,12 +11,14 @@
 #define GRAPHICGROUPIMP_H
 
 #include "GraphicObjectImp.h"
+#include "GraphicObjectIndex.h"
 #include "GraphicProperty.h"
 #include "TypesFile.h"
 #include "xmlwriter.h"
 
 #include <string>
 #include <list>
+#include <vector>
 
 class GraphicLayer;
 
@@ -48,6 +50,22 @@ public:
    void insertObjects(const std::list<GraphicObject*>& objects);
    bool hasObject(GraphicObject* pObject) const;
    const std::list<GraphicObject*>& getObjects() const;
+
+   /**
+    * Finds the objects whose rotated extents intersect a region.
+    *
+    * Large groups use a spatial index, so the returned objects may be a small
+    * subset of the group. Small groups return all of their objects.
+    *
+    * @param llCorner
+    *        The lower left corner of the region.
+    * @param urCorner
+    *        The upper right corner of the region.
+    * @param objects
+    *        Populated with the candidate objects in stacking order, from back to front.
+    */
+   void getObjectsInRegion(const LocationType& llCorner, const LocationType& urCorner,
+      std::vector<GraphicObject*>& objects) const;
    bool moveObjectToBack(GraphicObject* pObject);
    bool moveObjectToFront(GraphicObject* pObject);
    int getObjectStackingIndex(GraphicObject* pObject) const;
@@ -82,6 +100,12 @@ private:
    bool mbNeedsLayout;
    LocationType mLlCorner;
    LocationType mUrCorner;
+   mutable GraphicObjectIndex mIndex;
+   mutable bool mIndexDirty;
+
+   const GraphicObjectIndex* getIndex() const;
+   bool getHitMargin(double& margin) const;
+   bool getVisibleExtents(LocationType& llCorner, LocationType& urCorner) const;
 
    template<typename T, typename U>
    bool propagateProperty(T method, U value);
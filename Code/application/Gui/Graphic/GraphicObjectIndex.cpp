@@ -0,0 +1,248 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "GraphicObject.h"
+#include "GraphicObjectIndex.h"
+
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+
+namespace
+{
+   // Number of children of each node, small enough that a node's bounds fit in a few cache lines
+   const unsigned int sNodeCapacity = 16;
+
+   template<typename T>
+   bool compareCenterX(const T& lhs, const T& rhs)
+   {
+      return lhs.mBounds.mMinX + lhs.mBounds.mMaxX < rhs.mBounds.mMinX + rhs.mBounds.mMaxX;
+   }
+
+   template<typename T>
+   bool compareCenterY(const T& lhs, const T& rhs)
+   {
+      return lhs.mBounds.mMinY + lhs.mBounds.mMaxY < rhs.mBounds.mMinY + rhs.mBounds.mMaxY;
+   }
+}
+
+GraphicObjectIndex::GraphicObjectIndex()
+{}
+
+GraphicObjectIndex::~GraphicObjectIndex()
+{}
+
+void GraphicObjectIndex::build(const list<GraphicObject*>& objects)
+{
+   clear();
+
+   unsigned int stackingIndex = 0;
+   mEntries.reserve(objects.size());
+   for (list<GraphicObject*>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter, ++stackingIndex)
+   {
+      if (*iter == NULL)
+      {
+         continue;
+      }
+
+      LocationType llCorner;
+      LocationType urCorner;
+      getExtents(*iter, llCorner, urCorner);
+
+      Entry entry;
+      entry.mBounds.mMinX = llCorner.mX;
+      entry.mBounds.mMinY = llCorner.mY;
+      entry.mBounds.mMaxX = urCorner.mX;
+      entry.mBounds.mMaxY = urCorner.mY;
+      entry.mStackingIndex = stackingIndex;
+      entry.mpObject = *iter;
+      mEntries.push_back(entry);
+   }
+
+   if (mEntries.empty())
+   {
+      return;
+   }
+
+   // Pack the entries into leaves and then each level into the next until a single root remains
+   vector<vector<Node> > levels(1);
+   sortTiles(mEntries);
+   pack(mEntries, true, levels.back());
+   while (levels.back().size() > 1)
+   {
+      vector<Node> parents;
+      sortTiles(levels.back());
+      pack(levels.back(), false, parents);
+      levels.push_back(parents);
+   }
+
+   // Store the levels from the leaves up so the root is the last node
+   unsigned int levelOffset = 0;
+   for (vector<vector<Node> >::const_iterator level = levels.begin(); level != levels.end(); ++level)
+   {
+      unsigned int nextOffset = levelOffset + static_cast<unsigned int>(level->size());
+      for (vector<Node>::const_iterator node = level->begin(); node != level->end(); ++node)
+      {
+         mNodes.push_back(*node);
+         if (node->mLeaf == false)
+         {
+            mNodes.back().mFirst += levelOffset - static_cast<unsigned int>((level - 1)->size());
+         }
+      }
+
+      levelOffset = nextOffset;
+   }
+}
+
+void GraphicObjectIndex::clear()
+{
+   mEntries.clear();
+   mNodes.clear();
+}
+
+unsigned int GraphicObjectIndex::getNumObjects() const
+{
+   return static_cast<unsigned int>(mEntries.size());
+}
+
+void GraphicObjectIndex::query(const LocationType& llCorner, const LocationType& urCorner,
+                               vector<GraphicObject*>& objects) const
+{
+   objects.clear();
+   if (mNodes.empty())
+   {
+      return;
+   }
+
+   double minX = min(llCorner.mX, urCorner.mX);
+   double minY = min(llCorner.mY, urCorner.mY);
+   double maxX = max(llCorner.mX, urCorner.mX);
+   double maxY = max(llCorner.mY, urCorner.mY);
+
+   vector<pair<unsigned int, GraphicObject*> > hits;
+   vector<unsigned int> pending(1, static_cast<unsigned int>(mNodes.size()) - 1);
+   while (pending.empty() == false)
+   {
+      const Node& node = mNodes[pending.back()];
+      pending.pop_back();
+      if (node.mBounds.mMaxX < minX || node.mBounds.mMinX > maxX ||
+         node.mBounds.mMaxY < minY || node.mBounds.mMinY > maxY)
+      {
+         continue;
+      }
+
+      for (unsigned int i = node.mFirst; i < node.mFirst + node.mCount; ++i)
+      {
+         if (node.mLeaf == false)
+         {
+            pending.push_back(i);
+            continue;
+         }
+
+         const Entry& entry = mEntries[i];
+         if (entry.mBounds.mMaxX >= minX && entry.mBounds.mMinX <= maxX &&
+            entry.mBounds.mMaxY >= minY && entry.mBounds.mMinY <= maxY)
+         {
+            hits.push_back(make_pair(entry.mStackingIndex, entry.mpObject));
+         }
+      }
+   }
+
+   sort(hits.begin(), hits.end());
+
+   objects.reserve(hits.size());
+   for (vector<pair<unsigned int, GraphicObject*> >::const_iterator iter = hits.begin(); iter != hits.end(); ++iter)
+   {
+      objects.push_back(iter->second);
+   }
+}
+
+void GraphicObjectIndex::getExtents(const GraphicObject* pObject, LocationType& llCorner, LocationType& urCorner)
+{
+   llCorner = LocationType();
+   urCorner = LocationType();
+   if (pObject == NULL)
+   {
+      return;
+   }
+
+   LocationType objectLlCorner = pObject->getLlCorner();
+   LocationType objectUrCorner = pObject->getUrCorner();
+   LocationType center((objectLlCorner.mX + objectUrCorner.mX) / 2.0,
+      (objectLlCorner.mY + objectUrCorner.mY) / 2.0);
+
+   double angle = pObject->getRotation();
+   double cosTheta = cos(PI / 180.0 * angle);
+   double sinTheta = sin(PI / 180.0 * angle);
+
+   LocationType corners[4];
+   corners[0] = objectLlCorner;
+   corners[1] = LocationType(objectLlCorner.mX, objectUrCorner.mY);
+   corners[2] = objectUrCorner;
+   corners[3] = LocationType(objectUrCorner.mX, objectLlCorner.mY);
+
+   llCorner = LocationType(1e30, 1e30);
+   urCorner = LocationType(-1e30, -1e30);
+   for (int i = 0; i < 4; ++i)
+   {
+      LocationType realPoint
+      (
+         center.mX + (corners[i].mX - center.mX) * cosTheta - (corners[i].mY - center.mY) * sinTheta,
+         center.mY + (corners[i].mX - center.mX) * sinTheta + (corners[i].mY - center.mY) * cosTheta
+      );
+
+      llCorner.mX = min(llCorner.mX, realPoint.mX);
+      llCorner.mY = min(llCorner.mY, realPoint.mY);
+      urCorner.mX = max(urCorner.mX, realPoint.mX);
+      urCorner.mY = max(urCorner.mY, realPoint.mY);
+   }
+}
+
+template<typename T>
+void GraphicObjectIndex::sortTiles(vector<T>& items)
+{
+   // Sort into vertical slices of whole nodes and then sort each slice vertically so that
+   // consecutive runs of sNodeCapacity items form compact tiles
+   size_t nodeCount = (items.size() + sNodeCapacity - 1) / sNodeCapacity;
+   size_t sliceCount = static_cast<size_t>(ceil(sqrt(static_cast<double>(nodeCount))));
+   size_t sliceSize = max(sliceCount, static_cast<size_t>(1)) * sNodeCapacity;
+
+   sort(items.begin(), items.end(), compareCenterX<T>);
+   for (size_t first = 0; first < items.size(); first += sliceSize)
+   {
+      size_t last = min(first + sliceSize, items.size());
+      sort(items.begin() + first, items.begin() + last, compareCenterY<T>);
+   }
+}
+
+template<typename T>
+void GraphicObjectIndex::pack(const vector<T>& items, bool leaf, vector<Node>& nodes)
+{
+   nodes.clear();
+   nodes.reserve((items.size() + sNodeCapacity - 1) / sNodeCapacity);
+   for (size_t first = 0; first < items.size(); first += sNodeCapacity)
+   {
+      Node node;
+      node.mFirst = static_cast<unsigned int>(first);
+      node.mCount = static_cast<unsigned int>(min(static_cast<size_t>(sNodeCapacity), items.size() - first));
+      node.mLeaf = leaf;
+      node.mBounds = items[first].mBounds;
+      for (size_t i = first + 1; i < first + node.mCount; ++i)
+      {
+         node.mBounds.mMinX = min(node.mBounds.mMinX, items[i].mBounds.mMinX);
+         node.mBounds.mMinY = min(node.mBounds.mMinY, items[i].mBounds.mMinY);
+         node.mBounds.mMaxX = max(node.mBounds.mMaxX, items[i].mBounds.mMaxX);
+         node.mBounds.mMaxY = max(node.mBounds.mMaxY, items[i].mBounds.mMaxY);
+      }
+
+      nodes.push_back(node);
+   }
+}
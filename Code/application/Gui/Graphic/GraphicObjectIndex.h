@@ -0,0 +1,115 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef GRAPHICOBJECTINDEX_H
+#define GRAPHICOBJECTINDEX_H
+
+#include "LocationType.h"
+
+#include <list>
+#include <vector>
+
+class GraphicObject;
+
+/**
+ * A static R-tree of the extents of the objects in a graphic group.
+ *
+ * The tree is bulk loaded with the sort-tile-recursive algorithm, so it is rebuilt
+ * as a whole when the objects change rather than updated in place. Queries return
+ * the objects in their stacking order so callers can use the results the same way
+ * as the group's object list.
+ */
+class GraphicObjectIndex
+{
+public:
+   GraphicObjectIndex();
+   ~GraphicObjectIndex();
+
+   /**
+    * Replaces the contents of the index.
+    *
+    * @param objects
+    *        The objects to index in stacking order, from back to front.
+    */
+   void build(const std::list<GraphicObject*>& objects);
+
+   /**
+    * Removes all objects from the index.
+    */
+   void clear();
+
+   /**
+    * Returns the number of indexed objects.
+    */
+   unsigned int getNumObjects() const;
+
+   /**
+    * Finds the objects whose extents intersect a region.
+    *
+    * @param llCorner
+    *        The lower left corner of the region.
+    * @param urCorner
+    *        The upper right corner of the region.
+    * @param objects
+    *        Populated with the objects which intersect the region in stacking
+    *        order, from back to front.
+    */
+   void query(const LocationType& llCorner, const LocationType& urCorner, std::vector<GraphicObject*>& objects) const;
+
+   /**
+    * Calculates the extents of an object including its rotation.
+    *
+    * @param pObject
+    *        The object.
+    * @param llCorner
+    *        Populated with the lower left corner of the axis aligned box which
+    *        contains the rotated object.
+    * @param urCorner
+    *        Populated with the upper right corner of the axis aligned box which
+    *        contains the rotated object.
+    */
+   static void getExtents(const GraphicObject* pObject, LocationType& llCorner, LocationType& urCorner);
+
+private:
+   GraphicObjectIndex(const GraphicObjectIndex& rhs);
+   GraphicObjectIndex& operator=(const GraphicObjectIndex& rhs);
+
+   struct Bounds
+   {
+      double mMinX;
+      double mMinY;
+      double mMaxX;
+      double mMaxY;
+   };
+
+   struct Entry
+   {
+      Bounds mBounds;
+      unsigned int mStackingIndex;
+      GraphicObject* mpObject;
+   };
+
+   struct Node
+   {
+      Bounds mBounds;
+      unsigned int mFirst;
+      unsigned int mCount;
+      bool mLeaf;
+   };
+
+   template<typename T>
+   static void sortTiles(std::vector<T>& items);
+   template<typename T>
+   static void pack(const std::vector<T>& items, bool leaf, std::vector<Node>& nodes);
+
+   std::vector<Entry> mEntries;
+   std::vector<Node> mNodes;
+};
+
+#endif
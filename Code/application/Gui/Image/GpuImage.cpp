@@ -27,6 +27,7 @@
 #include "RasterUtilities.h"
 #include "UtilityServicesImp.h"
 
+#include <algorithm>
 #include <limits>
 using namespace mta;
 using namespace std;
@@ -382,11 +383,13 @@ double getOpenGlMax<double>()
 class GpuTileProcessor
 {
 public:
+   // When prefetching, the texture data is only read into the tiles and is not loaded into the textures
    GpuTileProcessor(const vector<GpuTile*>& tiles,
-      vector<unsigned int>& tileZoomIndices, const Image::ImageData& info) :
+      vector<unsigned int>& tileZoomIndices, const Image::ImageData& info, bool prefetch = false) :
       mTiles(tiles),
       mTileZoomIndices(tileZoomIndices),
-      mInfo(info)
+      mInfo(info),
+      mPrefetch(prefetch)
    {}
 
    void run();
@@ -395,6 +398,7 @@ private:
    const vector<GpuTile*>& mTiles;
    vector<unsigned int>& mTileZoomIndices;
    const Image::ImageData& mInfo;
+   bool mPrefetch;
 
    GpuTileProcessor& operator=(const GpuTileProcessor& rhs);
 
@@ -674,6 +678,12 @@ private:
          GpuTile* pTile = mTiles[i];
          if (pTile != NULL)
          {
+            if ((mPrefetch == false) && (pTile->usePrefetchData(bufSize * sizeof(Out), mInfo.mKey) == true))
+            {
+               pTile->setupTile(pTile->getTexData(bufSize * sizeof(Out)), outputType, mTileZoomIndices[i]);
+               continue;
+            }
+
             unsigned int posX = static_cast<unsigned int>(pTile->getPos().mX);
             unsigned int posY = static_cast<unsigned int>(pTile->getPos().mY);
             unsigned int geomSizeX = static_cast<unsigned int>(pTile->getGeomSize().mX);
@@ -699,6 +709,14 @@ private:
                return;
             }
 
+            if (mPrefetch == true)
+            {
+               Out* pPrefetchData = static_cast<Out*>(pTile->getPrefetchData(bufSize * sizeof(Out), mInfo.mKey));
+               populateTextureData(pPrefetchData, mInfo.mRawType[0], geomSizeX, geomSizeY, da,
+                  pDescriptor->getInterleaveFormat(), 1, channels, outputType);
+               continue;
+            }
+
             Out *pTexData = static_cast<Out*>(pTile->getTexData(bufSize * sizeof(Out)));
             populateTextureData(pTexData, mInfo.mRawType[0], geomSizeX, geomSizeY, da, 
                pDescriptor->getInterleaveFormat(), 1, channels, outputType);
@@ -1623,12 +1641,59 @@ void GpuImage::setActiveTileSet(const ImageKey &key)
    }
 }
 
+bool GpuImage::prefetchBand(DimensionDescriptor band, const vector<double>& stretchPoints,
+                            const vector<int>& badValues)
+{
+   // The tile sets are keyed on the display program, so the raw data for the drawn tiles is
+   // read into the tiles and loaded into their textures when the band is displayed. The
+   // stretch is applied by the display program and does not affect the data.
+   Image::ImageData info = getImageData();
+   if ((band.isValid() == false) || (band == info.mKey.mBand1) || (info.mKey.mStretchPoints2.empty() == false) ||
+      (badValues.empty() != info.mKey.mBadValues1.empty()))
+   {
+      return false;
+   }
+
+   info.mKey.mBand1 = band;
+   info.mKey.mBadValues1 = badValues;
+
+   vector<unsigned int> drawnZoomIndices;
+   vector<Tile*> drawnTiles = getDrawnTiles(drawnZoomIndices);
+
+   vector<GpuTile*> tiles;
+   vector<unsigned int> tileZoomIndices;
+   for (unsigned int i = 0; i < drawnTiles.size(); ++i)
+   {
+      GpuTile* pTile = dynamic_cast<GpuTile*>(drawnTiles[i]);
+      if ((pTile != NULL) && (pTile->hasPrefetchData(info.mKey) == false))
+      {
+         tiles.push_back(pTile);
+         tileZoomIndices.push_back(drawnZoomIndices[i]);
+      }
+   }
+
+   if (tiles.empty() == true)
+   {
+      return false;
+   }
+
+   GpuTileProcessor processor(tiles, tileZoomIndices, info, true);
+   processor.run();
+   return true;
+}
+
 unsigned int GpuImage::getMaxNumTileSets() const
 {
    // One tile set for grayscale, one for RGB, and one for the color map
    return 3;
 }
 
+bool GpuImage::canGenerateTilesInBackground() const
+{
+   // The tiles are loaded into textures and processed by the display programs on the main thread
+   return false;
+}
+
 vector<Tile*> GpuImage::getTilesToUpdate(const vector<Tile*>& tilesToDraw, vector<unsigned int>& tileZoomIndices)
 {
    const Image::ImageData imageInfo = Image::getImageData();
@@ -1637,12 +1702,13 @@ vector<Tile*> GpuImage::getTilesToUpdate(const vector<Tile*>& tilesToDraw, vecto
    // number to allow for an invalid default value of zero
    if (mPreviousBand != (imageInfo.mKey.mBand1.getActiveNumber() + 1))
    {
-      // band change has occurred and ALL the tiles need to be updated
-      // not just the ones that are visable and will be drawn to the screen
+      // band change has occurred, so every tile in the set holds the previous band. The tiles
+      // which are drawn are reloaded now and the others are evicted from the texture cache so
+      // that they are reloaded when they are next drawn.
       const vector<Tile*>* pTileSet = getActiveTiles();
       if (pTileSet != NULL)
       {
-         int numTiles = pTileSet->size();
+         int numTiles = tilesToDraw.size();
 
          vector<Tile*> tilesToUpdate;
          tilesToUpdate.reserve(numTiles);
@@ -1652,6 +1718,15 @@ vector<Tile*> GpuImage::getTilesToUpdate(const vector<Tile*>& tilesToDraw, vecto
 
          vector<Tile*>::const_iterator iter;
          for (iter = pTileSet->begin(); iter != pTileSet->end(); ++iter)
+         {
+            GpuTile* pTile = dynamic_cast<GpuTile*>(*iter);
+            if ((pTile != NULL) && (find(tilesToDraw.begin(), tilesToDraw.end(), pTile) == tilesToDraw.end()))
+            {
+               pTile->evict();
+            }
+         }
+
+         for (iter = tilesToDraw.begin(); iter != tilesToDraw.end(); ++iter)
          {
             Tile* pTile = *iter;
             if (pTile != NULL)
@@ -74,6 +74,9 @@ public:
    void freezeFilter(ImageFilterDescriptor *pDescriptor, bool toggle = true);
    unsigned int readTiles(double xCoord, double yCoord, GLsizei width, GLsizei height, std::vector<float>& values, bool& hasAlphas);
 
+   bool prefetchBand(DimensionDescriptor band, const std::vector<double>& stretchPoints,
+      const std::vector<int>& badValues);
+
    static void setMaxTextureSize(GLint maxSize = 0);
    static GLint getMaxTextureSize();
 
@@ -91,6 +94,7 @@ protected:
    unsigned int getMaxNumTileSets() const;
    std::vector<Tile*> getTilesToUpdate(const std::vector<Tile*>& tilesToDraw,
       std::vector<unsigned int>& tileZoomIndices);
+   bool canGenerateTilesInBackground() const;
    void getTilesToRead(int xCoord, int yCoord, GLsizei width, GLsizei height, 
                        std::vector<Tile*> &tiles, std::vector<LocationType> &tileLocations);
    unsigned int readTile(Tile* pTile, const LocationType& tileLocation, int x1Coord, int y1Coord,
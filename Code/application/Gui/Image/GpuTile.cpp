@@ -10,6 +10,7 @@
 #include "AppAssert.h"
 #include "GpuResourceManager.h"
 #include "GpuTile.h"
+#include "Image.h"
 #include "ImageFilter.h"
 #include "ImageUtilities.h"
 #include "ImageBuffer.h"
@@ -25,14 +26,18 @@ GpuTile::GpuTile() :
    mpImageLoader(NULL),
    mpImageReader(NULL),
    mpOutputColorBuffer(NULL),
-   mbInitialized(false)
+   mbInitialized(false),
+   mUploading(false),
+   mpPrefetchKey(NULL)
 {
 }
 
 GpuTile::~GpuTile()
 {
+   removeFromCache();
    delete mpImageLoader;
    delete mpImageReader;
+   delete mpPrefetchKey;
    for (vector<ImageFilter*>::iterator filter = mFilters.begin(); filter != mFilters.end(); ++filter)
    {
       delete *filter;
@@ -70,6 +75,12 @@ void GpuTile::setupTile(void *pData, EncodingType encodingType, unsigned int ind
       setXCoords(xCoords);
       setYCoords(yCoords);
 
+      int numBytes = static_cast<int>(texSize.mX) * static_cast<int>(texSize.mY) * 
+         ImageUtilities::sizeOf(dataType) * ImageUtilities::getNumColorChannels(textureFormat);
+
+      // make room in the texture cache before allocating so that this tile is not the one evicted
+      reserveCacheSpace(static_cast<unsigned int>(numBytes));
+
       // create color buffer object to be used to load data to the graphics card
       ColorBuffer* pColorBuffer(new ColorBuffer(GL_TEXTURE_RECTANGLE_ARB, internalFormat, 
                                       static_cast<int>(texSize.mX), static_cast<int>(texSize.mY), 
@@ -81,9 +92,6 @@ void GpuTile::setupTile(void *pData, EncodingType encodingType, unsigned int ind
          // the standard, ImageLoader, or ImagePBO, which uses the PBO OpenGL extension to
          // improve texture load time
          Service<GpuResourceManager> pResourceManager;
-         int numBytes = static_cast<int>(texSize.mX) * static_cast<int>(texSize.mY) * 
-            ImageUtilities::sizeOf(dataType) * ImageUtilities::getNumColorChannels(textureFormat);
-
          PixelBufferObject* pPixelBufferObject = pResourceManager->getPixelBufferObject(numBytes, GL_WRITE_ONLY);
          if (pPixelBufferObject != NULL)
          {
@@ -97,14 +105,21 @@ void GpuTile::setupTile(void *pData, EncodingType encodingType, unsigned int ind
          if (mpImageLoader != NULL)
          {
             mbInitialized = true;
+            mUploading = true;
+            addToCache(static_cast<unsigned int>(numBytes));
          }
       }
+      else
+      {
+         delete pColorBuffer;
+      }
    }
 
    // Update the input image buffer
    if (mpImageLoader != NULL)
    {
       mpImageLoader->loadData(pData);
+      markUsed();
    }
 
    // Run the filters and set the output image buffer
@@ -127,6 +142,17 @@ void GpuTile::draw(CGparameter outputCgTextureParam, GLfloat textureMode)
       return;
    }
 
+   // The first draw shows the texture which was just allocated and was already counted as a miss
+   if (mUploading == true)
+   {
+      mUploading = false;
+   }
+   else
+   {
+      recordHit();
+   }
+   markUsed();
+
    glMatrixMode(GL_MODELVIEW);
    glPushMatrix();
 
@@ -453,3 +479,71 @@ void *GpuTile::getTexData(unsigned int bytes)
 
    return &mTexData.front();
 }
+
+void* GpuTile::getPrefetchData(unsigned int bytes, const ImageKey& key)
+{
+   if (bytes == 0)
+   {
+      return NULL;
+   }
+
+   unsigned int elements = bytes / sizeof(unsigned int);
+   if (bytes % sizeof(unsigned int) != 0)
+   {
+      ++elements;
+   }
+
+   if (mPrefetchData.size() < elements)
+   {
+      mPrefetchData.resize(elements);
+   }
+
+   if (mpPrefetchKey == NULL)
+   {
+      mpPrefetchKey = new ImageKey(key);
+   }
+   else
+   {
+      *mpPrefetchKey = key;
+   }
+
+   return &mPrefetchData.front();
+}
+
+bool GpuTile::hasPrefetchData(const ImageKey& key) const
+{
+   // The texture data only depends on the values which are read, not on how they are displayed
+   if ((mpPrefetchKey == NULL) || (mPrefetchData.empty() == true))
+   {
+      return false;
+   }
+
+   return ((mpPrefetchKey->mpRasterElement[0] == key.mpRasterElement[0]) &&
+      (mpPrefetchKey->mBand1 == key.mBand1) && (mpPrefetchKey->mComponent == key.mComponent) &&
+      (mpPrefetchKey->mBadValues1 == key.mBadValues1));
+}
+
+bool GpuTile::usePrefetchData(unsigned int bytes, const ImageKey& key)
+{
+   if ((hasPrefetchData(key) == false) || (mPrefetchData.size() * sizeof(unsigned int) < bytes))
+   {
+      return false;
+   }
+
+   mTexData.swap(mPrefetchData);
+   mPrefetchData.clear();
+   delete mpPrefetchKey;
+   mpPrefetchKey = NULL;
+   return true;
+}
+
+void GpuTile::evict()
+{
+   // The image loader owns the color buffer holding the raw data
+   delete mpImageLoader;
+   mpImageLoader = NULL;
+   mpOutputColorBuffer = NULL;
+   mbInitialized = false;
+   mUploading = false;
+   removeFromCache();
+}
@@ -13,15 +13,19 @@
 #include "Tile.h"
 #include "ImageFilterDescriptor.h"
 #include "glCommon.h"
+#include "Textures.h"
 #include "TypesFile.h"
 
 #include <vector>
 
 class ColorBuffer;
 class ImageFilter;
+class ImageKey;
 class ImageLoader;
 
-class GpuTile : public Tile
+// The texture holding the raw tile data is an entry in the global texture cache, so it
+// is released when the cache is over budget and reloaded the next time it is drawn.
+class GpuTile : public Tile, public TextureCacheEntry
 {
    friend class GpuImage;
 public:
@@ -46,8 +50,14 @@ public:
 
    void *getTexData(unsigned int bytes);
 
+   // Holds the texture data of another band so that it can be loaded without reading the band again
+   void* getPrefetchData(unsigned int bytes, const ImageKey& key);
+   bool hasPrefetchData(const ImageKey& key) const;
+   bool usePrefetchData(unsigned int bytes, const ImageKey& key);
+
 protected:
    void applyFilters();
+   void evict();
 
 private:
    ImageLoader* mpImageLoader;
@@ -55,9 +65,12 @@ private:
    ColorBuffer* mpOutputColorBuffer;
 
    bool mbInitialized;
+   bool mUploading;
 
    std::vector<ImageFilter*> mFilters;
    std::vector<unsigned int> mTexData;
+   std::vector<unsigned int> mPrefetchData;
+   ImageKey* mpPrefetchKey;
 };
 
 #endif
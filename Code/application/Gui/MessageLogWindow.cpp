@@ -180,6 +180,7 @@ MessageLogWindowModel::MessageLogWindowModel(QObject* pParent) :
    mHeaderNames << "ID" << "Type" << "Message" << "Result" << "Reason" << "Time Stamp" << "Component" << "Key";
    mpLog.addSignal(SIGNAL_NAME(MessageLog, MessageAdded), Slot(this, &MessageLogWindowModel::messageAdded));
    mpLog.addSignal(SIGNAL_NAME(MessageLog, MessageHidden), Slot(this, &MessageLogWindowModel::messageFinalized));
+   mpLog.addSignal(SIGNAL_NAME(MessageLog, MessageDeleted), Slot(this, &MessageLogWindowModel::messageDeleted));
 }
 
 MessageLogWindowModel::~MessageLogWindowModel()
@@ -574,6 +575,14 @@ void MessageLogWindowModel::messageAdded(Subject& subject, const string& signal,
    }
 }
 
+void MessageLogWindowModel::messageDeleted(Subject& subject, const string& signal, const boost::any& value)
+{
+   // The log has already removed the message so the row can not be located, reset the model
+   // instead. Logs delete old messages in batches so this does not happen for every new message.
+   mPropertyCache.clear();
+   reset();
+}
+
 void MessageLogWindowModel::messageFinalized(Subject& subject, const string& signal, const boost::any& value)
 {
    Message* pMessage = boost::any_cast<Message*>(value);
@@ -91,6 +91,7 @@ public:
 
    void messageFinalized(Subject& subject, const std::string& signal, const boost::any& value);
    void messageAdded(Subject& subject, const std::string& signal, const boost::any& value);
+   void messageDeleted(Subject& subject, const std::string& signal, const boost::any& value);
 
 public slots:
    void setMessageLog(MessageLog* pLog);
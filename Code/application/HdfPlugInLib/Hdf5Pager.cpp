@@ -8,7 +8,9 @@
  */
 
 #include <hdf5.h> // #include this first so Hdf5Pager class is included properly
+#include <algorithm>
 #include <vector>
+#include <zlib.h>
 
 #include "ComplexData.h"
 #include "AppVerify.h"
@@ -21,6 +23,7 @@
 #include "Hdf5Pager.h"
 #include "Hdf5Resource.h"
 #include "Hdf5Utilities.h"
+#include "MultiThreadedAlgorithm.h"
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
 #include "RasterFileDescriptor.h"
@@ -29,8 +32,173 @@
 using namespace HdfUtilities;
 using namespace std;
 
+// H5Dread_chunk() was added in HDF5 1.10.3, older libraries decode every chunk themselves
+#if H5_VERS_MAJOR > 1 || (H5_VERS_MAJOR == 1 && \
+   (H5_VERS_MINOR > 10 || (H5_VERS_MINOR == 10 && H5_VERS_RELEASE >= 3)))
+#define HDF5_RAW_CHUNK_READS
+#endif
+
+namespace
+{
+   struct RawChunk
+   {
+      RawChunk() : mIndex(0), mFilterMask(0), mFileType(false) {}
+
+      hsize_t mIndex;
+      hsize_t mOffset[3];
+      unsigned int mFilterMask;
+      bool mFileType;
+      vector<char> mEncoded;
+      boost::shared_ptr<vector<char> > mpDecoded;
+   };
+
+   bool inflateChunk(const vector<char>& encoded, vector<char>& decoded)
+   {
+      uLongf decodedSize = static_cast<uLongf>(decoded.size());
+      if (encoded.empty() || decoded.empty())
+      {
+         return false;
+      }
+
+      return uncompress(reinterpret_cast<Bytef*>(&decoded[0]), &decodedSize,
+         reinterpret_cast<const Bytef*>(&encoded[0]), static_cast<uLong>(encoded.size())) == Z_OK &&
+         decodedSize == decoded.size();
+   }
+
+   void unshuffleChunk(const vector<char>& shuffled, vector<char>& decoded, size_t elementSize)
+   {
+      // The shuffle filter stores the first byte of every element, then the second byte, etc.
+      // Trailing bytes which do not make up a whole element are not shuffled.
+      size_t elementCount = shuffled.size() / elementSize;
+      decoded.resize(shuffled.size());
+      for (size_t byte = 0; byte < elementSize; ++byte)
+      {
+         const char* pSource = &shuffled[byte * elementCount];
+         for (size_t element = 0; element < elementCount; ++element)
+         {
+            decoded[element * elementSize + byte] = pSource[element];
+         }
+      }
+
+      copy(shuffled.begin() + elementCount * elementSize, shuffled.end(), decoded.begin() + elementCount * elementSize);
+   }
+
+   bool decodeChunk(RawChunk& chunk, const vector<H5Z_filter_t>& filters, size_t elementSize, size_t chunkBytes)
+   {
+      // Undo the filters in the reverse of the order they were applied when the chunk was written
+      vector<char> buffer;
+      buffer.swap(chunk.mEncoded);
+      for (int filter = static_cast<int>(filters.size()) - 1; filter >= 0; --filter)
+      {
+         if ((chunk.mFilterMask & (1U << filter)) != 0)
+         {
+            continue; // the filter was skipped for this chunk
+         }
+
+         vector<char> decoded;
+         if (filters[filter] == H5Z_FILTER_DEFLATE)
+         {
+            decoded.resize(chunkBytes);
+            if (inflateChunk(buffer, decoded) == false)
+            {
+               return false;
+            }
+         }
+         else if (filters[filter] == H5Z_FILTER_SHUFFLE)
+         {
+            unshuffleChunk(buffer, decoded, elementSize);
+         }
+         else
+         {
+            return false;
+         }
+
+         buffer.swap(decoded);
+      }
+
+      if (buffer.size() != chunkBytes)
+      {
+         return false;
+      }
+
+      chunk.mpDecoded.reset(new vector<char>);
+      chunk.mpDecoded->swap(buffer);
+      return true;
+   }
+
+   class ChunkDecodeThread;
+
+   struct ChunkDecodeInput
+   {
+      vector<RawChunk>* mpChunks;
+      const vector<H5Z_filter_t>* mpFilters;
+      size_t mElementSize;
+      size_t mChunkBytes;
+   };
+
+   struct ChunkDecodeOutput
+   {
+      bool compileOverallResults(const vector<ChunkDecodeThread*>& threads);
+   };
+
+   class ChunkDecodeThread : public mta::AlgorithmThread
+   {
+   public:
+      ChunkDecodeThread(const ChunkDecodeInput& input, int threadCount, int threadIndex,
+         mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRange(getThreadRange(threadCount, static_cast<int>(input.mpChunks->size()))),
+         mSuccess(true)
+      {}
+
+      void run()
+      {
+         for (int index = mRange.mFirst; index <= mRange.mLast && mSuccess; ++index)
+         {
+            RawChunk& chunk = (*mInput.mpChunks)[index];
+            if (chunk.mpDecoded.get() == NULL)
+            {
+               mSuccess = decodeChunk(chunk, *mInput.mpFilters, mInput.mElementSize, mInput.mChunkBytes);
+            }
+         }
+      }
+
+      bool isSuccessful() const
+      {
+         return mSuccess;
+      }
+
+   private:
+      ChunkDecodeThread& operator=(const ChunkDecodeThread& rhs);
+
+      const ChunkDecodeInput& mInput;
+      Range mRange;
+      bool mSuccess;
+   };
+
+   bool ChunkDecodeOutput::compileOverallResults(const vector<ChunkDecodeThread*>& threads)
+   {
+      for (vector<ChunkDecodeThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+      {
+         if ((*iter)->isSuccessful() == false)
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+}
+
 Hdf5Pager::Hdf5Pager() :
-   mFileHandle(INVALID_HANDLE), mDataHandle(INVALID_HANDLE), mFileAccessProperties(H5P_DEFAULT)
+   mFileHandle(INVALID_HANDLE),
+   mDataHandle(INVALID_HANDLE),
+   mFileAccessProperties(H5P_DEFAULT),
+   mChunkedReads(false),
+   mRawChunkReads(false),
+   mDecodedChunkBytes(0),
+   mDecodedChunkCacheSize(0)
 {
    setName("Hdf5Pager");
    setDescriptorId("{F3720154-8F3A-43e2-BF36-3A810B59218F}");
@@ -109,6 +277,65 @@ bool Hdf5Pager::openFile(const std::string& filename)
    {
       return false;
    }
+
+   mChunkedReads = Hdf5Pager::getSettingChunkAlignedReads() && initializeChunkedReads();
+   mDecodedChunkCacheSize = Hdf5Pager::getSettingDecodedChunkCacheSize();
+   return true;
+}
+
+bool Hdf5Pager::initializeChunkedReads()
+{
+   Hdf5DataSpaceResource dataSpace(H5Dget_space(mDataHandle));
+   if (*dataSpace < 0 || H5Sget_simple_extent_ndims(*dataSpace) != 3 ||
+      H5Sget_simple_extent_dims(*dataSpace, mDataDims, NULL) != 3)
+   {
+      return false;
+   }
+
+   hid_t createProperties = H5Dget_create_plist(mDataHandle);
+   if (createProperties < 0)
+   {
+      return false;
+   }
+
+   bool chunked = H5Pget_layout(createProperties) == H5D_CHUNKED &&
+      H5Pget_chunk(createProperties, 3, mChunkDims) == 3;
+
+   // Chunks can only be read without the library decoding them if every filter can be undone here
+   mFilters.clear();
+   mRawChunkReads = chunked;
+   int filterCount = (chunked ? H5Pget_nfilters(createProperties) : 0);
+   for (int index = 0; index < filterCount; ++index)
+   {
+      unsigned int flags = 0;
+      size_t valueCount = 0;
+      unsigned int filterConfig = 0;
+      H5Z_filter_t filter = H5Pget_filter2(createProperties, index, &flags, &valueCount, NULL, 0, NULL,
+         &filterConfig);
+      if (filter != H5Z_FILTER_DEFLATE && filter != H5Z_FILTER_SHUFFLE)
+      {
+         mRawChunkReads = false;
+      }
+
+      mFilters.push_back(filter);
+   }
+
+   H5Pclose(createProperties);
+   if (chunked == false)
+   {
+      return false;
+   }
+
+   for (int dim = 0; dim < 3; ++dim)
+   {
+      if (mChunkDims[dim] == 0)
+      {
+         return false;
+      }
+
+      mChunkCounts[dim] = (mDataDims[dim] + mChunkDims[dim] - 1) / mChunkDims[dim];
+   }
+
    return true;
 }
 
@@ -127,6 +354,10 @@ void Hdf5Pager::closeFile()
    {
       H5Fclose(mFileHandle);
    }
+
+   mDecodedChunks.clear();
+   mChunkOrder.clear();
+   mDecodedChunkBytes = 0;
 }
 
 hid_t Hdf5Pager::getFileHandle()
@@ -178,6 +409,7 @@ CachedPage::UnitPtr Hdf5Pager::fetchUnit(DataRequest *pOriginalRequest)
    double bpp = getBytesPerBand();
 
    InterleaveFormatType fileInterleave = pFileDescriptor->getInterleaveFormat();
+   ProcessingLocation procLoc = pDescriptor->getProcessingLocation();
 
    if (requestedFormat != fileInterleave)
    {
@@ -228,8 +460,6 @@ CachedPage::UnitPtr Hdf5Pager::fetchUnit(DataRequest *pOriginalRequest)
       }
    case BSQ:
       {
-         ProcessingLocation procLoc = pDescriptor->getProcessingLocation();
-
          // the offsets change the 'origin' of the read
          offset[0] = startBand.getOnDiskNumber();
          if (procLoc == ON_DISK_READ_ONLY)
@@ -294,6 +524,41 @@ CachedPage::UnitPtr Hdf5Pager::fetchUnit(DataRequest *pOriginalRequest)
       return pUnit;
    }
 
+   // Read whole chunks from chunked datasets so each chunk is only decompressed once
+   bool chunkedRead = mChunkedReads && stride[0] == 1 && stride[1] == 1 && stride[2] == 1;
+   if (chunkedRead)
+   {
+      // Extend the unit to chunk boundaries if that no more than doubles its rows.
+      // Larger chunks are shared between units through the decoded chunk cache.
+      const int rowDim = (fileInterleave == BSQ ? 1 : 0);
+      const hsize_t chunkRows = mChunkDims[rowDim];
+      const hsize_t firstRow = offset[rowDim] - offset[rowDim] % chunkRows;
+      const hsize_t endRow = min((offset[rowDim] + counts[rowDim] + chunkRows - 1) / chunkRows * chunkRows,
+         mDataDims[rowDim]);
+      const hsize_t leadingRows = offset[rowDim] - firstRow;
+      const hsize_t alignedRows = endRow - firstRow;
+      const hsize_t activeStart = startRow.getActiveNumber();
+      if (alignedRows <= 2 * counts[rowDim] && leadingRows <= activeStart &&
+         activeStart - leadingRows + alignedRows <= pDescriptor->getRowCount())
+      {
+         // The aligned rows must also be contiguous in the file
+         bool onDisk = (fileInterleave == BSQ && procLoc == ON_DISK_READ_ONLY);
+         DimensionDescriptor alignedStart =
+            pDescriptor->getActiveRow(static_cast<unsigned int>(activeStart - leadingRows));
+         DimensionDescriptor alignedLast =
+            pDescriptor->getActiveRow(static_cast<unsigned int>(activeStart - leadingRows + alignedRows - 1));
+         if ((onDisk ? alignedStart.getOnDiskNumber() : alignedStart.getActiveNumber()) == firstRow &&
+            (onDisk ? alignedLast.getOnDiskNumber() : alignedLast.getActiveNumber()) == endRow - 1)
+         {
+            startRow = alignedStart;
+            concurrentRows = static_cast<unsigned int>(alignedRows);
+            offset[rowDim] = firstRow;
+            counts[rowDim] = alignedRows;
+            dimSpace[rowDim] = alignedRows;
+         }
+      }
+   }
+
    size_t pageSize = static_cast<size_t>(bpp*counts[0]*counts[1]*counts[2]);
 
    ArrayResource<char> pData(pageSize, true);
@@ -337,10 +602,18 @@ CachedPage::UnitPtr Hdf5Pager::fetchUnit(DataRequest *pOriginalRequest)
       }
    }
 
-   success = 0 == H5Sselect_hyperslab(*dataSpace, H5S_SELECT_SET, offset, stride, counts, NULL);
-   if (success)
+   if (chunkedRead && H5Tget_size(*loadedType) == H5Tget_size(*dataType) &&
+      H5Tget_size(*loadedType) == static_cast<size_t>(bpp))
    {
-      success = 0 == H5Dread(mDataHandle, *loadedType, *memSpace, *dataSpace, H5P_DEFAULT, pData.get());
+      success = readChunks(offset, counts, *dataType, *loadedType, pData.get());
+   }
+   else
+   {
+      success = 0 == H5Sselect_hyperslab(*dataSpace, H5S_SELECT_SET, offset, stride, counts, NULL);
+      if (success)
+      {
+         success = 0 == H5Dread(mDataHandle, *loadedType, *memSpace, *dataSpace, H5P_DEFAULT, pData.get());
+      }
    }
 
    if (success == false)
@@ -353,3 +626,186 @@ CachedPage::UnitPtr Hdf5Pager::fetchUnit(DataRequest *pOriginalRequest)
    pUnit.reset(pCacheUnit);
    return pUnit;
 }
+
+bool Hdf5Pager::readChunks(const hsize_t offset[3], const hsize_t counts[3], hid_t fileType, hid_t memoryType,
+                           char* pData)
+{
+   VERIFY(pData != NULL);
+
+   const size_t elementSize = H5Tget_size(memoryType);
+   const hsize_t chunkElements = mChunkDims[0] * mChunkDims[1] * mChunkDims[2];
+   const size_t chunkBytes = static_cast<size_t>(chunkElements) * elementSize;
+   const bool convertType = H5Tequal(fileType, memoryType) <= 0;
+
+   hsize_t firstChunk[3];
+   hsize_t lastChunk[3];
+   for (int dim = 0; dim < 3; ++dim)
+   {
+      VERIFY(counts[dim] > 0 && offset[dim] + counts[dim] <= mDataDims[dim]);
+      firstChunk[dim] = offset[dim] / mChunkDims[dim];
+      lastChunk[dim] = (offset[dim] + counts[dim] - 1) / mChunkDims[dim];
+   }
+
+   // Use the cached chunks and read the others from the file
+   map<hsize_t, ChunkPtr> chunks;
+   vector<RawChunk> rawChunks;
+   for (hsize_t chunk0 = firstChunk[0]; chunk0 <= lastChunk[0]; ++chunk0)
+   {
+      for (hsize_t chunk1 = firstChunk[1]; chunk1 <= lastChunk[1]; ++chunk1)
+      {
+         for (hsize_t chunk2 = firstChunk[2]; chunk2 <= lastChunk[2]; ++chunk2)
+         {
+            hsize_t chunkIndex = (chunk0 * mChunkCounts[1] + chunk1) * mChunkCounts[2] + chunk2;
+            map<hsize_t, ChunkPtr>::const_iterator cachedChunk = mDecodedChunks.find(chunkIndex);
+            if (cachedChunk != mDecodedChunks.end())
+            {
+               chunks[chunkIndex] = cachedChunk->second;
+               mChunkOrder.remove(chunkIndex);
+               mChunkOrder.push_back(chunkIndex);
+               continue;
+            }
+
+            rawChunks.push_back(RawChunk());
+            RawChunk& rawChunk = rawChunks.back();
+            rawChunk.mIndex = chunkIndex;
+            rawChunk.mOffset[0] = chunk0 * mChunkDims[0];
+            rawChunk.mOffset[1] = chunk1 * mChunkDims[1];
+            rawChunk.mOffset[2] = chunk2 * mChunkDims[2];
+
+#if defined(HDF5_RAW_CHUNK_READS)
+            hsize_t storageSize = 0;
+            if (mRawChunkReads && H5Dget_chunk_storage_size(mDataHandle, rawChunk.mOffset, &storageSize) >= 0 &&
+               storageSize > 0)
+            {
+               uint32_t filterMask = 0;
+               rawChunk.mEncoded.resize(static_cast<size_t>(storageSize));
+               if (H5Dread_chunk(mDataHandle, H5P_DEFAULT, rawChunk.mOffset, &filterMask,
+                  &rawChunk.mEncoded[0]) < 0)
+               {
+                  return false;
+               }
+
+               rawChunk.mFilterMask = filterMask;
+               rawChunk.mFileType = true;
+               continue;
+            }
+#endif
+
+            // Let the library read and decode the chunk. This also handles chunks which have
+            // not been written and only contain the fill value.
+            hsize_t chunkCounts[3];
+            for (int dim = 0; dim < 3; ++dim)
+            {
+               chunkCounts[dim] = min(mChunkDims[dim], mDataDims[dim] - rawChunk.mOffset[dim]);
+            }
+
+            const hsize_t memoryOffset[3] = {0, 0, 0};
+            Hdf5DataSpaceResource memorySpace(H5Screate_simple(3, mChunkDims, NULL));
+            Hdf5DataSpaceResource dataSpace(H5Dget_space(mDataHandle));
+            rawChunk.mpDecoded.reset(new vector<char>(chunkBytes, 0));
+            if (H5Sselect_hyperslab(*memorySpace, H5S_SELECT_SET, memoryOffset, NULL, chunkCounts, NULL) < 0 ||
+               H5Sselect_hyperslab(*dataSpace, H5S_SELECT_SET, rawChunk.mOffset, NULL, chunkCounts, NULL) < 0 ||
+               H5Dread(mDataHandle, memoryType, *memorySpace, *dataSpace, H5P_DEFAULT,
+                  &(*rawChunk.mpDecoded)[0]) < 0)
+            {
+               return false;
+            }
+         }
+      }
+   }
+
+   // Decompress the chunks in parallel outside of the HDF5 library
+   bool decode = false;
+   for (vector<RawChunk>::const_iterator rawChunk = rawChunks.begin(); rawChunk != rawChunks.end(); ++rawChunk)
+   {
+      decode = decode || rawChunk->mpDecoded.get() == NULL;
+   }
+
+   if (decode)
+   {
+      ChunkDecodeInput decodeInput;
+      decodeInput.mpChunks = &rawChunks;
+      decodeInput.mpFilters = &mFilters;
+      decodeInput.mElementSize = H5Tget_size(fileType);
+      decodeInput.mChunkBytes = chunkBytes;
+      ChunkDecodeOutput decodeOutput;
+      mta::MultiThreadedAlgorithm<ChunkDecodeInput, ChunkDecodeOutput, ChunkDecodeThread> decodeAlgorithm(
+         mta::getNumRequiredThreads(static_cast<unsigned int>(rawChunks.size())), decodeInput, decodeOutput, NULL);
+      if (decodeAlgorithm.run() != mta::SUCCESS)
+      {
+         return false;
+      }
+   }
+
+   for (vector<RawChunk>::iterator rawChunk = rawChunks.begin(); rawChunk != rawChunks.end(); ++rawChunk)
+   {
+      VERIFY(rawChunk->mpDecoded.get() != NULL);
+
+      // Chunks which were not decoded by the library are still in the file type and byte order
+      if (rawChunk->mFileType && convertType && H5Tconvert(fileType, memoryType, static_cast<size_t>(chunkElements),
+         &(*rawChunk->mpDecoded)[0], NULL, H5P_DEFAULT) < 0)
+      {
+         return false;
+      }
+
+      chunks[rawChunk->mIndex] = rawChunk->mpDecoded;
+      cacheChunk(rawChunk->mIndex, rawChunk->mpDecoded);
+   }
+
+   // Copy the requested part of each chunk into the hyperslab
+   for (hsize_t chunk0 = firstChunk[0]; chunk0 <= lastChunk[0]; ++chunk0)
+   {
+      for (hsize_t chunk1 = firstChunk[1]; chunk1 <= lastChunk[1]; ++chunk1)
+      {
+         for (hsize_t chunk2 = firstChunk[2]; chunk2 <= lastChunk[2]; ++chunk2)
+         {
+            const vector<char>& chunk = *chunks[(chunk0 * mChunkCounts[1] + chunk1) * mChunkCounts[2] + chunk2];
+            const hsize_t chunkStart[3] = {chunk0 * mChunkDims[0], chunk1 * mChunkDims[1], chunk2 * mChunkDims[2]};
+            hsize_t first[3];
+            hsize_t end[3];
+            for (int dim = 0; dim < 3; ++dim)
+            {
+               first[dim] = max(offset[dim], chunkStart[dim]);
+               end[dim] = min(offset[dim] + counts[dim], chunkStart[dim] + mChunkDims[dim]);
+            }
+
+            const size_t runBytes = static_cast<size_t>(end[2] - first[2]) * elementSize;
+            for (hsize_t index0 = first[0]; index0 < end[0]; ++index0)
+            {
+               for (hsize_t index1 = first[1]; index1 < end[1]; ++index1)
+               {
+                  hsize_t source = ((index0 - chunkStart[0]) * mChunkDims[1] + (index1 - chunkStart[1])) *
+                     mChunkDims[2] + (first[2] - chunkStart[2]);
+                  hsize_t destination = ((index0 - offset[0]) * counts[1] + (index1 - offset[1])) * counts[2] +
+                     (first[2] - offset[2]);
+                  memcpy(pData + static_cast<size_t>(destination) * elementSize,
+                     &chunk[static_cast<size_t>(source) * elementSize], runBytes);
+               }
+            }
+         }
+      }
+   }
+
+   return true;
+}
+
+void Hdf5Pager::cacheChunk(hsize_t chunkIndex, ChunkPtr pChunk)
+{
+   VERIFYNRV(pChunk.get() != NULL);
+
+   mDecodedChunks[chunkIndex] = pChunk;
+   mChunkOrder.push_back(chunkIndex);
+   mDecodedChunkBytes += pChunk->size();
+
+   // The chunks used by the unit being read are still referenced by the caller when they are discarded
+   while (mDecodedChunkBytes > mDecodedChunkCacheSize && mChunkOrder.empty() == false)
+   {
+      map<hsize_t, ChunkPtr>::iterator oldestChunk = mDecodedChunks.find(mChunkOrder.front());
+      mChunkOrder.pop_front();
+      if (oldestChunk != mDecodedChunks.end())
+      {
+         mDecodedChunkBytes -= oldestChunk->second->size();
+         mDecodedChunks.erase(oldestChunk);
+      }
+   }
+}
@@ -15,6 +15,11 @@
 
 #include <hdf5.h>
 
+#include <boost/shared_ptr.hpp>
+#include <list>
+#include <map>
+#include <vector>
+
 /**
  * This class is an on-disk accessor for HDF5 files.
  *
@@ -25,12 +30,21 @@
  * or three dimensions.  If used with datasets having two
  * dimensions, the band count must be 1 and the interleave format
  * must be BIP.
+ *
+ * If the dataset is chunked, cache units are aligned to the chunk layout and
+ * the data is read one chunk at a time. Deflate and shuffle compressed chunks
+ * are read from the file without being decoded by the HDF5 library and are
+ * decompressed on multiple threads. Decoded chunks are kept in a cache of
+ * getSettingDecodedChunkCacheSize() bytes so a chunk which is shared by
+ * several cache units is only decompressed once.
  */
 class Hdf5Pager : public HdfPager, public Hdf5PagerFileHandle
 {
 public:
    SETTING(CacheSize, Hdf5Pager, unsigned int, 1024 * 1024)
    SETTING(ChunkBufferSize, Hdf5Pager, unsigned int, 64 * 1024)
+   SETTING(ChunkAlignedReads, Hdf5Pager, bool, true)
+   SETTING(DecodedChunkCacheSize, Hdf5Pager, unsigned int, 64 * 1024 * 1024)
 
    /**
     * Creates an RasterPager for HDF5 data.
@@ -60,6 +74,21 @@ private:
    hid_t mDataHandle;
    hid_t mFileAccessProperties;
 
+   // chunk layout of the dataset, only valid if mChunkedReads is true
+   bool mChunkedReads;
+   bool mRawChunkReads;
+   hsize_t mDataDims[3];
+   hsize_t mChunkDims[3];
+   hsize_t mChunkCounts[3];
+   std::vector<H5Z_filter_t> mFilters;
+
+   // decoded chunks keyed by chunk index, mChunkOrder is least recently used first
+   typedef boost::shared_ptr<std::vector<char> > ChunkPtr;
+   std::map<hsize_t, ChunkPtr> mDecodedChunks;
+   std::list<hsize_t> mChunkOrder;
+   size_t mDecodedChunkBytes;
+   size_t mDecodedChunkCacheSize;
+
    /**
     * Opens the HDF5 file and dataset.
     *
@@ -73,6 +102,41 @@ private:
     */
    void closeFile();
 
+   /**
+    * Reads the chunk layout and filter pipeline of the dataset.
+    *
+    * @return \c True if the dataset is chunked and can be read one chunk at a time.
+    */
+   bool initializeChunkedReads();
+
+   /**
+    * Reads a hyperslab of a chunked dataset from whole decoded chunks.
+    *
+    * Chunks which are not in the decoded chunk cache are read and then decompressed
+    * in parallel.
+    *
+    * @param offset
+    *        The start of the hyperslab in the dataset.
+    * @param counts
+    *        The size of the hyperslab.
+    * @param fileType
+    *        The type of the data in the file.
+    * @param memoryType
+    *        The type to return the data as. It must be the same size as \em fileType.
+    * @param pData
+    *        The buffer for the hyperslab.
+    *
+    * @return \c True if the hyperslab was read, \c false otherwise.
+    */
+   bool readChunks(const hsize_t offset[3], const hsize_t counts[3], hid_t fileType, hid_t memoryType,
+      char* pData);
+
+   /**
+    * Adds a decoded chunk to the cache and discards the least recently used chunks
+    * which exceed the cache size.
+    */
+   void cacheChunk(hsize_t chunkIndex, ChunkPtr pChunk);
+
    /**
     *  Fetches a cache unit from an HDF5 file.
     */
@@ -56,6 +56,21 @@ typedef int64_t (*convertToInteger)(const void*, int, ComplexComponent);
  *    nextRow()
  * @endcode
  *
+ * If the DataRequest is tiled, each page is a block of rows and columns
+ * instead of a strip of full rows.  nextRow() pages down within the current
+ * tile column and toPixel() pages to whichever tile contains the pixel.
+ *
+ * @code
+ *   for each tile row
+ *      for each tile column
+ *         toPixel(tile start row, tile start column)
+ *         for each row in the tile
+ *            for each column in the tile
+ *               value = *getColumn()
+ *               nextColumn()
+ *            nextRow()
+ * @endcode
+ *
  * @see      RasterElement::getDataAccessor()
  */
 class DataAccessorImpl
@@ -109,7 +124,8 @@ public:
       mColumnOffset(0),
       mRefCount(0),
       mConvertToDoubleFunc(NULL),
-      mConvertToIntegerFunc(NULL)
+      mConvertToIntegerFunc(NULL),
+      mTiled(false)
    {
       if (pPage == NULL || mpRasterElement == NULL || mpRequest.get() == NULL)
       {
@@ -118,6 +134,7 @@ public:
       mAccessorRow = mpRequest->getStartRow().getActiveNumber();
       mAccessorColumn = mpRequest->getStartColumn().getActiveNumber();
       mAccessorBand = mpRequest->getStartBand().getActiveNumber();
+      mTiled = mpRequest->getTiled();
       updateDataSizes(elementSize, interLineBytes);
    }
 
@@ -154,6 +171,7 @@ public:
     *
     *  @param   resetColumn
     *           Whether or not to reset the column to the beginning column of the accessor.
+    *           For a tiled accessor, this is the first column of the current tile.
     */
    inline void nextRow(bool resetColumn=true) 
    {
@@ -250,7 +268,8 @@ public:
     *  Advances to the next column in the dataset.
     *
     *  This method increments to the next column based on the interleave
-    *  BIP, BSQ, or BIL.
+    *  BIP, BSQ, or BIL.  For a tiled accessor, this must not advance beyond
+    *  the last column of the current tile.
     */
    inline void nextColumn() 
    { 
@@ -292,6 +311,8 @@ public:
     *  @param   column
     *           The column to access in the current band.  This must be 
     *           non-negative and less than the total number of columns.
+    *           For a tiled accessor, the tile containing this column is
+    *           paged in if it is not the current tile.
     */
    inline void toPixel(int row, int column) 
    { 
@@ -387,6 +408,41 @@ public:
       return mConcurrentColumns;
    }
 
+   /**
+    *  Access the number of rows available in memory starting with the current row.
+    *
+    *  Rows beyond this may be accessed with nextRow() or toPixel() but are not
+    *  contiguous in memory with the current row.
+    *
+    *  @return The number of rows available in the current page.
+    */
+   inline size_t getConcurrentRows() const
+   {
+      return mConcurrentRows - mCurrentRow;
+   }
+
+   /**
+    *  Access the distance in bytes between the start of consecutive rows.
+    *
+    *  Unlike getRowSize(), this includes the interline bytes.
+    *
+    *  @return The number of bytes from the start of one row to the start of the next row.
+    */
+   inline size_t getRowStride() const
+   {
+      return mRowSize;
+   }
+
+   /**
+    *  Access the distance in bytes between the start of consecutive columns.
+    *
+    *  @return The number of bytes from the start of one column to the start of the next column.
+    */
+   inline size_t getColumnStride() const
+   {
+      return mColumnSize;
+   }
+
 private:
    friend class RasterElementImp;
 
@@ -398,7 +454,7 @@ private:
     */
    inline void updateIfNeeded()
    {
-      if (mCurrentRow >= mConcurrentRows)
+      if (mCurrentRow >= mConcurrentRows || (mTiled && mCurrentColumn >= mConcurrentColumns))
       {
          if (mpRasterElement == NULL)
          {
@@ -467,6 +523,7 @@ private:
    int mRefCount;
    convertToDouble mConvertToDoubleFunc;
    convertToInteger mConvertToIntegerFunc;
+   bool mTiled;                        // Pages are blocks of columns instead of full rows
 };
 
 #endif
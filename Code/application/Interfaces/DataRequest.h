@@ -81,7 +81,7 @@ public:
     *        The descriptor to use to determine required version.
     *
     * @return The smallest version number which can properly use this
-    *         DataRequest.  Currently always returns 1.
+    *         DataRequest.  Returns 2 for a tiled request and 1 otherwise.
     *
     * @see RasterPager::getSupportedRequestVersion()
     */
@@ -286,6 +286,46 @@ public:
     */
    virtual void setWritable(bool writable) = 0;
 
+   /**
+    * Get whether the request is for tiled data.
+    *
+    * This defaults to false.
+    *
+    * @return True if the request is for tiled data, false otherwise.
+    *
+    * @see setTiled()
+    */
+   virtual bool getTiled() const = 0;
+
+   /**
+    * Set whether the request is for tiled data.
+    *
+    * A non-tiled request is paged in row strips: each page contains
+    * every requested column and DataAccessor::nextRow() moves to the next
+    * page when the page is exhausted.
+    *
+    * A tiled request is paged in blocks of at most getConcurrentRows() by
+    * getConcurrentColumns() pixels.  A pager which natively stores its data
+    * in tiles or chunks can return a block without reading the remainder of
+    * the rows.  While iterating over a tiled DataAccessor, DataAccessor::nextColumn()
+    * must not be called beyond the last column of the current tile and
+    * DataAccessor::nextRow() with \c resetColumn set to \c true returns to the
+    * first column of the current tile.  DataAccessor::toPixel() may be used to
+    * move between tiles.
+    *
+    * Tiled requests are version 2 requests.  If the pager for the RasterElement
+    * does not support version 2 requests, or the requested interleave is BIL,
+    * the core clears this flag and pages the data in row strips.  Code which
+    * positions the accessor with DataAccessor::toPixel() at the start of each
+    * tile row works with either layout.
+    *
+    * @param tiled
+    *        True if the request is for tiled data, false otherwise.
+    *
+    * @see getTiled(), RasterPager::getSupportedRequestVersion()
+    */
+   virtual void setTiled(bool tiled) = 0;
+
 protected:
    /**
     * This should be destroyed by calling ObjectFactory::destroyObject.
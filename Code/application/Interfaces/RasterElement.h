@@ -164,6 +164,26 @@ public:
     */
    virtual Statistics* getStatistics(DimensionDescriptor band = DimensionDescriptor()) const = 0;
 
+   /**
+    *  Calculates the statistics of several bands together.
+    *
+    *  The statistics of the given bands which have not already been calculated
+    *  are calculated with one pass over the data for all of the bands instead of
+    *  separate passes for each band.  The results are the same as calling the
+    *  Statistics methods for each band.  Bands with an AOI set on their
+    *  statistics are calculated separately.
+    *
+    *  @param   bands
+    *           The bands for which to calculate the statistics.
+    *  @param   component
+    *           The complex component for which to calculate the statistics.
+    *           This is ignored for non-complex data.
+    *
+    *  @see     getStatistics()
+    */
+   virtual void calculateStatistics(const std::vector<DimensionDescriptor>& bands,
+      ComplexComponent component = COMPLEX_MAGNITUDE) = 0;
+
    /**
     * This method will create a new RasterElement which is a
     * chip of the object it is called on.  Its active row, column, and
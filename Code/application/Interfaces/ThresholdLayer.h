@@ -41,6 +41,7 @@ public:
    SETTING(PassArea, ThresholdLayer, PassArea, LOWER)
    SETTING(SecondValue, ThresholdLayer, double, 0.0)
    SETTING(RegionUnits, ThresholdLayer, RegionUnits, RAW_VALUE)
+   SETTING(IndexedPixelLimit, ThresholdLayer, unsigned int, 16777216)
 
    /**
     *  Emitted with boost::any<RegionUnits> when the units are changed.
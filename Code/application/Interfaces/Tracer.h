@@ -0,0 +1,115 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include "AppConfig.h"
+#include "Service.h"
+
+#include <string>
+
+/**
+ *  Records timed spans of work for profiling.
+ *
+ *  The tracer collects spans from the plug-in execution, raster paging, multi-threaded
+ *  algorithm and progress reporting code paths while it is enabled. Each thread records
+ *  into its own buffer so adding a span does not contend with other threads. The
+ *  recorded spans can be written as a Chrome trace, which can be loaded by the
+ *  chrome://tracing page of the Chrome web browser, or as a summary table.
+ *
+ *  Tracing is disabled by default and has negligible cost while it is disabled.
+ *  Plug-ins should typically record spans with the TraceSpan class rather than
+ *  calling addSpan() directly.
+ *
+ *  @see     TraceSpan
+ */
+class Tracer
+{
+public:
+   /**
+    *  Starts or stops recording spans.
+    *
+    *  Spans which have already been recorded are kept when tracing is disabled.
+    *
+    *  @param   enabled
+    *           If \c true, spans are recorded.
+    */
+   virtual void setEnabled(bool enabled) = 0;
+
+   /**
+    *  Queries whether spans are being recorded.
+    *
+    *  @return  \c True if spans are being recorded, otherwise \c false.
+    */
+   virtual bool isEnabled() const = 0;
+
+   /**
+    *  Returns the current trace time.
+    *
+    *  @return  The number of seconds since the tracer was created measured
+    *           with the highest resolution clock available.
+    */
+   virtual double getTime() const = 0;
+
+   /**
+    *  Records a span on the calling thread.
+    *
+    *  The span is ignored if tracing is not enabled.
+    *
+    *  @param   category
+    *           The category of the span, e.g. "plugin" or "raster".
+    *  @param   name
+    *           The name of the span. Spans with the same category and name are
+    *           combined in the summary.
+    *  @param   startTime
+    *           The start of the span as returned by getTime().
+    *  @param   endTime
+    *           The end of the span as returned by getTime().
+    *  @param   bytes
+    *           The number of bytes processed during the span or zero.
+    *  @param   detail
+    *           Additional text which is shown with the span in the Chrome trace.
+    */
+   virtual void addSpan(const std::string& category, const std::string& name, double startTime, double endTime,
+      uint64_t bytes = 0, const std::string& detail = std::string()) = 0;
+
+   /**
+    *  Discards all recorded spans.
+    */
+   virtual void clear() = 0;
+
+   /**
+    *  Writes the recorded spans in the Chrome trace event format.
+    *
+    *  @param   filename
+    *           The JSON file to write.
+    *
+    *  @return  \c True if the file was successfully written, otherwise \c false.
+    */
+   virtual bool writeChromeTrace(const std::string& filename) const = 0;
+
+   /**
+    *  Summarizes the recorded spans.
+    *
+    *  @return  A text table with one line for each category and name containing the
+    *           number of spans, the total, mean and maximum duration and the
+    *           total bytes. The lines are sorted by decreasing total duration.
+    */
+   virtual std::string getSummary() const = 0;
+
+protected:
+   /**
+    *  This will be cleaned up during application close.  Plug-ins do not
+    *  need to destroy it.
+    */
+   virtual ~Tracer() {}
+};
+
+#endif
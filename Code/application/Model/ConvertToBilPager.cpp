@@ -68,7 +68,6 @@ RasterPage* ConvertToBilPager::getPage(DataRequest* pOriginalRequest, DimensionD
    unsigned int numRows = pDd->getRowCount();
    unsigned int numCols = pDd->getColumnCount();
    unsigned int numBands = pDd->getBandCount();
-   const std::vector<DimensionDescriptor>& bandVec = pDd->getBands();
 
    if (startRow.getActiveNumber() >= numRows || stopRow.getActiveNumber() >= numRows ||
       startColumn.getActiveNumber() >= numCols || stopColumn.getActiveNumber() >= numCols ||
@@ -77,14 +76,10 @@ RasterPage* ConvertToBilPager::getPage(DataRequest* pOriginalRequest, DimensionD
       return NULL;
    }
 
-   std::vector<DimensionDescriptor>::const_iterator iter = std::find(bandVec.begin(), bandVec.end(), startBand);
-   if (iter == bandVec.end())
-   {
-      return NULL;
-   }
-
-   std::vector<DimensionDescriptor>::const_iterator stopIter = std::find(iter, bandVec.end(), stopBand);
-   if (stopIter == bandVec.end())
+   // Look the bands up by number so the descriptor's band vector is not locked and searched for every page
+   if (stopBand.getActiveNumber() < startBand.getActiveNumber() ||
+      pDd->getActiveBand(startBand.getActiveNumber()) != startBand ||
+      pDd->getActiveBand(stopBand.getActiveNumber()) != stopBand)
    {
       return NULL;
    }
@@ -101,12 +96,13 @@ RasterPage* ConvertToBilPager::getPage(DataRequest* pOriginalRequest, DimensionD
 
    if (interleave == BSQ)
    {
-      for (unsigned int band = 0; iter <= stopIter; ++iter, ++band)
+      for (unsigned int band = 0; band < bands; ++band)
       {
+         DimensionDescriptor bandDim = pDd->getActiveBand(startBand.getActiveNumber() + band);
          FactoryResource<DataRequest> pRequest;
          pRequest->setRows(startRow, stopRow, 1);
          pRequest->setColumns(startColumn, stopColumn, cols);
-         pRequest->setBands(*iter, DimensionDescriptor());
+         pRequest->setBands(bandDim, DimensionDescriptor());
 
          DataAccessor da = mpRaster->getDataAccessor(pRequest.release());
          unsigned char* pDst = reinterpret_cast<unsigned char*>(pPage->getRawData()) + (band * cols * mBytesPerElement);
@@ -129,7 +125,7 @@ RasterPage* ConvertToBilPager::getPage(DataRequest* pOriginalRequest, DimensionD
       FactoryResource<DataRequest> pRequest;
       pRequest->setRows(startRow, stopRow, 1);
       pRequest->setColumns(startColumn, stopColumn, cols);
-      pRequest->setBands(*iter, DimensionDescriptor());
+      pRequest->setBands(startBand, DimensionDescriptor());
 
       DataAccessor da = mpRaster->getDataAccessor(pRequest.release());
       for (unsigned int row = 0; row < rows; ++row)
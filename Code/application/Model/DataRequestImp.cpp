@@ -18,7 +18,8 @@ DataRequestImp::DataRequestImp() :
    mConcurrentRows(0),
    mConcurrentColumns(0),
    mConcurrentBands(0),
-   mbWritable(false)
+   mbWritable(false),
+   mTiled(false)
 {
 }
 
@@ -38,7 +39,8 @@ DataRequestImp::DataRequestImp(const DataRequestImp& rhs) :
    mStartBand(rhs.mStartBand),
    mStopBand(rhs.mStopBand),
    mConcurrentBands(rhs.mConcurrentBands),
-   mbWritable(rhs.mbWritable)
+   mbWritable(rhs.mbWritable),
+   mTiled(rhs.mTiled)
 {
 }
 
@@ -172,7 +174,7 @@ bool DataRequestImp::polish(const RasterDataDescriptor *pDescriptor)
 
 int DataRequestImp::getRequestVersion(const RasterDataDescriptor *pDescriptor) const
 {
-   return 1;
+   return mTiled ? 2 : 1;
 }
 
 InterleaveFormatType DataRequestImp::getInterleaveFormat() const
@@ -262,3 +264,13 @@ void DataRequestImp::setWritable(bool writable)
 {
    mbWritable = writable;
 }
+
+bool DataRequestImp::getTiled() const
+{
+   return mTiled;
+}
+
+void DataRequestImp::setTiled(bool tiled)
+{
+   mTiled = tiled;
+}
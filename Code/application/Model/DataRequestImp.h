@@ -49,6 +49,9 @@ public:
    bool getWritable() const;
    void setWritable(bool writable);
 
+   bool getTiled() const;
+   void setTiled(bool tiled);
+
 private:
    InterleaveFormatType mInterleave;
    bool mInterleaveDefault;
@@ -66,6 +69,7 @@ private:
    unsigned int mConcurrentBands;
 
    bool mbWritable;
+   bool mTiled;
 
 };
 
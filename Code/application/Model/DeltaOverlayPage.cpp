@@ -0,0 +1,76 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "DeltaOverlayPage.h"
+
+#include <stdlib.h>
+
+DeltaOverlayPage::DeltaOverlayPage(char* pData, unsigned int rows, unsigned int columns,
+                                   unsigned int interlineBytes, uint64_t blockKey) :
+   mpData(pData),
+   mRows(rows),
+   mColumns(columns),
+   mInterlineBytes(interlineBytes),
+   mBlockKey(blockKey),
+   mpSourcePage(NULL)
+{
+}
+
+DeltaOverlayPage::DeltaOverlayPage(RasterPage* pSourcePage, unsigned int rows) :
+   mpData(NULL),
+   mRows(rows),
+   mColumns(0),
+   mInterlineBytes(0),
+   mBlockKey(0),
+   mpSourcePage(pSourcePage)
+{
+   if (mpSourcePage != NULL)
+   {
+      mpData = reinterpret_cast<char*>(mpSourcePage->getRawData());
+   }
+}
+
+DeltaOverlayPage::~DeltaOverlayPage()
+{
+}
+
+unsigned int DeltaOverlayPage::getNumBands()
+{
+   return (mpSourcePage == NULL ? 0 : mpSourcePage->getNumBands());
+}
+
+unsigned int DeltaOverlayPage::getNumRows()
+{
+   return mRows;
+}
+
+unsigned int DeltaOverlayPage::getNumColumns()
+{
+   return (mpSourcePage == NULL ? mColumns : mpSourcePage->getNumColumns());
+}
+
+unsigned int DeltaOverlayPage::getInterlineBytes()
+{
+   return (mpSourcePage == NULL ? mInterlineBytes : mpSourcePage->getInterlineBytes());
+}
+
+void* DeltaOverlayPage::getRawData()
+{
+   return mpData;
+}
+
+RasterPage* DeltaOverlayPage::getSourcePage() const
+{
+   return mpSourcePage;
+}
+
+uint64_t DeltaOverlayPage::getBlockKey() const
+{
+   return mBlockKey;
+}
@@ -0,0 +1,70 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef DELTAOVERLAYPAGE_H
+#define DELTAOVERLAYPAGE_H
+
+#include "AppConfig.h"
+#include "RasterPage.h"
+#include "TypesFile.h"
+
+/**
+ * This class works with DeltaOverlayPager to provide either rows of a modified
+ * block or the rows of a page from the original pager which precede the next
+ * modified block.
+ */
+class DeltaOverlayPage : public RasterPage
+{
+public:
+   /**
+    * Creates a page of rows in a modified block.
+    *
+    * A tiled page reports the columns it contains and the interline bytes which
+    * skip the remainder of each row. Zero columns reports every column of the row.
+    */
+   DeltaOverlayPage(char* pData, unsigned int rows, unsigned int columns, unsigned int interlineBytes,
+      uint64_t blockKey);
+
+   /**
+    * Creates a page which limits the rows of a page from the original pager.
+    */
+   DeltaOverlayPage(RasterPage* pSourcePage, unsigned int rows);
+
+   virtual ~DeltaOverlayPage();
+
+   // RasterPage methods
+   unsigned int getNumBands();
+   unsigned int getNumRows();
+   unsigned int getNumColumns();
+   unsigned int getInterlineBytes();
+   void* getRawData();
+
+   /**
+    * Returns the page from the original pager, or \c NULL for a page of a modified block.
+    */
+   RasterPage* getSourcePage() const;
+
+   /**
+    * Returns the key of the modified block containing the page's rows.
+    */
+   uint64_t getBlockKey() const;
+
+private:
+   DeltaOverlayPage(const DeltaOverlayPage& rhs);
+   DeltaOverlayPage& operator=(const DeltaOverlayPage& rhs);
+
+   char* mpData;
+   unsigned int mRows;
+   unsigned int mColumns;
+   unsigned int mInterlineBytes;
+   uint64_t mBlockKey;
+   RasterPage* mpSourcePage;
+};
+
+#endif
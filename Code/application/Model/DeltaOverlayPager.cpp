@@ -0,0 +1,369 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "DataRequest.h"
+#include "DeltaOverlayPage.h"
+#include "DeltaOverlayPager.h"
+#include "Filename.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+
+#include <algorithm>
+#include <string.h>
+
+using namespace std;
+
+namespace
+{
+   // Number of bytes of whole rows in each block
+   const size_t sBlockSize = 1024 * 1024;
+}
+
+DeltaOverlayPager::DeltaOverlayPager(RasterElement* pRaster, RasterPager* pSourcePager) :
+   mpRaster(pRaster),
+   mpSourcePager(pSourcePager),
+   mInterleave(BSQ),
+   mRowCount(0),
+   mColumnCount(0),
+   mBandCount(0),
+   mBytesPerElement(0),
+   mRowBytes(0),
+   mBlockRows(0),
+   mBlocksPerBand(0),
+   mBlockBytes(0),
+   mMemoryBytes(0),
+   mMemoryLimit(DeltaOverlayPager::getSettingMemoryLimit()),
+   mBlockUses(0),
+   mSpillFileSize(0)
+{
+   const RasterDataDescriptor* pDescriptor = NULL;
+   if (mpRaster != NULL)
+   {
+      pDescriptor = dynamic_cast<const RasterDataDescriptor*>(mpRaster->getDataDescriptor());
+   }
+
+   if (pDescriptor != NULL)
+   {
+      mInterleave = pDescriptor->getInterleaveFormat();
+      mRowCount = pDescriptor->getRowCount();
+      mColumnCount = pDescriptor->getColumnCount();
+      mBandCount = pDescriptor->getBandCount();
+      mBytesPerElement = pDescriptor->getBytesPerElement();
+
+      // a block contains one band of BSQ data or all of the bands otherwise
+      mRowBytes = static_cast<size_t>(mColumnCount) * mBytesPerElement;
+      if (mInterleave != BSQ)
+      {
+         mRowBytes *= mBandCount;
+      }
+
+      if (mRowBytes > 0 && mRowCount > 0)
+      {
+         mBlockRows = static_cast<unsigned int>(min(max(sBlockSize / mRowBytes, static_cast<size_t>(1)),
+            static_cast<size_t>(mRowCount)));
+         mBlocksPerBand = (mRowCount + mBlockRows - 1) / mBlockRows;
+         mBlockBytes = mBlockRows * mRowBytes;
+      }
+   }
+}
+
+DeltaOverlayPager::~DeltaOverlayPager()
+{
+   for (map<uint64_t, Block>::iterator iter = mBlocks.begin(); iter != mBlocks.end(); ++iter)
+   {
+      delete [] iter->second.mpData;
+   }
+
+   if (mSpillFilename.empty() == false)
+   {
+      mSpillFile.close();
+      remove(mSpillFilename.c_str());
+   }
+}
+
+RasterPage* DeltaOverlayPager::getPage(DataRequest* pOriginalRequest, DimensionDescriptor startRow,
+                                       DimensionDescriptor startColumn, DimensionDescriptor startBand)
+{
+   VERIFYRV(pOriginalRequest != NULL && mpSourcePager != NULL, NULL);
+   if (pOriginalRequest->getInterleaveFormat() != mInterleave || mBlockRows == 0)
+   {
+      return NULL;
+   }
+
+   unsigned int row = startRow.getActiveNumber();
+   unsigned int column = startColumn.getActiveNumber();
+   unsigned int band = startBand.getActiveNumber();
+   if (row >= mRowCount || column >= mColumnCount || band >= mBandCount)
+   {
+      return NULL;
+   }
+
+   unsigned int outerBand = (mInterleave == BSQ ? band : 0);
+   unsigned int blockIndex = row / mBlockRows;
+   unsigned int blockFirstRow = blockIndex * mBlockRows;
+   unsigned int blockRows = min(mBlockRows, mRowCount - blockFirstRow);
+   uint64_t key = static_cast<uint64_t>(outerBand) * mBlocksPerBand + blockIndex;
+
+   mta::MutexLock lock(mMutex);
+
+   map<uint64_t, Block>::iterator foundBlock = mBlocks.find(key);
+   if (foundBlock == mBlocks.end() && pOriginalRequest->getWritable() == false)
+   {
+      // unmodified rows are read from the original pager, up to the next modified block of the band
+      RasterPage* pSourcePage = mpSourcePager->getPage(pOriginalRequest, startRow, startColumn, startBand);
+      if (pSourcePage == NULL)
+      {
+         return NULL;
+      }
+
+      unsigned int numRows = pSourcePage->getNumRows();
+      map<uint64_t, Block>::const_iterator nextBlock = mBlocks.upper_bound(key);
+      if (nextBlock != mBlocks.end() && nextBlock->first < static_cast<uint64_t>(outerBand + 1) * mBlocksPerBand)
+      {
+         unsigned int nextRow = static_cast<unsigned int>(nextBlock->first - key + blockIndex) * mBlockRows;
+         numRows = min(numRows, nextRow - row);
+      }
+
+      return new DeltaOverlayPage(pSourcePage, numRows);
+   }
+
+   if (foundBlock == mBlocks.end())
+   {
+      // the first write to a block copies it from the original pager
+      ArrayResource<char> pData(static_cast<int>(mBlockBytes), true);
+      if (pData.get() == NULL || readSourceBlock(blockFirstRow, blockRows, band, pData.get()) == false)
+      {
+         return NULL;
+      }
+
+      Block block;
+      block.mpData = pData.release();
+      block.mFileOffset = -1;
+      block.mLeases = 0;
+      block.mLastUse = 0;
+      foundBlock = mBlocks.insert(make_pair(key, block)).first;
+      mMemoryBytes += mBlockBytes;
+   }
+   else if (loadBlock(foundBlock->second) == false)
+   {
+      return NULL;
+   }
+
+   Block& block = foundBlock->second;
+   ++block.mLeases;
+   block.mLastUse = ++mBlockUses;
+
+   // the page starts at the requested pixel in the same layout as the original pages
+   size_t offset = (row - blockFirstRow) * mRowBytes;
+   if (mInterleave == BIP)
+   {
+      offset += (static_cast<size_t>(column) * mBandCount + band) * mBytesPerElement;
+   }
+   else if (mInterleave == BIL)
+   {
+      offset += (static_cast<size_t>(band) * mColumnCount + column) * mBytesPerElement;
+   }
+   else
+   {
+      offset += static_cast<size_t>(column) * mBytesPerElement;
+   }
+
+   // a tiled page only contains the requested columns, the remainder of each row
+   // becomes interline bytes so the accessor steps over it
+   unsigned int numColumns = 0;
+   unsigned int interlineBytes = 0;
+   if (pOriginalRequest->getTiled() && mInterleave != BIL)
+   {
+      size_t columnBytes = mBytesPerElement * (mInterleave == BIP ? mBandCount : 1);
+      numColumns = min(pOriginalRequest->getConcurrentColumns(), mColumnCount - column);
+      interlineBytes = static_cast<unsigned int>(mRowBytes - numColumns * columnBytes);
+   }
+
+   DeltaOverlayPage* pPage = new DeltaOverlayPage(block.mpData + offset, blockFirstRow + blockRows - row,
+      numColumns, interlineBytes, key);
+   trimBlocks();
+
+   return pPage;
+}
+
+void DeltaOverlayPager::releasePage(RasterPage* pPage)
+{
+   // Check that pPage is the correct type before deleting it.
+   DeltaOverlayPage* pOverlayPage = dynamic_cast<DeltaOverlayPage*>(pPage);
+   VERIFYNRV(pOverlayPage != NULL);
+
+   mta::MutexLock lock(mMutex);
+   if (pOverlayPage->getSourcePage() != NULL)
+   {
+      mpSourcePager->releasePage(pOverlayPage->getSourcePage());
+   }
+   else
+   {
+      map<uint64_t, Block>::iterator foundBlock = mBlocks.find(pOverlayPage->getBlockKey());
+      if (foundBlock != mBlocks.end() && foundBlock->second.mLeases > 0)
+      {
+         --foundBlock->second.mLeases;
+      }
+
+      trimBlocks();
+   }
+
+   delete pOverlayPage;
+}
+
+int DeltaOverlayPager::getSupportedRequestVersion() const
+{
+   // unmodified rows are paged by the original pager, so tiled requests are supported when it supports them
+   return (mpSourcePager == NULL ? 1 : mpSourcePager->getSupportedRequestVersion());
+}
+
+bool DeltaOverlayPager::isModified() const
+{
+   mta::MutexLock lock(mMutex);
+   return mBlocks.empty() == false;
+}
+
+uint64_t DeltaOverlayPager::getModifiedBytes() const
+{
+   mta::MutexLock lock(mMutex);
+   return static_cast<uint64_t>(mBlocks.size()) * mBlockBytes;
+}
+
+bool DeltaOverlayPager::readSourceBlock(unsigned int firstRow, unsigned int numRows, unsigned int band, char* pData)
+{
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(mpRaster->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   DimensionDescriptor startBand = pDescriptor->getActiveBand(mInterleave == BSQ ? band : 0);
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setInterleaveFormat(mInterleave);
+   pRequest->setRows(pDescriptor->getActiveRow(firstRow), pDescriptor->getActiveRow(firstRow + numRows - 1), numRows);
+   if (mInterleave == BSQ)
+   {
+      pRequest->setBands(startBand, startBand, 1);
+   }
+   pRequest->polish(pDescriptor);
+
+   // the original pager may return fewer rows than requested, so copy each page's rows
+   unsigned int row = 0;
+   while (row < numRows)
+   {
+      RasterPage* pPage = mpSourcePager->getPage(pRequest.get(), pDescriptor->getActiveRow(firstRow + row),
+         pDescriptor->getActiveColumn(0), startBand);
+      if (pPage == NULL)
+      {
+         return false;
+      }
+
+      const char* pSource = reinterpret_cast<const char*>(pPage->getRawData());
+      unsigned int pageRows = pPage->getNumRows();
+      unsigned int pageColumns = pPage->getNumColumns();
+      size_t sourceRowBytes = mRowBytes + pPage->getInterlineBytes();
+      if (pSource == NULL || pageRows == 0 || (pageColumns != 0 && pageColumns != mColumnCount))
+      {
+         mpSourcePager->releasePage(pPage);
+         return false;
+      }
+
+      for (unsigned int pageRow = 0; pageRow < pageRows && row < numRows; ++pageRow, ++row)
+      {
+         memcpy(pData + row * mRowBytes, pSource + pageRow * sourceRowBytes, mRowBytes);
+      }
+
+      mpSourcePager->releasePage(pPage);
+   }
+
+   return true;
+}
+
+bool DeltaOverlayPager::loadBlock(Block& block)
+{
+   if (block.mpData != NULL)
+   {
+      return true;
+   }
+
+   ArrayResource<char> pData(static_cast<int>(mBlockBytes), true);
+   if (pData.get() == NULL || block.mFileOffset < 0 ||
+      mSpillFile.seek(block.mFileOffset, SEEK_SET) != block.mFileOffset ||
+      mSpillFile.read(pData.get(), mBlockBytes) != static_cast<int64_t>(mBlockBytes))
+   {
+      return false;
+   }
+
+   block.mpData = pData.release();
+   mMemoryBytes += mBlockBytes;
+   return true;
+}
+
+void DeltaOverlayPager::trimBlocks()
+{
+   while (mMemoryBytes > mMemoryLimit)
+   {
+      map<uint64_t, Block>::iterator oldestBlock = mBlocks.end();
+      for (map<uint64_t, Block>::iterator iter = mBlocks.begin(); iter != mBlocks.end(); ++iter)
+      {
+         if (iter->second.mpData != NULL && iter->second.mLeases == 0 &&
+            (oldestBlock == mBlocks.end() || iter->second.mLastUse < oldestBlock->second.mLastUse))
+         {
+            oldestBlock = iter;
+         }
+      }
+
+      // leased blocks stay in memory, so the limit may temporarily be exceeded
+      if (oldestBlock == mBlocks.end())
+      {
+         break;
+      }
+
+      if (mSpillFilename.empty())
+      {
+         const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+         string tempPath;
+         if (pTempPath != NULL)
+         {
+            tempPath = pTempPath->getFullPathAndName();
+         }
+
+         char* pTempFilename = tempnam(tempPath.c_str(), "DO");
+         if (pTempFilename == NULL)
+         {
+            break;
+         }
+         mSpillFilename = pTempFilename;
+         free(pTempFilename);
+
+         if (mSpillFile.open(mSpillFilename, O_RDWR | O_CREAT | O_BINARY | O_TRUNC, S_IREAD | S_IWRITE) == false)
+         {
+            break;
+         }
+      }
+
+      // a block keeps its place in the file so it is overwritten when it is written again
+      Block& block = oldestBlock->second;
+      if (block.mFileOffset < 0)
+      {
+         block.mFileOffset = mSpillFileSize;
+         mSpillFileSize += mBlockBytes;
+      }
+
+      if (mSpillFile.seek(block.mFileOffset, SEEK_SET) != block.mFileOffset ||
+         mSpillFile.write(block.mpData, mBlockBytes) != static_cast<int64_t>(mBlockBytes))
+      {
+         break;
+      }
+
+      delete [] block.mpData;
+      block.mpData = NULL;
+      mMemoryBytes -= mBlockBytes;
+   }
+}
@@ -0,0 +1,115 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef DELTAOVERLAYPAGER_H
+#define DELTAOVERLAYPAGER_H
+
+#include "ConfigurationSettings.h"
+#include "DMutex.h"
+#include "FileResource.h"
+#include "RasterPager.h"
+#include "TypesFile.h"
+
+#include <map>
+#include <string>
+
+class RasterElement;
+
+/**
+ * Provides writable access to on-disk read-only data without copying it.
+ *
+ * The data is divided into blocks of whole rows, one band at a time for BSQ data.
+ * A block is copied from the original pager the first time it is requested for
+ * writing and every later request for its rows is served from the copy. Requests
+ * for rows which have not been modified are passed to the original pager, so the
+ * memory and disk space used only grow with the modified area.
+ *
+ * Modified blocks are kept in memory up to getSettingMemoryLimit() bytes. Beyond
+ * that, the least recently used blocks which are not leased are written to a file
+ * in the temporary directory and read back when they are next requested.
+ *
+ * Reading the data through the element flattens the modifications, so exporting
+ * the element or saving it in a session writes the modified data.
+ */
+class DeltaOverlayPager : public RasterPager
+{
+public:
+   SETTING(MemoryLimit, DeltaOverlayPager, unsigned int, 256 * 1024 * 1024)
+
+   /**
+    * Creates an overlay of a pager.
+    *
+    * @param pRaster
+    *        The element whose data is paged.
+    * @param pSourcePager
+    *        The pager which reads the original data. The overlay does not take ownership
+    *        of the pager, which must exist until the overlay is destroyed.
+    */
+   DeltaOverlayPager(RasterElement* pRaster, RasterPager* pSourcePager);
+
+   virtual ~DeltaOverlayPager();
+
+   RasterPage* getPage(DataRequest* pOriginalRequest, DimensionDescriptor startRow,
+      DimensionDescriptor startColumn, DimensionDescriptor startBand);
+
+   void releasePage(RasterPage* pPage);
+
+   int getSupportedRequestVersion() const;
+
+   /**
+    * Returns \c true if any block has been requested for writing.
+    */
+   bool isModified() const;
+
+   /**
+    * Returns the number of bytes in the modified blocks.
+    */
+   uint64_t getModifiedBytes() const;
+
+private:
+   DeltaOverlayPager(const DeltaOverlayPager& rhs);
+   DeltaOverlayPager& operator=(const DeltaOverlayPager& rhs);
+
+   struct Block
+   {
+      char* mpData;
+      int64_t mFileOffset;
+      unsigned int mLeases;
+      unsigned int mLastUse;
+   };
+
+   bool readSourceBlock(unsigned int firstRow, unsigned int numRows, unsigned int band, char* pData);
+   bool loadBlock(Block& block);
+   void trimBlocks();
+
+   RasterElement* const mpRaster;
+   RasterPager* const mpSourcePager;
+   InterleaveFormatType mInterleave;
+   unsigned int mRowCount;
+   unsigned int mColumnCount;
+   unsigned int mBandCount;
+   unsigned int mBytesPerElement;
+   size_t mRowBytes;
+   unsigned int mBlockRows;
+   unsigned int mBlocksPerBand;
+   size_t mBlockBytes;
+
+   std::map<uint64_t, Block> mBlocks;
+   size_t mMemoryBytes;
+   size_t mMemoryLimit;
+   unsigned int mBlockUses;
+
+   std::string mSpillFilename;
+   LargeFileResource mSpillFile;
+   int64_t mSpillFileSize;
+
+   mutable mta::DMutex mMutex;
+};
+
+#endif
@@ -0,0 +1,358 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "DimensionMap.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+using namespace std;
+
+DimensionMap::DimensionMap() :
+   mSize(0),
+   mVectorValid(false)
+{}
+
+DimensionMap::DimensionMap(const DimensionMap& rhs) :
+   mRuns(rhs.mRuns),
+   mSize(rhs.mSize),
+   mVectorValid(false)
+{
+   for (int type = 0; type < NUMBER_TYPE_COUNT; ++type)
+   {
+      mLookups[type] = rhs.mLookups[type];
+   }
+}
+
+DimensionMap::~DimensionMap()
+{}
+
+DimensionMap& DimensionMap::operator=(const DimensionMap& rhs)
+{
+   if (this != &rhs)
+   {
+      mRuns = rhs.mRuns;
+      mSize = rhs.mSize;
+      for (int type = 0; type < NUMBER_TYPE_COUNT; ++type)
+      {
+         mLookups[type] = rhs.mLookups[type];
+      }
+
+      vector<DimensionDescriptor>().swap(mVector);
+      mVectorValid = false;
+   }
+
+   return *this;
+}
+
+void DimensionMap::set(const vector<DimensionDescriptor>& descriptors)
+{
+   clear();
+
+   for (vector<DimensionDescriptor>::size_type i = 0; i < descriptors.size(); ++i)
+   {
+      Sequence numbers[NUMBER_TYPE_COUNT];
+      for (int type = 0; type < NUMBER_TYPE_COUNT; ++type)
+      {
+         numbers[type] = getSequence(descriptors[i], static_cast<NumberType>(type));
+      }
+
+      // Extend the last run if every number continues its sequence
+      if (mRuns.empty() == false)
+      {
+         Run run = mRuns.back();
+         bool extended = true;
+         for (int type = 0; type < NUMBER_TYPE_COUNT && extended; ++type)
+         {
+            extended = extend(run.mNumbers[type], run.mCount, numbers[type]);
+         }
+
+         if (extended)
+         {
+            ++run.mCount;
+            mRuns.back() = run;
+            continue;
+         }
+      }
+
+      Run run;
+      run.mIndex = static_cast<unsigned int>(i);
+      run.mCount = 1;
+      for (int type = 0; type < NUMBER_TYPE_COUNT; ++type)
+      {
+         run.mNumbers[type] = numbers[type];
+      }
+
+      mRuns.push_back(run);
+   }
+
+   mSize = static_cast<unsigned int>(descriptors.size());
+   for (int type = 0; type < NUMBER_TYPE_COUNT; ++type)
+   {
+      buildLookup(static_cast<NumberType>(type));
+   }
+}
+
+void DimensionMap::clear()
+{
+   vector<Run>().swap(mRuns);
+   mSize = 0;
+   for (int type = 0; type < NUMBER_TYPE_COUNT; ++type)
+   {
+      mLookups[type] = Lookup();
+   }
+
+   vector<DimensionDescriptor>().swap(mVector);
+   mVectorValid = false;
+}
+
+unsigned int DimensionMap::size() const
+{
+   return mSize;
+}
+
+bool DimensionMap::empty() const
+{
+   return mSize == 0;
+}
+
+unsigned int DimensionMap::getRunCount() const
+{
+   return static_cast<unsigned int>(mRuns.size());
+}
+
+DimensionDescriptor DimensionMap::get(unsigned int index) const
+{
+   if (index >= mSize)
+   {
+      return DimensionDescriptor();
+   }
+
+   // Find the last run which starts at or before the index
+   vector<Run>::size_type first = 0;
+   vector<Run>::size_type last = mRuns.size();
+   while (last - first > 1)
+   {
+      vector<Run>::size_type middle = first + (last - first) / 2;
+      if (mRuns[middle].mIndex <= index)
+      {
+         first = middle;
+      }
+      else
+      {
+         last = middle;
+      }
+   }
+
+   const Run& run = mRuns[first];
+   return getDescriptor(run, index - run.mIndex);
+}
+
+DimensionDescriptor DimensionMap::findOriginal(unsigned int originalNumber) const
+{
+   return find(ORIGINAL, originalNumber);
+}
+
+DimensionDescriptor DimensionMap::findOnDisk(unsigned int onDiskNumber) const
+{
+   return find(ON_DISK, onDiskNumber);
+}
+
+DimensionDescriptor DimensionMap::findActive(unsigned int activeNumber) const
+{
+   return find(ACTIVE, activeNumber);
+}
+
+const vector<DimensionDescriptor>& DimensionMap::getVector() const
+{
+   mta::MutexLock lock(mVectorMutex);
+   if (mVectorValid == false)
+   {
+      mVector.clear();
+      mVector.reserve(mSize);
+      for (vector<Run>::const_iterator run = mRuns.begin(); run != mRuns.end(); ++run)
+      {
+         for (unsigned int offset = 0; offset < run->mCount; ++offset)
+         {
+            mVector.push_back(getDescriptor(*run, offset));
+         }
+      }
+
+      mVectorValid = true;
+   }
+
+   return mVector;
+}
+
+bool DimensionMap::operator==(const vector<DimensionDescriptor>& descriptors) const
+{
+   if (descriptors.size() != mSize)
+   {
+      return false;
+   }
+
+   vector<DimensionDescriptor>::size_type i = 0;
+   for (vector<Run>::const_iterator run = mRuns.begin(); run != mRuns.end(); ++run)
+   {
+      for (unsigned int offset = 0; offset < run->mCount; ++offset, ++i)
+      {
+         if (getDescriptor(*run, offset) != descriptors[i])
+         {
+            return false;
+         }
+      }
+   }
+
+   return true;
+}
+
+bool DimensionMap::operator!=(const vector<DimensionDescriptor>& descriptors) const
+{
+   return !(*this == descriptors);
+}
+
+DimensionMap::Sequence DimensionMap::getSequence(const DimensionDescriptor& descriptor, NumberType type)
+{
+   // The number is stored even when it is not valid so the descriptor can be recreated exactly
+   Sequence sequence;
+   sequence.mStep = 0;
+   switch (type)
+   {
+   case ORIGINAL:
+      sequence.mStart = descriptor.getOriginalNumber();
+      sequence.mValid = descriptor.isOriginalNumberValid();
+      break;
+   case ON_DISK:
+      sequence.mStart = descriptor.getOnDiskNumber();
+      sequence.mValid = descriptor.isOnDiskNumberValid();
+      break;
+   default:
+      sequence.mStart = descriptor.getActiveNumber();
+      sequence.mValid = descriptor.isActiveNumberValid();
+      break;
+   }
+
+   return sequence;
+}
+
+bool DimensionMap::extend(Sequence& sequence, unsigned int count, const Sequence& next)
+{
+   if (sequence.mValid != next.mValid)
+   {
+      return false;
+   }
+
+   if (count == 1)
+   {
+      // The second number determines the step of the run
+      int64_t step = static_cast<int64_t>(next.mStart) - static_cast<int64_t>(sequence.mStart);
+      if (step > numeric_limits<int>::max() || step < numeric_limits<int>::min())
+      {
+         return false;
+      }
+
+      sequence.mStep = static_cast<int>(step);
+      return true;
+   }
+
+   return static_cast<int64_t>(sequence.mStart) + static_cast<int64_t>(sequence.mStep) * count ==
+      static_cast<int64_t>(next.mStart);
+}
+
+unsigned int DimensionMap::getNumber(const Sequence& sequence, unsigned int offset)
+{
+   return static_cast<unsigned int>(static_cast<int64_t>(sequence.mStart) +
+      static_cast<int64_t>(sequence.mStep) * offset);
+}
+
+DimensionDescriptor DimensionMap::getDescriptor(const Run& run, unsigned int offset)
+{
+   DimensionDescriptor descriptor;
+   descriptor.setOriginalNumber(getNumber(run.mNumbers[ORIGINAL], offset));
+   descriptor.setOriginalNumberValid(run.mNumbers[ORIGINAL].mValid);
+   descriptor.setOnDiskNumber(getNumber(run.mNumbers[ON_DISK], offset));
+   descriptor.setOnDiskNumberValid(run.mNumbers[ON_DISK].mValid);
+   descriptor.setActiveNumber(getNumber(run.mNumbers[ACTIVE], offset));
+   descriptor.setActiveNumberValid(run.mNumbers[ACTIVE].mValid);
+   return descriptor;
+}
+
+void DimensionMap::buildLookup(NumberType type)
+{
+   vector<pair<pair<unsigned int, unsigned int>, unsigned int> > ranges;
+   for (vector<Run>::size_type i = 0; i < mRuns.size(); ++i)
+   {
+      const Sequence& sequence = mRuns[i].mNumbers[type];
+      if (sequence.mValid)
+      {
+         unsigned int first = sequence.mStart;
+         unsigned int last = getNumber(sequence, mRuns[i].mCount - 1);
+         ranges.push_back(make_pair(make_pair(min(first, last), max(first, last)), static_cast<unsigned int>(i)));
+      }
+   }
+
+   sort(ranges.begin(), ranges.end());
+
+   Lookup& lookup = mLookups[type];
+   lookup = Lookup();
+   lookup.mMinimums.reserve(ranges.size());
+   lookup.mMaximums.reserve(ranges.size());
+   lookup.mRuns.reserve(ranges.size());
+   for (vector<pair<pair<unsigned int, unsigned int>, unsigned int> >::const_iterator range = ranges.begin();
+      range != ranges.end(); ++range)
+   {
+      lookup.mMinimums.push_back(range->first.first);
+      lookup.mMaximums.push_back(lookup.mMaximums.empty() ? range->first.second :
+         max(lookup.mMaximums.back(), range->first.second));
+      lookup.mRuns.push_back(range->second);
+   }
+}
+
+DimensionDescriptor DimensionMap::find(NumberType type, unsigned int number) const
+{
+   const Lookup& lookup = mLookups[type];
+   vector<unsigned int>::size_type candidate =
+      upper_bound(lookup.mMinimums.begin(), lookup.mMinimums.end(), number) - lookup.mMinimums.begin();
+
+   // Several runs only contain the number if the runs overlap, so the earliest one in the map is returned
+   const Run* pBestRun = NULL;
+   unsigned int bestOffset = 0;
+   while (candidate > 0 && lookup.mMaximums[candidate - 1] >= number)
+   {
+      --candidate;
+      const Run& run = mRuns[lookup.mRuns[candidate]];
+      const Sequence& sequence = run.mNumbers[type];
+      int64_t difference = static_cast<int64_t>(number) - static_cast<int64_t>(sequence.mStart);
+
+      int64_t offset = -1;
+      if (sequence.mStep == 0)
+      {
+         offset = (difference == 0 ? 0 : -1);
+      }
+      else if (difference % sequence.mStep == 0)
+      {
+         offset = difference / sequence.mStep;
+      }
+
+      if (offset >= 0 && offset < run.mCount && (pBestRun == NULL || run.mIndex < pBestRun->mIndex))
+      {
+         pBestRun = &run;
+         bestOffset = static_cast<unsigned int>(offset);
+      }
+   }
+
+   if (pBestRun == NULL)
+   {
+      return DimensionDescriptor();
+   }
+
+   return getDescriptor(*pBestRun, bestOffset);
+}
@@ -0,0 +1,145 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef DIMENSIONMAP_H
+#define DIMENSIONMAP_H
+
+#include "DimensionDescriptor.h"
+#include "DMutex.h"
+
+#include <vector>
+
+/**
+ * Stores the rows, columns or bands of a descriptor as runs of descriptors whose
+ * original, on-disk and active numbers are each arithmetic sequences.
+ *
+ * A full dimension, a subset and a skip factored subset are each a single run, so
+ * a million row descriptor takes a few dozen bytes instead of megabytes and the
+ * descriptor at an index or with a given original, on-disk or active number is
+ * found in O(log runs) time instead of with a linear scan.
+ *
+ * The vector of descriptors is only created when it is requested for compatibility
+ * with the public interfaces, and it is kept until the map is next changed so the
+ * returned reference remains valid for as long as the vector it replaces was.
+ */
+class DimensionMap
+{
+public:
+   DimensionMap();
+   DimensionMap(const DimensionMap& rhs);
+   ~DimensionMap();
+
+   DimensionMap& operator=(const DimensionMap& rhs);
+
+   /**
+    * Replaces the contents of the map.
+    *
+    * @param descriptors
+    *        The descriptors in active order.
+    */
+   void set(const std::vector<DimensionDescriptor>& descriptors);
+
+   /**
+    * Removes all descriptors from the map.
+    */
+   void clear();
+
+   /**
+    * Returns the number of descriptors.
+    */
+   unsigned int size() const;
+
+   /**
+    * Returns \c true if the map has no descriptors.
+    */
+   bool empty() const;
+
+   /**
+    * Returns the number of runs used to store the descriptors.
+    */
+   unsigned int getRunCount() const;
+
+   /**
+    * Returns the descriptor at an index, or an invalid descriptor if the index is out of range.
+    */
+   DimensionDescriptor get(unsigned int index) const;
+
+   /**
+    * Returns the first descriptor with a valid original number equal to \c originalNumber,
+    * or an invalid descriptor if there is none.
+    */
+   DimensionDescriptor findOriginal(unsigned int originalNumber) const;
+
+   /**
+    * Returns the first descriptor with a valid on-disk number equal to \c onDiskNumber,
+    * or an invalid descriptor if there is none.
+    */
+   DimensionDescriptor findOnDisk(unsigned int onDiskNumber) const;
+
+   /**
+    * Returns the first descriptor with a valid active number equal to \c activeNumber,
+    * or an invalid descriptor if there is none.
+    */
+   DimensionDescriptor findActive(unsigned int activeNumber) const;
+
+   /**
+    * Returns the descriptors as a vector, creating it on the first call after the map changes.
+    */
+   const std::vector<DimensionDescriptor>& getVector() const;
+
+   /**
+    * Compares the map with a vector of descriptors without creating the map's vector.
+    */
+   bool operator==(const std::vector<DimensionDescriptor>& descriptors) const;
+   bool operator!=(const std::vector<DimensionDescriptor>& descriptors) const;
+
+private:
+   enum NumberType { ORIGINAL, ON_DISK, ACTIVE, NUMBER_TYPE_COUNT };
+
+   struct Sequence
+   {
+      unsigned int mStart;
+      int mStep;
+      bool mValid;
+   };
+
+   struct Run
+   {
+      unsigned int mIndex;
+      unsigned int mCount;
+      Sequence mNumbers[NUMBER_TYPE_COUNT];
+   };
+
+   // The runs sorted by their smallest number with the largest number of any run up to each entry,
+   // so the runs which may contain a number are the ones before the upper bound of the number
+   // whose running maximum is at least the number
+   struct Lookup
+   {
+      std::vector<unsigned int> mMinimums;
+      std::vector<unsigned int> mMaximums;
+      std::vector<unsigned int> mRuns;
+   };
+
+   static Sequence getSequence(const DimensionDescriptor& descriptor, NumberType type);
+   static bool extend(Sequence& sequence, unsigned int count, const Sequence& next);
+   static unsigned int getNumber(const Sequence& sequence, unsigned int offset);
+   static DimensionDescriptor getDescriptor(const Run& run, unsigned int offset);
+   void buildLookup(NumberType type);
+   DimensionDescriptor find(NumberType type, unsigned int number) const;
+
+   std::vector<Run> mRuns;
+   unsigned int mSize;
+   Lookup mLookups[NUMBER_TYPE_COUNT];
+
+   mutable std::vector<DimensionDescriptor> mVector;
+   mutable bool mVectorValid;
+   mutable mta::DMutex mVectorMutex;
+};
+
+#endif
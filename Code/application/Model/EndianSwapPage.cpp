@@ -8,56 +8,139 @@
  */
 
 #include "EndianSwapPage.h"
-#include "Endian.h"
-#include "switchOnEncoding.h"
 #include "RasterUtilities.h"
 
-#include <stdlib.h>
+#include <algorithm>
 #include <string.h>
 
-EndianSwapPage::EndianSwapPage(void* pSrcData, EncodingType encoding, unsigned int rows, unsigned int columns,
-                               unsigned int bytesPerRow, unsigned int interlineBytes, unsigned char* pEndOfSegment) :
-   mData(rows * bytesPerRow), mRows(rows), mColumns(columns)
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENDIAN_SWAP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
 {
-   if (interlineBytes == 0)
+   template<size_t N>
+   void copyAndSwapScalar(const unsigned char* pSrc, unsigned char* pDest, size_t count)
    {
-      // if there are no interline bytes, then we can do this more efficiently
-      unsigned int count = bytesPerRow * rows;
-      if (pEndOfSegment != NULL)
+      for (size_t i = 0; i < count; ++i, pSrc += N, pDest += N)
       {
-         count = std::min(count, static_cast<unsigned int>(pEndOfSegment - static_cast<unsigned char*>(pSrcData)));
+         unsigned char value[N];
+         for (size_t byte = 0; byte < N; ++byte)
+         {
+            value[byte] = pSrc[N - 1 - byte];
+         }
+
+         memcpy(pDest, value, N);
       }
-      memcpy(&mData.front(), pSrcData, count);
    }
-   else
+
+#if defined(ENDIAN_SWAP_SSE2)
+   inline __m128i swapWords(__m128i value)
+   {
+      return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+   }
+
+   // Swaps 16 bytes of N byte values, reversing the order of the 16-bit words in each value
+   // with the shuffles and then swapping the bytes of each word
+   template<size_t N>
+   __m128i swapVector(__m128i value);
+
+   template<>
+   inline __m128i swapVector<2>(__m128i value)
+   {
+      return swapWords(value);
+   }
+
+   template<>
+   inline __m128i swapVector<4>(__m128i value)
    {
-      unsigned int destOffset = 0;
-      unsigned int srcOffset = 0;
-      for (unsigned int row = 0; row < rows; row++)
+      value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+      value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+      return swapWords(value);
+   }
+
+   template<>
+   inline __m128i swapVector<8>(__m128i value)
+   {
+      value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+      value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+      return swapWords(value);
+   }
+#endif
+
+   template<size_t N>
+   void copyAndSwapValues(const unsigned char* pSrc, unsigned char* pDest, size_t count)
+   {
+#if defined(ENDIAN_SWAP_SSE2)
+      const size_t valuesPerVector = 16 / N;
+      for (; count >= 4 * valuesPerVector; count -= 4 * valuesPerVector, pSrc += 64, pDest += 64)
       {
-         unsigned char* pStart = static_cast<unsigned char*>(pSrcData) + srcOffset;
-         unsigned int count = bytesPerRow;
-         if (pEndOfSegment != NULL)
-         {
-            if (pStart >= pEndOfSegment)
-            {
-               break;
-            }
-            count = std::min(count, static_cast<unsigned int>(pEndOfSegment - pStart));
-         }
-         memcpy(&mData[destOffset], pStart, count);
-         if (count < bytesPerRow)
+         __m128i value0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+         __m128i value1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 16));
+         __m128i value2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 32));
+         __m128i value3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 48));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), swapVector<N>(value0));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + 16), swapVector<N>(value1));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + 32), swapVector<N>(value2));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + 48), swapVector<N>(value3));
+      }
+
+      for (; count >= valuesPerVector; count -= valuesPerVector, pSrc += 16, pDest += 16)
+      {
+         __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest), swapVector<N>(value));
+      }
+#endif
+
+      copyAndSwapScalar<N>(pSrc, pDest, count);
+   }
+}
+
+EndianSwapPage::EndianSwapPage(void* pSrcData, EncodingType encoding, unsigned int rows, unsigned int columns,
+                               unsigned int bytesPerRow, unsigned int interlineBytes, unsigned char* pEndOfSegment) :
+   mData(static_cast<int>(rows * bytesPerRow), true),
+   mSize(0),
+   mRows(rows),
+   mColumns(columns)
+{
+   if (mData.get() == NULL)
+   {
+      return;
+   }
+
+   mSize = static_cast<size_t>(rows) * bytesPerRow;
+
+   // Copy and swap each row in one pass, stopping at the end of the mapped segment
+   size_t copied = 0;
+   const unsigned char* pStart = static_cast<const unsigned char*>(pSrcData);
+   for (unsigned int row = 0; row < rows; ++row)
+   {
+      size_t count = bytesPerRow;
+      if (pEndOfSegment != NULL)
+      {
+         if (pStart >= pEndOfSegment)
          {
             break;
          }
-         destOffset += count;
-         srcOffset += count + interlineBytes;
+         count = std::min(count, static_cast<size_t>(pEndOfSegment - pStart));
+      }
+
+      copyAndSwap(pStart, mData.get() + copied, count, encoding);
+      copied += count;
+      if (count < bytesPerRow)
+      {
+         break;
       }
+
+      pStart += count + interlineBytes;
    }
 
-   Endian endian;
-   switchOnComplexEncoding(encoding, endian.swapBuffer, &mData.front(),
-      mData.size() / RasterUtilities::bytesInEncoding(encoding));
+   // Only the rows past the end of the segment are cleared
+   if (copied < mSize)
+   {
+      memset(mData.get() + copied, 0, mSize - copied);
+   }
 }
 
 EndianSwapPage::~EndianSwapPage()
@@ -66,7 +149,7 @@ EndianSwapPage::~EndianSwapPage()
 
 void* EndianSwapPage::getRawData()
 {
-   return &mData.front();
+   return mData.get();
 }
 
 unsigned int EndianSwapPage::getNumRows()
@@ -88,3 +171,46 @@ unsigned int EndianSwapPage::getInterlineBytes()
 {
    return 0;
 }
+
+size_t EndianSwapPage::getSize() const
+{
+   return mSize;
+}
+
+void EndianSwapPage::copyAndSwap(const void* pSrc, void* pDest, size_t bytes, EncodingType encoding)
+{
+   const unsigned char* pSrcBytes = static_cast<const unsigned char*>(pSrc);
+   unsigned char* pDestBytes = static_cast<unsigned char*>(pDest);
+
+   // Complex values are swapped as pairs of their component values
+   size_t valueSize = RasterUtilities::bytesInEncoding(encoding);
+   if (encoding == INT4SCOMPLEX || encoding == FLT8COMPLEX)
+   {
+      valueSize /= 2;
+   }
+
+   size_t count = 0;
+   switch (valueSize)
+   {
+   case 2:
+      count = bytes / 2;
+      copyAndSwapValues<2>(pSrcBytes, pDestBytes, count);
+      break;
+   case 4:
+      count = bytes / 4;
+      copyAndSwapValues<4>(pSrcBytes, pDestBytes, count);
+      break;
+   case 8:
+      count = bytes / 8;
+      copyAndSwapValues<8>(pSrcBytes, pDestBytes, count);
+      break;
+   default:
+      break;
+   }
+
+   size_t swapped = count * valueSize;
+   if (swapped < bytes && pSrcBytes != pDestBytes)
+   {
+      memcpy(pDestBytes + swapped, pSrcBytes + swapped, bytes - swapped);
+   }
+}
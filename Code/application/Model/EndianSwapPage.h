@@ -10,10 +10,17 @@
 #ifndef ENDIANSWAPPAGE_H
 #define ENDIANSWAPPAGE_H
 
+#include "ObjectResource.h"
 #include "RasterPage.h"
 #include "TypesFile.h"
-#include <vector>
 
+#include <stddef.h>
+
+/**
+ * A page holding a native byte order copy of non-native data.
+ *
+ * Each row is copied and swapped in a single pass so the data is only read once.
+ */
 class EndianSwapPage : public RasterPage
 {
 public:
@@ -49,8 +56,32 @@ public:
    unsigned int getNumBands();
    unsigned int getInterlineBytes();
 
+   /**
+    * Returns the number of bytes of data in the page.
+    */
+   size_t getSize() const;
+
+   /**
+    * Copies data and reverses the byte order of each value.
+    *
+    * The real and imaginary parts of complex values are swapped separately. SSE2
+    * instructions are used when they are available.
+    *
+    * @param pSrc
+    *        The data to copy.
+    * @param pDest
+    *        The destination of the swapped data. This may be the same as \c pSrc to swap in place,
+    *        but the buffers must not otherwise overlap.
+    * @param bytes
+    *        The number of bytes to copy. Any bytes after the last whole value are copied unchanged.
+    * @param encoding
+    *        The data type of the values.
+    */
+   static void copyAndSwap(const void* pSrc, void* pDest, size_t bytes, EncodingType encoding);
+
 private:
-   std::vector<char> mData;
+   ArrayResource<char> mData;
+   size_t mSize;
    unsigned int mRows;
    unsigned int mColumns;
 };
@@ -26,14 +26,22 @@
 #include "RasterElement.h"
 #include "RasterFileDescriptor.h"
 
+#include <QtCore/QFile>
+#include <QtCore/QString>
+
 #include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
 using namespace std;
 
 MemoryMappedPager::MemoryMappedPager() :
    mbUseDataDescriptor(true),
    mpDataDescriptor(NULL),
    mSwapEndian(false),
-   mWritable(false)
+   mWritable(false),
+   mSwappedPageBytes(0),
+   mSwappedPageCacheSize(0),
+   mSwappedPageUses(0)
 {
    setName("MemoryMappedPager");
    setCopyright("Copyright (2005) by Ball Aerospace & Technologies Corp.");
@@ -55,6 +63,38 @@ namespace
          delete pMatrix;
       }
    };
+
+   // Number of bytes mapped at a time when a file is converted to native byte order
+   const size_t sConversionBlockSize = 16 * 1024 * 1024;
+}
+
+bool MemoryMappedPager::SwappedPageKey::operator<(const SwappedPageKey& rhs) const
+{
+   if (mpMatrix != rhs.mpMatrix)
+   {
+      return mpMatrix < rhs.mpMatrix;
+   }
+   if (mRow != rhs.mRow)
+   {
+      return mRow < rhs.mRow;
+   }
+   if (mColumn != rhs.mColumn)
+   {
+      return mColumn < rhs.mColumn;
+   }
+   if (mBand != rhs.mBand)
+   {
+      return mBand < rhs.mBand;
+   }
+   if (mNumRows != rhs.mNumRows)
+   {
+      return mNumRows < rhs.mNumRows;
+   }
+   if (mNumColumns != rhs.mNumColumns)
+   {
+      return mNumColumns < rhs.mNumColumns;
+   }
+   return mBytesPerRow < rhs.mBytesPerRow;
 }
 
 MemoryMappedPager::~MemoryMappedPager()
@@ -84,7 +124,19 @@ MemoryMappedPager::~MemoryMappedPager()
    }
    mCurrentlyLeasedPages.clear();
 
+   for (map<SwappedPageKey, SwappedPage>::iterator iter = mSwappedPages.begin(); iter != mSwappedPages.end(); ++iter)
+   {
+      delete iter->second.mpPage;
+   }
+   mSwappedPages.clear();
+   mSwappedPageKeys.clear();
+
    for_each(mMatrices.begin(), mMatrices.end(), MemoryMappedMatrixDeleter());
+
+   for (vector<string>::const_iterator iter = mConvertedFiles.begin(); iter != mConvertedFiles.end(); ++iter)
+   {
+      remove(iter->c_str());
+   }
 }
 
 bool MemoryMappedPager::getInputSpecification(PlugInArgList *&argList)
@@ -225,6 +277,7 @@ bool MemoryMappedPager::execute(PlugInArgList* pInputArgList, PlugInArgList* pOu
          EndianType srcEndian = pFileDescriptor->getEndian();
          mSwapEndian = (srcEndian != Endian::getSystemEndian() && pDescriptor->getBytesPerElement() > 1);
 
+         vector<string> filenames;
          const std::vector<const Filename*>& bandFiles = pFileDescriptor->getBandFiles();
          if (!mWritable && !bandFiles.empty())
          {
@@ -236,6 +289,7 @@ bool MemoryMappedPager::execute(PlugInArgList* pInputArgList, PlugInArgList* pOu
             {
                const Filename* pFilename = *iter;
                VERIFY(pFilename != NULL);
+               filenames.push_back(pFilename->getFullPathAndName());
                mMatrices.push_back(new MemoryMappedMatrix(pFilename->getFullPathAndName(),
                   pFileDescriptor->getHeaderBytes() + pFileDescriptor->getPrelineBytes() +
                      pFileDescriptor->getPrebandBytes(),
@@ -258,6 +312,7 @@ bool MemoryMappedPager::execute(PlugInArgList* pInputArgList, PlugInArgList* pOu
             //     will return the original filename, and it should be opened read only (!isWritable() == true)
             //  3) the accessor is for a single file, and is read-write.  getFullPathAndName()
             //     will return a temporary filename, which should be opened read-write (!isWritable() == false)
+            filenames.push_back(pFilename->getFullPathAndName());
             mMatrices.push_back(new MemoryMappedMatrix(pFilename->getFullPathAndName(),
                pFileDescriptor->getHeaderBytes() + pFileDescriptor->getPrelineBytes() +
                   pFileDescriptor->getPrebandBytes(),
@@ -270,6 +325,12 @@ bool MemoryMappedPager::execute(PlugInArgList* pInputArgList, PlugInArgList* pOu
                pFileDescriptor->getPostbandBytes() + pFileDescriptor->getPrebandBytes(),
                !mWritable));
          }
+
+         // If the conversion fails, the pages are swapped as they are accessed
+         if (mSwapEndian && MemoryMappedPager::getSettingConvertToNativeEndian())
+         {
+            convertToNativeEndian(filenames, pFileDescriptor);
+         }
       }
    }
    catch (...)
@@ -278,6 +339,8 @@ bool MemoryMappedPager::execute(PlugInArgList* pInputArgList, PlugInArgList* pOu
    } 
    VERIFY(!mMatrices.empty());
 
+   mSwappedPageCacheSize = MemoryMappedPager::getSettingSwappedPageCacheSize();
+
    return true;
 }
 
@@ -323,18 +386,18 @@ RasterPage* MemoryMappedPager::getPage(DataRequest* pOriginalRequest, DimensionD
       numColumns = pFileDescriptor->getColumnCount();
       interlineBytes = pFileDescriptor->getPostlineBytes() + pFileDescriptor->getPrelineBytes();
 
+      // Look the first rows and columns up by number so the descriptors' dimension vectors are not locked
+      // for every page
       DimensionDescriptor rowDim;
-      const vector<DimensionDescriptor>& rows = mpDataDescriptor->getRows();
-      if (rows.empty() == false)
+      if (mpDataDescriptor->getRowCount() > 0)
       {
-         rowDim = rows.front();
+         rowDim = mpDataDescriptor->getActiveRow(0);
       }
 
       DimensionDescriptor fileRowDim;
-      const vector<DimensionDescriptor>& fileRows = pFileDescriptor->getRows();
-      if (fileRows.empty() == false)
+      if (pFileDescriptor->getRowCount() > 0)
       {
-         fileRowDim = fileRows.front();
+         fileRowDim = pFileDescriptor->getOnDiskRow(0);
       }
 
       if (rowDim.isValid() && fileRowDim.isValid())
@@ -343,17 +406,15 @@ RasterPage* MemoryMappedPager::getPage(DataRequest* pOriginalRequest, DimensionD
       }
 
       DimensionDescriptor columnDim;
-      const vector<DimensionDescriptor>& columns = mpDataDescriptor->getColumns();
-      if (columns.empty() == false)
+      if (mpDataDescriptor->getColumnCount() > 0)
       {
-         columnDim = columns.front();
+         columnDim = mpDataDescriptor->getActiveColumn(0);
       }
 
       DimensionDescriptor fileColumnDim;
-      const vector<DimensionDescriptor>& fileColumns = pFileDescriptor->getColumns();
-      if (fileColumns.empty() == false)
+      if (pFileDescriptor->getColumnCount() > 0)
       {
-         fileColumnDim = fileColumns.front();
+         fileColumnDim = pFileDescriptor->getOnDiskColumn(0);
       }
 
       if (columnDim.isValid() && fileColumnDim.isValid())
@@ -389,8 +450,6 @@ RasterPage* MemoryMappedPager::getPage(DataRequest* pOriginalRequest, DimensionD
    segmentSize = concurrentRows * rowSize;
    numRows = concurrentRows;
 
-   //get the MemoryMappedMatrixView of a let segmentSize large
-   MemoryMappedMatrixView* pView = NULL;
    MemoryMappedMatrix* pMatrix = mMatrices.front();
    if (mMatrices.size() > 1)
    {
@@ -398,17 +457,57 @@ RasterPage* MemoryMappedPager::getPage(DataRequest* pOriginalRequest, DimensionD
       pMatrix = mMatrices[bandIndex];
    }
    VERIFYRV(pMatrix != NULL, NULL);
-   pView = pMatrix->getView(segmentSize);
-   VERIFYRV(pView != NULL, NULL);
 
-   //ask the MemoryMappedMatrixView for a pointer starting
-   //at the given location
    if (mMatrices.size() > 1)
    {
       bandIndex = 0;
    }
-   char* pRawCubePointer = reinterpret_cast<char*>(pView->getSegment(startRow.getActiveNumber() + offsetRow,
-                                                   startColumn.getActiveNumber() + offsetCol, bandIndex));
+   unsigned int segmentRow = startRow.getActiveNumber() + offsetRow;
+   unsigned int segmentColumn = startColumn.getActiveNumber() + offsetCol;
+
+   //a tiled page only contains the requested columns, the remainder of each row
+   //becomes interline bytes so the accessor steps over it
+   unsigned long dataBytesPerRow = rowSize - interlineBytes;
+   if (pOriginalRequest->getTiled() && interleave != BIL)
+   {
+      unsigned int columnBytes = bytesPerElement;
+      if (interleave == BIP)
+      {
+         columnBytes *= numBands;
+      }
+
+      numColumns = std::min(pOriginalRequest->getConcurrentColumns(),
+         mpDataDescriptor->getColumnCount() - startColumn.getActiveNumber());
+      dataBytesPerRow = numColumns * columnBytes;
+      interlineBytes = rowSize - dataBytesPerRow;
+   }
+
+   SwappedPageKey key;
+   key.mpMatrix = pMatrix;
+   key.mRow = segmentRow;
+   key.mColumn = segmentColumn;
+   key.mBand = bandIndex;
+   key.mNumRows = numRows;
+   key.mNumColumns = numColumns;
+   key.mBytesPerRow = dataBytesPerRow;
+   if (mSwapEndian)
+   {
+      map<SwappedPageKey, SwappedPage>::iterator cachedPage = mSwappedPages.find(key);
+      if (cachedPage != mSwappedPages.end())
+      {
+         ++cachedPage->second.mLeases;
+         cachedPage->second.mLastUse = ++mSwappedPageUses;
+         return cachedPage->second.mpPage;
+      }
+   }
+
+   //get the MemoryMappedMatrixView of a let segmentSize large
+   MemoryMappedMatrixView* pView = pMatrix->getView(segmentSize);
+   VERIFYRV(pView != NULL, NULL);
+
+   //ask the MemoryMappedMatrixView for a pointer starting
+   //at the given location
+   char* pRawCubePointer = reinterpret_cast<char*>(pView->getSegment(segmentRow, segmentColumn, bandIndex));
    if (pRawCubePointer == NULL)
    {
       return NULL;
@@ -427,12 +526,25 @@ RasterPage* MemoryMappedPager::getPage(DataRequest* pOriginalRequest, DimensionD
    if (mSwapEndian)
    {
       EndianSwapPage* pEndianPage = new EndianSwapPage(pPage->getRawData(), mpDataDescriptor->getDataType(),
-                                                       numRows, numColumns, rowSize - interlineBytes, interlineBytes,
+                                                       numRows, numColumns, dataBytesPerRow, interlineBytes,
                                                        pPage->getMemoryMappedMatrixView()->getEndOfSegment());
 
       pMatrix->release(pView);
       delete pPage;
 
+      if (pEndianPage->getRawData() == NULL)
+      {
+         delete pEndianPage;
+         return NULL;
+      }
+
+      SwappedPage& swappedPage = mSwappedPages[key];
+      swappedPage.mpPage = pEndianPage;
+      swappedPage.mLeases = 1;
+      swappedPage.mLastUse = ++mSwappedPageUses;
+      mSwappedPageKeys[pEndianPage] = key;
+      mSwappedPageBytes += pEndianPage->getSize();
+
       return pEndianPage;
    }
 
@@ -450,7 +562,19 @@ void MemoryMappedPager::releasePage(RasterPage* pPage)
 
    if (mSwapEndian)
    {
-      delete static_cast<EndianSwapPage*>(pPage);
+      // The page stays in the cache until it is the least recently used page when the cache is full
+      map<EndianSwapPage*, SwappedPageKey>::iterator foundKey =
+         mSwappedPageKeys.find(static_cast<EndianSwapPage*>(pPage));
+      if (foundKey != mSwappedPageKeys.end())
+      {
+         map<SwappedPageKey, SwappedPage>::iterator foundPage = mSwappedPages.find(foundKey->second);
+         if (foundPage != mSwappedPages.end() && foundPage->second.mLeases > 0)
+         {
+            --foundPage->second.mLeases;
+         }
+
+         trimSwappedPages();
+      }
    }
    else
    {
@@ -479,5 +603,163 @@ void MemoryMappedPager::releasePage(RasterPage* pPage)
 
 int MemoryMappedPager::getSupportedRequestVersion() const
 {
-   return 1;
+   return 2;
+}
+
+void MemoryMappedPager::trimSwappedPages()
+{
+   while (mSwappedPageBytes > mSwappedPageCacheSize)
+   {
+      map<SwappedPageKey, SwappedPage>::iterator oldestPage = mSwappedPages.end();
+      for (map<SwappedPageKey, SwappedPage>::iterator iter = mSwappedPages.begin();
+         iter != mSwappedPages.end(); ++iter)
+      {
+         if (iter->second.mLeases == 0 &&
+            (oldestPage == mSwappedPages.end() || iter->second.mLastUse < oldestPage->second.mLastUse))
+         {
+            oldestPage = iter;
+         }
+      }
+
+      // Leased pages are never removed, so the cache may temporarily exceed its size
+      if (oldestPage == mSwappedPages.end())
+      {
+         break;
+      }
+
+      EndianSwapPage* pPage = oldestPage->second.mpPage;
+      mSwappedPageBytes -= pPage->getSize();
+      mSwappedPageKeys.erase(pPage);
+      mSwappedPages.erase(oldestPage);
+      delete pPage;
+   }
+}
+
+bool MemoryMappedPager::convertToNativeEndian(const vector<string>& filenames,
+                                              const RasterFileDescriptor* pFileDescriptor)
+{
+   VERIFY(pFileDescriptor != NULL && filenames.size() == mMatrices.size());
+
+   string tempPath;
+   const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+   if (pTempPath != NULL)
+   {
+      tempPath = pTempPath->getFullPathAndName();
+   }
+
+   unsigned int headerBytes = pFileDescriptor->getHeaderBytes() + pFileDescriptor->getPrelineBytes() +
+      pFileDescriptor->getPrebandBytes();
+   unsigned int interlineBytes = pFileDescriptor->getPostlineBytes() + pFileDescriptor->getPrelineBytes();
+   unsigned int interbandBytes = pFileDescriptor->getPostbandBytes() + pFileDescriptor->getPrebandBytes();
+   unsigned int bands = (filenames.size() > 1 ? 1 : pFileDescriptor->getBandCount());
+
+   vector<MemoryMappedMatrix*> matrices;
+   bool success = true;
+   try
+   {
+      for (vector<string>::const_iterator filename = filenames.begin();
+         filename != filenames.end() && success; ++filename)
+      {
+         char* pTempFilename = tempnam(tempPath.c_str(), "MM");
+         if (pTempFilename == NULL)
+         {
+            success = false;
+            break;
+         }
+
+         string convertedFile = pTempFilename;
+         free(pTempFilename);
+
+         // The whole file is copied so the data is at the same offsets as in the original file
+         success = QFile::copy(QString::fromStdString(*filename), QString::fromStdString(convertedFile));
+         if (success)
+         {
+            mConvertedFiles.push_back(convertedFile);
+
+            MemoryMappedMatrix* pMatrix = new MemoryMappedMatrix(convertedFile, headerBytes,
+               pFileDescriptor->getInterleaveFormat(), mpDataDescriptor->getBytesPerElement(),
+               pFileDescriptor->getRowCount(), pFileDescriptor->getColumnCount(), bands, interlineBytes,
+               interbandBytes, false);
+            matrices.push_back(pMatrix);
+
+            success = swapFile(pMatrix, pFileDescriptor->getInterleaveFormat(), pFileDescriptor->getRowCount(),
+               pFileDescriptor->getColumnCount(), bands, interlineBytes, interbandBytes);
+         }
+      }
+   }
+   catch (...)
+   {
+      success = false;
+   }
+
+   if (success == false)
+   {
+      for_each(matrices.begin(), matrices.end(), MemoryMappedMatrixDeleter());
+      return false;
+   }
+
+   // The copies are private to this pager, so they are mapped read-write
+   for_each(mMatrices.begin(), mMatrices.end(), MemoryMappedMatrixDeleter());
+   mMatrices = matrices;
+   mSwapEndian = false;
+   mWritable = true;
+
+   return true;
+}
+
+bool MemoryMappedPager::swapFile(MemoryMappedMatrix* pMatrix, InterleaveFormatType interleave, unsigned int rows,
+                                 unsigned int columns, unsigned int bands, unsigned int interlineBytes,
+                                 unsigned int interbandBytes)
+{
+   VERIFY(pMatrix != NULL && mpDataDescriptor != NULL);
+
+   // Each row of a BSQ band, or each row of all bands otherwise, is contiguous on disk
+   EncodingType encoding = mpDataDescriptor->getDataType();
+   size_t rowBytes = static_cast<size_t>(columns) * mpDataDescriptor->getBytesPerElement();
+   unsigned int bandCount = 1;
+   if (interleave == BSQ)
+   {
+      bandCount = bands;
+   }
+   else
+   {
+      rowBytes *= bands;
+   }
+
+   size_t rowStride = rowBytes + interlineBytes;
+   size_t blockRows = max(sConversionBlockSize / rowStride, static_cast<size_t>(1));
+   MemoryMappedMatrixView* pView = pMatrix->getView(blockRows * rowStride + interbandBytes);
+   VERIFY(pView != NULL);
+
+   bool success = true;
+   for (unsigned int band = 0; band < bandCount && success; ++band)
+   {
+      unsigned char* pBlock = NULL;
+      unsigned int blockRow = 0;
+      for (unsigned int row = 0; row < rows; ++row)
+      {
+         unsigned char* pRow = NULL;
+         if (pBlock != NULL)
+         {
+            pRow = pBlock + (row - blockRow) * rowStride;
+         }
+
+         if (pRow == NULL || pRow + rowBytes > pView->getEndOfSegment())
+         {
+            pBlock = pView->getSegment(row, 0, band);
+            blockRow = row;
+            pRow = pBlock;
+            if (pRow == NULL || pRow + rowBytes > pView->getEndOfSegment())
+            {
+               success = false;
+               break;
+            }
+         }
+
+         EndianSwapPage::copyAndSwap(pRow, pRow, rowBytes, encoding);
+      }
+   }
+
+   pMatrix->release(pView);
+   return success;
 }
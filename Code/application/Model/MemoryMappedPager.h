@@ -12,19 +12,37 @@
 #ifndef MEMORYMAPPEDPAGER_H
 #define MEMORYMAPPEDPAGER_H
 
+#include "ConfigurationSettings.h"
 #include "RasterPagerShell.h"
 #include "DMutex.h"
+#include "TypesFile.h"
 
 #include <vector>
 #include <map>
+#include <string>
 
+class EndianSwapPage;
 class RasterDataDescriptor;
+class RasterFileDescriptor;
 class MemoryMappedPage;
 class MemoryMappedMatrix;
 
+/**
+ * Provides access to on-disk data by memory mapping the file.
+ *
+ * Pages of data whose byte order differs from the system's are copied and swapped
+ * into native order. The swapped pages are kept in a cache of
+ * getSettingSwappedPageCacheSize() bytes so data which is accessed repeatedly is
+ * only swapped once. If getSettingConvertToNativeEndian() is \c true, the files are
+ * instead copied to the temporary directory and swapped once when the pager is
+ * executed, so the data is mapped directly and may be written.
+ */
 class MemoryMappedPager : public RasterPagerShell
 {
 public:
+   SETTING(SwappedPageCacheSize, MemoryMappedPager, unsigned int, 64 * 1024 * 1024)
+   SETTING(ConvertToNativeEndian, MemoryMappedPager, bool, false)
+
    MemoryMappedPager();
    ~MemoryMappedPager();
 
@@ -44,6 +62,32 @@ public:
 
 
 private:
+   struct SwappedPageKey
+   {
+      bool operator<(const SwappedPageKey& rhs) const;
+
+      MemoryMappedMatrix* mpMatrix;
+      unsigned int mRow;
+      unsigned int mColumn;
+      unsigned int mBand;
+      unsigned int mNumRows;
+      unsigned int mNumColumns;
+      unsigned long mBytesPerRow;
+   };
+
+   struct SwappedPage
+   {
+      EndianSwapPage* mpPage;
+      unsigned int mLeases;
+      unsigned int mLastUse;
+   };
+
+   bool convertToNativeEndian(const std::vector<std::string>& filenames,
+      const RasterFileDescriptor* pFileDescriptor);
+   bool swapFile(MemoryMappedMatrix* pMatrix, InterleaveFormatType interleave, unsigned int rows,
+      unsigned int columns, unsigned int bands, unsigned int interlineBytes, unsigned int interbandBytes);
+   void trimSwappedPages();
+
    bool mbUseDataDescriptor;
    const RasterDataDescriptor* mpDataDescriptor;
    bool mSwapEndian;
@@ -55,6 +99,16 @@ private:
    
    mta::DMutex                           mMutex;
 
+   // Swapped pages, including the leased ones, by the location and size of their data
+   std::map<SwappedPageKey, SwappedPage> mSwappedPages;
+   std::map<EndianSwapPage*, SwappedPageKey> mSwappedPageKeys;
+   size_t mSwappedPageBytes;
+   size_t mSwappedPageCacheSize;
+   unsigned int mSwappedPageUses;
+
+   // Native byte order copies of the files, which are deleted with the pager
+   std::vector<std::string> mConvertedFiles;
+
    bool mWritable;
 };
 
@@ -121,7 +121,7 @@ const vector<int>& RasterDataDescriptorImp::getBadValues() const
 
 void RasterDataDescriptorImp::setRows(const vector<DimensionDescriptor>& rows)
 {
-   if (rows != mRows)
+   if (mRows != rows)
    {
       //ensure the provided values have correct active numbers
       bool anyActiveNumberSet = false;
@@ -160,15 +160,15 @@ void RasterDataDescriptorImp::setRows(const vector<DimensionDescriptor>& rows)
             VERIFYNRV(!anyOnDiskNumberSet);
          }
       }
-      mRows = rows;
+      mRows.set(rows);
       mRowSkipFactor = skipFactor - 1;
-      notify(SIGNAL_NAME(RasterDataDescriptor, RowsChanged), boost::any(mRows));
+      notify(SIGNAL_NAME(RasterDataDescriptor, RowsChanged), boost::any(rows));
    }
 }
 
 const vector<DimensionDescriptor>& RasterDataDescriptorImp::getRows() const
 {
-   return mRows;
+   return mRows.getVector();
 }
 
 unsigned int RasterDataDescriptorImp::getRowSkipFactor() const
@@ -178,20 +178,7 @@ unsigned int RasterDataDescriptorImp::getRowSkipFactor() const
 
 DimensionDescriptor RasterDataDescriptorImp::getOriginalRow(unsigned int originalNumber) const
 {
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mRows.begin(); iter != mRows.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isOriginalNumberValid() == true)
-      {
-         if (descriptor.getOriginalNumber() == originalNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-
-   return DimensionDescriptor();
+   return mRows.findOriginal(originalNumber);
 }
 
 DimensionDescriptor RasterDataDescriptorImp::getOnDiskRow(unsigned int onDiskNumber) const
@@ -205,25 +192,14 @@ DimensionDescriptor RasterDataDescriptorImp::getOnDiskRow(unsigned int onDiskNum
          return getActiveRow(descriptor.getActiveNumber());
       }
    }
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mRows.begin(); iter != mRows.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isOnDiskNumberValid() == true)
-      {
-         if (descriptor.getOnDiskNumber() == onDiskNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-   return DimensionDescriptor();
+
+   return mRows.findOnDisk(onDiskNumber);
 }
 
 DimensionDescriptor RasterDataDescriptorImp::getActiveRow(unsigned int activeNumber) const
 {
    VERIFYRV(activeNumber < mRows.size(), DimensionDescriptor());
-   return mRows[activeNumber];
+   return mRows.get(activeNumber);
 }
 
 unsigned int RasterDataDescriptorImp::getRowCount() const
@@ -233,7 +209,7 @@ unsigned int RasterDataDescriptorImp::getRowCount() const
 
 void RasterDataDescriptorImp::setColumns(const vector<DimensionDescriptor>& columns)
 {
-   if (columns != mColumns)
+   if (mColumns != columns)
    {
       //ensure the provided values have correct active numbers
       bool anyActiveNumberSet = false;
@@ -272,15 +248,15 @@ void RasterDataDescriptorImp::setColumns(const vector<DimensionDescriptor>& colu
             VERIFYNRV(!anyOnDiskNumberSet);
          }
       }
-      mColumns = columns;
+      mColumns.set(columns);
       mColumnSkipFactor = skipFactor - 1;
-      notify(SIGNAL_NAME(RasterDataDescriptor, ColumnsChanged), boost::any(mColumns));
+      notify(SIGNAL_NAME(RasterDataDescriptor, ColumnsChanged), boost::any(columns));
    }
 }
 
 const vector<DimensionDescriptor>& RasterDataDescriptorImp::getColumns() const
 {
-   return mColumns;
+   return mColumns.getVector();
 }
 
 unsigned int RasterDataDescriptorImp::getColumnSkipFactor() const
@@ -290,20 +266,7 @@ unsigned int RasterDataDescriptorImp::getColumnSkipFactor() const
 
 DimensionDescriptor RasterDataDescriptorImp::getOriginalColumn(unsigned int originalNumber) const
 {
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mColumns.begin(); iter != mColumns.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isOriginalNumberValid() == true)
-      {
-         if (descriptor.getOriginalNumber() == originalNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-
-   return DimensionDescriptor();
+   return mColumns.findOriginal(originalNumber);
 }
 
 DimensionDescriptor RasterDataDescriptorImp::getOnDiskColumn(unsigned int onDiskNumber) const
@@ -317,25 +280,14 @@ DimensionDescriptor RasterDataDescriptorImp::getOnDiskColumn(unsigned int onDisk
          return getActiveColumn(descriptor.getActiveNumber());
       }
    }
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mColumns.begin(); iter != mColumns.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isOnDiskNumberValid() == true)
-      {
-         if (descriptor.getOnDiskNumber() == onDiskNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-   return DimensionDescriptor();
+
+   return mColumns.findOnDisk(onDiskNumber);
 }
 
 DimensionDescriptor RasterDataDescriptorImp::getActiveColumn(unsigned int activeNumber) const
 {
    VERIFYRV(activeNumber < mColumns.size(), DimensionDescriptor());
-   return mColumns[activeNumber];
+   return mColumns.get(activeNumber);
 }
 
 unsigned int RasterDataDescriptorImp::getColumnCount() const
@@ -345,7 +297,7 @@ unsigned int RasterDataDescriptorImp::getColumnCount() const
 
 void RasterDataDescriptorImp::setBands(const vector<DimensionDescriptor>& bands)
 {
-   if (bands != mBands)
+   if (mBands != bands)
    {
       //ensure the provided values have correct active numbers
       bool anyActiveNumberSet = false;
@@ -375,32 +327,19 @@ void RasterDataDescriptorImp::setBands(const vector<DimensionDescriptor>& bands)
             VERIFYNRV(!anyOnDiskNumberSet);
          }
       }
-      mBands = bands;
-      notify(SIGNAL_NAME(RasterDataDescriptor, BandsChanged), boost::any(mBands));
+      mBands.set(bands);
+      notify(SIGNAL_NAME(RasterDataDescriptor, BandsChanged), boost::any(bands));
    }
 }
 
 const vector<DimensionDescriptor>& RasterDataDescriptorImp::getBands() const
 {
-   return mBands;
+   return mBands.getVector();
 }
 
 DimensionDescriptor RasterDataDescriptorImp::getOriginalBand(unsigned int originalNumber) const
 {
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mBands.begin(); iter != mBands.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isOriginalNumberValid() == true)
-      {
-         if (descriptor.getOriginalNumber() == originalNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-
-   return DimensionDescriptor();
+   return mBands.findOriginal(originalNumber);
 }
 
 DimensionDescriptor RasterDataDescriptorImp::getOnDiskBand(unsigned int onDiskNumber) const
@@ -414,25 +353,14 @@ DimensionDescriptor RasterDataDescriptorImp::getOnDiskBand(unsigned int onDiskNu
          return getActiveBand(descriptor.getActiveNumber());
       }
    }
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mBands.begin(); iter != mBands.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isOnDiskNumberValid() == true)
-      {
-         if (descriptor.getOnDiskNumber() == onDiskNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-   return DimensionDescriptor();
+
+   return mBands.findOnDisk(onDiskNumber);
 }
 
 DimensionDescriptor RasterDataDescriptorImp::getActiveBand(unsigned int activeNumber) const
 {
    VERIFYRV(activeNumber < mBands.size(), DimensionDescriptor());
-   return mBands[activeNumber];
+   return mBands.get(activeNumber);
 }
 
 unsigned int RasterDataDescriptorImp::getBandCount() const
@@ -585,9 +513,7 @@ DataDescriptor* RasterDataDescriptorImp::copy(const string& name, DataElement* p
       pDescriptor->setValidDataTypes(mValidDataTypes);
       pDescriptor->setInterleaveFormat(mInterleave);
       pDescriptor->setBadValues(mBadValues);
-      pDescriptor->setRows(mRows);
-      pDescriptor->setColumns(mColumns);
-      pDescriptor->setBands(mBands);
+      copyDimensions(pDescriptor);
       pDescriptor->setXPixelSize(mXPixelSize);
       pDescriptor->setYPixelSize(mYPixelSize);
       pDescriptor->setUnits(&mUnits);
@@ -610,9 +536,7 @@ DataDescriptor* RasterDataDescriptorImp::copy(const string& name, const vector<s
       pDescriptor->setValidDataTypes(mValidDataTypes);
       pDescriptor->setInterleaveFormat(mInterleave);
       pDescriptor->setBadValues(mBadValues);
-      pDescriptor->setRows(mRows);
-      pDescriptor->setColumns(mColumns);
-      pDescriptor->setBands(mBands);
+      copyDimensions(pDescriptor);
       pDescriptor->setXPixelSize(mXPixelSize);
       pDescriptor->setYPixelSize(mYPixelSize);
       pDescriptor->setUnits(&mUnits);
@@ -626,6 +550,25 @@ DataDescriptor* RasterDataDescriptorImp::copy(const string& name, const vector<s
    return pDescriptor;
 }
 
+void RasterDataDescriptorImp::copyDimensions(RasterDataDescriptor* pDescriptor) const
+{
+   // Copy the maps directly when possible so the copy does not create the vectors of either descriptor
+   RasterDataDescriptorImp* pDescriptorImp = dynamic_cast<RasterDataDescriptorImp*>(pDescriptor);
+   if (pDescriptorImp != NULL)
+   {
+      pDescriptorImp->mRows = mRows;
+      pDescriptorImp->mRowSkipFactor = mRowSkipFactor;
+      pDescriptorImp->mColumns = mColumns;
+      pDescriptorImp->mColumnSkipFactor = mColumnSkipFactor;
+      pDescriptorImp->mBands = mBands;
+      return;
+   }
+
+   pDescriptor->setRows(mRows.getVector());
+   pDescriptor->setColumns(mColumns.getVector());
+   pDescriptor->setBands(mBands.getVector());
+}
+
 bool RasterDataDescriptorImp::clone(const DataDescriptor* pDescriptor)
 {
    const RasterDataDescriptorImp* pRasterDescriptor = dynamic_cast<const RasterDataDescriptorImp*>(pDescriptor);
@@ -756,12 +699,12 @@ bool RasterDataDescriptorImp::toXml(XMLWriter* pXml) const
 
       // Rows
       pXml->pushAddPoint(pXml->addElement("rows"));
-      XmlUtilities::serializeDimensionDescriptors("row", mRows, pXml);
+      XmlUtilities::serializeDimensionDescriptors("row", mRows.getVector(), pXml);
       pXml->popAddPoint();
 
       // Columns
       pXml->pushAddPoint(pXml->addElement("columns"));
-      XmlUtilities::serializeDimensionDescriptors("column", mColumns, pXml);
+      XmlUtilities::serializeDimensionDescriptors("column", mColumns.getVector(), pXml);
       pXml->popAddPoint();
 
       // Pixel size
@@ -778,7 +721,7 @@ bool RasterDataDescriptorImp::toXml(XMLWriter* pXml) const
 
       // Bands
       pXml->pushAddPoint(pXml->addElement("bands"));
-      XmlUtilities::serializeDimensionDescriptors("band", mBands, pXml);
+      XmlUtilities::serializeDimensionDescriptors("band", mBands.getVector(), pXml);
       pXml->popAddPoint();
 
       // Gray Band
@@ -898,15 +841,21 @@ bool RasterDataDescriptorImp::fromXml(DOMNode* pDocument, unsigned int version)
       }
       else if (XMLString::equals(pChild->getNodeName(), X("rows")))
       {
-         XmlUtilities::deserializeDimensionDescriptors("row", mRows, pChild);
+         vector<DimensionDescriptor> rows;
+         XmlUtilities::deserializeDimensionDescriptors("row", rows, pChild);
+         mRows.set(rows);
       }
       else if (XMLString::equals(pChild->getNodeName(), X("columns")))
       {
-         XmlUtilities::deserializeDimensionDescriptors("column", mColumns, pChild);
+         vector<DimensionDescriptor> columns;
+         XmlUtilities::deserializeDimensionDescriptors("column", columns, pChild);
+         mColumns.set(columns);
       }
       else if (XMLString::equals(pChild->getNodeName(), X("bands")))
       {
-         XmlUtilities::deserializeDimensionDescriptors("band", mBands, pChild);
+         vector<DimensionDescriptor> bands;
+         XmlUtilities::deserializeDimensionDescriptors("band", bands, pChild);
+         mBands.set(bands);
       }
       else if (XMLString::equals(pChild->getNodeName(), X("units")))
       {
@@ -12,12 +12,15 @@
 
 #include "DataDescriptorImp.h"
 #include "DimensionDescriptor.h"
+#include "DimensionMap.h"
 #include "TypesFile.h"
 #include "UnitsAdapter.h"
 
 #include <string>
 #include <vector>
 
+class RasterDataDescriptor;
+
 using XERCES_CPP_NAMESPACE_QUALIFIER DOMNode;
 
 class RasterDataDescriptorImp : public DataDescriptorImp
@@ -99,14 +102,16 @@ private:
    RasterDataDescriptorImp(const RasterDataDescriptorImp& rhs);
    RasterDataDescriptorImp& operator=(const RasterDataDescriptorImp& rhs);
 
+   void copyDimensions(RasterDataDescriptor* pDescriptor) const;
+
    EncodingType mDataType;
    std::vector<EncodingType> mValidDataTypes;
    InterleaveFormatType mInterleave;
    std::vector<int> mBadValues;
 
-   std::vector<DimensionDescriptor> mRows;
-   std::vector<DimensionDescriptor> mColumns;
-   std::vector<DimensionDescriptor> mBands;
+   DimensionMap mRows;
+   DimensionMap mColumns;
+   DimensionMap mBands;
 
    unsigned int mRowSkipFactor;
    unsigned int mColumnSkipFactor;
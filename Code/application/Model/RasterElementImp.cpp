@@ -15,6 +15,7 @@
 #include "ConvertToBsqPager.h"
 #include "DataAccessorImpl.h"
 #include "DataRequest.h"
+#include "DeltaOverlayPager.h"
 #include "DimensionDescriptor.h"
 #include "Executable.h"
 #include "FileResource.h"
@@ -38,8 +39,10 @@
 #include "SessionItemSerializer.h"
 #include "SessionManager.h"
 #include "StatisticsImp.h"
+#include "TraceSpan.h"
 #include "xmlwriter.h"
 
+#include <algorithm>
 #include <fstream>
 #include <limits>
 #include <boost/bind.hpp>
@@ -154,6 +157,7 @@ RasterElementImp::RasterElementImp(const DataDescriptorImp& descriptor, const st
    DataElementImp(descriptor, id),
    mpTerrain(NULL),
    mpPager(NULL),
+   mpOverlayPager(NULL),
    mpBipConverterPager(NULL),
    mpBilConverterPager(NULL),
    mpBsqConverterPager(NULL),
@@ -269,6 +273,7 @@ RasterElementImp::~RasterElementImp()
    delete mpBipConverterPager;
    delete mpBilConverterPager;
    delete mpBsqConverterPager;
+   delete mpOverlayPager;
 
    Service<PlugInManagerServices> pPluginManager;
    if (mpPager != NULL)
@@ -439,6 +444,26 @@ Statistics* RasterElementImp::getStatistics(DimensionDescriptor band) const
    return NULL;
 }
 
+void RasterElementImp::calculateStatistics(const vector<DimensionDescriptor>& bands, ComplexComponent component)
+{
+   vector<StatisticsImp*> statistics;
+   for (vector<DimensionDescriptor>::const_iterator band = bands.begin(); band != bands.end(); ++band)
+   {
+      map<DimensionDescriptor, StatisticsImp*>::const_iterator iter = mStatistics.find(*band);
+      if (iter != mStatistics.end() && iter->second != NULL &&
+         iter->second->areStatisticsCalculated(component) == false &&
+         find(statistics.begin(), statistics.end(), iter->second) == statistics.end())
+      {
+         statistics.push_back(iter->second);
+      }
+   }
+
+   if (statistics.size() > 1)
+   {
+      StatisticsImp::calculateBandStatistics(statistics, component);
+   }
+}
+
 
 bool RasterElementImp::toXml(XMLWriter* pXml) const
 {
@@ -1265,6 +1290,13 @@ bool RasterElementImp::setPager(RasterPager* pPager)
       return false;
    }
 
+   // modifications made through the overlay are discarded with the pager they overlay
+   {
+      mta::MutexLock lock(mOverlayMutex);
+      delete mpOverlayPager;
+      mpOverlayPager = NULL;
+   }
+
    if (mpPager != NULL)
    {
       //destroy the old plugins first
@@ -1330,7 +1362,9 @@ bool RasterElementImp::serialize(SessionItemSerializer& serializer) const
       return false;
    }
 
-   if (mModified || pDescriptor->getFileDescriptor() == NULL)
+   // on-disk read-only data which has been modified is saved by reading it through the overlay
+   if (mModified || pDescriptor->getFileDescriptor() == NULL ||
+      (mpOverlayPager != NULL && mpOverlayPager->isModified()))
    {
 //#pragma message(__FILE__ "(" STRING(__LINE__) ") : warning : Modify this to only save when necessary (tclarke)")
       //mModified = false;
@@ -1435,6 +1469,12 @@ bool RasterElementImp::deserialize(SessionItemDeserializer& deserializer)
       {
          deserializer.nextBlock();
 
+         // modified on-disk read-only data is restored into a temporary file
+         if (pDescriptor->getProcessingLocation() == ON_DISK_READ_ONLY)
+         {
+            pDescriptor->setProcessingLocation(ON_DISK);
+         }
+
          if (!createDefaultPager())
          {
             // should never have on-disk read-only data saved to the session
@@ -1515,22 +1555,34 @@ void RasterElementImp::incrementDataAccessor(DataAccessorImpl& da)
    //release the previous page
    if (da.mpRasterPage != NULL)
    {
+      TraceSpan span("raster", "Release Page");
       da.mpRasterPager->releasePage(da.mpRasterPage);
    }
 
    //update the DataAccessor properties
    da.mAccessorRow += da.mCurrentRow;
    da.mCurrentRow = 0;
-   da.mAccessorColumn = da.mpRequest->getStartColumn().getActiveNumber();
+   if (da.mTiled)
+   {
+      //a tiled page starts at the current pixel
+      da.mAccessorColumn += da.mCurrentColumn;
+      da.mCurrentColumn = 0;
+      da.mColumnOffset = 0;
+   }
+   else
+   {
+      da.mAccessorColumn = da.mpRequest->getStartColumn().getActiveNumber();
+   }
    da.mAccessorBand = da.mpRequest->getStartBand().getActiveNumber();
 
    //get a new raster page loaded into memory,
    //the only thing different from the previous page that we requested
-   //should be the startRow.
+   //should be the startRow and, for a tiled request, the startColumn.
 
    //request the same number of concurrentRows, cols, and bands
    //that we originally requested in the getDataAccessor()
    //call
+   TraceSpan span("raster", "Get Page");
    RasterPage* pPage = NULL;
    if (da.mAccessorRow < pDescriptor->getRowCount() &&
       da.mAccessorColumn < pDescriptor->getColumnCount() &&
@@ -1573,6 +1625,12 @@ void RasterElementImp::incrementDataAccessor(DataAccessorImpl& da)
          da.mConcurrentColumns = numBlockColumns;
          da.mConcurrentBands = numBlockBands;
          da.updateDataSizes(pDescriptor->getBytesPerElement(), numBlockInterlineBytes);
+         if (span.isActive())
+         {
+            span.setBytes(static_cast<uint64_t>(da.mConcurrentRows) * numBlockColumns * numBlockBands *
+               pDescriptor->getBytesPerElement());
+            span.setDetail(getName());
+         }
       }
    }
    else
@@ -1634,7 +1692,24 @@ DataAccessor RasterElementImp::getDataAccessor(DataRequest* pRequestIn)
    InterleaveFormatType sourceInterleave = pDescriptor->getInterleaveFormat();
    InterleaveFormatType interleave = pRequest->getInterleaveFormat();
 
-   RasterPager* pPager = mpPager;
+   // writing to on-disk read-only data copies the modified blocks instead of failing,
+   // the lock keeps accessors created on other threads from creating a second overlay
+   RasterPager* pBasePager = mpPager;
+   {
+      mta::MutexLock lock(mOverlayMutex);
+      if (pRequest->getWritable() && interleave == sourceInterleave && mpOverlayPager == NULL &&
+         pDescriptor->getProcessingLocation() == ON_DISK_READ_ONLY)
+      {
+         mpOverlayPager = new DeltaOverlayPager(dynamic_cast<RasterElement*>(this), mpPager);
+      }
+
+      if (mpOverlayPager != NULL)
+      {
+         pBasePager = mpOverlayPager;
+      }
+   }
+
+   RasterPager* pPager = pBasePager;
    if (interleave == BIP && (sourceInterleave == BSQ || sourceInterleave == BIL))
    {
       if (mpBipConverterPager == NULL)
@@ -1669,6 +1744,13 @@ DataAccessor RasterElementImp::getDataAccessor(DataRequest* pRequestIn)
       return DataAccessor(NULL, NULL);
    }
 
+   if (pRequest->getTiled() && (interleave == BIL || pPager->getSupportedRequestVersion() < 2))
+   {
+      //pagers which can not provide tiles and BIL pages, whose bands are interleaved
+      //within each row, fall back to row strips
+      pRequest->setTiled(false);
+   }
+
    if (pPager->getSupportedRequestVersion() < pRequest->getRequestVersion(pDescriptor))
    {
       return DataAccessor(NULL, NULL);
@@ -1688,7 +1770,7 @@ DataAccessor RasterElementImp::getDataAccessor(DataRequest* pRequestIn)
          unsigned int numPageBands = pPage->getNumBands();
          unsigned int numPageInterlineBytes = pPage->getInterlineBytes();
 
-         if (pPager == mpPager)
+         if (pPager == pBasePager)
          {
             if (numPageColumns == 0)
             {
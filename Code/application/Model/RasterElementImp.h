@@ -14,6 +14,7 @@
 #include "DataAccessor.h"
 #include "DataElementImp.h"
 #include "DimensionDescriptor.h"
+#include "DMutex.h"
 #include "SafePtr.h"
 #include "StatisticsImp.h"
 #include "TypesFile.h"
@@ -21,6 +22,8 @@
 
 #include <vector>
 
+class DeltaOverlayPager;
+
 class RasterElementImp : public DataElementImp
 {
 public:
@@ -43,6 +46,13 @@ public:
 
    Statistics* getStatistics(DimensionDescriptor band) const;
 
+   /**
+    * Calculates the statistics of the bands which have not been calculated in one pass over the data.
+    *
+    * @see StatisticsImp::calculateBandStatistics()
+    */
+   void calculateStatistics(const std::vector<DimensionDescriptor>& bands, ComplexComponent component);
+
    RasterElement *createChip(DataElement *pParent, const std::string &appendName,
       const std::vector<DimensionDescriptor>& selectedRows,
       const std::vector<DimensionDescriptor>& selectedColumns,
@@ -176,6 +186,8 @@ private:
    std::string mTempFilename;
 
    RasterPager* mpPager;
+   DeltaOverlayPager* mpOverlayPager;
+   mta::DMutex mOverlayMutex;
    RasterPager* mpBipConverterPager;
    RasterPager* mpBilConverterPager;
    RasterPager* mpBsqConverterPager;
@@ -233,6 +245,11 @@ private:
    { \
       return impClass::getStatistics(pBand); \
    } \
+   void calculateStatistics(const std::vector<DimensionDescriptor>& bands, \
+      ComplexComponent component = COMPLEX_MAGNITUDE) \
+   { \
+      impClass::calculateStatistics(bands, component); \
+   } \
    RasterElement *createChip(DataElement *pParent, \
       const std::string &appendName, \
       const std::vector<DimensionDescriptor> &selectedRows, \
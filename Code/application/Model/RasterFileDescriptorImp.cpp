@@ -159,7 +159,7 @@ InterleaveFormatType RasterFileDescriptorImp::getInterleaveFormat() const
 
 void RasterFileDescriptorImp::setRows(const vector<DimensionDescriptor>& rows)
 {
-   if (rows == mRows)
+   if (mRows == rows)
    {
       return;
    }
@@ -191,55 +191,29 @@ void RasterFileDescriptorImp::setRows(const vector<DimensionDescriptor>& rows)
          lastActiveNumber = rows[count].getActiveNumber();
       }
    }
-   mRows = rows;
-   notify(SIGNAL_NAME(RasterFileDescriptor, RowsChanged), boost::any(mRows));
+   mRows.set(rows);
+   notify(SIGNAL_NAME(RasterFileDescriptor, RowsChanged), boost::any(rows));
 }
 
 const vector<DimensionDescriptor>& RasterFileDescriptorImp::getRows() const
 {
-   return mRows;
+   return mRows.getVector();
 }
 
 DimensionDescriptor RasterFileDescriptorImp::getOriginalRow(unsigned int originalNumber) const
 {
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mRows.begin(); iter != mRows.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isOriginalNumberValid() == true)
-      {
-         if (descriptor.getOriginalNumber() == originalNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-
-   return DimensionDescriptor();
+   return mRows.findOriginal(originalNumber);
 }
 
 DimensionDescriptor RasterFileDescriptorImp::getOnDiskRow(unsigned int onDiskNumber) const
 {
    VERIFYRV(onDiskNumber < mRows.size(), DimensionDescriptor());
-   return mRows[onDiskNumber];
+   return mRows.get(onDiskNumber);
 }
 
 DimensionDescriptor RasterFileDescriptorImp::getActiveRow(unsigned int activeNumber) const
 {
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mRows.begin(); iter != mRows.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isActiveNumberValid() == true)
-      {
-         if (descriptor.getActiveNumber() == activeNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-
-   return DimensionDescriptor();
+   return mRows.findActive(activeNumber);
 }
 
 unsigned int RasterFileDescriptorImp::getRowCount() const
@@ -249,7 +223,7 @@ unsigned int RasterFileDescriptorImp::getRowCount() const
 
 void RasterFileDescriptorImp::setColumns(const vector<DimensionDescriptor>& columns)
 {
-   if (columns == mColumns)
+   if (mColumns == columns)
    {
       return;
    }
@@ -281,55 +255,29 @@ void RasterFileDescriptorImp::setColumns(const vector<DimensionDescriptor>& colu
          lastActiveNumber = columns[count].getActiveNumber();
       }
    }
-   mColumns = columns;
-   notify(SIGNAL_NAME(RasterFileDescriptor, ColumnsChanged), boost::any(mColumns));
+   mColumns.set(columns);
+   notify(SIGNAL_NAME(RasterFileDescriptor, ColumnsChanged), boost::any(columns));
 }
 
 const vector<DimensionDescriptor>& RasterFileDescriptorImp::getColumns() const
 {
-   return mColumns;
+   return mColumns.getVector();
 }
 
 DimensionDescriptor RasterFileDescriptorImp::getOriginalColumn(unsigned int originalNumber) const
 {
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mColumns.begin(); iter != mColumns.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isOriginalNumberValid() == true)
-      {
-         if (descriptor.getOriginalNumber() == originalNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-
-   return DimensionDescriptor();
+   return mColumns.findOriginal(originalNumber);
 }
 
 DimensionDescriptor RasterFileDescriptorImp::getOnDiskColumn(unsigned int onDiskNumber) const
 {
    VERIFYRV(onDiskNumber < mColumns.size(), DimensionDescriptor());
-   return mColumns[onDiskNumber];
+   return mColumns.get(onDiskNumber);
 }
 
 DimensionDescriptor RasterFileDescriptorImp::getActiveColumn(unsigned int activeNumber) const
 {
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mColumns.begin(); iter != mColumns.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isActiveNumberValid() == true)
-      {
-         if (descriptor.getActiveNumber() == activeNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-
-   return DimensionDescriptor();
+   return mColumns.findActive(activeNumber);
 }
 
 unsigned int RasterFileDescriptorImp::getColumnCount() const
@@ -339,7 +287,7 @@ unsigned int RasterFileDescriptorImp::getColumnCount() const
 
 void RasterFileDescriptorImp::setBands(const vector<DimensionDescriptor>& bands)
 {
-   if (bands == mBands)
+   if (mBands == bands)
    {
       return;
    }
@@ -362,55 +310,29 @@ void RasterFileDescriptorImp::setBands(const vector<DimensionDescriptor>& bands)
          lastActiveNumber = bands[count].getActiveNumber();
       }
    }
-   mBands = bands;
-   notify(SIGNAL_NAME(RasterFileDescriptor, BandsChanged), boost::any(mBands));
+   mBands.set(bands);
+   notify(SIGNAL_NAME(RasterFileDescriptor, BandsChanged), boost::any(bands));
 }
 
 const vector<DimensionDescriptor>& RasterFileDescriptorImp::getBands() const
 {
-   return mBands;
+   return mBands.getVector();
 }
 
 DimensionDescriptor RasterFileDescriptorImp::getOriginalBand(unsigned int originalNumber) const
 {
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mBands.begin(); iter != mBands.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isOriginalNumberValid() == true)
-      {
-         if (descriptor.getOriginalNumber() == originalNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-
-   return DimensionDescriptor();
+   return mBands.findOriginal(originalNumber);
 }
 
 DimensionDescriptor RasterFileDescriptorImp::getOnDiskBand(unsigned int onDiskNumber) const
 {
    VERIFYRV(onDiskNumber < mBands.size(), DimensionDescriptor());
-   return mBands[onDiskNumber];
+   return mBands.get(onDiskNumber);
 }
 
 DimensionDescriptor RasterFileDescriptorImp::getActiveBand(unsigned int activeNumber) const
 {
-   vector<DimensionDescriptor>::const_iterator iter;
-   for (iter = mBands.begin(); iter != mBands.end(); ++iter)
-   {
-      DimensionDescriptor descriptor = *iter;
-      if (descriptor.isActiveNumberValid() == true)
-      {
-         if (descriptor.getActiveNumber() == activeNumber)
-         {
-            return descriptor;
-         }
-      }
-   }
-
-   return DimensionDescriptor();
+   return mBands.findActive(activeNumber);
 }
 
 unsigned int RasterFileDescriptorImp::getBandCount() const
@@ -665,17 +587,17 @@ bool RasterFileDescriptorImp::toXml(XMLWriter* pXml) const
 
       // Rows
       pXml->pushAddPoint(pXml->addElement("rows"));
-      XmlUtilities::serializeDimensionDescriptors("row", mRows, pXml);
+      XmlUtilities::serializeDimensionDescriptors("row", mRows.getVector(), pXml);
       pXml->popAddPoint();
 
       // Columns
       pXml->pushAddPoint(pXml->addElement("columns"));
-      XmlUtilities::serializeDimensionDescriptors("column", mColumns, pXml);
+      XmlUtilities::serializeDimensionDescriptors("column", mColumns.getVector(), pXml);
       pXml->popAddPoint();
 
       // Bands
       pXml->pushAddPoint(pXml->addElement("bands"));
-      XmlUtilities::serializeDimensionDescriptors("band", mBands, pXml);
+      XmlUtilities::serializeDimensionDescriptors("band", mBands.getVector(), pXml);
       pXml->popAddPoint();
 
       // Pixel size
@@ -751,11 +673,15 @@ bool RasterFileDescriptorImp::fromXml(DOMNode* pDocument, unsigned int version)
       }
       else if (XMLString::equals(pChild->getNodeName(), X("rows")))
       {
-         XmlUtilities::deserializeDimensionDescriptors("row", mRows, pChild);
+         vector<DimensionDescriptor> rows;
+         XmlUtilities::deserializeDimensionDescriptors("row", rows, pChild);
+         mRows.set(rows);
       }
       else if (XMLString::equals(pChild->getNodeName(), X("columns")))
       {
-         XmlUtilities::deserializeDimensionDescriptors("column", mColumns, pChild);
+         vector<DimensionDescriptor> columns;
+         XmlUtilities::deserializeDimensionDescriptors("column", columns, pChild);
+         mColumns.set(columns);
       }
       else if (XMLString::equals(pChild->getNodeName(), X("bandFile")))
       {
@@ -773,7 +699,9 @@ bool RasterFileDescriptorImp::fromXml(DOMNode* pDocument, unsigned int version)
       }
       else if (XMLString::equals(pChild->getNodeName(), X("bands")))
       {
-         XmlUtilities::deserializeDimensionDescriptors("band", mBands, pChild);
+         vector<DimensionDescriptor> bands;
+         XmlUtilities::deserializeDimensionDescriptors("band", bands, pChild);
+         mBands.set(bands);
       }
       else if (XMLString::equals(pChild->getNodeName(), X("units")))
       {
@@ -11,6 +11,7 @@
 #define RASTERFILEDESCRIPTORIMP_H
 
 #include "DimensionDescriptor.h"
+#include "DimensionMap.h"
 #include "FileDescriptorImp.h"
 #include "GcpList.h"
 #include "UnitsAdapter.h"
@@ -110,9 +111,9 @@ private:
    unsigned int mBitsPerElement;
    InterleaveFormatType mInterleave;
 
-   std::vector<DimensionDescriptor> mRows;
-   std::vector<DimensionDescriptor> mColumns;
-   std::vector<DimensionDescriptor> mBands;
+   DimensionMap mRows;
+   DimensionMap mColumns;
+   DimensionMap mBands;
 
    double mXPixelSize;
    double mYPixelSize;
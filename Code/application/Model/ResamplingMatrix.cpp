@@ -0,0 +1,209 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "MultiThreadedAlgorithm.h"
+#include "Resampler.h"
+#include "ResamplingMatrix.h"
+
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+
+namespace
+{
+   struct ApplyInput
+   {
+      const ResamplingMatrix* mpMatrix;
+      const double* mpFromData;
+      double* mpToData;
+      unsigned int mFromSize;
+      unsigned int mToSize;
+      unsigned int mCount;
+   };
+
+   class ApplyThread : public mta::AlgorithmThread
+   {
+   public:
+      ApplyThread(const ApplyInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRange(getThreadRange(threadCount, input.mCount))
+      {}
+
+      void run()
+      {
+         for (int i = mRange.mFirst; i <= mRange.mLast; ++i)
+         {
+            mInput.mpMatrix->apply(mInput.mpFromData + static_cast<size_t>(i) * mInput.mFromSize,
+               mInput.mpToData + static_cast<size_t>(i) * mInput.mToSize);
+         }
+      }
+
+   private:
+      ApplyThread& operator=(const ApplyThread& rhs);
+
+      const ApplyInput& mInput;
+      mta::AlgorithmThread::Range mRange;
+   };
+
+   struct ApplyOutput
+   {
+      bool compileOverallResults(const vector<ApplyThread*>& threads)
+      {
+         return true;
+      }
+   };
+}
+
+ResamplingMatrix::ResamplingMatrix()
+{}
+
+ResamplingMatrix::~ResamplingMatrix()
+{}
+
+bool ResamplingMatrix::build(Resampler* pResampler, const vector<double>& fromWavelengths,
+                             const vector<double>& toWavelengths, string& errorMessage)
+{
+   clear();
+   VERIFY(pResampler != NULL);
+
+   // Resampling a unit spectrum gives the weights of one source value in every destination value
+   vector<vector<pair<unsigned int, double> > > rows(toWavelengths.size());
+   vector<double> fromData(fromWavelengths.size(), 0.0);
+   vector<double> toData;
+   vector<double> toFwhm;
+   vector<int> toBands;
+   for (unsigned int column = 0; column < fromWavelengths.size(); ++column)
+   {
+      fromData[column] = 1.0;
+      toData.clear();
+      toBands.clear();
+      bool success = pResampler->execute(fromData, toData, fromWavelengths, toWavelengths, toFwhm, toBands,
+         errorMessage);
+      fromData[column] = 0.0;
+      if (!success || toData.size() != toWavelengths.size())
+      {
+         return false;
+      }
+
+      for (unsigned int row = 0; row < toData.size(); ++row)
+      {
+         if (toData[row] != 0.0)
+         {
+            rows[row].push_back(make_pair(column, toData[row]));
+         }
+      }
+   }
+
+   mRowStarts.reserve(rows.size() + 1);
+   for (vector<vector<pair<unsigned int, double> > >::const_iterator row = rows.begin(); row != rows.end(); ++row)
+   {
+      mRowStarts.push_back(static_cast<unsigned int>(mColumns.size()));
+      for (vector<pair<unsigned int, double> >::const_iterator weight = row->begin(); weight != row->end(); ++weight)
+      {
+         mColumns.push_back(weight->first);
+         mWeights.push_back(weight->second);
+      }
+   }
+   mRowStarts.push_back(static_cast<unsigned int>(mColumns.size()));
+
+   mFromWavelengths = fromWavelengths;
+   mToWavelengths = toWavelengths;
+   return true;
+}
+
+void ResamplingMatrix::clear()
+{
+   mFromWavelengths.clear();
+   mToWavelengths.clear();
+   mRowStarts.clear();
+   mColumns.clear();
+   mWeights.clear();
+}
+
+bool ResamplingMatrix::isBuilt(const vector<double>& fromWavelengths, const vector<double>& toWavelengths) const
+{
+   return mRowStarts.empty() == false && fromWavelengths == mFromWavelengths && toWavelengths == mToWavelengths;
+}
+
+bool ResamplingMatrix::verify(Resampler* pResampler, const double* pFromData) const
+{
+   VERIFY(pResampler != NULL && pFromData != NULL && mRowStarts.empty() == false);
+
+   vector<double> fromData(pFromData, pFromData + mFromWavelengths.size());
+   vector<double> expected;
+   vector<double> toFwhm;
+   vector<int> toBands;
+   string errorMessage;
+   if (!pResampler->execute(fromData, expected, mFromWavelengths, mToWavelengths, toFwhm, toBands, errorMessage) ||
+      expected.size() != mToWavelengths.size())
+   {
+      return false;
+   }
+
+   vector<double> actual(mToWavelengths.size());
+   apply(pFromData, &actual[0]);
+
+   // Allow for the rounding differences of summing the weights in another order
+   double scale = 1.0;
+   for (vector<double>::const_iterator iter = fromData.begin(); iter != fromData.end(); ++iter)
+   {
+      scale = max(scale, fabs(*iter));
+   }
+
+   for (unsigned int i = 0; i < actual.size(); ++i)
+   {
+      bool actualNan = (actual[i] != actual[i]);
+      bool expectedNan = (expected[i] != expected[i]);
+      if (actualNan != expectedNan || (actualNan == false && fabs(actual[i] - expected[i]) > 1e-9 * scale))
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+void ResamplingMatrix::apply(const double* pFromData, unsigned int count, double* pToData) const
+{
+   VERIFYNRV(pFromData != NULL && pToData != NULL);
+   if (count == 0)
+   {
+      return;
+   }
+
+   ApplyInput input;
+   input.mpMatrix = this;
+   input.mpFromData = pFromData;
+   input.mpToData = pToData;
+   input.mFromSize = static_cast<unsigned int>(mFromWavelengths.size());
+   input.mToSize = static_cast<unsigned int>(mToWavelengths.size());
+   input.mCount = count;
+
+   ApplyOutput output;
+   mta::MultiThreadedAlgorithm<ApplyInput, ApplyOutput, ApplyThread>
+      alg(mta::getNumRequiredThreads(count), input, output, NULL);
+   alg.run();
+}
+
+void ResamplingMatrix::apply(const double* pFromData, double* pToData) const
+{
+   for (unsigned int row = 0; row + 1 < mRowStarts.size(); ++row)
+   {
+      double value = 0.0;
+      for (unsigned int i = mRowStarts[row]; i < mRowStarts[row + 1]; ++i)
+      {
+         value += mWeights[i] * pFromData[mColumns[i]];
+      }
+
+      pToData[row] = value;
+   }
+}
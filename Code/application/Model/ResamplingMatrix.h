@@ -0,0 +1,107 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef RESAMPLINGMATRIX_H
+#define RESAMPLINGMATRIX_H
+
+#include <string>
+#include <vector>
+
+class Resampler;
+
+/**
+ * The weights which resample spectra from one set of wavelengths to another.
+ *
+ * The resampling algorithms are linear in the data values, so resampling a
+ * spectrum is a multiplication by a matrix which only depends on the
+ * wavelengths. The matrix is measured by resampling a unit spectrum for each
+ * source wavelength with the Resampler plug-in and is stored sparsely since each
+ * resampled value only depends on a few nearby source values.
+ */
+class ResamplingMatrix
+{
+public:
+   ResamplingMatrix();
+   ~ResamplingMatrix();
+
+   /**
+    * Computes the weights with the current resampling algorithm.
+    *
+    * @param pResampler
+    *        The resampler plug-in.
+    * @param fromWavelengths
+    *        The wavelengths of the data to resample.
+    * @param toWavelengths
+    *        The wavelengths to resample the data to.
+    * @param errorMessage
+    *        Populated with the resampler's error message if the weights cannot
+    *        be computed.
+    *
+    * @return \c True if the weights were computed, \c false otherwise.
+    */
+   bool build(Resampler* pResampler, const std::vector<double>& fromWavelengths,
+      const std::vector<double>& toWavelengths, std::string& errorMessage);
+
+   /**
+    * Removes the weights.
+    */
+   void clear();
+
+   /**
+    * Queries whether the matrix resamples between the given wavelengths.
+    */
+   bool isBuilt(const std::vector<double>& fromWavelengths, const std::vector<double>& toWavelengths) const;
+
+   /**
+    * Checks that the matrix reproduces the resampler for a spectrum.
+    *
+    * This detects a resampling algorithm which is not linear or a change in the
+    * resampling options since the matrix was built.
+    *
+    * @param pResampler
+    *        The resampler plug-in.
+    * @param pFromData
+    *        The spectrum, with one value for each source wavelength.
+    *
+    * @return \c True if the matrix and the resampler produce the same values.
+    */
+   bool verify(Resampler* pResampler, const double* pFromData) const;
+
+   /**
+    * Resamples contiguous spectra on multiple threads.
+    *
+    * @param pFromData
+    *        The spectra to resample, with one value for each source wavelength.
+    * @param count
+    *        The number of spectra.
+    * @param pToData
+    *        Populated with the resampled spectra, with one value for each
+    *        destination wavelength.
+    */
+   void apply(const double* pFromData, unsigned int count, double* pToData) const;
+
+   /**
+    * Resamples a single spectrum.
+    */
+   void apply(const double* pFromData, double* pToData) const;
+
+private:
+   ResamplingMatrix(const ResamplingMatrix& rhs);
+   ResamplingMatrix& operator=(const ResamplingMatrix& rhs);
+
+   std::vector<double> mFromWavelengths;
+   std::vector<double> mToWavelengths;
+
+   // Compressed rows, one row for each destination wavelength
+   std::vector<unsigned int> mRowStarts;
+   std::vector<unsigned int> mColumns;
+   std::vector<double> mWeights;
+};
+
+#endif
@@ -78,6 +78,15 @@ namespace
    {
       copy(pSource, &pSource[count], dest.begin());
    }
+
+   template<typename T>
+   void copyOriginalAsDouble(T* pSource, unsigned int count, double* pDest)
+   {
+      copy(pSource, &pSource[count], pDest);
+   }
+
+   // The number of signatures read and resampled at a time, which bounds the memory used for the original values
+   const unsigned int sResampleBlockSize = 1024;
 }
 
 const double *SignatureLibraryImp::getOrdinateData(unsigned int index) const
@@ -204,6 +213,12 @@ bool SignatureLibraryImp::resample(const vector<double> &abscissa)
       return true;
    }
 
+   unsigned int numOriginal = mOriginalAbscissa.size();
+   if (numOriginal == 0)
+   {
+      return false;
+   }
+
    mResampledData.resize(numSigs * abscissa.size());
 
    DataAccessor da = mpOdre->getDataAccessor();
@@ -213,28 +228,75 @@ bool SignatureLibraryImp::resample(const vector<double> &abscissa)
       return false;
    }
 
-   vector<double> originalOrdinateData(mOriginalAbscissa.size());
+   // Resampling is linear in the ordinate values, so the same weights apply to every signature. Larger
+   // libraries measure the weights once and resample blocks of signatures with a parallel sparse multiply.
+   // Smaller libraries, and algorithms the weights cannot reproduce, call the resampler for each signature.
+   bool useMatrix = (numSigs > numOriginal);
+
+   vector<double> originalOrdinateData;
+   vector<double> fromData(numOriginal);
    vector<double> toData;
    vector<double> toFwhm;
    vector<int> toBands;
    string errorMessage;
-   for (unsigned int i = 0; i < mSignatures.size(); ++i)
-   {
-      switchOnEncoding(pDesc->getDataType(), getOriginalAsDouble, da->getRow(), mOriginalAbscissa.size(),
-         originalOrdinateData);
-      toData.clear();
-      toData.reserve(mAbscissa.size());
-      toBands.clear();
-      toBands.reserve(mAbscissa.size());
-      bool success = pResampler->execute(originalOrdinateData, toData, 
-         mOriginalAbscissa, abscissa, toFwhm, toBands, errorMessage);
-      if (!success || toData.size() != abscissa.size())
+   for (unsigned int first = 0; first < numSigs; first += sResampleBlockSize)
+   {
+      unsigned int count = min(sResampleBlockSize, numSigs - first);
+      originalOrdinateData.resize(count * numOriginal);
+      for (unsigned int i = 0; i < count; ++i)
       {
-         desample();
-         return false;
+         if (da.isValid() == false)
+         {
+            desample();
+            return false;
+         }
+
+         switchOnEncoding(pDesc->getDataType(), copyOriginalAsDouble, da->getRow(), numOriginal,
+            &originalOrdinateData[i * numOriginal]);
+         da->nextRow();
+      }
+
+      if (useMatrix && first == 0)
+      {
+         bool matrixValid = mResamplingMatrix.isBuilt(mOriginalAbscissa, abscissa) &&
+            mResamplingMatrix.verify(pResampler, &originalOrdinateData[0]);
+         if (matrixValid == false)
+         {
+            matrixValid = mResamplingMatrix.build(pResampler, mOriginalAbscissa, abscissa, errorMessage) &&
+               mResamplingMatrix.verify(pResampler, &originalOrdinateData[0]);
+         }
+
+         if (matrixValid == false)
+         {
+            mResamplingMatrix.clear();
+            useMatrix = false;
+         }
+      }
+
+      double* pResampledData = &mResampledData[first * abscissa.size()];
+      if (useMatrix)
+      {
+         mResamplingMatrix.apply(&originalOrdinateData[0], count, pResampledData);
+         continue;
+      }
+
+      for (unsigned int i = 0; i < count; ++i)
+      {
+         copy(&originalOrdinateData[i * numOriginal], &originalOrdinateData[(i + 1) * numOriginal],
+            fromData.begin());
+         toData.clear();
+         toData.reserve(abscissa.size());
+         toBands.clear();
+         toBands.reserve(abscissa.size());
+         bool success = pResampler->execute(fromData, toData, mOriginalAbscissa, abscissa, toFwhm, toBands,
+            errorMessage);
+         if (!success || toData.size() != abscissa.size())
+         {
+            desample();
+            return false;
+         }
+         std::copy(toData.begin(), toData.end(), &pResampledData[i * abscissa.size()]);
       }
-      std::copy(toData.begin(), toData.end(), &mResampledData[i*abscissa.size()]);
-      da->nextRow();
    }
 
    mAbscissa = abscissa;
@@ -13,6 +13,7 @@
 #include "AttachmentPtr.h"
 #include "LibrarySignatureAdapter.h"
 #include "RasterElement.h"
+#include "ResamplingMatrix.h"
 #include "SignatureSetImp.h"
 
 #include <map>
@@ -70,6 +71,7 @@ private:
    std::map<std::string, Signature *> mSignatureNames;
    std::vector<LibrarySignatureAdapter*> mSignatures;
    std::vector<double> mResampledData;
+   ResamplingMatrix mResamplingMatrix;
    AttachmentPtr<RasterElement> mpOdre;
    std::string mAbscissaName;
    bool mNeedToResample;
@@ -32,6 +32,40 @@
 using namespace mta;
 XERCES_CPP_NAMESPACE_USE
 
+namespace
+{
+   // Memory for the full resolution histograms of all threads when statistics are calculated for several bands
+   const size_t sBandHistogramMemory = 256 * 1024 * 1024;
+
+   bool isIntegerStatistics(EncodingType encoding, ComplexComponent component)
+   {
+      if ((encoding == FLT4BYTES) || (encoding == FLT8COMPLEX) || (encoding == FLT8BYTES) ||
+         ((encoding == INT4SCOMPLEX) && (component == COMPLEX_MAGNITUDE)) ||
+         ((encoding == INT4SCOMPLEX) && (component == COMPLEX_PHASE)))
+      {
+         return false;
+      }
+
+      return true;
+   }
+
+   bool isBadValue(const std::vector<int>& badValues, double value)
+   {
+      if (badValues.empty())
+      {
+         return false;
+      }
+
+      int valueInt = roundDouble(value);
+      if (badValues.size() == 1)
+      {
+         return valueInt == badValues.front();
+      }
+
+      return std::binary_search(badValues.begin(), badValues.end(), valueInt);
+   }
+}
+
 StatisticsImp::StatisticsImp(const RasterElementImp* pRasterElement,
                              DimensionDescriptor band,
                              AoiElement* pAoi) :
@@ -659,24 +693,7 @@ void StatisticsImp::calculateStatistics(ComplexComponent component)
       dynamic_cast<const RasterDataDescriptor*>(mpRasterElement->getDataDescriptor());
    VERIFYNRV(pDescriptor);
 
-   int rowNum = pDescriptor->getRowCount();
-   int colNum = pDescriptor->getColumnCount();
-   if (mStatisticsResolution == 0)
-   {
-      if (rowNum < colNum)
-      {
-         mStatisticsResolution = rowNum/500;
-      }
-      else
-      {
-         mStatisticsResolution = colNum/500;
-      }
-
-      if (mStatisticsResolution < 1)
-      {
-         mStatisticsResolution = 1;
-      }
-   }
+   initializeResolution();
 
    if (mpOriginalAoi.get() != NULL)
    {
@@ -703,14 +720,7 @@ void StatisticsImp::calculateStatistics(ComplexComponent component)
       (getNumRequiredThreads(pDescriptor->getRowCount()), statInput, statOutput, &progressReporter);
    statisticsAlgorithm.run();
 
-   bool bInteger = true;
-   EncodingType encoding = pDescriptor->getDataType();
-   if ((encoding == FLT4BYTES) || (encoding == FLT8COMPLEX) || (encoding == FLT8BYTES) ||
-      ((encoding == INT4SCOMPLEX) && (component == COMPLEX_MAGNITUDE)) ||
-      ((encoding == INT4SCOMPLEX) && (component == COMPLEX_PHASE)))
-   {
-      bInteger = false;
-   }
+   bool bInteger = isIntegerStatistics(pDescriptor->getDataType(), component);
 
    progressReporter.setCurrentPhase(1);
 
@@ -724,20 +734,172 @@ void StatisticsImp::calculateStatistics(ComplexComponent component)
 
       if (histogramAlgorithm.run() == mta::SUCCESS)
       {
-         setMin(statOutput.mMinimum, component);
-         setMax(statOutput.mMaximum, component);
-         setAverage(statOutput.mAverage, component);
-         setStandardDeviation(statOutput.mStandardDeviation, component);
-         setPercentiles(histOutput.getPercentiles(), component);
-         setHistogram(histOutput.getBinCenters(), histOutput.getBinCounts(), component);
+         setCalculatedStatistics(component, statOutput, &histOutput);
       }
    }
    else
+   {
+      setCalculatedStatistics(component, statOutput, NULL);
+   }
+}
+
+void StatisticsImp::calculateBandStatistics(const std::vector<StatisticsImp*>& statistics,
+                                            ComplexComponent component)
+{
+   if (statistics.empty() || statistics.front() == NULL || statistics.front()->mpRasterElement == NULL)
+   {
+      return;
+   }
+
+   const RasterElementImp* pRasterElement = statistics.front()->mpRasterElement;
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pRasterElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor);
+
+   // Only whole band statistics with the same sampling as the first band can share a pass
+   int resolution = statistics.front()->initializeResolution();
+   std::vector<StatisticsImp*> batchStatistics;
+   std::vector<DimensionDescriptor> bands;
+   std::vector<std::vector<int> > badValues;
+   for (std::vector<StatisticsImp*>::const_iterator iter = statistics.begin(); iter != statistics.end(); ++iter)
+   {
+      StatisticsImp* pStatistics = *iter;
+      if (pStatistics == NULL)
+      {
+         continue;
+      }
+
+      if (pStatistics->mpRasterElement != pRasterElement || pStatistics->mBands.size() != 1 ||
+         pStatistics->mpOriginalAoi.get() != NULL || pStatistics->mpAoi.get() != NULL ||
+         pStatistics->initializeResolution() != resolution)
+      {
+         pStatistics->calculateStatistics(component);
+         continue;
+      }
+
+      pStatistics->reset(component);
+      batchStatistics.push_back(pStatistics);
+      bands.push_back(pStatistics->mBands.front());
+      badValues.push_back(pStatistics->mBadValues);
+   }
+
+   if (batchStatistics.empty())
+   {
+      return;
+   }
+
+   BandStatisticsInput input(dynamic_cast<const RasterElement*>(pRasterElement), bands, badValues, component,
+      resolution);
+   BandStatisticsOutput output(input);
+
+   // Each thread has a full resolution histogram for every band in a group
+   unsigned int threadCount = getNumRequiredThreads(pDescriptor->getRowCount());
+   size_t groupSize = sBandHistogramMemory / (std::max(threadCount, 1U) * HISTOGRAM_SIZE * sizeof(unsigned int));
+   unsigned int bandGroupSize = static_cast<unsigned int>(std::min(std::max(groupSize, static_cast<size_t>(1)),
+      bands.size()));
+   unsigned int groupCount = static_cast<unsigned int>((bands.size() + bandGroupSize - 1) / bandGroupSize);
+
+   mta::StatusBarReporter barReporter("Computing statistics", "app", "CF884AA2-A1BF-468d-9609-795DE0F7B7A4");
+
+   std::vector<int> phaseWeights(1, 20);
+   phaseWeights.resize(groupCount + 1, std::max(80 / static_cast<int>(groupCount), 1));
+   mta::MultiPhaseProgressReporter progressReporter(barReporter, phaseWeights);
+
+   mta::MultiThreadedAlgorithm<BandStatisticsInput, BandStatisticsOutput, BandStatisticsThread> statisticsAlgorithm
+      (threadCount, input, output, &progressReporter);
+   if (statisticsAlgorithm.run() != mta::SUCCESS)
+   {
+      return;
+   }
+
+   input.mMinimums.resize(bands.size());
+   input.mMaximums.resize(bands.size());
+   for (std::vector<DimensionDescriptor>::size_type band = 0; band < bands.size(); ++band)
+   {
+      input.mMinimums[band] = output.mStatistics[band].mMinimum;
+      input.mMaximums[band] = output.mStatistics[band].mMaximum;
+   }
+
+   bool bInteger = isIntegerStatistics(pDescriptor->getDataType(), component);
+   input.mHistogramPhase = true;
+   for (unsigned int group = 0; group < groupCount; ++group)
+   {
+      progressReporter.setCurrentPhase(group + 1);
+
+      input.mFirstBand = group * bandGroupSize;
+      input.mBandCount = std::min(bandGroupSize, static_cast<unsigned int>(bands.size()) - input.mFirstBand);
+
+      mta::MultiThreadedAlgorithm<BandStatisticsInput, BandStatisticsOutput, BandStatisticsThread>
+         histogramAlgorithm(threadCount, input, output, &progressReporter);
+      if (histogramAlgorithm.run() != mta::SUCCESS)
+      {
+         return;
+      }
+
+      for (unsigned int band = 0; band < input.mBandCount; ++band)
+      {
+         const StatisticsOutput& bandStatistics = output.mStatistics[input.mFirstBand + band];
+         StatisticsImp* pStatistics = batchStatistics[input.mFirstBand + band];
+         if (bandStatistics.mMaxMinSet)
+         {
+            HistogramOutput histOutput(bInteger, bandStatistics.mMaximum, bandStatistics.mMinimum);
+            histOutput.compileOverallResults(output.mBinCounts[band]);
+            pStatistics->setCalculatedStatistics(component, bandStatistics, &histOutput);
+         }
+         else
+         {
+            pStatistics->setCalculatedStatistics(component, bandStatistics, NULL);
+         }
+      }
+   }
+}
+
+int StatisticsImp::initializeResolution()
+{
+   if (mStatisticsResolution == 0 && mpRasterElement != NULL)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(mpRasterElement->getDataDescriptor());
+      VERIFYRV(pDescriptor, 1);
+
+      int rowNum = pDescriptor->getRowCount();
+      int colNum = pDescriptor->getColumnCount();
+      if (rowNum < colNum)
+      {
+         mStatisticsResolution = rowNum/500;
+      }
+      else
+      {
+         mStatisticsResolution = colNum/500;
+      }
+
+      if (mStatisticsResolution < 1)
+      {
+         mStatisticsResolution = 1;
+      }
+   }
+
+   return mStatisticsResolution;
+}
+
+void StatisticsImp::setCalculatedStatistics(ComplexComponent component, const StatisticsOutput& statistics,
+                                            const HistogramOutput* pHistogram)
+{
+   if (pHistogram != NULL)
+   {
+      setMin(statistics.mMinimum, component);
+      setMax(statistics.mMaximum, component);
+      setAverage(statistics.mAverage, component);
+      setStandardDeviation(statistics.mStandardDeviation, component);
+      setPercentiles(pHistogram->getPercentiles(), component);
+      setHistogram(pHistogram->getBinCenters(), pHistogram->getBinCounts(), component);
+   }
+   else
    {
       setMin(0.0, component);
       setMax(0.0, component);
-      setAverage(statOutput.mAverage, component);
-      setStandardDeviation(statOutput.mStandardDeviation, component);
+      setAverage(statistics.mAverage, component);
+      setStandardDeviation(statistics.mStandardDeviation, component);
       std::vector<double> dzeroes(1001, 0.0); // setPercentiles needs 1001 contiguous values; setHistogram needs 256
       std::vector<unsigned int> uizeroes(256, 0);
       setPercentiles(&dzeroes.front(), component);
@@ -749,8 +911,7 @@ StatisticsThread::StatisticsThread(const StatisticsInput& input, int threadCount
                                    ThreadReporter& reporter) :
    AlgorithmThread(threadIndex, reporter),
    mInput(input),
-   mRowRange(getThreadRange(threadCount, static_cast<const RasterDataDescriptor*>(
-                                 input.mpRasterElement->getDataDescriptor())->getRowCount())),
+   mThreadCount(threadCount),
    mMaxMinSet(false),
    mMaximum(-std::numeric_limits<double>::max()),
    mMinimum(std::numeric_limits<double>::max()),
@@ -765,13 +926,27 @@ void StatisticsThread::run()
       mInput.mpRasterElement->getDataDescriptor());
    VERIFYNRV(pDescriptor != NULL);
 
-   BitMaskIterator diter(mInput.mpAoi, 0, mRowRange.mFirst, pDescriptor->getColumnCount() - 1, mRowRange.mLast);
-
    mMaxMinSet = false;
    mSum = 0.0;
    mSumSquared = 0.0;
    mCount = 0;
 
+   Range rowRange;
+   while (getNextRange(mThreadCount, static_cast<int>(pDescriptor->getRowCount()), rowRange))
+   {
+      BitMaskIterator diter(mInput.mpAoi, 0, rowRange.mFirst, pDescriptor->getColumnCount() - 1, rowRange.mLast);
+      if (diter != diter.end())
+      {
+         calculateRows(diter);
+      }
+   }
+}
+
+void StatisticsThread::calculateRows(BitMaskIterator& diter)
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(
+      mInput.mpRasterElement->getDataDescriptor());
+
    EncodingType encoding = pDescriptor->getDataType();
    ComplexComponent component = mInput.mComplexComponent;
    unsigned int badValueCount = mInput.mBadValues.size();
@@ -783,8 +958,6 @@ void StatisticsThread::run()
    std::vector<int>::const_iterator badBegin = mInput.mBadValues.begin();
    std::vector<int>::const_iterator badEnd = mInput.mBadValues.end();
 
-   int oldPercentDone = -1;
-
    bool isBip = pDescriptor->getInterleaveFormat() == BIP;
    // Outer band loop not for BIP, will break if BIP
    for (std::vector<DimensionDescriptor>::const_iterator bandIt = mInput.mBandsToCalculate.begin();
@@ -818,13 +991,6 @@ void StatisticsThread::run()
       {
          LocationType loc;
          diter.getPixelLocation(loc);
-         int percentDone = mRowRange.computePercent(static_cast<int>(loc.mY));
-         if (percentDone >= oldPercentDone + 25)
-         {
-            oldPercentDone = percentDone;
-            getReporter().reportProgress(getThreadIndex(), percentDone);
-         }
-
          da->toPixel(static_cast<int>(loc.mY), static_cast<int>(loc.mX));
          VERIFYNRV(da.isValid());
 
@@ -922,17 +1088,16 @@ StatisticsOutput::StatisticsOutput() :
 
 bool StatisticsOutput::compileOverallResults(const std::vector<StatisticsThread*>& threads)
 {
-   mMaxMinSet = false;
-   mMaximum = -std::numeric_limits<double>::max();
-   mMinimum = std::numeric_limits<double>::max();
-   mAverage = 0.0;
-   mStandardDeviation = 0.0;
+   setResults(false, -std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), 0.0, 0.0, 0);
 
    if (threads.size() == 0)
    {
       return false;
    }
 
+   bool maxMinSet = false;
+   double maximum = -std::numeric_limits<double>::max();
+   double minimum = std::numeric_limits<double>::max();
    double totalSum = 0.0;
    double totalSquaredSum = 0.0;
    unsigned int pointCount = 0;
@@ -944,9 +1109,9 @@ bool StatisticsOutput::compileOverallResults(const std::vector<StatisticsThread*
       {
          if (pThread->isMaxMinSet())
          {
-            mMaxMinSet = true;
-            mMaximum = std::max(mMaximum, pThread->getMaximum());
-            mMinimum = std::min(mMinimum, pThread->getMinimum());
+            maxMinSet = true;
+            maximum = std::max(maximum, pThread->getMaximum());
+            minimum = std::min(minimum, pThread->getMinimum());
          }
          totalSum += pThread->getSum();
          totalSquaredSum += pThread->getSumSquared();
@@ -954,6 +1119,19 @@ bool StatisticsOutput::compileOverallResults(const std::vector<StatisticsThread*
       }
    }
 
+   setResults(maxMinSet, maximum, minimum, totalSum, totalSquaredSum, pointCount);
+   return true;
+}
+
+void StatisticsOutput::setResults(bool maxMinSet, double maximum, double minimum, double totalSum,
+                                  double totalSquaredSum, unsigned int pointCount)
+{
+   mMaxMinSet = maxMinSet;
+   mMaximum = maximum;
+   mMinimum = minimum;
+   mAverage = 0.0;
+   mStandardDeviation = 0.0;
+
    if (pointCount > 0)
    {
       mAverage = totalSum / pointCount;
@@ -966,8 +1144,6 @@ bool StatisticsOutput::compileOverallResults(const std::vector<StatisticsThread*
       double numerator = fabs(pointCount * totalSquaredSum - totalSum * totalSum);
       mStandardDeviation = sqrt((numerator / pointCount) / (pointCount - 1));
    }
-
-   return true;
 }
 
 HistogramThread::HistogramThread(const HistogramInput& input,
@@ -977,12 +1153,29 @@ HistogramThread::HistogramThread(const HistogramInput& input,
    AlgorithmThread(threadIndex, reporter),
    mInput(input),
    mCount(0),
-   mRowRange(getThreadRange(threadCount, static_cast<const RasterDataDescriptor*>(
-                                 input.mStatInput.mpRasterElement->getDataDescriptor())->getRowCount())),
+   mThreadCount(threadCount),
    mBinCounts(HISTOGRAM_SIZE)
 {}
 
 void HistogramThread::run()
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(
+      mInput.mStatInput.mpRasterElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+
+   Range rowRange;
+   while (getNextRange(mThreadCount, static_cast<int>(pDescriptor->getRowCount()), rowRange))
+   {
+      BitMaskIterator diter(mInput.mStatInput.mpAoi, 0, rowRange.mFirst,
+         pDescriptor->getColumnCount() - 1, rowRange.mLast);
+      if (diter != diter.end())
+      {
+         calculateRows(diter);
+      }
+   }
+}
+
+void HistogramThread::calculateRows(BitMaskIterator& diter)
 {
    double range = 1.0;
    double toBin = 0.0;
@@ -997,10 +1190,6 @@ void HistogramThread::run()
 
    const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(
       mInput.mStatInput.mpRasterElement->getDataDescriptor());
-   VERIFYNRV(pDescriptor != NULL);
-
-   BitMaskIterator diter(mInput.mStatInput.mpAoi, 0, mRowRange.mFirst,
-      pDescriptor->getColumnCount() - 1, mRowRange.mLast);
 
    bool isBip = pDescriptor->getInterleaveFormat() == BIP;
    // Outer band loop not for BIP, will break if BIP
@@ -1040,20 +1229,12 @@ void HistogramThread::run()
       std::vector<int>::const_iterator badBegin = mInput.mStatInput.mBadValues.begin();
       std::vector<int>::const_iterator badEnd = mInput.mStatInput.mBadValues.end();
 
-      int oldPercentDone = -1;
       // Iterate the band over the AOI or all bands in the case of BIP
 //#pragma message(__FILE__ "(" STRING(__LINE__) ") : warning : This should be changed to for (; fiter != diter.end(); diter += mInput.mResolution)  if/when BitMaskIterator is modified to be an STL iterator (tclarke)")
       while (diter != diter.end())
       {
          LocationType loc;
          diter.getPixelLocation(loc);
-         int percentDone = mRowRange.computePercent(static_cast<int>(loc.mY));
-         if (percentDone >= oldPercentDone + 25)
-         {
-            oldPercentDone = percentDone;
-            getReporter().reportProgress(getThreadIndex(), percentDone);
-         }
-
          da->toPixel(static_cast<int>(loc.mY), static_cast<int>(loc.mX));
          VERIFYNRV(da.isValid());
 
@@ -1112,11 +1293,16 @@ bool HistogramOutput::compileOverallResults(const std::vector<HistogramThread*>&
    std::vector<unsigned int> totalBinCounts(HISTOGRAM_SIZE);
 
    sumAllThreads(threads, totalBinCounts);
+   compileOverallResults(totalBinCounts);
+
+   return true;
+}
+
+void HistogramOutput::compileOverallResults(const std::vector<unsigned int>& totalBinCounts)
+{
    computeBinCenters();
    computeResultHistogram(totalBinCounts);
    computePercentiles(totalBinCounts);
-
-   return true;
 }
 
 const double* HistogramOutput::getBinCenters() const
@@ -1259,3 +1445,245 @@ void HistogramOutput::computePercentiles(const std::vector<unsigned int>& totalH
       }
    }
 }
+
+bool BandStatisticsOutput::compileOverallResults(const std::vector<BandStatisticsThread*>& threads)
+{
+   if (threads.size() == 0)
+   {
+      return false;
+   }
+
+   if (mInput.mHistogramPhase)
+   {
+      mBinCounts.assign(mInput.mBandCount, std::vector<unsigned int>(HISTOGRAM_SIZE));
+      for (std::vector<BandStatisticsThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+      {
+         if (*iter == NULL || (*iter)->getBinCounts().empty())
+         {
+            continue;
+         }
+
+         const std::vector<unsigned int>& threadBinCounts = (*iter)->getBinCounts();
+         for (unsigned int band = 0; band < mInput.mBandCount; ++band)
+         {
+            std::vector<unsigned int>::const_iterator threadBand = threadBinCounts.begin() + band * HISTOGRAM_SIZE;
+            transform(mBinCounts[band].begin(), mBinCounts[band].end(), threadBand, mBinCounts[band].begin(),
+               std::plus<unsigned int>());
+         }
+      }
+
+      return true;
+   }
+
+   mStatistics.assign(mInput.mBands.size(), StatisticsOutput());
+   for (unsigned int band = 0; band < mInput.mBands.size(); ++band)
+   {
+      BandStatisticsThread::Accumulator total;
+      for (std::vector<BandStatisticsThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+      {
+         if (*iter == NULL || (*iter)->getAccumulators().size() <= band)
+         {
+            continue;
+         }
+
+         const BandStatisticsThread::Accumulator& accumulator = (*iter)->getAccumulators()[band];
+         if (accumulator.mMaxMinSet)
+         {
+            total.mMaxMinSet = true;
+            total.mMaximum = std::max(total.mMaximum, accumulator.mMaximum);
+            total.mMinimum = std::min(total.mMinimum, accumulator.mMinimum);
+         }
+         total.mSum += accumulator.mSum;
+         total.mSumSquared += accumulator.mSumSquared;
+         total.mCount += accumulator.mCount;
+      }
+
+      mStatistics[band].setResults(total.mMaxMinSet, total.mMaximum, total.mMinimum, total.mSum, total.mSumSquared,
+         total.mCount);
+   }
+
+   return true;
+}
+
+BandStatisticsThread::Accumulator::Accumulator() :
+   mMaxMinSet(false),
+   mMaximum(-std::numeric_limits<double>::max()),
+   mMinimum(std::numeric_limits<double>::max()),
+   mSum(0.0),
+   mSumSquared(0.0),
+   mCount(0)
+{}
+
+BandStatisticsThread::BandStatisticsThread(const BandStatisticsInput& input, int threadCount, int threadIndex,
+                                           ThreadReporter& reporter) :
+   AlgorithmThread(threadIndex, reporter),
+   mInput(input),
+   mThreadCount(threadCount)
+{}
+
+void BandStatisticsThread::run()
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(
+      mInput.mpRasterElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+
+   unsigned int firstBand = mInput.mFirstBand;
+   unsigned int bandCount = mInput.mBandCount;
+   std::vector<double> toBin;
+   if (mInput.mHistogramPhase)
+   {
+      mBinCounts.assign(static_cast<size_t>(bandCount) * HISTOGRAM_SIZE, 0);
+      toBin.resize(bandCount, 0.0);
+      for (unsigned int band = 0; band < bandCount; ++band)
+      {
+         double range = mInput.mMaximums[firstBand + band] - mInput.mMinimums[firstBand + band];
+         if (range != 0.0)
+         {
+            toBin[band] = 0.999999999 * (HISTOGRAM_SIZE) / range;
+         }
+      }
+   }
+   else
+   {
+      mAccumulators.assign(bandCount, Accumulator());
+   }
+
+   Range rowRange;
+   while (getNextRange(mThreadCount, static_cast<int>(pDescriptor->getRowCount()), rowRange))
+   {
+      calculateRows(rowRange, toBin);
+   }
+}
+
+void BandStatisticsThread::calculateRows(const Range& rowRange, const std::vector<double>& toBin)
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(
+      mInput.mpRasterElement->getDataDescriptor());
+   unsigned int firstBand = mInput.mFirstBand;
+   unsigned int bandCount = mInput.mBandCount;
+   EncodingType encoding = pDescriptor->getDataType();
+   ComplexComponent component = mInput.mComplexComponent;
+   InterleaveFormatType interleave = pDescriptor->getInterleaveFormat();
+   unsigned int columnCount = pDescriptor->getColumnCount();
+   unsigned int nativeBandCount = pDescriptor->getBandCount();
+   unsigned int resolution = static_cast<unsigned int>(std::max(mInput.mResolution, 1));
+
+   // BIP and BIL rows contain every band so each row is read once for all of the bands,
+   // while the bands of BSQ data are stored separately and are read one after another
+   unsigned int passCount = (interleave == BSQ ? bandCount : 1);
+   for (unsigned int pass = 0; pass < passCount; ++pass)
+   {
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(interleave);
+      pRequest->setRows(pDescriptor->getActiveRow(rowRange.mFirst), pDescriptor->getActiveRow(rowRange.mLast), 1);
+      if (interleave == BSQ)
+      {
+         pRequest->setBands(mInput.mBands[firstBand + pass], mInput.mBands[firstBand + pass], 1);
+      }
+
+      DataAccessor da(mInput.mpRasterElement->getDataAccessor(pRequest.release()));
+      if (!da.isValid())
+      {
+         return;
+      }
+
+      unsigned int passFirstBand = (interleave == BSQ ? pass : 0);
+      unsigned int passLastBand = (interleave == BSQ ? pass + 1 : bandCount);
+
+      // Every resolution'th pixel is sampled in row major order from the start of the chunk's rows
+      unsigned int firstColumn = 0;
+      for (int row = rowRange.mFirst; row <= rowRange.mLast; ++row)
+      {
+         da->toPixel(row, 0);
+         VERIFYNRV(da.isValid());
+         const void* pRow = da->getRow();
+
+         for (unsigned int band = passFirstBand; band < passLastBand; ++band)
+         {
+            unsigned int bandNumber = mInput.mBands[firstBand + band].getActiveNumber();
+            const std::vector<int>& badValues = mInput.mBadValues[firstBand + band];
+
+            size_t bandOffset = 0;
+            size_t columnStride = 1;
+            if (interleave == BIP)
+            {
+               bandOffset = bandNumber;
+               columnStride = nativeBandCount;
+            }
+            else if (interleave == BIL)
+            {
+               bandOffset = static_cast<size_t>(bandNumber) * columnCount;
+            }
+
+            if (mInput.mHistogramPhase)
+            {
+               double minimum = mInput.mMinimums[firstBand + band];
+               double scale = toBin[band];
+               unsigned int* pBinCounts = &mBinCounts[static_cast<size_t>(band) * HISTOGRAM_SIZE];
+               for (unsigned int column = firstColumn; column < columnCount; column += resolution)
+               {
+                  double value = ModelServices::getDataValue(encoding, pRow, component,
+                     static_cast<int>(bandOffset + column * columnStride));
+                  if (isBadValue(badValues, value) == false)
+                  {
+                     int bin = static_cast<int>((value - minimum) * scale);
+                     if (bin >= HISTOGRAM_SIZE)
+                     {
+                        bin = HISTOGRAM_SIZE - 1;
+                     }
+                     else if (bin < 0)
+                     {
+                        bin = 0;
+                     }
+
+                     pBinCounts[bin]++;
+                  }
+               }
+            }
+            else
+            {
+               Accumulator& accumulator = mAccumulators[band];
+               for (unsigned int column = firstColumn; column < columnCount; column += resolution)
+               {
+                  double value = ModelServices::getDataValue(encoding, pRow, component,
+                     static_cast<int>(bandOffset + column * columnStride));
+                  if (isBadValue(badValues, value) == false)
+                  {
+                     if (!accumulator.mMaxMinSet)
+                     {
+                        accumulator.mMinimum = accumulator.mMaximum = value;
+                        accumulator.mMaxMinSet = true;
+                     }
+                     else
+                     {
+                        accumulator.mMinimum = std::min(accumulator.mMinimum, value);
+                        accumulator.mMaximum = std::max(accumulator.mMaximum, value);
+                     }
+
+                     accumulator.mSumSquared += value * value;
+                     accumulator.mSum += value;
+                     accumulator.mCount++;
+                  }
+               }
+            }
+         }
+
+         // Carry the sampling position over to the next row
+         if (firstColumn < columnCount)
+         {
+            firstColumn += (columnCount - firstColumn + resolution - 1) / resolution * resolution;
+         }
+         firstColumn -= columnCount;
+      }
+   }
+}
+
+const std::vector<BandStatisticsThread::Accumulator>& BandStatisticsThread::getAccumulators() const
+{
+   return mAccumulators;
+}
+
+const std::vector<unsigned int>& BandStatisticsThread::getBinCounts() const
+{
+   return mBinCounts;
+}
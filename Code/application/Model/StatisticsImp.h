@@ -22,8 +22,11 @@
 #include <map>
 #include <vector>
 
+class BitMaskIterator;
+class HistogramOutput;
 class RasterElement;
 class RasterElementImp;
+class StatisticsOutput;
 
 class StatisticsImp : public Statistics
 {
@@ -79,6 +82,25 @@ public:
    bool toXml(XMLWriter* pXml) const;
    bool fromXml(DOMNode* pDocument, unsigned int version);
 
+   /**
+    * Calculates the statistics of several bands of one raster element together.
+    *
+    * The minimums, maximums, averages and standard deviations of all of the bands
+    * are accumulated in a single pass over the element's native interleave, and the
+    * histograms and percentiles in one more pass for each group of bands whose
+    * histograms fit in memory, instead of two passes for every band. The results
+    * are identical to calculating the statistics of each band separately.
+    *
+    * Statistics with an AOI or a resolution which differs from the first band's
+    * resolution are calculated separately.
+    *
+    * @param statistics
+    *        The single band statistics of bands of the same element.
+    * @param component
+    *        The complex component to calculate.
+    */
+   static void calculateBandStatistics(const std::vector<StatisticsImp*>& statistics, ComplexComponent component);
+
 protected:
    void calculateStatistics(ComplexComponent component);
 
@@ -86,6 +108,10 @@ private:
    StatisticsImp(const StatisticsImp& rhs);
    StatisticsImp& operator=(const StatisticsImp& rhs);
 
+   int initializeResolution();
+   void setCalculatedStatistics(ComplexComponent component, const StatisticsOutput& statistics,
+      const HistogramOutput* pHistogram);
+
    // NOTE: this has to be a RasterElementImp instead of RasterElement as it is populated
    // in the RasterElementImp constructor. At that point, a dynamic_cast to RasterElement
    // is not possible.
@@ -145,6 +171,8 @@ public:
    double mAverage;
    double mStandardDeviation;
    bool compileOverallResults(const std::vector<StatisticsThread*>& threads);
+   void setResults(bool maxMinSet, double maximum, double minimum, double totalSum, double totalSquaredSum,
+      unsigned int pointCount);
 };
 
 class StatisticsThread : public mta::AlgorithmThread
@@ -165,9 +193,11 @@ public:
 private:
    StatisticsThread& operator=(const StatisticsThread& rhs);
 
+   void calculateRows(BitMaskIterator& diter);
+
    const StatisticsInput& mInput;
 
-   Range mRowRange;
+   int mThreadCount;
    bool mMaxMinSet;
    double mMaximum;
    double mMinimum;
@@ -197,6 +227,7 @@ public:
       mIsInteger(isInteger), mMaximum(maximum), mMinimum(minimum) {}
 
    bool compileOverallResults(const std::vector<HistogramThread*>& threads);
+   void compileOverallResults(const std::vector<unsigned int>& totalBinCounts);
    const double* getBinCenters() const;
    const unsigned int* getBinCounts() const;
    const double* getPercentiles() const;
@@ -228,10 +259,99 @@ public:
 private:
    HistogramThread& operator=(const HistogramThread& rhs);
 
+   void calculateRows(BitMaskIterator& diter);
+
    const HistogramInput& mInput;
    unsigned int mCount;
 
-   Range mRowRange;
+   int mThreadCount;
+   std::vector<unsigned int> mBinCounts;
+};
+
+class BandStatisticsInput
+{
+public:
+   BandStatisticsInput(const RasterElement* pRaster, const std::vector<DimensionDescriptor>& bands,
+                       const std::vector<std::vector<int> >& badValues, ComplexComponent component,
+                       int resolution) :
+      mpRasterElement(pRaster),
+      mBands(bands),
+      mBadValues(badValues),
+      mComplexComponent(component),
+      mResolution(resolution),
+      mHistogramPhase(false),
+      mFirstBand(0),
+      mBandCount(static_cast<unsigned int>(bands.size()))
+   {
+   }
+
+   const RasterElement* mpRasterElement;
+   const std::vector<DimensionDescriptor>& mBands;
+   const std::vector<std::vector<int> >& mBadValues;
+   ComplexComponent mComplexComponent;
+   int mResolution;
+
+   // The histogram phase bins the bands from mFirstBand using the minimums and maximums of the statistics phase
+   bool mHistogramPhase;
+   unsigned int mFirstBand;
+   unsigned int mBandCount;
+   std::vector<double> mMinimums;
+   std::vector<double> mMaximums;
+
+private:
+   BandStatisticsInput& operator=(const BandStatisticsInput& rhs);
+};
+
+class BandStatisticsThread;
+class BandStatisticsOutput
+{
+public:
+   BandStatisticsOutput(const BandStatisticsInput& input) : mInput(input) {}
+
+   bool compileOverallResults(const std::vector<BandStatisticsThread*>& threads);
+
+   std::vector<StatisticsOutput> mStatistics;
+   std::vector<std::vector<unsigned int> > mBinCounts;
+
+private:
+   BandStatisticsOutput& operator=(const BandStatisticsOutput& rhs);
+
+   const BandStatisticsInput& mInput;
+};
+
+class BandStatisticsThread : public mta::AlgorithmThread
+{
+public:
+   struct Accumulator
+   {
+      Accumulator();
+
+      bool mMaxMinSet;
+      double mMaximum;
+      double mMinimum;
+      double mSum;
+      double mSumSquared;
+      unsigned int mCount;
+   };
+
+   BandStatisticsThread(const BandStatisticsInput& input, int threadCount, int threadIndex,
+      mta::ThreadReporter& reporter);
+   virtual ~BandStatisticsThread() {};
+
+   virtual void run();
+
+   const std::vector<Accumulator>& getAccumulators() const;
+   const std::vector<unsigned int>& getBinCounts() const;
+
+private:
+   BandStatisticsThread& operator=(const BandStatisticsThread& rhs);
+
+   void calculateRows(const Range& rowRange, const std::vector<double>& toBin);
+
+   const BandStatisticsInput& mInput;
+
+   int mThreadCount;
+   std::vector<Accumulator> mAccumulators;
    std::vector<unsigned int> mBinCounts;
 };
 
@@ -22,13 +22,16 @@
 #include "FileResource.h"
 #include "Georeference.h"
 #include "ImportDescriptor.h"
+#include "MultiThreadedAlgorithm.h"
 #include "NitfConstants.h"
 #include "NitfImporterShell.h"
 #include "NitfMetadataParsing.h"
 #include "NitfResource.h"
+#include "NitfTreCache.h"
 #include "NitfUtilities.h"
 #include "ObjectResource.h"
 #include "PlugInArgList.h"
+#include "Progress.h"
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
 #include "RasterFileDescriptor.h"
@@ -42,8 +45,10 @@
 #include "TypesFile.h"
 
 #include <ossim/base/ossimConstants.h>
+#include <ossim/base/ossimRefPtr.h>
 #include <ossim/support_data/ossimNitfFile.h>
 #include <ossim/support_data/ossimNitfFileHeaderV2_X.h>
+#include <ossim/support_data/ossimNitfImageHeader.h>
 #include <ossim/support_data/ossimNitfImageHeaderV2_X.h>
 #include <ossim/imaging/ossimNitfTileSource.h>
 
@@ -55,6 +60,69 @@ using namespace std;
 //#pragma message(__FILE__ "(" STRING(__LINE__) ") : warning : TODO: The NULL pix value for OSSIM_PARTIAL " \
 //   "is a bad value (leckels)")
 
+namespace
+{
+   class SegmentScanThread;
+
+   struct SegmentScanInput
+   {
+      ossimNitfFile* mpFile;
+      const vector<ossim_uint32>* mpSegments;
+   };
+
+   struct SegmentScanOutput
+   {
+      bool compileOverallResults(const vector<SegmentScanThread*>& threads);
+
+      vector<ossimRefPtr<ossimNitfImageHeader> > mHeaders;
+   };
+
+   // Reads the subheaders of a contiguous range of image segments. Each call to getNewImageHeader()
+   // opens its own stream so the subheaders of different segments can be read concurrently.
+   class SegmentScanThread : public mta::AlgorithmThread
+   {
+   public:
+      SegmentScanThread(const SegmentScanInput& input, int threadCount, int threadIndex,
+         mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRange(getThreadRange(threadCount, static_cast<int>(input.mpSegments->size())))
+      {}
+
+      void run()
+      {
+         for (int index = mRange.mFirst; index <= mRange.mLast; ++index)
+         {
+            mHeaders.push_back(mInput.mpFile->getNewImageHeader((*mInput.mpSegments)[index]));
+         }
+      }
+
+      const vector<ossimRefPtr<ossimNitfImageHeader> >& getHeaders() const
+      {
+         return mHeaders;
+      }
+
+   private:
+      SegmentScanThread& operator=(const SegmentScanThread& rhs);
+
+      const SegmentScanInput& mInput;
+      Range mRange;
+      vector<ossimRefPtr<ossimNitfImageHeader> > mHeaders;
+   };
+
+   bool SegmentScanOutput::compileOverallResults(const vector<SegmentScanThread*>& threads)
+   {
+      // The threads process contiguous ranges in order so the headers stay in segment order
+      for (vector<SegmentScanThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+      {
+         const vector<ossimRefPtr<ossimNitfImageHeader> >& headers = (*iter)->getHeaders();
+         mHeaders.insert(mHeaders.end(), headers.begin(), headers.end());
+      }
+
+      return true;
+   }
+}
+
 Nitf::NitfImporterShell::NitfImporterShell()
 {
    setExtensions("NITF Files (*.ntf *.NTF *.nitf *.NITF *.r0 *.R0)");
@@ -97,18 +165,36 @@ vector<ImportDescriptor*> Nitf::NitfImporterShell::getImportDescriptors(const st
    vector<ossim_uint32> importableImageSegments;
    pHandler->getEntryList(importableImageSegments);
 
-   // Create map of TRE parsers.
-   // The sole purpose of this map is to force DLLs to stay loaded while the metadata is being imported.
-   std::map<std::string, TrePlugInResource> parsers;
+   // The TRE cache keeps the TRE parser DLLs loaded while the metadata is being imported and
+   // reuses the parsed TREs when the descriptors for the same file are requested again.
+   if (mpTreCache.get() == NULL || mpTreCache->isCurrent(filename) == false)
+   {
+      mpTreCache.reset(new TreCache(filename));
+   }
 
-   for (vector<ossim_uint32>::iterator segmentIter = importableImageSegments.begin();
-        segmentIter != importableImageSegments.end(); ++segmentIter)
+   // Read the image subheaders in parallel. Do not call pHandler->setCurrentEntry as it is
+   // a very expensive operation which causes up to a several second delay on files with many large images.
+   SegmentScanInput scanInput;
+   scanInput.mpFile = pFile.get();
+   scanInput.mpSegments = &importableImageSegments;
+   SegmentScanOutput scanOutput;
+   if (importableImageSegments.empty() == false)
    {
-      // Do not call pHandler->setCurrentEntry as it is a very expensive operation
-      // which causes up to a several second delay on files with many large images.
-      const ossim_uint32& currentIndex = *segmentIter;
+      mta::MultiThreadedAlgorithm<SegmentScanInput, SegmentScanOutput, SegmentScanThread> scanAlgorithm(
+         mta::getNumRequiredThreads(static_cast<unsigned int>(importableImageSegments.size())),
+         scanInput, scanOutput, NULL);
+      if (scanAlgorithm.run() != mta::SUCCESS)
+      {
+         return retval;
+      }
+   }
+   VERIFYRV(scanOutput.mHeaders.size() == importableImageSegments.size(), retval);
+
+   for (vector<ossim_uint32>::size_type segment = 0; segment < importableImageSegments.size(); ++segment)
+   {
+      const ossim_uint32& currentIndex = importableImageSegments[segment];
       ossimNitfImageHeaderV2_X* pImgHeader =
-         PTR_CAST(ossimNitfImageHeaderV2_X, pFile->getNewImageHeader(currentIndex));
+         PTR_CAST(ossimNitfImageHeaderV2_X, scanOutput.mHeaders[segment].get());
       if (pImgHeader == NULL)
       {
          continue;
@@ -166,7 +252,7 @@ vector<ImportDescriptor*> Nitf::NitfImporterShell::getImportDescriptors(const st
       RasterUtilities::generateAndSetFileDescriptor(pDd, filename, imageName, LITTLE_ENDIAN_ORDER);
 
       string errorMessage;
-      if (Nitf::importMetadata(currentIndex + 1, pFile, pFileHeader, pImgHeader, pDd, parsers, errorMessage) == true)
+      if (Nitf::importMetadata(currentIndex + 1, pFile, pFileHeader, pImgHeader, pDd, *mpTreCache, errorMessage) == true)
       {
          const DynamicObject* pMeta = pDd->getMetadata();
          VERIFYRV(pMeta, retval);
@@ -239,6 +325,43 @@ vector<ImportDescriptor*> Nitf::NitfImporterShell::getImportDescriptors(const st
    return retval;
 }
 
+bool Nitf::NitfImporterShell::parseInputArgList(PlugInArgList* pInArgList)
+{
+   if (RasterElementImporterShell::parseInputArgList(pInArgList) == false)
+   {
+      return false;
+   }
+
+   RasterElement* pRaster = getRasterElement();
+   VERIFY(pRaster != NULL);
+
+   RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   const FileDescriptor* pFileDescriptor = pDescriptor->getFileDescriptor();
+   VERIFY(pFileDescriptor != NULL);
+
+   const string filename = pFileDescriptor->getFilename().getFullPathAndName();
+   if (mpTreCache.get() == NULL || mpTreCache->isCurrent(filename) == false)
+   {
+      mpTreCache.reset(new TreCache(filename));
+   }
+
+   // A TRE which cannot be parsed does not prevent the image from being imported
+   string errorMessage;
+   mpTreCache->loadDeferredTres(pDescriptor, errorMessage);
+   if (errorMessage.empty() == false)
+   {
+      Progress* pProgress = getProgress();
+      if (pProgress != NULL)
+      {
+         pProgress->updateProgress(errorMessage, 0, WARNING);
+      }
+   }
+
+   return true;
+}
+
 unsigned char Nitf::NitfImporterShell::getFileAffinity(const string& filename)
 {
    // Check that the file exists
@@ -13,8 +13,9 @@
 #include "RasterElementImporterShell.h"
 
 #include <ossim/base/ossimConstants.h>
-#include <string>
 #include <map>
+#include <memory>
+#include <string>
 
 class ossimNitfFile;
 class ossimNitfFileHeaderV2_X;
@@ -22,6 +23,8 @@ class ossimNitfImageHeaderV2_X;
 
 namespace Nitf
 {
+   class TreCache;
+
    /**
     * Base class for NITF importers.
     */
@@ -44,6 +47,9 @@ namespace Nitf
        * @copydoc RasterElementImporterShell::getImportDescriptors()
        *
        * @default The default implementation returns image segments which can be imported by this importer.
+       *          The image subheaders are read in parallel and the parsed TREs are cached for the file.
+       *          TREs which are at least TreCache::getSettingDeferredTreSize() bytes are not parsed until
+       *          the image segment is imported.
        */
       virtual std::vector<ImportDescriptor*> getImportDescriptors(const std::string& filename);
 
@@ -130,6 +136,14 @@ namespace Nitf
        */
       virtual int getValidationTest(const DataDescriptor* pDescriptor) const;
 
+      /**
+       * @copydoc RasterElementImporterShell::parseInputArgList()
+       *
+       * @default The default implementation also parses the TREs which were
+       *          deferred when the import descriptor was created.
+       */
+      virtual bool parseInputArgList(PlugInArgList* pInArgList);
+
       /**
        * Allocate and return an ImportDescriptor for the specified image. This method should allocate an
        * ImportDescriptor (if desired) and set whether it is imported by default. This method should not set any fields
@@ -167,6 +181,7 @@ namespace Nitf
 
    private:
       std::map<std::string, std::string> mParseMessages;
+      std::auto_ptr<TreCache> mpTreCache;
    };
 }
 #endif
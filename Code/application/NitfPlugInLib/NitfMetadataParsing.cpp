@@ -16,6 +16,7 @@
 #include "NitfFileHeader.h"
 #include "NitfImageSubheader.h"
 #include "NitfMetadataParsing.h"
+#include "NitfTreCache.h"
 #include "NitfTreParser.h"
 #include "NitfUtilities.h"
 #include "ObjectFactory.h"
@@ -53,42 +54,53 @@ using namespace std;
 
 bool Nitf::TrePlugInResource::parseTag(const ossimNitfRegisteredTag& input, DynamicObject& output,
    RasterDataDescriptor& descriptor, string& errorMessage) const
+{
+   bool parsed = parseTag(input, output, errorMessage);
+   if (parsed)
+   {
+      importMetadata(output, descriptor, errorMessage);
+   }
+
+   return parsed;
+}
+
+bool Nitf::TrePlugInResource::parseTag(const ossimNitfRegisteredTag& input, DynamicObject& output,
+   string& errorMessage) const
 {
    bool parsed = false;
    const TreParser* pParser = dynamic_cast<const TreParser*>(get());
    if (pParser != NULL)
    {
-      string errorMessage1;
-      string errorMessage2;
-      parsed = pParser->ossimTagToDynamicObject(input, output, errorMessage1);
+      string parseMessage;
+      parsed = pParser->ossimTagToDynamicObject(input, output, parseMessage);
       if (!parsed)
       {
          stringstream strm;
          const_cast<ossimNitfRegisteredTag&>(input).writeStream(strm);
-         parsed = pParser->toDynamicObject(strm, input.getSizeInBytes(), output, errorMessage1);
+         parsed = pParser->toDynamicObject(strm, input.getSizeInBytes(), output, parseMessage);
       }
 
-      if (parsed)
+      if (!parseMessage.empty())
       {
-         pParser->importMetadata(output, descriptor, errorMessage2);
+         errorMessage += getArgs().mPlugInName + ": " + parseMessage;
       }
+   }
+   return parsed;
+}
 
-      if (!errorMessage1.empty() || !errorMessage2.empty())
+void Nitf::TrePlugInResource::importMetadata(const DynamicObject& tre, RasterDataDescriptor& descriptor,
+   string& errorMessage) const
+{
+   const TreParser* pParser = dynamic_cast<const TreParser*>(get());
+   if (pParser != NULL)
+   {
+      string importMessage;
+      pParser->importMetadata(tre, descriptor, importMessage);
+      if (!importMessage.empty())
       {
-         errorMessage += getArgs().mPlugInName + ": ";
-
-         if (!errorMessage1.empty())
-         {
-            errorMessage += errorMessage1;
-         }
-
-         if (!errorMessage2.empty())
-         {
-            errorMessage += errorMessage2 + "\n";
-         }
+         errorMessage += getArgs().mPlugInName + ": " + importMessage + "\n";
       }
    }
-   return parsed;
 }
 
 bool Nitf::TrePlugInResource::writeTag(const DynamicObject& input, const ossim_uint32& ownerIndex,
@@ -199,9 +211,45 @@ bool Nitf::TrePlugInResource::exportMetadata(const RasterDataDescriptor& descrip
    return false;
 }
 
+// Tags are parsed through the cache when one is available, otherwise each tag is parsed with the given parsers
+static bool importNitfMetadata(const unsigned int& currentImage, const Nitf::OssimFileResource& pFile,
+   const ossimNitfFileHeaderV2_X* pFileHeader, const ossimNitfImageHeaderV2_X* pImageSubheader,
+   RasterDataDescriptor* pDescriptor, map<string, TrePlugInResource>* pParsers, TreCache* pTreCache,
+   string& errorMessage);
+
+static bool addTag(const unsigned int& ownerIndex, const ossimNitfTagInformation& tagInfo,
+   RasterDataDescriptor* pDescriptor, DynamicObject* pTres, DynamicObject* pTreInfo,
+   map<string, TrePlugInResource>* pParsers, TreCache* pTreCache, string& errorMessage)
+{
+   if (pTreCache != NULL)
+   {
+      return pTreCache->addTagToMetadata(ownerIndex, tagInfo, pDescriptor, pTres, pTreInfo, true, errorMessage);
+   }
+
+   VERIFY(pParsers != NULL);
+   return addTagToMetadata(ownerIndex, tagInfo, pDescriptor, pTres, pTreInfo, *pParsers, errorMessage);
+}
+
 bool Nitf::importMetadata(const unsigned int& currentImage, const Nitf::OssimFileResource& pFile,
    const ossimNitfFileHeaderV2_X* pFileHeader, const ossimNitfImageHeaderV2_X* pImageSubheader,
    RasterDataDescriptor* pDescriptor, map<string, TrePlugInResource>& parsers, string& errorMessage)
+{
+   return importNitfMetadata(currentImage, pFile, pFileHeader, pImageSubheader, pDescriptor, &parsers, NULL,
+      errorMessage);
+}
+
+bool Nitf::importMetadata(const unsigned int& currentImage, const Nitf::OssimFileResource& pFile,
+   const ossimNitfFileHeaderV2_X* pFileHeader, const ossimNitfImageHeaderV2_X* pImageSubheader,
+   RasterDataDescriptor* pDescriptor, TreCache& treCache, string& errorMessage)
+{
+   return importNitfMetadata(currentImage, pFile, pFileHeader, pImageSubheader, pDescriptor, NULL, &treCache,
+      errorMessage);
+}
+
+static bool importNitfMetadata(const unsigned int& currentImage, const Nitf::OssimFileResource& pFile,
+   const ossimNitfFileHeaderV2_X* pFileHeader, const ossimNitfImageHeaderV2_X* pImageSubheader,
+   RasterDataDescriptor* pDescriptor, map<string, TrePlugInResource>* pParsers, TreCache* pTreCache,
+   string& errorMessage)
 {
 //#pragma message(__FILE__ "(" STRING(__LINE__) ") : warning : Separate the file header parsing " \
 //   "from the subheader parsing (dadkins)")
@@ -256,7 +304,7 @@ bool Nitf::importMetadata(const unsigned int& currentImage, const Nitf::OssimFil
       }
       else
       {
-         addTagToMetadata(currentImage, tagInfo, pDescriptor, pTres.get(), pTreInfo.get(), parsers, errorMessage);
+         addTag(currentImage, tagInfo, pDescriptor, pTres.get(), pTreInfo.get(), pParsers, pTreCache, errorMessage);
       }
    }
 
@@ -273,7 +321,7 @@ bool Nitf::importMetadata(const unsigned int& currentImage, const Nitf::OssimFil
       else
       {
          // For file headers, currentImage is always 0.
-         addTagToMetadata(0, tagInfo, pDescriptor, pTres.get(), pTreInfo.get(), parsers, errorMessage);
+         addTag(0, tagInfo, pDescriptor, pTres.get(), pTreInfo.get(), pParsers, pTreCache, errorMessage);
       }
    }
 
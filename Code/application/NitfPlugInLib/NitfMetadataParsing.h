@@ -35,6 +35,8 @@ class ossimString;
 
 namespace Nitf
 {
+   class TreCache;
+
    /**
     * This is a %Resource class for TRE parser plug-ins.
     *
@@ -76,6 +78,35 @@ namespace Nitf
       bool parseTag(const ossimNitfRegisteredTag& input, DynamicObject& output,
          RasterDataDescriptor& descriptor, std::string& errorMessage) const;
 
+      /**
+       * Parse a TRE and store it in a DynamicObject.
+       *
+       * @param input
+       *        The ossimNitfRegisteredTag to read from.
+       * @param output
+       *        The DynamicObject to write to.
+       * @param errorMessage
+       *        If this is modified by the function, it will be displayed to the
+       *        user as a warning that imported TREs might be incomplete, missing, etc.
+       *
+       * @return \c True on success, \c false otherwise.
+       */
+      bool parseTag(const ossimNitfRegisteredTag& input, DynamicObject& output, std::string& errorMessage) const;
+
+      /**
+       * Update a RasterDataDescriptor from a parsed TRE.
+       *
+       * @param tre
+       *        The TRE parsed by parseTag().
+       * @param descriptor
+       *        The RasterDataDescriptor which should be updated.
+       * @param errorMessage
+       *        If this is modified by the function, it will be displayed to the
+       *        user as a warning that imported TREs might be incomplete, missing, etc.
+       */
+      void importMetadata(const DynamicObject& tre, RasterDataDescriptor& descriptor,
+         std::string& errorMessage) const;
+
       /**
        * Parse a TRE from a DynamicObject and store it in \c writer.
        *
@@ -141,6 +172,36 @@ namespace Nitf
       const ossimNitfFileHeaderV2_X* pFileHeader, const ossimNitfImageHeaderV2_X* pImageSubheader,
       RasterDataDescriptor* pDescriptor, std::map<std::string, TrePlugInResource>& parsers, std::string& errorMessage);
 
+  /**
+   * Imports supported metadata for the specified image into a RasterDataDescriptor.
+   *
+   * TREs are parsed through a cache so TREs which are shared by several image
+   * segments are only parsed once, and large TREs may be deferred until the
+   * image segment is imported.
+   *
+   * @param currentImage
+   *        The index of the image to import.
+   * @param pFile
+   *        The source file.
+   * @param pFileHeader
+   *        The header of the source file.
+   * @param pImageSubheader
+   *        The current image subheader.
+   * @param pDescriptor
+   *        The RasterDataDescriptor to populate.
+   * @param treCache
+   *        The TRE cache for the source file.
+   * @param errorMessage
+   *        %Message for import errors, etc.
+   *
+   * @return \c True on success, \c false otherwise.
+   *
+   * @see TreCache::loadDeferredTres()
+   */
+   bool importMetadata(const unsigned int& currentImage, const Nitf::OssimFileResource& pFile,
+      const ossimNitfFileHeaderV2_X* pFileHeader, const ossimNitfImageHeaderV2_X* pImageSubheader,
+      RasterDataDescriptor* pDescriptor, TreCache& treCache, std::string& errorMessage);
+
    /**
     * Adds a single TRE to a RasterDataDescriptor.
     *
@@ -0,0 +1,292 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "DynamicObject.h"
+#include "NitfConstants.h"
+#include "NitfTreCache.h"
+#include "RasterDataDescriptor.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#include <ossim/base/ossimRefPtr.h>
+#include <ossim/support_data/ossimNitfRegisteredTag.h>
+#include <ossim/support_data/ossimNitfTagFactoryRegistry.h>
+#include <ossim/support_data/ossimNitfTagInformation.h>
+#include <ossim/support_data/ossimNitfUnknownTag.h>
+
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   string getCacheKey(ossim_uint64 dataOffset)
+   {
+      stringstream key;
+      key << dataOffset;
+      return key.str();
+   }
+}
+
+Nitf::TreCache::TreCache(const string& filename) :
+   mFilename(filename),
+   mLastModified(QFileInfo(QString::fromStdString(filename)).lastModified())
+{}
+
+Nitf::TreCache::~TreCache()
+{}
+
+bool Nitf::TreCache::isCurrent(const string& filename) const
+{
+   return filename == mFilename && QFileInfo(QString::fromStdString(filename)).lastModified() == mLastModified;
+}
+
+bool Nitf::TreCache::addTagToMetadata(unsigned int ownerIndex, const ossimNitfTagInformation& tagInfo,
+   RasterDataDescriptor* pDescriptor, DynamicObject* pTres, DynamicObject* pTreInfo, bool allowDeferral,
+   string& errorMessage)
+{
+   string tagName = tagInfo.getTagName();
+   VERIFY(tagName.empty() == false);
+
+   const ossim_uint64 dataOffset = tagInfo.getTagDataOffset();
+   const ossim_uint32 dataLength = tagInfo.getTagLength();
+
+   // A TRE which was parsed for another image segment is used even if it could be deferred
+   const DynamicObject* pTre = NULL;
+   if (allowDeferral == false || isDeferrable(tagName, dataLength) == false ||
+      mParsedTres.find(dataOffset) != mParsedTres.end())
+   {
+      ossimRefPtr<ossimNitfRegisteredTag> pRegTag = tagInfo.getTagData();
+      VERIFY(pRegTag.get() != NULL);
+
+      pTre = parseTag(tagName, dataOffset, *pRegTag.get(), errorMessage);
+      if (pTre == NULL)
+      {
+         errorMessage += tagName + " has not been imported.\n";
+         return false;
+      }
+   }
+
+   return importTag(tagName, ownerIndex, tagInfo.getTagType(), dataOffset, dataLength, pTre, pDescriptor,
+      pTres, pTreInfo, errorMessage);
+}
+
+bool Nitf::TreCache::loadDeferredTres(RasterDataDescriptor* pDescriptor, string& errorMessage)
+{
+   VERIFY(pDescriptor != NULL);
+
+   DynamicObject* pMetadata = pDescriptor->getMetadata();
+   VERIFY(pMetadata != NULL);
+
+   DynamicObject* pTreInfo = pMetadata->getAttributeByPath(Nitf::NITF_METADATA + "/" +
+      Nitf::TRE_INFO_METADATA).getPointerToValue<DynamicObject>();
+   if (pTreInfo == NULL)
+   {
+      return true;
+   }
+
+   bool success = true;
+   QFile file(QString::fromStdString(mFilename));
+
+   vector<string> tagNames;
+   pTreInfo->getAttributeNames(tagNames);
+   for (vector<string>::const_iterator tagName = tagNames.begin(); tagName != tagNames.end(); ++tagName)
+   {
+      DynamicObject* pInstances = pTreInfo->getAttribute(*tagName).getPointerToValue<DynamicObject>();
+      if (pInstances == NULL)
+      {
+         continue;
+      }
+
+      vector<string> instances;
+      pInstances->getAttributeNames(instances);
+      for (vector<string>::const_iterator instance = instances.begin(); instance != instances.end(); ++instance)
+      {
+         DynamicObject* pInfo = pInstances->getAttribute(*instance).getPointerToValue<DynamicObject>();
+         bool deferred = false;
+         if (pInfo == NULL || pInfo->getAttribute("Deferred").getValue(deferred) == false || deferred == false)
+         {
+            continue;
+         }
+
+         uint64_t dataOffset = 0;
+         unsigned int dataLength = 0;
+         VERIFY(pInfo->getAttribute("Data Offset").getValue(dataOffset));
+         VERIFY(pInfo->getAttribute("Data Length").getValue(dataLength));
+
+         const DynamicObject* pTre = NULL;
+         map<ossim_uint64, ParsedTre>::const_iterator parsedTre = mParsedTres.find(dataOffset);
+         if (parsedTre != mParsedTres.end())
+         {
+            errorMessage += parsedTre->second.mErrorMessage;
+            if (parsedTre->second.mParsed)
+            {
+               pTre = mpParsedTres->getAttribute(getCacheKey(dataOffset)).getPointerToValue<DynamicObject>();
+            }
+         }
+         else
+         {
+            if (file.isOpen() == false && file.open(QIODevice::ReadOnly) == false)
+            {
+               errorMessage += "Unable to open the file to read the deferred TREs.\n";
+               return false;
+            }
+
+            QByteArray bytes;
+            if (file.seek(static_cast<qint64>(dataOffset)) == true)
+            {
+               bytes = file.read(dataLength);
+            }
+
+            if (bytes.size() != static_cast<int>(dataLength))
+            {
+               errorMessage += "Unable to read the " + *tagName + " TRE from the file.\n";
+               success = false;
+               continue;
+            }
+
+            ossimRefPtr<ossimNitfRegisteredTag> pTag = ossimNitfTagFactoryRegistry::instance()->create(*tagName);
+            VERIFY(pTag.get() != NULL);
+            if (pTag->canCastTo("ossimNitfUnknownTag"))
+            {
+               ossimNitfUnknownTag* pUnknown = PTR_CAST(ossimNitfUnknownTag, pTag.get());
+               pUnknown->setTagName(*tagName);
+               pUnknown->setTagLength(dataLength);
+            }
+
+            istringstream strm(string(bytes.constData(), bytes.size()));
+            pTag->parseStream(strm);
+            pTre = parseTag(*tagName, dataOffset, *pTag.get(), errorMessage);
+         }
+
+         if (pTre == NULL)
+         {
+            errorMessage += *tagName + " has not been imported.\n";
+            success = false;
+            continue;
+         }
+
+         VERIFY(pMetadata->setAttributeByPath(Nitf::NITF_METADATA + "/" + Nitf::TRE_METADATA + "/" +
+            *tagName + "/" + *instance, *pTre));
+         getParser(mParsedTres[dataOffset].mParserName).importMetadata(*pTre, *pDescriptor, errorMessage);
+         pInfo->removeAttribute("Deferred");
+      }
+   }
+
+   return success;
+}
+
+const DynamicObject* Nitf::TreCache::parseTag(const string& tagName, ossim_uint64 dataOffset,
+   const ossimNitfRegisteredTag& tag, string& errorMessage)
+{
+   map<ossim_uint64, ParsedTre>::iterator parsedTre = mParsedTres.find(dataOffset);
+   if (parsedTre == mParsedTres.end())
+   {
+      ParsedTre parsed;
+      FactoryResource<DynamicObject> pTre;
+      VERIFYRV(pTre.get() != NULL, NULL);
+
+      // Try to parse the TRE with a specialized parser and fall back to the unknown TRE parser
+      parsed.mParserName = tagName;
+      parsed.mParsed = getParser(parsed.mParserName).parseTag(tag, *pTre.get(), parsed.mErrorMessage);
+      if (parsed.mParsed == false)
+      {
+         pTre->clear();
+         parsed.mParserName = "Unknown Tre Parser";
+         parsed.mParsed = getParser(parsed.mParserName).parseTag(tag, *pTre.get(), parsed.mErrorMessage);
+      }
+
+      if (parsed.mParsed)
+      {
+         VERIFYRV(mpParsedTres->setAttribute(getCacheKey(dataOffset), *pTre.get()), NULL);
+      }
+
+      parsedTre = mParsedTres.insert(make_pair(dataOffset, parsed)).first;
+   }
+
+   errorMessage += parsedTre->second.mErrorMessage;
+   if (parsedTre->second.mParsed == false)
+   {
+      return NULL;
+   }
+
+   return mpParsedTres->getAttribute(getCacheKey(dataOffset)).getPointerToValue<DynamicObject>();
+}
+
+bool Nitf::TreCache::importTag(const string& tagName, unsigned int ownerIndex, const string& tagType,
+   ossim_uint64 dataOffset, ossim_uint32 dataLength, const DynamicObject* pTre,
+   RasterDataDescriptor* pDescriptor, DynamicObject* pTres, DynamicObject* pTreInfo, string& errorMessage)
+{
+   VERIFY(pDescriptor != NULL);
+   VERIFY(pTres != NULL);
+   VERIFY(pTreInfo != NULL);
+
+   // Parse the TRE info. The location of the data is recorded so deferred TREs can be parsed later.
+   FactoryResource<DynamicObject> pTagInfo;
+   VERIFY(pTagInfo.get() != NULL);
+   VERIFY(pTagInfo->setAttribute("Tag Type", tagType));
+   VERIFY(pTagInfo->setAttribute("Owner Index", ownerIndex));
+   VERIFY(pTagInfo->setAttribute("Data Offset", static_cast<uint64_t>(dataOffset)));
+   VERIFY(pTagInfo->setAttribute("Data Length", static_cast<unsigned int>(dataLength)));
+   if (pTre == NULL)
+   {
+      VERIFY(pTagInfo->setAttribute("Deferred", true));
+   }
+
+   // Determine how many (if any) tags of this name already exist. The TRE info is
+   // used since it also contains the deferred tags.
+   unsigned int instance = 0;
+   DynamicObject* pParentDynObj = pTreInfo->getAttribute(tagName).getPointerToValue<DynamicObject>();
+   if (pParentDynObj != NULL)
+   {
+      instance = pParentDynObj->getNumAttributes();
+   }
+
+   // Build the TRE and the TRE_INFO entries
+   stringstream strm;
+   strm << tagName << "/" << instance;
+
+   if (pTre != NULL)
+   {
+      VERIFY(pTres->setAttributeByPath(strm.str(), *pTre));
+      getParser(mParsedTres[dataOffset].mParserName).importMetadata(*pTre, *pDescriptor, errorMessage);
+   }
+
+   VERIFY(pTreInfo->setAttributeByPath(strm.str(), *pTagInfo.get()));
+   return true;
+}
+
+Nitf::TrePlugInResource& Nitf::TreCache::getParser(const string& parserName)
+{
+   // Do NOT make a copy of the parser as it has ownership which gets transferred when the assignment
+   // operator is used. Doing so would leave a stale pointer in the map.
+   map<string, TrePlugInResource>::iterator pParser = mParsers.find(parserName);
+   if (pParser == mParsers.end())
+   {
+      pParser = mParsers.insert(make_pair(parserName, TrePlugInResource(parserName))).first;
+   }
+
+   return pParser->second;
+}
+
+bool Nitf::TreCache::isDeferrable(const string& tagName, ossim_uint32 dataLength) const
+{
+   // These TREs are used while the import descriptor is created so they are never deferred
+   if (tagName == "BANDSB" || tagName == "ICHIPB" || tagName == "STDIDB")
+   {
+      return false;
+   }
+
+   unsigned int deferredSize = getSettingDeferredTreSize();
+   return deferredSize > 0 && dataLength >= deferredSize;
+}
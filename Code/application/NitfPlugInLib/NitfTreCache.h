@@ -0,0 +1,145 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef NITFTRECACHE_H
+#define NITFTRECACHE_H
+
+#include "ConfigurationSettings.h"
+#include "NitfMetadataParsing.h"
+#include "ObjectResource.h"
+
+#include <ossim/base/ossimConstants.h>
+
+#include <QtCore/QDateTime>
+
+#include <map>
+#include <string>
+
+class DynamicObject;
+class RasterDataDescriptor;
+class ossimNitfTagInformation;
+
+namespace Nitf
+{
+   /**
+    * Caches TRE parsers and parsed TREs for a single NITF file.
+    *
+    * Parsing a TRE with a parser plug-in is the most expensive part of creating
+    * import descriptors for files with large TREs. The file header TREs are shared
+    * by every image segment, so each TRE is parsed once and the parsed result is
+    * reused for every segment which needs it. TREs are identified by the offset of
+    * their data in the file.
+    *
+    * TREs which are at least TreCache::getSettingDeferredTreSize() bytes are not
+    * parsed when the import descriptors are created. Their location in the file is
+    * recorded in the TRE_INFO metadata and they are parsed by loadDeferredTres()
+    * when the image segment is imported.
+    */
+   class TreCache
+   {
+   public:
+      SETTING(DeferredTreSize, TreCache, unsigned int, 0);
+
+      /**
+       * Creates an empty cache for a file.
+       *
+       * @param filename
+       *        The full path and name of the NITF file.
+       */
+      TreCache(const std::string& filename);
+
+      /**
+       * Destroys the cached TREs and unloads the TRE parsers.
+       */
+      ~TreCache();
+
+      /**
+       * Queries whether the cache describes the current contents of a file.
+       *
+       * @param filename
+       *        The full path and name of the NITF file.
+       *
+       * @return \c True if the cache was created for \c filename and the file
+       *         has not been modified since, \c false otherwise.
+       */
+      bool isCurrent(const std::string& filename) const;
+
+      /**
+       * Adds a single TRE to a RasterDataDescriptor.
+       *
+       * The TRE is parsed the first time it is added from any image segment and the
+       * cached result is used afterwards. The parser's import of metadata into the
+       * descriptor is performed every time since it depends on the descriptor.
+       *
+       * @param ownerIndex
+       *        The index of the owner of this TRE.
+       * @param tagInfo
+       *        Information about the TRE.
+       * @param pDescriptor
+       *        The RasterDataDescriptor to populate.
+       * @param pTres
+       *        The DynamicObject containing the TREs.
+       * @param pTreInfo
+       *        The DynamicObject containing the locations of the TREs.
+       * @param allowDeferral
+       *        If \c true, large TREs are only recorded in \c pTreInfo and are not
+       *        parsed until loadDeferredTres() is called.
+       * @param errorMessage
+       *        %Message for import errors, etc.
+       *
+       * @return \c True on success, \c false otherwise.
+       */
+      bool addTagToMetadata(unsigned int ownerIndex, const ossimNitfTagInformation& tagInfo,
+         RasterDataDescriptor* pDescriptor, DynamicObject* pTres, DynamicObject* pTreInfo, bool allowDeferral,
+         std::string& errorMessage);
+
+      /**
+       * Parses the TREs which were deferred when the import descriptor was created.
+       *
+       * @param pDescriptor
+       *        The RasterDataDescriptor whose metadata contains deferred TREs.
+       * @param errorMessage
+       *        %Message for import errors, etc.
+       *
+       * @return \c True if all deferred TREs were parsed, \c false otherwise.
+       */
+      bool loadDeferredTres(RasterDataDescriptor* pDescriptor, std::string& errorMessage);
+
+   private:
+      TreCache(const TreCache& rhs);
+      TreCache& operator=(const TreCache& rhs);
+
+      struct ParsedTre
+      {
+         ParsedTre() : mParsed(false) {}
+
+         bool mParsed;
+         std::string mParserName;
+         std::string mErrorMessage;
+      };
+
+      const DynamicObject* parseTag(const std::string& tagName, ossim_uint64 dataOffset,
+         const ossimNitfRegisteredTag& tag, std::string& errorMessage);
+      bool importTag(const std::string& tagName, unsigned int ownerIndex, const std::string& tagType,
+         ossim_uint64 dataOffset, ossim_uint32 dataLength, const DynamicObject* pTre,
+         RasterDataDescriptor* pDescriptor, DynamicObject* pTres, DynamicObject* pTreInfo, std::string& errorMessage);
+      TrePlugInResource& getParser(const std::string& parserName);
+      bool isDeferrable(const std::string& tagName, ossim_uint32 dataLength) const;
+
+      std::string mFilename;
+      QDateTime mLastModified;
+      std::map<std::string, TrePlugInResource> mParsers;
+      std::map<ossim_uint64, ParsedTre> mParsedTres;
+
+      // Declared after the parsers so the parsed TREs are destroyed while the parsers are still loaded
+      FactoryResource<DynamicObject> mpParsedTres;
+   };
+}
+
+#endif
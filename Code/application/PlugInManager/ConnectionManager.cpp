@@ -22,6 +22,7 @@
 #include "DesktopServicesImp.h"
 #include "ModelServicesImp.h"
 #include "PlugInManagerServicesImp.h"
+#include "TracerImp.h"
 #include "UtilityServicesImp.h"
 
 #include <string>
@@ -149,6 +150,11 @@ bool ConnectionManager::queryInterface(const char* interfaceName, void** interfa
       *interfaceAddress = static_cast<ApplicationServices*>(ApplicationServicesImp::instance());
    }
 
+   if (name == "Tracer1")
+   {
+      *interfaceAddress = static_cast<Tracer*>(TracerImp::instance());
+   }
+
    if (*interfaceAddress != NULL)
    {
       return true;
@@ -12,13 +12,16 @@
 const DimensionDescriptor CachedPage::CacheUnit::ALL_BANDS = DimensionDescriptor();
 
 CachedPage::CacheUnit::CacheUnit(char* pData, DimensionDescriptor startRow, int concurrentRows, size_t size,
-                                 DimensionDescriptor band, unsigned int interlineBytes) :
+                                 DimensionDescriptor band, unsigned int interlineBytes,
+                                 DimensionDescriptor startColumn, unsigned int concurrentColumns) :
    mpData(pData),
    mStartRow(startRow),
    mConcurrentRows(concurrentRows),
    mBand(band),
    mSize(size),
-   mInterlineBytes(interlineBytes)
+   mInterlineBytes(interlineBytes),
+   mStartColumn(startColumn),
+   mConcurrentColumns(startColumn.isValid() ? concurrentColumns : 0)
 {
 }
 
@@ -36,7 +39,28 @@ bool CachedPage::CacheUnit::matches(DimensionDescriptor startRow, int concurrent
 {
    if (startRow.getActiveNumber() >= mStartRow.getActiveNumber() && 
       (mBand == band) &&
-      startRow.getActiveNumber() + concurrentRows <= mStartRow.getActiveNumber() + mConcurrentRows)
+      startRow.getActiveNumber() + concurrentRows <= mStartRow.getActiveNumber() + mConcurrentRows &&
+      mConcurrentColumns == 0)
+   {
+      return true;
+   }
+   return false;
+}
+
+bool CachedPage::CacheUnit::matches(DimensionDescriptor startRow, int concurrentRows, DimensionDescriptor startColumn,
+                                    int concurrentColumns, DimensionDescriptor band)
+{
+   // a unit with full rows contains every column
+   if (mConcurrentColumns == 0)
+   {
+      return matches(startRow, concurrentRows, band);
+   }
+
+   if (startRow.getActiveNumber() >= mStartRow.getActiveNumber() && 
+      startColumn.getActiveNumber() >= mStartColumn.getActiveNumber() && 
+      (mBand == band) &&
+      startRow.getActiveNumber() + concurrentRows <= mStartRow.getActiveNumber() + mConcurrentRows &&
+      startColumn.getActiveNumber() + concurrentColumns <= mStartColumn.getActiveNumber() + mConcurrentColumns)
    {
       return true;
    }
@@ -68,10 +92,32 @@ unsigned int CachedPage::CacheUnit::getInterlineBytes()
    return mInterlineBytes;
 }
 
+DimensionDescriptor CachedPage::CacheUnit::getStartColumn() const
+{
+   return mStartColumn;
+}
+
+unsigned int CachedPage::CacheUnit::getConcurrentColumns()
+{
+   return mConcurrentColumns;
+}
+
 CachedPage::CachedPage(UnitPtr pCacheUnit, size_t offset, DimensionDescriptor startRow) :
    mpCacheUnit(pCacheUnit),
    mOffset(offset),
-   mStartRow(startRow)
+   mStartRow(startRow),
+   mNumColumns(0),
+   mInterlineBytes(pCacheUnit->getInterlineBytes())
+{
+}
+
+CachedPage::CachedPage(UnitPtr pCacheUnit, size_t offset, DimensionDescriptor startRow, unsigned int numColumns,
+                       unsigned int interlineBytes) :
+   mpCacheUnit(pCacheUnit),
+   mOffset(offset),
+   mStartRow(startRow),
+   mNumColumns(numColumns),
+   mInterlineBytes(interlineBytes)
 {
 }
 
@@ -92,7 +138,7 @@ unsigned int CachedPage::getNumRows()
 
 unsigned int CachedPage::getNumColumns()
 {
-   return 0;
+   return mNumColumns;
 }
 
 unsigned int CachedPage::getNumBands()
@@ -102,5 +148,5 @@ unsigned int CachedPage::getNumBands()
 
 unsigned int CachedPage::getInterlineBytes()
 {
-   return mpCacheUnit->getInterlineBytes();
+   return mInterlineBytes;
 }
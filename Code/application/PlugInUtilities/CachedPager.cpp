@@ -20,6 +20,7 @@
 #include "PlugInManagerServices.h"
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
+#include "TraceSpan.h"
 
 using namespace std;
 
@@ -128,9 +129,6 @@ RasterPage* CachedPager::getPage(DataRequest *pOriginalRequest,
 
    VERIFYRV(pOriginalRequest != NULL, NULL);
 
-   mta::MutexLock lock(*mpMutex);
-
-
    InterleaveFormatType requestedFormat = pOriginalRequest->getInterleaveFormat();
    DimensionDescriptor stopRow = pOriginalRequest->getStopRow();
    DimensionDescriptor stopBand = pOriginalRequest->getStopBand();
@@ -141,11 +139,26 @@ RasterPage* CachedPager::getPage(DataRequest *pOriginalRequest,
       return NULL;
    }
 
-   CachedPage::UnitPtr pUnit = mCache.getUnit(pOriginalRequest, startRow, startBand);
+   bool tiled = pOriginalRequest->getTiled() && requestedFormat != BIL;
+   TraceSpan span("raster", "Page Cache Hit");
+
+   // Pagers which can not read concurrently hold the lock from the lookup through the insertion so a unit
+   // is only ever read once.  Thread-safe pagers only hold it while accessing the cache.
+   bool fetchThreadSafe = isFetchUnitThreadSafe();
+   std::auto_ptr<mta::MutexLock> pLock(new mta::MutexLock(*mpMutex));
+   CachedPage::UnitPtr pUnit = mCache.getUnit(pOriginalRequest, startRow, startColumn, startBand);
+   if (pUnit.get() != NULL)
+   {
+      return mCache.createPage(pUnit, requestedFormat, startRow, startColumn, startBand, tiled);
+   }
+
+   if (fetchThreadSafe)
+   {
+      pLock.reset();
+   }
 
    DimensionDescriptor cacheStartBand = startBand;
    DimensionDescriptor cacheStopBand = stopBand;
-   if (pUnit.get() == NULL) // cache miss
    {
       if (requestedFormat != BSQ)
       {
@@ -154,15 +167,34 @@ RasterPage* CachedPager::getPage(DataRequest *pOriginalRequest,
          concurrentBands = mBandCount;
       }
 
+      // Get full columns unless the file is stored in tiles, in which case get the tile columns
+      // which contain the requested columns
+      DimensionDescriptor cacheStartColumn;
+      DimensionDescriptor cacheStopColumn;
+      unsigned int concurrentColumns = mColumnCount;
+      unsigned int tileColumns = getTileColumnCount();
+      if (tiled && tileColumns > 0)
+      {
+         unsigned int firstColumn = startColumn.getActiveNumber();
+         unsigned int lastColumn = std::min(firstColumn + pOriginalRequest->getConcurrentColumns(),
+            static_cast<unsigned int>(mColumnCount)) - 1;
+         firstColumn -= firstColumn % tileColumns;
+         lastColumn = std::min((lastColumn / tileColumns + 1) * tileColumns, static_cast<unsigned int>(mColumnCount)) - 1;
+         cacheStartColumn = mpDescriptor->getActiveColumn(firstColumn);
+         cacheStopColumn = mpDescriptor->getActiveColumn(lastColumn);
+         concurrentColumns = lastColumn - firstColumn + 1;
+      }
+
       // get a bunch more rows if you can to prevent a cache miss
       unsigned int concurrentRows = std::max(pOriginalRequest->getConcurrentRows(),
-         static_cast<unsigned int>(getChunkSize() / (concurrentBands * mColumnCount * mBytesPerBand)));
+         static_cast<unsigned int>(getChunkSize() / (concurrentBands * concurrentColumns * mBytesPerBand)));
       concurrentRows = std::min(concurrentRows, stopRow.getActiveNumber() - startRow.getActiveNumber() + 1);
 
       FactoryResource<DataRequest> pNewRequest;
       pNewRequest->setInterleaveFormat(requestedFormat);
       pNewRequest->setRows(startRow, stopRow, concurrentRows);
-      // Get full columns
+      pNewRequest->setColumns(cacheStartColumn, cacheStopColumn, concurrentColumns);
+      pNewRequest->setTiled(cacheStartColumn.isValid());
       pNewRequest->setBands(cacheStartBand, cacheStopBand);
 
       pNewRequest->polish(mpDescriptor);
@@ -170,9 +202,30 @@ RasterPage* CachedPager::getPage(DataRequest *pOriginalRequest,
       {
          pUnit = fetchUnit(pNewRequest.get());
       }
+
+      if (span.isActive())
+      {
+         span.setName("Page Cache Miss");
+         if (pUnit.get() != NULL)
+         {
+            span.setBytes(pUnit->getSize());
+         }
+      }
+   }
+
+   if (fetchThreadSafe)
+   {
+      pLock.reset(new mta::MutexLock(*mpMutex));
+
+      // another thread may have cached the same unit while this one was reading it
+      CachedPage::UnitPtr pCachedUnit = mCache.getUnit(pOriginalRequest, startRow, startColumn, startBand);
+      if (pCachedUnit.get() != NULL)
+      {
+         pUnit = pCachedUnit;
+      }
    }
 
-   return mCache.createPage(pUnit, requestedFormat, startRow, startColumn, startBand);
+   return mCache.createPage(pUnit, requestedFormat, startRow, startColumn, startBand, tiled);
 }
 
 void CachedPager::releasePage(RasterPage *pPage)
@@ -184,7 +237,7 @@ void CachedPager::releasePage(RasterPage *pPage)
 
 int CachedPager::getSupportedRequestVersion() const
 {
-   return 1;
+   return 2;
 }
 
 const int CachedPager::getBytesPerBand() const
@@ -211,3 +264,13 @@ double CachedPager::getChunkSize() const
 {
    return 1 * 1024 * 1024;
 }
+
+unsigned int CachedPager::getTileColumnCount() const
+{
+   return 0;
+}
+
+bool CachedPager::isFetchUnitThreadSafe() const
+{
+   return false;
+}
@@ -51,9 +51,17 @@ public:
        *        The band provided if BSQ, or ALL_BANDS if all bands are provided.
        * @param interlineBytes
        *        The number of interline bytes within the buffer.
+       * @param startColumn
+       *        The starting column for this unit if the unit contains a subset
+       *        of the columns.  An invalid DimensionDescriptor indicates that
+       *        each row of the unit contains all of the columns.
+       * @param concurrentColumns
+       *        The number of columns in each row of the unit.  This is ignored
+       *        unless \p startColumn is valid.
        */
       CacheUnit(char *pData, DimensionDescriptor startRow, int concurrentRows, size_t size, 
-         DimensionDescriptor band = ALL_BANDS, unsigned int interlineBytes = 0);
+         DimensionDescriptor band = ALL_BANDS, unsigned int interlineBytes = 0,
+         DimensionDescriptor startColumn = DimensionDescriptor(), unsigned int concurrentColumns = 0);
 
       /**
        * Destroy a CacheUnit.
@@ -77,9 +85,31 @@ public:
        *         The number of rows needed at any given time.
        * @param  band
        *         For BSQ data, the band number. When called on BIP data, this is assumed to be ALL_BANDS.
+       *
+       * @return \c True if the unit contains the rows and all of the columns, \c false otherwise.
        */
       bool matches(DimensionDescriptor startRow, int concurrentRows, DimensionDescriptor band);
 
+      /**
+       * A function that determines if a block of rows and columns and a band (for BSQ)
+       * is contained by this current page.
+       *
+       * @param  startRow
+       *         The start row of the block that may be requested.
+       * @param  concurrentRows
+       *         The number of rows needed at any given time.
+       * @param  startColumn
+       *         The start column of the block that may be requested.
+       * @param  concurrentColumns
+       *         The number of columns needed at any given time.
+       * @param  band
+       *         For BSQ data, the band number. When called on BIP data, this is assumed to be ALL_BANDS.
+       *
+       * @return \c True if the unit contains the block, \c false otherwise.
+       */
+      bool matches(DimensionDescriptor startRow, int concurrentRows, DimensionDescriptor startColumn,
+         int concurrentColumns, DimensionDescriptor band);
+
       /**
        * Accessor function to private data.
        *
@@ -108,6 +138,22 @@ public:
        */
       unsigned int getConcurrentRows();
 
+      /**
+       * Accessor function to private data.
+       *
+       * @return The start column of this block or an invalid DimensionDescriptor
+       *         if each row of the block contains all of the columns.
+       */
+      DimensionDescriptor getStartColumn() const;
+
+      /**
+       * Get the number of columns in each row of the cache unit.
+       *
+       * @return The number of columns in each row or 0 if each row of the block
+       *         contains all of the columns.
+       */
+      unsigned int getConcurrentColumns();
+
       /**
        * Get the number of interline bytes contained in the cache unit.
        *
@@ -122,6 +168,8 @@ public:
       DimensionDescriptor mBand; // for BSQ
       size_t mSize;
       unsigned int mInterlineBytes;
+      DimensionDescriptor mStartColumn;
+      unsigned int mConcurrentColumns;
    };
 
    typedef boost::shared_ptr<CacheUnit> UnitPtr;
@@ -139,6 +187,24 @@ public:
     */
    CachedPage(UnitPtr pCacheUnit, size_t offset, DimensionDescriptor startRow);
 
+   /**
+    * Creates a CachedPage which contains a subset of the columns in each row.
+    *
+    * @param pCacheUnit
+    *        The CacheUnit for this page
+    * @param offset
+    *        The number of bytes to offset into the block. This does not account for size of the
+    *        data type.
+    * @param startRow
+    *        The start row for this page.
+    * @param numColumns
+    *        The number of columns in each row of the page.
+    * @param interlineBytes
+    *        The number of bytes between the last column of a row and the first column of the next row.
+    */
+   CachedPage(UnitPtr pCacheUnit, size_t offset, DimensionDescriptor startRow, unsigned int numColumns,
+      unsigned int interlineBytes);
+
    /**
     * Virtual destructor to ensure proper deletion of inherited classes.
     */
@@ -160,9 +226,9 @@ public:
 
 
    /**
-    * Inherited obligations that return 0.
+    * Access the number of columns in the page.
     *
-    * @return Returns 0.
+    * @return The number of columns in the page or 0 if the page contains all of the columns.
     */
    unsigned int getNumColumns();
    
@@ -193,6 +259,8 @@ private:
    size_t mOffset;
 
    DimensionDescriptor mStartRow;
+   unsigned int mNumColumns;
+   unsigned int mInterlineBytes;
 };
 
 #endif
@@ -304,6 +304,37 @@ protected:
     */
    virtual double getChunkSize() const;
 
+   /**
+    *  Returns the width of the tiles in which the file is natively stored.
+    *
+    *  If this returns a non-zero value, cache misses for tiled DataRequest objects
+    *  call fetchUnit() with a tiled request for only the tile columns which contain the
+    *  requested columns.  fetchUnit() must then return a CacheUnit with a valid
+    *  start column and the number of columns requested.  Cache misses for requests
+    *  which are not tiled always request full rows.
+    *
+    *  @return  The number of active columns in each tile, or 0 to always read full rows.
+    *           Default implementation returns 0.
+    *
+    *  @see DataRequest::setTiled()
+    */
+   virtual unsigned int getTileColumnCount() const;
+
+   /**
+    *  Returns whether fetchUnit() may be called by several threads at once.
+    *
+    *  If this returns \c true, cache misses call fetchUnit() without holding the
+    *  pager's lock so pages may be read concurrently. Two threads which miss the
+    *  same unit at the same time may then both read it, but only the first unit
+    *  inserted is kept in the cache.  If this returns \c false, the lock is held
+    *  from the cache lookup until the fetched unit is cached, so each unit is
+    *  read once and calls to fetchUnit() are serialized.
+    *
+    *  @return  \c True if fetchUnit() is thread-safe, \c false to serialize the calls.
+    *           Default implementation returns \c false.
+    */
+   virtual bool isFetchUnitThreadSafe() const;
+
 private:
    CachedPager& operator=(const CachedPager& rhs);
 
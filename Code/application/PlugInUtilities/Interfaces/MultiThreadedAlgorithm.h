@@ -19,7 +19,9 @@
 #include "DMutex.h"
 #include "EnumWrapper.h"
 #include "MessageLogResource.h"
+#include "ThreadPool.h"
 
+#include <deque>
 #include <numeric>
 #include <algorithm>
 #include <sstream>
@@ -258,6 +260,152 @@ private:
    Result signalMainThread(ThreadCommand& reportStatus, ReportType type);
 };
 
+/**
+ * Communicates between the tasks of an algorithm running on the ThreadPool and the thread which runs the algorithm.
+ *
+ * Progress is stored in a counter for each thread and errors are recorded under a lock, so
+ * reports never wait for the main thread.  The main thread polls the progress and errors
+ * while it waits for the tasks.  Commands passed to runInMainThread() are queued and the
+ * calling thread waits until the main thread has run them, unless it is the main thread.
+ */
+class TaskReporter : public ThreadReporter
+{
+public:
+   /**
+    * Constructor.
+    *
+    * The thread which creates the reporter is its main thread.
+    *
+    * @param threadCount
+    *        The number of threads which report progress.
+    * @param tasks
+    *        The group which the main thread waits on, notified when a command is queued.
+    */
+   TaskReporter(int threadCount, TaskGroup& tasks);
+
+   /**
+    * Destructor.
+    */
+   virtual ~TaskReporter() {};
+
+   /**
+    * @copydoc ThreadReporter::reportProgress()
+    */
+   Result reportProgress(int threadIndex, int percentDone);
+
+   /**
+    * @copydoc ThreadReporter::reportCompletion()
+    */
+   Result reportCompletion(int threadIndex);
+
+   /**
+    * @copydoc ThreadReporter::reportError()
+    */
+   Result reportError(std::string errorText);
+
+   /**
+    * Get the average progress of all threads.
+    *
+    * @return Percent complete for the algorithm.
+    */
+   int getProgress() const;
+
+   /**
+    * @copydoc ThreadReporter::getProgress
+    */
+   int getProgress(int threadIndex) const;
+
+   /**
+    * @copydoc ThreadReporter::getErrorText()
+    */
+   std::string getErrorText() const;
+
+   /**
+    * Returns \c true if an error has been reported.
+    */
+   bool hasError() const;
+
+   /**
+    * @copydoc ThreadReporter::runInMainThread()
+    */
+   void runInMainThread(ThreadCommand& command);
+
+   /**
+    * Runs the commands queued by runInMainThread().
+    *
+    * This must be called from the main thread.
+    */
+   void runMainThreadCommands();
+
+private:
+   TaskReporter(const TaskReporter& rhs);
+   TaskReporter& operator=(const TaskReporter& rhs);
+
+   struct MainThreadRequest
+   {
+      ThreadCommand* mpCommand;
+      bool mComplete;
+   };
+
+   TaskGroup& mTasks;
+   pthread_t mMainThread;
+   std::vector<AtomicCounter> mThreadProgress;
+   AtomicCounter mFailed;
+   std::string mErrorMessage;
+   std::deque<MainThreadRequest*> mRequests;
+   mutable DMutex mMutex;
+   DThreadSignal mRequestSignal;
+};
+
+/**
+ * Hands out chunks of the items processed by the threads of an algorithm in order.
+ *
+ * Threads which finish their chunks quickly take more of them, so the work stays balanced
+ * when the cost of each item varies, such as when only part of the data is in an AOI.
+ * The number of completed items is the progress of the whole algorithm.
+ *
+ * @see AlgorithmThread::getNextRange()
+ */
+class WorkQueue
+{
+public:
+   /**
+    * Creates a queue whose first chunk starts at item zero.
+    */
+   WorkQueue();
+
+   /**
+    * Takes the next chunk.
+    *
+    * @param dataSize
+    *        The total number of items.
+    * @param chunkSize
+    *        The number of items in the chunk.
+    * @param first
+    *        Set to the first item of the chunk.
+    * @return \c True if a chunk was taken, \c false if every item has been handed out.
+    */
+   bool takeChunk(int dataSize, int chunkSize, int& first);
+
+   /**
+    * Records that items have been processed.
+    *
+    * @param count
+    *        The number of items.
+    */
+   void completeItems(int count);
+
+   /**
+    * Returns the percentage of the items which have been processed, or -1 if no chunk has been taken.
+    */
+   int getProgress() const;
+
+private:
+   AtomicCounter mNextItem;
+   AtomicCounter mCompletedItems;
+   AtomicCounter mDataSize;
+};
+
 // this pragma shushes a compiler warning regarding the initialization
 // of the mThreadHandle with 'this'
 #if defined(WIN_API)
@@ -283,7 +431,13 @@ public:
       mpAlgorithmMutex(NULL),
       mReporter(reporter), 
       mThreadHandle(static_cast<void*>(this),  reinterpret_cast<void*>(AlgorithmThread::threadFunction)), 
-      mThreadIndex(threadIndex) {}
+      mThreadIndex(threadIndex),
+      mpWorkQueue(NULL),
+      mChunkItems(0),
+      mRangeTaken(false)
+   {
+      mWorkRange.mLast = -1;
+   }
 
    /**
     * Destructor.
@@ -300,7 +454,11 @@ public:
       mpAlgorithmMutex(thread.mpAlgorithmMutex),
       mReporter(thread.mReporter), 
       mThreadHandle(static_cast<void*>(this),  reinterpret_cast<void*>(AlgorithmThread::threadFunction)),
-      mThreadIndex(thread.mThreadIndex) {}
+      mThreadIndex(thread.mThreadIndex),
+      mWorkRange(thread.mWorkRange),
+      mpWorkQueue(thread.mpWorkQueue),
+      mChunkItems(thread.mChunkItems),
+      mRangeTaken(thread.mRangeTaken) {}
 
    /**
     * The function executed by the underlying threading system.
@@ -356,6 +514,18 @@ public:
     */
    void waitForAlgorithmLoop();
 
+   /**
+    * Set the queue which hands out chunks of work to the threads in an algorithm cluster.
+    *
+    * This should be the same object for all threads in the algorithm cluster.
+    *
+    * @param pQueue
+    *        The queue, or \c NULL to give each thread a fixed range.
+    *
+    * @see getNextRange()
+    */
+   void setWorkQueue(WorkQueue* pQueue);
+
    /**
     * Represents a range in integers.
     */
@@ -404,6 +574,29 @@ protected:
     */
    Range getThreadRange(int threadCount, int dataSize) const;
 
+   /**
+    * Take the next range of values for this thread to process.
+    *
+    * Call this in a loop until it returns \c false.  When the algorithm has a WorkQueue,
+    * the threads take small chunks in turn so a thread whose items are cheap to process
+    * takes more of them.  Otherwise the first call returns the same range as
+    * getThreadRange().  Each call also records the items of the previous range as
+    * complete, which is reported as the progress of the algorithm, so the thread does
+    * not need to report progress itself.
+    *
+    * @param threadCount
+    *        The total number of threads in an algorithm cluster.
+    * @param dataSize
+    *        The total number of items which need to be processed.
+    * @param range
+    *        Set to the range of items to process.
+    * @param chunkSize
+    *        The number of items in each range, or zero to divide the items into eight
+    *        ranges for each thread.
+    * @return \c True if a range was taken, \c false if there are no more items.
+    */
+   bool getNextRange(int threadCount, int dataSize, Range& range, int chunkSize = 0);
+
    /**
     * Get the id of this thread.
     *
@@ -423,6 +616,10 @@ private:
    ThreadReporter& mReporter;
    BThread mThreadHandle;
    int mThreadIndex;
+   mutable Range mWorkRange;  // The items processed by this thread, reported when tracing
+   WorkQueue* mpWorkQueue;
+   int mChunkItems;
+   bool mRangeTaken;
 };
 
 #if defined(WIN_API)
@@ -452,6 +649,20 @@ private:
  *    // put per-thread information into member data here
  * };
  * @endcode
+ *
+ * The threads run on the ThreadPool, so algorithms may be nested.  Rather than processing
+ * the fixed range from getThreadRange(), run() should take ranges until there are none left
+ * so the work is balanced between the threads:
+ * @code
+ * void MyAlgorithmThread::run()
+ * {
+ *    Range range;
+ *    while (getNextRange(mThreadCount, mDataSize, range))
+ *    {
+ *       // process items range.mFirst through range.mLast
+ *    }
+ * }
+ * @endcode
  */
 
 /**
@@ -631,6 +842,10 @@ private:
 
 /**
  * An algorithm which distributes work between multiply threads. (SIMD)
+ *
+ * Each AlgThread runs as a task on the process-wide ThreadPool instead of on a thread of
+ * its own, and the thread which calls run() services progress, errors and
+ * AlgorithmThread::runInMainThread() requests until the tasks complete.
  */
 template<class AlgInput, class AlgOutput, class AlgThread>
 class MultiThreadedAlgorithm
@@ -676,23 +891,39 @@ public:
 private:
    MultiThreadedAlgorithm& operator=(const MultiThreadedAlgorithm& rhs);
 
+   /**
+    * Runs an AlgorithmThread as a ThreadPool task.
+    */
+   class AlgorithmTask : public ThreadCommand
+   {
+   public:
+      explicit AlgorithmTask(AlgThread& thread) : mThread(thread) {}
+
+      void run()
+      {
+         AlgorithmThread::threadFunction(&mThread);
+      }
+
+   private:
+      AlgorithmTask& operator=(const AlgorithmTask& rhs);
+
+      AlgThread& mThread;
+   };
+
    Result createThreads(int threadCount);
-   Result startAllThreads();
-   Result waitForThreadsToComplete();
-   int processCurrentReports(int percentDone);
-   int processReport(unsigned int currentType, int percentDone);
+   Result runThreads();
+   void processCurrentReports(bool complete, int& percentDone);
    Result compileResults();
 
    Result mCurrentStatus;
    const AlgInput& mInput;
    AlgOutput& mOutput;
+   TaskGroup mTasks;
    std::vector<AlgThread*> mThreads;
-   MultiThreadReporter* mpThreadReporter;
+   std::vector<AlgorithmTask*> mThreadTasks;
+   TaskReporter* mpThreadReporter;
+   WorkQueue mWorkQueue;
    ProgressReporter* mpProgressReporter;
-   DMutex mMutexA;
-   DThreadSignal mSignalA;
-   DMutex mMutexB;
-   DThreadSignal mSignalB;
    std::string mErrorText;
 };
 
@@ -705,13 +936,24 @@ MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::MultiThreadedAlgorithm(i
    mpThreadReporter(NULL),
    mpProgressReporter(pReporter)
 {
-   mpThreadReporter = new MultiThreadReporter(threadCount, &mCurrentStatus, mMutexA, mSignalA, mMutexB, mSignalB);
+   mpThreadReporter = new TaskReporter(threadCount, mTasks);
    createThreads(threadCount);
 }
 
 template<class AlgInput, class AlgOutput, class AlgThread>
 MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::~MultiThreadedAlgorithm()
 {
+   // run() waits for the tasks, but wait here as well in case it was not called
+   mTasks.wait();
+
+   typename std::vector<AlgorithmTask*>::iterator taskIter;
+   for (taskIter = mThreadTasks.begin(); taskIter != mThreadTasks.end(); ++taskIter)
+   {
+      delete *taskIter;
+   }
+
+   mThreadTasks.clear();
+
    typename std::vector<AlgThread*>::iterator iter;
    for (iter = mThreads.begin(); iter != mThreads.end(); ++iter)
    {
@@ -736,114 +978,69 @@ Result MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::createThreads(int
       pThread = new AlgThread(mInput, threadCount, i, *mpThreadReporter);
       if (pThread != NULL)
       {
-         pThread->setAlgorithmMutex(&mMutexA);
+         pThread->setWorkQueue(&mWorkQueue);
          mThreads.push_back(pThread);
+         mThreadTasks.push_back(new AlgorithmTask(*pThread));
       }
    }
    return SUCCESS;
 }
 
 template<class AlgInput, class AlgOutput, class AlgThread>
-Result MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::startAllThreads()
+Result MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::runThreads()
 {
-   typename std::vector<AlgThread*>::iterator iter;
-
-   mMutexA.MutexLock();
-   mMutexB.MutexLock();
-
-   for (iter = mThreads.begin(); iter != mThreads.end(); ++iter)
+   typename std::vector<AlgorithmTask*>::iterator iter;
+   for (iter = mThreadTasks.begin(); iter != mThreadTasks.end(); ++iter)
    {
-      (*iter)->launch();
+      mTasks.run(**iter);
    }
-   return SUCCESS;
-}
-
-template<class AlgInput, class AlgOutput, class AlgThread>
-Result MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::waitForThreadsToComplete()
-{
-   bool doneProcessing = false;
-   int percentDone = 0;
 
-   mMutexB.MutexUnlock();
-   while (!doneProcessing)
+   // The tasks always run to completion since they use this object, so requests
+   // from the threads are still serviced after an error
+   bool complete = false;
+   int percentDone = -1;
+   while (!complete)
    {
-      mSignalA.ThreadSignalWait(&mMutexA);
-
-      percentDone = processCurrentReports(percentDone);
-      doneProcessing = (percentDone == 100 || mCurrentStatus != SUCCESS);
-      if (doneProcessing)
-      {
-         mMutexA.MutexUnlock();
-
-         typename std::vector<AlgThread*>::iterator iter;
-         for (iter = mThreads.begin(); iter != mThreads.end(); ++iter)
-         {
-            (*iter)->wait();
-         }
-      }
+      complete = mTasks.wait(100);
+      processCurrentReports(complete, percentDone);
    }
 
    return mCurrentStatus;
 }
 
 template<class AlgInput, class AlgOutput, class AlgThread>
-int MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::processCurrentReports(int percentDone)
+void MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::processCurrentReports(bool complete, int& percentDone)
 {
-   mMutexB.MutexLock();
+   mpThreadReporter->runMainThreadCommands();
 
-   int type = mpThreadReporter->getReportType();
-   unsigned int currentType = MultiThreadReporter::THREAD_WORK;
-   while (currentType != 0)
+   if (mCurrentStatus == SUCCESS && mpThreadReporter->hasError())
    {
-      if (type & currentType)
+      mErrorText = mpThreadReporter->getErrorText();
+      mCurrentStatus = FAILURE;
+      if (mpProgressReporter != NULL)
       {
-         percentDone = processReport(currentType, percentDone);
+         mpProgressReporter->reportError(mErrorText);
       }
-      currentType /= 2;
    }
 
-   mpThreadReporter->setReportType(MultiThreadReporter::THREAD_NO_REPORT);
-
-   mSignalB.ThreadSignalActivate();
-   mMutexB.MutexUnlock();
-
-   return percentDone;
-}
-
-template<class AlgInput, class AlgOutput, class AlgThread>
-int MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::processReport(unsigned int currentType, int percentDone)
-{
-   switch (currentType)
+   if (mCurrentStatus == SUCCESS && mpProgressReporter != NULL)
    {
-      case MultiThreadReporter::THREAD_NO_REPORT:
-         break;
-      case MultiThreadReporter::THREAD_COMPLETE:
-      case MultiThreadReporter::THREAD_PROGRESS:
-         percentDone = mpThreadReporter->getProgress();
-         if (mpProgressReporter != NULL)
-         {
-            mpProgressReporter->reportProgress(percentDone);
-         }
-         break;
-      case MultiThreadReporter::THREAD_ERROR:
-         if (mpProgressReporter != NULL)
-         {
-            mpProgressReporter->reportError(mpThreadReporter->getErrorText().c_str());
-         }
-         mErrorText = mpThreadReporter->getErrorText().c_str();
-         mCurrentStatus = FAILURE;
-         break;
-      case MultiThreadReporter::THREAD_WORK:
-         if (mpThreadReporter->getThreadCommand() != NULL)
-         {
-            mpThreadReporter->getThreadCommand()->run();
-         }
-         break;
-      default:
-         break;
-   }
+      int progress = mWorkQueue.getProgress();
+      if (complete)
+      {
+         progress = 100;
+      }
+      else if (progress < 0)
+      {
+         progress = mpThreadReporter->getProgress();
+      }
 
-   return percentDone;
+      if (progress != percentDone)
+      {
+         percentDone = progress;
+         mpProgressReporter->reportProgress(percentDone);
+      }
+   }
 }
 
 template<class AlgInput, class AlgOutput, class AlgThread>
@@ -856,12 +1053,13 @@ Result MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::compileResults()
 template<class AlgInput, class AlgOutput, class AlgThread>
 Result MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::run()
 {
-   Result result = startAllThreads();
-   if (result == SUCCESS)
+   if (mpThreadReporter->hasError())
    {
-      result = waitForThreadsToComplete();
+      mErrorText = mpThreadReporter->getErrorText();
+      return FAILURE;
    }
 
+   Result result = runThreads();
    if (result == SUCCESS)
    {
       result = compileResults();
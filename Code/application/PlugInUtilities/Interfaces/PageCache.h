@@ -65,6 +65,23 @@ public:
       DimensionDescriptor startRow, 
       DimensionDescriptor startBand);
 
+   /**
+    * Fetches a unit from the cache.
+    *
+    * See RasterPager::getPage() for details on the parameters.  If the
+    * request is tiled, units which only contain some of the columns in
+    * each row may be returned.  Otherwise, this is the same as the
+    * overload which does not take a start column.
+    *
+    * @return A CacheUnit object containing the startRow, startColumn, and startBand,
+    *         and containing and least concurrentRows number of rows, concurrentColumns number
+    *         of columns, and concurrentBands number of bands.
+    */
+   CachedPage::UnitPtr getUnit(DataRequest *pOriginalRequest,
+      DimensionDescriptor startRow, 
+      DimensionDescriptor startColumn, 
+      DimensionDescriptor startBand);
+
    /**
     * An STL list of PagePtr.
     *
@@ -102,12 +119,16 @@ public:
     *         The desired column.
     * @param  startBand
     *         The desired band.
+    * @param  tiled
+    *         If \c true and the format is not BIL, the page only contains the
+    *         columns from \p startColumn to the last column in the unit.
     *
     * @return The created page, or NULL if pUnit is NULL.  The caller
     *         takes ownership over the created page.
     */
    CachedPage *createPage(CachedPage::UnitPtr pUnit, InterleaveFormatType requestedFormat,
-      DimensionDescriptor startRow, DimensionDescriptor startColumn, DimensionDescriptor startBand);
+      DimensionDescriptor startRow, DimensionDescriptor startColumn, DimensionDescriptor startBand,
+      bool tiled = false);
 
 protected:
    const size_t MAX_CACHE_SIZE;
@@ -0,0 +1,670 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef RASTERTILEPROCESSOR_H
+#define RASTERTILEPROCESSOR_H
+
+#include "BitMask.h"
+#include "ComplexData.h"
+#include "DataAccessor.h"
+#include "MultiThreadedAlgorithm.h"
+#include "TypesFile.h"
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+class RasterElement;
+
+/**
+ * The location of the bands of one element within a tile.
+ *
+ * Element (row, column, band) of the tile starts at
+ * <tt>mBands[band] + row * mRowStride + column * mColumnStride</tt>,
+ * which describes every interleave.
+ */
+struct RasterTileLayout
+{
+   std::vector<char*> mBands;
+   size_t mRowStride;
+   size_t mColumnStride;
+};
+
+/**
+ * A typed view of the rows of one element in a RasterTileSet.
+ *
+ * The view is a pointer to the layout, so it is cheap to copy but is only
+ * valid while the kernel which received it is running.
+ */
+template<typename T>
+class RasterTile
+{
+public:
+   /**
+    * Creates a view of a layout.
+    *
+    * @param pLayout
+    *        The layout of the tile's bands.
+    */
+   explicit RasterTile(const RasterTileLayout* pLayout = NULL) :
+      mpLayout(pLayout)
+   {}
+
+   /**
+    * Returns \c true if the view refers to a tile.
+    */
+   bool isValid() const
+   {
+      return mpLayout != NULL;
+   }
+
+   /**
+    * Returns the number of bands in the tile.
+    */
+   unsigned int getBandCount() const
+   {
+      return static_cast<unsigned int>(mpLayout->mBands.size());
+   }
+
+   /**
+    * Returns the number of elements between adjacent columns of a band.
+    *
+    * This is one for BIL and BSQ data and the band count for BIP data, so a row
+    * can be processed with <tt>pRow[column * getColumnStep()]</tt>.
+    */
+   size_t getColumnStep() const
+   {
+      return mpLayout->mColumnStride / sizeof(T);
+   }
+
+   /**
+    * Returns the first column of a row of a band.
+    *
+    * @param row
+    *        The row within the tile.
+    * @param band
+    *        The band.
+    * @return The element in column zero.  The other columns follow at intervals of getColumnStep().
+    */
+   T* getRow(unsigned int row, unsigned int band) const
+   {
+      return reinterpret_cast<T*>(mpLayout->mBands[band] + row * mpLayout->mRowStride);
+   }
+
+   /**
+    * Returns an element of the tile.
+    *
+    * @param row
+    *        The row within the tile.
+    * @param column
+    *        The column.
+    * @param band
+    *        The band.
+    * @return A reference to the element.
+    */
+   T& operator()(unsigned int row, unsigned int column, unsigned int band) const
+   {
+      return *reinterpret_cast<T*>(mpLayout->mBands[band] + row * mpLayout->mRowStride +
+         column * mpLayout->mColumnStride);
+   }
+
+private:
+   const RasterTileLayout* mpLayout;
+};
+
+/**
+ * Reads the same rows of several elements in their native interleave for a RasterTileProcessor.
+ *
+ * Each call to read() makes the longest block of rows which every element has in memory
+ * available, so the kernel works on the pager's pages directly instead of on a copy.
+ */
+class RasterTileReader
+{
+public:
+   /**
+    * Creates a reader.
+    *
+    * @param inputs
+    *        The elements to read.  They must have the same number of rows and columns.
+    * @param pOutput
+    *        The element to write, or \c NULL.
+    */
+   RasterTileReader(const std::vector<const RasterElement*>& inputs, RasterElement* pOutput);
+
+   /**
+    * Creates the data accessors for a range of rows.
+    *
+    * @param firstRow
+    *        The first active row.
+    * @param lastRow
+    *        The last active row.
+    * @return \c True if every element could be accessed, \c false otherwise.
+    */
+   bool open(unsigned int firstRow, unsigned int lastRow);
+
+   /**
+    * Moves to a row and sets the layouts to the rows available from it.
+    *
+    * @param row
+    *        The first active row of the tile.
+    * @param lastRow
+    *        The last row which may be included in the tile.
+    * @return \c True if the data is available, \c false otherwise.
+    */
+   bool read(unsigned int row, unsigned int lastRow);
+
+   /**
+    * Returns the first row of the current tile.
+    */
+   unsigned int getFirstRow() const;
+
+   /**
+    * Returns the number of rows in the current tile.
+    */
+   unsigned int getRowCount() const;
+
+   /**
+    * Returns the number of columns in the tiles.
+    */
+   unsigned int getColumnCount() const;
+
+   /**
+    * Returns the layouts of the inputs in the current tile.
+    */
+   const std::vector<RasterTileLayout>& getInputs() const;
+
+   /**
+    * Returns the layout of the output in the current tile, or \c NULL if there is no output.
+    */
+   const RasterTileLayout* getOutput() const;
+
+private:
+   struct Element
+   {
+      const RasterElement* mpElement;
+      RasterElement* mpWritableElement;
+      InterleaveFormatType mInterleave;
+      unsigned int mBandCount;
+      size_t mBytesPerElement;
+      std::vector<DataAccessor> mAccessors;
+   };
+
+   bool moveTo(Element& element, unsigned int row, unsigned int& rowCount);
+   void setLayout(Element& element, RasterTileLayout& layout);
+
+   std::vector<Element> mElements;
+   std::vector<RasterTileLayout> mInputs;
+   RasterTileLayout mOutput;
+   bool mHasOutput;
+   unsigned int mFirstRow;
+   unsigned int mRowCount;
+   unsigned int mColumnCount;
+};
+
+/**
+ * The tiles of every element of a RasterTileProcessor for a block of rows.
+ *
+ * Row numbers are relative to the first row of the tile and column numbers
+ * are the active column numbers of the elements.
+ *
+ * @param T
+ *        The type of the elements of the inputs.
+ */
+template<typename T>
+class RasterTileSet
+{
+public:
+   /**
+    * Creates the tiles of the current rows of a reader.
+    *
+    * @param reader
+    *        The reader holding the layouts.
+    * @param pAoi
+    *        The pixels to process, or \c NULL to process every pixel.
+    */
+   RasterTileSet(const RasterTileReader& reader, const BitMask* pAoi) :
+      mReader(reader),
+      mpAoi(pAoi)
+   {}
+
+   /**
+    * Returns the active row number of the first row of the tiles.
+    */
+   unsigned int getFirstRow() const
+   {
+      return mReader.getFirstRow();
+   }
+
+   /**
+    * Returns the number of rows in the tiles.
+    */
+   unsigned int getRowCount() const
+   {
+      return mReader.getRowCount();
+   }
+
+   /**
+    * Returns the number of columns in the tiles.
+    */
+   unsigned int getColumnCount() const
+   {
+      return mReader.getColumnCount();
+   }
+
+   /**
+    * Returns the number of input tiles.
+    */
+   unsigned int getInputCount() const
+   {
+      return static_cast<unsigned int>(mReader.getInputs().size());
+   }
+
+   /**
+    * Returns the tile of an input element.
+    *
+    * @param index
+    *        The index of the input in the order in which it was added to the processor.
+    */
+   RasterTile<const T> getInput(unsigned int index = 0) const
+   {
+      return RasterTile<const T>(&mReader.getInputs()[index]);
+   }
+
+   /**
+    * Returns \c true if the processor has an output element.
+    */
+   bool hasOutput() const
+   {
+      return mReader.getOutput() != NULL;
+   }
+
+   /**
+    * Returns the tile of the output element.
+    *
+    * The output's encoding may differ from the inputs, so the kernel names the
+    * type of its elements.  Since the tile set's type is a template parameter of the
+    * kernel, the call is written as <tt>tiles.template getOutput<float>()</tt>.
+    *
+    * @param U
+    *        The type of the elements of the output.
+    */
+   template<typename U>
+   RasterTile<U> getOutput() const
+   {
+      return RasterTile<U>(mReader.getOutput());
+   }
+
+   /**
+    * Returns \c true if a pixel of the tiles should be processed.
+    *
+    * @param row
+    *        The row within the tiles.
+    * @param column
+    *        The column.
+    */
+   bool isSelected(unsigned int row, unsigned int column) const
+   {
+      return mpAoi == NULL || mpAoi->getPixel(static_cast<int>(column), static_cast<int>(getFirstRow() + row));
+   }
+
+private:
+   RasterTileSet& operator=(const RasterTileSet& rhs);
+
+   const RasterTileReader& mReader;
+   const BitMask* mpAoi;
+};
+
+/**
+ * Runs a kernel over the tiles of one or more raster elements on the thread pool.
+ *
+ * The rows of the elements are divided into small ranges which the threads of a
+ * mta::MultiThreadedAlgorithm take in turn.  Within a range, each tile is the block
+ * of rows which the pagers of every element hold in memory at once, in each element's
+ * native interleave, so no data is copied or converted.  The kernel receives a
+ * RasterTileSet typed with the encoding of the inputs:
+ *
+ * @code
+ * struct SumKernel
+ * {
+ *    typedef std::vector<double> State;
+ *
+ *    template<typename T>
+ *    void operator()(const RasterTileSet<T>& tiles, State& sums) const
+ *    {
+ *       RasterTile<const T> input = tiles.getInput();
+ *       for (unsigned int row = 0; row < tiles.getRowCount(); ++row)
+ *       {
+ *          for (unsigned int column = 0; column < tiles.getColumnCount(); ++column)
+ *          {
+ *             if (tiles.isSelected(row, column))
+ *             {
+ *                for (unsigned int band = 0; band < input.getBandCount(); ++band)
+ *                {
+ *                   sums[band] += input(row, column, band);
+ *                }
+ *             }
+ *          }
+ *       }
+ *    }
+ *
+ *    void merge(State& total, const State& sums) const
+ *    {
+ *       for (State::size_type band = 0; band < sums.size(); ++band)
+ *       {
+ *          total[band] += sums[band];
+ *       }
+ *    }
+ * };
+ *
+ * RasterTileProcessor processor;
+ * processor.addInput(pElement);
+ * std::vector<double> sums(bandCount, 0.0);
+ * mta::Result result = processor.run(SumKernel(), sums);
+ * @endcode
+ *
+ * The kernel is shared by the threads, so its operator() must be const.  Each thread
+ * reduces into its own copy of the initial state, and the copies are merged into the
+ * state passed to run() in thread order when every tile has been processed.  The
+ * initial state should therefore be the identity of the merge, such as zeros for a sum.
+ * Since the threads take whichever rows are next, floating point reductions may differ
+ * in their last digits between runs.  Kernels which only write the output can use an
+ * empty struct as their state.
+ */
+class RasterTileProcessor
+{
+public:
+   /**
+    * Creates a processor with no inputs.
+    */
+   RasterTileProcessor();
+
+   /**
+    * Adds an element to read.
+    *
+    * Every input must have the same encoding and the same number of rows and columns.
+    *
+    * @param pElement
+    *        The element.
+    */
+   void addInput(const RasterElement* pElement);
+
+   /**
+    * Sets the element to write.
+    *
+    * The output must have the same number of rows and columns as the inputs,
+    * but may have a different encoding, interleave and number of bands.
+    *
+    * @param pElement
+    *        The element, or \c NULL for a kernel which only reduces the inputs.
+    */
+   void setOutput(RasterElement* pElement);
+
+   /**
+    * Limits processing to the pixels of an AOI.
+    *
+    * Only the rows within the AOI's bounding box are read, and the kernel should
+    * check RasterTileSet::isSelected() for each pixel.
+    *
+    * @param pAoi
+    *        The selected pixels in the active rows and columns of the inputs, or \c NULL
+    *        to process every pixel.
+    */
+   void setAoi(const BitMask* pAoi);
+
+   /**
+    * Sets the object which reports the fraction of the rows which have been processed.
+    *
+    * @param pReporter
+    *        The reporter, or \c NULL.
+    */
+   void setProgressReporter(mta::ProgressReporter* pReporter);
+
+   /**
+    * Sets a flag which stops processing when it becomes \c true.
+    *
+    * @param pAbort
+    *        The flag, or \c NULL.
+    */
+   void setAbortFlag(const bool* pAbort);
+
+   /**
+    * Runs a kernel which does not support complex data.
+    *
+    * @param kernel
+    *        The kernel.
+    * @param state
+    *        The initial state of each thread, which is replaced with the merged states.
+    * @return mta::SUCCESS if every tile was processed, mta::ABORT if the abort flag was
+    *         set, or mta::FAILURE with getErrorText() describing the error.
+    */
+   template<class Kernel>
+   mta::Result run(const Kernel& kernel, typename Kernel::State& state)
+   {
+      return execute<Kernel, RealEncodings>(kernel, state);
+   }
+
+   /**
+    * Runs a kernel which also supports IntegerComplex and FloatComplex data.
+    *
+    * @copydetails run()
+    */
+   template<class Kernel>
+   mta::Result runComplex(const Kernel& kernel, typename Kernel::State& state)
+   {
+      return execute<Kernel, AllEncodings>(kernel, state);
+   }
+
+   /**
+    * Returns a description of the last error.
+    */
+   const std::string& getErrorText() const;
+
+private:
+   RasterTileProcessor(const RasterTileProcessor& rhs);
+   RasterTileProcessor& operator=(const RasterTileProcessor& rhs);
+
+   struct RealEncodings
+   {
+      static const bool sComplex = false;
+   };
+
+   struct AllEncodings
+   {
+      static const bool sComplex = true;
+   };
+
+   template<class Kernel>
+   struct TileInput
+   {
+      const RasterTileProcessor* mpProcessor;
+      const Kernel* mpKernel;
+      const typename Kernel::State* mpInitialState;
+   };
+
+   template<class Kernel, class Encodings>
+   class TileThread : public mta::AlgorithmThread
+   {
+   public:
+      TileThread(const TileInput<Kernel>& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mpProcessor(input.mpProcessor),
+         mpKernel(input.mpKernel),
+         mState(*input.mpInitialState),
+         mThreadCount(threadCount),
+         mReader(input.mpProcessor->mInputs, input.mpProcessor->mpOutput)
+      {}
+
+      void run()
+      {
+         int rowCount = static_cast<int>(mpProcessor->mLastRow - mpProcessor->mFirstRow + 1);
+         Range range;
+         while (getNextRange(mThreadCount, rowCount, range))
+         {
+            if (mpProcessor->isAborted())
+            {
+               continue;
+            }
+
+            unsigned int firstRow = mpProcessor->mFirstRow + static_cast<unsigned int>(range.mFirst);
+            unsigned int lastRow = mpProcessor->mFirstRow + static_cast<unsigned int>(range.mLast);
+            if (mReader.open(firstRow, lastRow) == false ||
+               processRows(mpProcessor->mEncoding, firstRow, lastRow, Encodings()) == false)
+            {
+               getReporter().reportError("Unable to access the data of the raster elements.");
+               return;
+            }
+         }
+      }
+
+      const typename Kernel::State& getState() const
+      {
+         return mState;
+      }
+
+   private:
+      TileThread& operator=(const TileThread& rhs);
+
+      template<typename T>
+      bool processTiles(unsigned int firstRow, unsigned int lastRow)
+      {
+         for (unsigned int row = firstRow; row <= lastRow; row += mReader.getRowCount())
+         {
+            if (mpProcessor->isAborted())
+            {
+               return true;
+            }
+
+            if (mReader.read(row, lastRow) == false)
+            {
+               return false;
+            }
+
+            (*mpKernel)(RasterTileSet<T>(mReader, mpProcessor->mpAoi), mState);
+         }
+
+         return true;
+      }
+
+      bool processRows(EncodingType encoding, unsigned int firstRow, unsigned int lastRow, RealEncodings)
+      {
+         switch (encoding)
+         {
+         case INT1UBYTE:
+            return processTiles<unsigned char>(firstRow, lastRow);
+         case INT1SBYTE:
+            return processTiles<signed char>(firstRow, lastRow);
+         case INT2UBYTES:
+            return processTiles<unsigned short>(firstRow, lastRow);
+         case INT2SBYTES:
+            return processTiles<signed short>(firstRow, lastRow);
+         case INT4UBYTES:
+            return processTiles<unsigned int>(firstRow, lastRow);
+         case INT4SBYTES:
+            return processTiles<signed int>(firstRow, lastRow);
+         case FLT4BYTES:
+            return processTiles<float>(firstRow, lastRow);
+         case FLT8BYTES:
+            return processTiles<double>(firstRow, lastRow);
+         default:
+            return false;
+         }
+      }
+
+      bool processRows(EncodingType encoding, unsigned int firstRow, unsigned int lastRow, AllEncodings)
+      {
+         switch (encoding)
+         {
+         case INT4SCOMPLEX:
+            return processTiles<IntegerComplex>(firstRow, lastRow);
+         case FLT8COMPLEX:
+            return processTiles<FloatComplex>(firstRow, lastRow);
+         default:
+            return processRows(encoding, firstRow, lastRow, RealEncodings());
+         }
+      }
+
+      const RasterTileProcessor* mpProcessor;
+      const Kernel* mpKernel;
+      typename Kernel::State mState;
+      int mThreadCount;
+      RasterTileReader mReader;
+   };
+
+   template<class Kernel, class Encodings>
+   struct TileOutput
+   {
+      const Kernel* mpKernel;
+      typename Kernel::State* mpState;
+
+      bool compileOverallResults(const std::vector<TileThread<Kernel, Encodings>*>& threads)
+      {
+         for (typename std::vector<TileThread<Kernel, Encodings>*>::const_iterator iter = threads.begin();
+            iter != threads.end(); ++iter)
+         {
+            mpKernel->merge(*mpState, (*iter)->getState());
+         }
+
+         return true;
+      }
+   };
+
+   template<class Kernel, class Encodings>
+   mta::Result execute(const Kernel& kernel, typename Kernel::State& state)
+   {
+      if (prepare(Encodings::sComplex) == false)
+      {
+         return mta::FAILURE;
+      }
+
+      if (mFirstRow > mLastRow)
+      {
+         return mta::SUCCESS;
+      }
+
+      TileInput<Kernel> input;
+      input.mpProcessor = this;
+      input.mpKernel = &kernel;
+      typename Kernel::State initialState(state);
+      input.mpInitialState = &initialState;
+
+      TileOutput<Kernel, Encodings> output;
+      output.mpKernel = &kernel;
+      output.mpState = &state;
+
+      mta::MultiThreadedAlgorithm<TileInput<Kernel>, TileOutput<Kernel, Encodings>, TileThread<Kernel, Encodings> >
+         algorithm(getThreadCount(), input, output, mpReporter);
+      mta::Result result = algorithm.run();
+      if (result == mta::FAILURE)
+      {
+         mErrorText = algorithm.getErrorText();
+      }
+      else if (isAborted())
+      {
+         result = mta::ABORT;
+      }
+
+      return result;
+   }
+
+   bool prepare(bool complexAllowed);
+   bool isAborted() const;
+   int getThreadCount() const;
+
+   std::vector<const RasterElement*> mInputs;
+   RasterElement* mpOutput;
+   const BitMask* mpAoi;
+   mta::ProgressReporter* mpReporter;
+   const bool* mpAbort;
+   std::string mErrorText;
+   EncodingType mEncoding;
+   unsigned int mFirstRow;
+   unsigned int mLastRow;
+};
+
+#endif
@@ -0,0 +1,303 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef RASTERWARPER_H
+#define RASTERWARPER_H
+
+#include "AppConfig.h"
+#include "LocationType.h"
+#include "MultiThreadedAlgorithm.h"
+#include "RasterUtilities.h"
+
+#include <string>
+#include <vector>
+
+class RasterElement;
+
+/**
+ * Maps output pixel locations into a source raster for a RasterWarper.
+ *
+ * All locations are zero-based pixel indices, i.e. (0.0, 0.0) is the center of
+ * the first pixel in the first row. The mapping is only ever evaluated from the
+ * thread which calls RasterWarper::warp() so implementations need not be
+ * thread safe.
+ */
+class WarpMapping
+{
+public:
+   /**
+    * Destructor.
+    */
+   virtual ~WarpMapping() {}
+
+   /**
+    * Map output pixel locations to source pixel locations.
+    *
+    * @param outputPixels
+    *        The output pixel locations to map.
+    * @param sourcePixels
+    *        Populated with one source pixel location for each output pixel location.
+    * @return \c True if the locations were mapped, \c false on error.
+    */
+   virtual bool map(const std::vector<LocationType>& outputPixels, std::vector<LocationType>& sourcePixels) const = 0;
+};
+
+/**
+ * A WarpMapping defined by a pair of 2D polynomials.
+ *
+ * The coefficients are laid out as produced by polywarp. For a polynomial of degree
+ * \em n, there are \em (n+1)^2 coefficients and coefficient \em i*(n+1)+j is
+ * multiplied by \em x^i*y^j where \em x is the output column and \em y is the output row.
+ */
+class PolynomialWarpMapping : public WarpMapping
+{
+public:
+   /**
+    * Create a polynomial mapping.
+    *
+    * @param kx
+    *        The coefficients which compute the source column.
+    * @param ky
+    *        The coefficients which compute the source row.
+    * @param columnOffset
+    *        Added to each output column before the polynomial is evaluated.
+    * @param rowOffset
+    *        Added to each output row before the polynomial is evaluated.
+    */
+   PolynomialWarpMapping(const std::vector<double>& kx, const std::vector<double>& ky,
+      double columnOffset = 0.0, double rowOffset = 0.0);
+
+   /**
+    * Destructor.
+    */
+   virtual ~PolynomialWarpMapping();
+
+   /**
+    * @copydoc WarpMapping::map()
+    *
+    * @default Fails if the coefficient vectors are not the same size or are not a square.
+    */
+   virtual bool map(const std::vector<LocationType>& outputPixels, std::vector<LocationType>& sourcePixels) const;
+
+private:
+   double evaluate(const std::vector<double>& coefficients, double x, double y) const;
+
+   std::vector<double> mKx;
+   std::vector<double> mKy;
+   unsigned int mDegree;
+   double mColumnOffset;
+   double mRowOffset;
+};
+
+/**
+ * A WarpMapping which uses the georeferencing of two raster elements.
+ *
+ * Each output pixel is converted to a geocoordinate using the georeference of the
+ * output geometry element, and the geocoordinate is converted to a pixel in the source.
+ * Any Georeference plug-in which is attached to the elements (RPC, GCP polynomial, etc.)
+ * may be used.
+ */
+class GeoreferenceWarpMapping : public WarpMapping
+{
+public:
+   /**
+    * Create a georeference mapping.
+    *
+    * @param pOutputGeometry
+    *        The georeferenced element which defines the output pixel grid.
+    * @param pSource
+    *        The georeferenced element which will be resampled.
+    * @param columnOffset
+    *        The column in \em pOutputGeometry which corresponds to the first output column.
+    * @param rowOffset
+    *        The row in \em pOutputGeometry which corresponds to the first output row.
+    */
+   GeoreferenceWarpMapping(const RasterElement* pOutputGeometry, const RasterElement* pSource,
+      double columnOffset = 0.0, double rowOffset = 0.0);
+
+   /**
+    * Destructor.
+    */
+   virtual ~GeoreferenceWarpMapping();
+
+   /**
+    * @copydoc WarpMapping::map()
+    *
+    * @default Fails if either element is \c NULL or is not georeferenced.
+    */
+   virtual bool map(const std::vector<LocationType>& outputPixels, std::vector<LocationType>& sourcePixels) const;
+
+private:
+   GeoreferenceWarpMapping& operator=(const GeoreferenceWarpMapping& rhs);
+
+   const RasterElement* mpOutputGeometry;
+   const RasterElement* mpSource;
+   double mColumnOffset;
+   double mRowOffset;
+};
+
+/**
+ * Resamples a raster element into a new pixel grid.
+ *
+ * The WarpMapping is evaluated exactly on a coarse grid of output locations. The grid
+ * spacing is halved until the mapping at the center of every grid cell differs from the
+ * bilinearly interpolated location by no more than the maximum grid error. Source
+ * locations for individual output pixels are then interpolated incrementally from
+ * the grid which avoids evaluating expensive mappings (RPC, geodetic conversions)
+ * per pixel.
+ *
+ * The output is divided into tiles which are processed by a mta::MultiThreadedAlgorithm.
+ * Each thread reads the source through its own cache of small source blocks so
+ * interpolation kernels never access the source one pixel at a time.
+ *
+ * Output pixels which map outside of the source are set to the bad value.
+ */
+class RasterWarper
+{
+public:
+   /**
+    * Specifies which source locations are considered to be inside the source.
+    */
+   enum SourceBoundsType
+   {
+      PIXEL_AREA,    /**< A location is inside if it is within the area covered by the source
+                          pixels, i.e. -0.5 <= x < columns - 0.5. */
+      PIXEL_INDEX    /**< A location is inside if its integer part is a valid pixel index,
+                          i.e. 0 <= x < columns. */
+   };
+
+   /**
+    * Create a warper.
+    *
+    * @param pSource
+    *        The element to resample. All bands are warped by default.
+    * @param mapping
+    *        Maps output pixels into \em pSource. The mapping must remain valid
+    *        until the warper is destroyed.
+    */
+   RasterWarper(const RasterElement* pSource, const WarpMapping& mapping);
+
+   /**
+    * Destructor.
+    */
+   ~RasterWarper();
+
+   /**
+    * Set the interpolation kernel.
+    *
+    * @param interp
+    *        The kernel used to sample the source. The default is RasterUtilities::BILINEAR.
+    */
+   void setInterpolation(RasterUtilities::InterpolationType interp);
+
+   /**
+    * Set the source bands to warp.
+    *
+    * @param bands
+    *        The zero-based active source bands. Output band \em i is warped from
+    *        \em bands[i]. If empty, all source bands are warped.
+    */
+   void setBands(const std::vector<unsigned int>& bands);
+
+   /**
+    * Set the value assigned to output pixels which do not map into the source.
+    *
+    * @param value
+    *        The bad value. The default is 0.
+    */
+   void setBadValue(double value);
+
+   /**
+    * Set which source locations are considered to be inside the source.
+    *
+    * @param bounds
+    *        The source bounds. Output pixels which map outside of these bounds are
+    *        set to the bad value. The default is RasterWarper::PIXEL_AREA.
+    */
+   void setSourceBounds(SourceBoundsType bounds);
+
+   /**
+    * Set how interpolated values are converted to integer data types.
+    *
+    * @param round
+    *        If \c true, values are rounded to the nearest integer. If \c false,
+    *        values are truncated toward zero. The default is \c true.
+    */
+   void setRoundValues(bool round);
+
+   /**
+    * Set the initial spacing of the mapping grid.
+    *
+    * @param spacing
+    *        The initial distance between grid nodes in output pixels. The default is 64.
+    */
+   void setGridSpacing(unsigned int spacing);
+
+   /**
+    * Set the maximum error allowed when interpolating the mapping grid.
+    *
+    * @param error
+    *        The maximum error in source pixels. The default is 0.1 pixels.
+    */
+   void setMaximumGridError(double error);
+
+   /**
+    * Set the size of the tiles distributed to worker threads.
+    *
+    * @param tileSize
+    *        The number of rows and columns in each output tile. The default is 256.
+    */
+   void setTileSize(unsigned int tileSize);
+
+   /**
+    * Warp the source into an existing element.
+    *
+    * @param pDestination
+    *        The output element. It must have the same data type as the source, one band
+    *        for each warped source band and be BSQ or BIP.
+    * @param pReporter
+    *        If not \c NULL, receives progress reports.
+    * @param pAbort
+    *        If not \c NULL, checked between tiles. If the value becomes \c true, the warp stops.
+    * @return \c True if the warp completed, \c false on error or abort.
+    */
+   bool warp(RasterElement* pDestination, mta::ProgressReporter* pReporter = NULL, const bool* pAbort = NULL);
+
+   /**
+    * Get the number of output pixels set to the bad value by the last call to warp().
+    *
+    * @return The number of output pixels per band which did not map into the source.
+    */
+   uint64_t getBadPixelCount() const;
+
+   /**
+    * Get the description of the last error.
+    *
+    * @return The error text or an empty string if the last warp succeeded.
+    */
+   const std::string& getErrorText() const;
+
+private:
+   RasterWarper& operator=(const RasterWarper& rhs);
+
+   const RasterElement* mpSource;
+   const WarpMapping& mMapping;
+   RasterUtilities::InterpolationType mInterpolation;
+   std::vector<unsigned int> mBands;
+   double mBadValue;
+   SourceBoundsType mSourceBounds;
+   bool mRoundValues;
+   unsigned int mGridSpacing;
+   double mMaxGridError;
+   unsigned int mTileSize;
+   uint64_t mBadPixelCount;
+   std::string mErrorText;
+};
+
+#endif
@@ -0,0 +1,222 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SPECTRALLIBRARYMATCHER_H
+#define SPECTRALLIBRARYMATCHER_H
+
+#include "AppConfig.h"
+#include "Location.h"
+
+#include <string>
+#include <vector>
+
+class RasterElement;
+class SignatureLibrary;
+
+/**
+ * Finds the signatures in a spectral library which best match pixel spectra.
+ *
+ * The library ordinates are copied into a contiguous single precision matrix with
+ * the squared norm and the sum of each signature precomputed, so a match only needs
+ * one SIMD kernel pass over each candidate signature. Batches of spectra are matched
+ * on multiple threads.
+ *
+ * The metrics are the spectral angle, the Euclidean distance and the Pearson
+ * correlation coefficient. Each of them is a monotonic function of the Euclidean
+ * distance between suitably normalized spectra (unnormalized, scaled to unit length,
+ * and centered and scaled to unit length respectively). When pruning is enabled,
+ * the normalized signatures are projected onto their leading principal components.
+ * The distance between projections is a lower bound on the distance between the
+ * spectra, so the signatures with the smallest bounds are compared first and any
+ * signature whose bound exceeds the worst of the best matches found so far is
+ * skipped. Pruning does not change the results.
+ *
+ * The spectra must have one value for each wavelength in the library's abscissa,
+ * so a library should be resampled to the wavelengths of a raster element before it
+ * is matched against the element's pixels. Signatures and spectra for which a metric
+ * is undefined, such as spectra with no variance for the correlation, never match.
+ *
+ * The matcher may be used from one thread at a time.
+ */
+class SpectralLibraryMatcher
+{
+public:
+   /**
+    * The metrics used to compare spectra.
+    */
+   enum MetricType
+   {
+      SPECTRAL_ANGLE,   /**< The angle in radians between the spectra. Smaller is better. */
+      EUCLIDEAN,        /**< The Euclidean distance between the spectra. Smaller is better. */
+      CORRELATION       /**< The Pearson correlation coefficient. Larger is better. */
+   };
+
+   /**
+    * A library signature matched to a spectrum.
+    */
+   struct Match
+   {
+      unsigned int mSignature;   /**< The index of the signature in the library. */
+      double mScore;             /**< The value of the metric. */
+   };
+
+   /**
+    * Creates a matcher with no signatures.
+    */
+   SpectralLibraryMatcher();
+
+   /**
+    * Destructor.
+    */
+   ~SpectralLibraryMatcher();
+
+   /**
+    * Copies the signatures of a library.
+    *
+    * The library's current abscissa is used, so resample the library before calling
+    * this method.
+    *
+    * @param pLibrary
+    *        The library to match against.
+    * @return \c True if the ordinates were copied, \c false otherwise.
+    */
+   bool setLibrary(const SignatureLibrary* pLibrary);
+
+   /**
+    * Copies signatures from a matrix.
+    *
+    * @param pOrdinates
+    *        The ordinates with the values of each signature stored contiguously.
+    * @param numSignatures
+    *        The number of signatures.
+    * @param numBands
+    *        The number of values in each signature.
+    */
+   void setSignatures(const double* pOrdinates, unsigned int numSignatures, unsigned int numBands);
+
+   /**
+    * Returns the number of signatures.
+    */
+   unsigned int getNumSignatures() const;
+
+   /**
+    * Returns the number of values in each signature and spectrum.
+    */
+   unsigned int getNumBands() const;
+
+   /**
+    * Sets the number of principal components used to prune the search.
+    *
+    * The components are computed the first time a metric is matched after this is
+    * called. Pruning is most effective for large libraries of correlated signatures.
+    *
+    * @param components
+    *        The number of components, or zero to compare each spectrum with every signature.
+    */
+   void setPruningComponents(unsigned int components);
+
+   /**
+    * Returns the number of principal components used to prune the search.
+    */
+   unsigned int getPruningComponents() const;
+
+   /**
+    * Finds the best matches for one spectrum.
+    *
+    * @param pSpectrum
+    *        The spectrum, with getNumBands() values.
+    * @param metric
+    *        The metric used to compare the spectrum with the signatures.
+    * @param count
+    *        The maximum number of matches.
+    * @param matches
+    *        Populated with the best matches, best first.
+    * @return \c True if the spectrum was matched, \c false if the arguments are invalid.
+    */
+   bool match(const double* pSpectrum, MetricType metric, unsigned int count, std::vector<Match>& matches);
+
+   /**
+    * Finds the best matches for contiguous spectra on multiple threads.
+    *
+    * @param pSpectra
+    *        The spectra, with getNumBands() values each.
+    * @param numSpectra
+    *        The number of spectra.
+    * @param metric
+    *        The metric used to compare the spectra with the signatures.
+    * @param count
+    *        The maximum number of matches for each spectrum.
+    * @param matches
+    *        Populated with the best matches of each spectrum, best first.
+    * @return \c True if the spectra were matched, \c false if the arguments are invalid.
+    */
+   bool match(const double* pSpectra, unsigned int numSpectra, MetricType metric, unsigned int count,
+      std::vector<std::vector<Match> >& matches);
+
+   /**
+    * Finds the best matches for pixels of a raster element.
+    *
+    * The spectra are read through a band interleaved by pixel DataAccessor in blocks
+    * and each block is matched on multiple threads.
+    *
+    * @param pRaster
+    *        The raster element, with getNumBands() bands in the library's wavelengths.
+    * @param pixels
+    *        The active row and column numbers of the pixels to match.
+    * @param metric
+    *        The metric used to compare the spectra with the signatures.
+    * @param count
+    *        The maximum number of matches for each pixel.
+    * @param matches
+    *        Populated with the best matches of each pixel, best first.
+    * @param pAbort
+    *        If not \c NULL, matching stops when the flag is set.
+    * @return \c True if the pixels were matched, \c false on error or abort.
+    */
+   bool match(const RasterElement* pRaster, const std::vector<Opticks::PixelLocation>& pixels, MetricType metric,
+      unsigned int count, std::vector<std::vector<Match> >& matches, const bool* pAbort = NULL);
+
+   /**
+    * Returns a description of the last error.
+    */
+   const std::string& getErrorText() const;
+
+private:
+   SpectralLibraryMatcher(const SpectralLibraryMatcher& rhs);
+   SpectralLibraryMatcher& operator=(const SpectralLibraryMatcher& rhs);
+
+   struct Pruning
+   {
+      Pruning() : mBuilt(false) {}
+
+      bool mBuilt;
+      std::vector<double> mMean;
+      std::vector<double> mComponents;
+      std::vector<double> mProjections;
+   };
+
+   void preparePruning(MetricType metric);
+   bool normalize(const double* pSpectrum, MetricType metric, std::vector<double>& normalized) const;
+   void matchSpectrum(const double* pSpectrum, MetricType metric, unsigned int count, std::vector<Match>& matches,
+      std::vector<float>& buffer) const;
+
+   friend class SpectralLibraryMatchThread;
+
+   unsigned int mNumSignatures;
+   unsigned int mNumBands;
+   unsigned int mStride;
+   std::vector<float> mOrdinates;
+   std::vector<double> mSquaredNorms;
+   std::vector<double> mSums;
+   unsigned int mPruningComponents;
+   Pruning mPruning[3];
+   std::string mErrorText;
+};
+
+#endif
@@ -0,0 +1,248 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "bthread.h"
+#include "DMutex.h"
+
+#include <deque>
+#include <vector>
+
+namespace mta
+{
+
+class ThreadCommand;
+
+/**
+ * An integer which can be changed by several threads without a lock.
+ */
+class AtomicCounter
+{
+public:
+   /**
+    * Creates a counter.
+    *
+    * @param value
+    *        The initial value.
+    */
+   explicit AtomicCounter(int value = 0);
+
+   /**
+    * Creates a counter with the current value of another counter.
+    *
+    * @param rhs
+    *        The counter to copy.
+    */
+   AtomicCounter(const AtomicCounter& rhs);
+
+   /**
+    * Sets the value to the current value of another counter.
+    *
+    * @param rhs
+    *        The counter to copy.
+    * @return A reference to this counter.
+    */
+   AtomicCounter& operator=(const AtomicCounter& rhs);
+
+   /**
+    * Returns the current value.
+    */
+   int get() const;
+
+   /**
+    * Sets the value.
+    *
+    * @param value
+    *        The new value.
+    */
+   void set(int value);
+
+   /**
+    * Adds to the value.
+    *
+    * @param amount
+    *        The amount to add.
+    * @return The value after the addition.
+    */
+   int add(int amount);
+
+   /**
+    * Adds one to the value.
+    *
+    * @return The value after the increment.
+    */
+   int increment();
+
+   /**
+    * Subtracts one from the value.
+    *
+    * @return The value after the decrement.
+    */
+   int decrement();
+
+private:
+   mutable volatile long mValue;
+};
+
+/**
+ * A set of commands run by the ThreadPool which can be waited on together.
+ *
+ * The commands must remain valid until wait() reports that the group is complete,
+ * so the destructor waits for any commands which are still queued or running.
+ */
+class TaskGroup
+{
+public:
+   /**
+    * Creates an empty group.
+    */
+   TaskGroup();
+
+   /**
+    * Waits for the commands in the group and destroys the group.
+    */
+   ~TaskGroup();
+
+   /**
+    * Queues a command on the thread pool.
+    *
+    * @param command
+    *        The command to run.  It is not copied.
+    */
+   void run(ThreadCommand& command);
+
+   /**
+    * Waits until every command in the group has completed.
+    */
+   void wait();
+
+   /**
+    * Waits until every command in the group has completed, the time elapses or notify() is called.
+    *
+    * When this is called from a pool thread, a queued command of this group is run on the
+    * calling thread instead of blocking, so commands which start an algorithm of their own
+    * cannot starve the pool.
+    *
+    * @param milliseconds
+    *        The maximum time to block.
+    * @return \c True if every command has completed, \c false otherwise.
+    */
+   bool wait(unsigned int milliseconds);
+
+   /**
+    * Wakes any thread blocked in wait() so it can service a request.
+    */
+   void notify();
+
+   /**
+    * Returns \c true if every command in the group has completed.
+    */
+   bool isComplete() const;
+
+private:
+   TaskGroup(const TaskGroup& rhs);
+   TaskGroup& operator=(const TaskGroup& rhs);
+
+   friend class ThreadPool;
+   void addTask();
+   void completeTask();
+
+   mutable DMutex mMutex;
+   DThreadSignal mSignal;
+   int mPendingTasks;
+   bool mNotified;
+};
+
+/**
+ * The process-wide set of worker threads which run the commands of every TaskGroup.
+ *
+ * The pool is created with ConfigurationSettings::getSettingThreadCount() workers the first
+ * time it is used, and the workers live until the application exits.  Each worker has its
+ * own queue.  Commands queued from a worker go to the front of its queue and are run in
+ * last-in first-out order so nested work stays on the thread whose caches hold its data,
+ * while idle workers steal the oldest command from the back of another worker's queue.
+ * Commands queued from other threads are spread over the workers' queues.
+ */
+class ThreadPool
+{
+public:
+   /**
+    * Returns the pool, creating it on first use.
+    */
+   static ThreadPool& instance();
+
+   /**
+    * Returns the number of worker threads.
+    */
+   unsigned int getWorkerCount() const;
+
+   /**
+    * Returns \c true if the calling thread is one of the pool's workers.
+    */
+   bool isWorkerThread() const;
+
+   /**
+    * Queues a command.
+    *
+    * @param command
+    *        The command to run.
+    * @param group
+    *        The group which is notified when the command completes.
+    */
+   void submit(ThreadCommand& command, TaskGroup& group);
+
+   /**
+    * Runs one queued command of a group on the calling thread.
+    *
+    * @param pGroup
+    *        The group whose command should be run, or \c NULL to run any command.
+    * @return \c True if a command was run, \c false if none was queued.
+    */
+   bool runPendingTask(TaskGroup* pGroup);
+
+private:
+   explicit ThreadPool(unsigned int workerCount);
+   ~ThreadPool();
+   ThreadPool(const ThreadPool& rhs);
+   ThreadPool& operator=(const ThreadPool& rhs);
+
+   struct Task
+   {
+      ThreadCommand* mpCommand;
+      TaskGroup* mpGroup;
+   };
+
+   struct Worker
+   {
+      ThreadPool* mpPool;
+      unsigned int mIndex;
+      DMutex mMutex;
+      std::deque<Task> mTasks;
+      BThread mThread;
+   };
+
+   static void createInstance();
+   static void workerFunction(Worker* pWorker);
+   int getWorkerIndex() const;
+   bool popTask(unsigned int firstWorker, TaskGroup* pGroup, Task& task);
+   void execute(const Task& task);
+
+   std::vector<Worker*> mWorkers;
+   pthread_key_t mWorkerKey;
+   AtomicCounter mQueuedTasks;
+   AtomicCounter mNextWorker;
+   DMutex mIdleMutex;
+   DThreadSignal mIdleSignal;
+};
+
+} // end namespace mta
+
+#endif
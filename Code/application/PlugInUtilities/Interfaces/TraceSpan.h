@@ -0,0 +1,117 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef TRACESPAN_H
+#define TRACESPAN_H
+
+#include "AppConfig.h"
+
+#include <string>
+
+class Tracer;
+
+/**
+ *  Records the lifetime of the object as a span in the Tracer.
+ *
+ *  The span starts when the object is created and is added to the tracer when the
+ *  object is destroyed. If tracing is disabled when the object is created, nothing
+ *  is recorded and the object only costs a check of the tracer state.
+ *
+ *  @code
+ *  {
+ *     TraceSpan span("raster", "Read Band");
+ *     // ...read the band...
+ *     span.setBytes(bandSize);
+ *  }
+ *  @endcode
+ *
+ *  @see     Tracer
+ */
+class TraceSpan
+{
+public:
+   /**
+    *  Starts a span.
+    *
+    *  @param   pCategory
+    *           The category of the span. This must remain valid for the lifetime of the object.
+    *  @param   pName
+    *           The name of the span. This must remain valid for the lifetime of the object.
+    */
+   TraceSpan(const char* pCategory, const char* pName);
+
+   /**
+    *  Starts a span.
+    *
+    *  @param   pCategory
+    *           The category of the span. This must remain valid for the lifetime of the object.
+    *  @param   name
+    *           The name of the span.
+    */
+   TraceSpan(const char* pCategory, const std::string& name);
+
+   /**
+    *  Ends the span and adds it to the tracer.
+    */
+   ~TraceSpan();
+
+   /**
+    *  Queries whether the span will be recorded.
+    *
+    *  This can be used to avoid preparing text for setDetail() when tracing is disabled.
+    *
+    *  @return  \c True if tracing was enabled when the span started, otherwise \c false.
+    */
+   bool isActive() const;
+
+   /**
+    *  Changes the name of the span.
+    *
+    *  @param   name
+    *           The new name.
+    */
+   void setName(const std::string& name);
+
+   /**
+    *  Sets the number of bytes processed during the span.
+    *
+    *  @param   bytes
+    *           The number of bytes.
+    */
+   void setBytes(uint64_t bytes);
+
+   /**
+    *  Sets additional text to show with the span.
+    *
+    *  @param   detail
+    *           The text.
+    */
+   void setDetail(const std::string& detail);
+
+   /**
+    *  Returns the tracer if tracing is enabled.
+    *
+    *  @return  The tracer or \c NULL if tracing is disabled or not available.
+    */
+   static Tracer* getActiveTracer();
+
+private:
+   TraceSpan(const TraceSpan& rhs);
+   TraceSpan& operator=(const TraceSpan& rhs);
+
+   Tracer* mpTracer;
+   const char* mpCategory;
+   const char* mpName;
+   std::string mName;
+   double mStartTime;
+   uint64_t mBytes;
+   std::string mDetail;
+};
+
+#endif
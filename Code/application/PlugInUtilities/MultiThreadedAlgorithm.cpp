@@ -10,8 +10,11 @@
 #include "MultiThreadedAlgorithm.h"
 #include "MessageLogMgrImp.h"
 #include "Progress.h"
+#include "TraceSpan.h"
 #include "Units.h"
 
+#include <sstream>
+
 using namespace mta;
 
 unsigned int mta::getNumRequiredThreads(unsigned int dataSize)
@@ -246,12 +249,188 @@ Result MultiThreadReporter::signalMainThread(ThreadCommand& reportStatus, Report
    return currentResult;
 }
 
+//------------ TaskReporter ---------------//
+
+TaskReporter::TaskReporter(int threadCount, TaskGroup& tasks) :
+   mTasks(tasks),
+   mMainThread(pthread_self()),
+   mThreadProgress(threadCount)
+{
+   if (threadCount == 0)
+   {
+      mFailed.set(1);
+      mErrorMessage = "Error: Thread count = 0";
+   }
+}
+
+Result TaskReporter::reportProgress(int threadIndex, int percentDone)
+{
+   mThreadProgress[threadIndex].set(percentDone);
+   return hasError() ? FAILURE : SUCCESS;
+}
+
+Result TaskReporter::reportCompletion(int threadIndex)
+{
+   return reportProgress(threadIndex, 100);
+}
+
+Result TaskReporter::reportError(std::string errorText)
+{
+   {
+      MutexLock lock(mMutex);
+      mErrorMessage = errorText;
+      mFailed.set(1);
+   }
+
+   mTasks.notify();
+   return FAILURE;
+}
+
+int TaskReporter::getProgress() const
+{
+   if (mThreadProgress.empty())
+   {
+      return 0;
+   }
+
+   int total = 0;
+   for (std::vector<AtomicCounter>::const_iterator iter = mThreadProgress.begin(); iter != mThreadProgress.end();
+      ++iter)
+   {
+      total += iter->get();
+   }
+
+   return total / static_cast<int>(mThreadProgress.size());
+}
+
+int TaskReporter::getProgress(int threadIndex) const
+{
+   return mThreadProgress[threadIndex].get();
+}
+
+std::string TaskReporter::getErrorText() const
+{
+   MutexLock lock(mMutex);
+   return mErrorMessage;
+}
+
+bool TaskReporter::hasError() const
+{
+   return mFailed.get() != 0;
+}
+
+void TaskReporter::runInMainThread(ThreadCommand& command)
+{
+   if (pthread_equal(pthread_self(), mMainThread))
+   {
+      command.run();
+      return;
+   }
+
+   MainThreadRequest request;
+   request.mpCommand = &command;
+   request.mComplete = false;
+   {
+      MutexLock lock(mMutex);
+      mRequests.push_back(&request);
+   }
+
+   mTasks.notify();
+
+   MutexLock lock(mMutex);
+   while (request.mComplete == false)
+   {
+      mRequestSignal.ThreadSignalWait(&mMutex);
+   }
+}
+
+void TaskReporter::runMainThreadCommands()
+{
+   std::deque<MainThreadRequest*> requests;
+   {
+      MutexLock lock(mMutex);
+      requests.swap(mRequests);
+   }
+
+   if (requests.empty())
+   {
+      return;
+   }
+
+   for (std::deque<MainThreadRequest*>::iterator iter = requests.begin(); iter != requests.end(); ++iter)
+   {
+      (*iter)->mpCommand->run();
+   }
+
+   MutexLock lock(mMutex);
+   for (std::deque<MainThreadRequest*>::iterator iter = requests.begin(); iter != requests.end(); ++iter)
+   {
+      (*iter)->mComplete = true;
+   }
+
+   mRequestSignal.ThreadSignalBroadcast();
+}
+
+//------------ WorkQueue ---------------//
+
+WorkQueue::WorkQueue() :
+   mDataSize(-1)
+{}
+
+bool WorkQueue::takeChunk(int dataSize, int chunkSize, int& first)
+{
+   mDataSize.set(dataSize);
+   first = mNextItem.add(chunkSize) - chunkSize;
+   return first < dataSize;
+}
+
+void WorkQueue::completeItems(int count)
+{
+   mCompletedItems.add(count);
+}
+
+int WorkQueue::getProgress() const
+{
+   int dataSize = mDataSize.get();
+   if (dataSize < 0)
+   {
+      return -1;
+   }
+   else if (dataSize == 0)
+   {
+      return 100;
+   }
+
+   return static_cast<int>(100.0 * mCompletedItems.get() / dataSize);
+}
+
 //------------ AlgorithmThread ---------------//
 
 void AlgorithmThread::threadFunction(AlgorithmThread *pThreadData)
 {
    pThreadData->waitForAlgorithmLoop();
-   pThreadData->run();
+   {
+      TraceSpan span("thread", "Algorithm Thread");
+      pThreadData->run();
+      if (pThreadData->mpWorkQueue != NULL && pThreadData->mChunkItems > 0)
+      {
+         // The thread stopped before asking for another range
+         pThreadData->mpWorkQueue->completeItems(pThreadData->mChunkItems);
+         pThreadData->mChunkItems = 0;
+      }
+
+      if (span.isActive())
+      {
+         std::stringstream detail;
+         detail << "Thread " << pThreadData->getThreadIndex();
+         const AlgorithmThread::Range& range = pThreadData->mWorkRange;
+         if (range.mLast >= range.mFirst)
+         {
+            detail << ", items " << range.mFirst << " to " << range.mLast;
+         }
+         span.setDetail(detail.str());
+      }
+   }
    if (pThreadData->getReporter().getErrorText() == "")
    {
       if (pThreadData->getReporter().getProgress(pThreadData->getThreadIndex()) != 100)
@@ -306,9 +485,63 @@ AlgorithmThread::Range AlgorithmThread::getThreadRange(int threadCount, int data
          }
       }
    }
+   mWorkRange = range;
    return range;
 }
 
+bool AlgorithmThread::getNextRange(int threadCount, int dataSize, Range& range, int chunkSize)
+{
+   if (mpWorkQueue == NULL)
+   {
+      if (mRangeTaken)
+      {
+         return false;
+      }
+
+      mRangeTaken = true;
+      range = getThreadRange(threadCount, dataSize);
+      return range.mFirst <= range.mLast;
+   }
+
+   if (mChunkItems > 0)
+   {
+      mpWorkQueue->completeItems(mChunkItems);
+      mChunkItems = 0;
+   }
+
+   if (chunkSize <= 0)
+   {
+      chunkSize = std::max(1, dataSize / (std::max(threadCount, 1) * 8));
+   }
+
+   int first = 0;
+   if (mpWorkQueue->takeChunk(dataSize, chunkSize, first) == false)
+   {
+      return false;
+   }
+
+   range.mFirst = first;
+   range.mLast = std::min(first + chunkSize, dataSize) - 1;
+   mChunkItems = range.mLast - range.mFirst + 1;
+
+   // The chunks are taken in order, so the thread's items span from its first chunk to its last
+   if (mWorkRange.mLast < mWorkRange.mFirst)
+   {
+      mWorkRange = range;
+   }
+   else
+   {
+      mWorkRange.mLast = range.mLast;
+   }
+
+   return true;
+}
+
+void AlgorithmThread::setWorkQueue(WorkQueue* pQueue)
+{
+   mpWorkQueue = pQueue;
+}
+
 int AlgorithmThread::getThreadIndex() const
 {
    return mThreadIndex;
@@ -31,6 +31,14 @@ PageCache::~PageCache()
 CachedPage::UnitPtr PageCache::getUnit(DataRequest *pOriginalRequest,
    DimensionDescriptor startRow, 
    DimensionDescriptor startBand)
+{
+   return getUnit(pOriginalRequest, startRow, DimensionDescriptor(), startBand);
+}
+
+CachedPage::UnitPtr PageCache::getUnit(DataRequest *pOriginalRequest,
+   DimensionDescriptor startRow, 
+   DimensionDescriptor startColumn, 
+   DimensionDescriptor startBand)
 {
    CachedPage::UnitPtr pUnit;
 
@@ -44,8 +52,24 @@ CachedPage::UnitPtr PageCache::getUnit(DataRequest *pOriginalRequest,
    {
       band = startBand;
    }
-   UnitList ::iterator ppMatchingUnit = find_if (mUnits.begin(), mUnits.end(), 
-      boost::bind(&CachedPage::CacheUnit::matches, _1, startRow, concurrentRows, band));
+
+   UnitList::iterator ppMatchingUnit;
+   if (pOriginalRequest->getTiled() && requestedFormat != BIL && startColumn.isValid())
+   {
+      int concurrentColumns = std::min(static_cast<int>(pOriginalRequest->getConcurrentColumns()),
+         mColumnCount - static_cast<int>(startColumn.getActiveNumber()));
+      bool (CachedPage::CacheUnit::*pMatches)(DimensionDescriptor, int, DimensionDescriptor, int,
+         DimensionDescriptor) = &CachedPage::CacheUnit::matches;
+      ppMatchingUnit = find_if(mUnits.begin(), mUnits.end(), 
+         boost::bind(pMatches, _1, startRow, concurrentRows, startColumn, concurrentColumns, band));
+   }
+   else
+   {
+      bool (CachedPage::CacheUnit::*pMatches)(DimensionDescriptor, int, DimensionDescriptor) =
+         &CachedPage::CacheUnit::matches;
+      ppMatchingUnit = find_if(mUnits.begin(), mUnits.end(), 
+         boost::bind(pMatches, _1, startRow, concurrentRows, band));
+   }
 
    if (ppMatchingUnit != mUnits.end()) // cache hit
    {
@@ -60,7 +84,7 @@ CachedPage::UnitPtr PageCache::getUnit(DataRequest *pOriginalRequest,
 }
 
 CachedPage *PageCache::createPage(CachedPage::UnitPtr pUnit, InterleaveFormatType requestedFormat,
-   DimensionDescriptor startRow, DimensionDescriptor startColumn, DimensionDescriptor startBand)
+   DimensionDescriptor startRow, DimensionDescriptor startColumn, DimensionDescriptor startBand, bool tiled)
 {
    if (pUnit.get() == NULL)
    {
@@ -71,30 +95,50 @@ CachedPage *PageCache::createPage(CachedPage::UnitPtr pUnit, InterleaveFormatTyp
    mCacheSize += pUnit->getSize();
    enforceCacheSize();
 
-   int columnOffset = mColumnCount*(startRow.getActiveNumber()-pUnit->getStartRow().getActiveNumber());
+   // units with a subset of the columns are offset from their first column
+   int unitColumnCount = mColumnCount;
+   int unitStartColumn = 0;
+   if (pUnit->getConcurrentColumns() != 0)
+   {
+      unitColumnCount = pUnit->getConcurrentColumns();
+      unitStartColumn = pUnit->getStartColumn().getActiveNumber();
+   }
+
+   int rowOffset = startRow.getActiveNumber() - pUnit->getStartRow().getActiveNumber();
+   int columnOffset = startColumn.getActiveNumber() - unitStartColumn;
+   unsigned int columnBytes = mBytesPerBand;
+   unsigned int rowBytes = 0;
    unsigned int offset = 0;
    if (requestedFormat == BIP)
    {
-      columnOffset += startColumn.getActiveNumber();
-      offset = mBytesPerBand*(columnOffset*mBandCount + startBand.getActiveNumber());
+      columnBytes *= mBandCount;
+      rowBytes = columnBytes*unitColumnCount + pUnit->getInterlineBytes();
+      offset = rowBytes*rowOffset + columnBytes*columnOffset + mBytesPerBand*startBand.getActiveNumber();
    }
    else if (requestedFormat == BSQ) // a BSQ row is 1 row of 1 band of data
    {
-      columnOffset += startColumn.getActiveNumber();
-      offset = mBytesPerBand*columnOffset;
+      rowBytes = columnBytes*unitColumnCount + pUnit->getInterlineBytes();
+      offset = rowBytes*rowOffset + columnBytes*columnOffset;
    }
    else if (requestedFormat == BIL)
    {
-      columnOffset *= mBandCount; // get to the appropriate row in page
-      columnOffset += startBand.getActiveNumber()*mColumnCount + // get to the appropriate band in page
-                      startColumn.getActiveNumber(); // get to the appropriate column in page
-      offset = mBytesPerBand*columnOffset;
+      rowBytes = columnBytes*unitColumnCount*mBandCount + pUnit->getInterlineBytes();
+      offset = rowBytes*rowOffset + // get to the appropriate row in page
+               columnBytes*(startBand.getActiveNumber()*unitColumnCount + // get to the appropriate band in page
+                            columnOffset); // get to the appropriate column in page
+      tiled = false;
    }
    else
    {
       return NULL;
    }
 
+   if (tiled)
+   {
+      unsigned int numColumns = unitColumnCount - columnOffset;
+      return new CachedPage(pUnit, offset, startRow, numColumns, rowBytes - columnBytes*numColumns);
+   }
+
    return new CachedPage(pUnit, offset, startRow);
 }
 
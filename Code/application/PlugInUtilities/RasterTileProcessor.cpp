@@ -0,0 +1,310 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "BitMask.h"
+#include "ConfigurationSettings.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterTileProcessor.h"
+
+#include <algorithm>
+
+using namespace std;
+
+//------------ RasterTileReader ---------------//
+
+RasterTileReader::RasterTileReader(const vector<const RasterElement*>& inputs, RasterElement* pOutput) :
+   mInputs(inputs.size()),
+   mHasOutput(pOutput != NULL),
+   mFirstRow(0),
+   mRowCount(0),
+   mColumnCount(0)
+{
+   // The elements are stored in place since they hold the accessors
+   mElements.resize(inputs.size() + (pOutput == NULL ? 0 : 1));
+   for (vector<Element>::size_type i = 0; i < mElements.size(); ++i)
+   {
+      Element& element = mElements[i];
+      element.mpWritableElement = (i < inputs.size() ? NULL : pOutput);
+      element.mpElement = (i < inputs.size() ? inputs[i] : pOutput);
+
+      const RasterDataDescriptor* pDescriptor =
+         static_cast<const RasterDataDescriptor*>(element.mpElement->getDataDescriptor());
+      element.mInterleave = pDescriptor->getInterleaveFormat();
+      element.mBandCount = pDescriptor->getBandCount();
+      element.mBytesPerElement = pDescriptor->getBytesPerElement();
+      mColumnCount = pDescriptor->getColumnCount();
+   }
+}
+
+bool RasterTileReader::open(unsigned int firstRow, unsigned int lastRow)
+{
+   for (vector<Element>::iterator iter = mElements.begin(); iter != mElements.end(); ++iter)
+   {
+      Element& element = *iter;
+      element.mAccessors.clear();
+
+      const RasterDataDescriptor* pDescriptor =
+         static_cast<const RasterDataDescriptor*>(element.mpElement->getDataDescriptor());
+
+      // BSQ bands are separate blocks of data, so each band has its own accessor
+      unsigned int accessorCount = (element.mInterleave == BSQ ? element.mBandCount : 1);
+      for (unsigned int band = 0; band < accessorCount; ++band)
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(element.mInterleave);
+         pRequest->setRows(pDescriptor->getActiveRow(firstRow), pDescriptor->getActiveRow(lastRow), 1);
+         if (element.mInterleave == BSQ)
+         {
+            pRequest->setBands(pDescriptor->getActiveBand(band), pDescriptor->getActiveBand(band), 1);
+         }
+
+         pRequest->setWritable(element.mpWritableElement != NULL);
+         DataAccessor accessor = (element.mpWritableElement != NULL ?
+            element.mpWritableElement->getDataAccessor(pRequest.release()) :
+            element.mpElement->getDataAccessor(pRequest.release()));
+         if (accessor.isValid() == false)
+         {
+            return false;
+         }
+
+         element.mAccessors.push_back(accessor);
+      }
+   }
+
+   return true;
+}
+
+bool RasterTileReader::read(unsigned int row, unsigned int lastRow)
+{
+   // A tile is the rows which every element has in memory, so each accessor is moved
+   // before any layout is set in case moving one accessor pages out another's rows
+   unsigned int rowCount = lastRow - row + 1;
+   for (vector<Element>::iterator iter = mElements.begin(); iter != mElements.end(); ++iter)
+   {
+      if (moveTo(*iter, row, rowCount) == false)
+      {
+         return false;
+      }
+   }
+
+   for (vector<Element>::size_type i = 0; i < mElements.size(); ++i)
+   {
+      setLayout(mElements[i], i < mInputs.size() ? mInputs[i] : mOutput);
+   }
+
+   mFirstRow = row;
+   mRowCount = rowCount;
+   return true;
+}
+
+unsigned int RasterTileReader::getFirstRow() const
+{
+   return mFirstRow;
+}
+
+unsigned int RasterTileReader::getRowCount() const
+{
+   return mRowCount;
+}
+
+unsigned int RasterTileReader::getColumnCount() const
+{
+   return mColumnCount;
+}
+
+const vector<RasterTileLayout>& RasterTileReader::getInputs() const
+{
+   return mInputs;
+}
+
+const RasterTileLayout* RasterTileReader::getOutput() const
+{
+   return mHasOutput ? &mOutput : NULL;
+}
+
+bool RasterTileReader::moveTo(Element& element, unsigned int row, unsigned int& rowCount)
+{
+   for (vector<DataAccessor>::iterator iter = element.mAccessors.begin(); iter != element.mAccessors.end(); ++iter)
+   {
+      DataAccessor& accessor = *iter;
+      accessor->toPixel(static_cast<int>(row), 0);
+      if (accessor.isValid() == false)
+      {
+         return false;
+      }
+
+      size_t concurrentRows = max(accessor->getConcurrentRows(), static_cast<size_t>(1));
+      rowCount = min(rowCount, static_cast<unsigned int>(concurrentRows));
+   }
+
+   return true;
+}
+
+void RasterTileReader::setLayout(Element& element, RasterTileLayout& layout)
+{
+   DataAccessor& accessor = element.mAccessors.front();
+   layout.mRowStride = accessor->getRowStride();
+   layout.mColumnStride = element.mBytesPerElement;
+   layout.mBands.resize(element.mBandCount);
+
+   char* pRow = static_cast<char*>(accessor->getRow());
+   for (unsigned int band = 0; band < element.mBandCount; ++band)
+   {
+      switch (element.mInterleave)
+      {
+      case BIP:
+         layout.mBands[band] = pRow + band * element.mBytesPerElement;
+         break;
+      case BIL:
+         layout.mBands[band] = pRow + static_cast<size_t>(band) * mColumnCount * element.mBytesPerElement;
+         break;
+      default:
+         layout.mBands[band] = static_cast<char*>(element.mAccessors[band]->getRow());
+         break;
+      }
+   }
+
+   if (element.mInterleave == BIP)
+   {
+      layout.mColumnStride *= element.mBandCount;
+   }
+}
+
+//------------ RasterTileProcessor ---------------//
+
+RasterTileProcessor::RasterTileProcessor() :
+   mpOutput(NULL),
+   mpAoi(NULL),
+   mpReporter(NULL),
+   mpAbort(NULL),
+   mFirstRow(0),
+   mLastRow(0)
+{}
+
+void RasterTileProcessor::addInput(const RasterElement* pElement)
+{
+   mInputs.push_back(pElement);
+}
+
+void RasterTileProcessor::setOutput(RasterElement* pElement)
+{
+   mpOutput = pElement;
+}
+
+void RasterTileProcessor::setAoi(const BitMask* pAoi)
+{
+   mpAoi = pAoi;
+}
+
+void RasterTileProcessor::setProgressReporter(mta::ProgressReporter* pReporter)
+{
+   mpReporter = pReporter;
+}
+
+void RasterTileProcessor::setAbortFlag(const bool* pAbort)
+{
+   mpAbort = pAbort;
+}
+
+const string& RasterTileProcessor::getErrorText() const
+{
+   return mErrorText;
+}
+
+bool RasterTileProcessor::prepare(bool complexAllowed)
+{
+   mErrorText.clear();
+   if (mInputs.empty())
+   {
+      mErrorText = "No raster element was provided.";
+      return false;
+   }
+
+   unsigned int rowCount = 0;
+   unsigned int columnCount = 0;
+   for (vector<const RasterElement*>::size_type i = 0; i <= mInputs.size(); ++i)
+   {
+      const RasterElement* pElement = (i < mInputs.size() ? mInputs[i] : mpOutput);
+      if (i == mInputs.size() && pElement == NULL)
+      {
+         break;
+      }
+
+      const RasterDataDescriptor* pDescriptor = (pElement == NULL ? NULL :
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor()));
+      if (pDescriptor == NULL)
+      {
+         mErrorText = "A raster element is invalid.";
+         return false;
+      }
+
+      if (i == 0)
+      {
+         rowCount = pDescriptor->getRowCount();
+         columnCount = pDescriptor->getColumnCount();
+         mEncoding = pDescriptor->getDataType();
+      }
+      else if (pDescriptor->getRowCount() != rowCount || pDescriptor->getColumnCount() != columnCount)
+      {
+         mErrorText = "The raster elements do not have the same number of rows and columns.";
+         return false;
+      }
+      else if (i < mInputs.size() && pDescriptor->getDataType() != mEncoding)
+      {
+         mErrorText = "The input raster elements do not have the same data type.";
+         return false;
+      }
+   }
+
+   if (complexAllowed == false && (mEncoding == INT4SCOMPLEX || mEncoding == FLT8COMPLEX))
+   {
+      mErrorText = "Complex data is not supported.";
+      return false;
+   }
+
+   // Only the rows within the AOI's bounding box are read
+   int firstRow = 0;
+   int lastRow = static_cast<int>(rowCount) - 1;
+   if (mpAoi != NULL && mpAoi->isOutsideSelected() == false)
+   {
+      int x1 = 0;
+      int y1 = 0;
+      int x2 = 0;
+      int y2 = 0;
+      mpAoi->getMinimalBoundingBox(x1, y1, x2, y2);
+      firstRow = max(firstRow, min(y1, y2));
+      lastRow = min(lastRow, max(y1, y2));
+   }
+
+   mFirstRow = static_cast<unsigned int>(max(firstRow, 0));
+   mLastRow = static_cast<unsigned int>(max(lastRow, 0));
+   if (lastRow < firstRow)
+   {
+      mFirstRow = 1;
+      mLastRow = 0;
+   }
+
+   return true;
+}
+
+bool RasterTileProcessor::isAborted() const
+{
+   return mpAbort != NULL && *mpAbort;
+}
+
+int RasterTileProcessor::getThreadCount() const
+{
+   unsigned int threadCount = max(ConfigurationSettings::getSettingThreadCount(), 1U);
+   return static_cast<int>(min(threadCount, mLastRow - mFirstRow + 1));
+}
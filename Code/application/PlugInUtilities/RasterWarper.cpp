@@ -0,0 +1,851 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterWarper.h"
+#include "switchOnEncoding.h"
+
+#include <algorithm>
+#include <limits>
+#include <list>
+#include <map>
+#include <math.h>
+
+namespace
+{
+   /**
+    * Source locations computed from the WarpMapping on a regular grid of output locations.
+    */
+   struct WarpGrid
+   {
+      WarpGrid() :
+         mSpacing(0),
+         mNodeColumns(0),
+         mNodeRows(0)
+      {}
+
+      const LocationType& node(unsigned int nodeRow, unsigned int nodeColumn) const
+      {
+         return mNodes[nodeRow * mNodeColumns + nodeColumn];
+      }
+
+      unsigned int mSpacing;
+      unsigned int mNodeColumns;
+      unsigned int mNodeRows;
+      std::vector<LocationType> mNodes;
+   };
+
+   LocationType lerp(const LocationType& first, const LocationType& second, double fraction)
+   {
+      return LocationType(first.mX + (second.mX - first.mX) * fraction, first.mY + (second.mY - first.mY) * fraction);
+   }
+
+   bool buildGrid(const WarpMapping& mapping, unsigned int rows, unsigned int columns, unsigned int spacing,
+      double maxError, WarpGrid& grid, std::string& errorText)
+   {
+      spacing = std::max(spacing, 1U);
+      while (true)
+      {
+         grid.mSpacing = spacing;
+         grid.mNodeColumns = std::max(2U, (columns - 1 + spacing - 1) / spacing + 1);
+         grid.mNodeRows = std::max(2U, (rows - 1 + spacing - 1) / spacing + 1);
+
+         std::vector<LocationType> outputPixels;
+         outputPixels.reserve(grid.mNodeColumns * grid.mNodeRows);
+         for (unsigned int nodeRow = 0; nodeRow < grid.mNodeRows; ++nodeRow)
+         {
+            for (unsigned int nodeColumn = 0; nodeColumn < grid.mNodeColumns; ++nodeColumn)
+            {
+               outputPixels.push_back(LocationType(nodeColumn * spacing, nodeRow * spacing));
+            }
+         }
+         if (!mapping.map(outputPixels, grid.mNodes) || grid.mNodes.size() != outputPixels.size())
+         {
+            errorText = "Unable to compute the warp mapping.";
+            return false;
+         }
+         if (spacing == 1)
+         {
+            return true;
+         }
+
+         // Check the interpolation error at the center of each grid cell. The center is
+         // the furthest point from the nodes so it is a good estimate of the worst case.
+         std::vector<LocationType> centers;
+         centers.reserve((grid.mNodeColumns - 1) * (grid.mNodeRows - 1));
+         double halfSpacing = spacing / 2.0;
+         for (unsigned int nodeRow = 0; nodeRow < grid.mNodeRows - 1; ++nodeRow)
+         {
+            for (unsigned int nodeColumn = 0; nodeColumn < grid.mNodeColumns - 1; ++nodeColumn)
+            {
+               centers.push_back(LocationType(nodeColumn * spacing + halfSpacing, nodeRow * spacing + halfSpacing));
+            }
+         }
+         std::vector<LocationType> exactCenters;
+         if (!mapping.map(centers, exactCenters) || exactCenters.size() != centers.size())
+         {
+            errorText = "Unable to compute the warp mapping.";
+            return false;
+         }
+
+         bool withinTolerance = true;
+         std::vector<LocationType>::const_iterator exact = exactCenters.begin();
+         for (unsigned int nodeRow = 0; nodeRow < grid.mNodeRows - 1 && withinTolerance; ++nodeRow)
+         {
+            for (unsigned int nodeColumn = 0; nodeColumn < grid.mNodeColumns - 1; ++nodeColumn, ++exact)
+            {
+               LocationType top = lerp(grid.node(nodeRow, nodeColumn), grid.node(nodeRow, nodeColumn + 1), 0.5);
+               LocationType bottom =
+                  lerp(grid.node(nodeRow + 1, nodeColumn), grid.node(nodeRow + 1, nodeColumn + 1), 0.5);
+               LocationType interpolated = lerp(top, bottom, 0.5);
+               if (fabs(interpolated.mX - exact->mX) > maxError || fabs(interpolated.mY - exact->mY) > maxError)
+               {
+                  withinTolerance = false;
+                  break;
+               }
+            }
+         }
+         if (withinTolerance)
+         {
+            return true;
+         }
+         spacing /= 2;
+      }
+   }
+
+   /**
+    * Computes the source location of each pixel in an output tile from a WarpGrid.
+    *
+    * Within a grid cell, the interpolated location is linear along a row so the
+    * location of each pixel is the location of the previous pixel plus a constant step.
+    */
+   void interpolateTile(const WarpGrid& grid, unsigned int startRow, unsigned int startColumn,
+      unsigned int rowCount, unsigned int columnCount, std::vector<LocationType>& locations)
+   {
+      locations.resize(rowCount * columnCount);
+      std::vector<LocationType>::iterator location = locations.begin();
+      const double spacing = grid.mSpacing;
+      for (unsigned int row = startRow; row < startRow + rowCount; ++row)
+      {
+         unsigned int nodeRow = std::min(row / grid.mSpacing, grid.mNodeRows - 2);
+         double rowFraction = (row - nodeRow * spacing) / spacing;
+
+         unsigned int column = startColumn;
+         while (column < startColumn + columnCount)
+         {
+            unsigned int nodeColumn = std::min(column / grid.mSpacing, grid.mNodeColumns - 2);
+            LocationType left =
+               lerp(grid.node(nodeRow, nodeColumn), grid.node(nodeRow + 1, nodeColumn), rowFraction);
+            LocationType right =
+               lerp(grid.node(nodeRow, nodeColumn + 1), grid.node(nodeRow + 1, nodeColumn + 1), rowFraction);
+            LocationType step((right.mX - left.mX) / spacing, (right.mY - left.mY) / spacing);
+
+            double columnFraction = column - nodeColumn * spacing;
+            LocationType current(left.mX + step.mX * columnFraction, left.mY + step.mY * columnFraction);
+            unsigned int cellEnd = std::min((nodeColumn + 1) * grid.mSpacing, startColumn + columnCount);
+            if (nodeColumn == grid.mNodeColumns - 2)
+            {
+               cellEnd = startColumn + columnCount;
+            }
+            for (; column < cellEnd; ++column, ++location)
+            {
+               *location = current;
+               current.mX += step.mX;
+               current.mY += step.mY;
+            }
+         }
+      }
+   }
+
+   template<typename T>
+   T toEncoding(double value, bool round = true)
+   {
+      if (std::numeric_limits<T>::is_integer)
+      {
+         if (round)
+         {
+            value = floor(value + 0.5);
+         }
+         else
+         {
+            value = (value < 0.0 ? ceil(value) : floor(value));
+         }
+
+         if (value < static_cast<double>(std::numeric_limits<T>::min()))
+         {
+            return std::numeric_limits<T>::min();
+         }
+         if (value > static_cast<double>(std::numeric_limits<T>::max()))
+         {
+            return std::numeric_limits<T>::max();
+         }
+      }
+      return static_cast<T>(value);
+   }
+
+   double cubicWeight(double distance)
+   {
+      // Keys cubic convolution kernel with a = -0.5
+      distance = fabs(distance);
+      if (distance < 1.0)
+      {
+         return (1.5 * distance - 2.5) * distance * distance + 1.0;
+      }
+      if (distance < 2.0)
+      {
+         return ((-0.5 * distance + 2.5) * distance - 4.0) * distance + 2.0;
+      }
+      return 0.0;
+   }
+
+   /**
+    * A per-thread cache of square blocks of single source bands.
+    *
+    * Interpolation kernels read neighboring pixels which are almost always in the
+    * same block, so the source is read through the pager one block at a time. If a
+    * block can not be read, get() returns 0.0 and hasFailed() returns \c true so the
+    * caller can stop instead of writing the values.
+    */
+   template<typename T>
+   class SourceBlockCache
+   {
+   public:
+      SourceBlockCache(const RasterElement* pSource, unsigned int blockSize, unsigned int maxBlocks) :
+         mpSource(pSource),
+         mpDescriptor(static_cast<const RasterDataDescriptor*>(pSource->getDataDescriptor())),
+         mBlockSize(blockSize),
+         mMaxBlocks(maxBlocks),
+         mRows(static_cast<int>(mpDescriptor->getRowCount())),
+         mColumns(static_cast<int>(mpDescriptor->getColumnCount())),
+         mUseCount(0),
+         mpLastBlock(NULL),
+         mFailed(false)
+      {}
+
+      int getRowCount() const
+      {
+         return mRows;
+      }
+
+      int getColumnCount() const
+      {
+         return mColumns;
+      }
+
+      bool hasFailed() const
+      {
+         return mFailed;
+      }
+
+      /**
+       * Get a source value. The row and column are clamped to the source extents.
+       */
+      double get(unsigned int band, int row, int column)
+      {
+         row = std::max(0, std::min(row, mRows - 1));
+         column = std::max(0, std::min(column, mColumns - 1));
+         int blockRow = row / mBlockSize;
+         int blockColumn = column / mBlockSize;
+         if (mpLastBlock == NULL || mpLastBlock->mBand != band || mpLastBlock->mBlockRow != blockRow ||
+            mpLastBlock->mBlockColumn != blockColumn)
+         {
+            mpLastBlock = getBlock(band, blockRow, blockColumn);
+            if (mpLastBlock == NULL)
+            {
+               mFailed = true;
+               return 0.0;
+            }
+         }
+         const Block& block = *mpLastBlock;
+         return static_cast<double>(
+            block.mData[(row - block.mStartRow) * block.mColumns + (column - block.mStartColumn)]);
+      }
+
+   private:
+      struct Block
+      {
+         unsigned int mBand;
+         int mBlockRow;
+         int mBlockColumn;
+         int mStartRow;
+         int mStartColumn;
+         int mColumns;
+         unsigned int mLastUse;
+         std::vector<T> mData;
+      };
+
+      typedef std::map<std::pair<unsigned int, std::pair<int, int> >, Block*> BlockMap;
+
+      Block* getBlock(unsigned int band, int blockRow, int blockColumn)
+      {
+         typename BlockMap::key_type key(band, std::make_pair(blockRow, blockColumn));
+         typename BlockMap::iterator found = mBlocks.find(key);
+         if (found != mBlocks.end())
+         {
+            found->second->mLastUse = ++mUseCount;
+            return found->second;
+         }
+
+         Block* pBlock = NULL;
+         if (mBlocks.size() < mMaxBlocks)
+         {
+            mStorage.push_back(Block());
+            pBlock = &mStorage.back();
+         }
+         else
+         {
+            typename BlockMap::iterator oldest = mBlocks.begin();
+            for (typename BlockMap::iterator iter = mBlocks.begin(); iter != mBlocks.end(); ++iter)
+            {
+               if (iter->second->mLastUse < oldest->second->mLastUse)
+               {
+                  oldest = iter;
+               }
+            }
+            pBlock = oldest->second;
+            mBlocks.erase(oldest);
+         }
+
+         pBlock->mBand = band;
+         pBlock->mBlockRow = blockRow;
+         pBlock->mBlockColumn = blockColumn;
+         pBlock->mStartRow = blockRow * mBlockSize;
+         pBlock->mStartColumn = blockColumn * mBlockSize;
+         int stopRow = std::min(pBlock->mStartRow + static_cast<int>(mBlockSize), mRows) - 1;
+         int stopColumn = std::min(pBlock->mStartColumn + static_cast<int>(mBlockSize), mColumns) - 1;
+         pBlock->mColumns = stopColumn - pBlock->mStartColumn + 1;
+         pBlock->mData.resize((stopRow - pBlock->mStartRow + 1) * pBlock->mColumns);
+         pBlock->mLastUse = ++mUseCount;
+
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(BSQ);
+         pRequest->setRows(mpDescriptor->getActiveRow(pBlock->mStartRow), mpDescriptor->getActiveRow(stopRow));
+         pRequest->setColumns(mpDescriptor->getActiveColumn(pBlock->mStartColumn),
+            mpDescriptor->getActiveColumn(stopColumn), pBlock->mColumns);
+         pRequest->setBands(mpDescriptor->getActiveBand(band), mpDescriptor->getActiveBand(band), 1);
+         DataAccessor accessor = mpSource->getDataAccessor(pRequest.release());
+         if (!accessor.isValid())
+         {
+            mStorage.remove_if(IsBlock(pBlock));
+            return NULL;
+         }
+
+         typename std::vector<T>::iterator value = pBlock->mData.begin();
+         for (int row = pBlock->mStartRow; row <= stopRow; ++row)
+         {
+            const T* pRow = reinterpret_cast<const T*>(accessor->getRow());
+            value = std::copy(pRow, pRow + pBlock->mColumns, value);
+            accessor->nextRow();
+         }
+
+         mBlocks[key] = pBlock;
+         return pBlock;
+      }
+
+      struct IsBlock
+      {
+         IsBlock(const Block* pBlock) : mpBlock(pBlock) {}
+         bool operator()(const Block& block) const
+         {
+            return &block == mpBlock;
+         }
+         const Block* mpBlock;
+      };
+
+      const RasterElement* mpSource;
+      const RasterDataDescriptor* mpDescriptor;
+      unsigned int mBlockSize;
+      unsigned int mMaxBlocks;
+      int mRows;
+      int mColumns;
+      unsigned int mUseCount;
+      std::list<Block> mStorage;
+      BlockMap mBlocks;
+      Block* mpLastBlock;
+      bool mFailed;
+   };
+
+   template<typename T>
+   bool sample(SourceBlockCache<T>& cache, unsigned int band, const LocationType& location,
+      RasterUtilities::InterpolationType interp, RasterWarper::SourceBoundsType bounds, double& value)
+   {
+      const double x = location.mX;
+      const double y = location.mY;
+      const double minimum = (bounds == RasterWarper::PIXEL_INDEX ? 0.0 : -0.5);
+      if (!(x >= minimum && y >= minimum && x < cache.getColumnCount() + minimum &&
+         y < cache.getRowCount() + minimum))
+      {
+         return false;
+      }
+
+      switch (interp)
+      {
+      case RasterUtilities::NEAREST_NEIGHBOR:
+         value = cache.get(band, static_cast<int>(floor(y + 0.5)), static_cast<int>(floor(x + 0.5)));
+         break;
+      case RasterUtilities::BILINEAR:
+         {
+            int x0 = static_cast<int>(floor(x));
+            int y0 = static_cast<int>(floor(y));
+            double u = x - x0;
+            double v = y - y0;
+            value = cache.get(band, y0, x0) * ((1.0 - u) * (1.0 - v)) +
+               cache.get(band, y0, x0 + 1) * (u * (1.0 - v)) +
+               cache.get(band, y0 + 1, x0) * ((1.0 - u) * v) +
+               cache.get(band, y0 + 1, x0 + 1) * (u * v);
+            break;
+         }
+      case RasterUtilities::BICUBIC:
+         {
+            int x0 = static_cast<int>(floor(x));
+            int y0 = static_cast<int>(floor(y));
+            double columnWeights[4];
+            double rowWeights[4];
+            for (int i = 0; i < 4; ++i)
+            {
+               columnWeights[i] = cubicWeight(x - (x0 - 1 + i));
+               rowWeights[i] = cubicWeight(y - (y0 - 1 + i));
+            }
+            value = 0.0;
+            for (int j = 0; j < 4; ++j)
+            {
+               double rowValue = 0.0;
+               for (int i = 0; i < 4; ++i)
+               {
+                  rowValue += columnWeights[i] * cache.get(band, y0 - 1 + j, x0 - 1 + i);
+               }
+               value += rowWeights[j] * rowValue;
+            }
+            break;
+         }
+      default:
+         return false;
+      }
+      return true;
+   }
+
+   struct WarpThreadInput
+   {
+      WarpThreadInput() :
+         mpSource(NULL),
+         mpDestination(NULL),
+         mpGrid(NULL),
+         mBadValue(0.0),
+         mSourceBounds(RasterWarper::PIXEL_AREA),
+         mRoundValues(true),
+         mTileSize(0),
+         mTileColumns(0),
+         mTileCount(0),
+         mpAbortFlag(NULL)
+      {}
+
+      const RasterElement* mpSource;
+      RasterElement* mpDestination;
+      const WarpGrid* mpGrid;
+      std::vector<unsigned int> mBands;
+      RasterUtilities::InterpolationType mInterpolation;
+      double mBadValue;
+      RasterWarper::SourceBoundsType mSourceBounds;
+      bool mRoundValues;
+      unsigned int mTileSize;
+      unsigned int mTileColumns;
+      unsigned int mTileCount;
+      const bool* mpAbortFlag;
+   };
+
+   class WarpThread : public mta::AlgorithmThread
+   {
+   public:
+      WarpThread(const WarpThreadInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mTileRange(getThreadRange(threadCount, input.mTileCount)),
+         mBadPixelCount(0)
+      {}
+
+      virtual ~WarpThread() {}
+
+      void run()
+      {
+         const RasterDataDescriptor* pDescriptor =
+            static_cast<const RasterDataDescriptor*>(mInput.mpSource->getDataDescriptor());
+         switchOnEncoding(pDescriptor->getDataType(), warpTiles, NULL);
+      }
+
+      uint64_t getBadPixelCount() const
+      {
+         return mBadPixelCount;
+      }
+
+   private:
+      WarpThread& operator=(const WarpThread& rhs);
+
+      template<typename T>
+      void warpTiles(const T*)
+      {
+         const RasterDataDescriptor* pDestDescriptor =
+            static_cast<const RasterDataDescriptor*>(mInput.mpDestination->getDataDescriptor());
+         const bool isBip = (pDestDescriptor->getInterleaveFormat() == BIP);
+         const unsigned int destRows = pDestDescriptor->getRowCount();
+         const unsigned int destColumns = pDestDescriptor->getColumnCount();
+         const unsigned int bandCount = mInput.mBands.size();
+         const T badValue = toEncoding<T>(mInput.mBadValue);
+
+         SourceBlockCache<T> cache(mInput.mpSource, 64, 256);
+         std::vector<LocationType> locations;
+         std::vector<unsigned char> valid;
+         for (int tile = mTileRange.mFirst; tile <= mTileRange.mLast; ++tile)
+         {
+            if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
+            {
+               break;
+            }
+            getReporter().reportProgress(getThreadIndex(), mTileRange.computePercent(tile));
+
+            unsigned int startRow = (tile / mInput.mTileColumns) * mInput.mTileSize;
+            unsigned int startColumn = (tile % mInput.mTileColumns) * mInput.mTileSize;
+            unsigned int rowCount = std::min(mInput.mTileSize, destRows - startRow);
+            unsigned int columnCount = std::min(mInput.mTileSize, destColumns - startColumn);
+            interpolateTile(*mInput.mpGrid, startRow, startColumn, rowCount, columnCount, locations);
+
+            // Source locations are shared by all bands so only compute the valid flags once
+            valid.assign(locations.size(), 1);
+
+            unsigned int requestBands = (isBip ? 1 : bandCount);
+            for (unsigned int requestBand = 0; requestBand < requestBands; ++requestBand)
+            {
+               FactoryResource<DataRequest> pRequest;
+               pRequest->setRows(pDestDescriptor->getActiveRow(startRow),
+                  pDestDescriptor->getActiveRow(startRow + rowCount - 1));
+               pRequest->setColumns(pDestDescriptor->getActiveColumn(startColumn),
+                  pDestDescriptor->getActiveColumn(startColumn + columnCount - 1), columnCount);
+               if (!isBip)
+               {
+                  pRequest->setBands(pDestDescriptor->getActiveBand(requestBand),
+                     pDestDescriptor->getActiveBand(requestBand), 1);
+               }
+               pRequest->setWritable(true);
+               DataAccessor accessor = mInput.mpDestination->getDataAccessor(pRequest.release());
+               if (!accessor.isValid())
+               {
+                  getReporter().reportError("Unable to access the warp destination.");
+                  return;
+               }
+
+               unsigned int firstBand = (isBip ? 0 : requestBand);
+               unsigned int lastBand = (isBip ? bandCount - 1 : requestBand);
+               std::vector<LocationType>::const_iterator location = locations.begin();
+               std::vector<unsigned char>::iterator isValid = valid.begin();
+               for (unsigned int row = 0; row < rowCount; ++row)
+               {
+                  VERIFYNRV(accessor.isValid());
+                  for (unsigned int column = 0; column < columnCount; ++column, ++location, ++isValid)
+                  {
+                     T* pPixel = reinterpret_cast<T*>(accessor->getColumn());
+                     for (unsigned int band = firstBand; band <= lastBand; ++band)
+                     {
+                        T* pValue = (isBip ? pPixel + band : pPixel);
+                        double value = 0.0;
+                        if (*isValid && sample(cache, mInput.mBands[band], *location, mInput.mInterpolation,
+                           mInput.mSourceBounds, value))
+                        {
+                           *pValue = toEncoding<T>(value, mInput.mRoundValues);
+                        }
+                        else
+                        {
+                           *isValid = 0;
+                           *pValue = badValue;
+                        }
+                     }
+                     accessor->nextColumn();
+                  }
+                  accessor->nextRow();
+               }
+
+               if (cache.hasFailed())
+               {
+                  getReporter().reportError("Unable to read the warp source.");
+                  return;
+               }
+            }
+            mBadPixelCount += std::count(valid.begin(), valid.end(), 0);
+         }
+      }
+
+      const WarpThreadInput& mInput;
+      mta::AlgorithmThread::Range mTileRange;
+      uint64_t mBadPixelCount;
+   };
+
+   struct WarpThreadOutput
+   {
+      WarpThreadOutput() :
+         mBadPixelCount(0)
+      {}
+
+      bool compileOverallResults(const std::vector<WarpThread*>& threads)
+      {
+         mBadPixelCount = 0;
+         for (std::vector<WarpThread*>::const_iterator thread = threads.begin(); thread != threads.end(); ++thread)
+         {
+            mBadPixelCount += (*thread)->getBadPixelCount();
+         }
+         return true;
+      }
+
+      uint64_t mBadPixelCount;
+   };
+}
+
+PolynomialWarpMapping::PolynomialWarpMapping(const std::vector<double>& kx, const std::vector<double>& ky,
+                                             double columnOffset, double rowOffset) :
+   mKx(kx),
+   mKy(ky),
+   mDegree(static_cast<unsigned int>(floor(sqrt(static_cast<double>(kx.size())) + 0.5)) - 1),
+   mColumnOffset(columnOffset),
+   mRowOffset(rowOffset)
+{}
+
+PolynomialWarpMapping::~PolynomialWarpMapping()
+{}
+
+double PolynomialWarpMapping::evaluate(const std::vector<double>& coefficients, double x, double y) const
+{
+   // Horner's method in both dimensions
+   double result = 0.0;
+   for (int i = static_cast<int>(mDegree); i >= 0; --i)
+   {
+      double term = 0.0;
+      for (int j = static_cast<int>(mDegree); j >= 0; --j)
+      {
+         term = term * y + coefficients[i * (mDegree + 1) + j];
+      }
+      result = result * x + term;
+   }
+   return result;
+}
+
+bool PolynomialWarpMapping::map(const std::vector<LocationType>& outputPixels,
+                                std::vector<LocationType>& sourcePixels) const
+{
+   if (mKx.empty() || mKx.size() != mKy.size() || (mDegree + 1) * (mDegree + 1) != mKx.size())
+   {
+      return false;
+   }
+   sourcePixels.resize(outputPixels.size());
+   for (std::vector<LocationType>::size_type i = 0; i < outputPixels.size(); ++i)
+   {
+      double x = outputPixels[i].mX + mColumnOffset;
+      double y = outputPixels[i].mY + mRowOffset;
+      sourcePixels[i] = LocationType(evaluate(mKx, x, y), evaluate(mKy, x, y));
+   }
+   return true;
+}
+
+GeoreferenceWarpMapping::GeoreferenceWarpMapping(const RasterElement* pOutputGeometry, const RasterElement* pSource,
+                                                 double columnOffset, double rowOffset) :
+   mpOutputGeometry(pOutputGeometry),
+   mpSource(pSource),
+   mColumnOffset(columnOffset),
+   mRowOffset(rowOffset)
+{}
+
+GeoreferenceWarpMapping::~GeoreferenceWarpMapping()
+{}
+
+bool GeoreferenceWarpMapping::map(const std::vector<LocationType>& outputPixels,
+                                  std::vector<LocationType>& sourcePixels) const
+{
+   if (mpOutputGeometry == NULL || mpSource == NULL ||
+      !mpOutputGeometry->isGeoreferenced() || !mpSource->isGeoreferenced())
+   {
+      return false;
+   }
+
+   // Georeference pixel coordinates place the center of a pixel at 0.5
+   std::vector<LocationType> pixels;
+   pixels.reserve(outputPixels.size());
+   for (std::vector<LocationType>::const_iterator pixel = outputPixels.begin(); pixel != outputPixels.end(); ++pixel)
+   {
+      pixels.push_back(LocationType(pixel->mX + mColumnOffset + 0.5, pixel->mY + mRowOffset + 0.5));
+   }
+   sourcePixels = mpSource->convertGeocoordsToPixels(mpOutputGeometry->convertPixelsToGeocoords(pixels));
+   for (std::vector<LocationType>::iterator pixel = sourcePixels.begin(); pixel != sourcePixels.end(); ++pixel)
+   {
+      pixel->mX -= 0.5;
+      pixel->mY -= 0.5;
+   }
+   return sourcePixels.size() == outputPixels.size();
+}
+
+RasterWarper::RasterWarper(const RasterElement* pSource, const WarpMapping& mapping) :
+   mpSource(pSource),
+   mMapping(mapping),
+   mInterpolation(RasterUtilities::BILINEAR),
+   mBadValue(0.0),
+   mSourceBounds(PIXEL_AREA),
+   mRoundValues(true),
+   mGridSpacing(64),
+   mMaxGridError(0.1),
+   mTileSize(256),
+   mBadPixelCount(0)
+{}
+
+RasterWarper::~RasterWarper()
+{}
+
+void RasterWarper::setInterpolation(RasterUtilities::InterpolationType interp)
+{
+   mInterpolation = interp;
+}
+
+void RasterWarper::setBands(const std::vector<unsigned int>& bands)
+{
+   mBands = bands;
+}
+
+void RasterWarper::setBadValue(double value)
+{
+   mBadValue = value;
+}
+
+void RasterWarper::setSourceBounds(SourceBoundsType bounds)
+{
+   mSourceBounds = bounds;
+}
+
+void RasterWarper::setRoundValues(bool round)
+{
+   mRoundValues = round;
+}
+
+void RasterWarper::setGridSpacing(unsigned int spacing)
+{
+   mGridSpacing = std::max(spacing, 1U);
+}
+
+void RasterWarper::setMaximumGridError(double error)
+{
+   mMaxGridError = error;
+}
+
+void RasterWarper::setTileSize(unsigned int tileSize)
+{
+   mTileSize = std::max(tileSize, 1U);
+}
+
+uint64_t RasterWarper::getBadPixelCount() const
+{
+   return mBadPixelCount;
+}
+
+const std::string& RasterWarper::getErrorText() const
+{
+   return mErrorText;
+}
+
+bool RasterWarper::warp(RasterElement* pDestination, mta::ProgressReporter* pReporter, const bool* pAbort)
+{
+   mErrorText.clear();
+   mBadPixelCount = 0;
+   if (mpSource == NULL || pDestination == NULL)
+   {
+      mErrorText = "Invalid warp source or destination.";
+      return false;
+   }
+   const RasterDataDescriptor* pSrcDesc = static_cast<const RasterDataDescriptor*>(mpSource->getDataDescriptor());
+   const RasterDataDescriptor* pDstDesc =
+      static_cast<const RasterDataDescriptor*>(pDestination->getDataDescriptor());
+   VERIFY(pSrcDesc != NULL && pDstDesc != NULL);
+
+   WarpThreadInput input;
+   input.mBands = mBands;
+   if (input.mBands.empty())
+   {
+      for (unsigned int band = 0; band < pSrcDesc->getBandCount(); ++band)
+      {
+         input.mBands.push_back(band);
+      }
+   }
+   for (std::vector<unsigned int>::const_iterator band = input.mBands.begin(); band != input.mBands.end(); ++band)
+   {
+      if (*band >= pSrcDesc->getBandCount())
+      {
+         mErrorText = "Invalid warp source band.";
+         return false;
+      }
+   }
+   if (pSrcDesc->getDataType() != pDstDesc->getDataType() || pDstDesc->getBandCount() != input.mBands.size())
+   {
+      mErrorText = "The warp destination is not compatible with the source.";
+      return false;
+   }
+   if (pDstDesc->getDataType() == INT4SCOMPLEX || pDstDesc->getDataType() == FLT8COMPLEX)
+   {
+      mErrorText = "Complex data can not be warped.";
+      return false;
+   }
+   if (pDstDesc->getInterleaveFormat() == BIL)
+   {
+      mErrorText = "The warp destination must be BSQ or BIP.";
+      return false;
+   }
+   unsigned int rows = pDstDesc->getRowCount();
+   unsigned int columns = pDstDesc->getColumnCount();
+   if (rows == 0 || columns == 0 || pSrcDesc->getRowCount() == 0 || pSrcDesc->getColumnCount() == 0)
+   {
+      mErrorText = "Unable to warp an empty data set.";
+      return false;
+   }
+
+   WarpGrid grid;
+   if (!buildGrid(mMapping, rows, columns, mGridSpacing, mMaxGridError, grid, mErrorText))
+   {
+      return false;
+   }
+
+   input.mpSource = mpSource;
+   input.mpDestination = pDestination;
+   input.mpGrid = &grid;
+   input.mInterpolation = mInterpolation;
+   input.mBadValue = mBadValue;
+   input.mSourceBounds = mSourceBounds;
+   input.mRoundValues = mRoundValues;
+   input.mTileSize = mTileSize;
+   input.mTileColumns = (columns + mTileSize - 1) / mTileSize;
+   input.mTileCount = input.mTileColumns * ((rows + mTileSize - 1) / mTileSize);
+   input.mpAbortFlag = pAbort;
+
+   WarpThreadOutput output;
+   mta::MultiThreadedAlgorithm<WarpThreadInput, WarpThreadOutput, WarpThread>
+      alg(mta::getNumRequiredThreads(input.mTileCount), input, output, pReporter);
+   if (alg.run() != mta::SUCCESS)
+   {
+      mErrorText = alg.getErrorText();
+      if (mErrorText.empty())
+      {
+         mErrorText = "Unable to warp the data set.";
+      }
+      return false;
+   }
+   if (pAbort != NULL && *pAbort)
+   {
+      mErrorText = "The warp was aborted.";
+      return false;
+   }
+
+   mBadPixelCount = output.mBadPixelCount;
+   return true;
+}
@@ -12,6 +12,7 @@
 #include "DesktopServices.h"
 #include "PlugInRegistration.h"
 #include "SessionExplorer.h"
+#include "Tracer.h"
 #include "UtilityServices.h"
 #include <stdexcept>
 
@@ -68,6 +69,14 @@ PlugInManagerServices* Service<PlugInManagerServices>::get() const
    return pT;
 }
 
+template<>
+Tracer* Service<Tracer>::get() const
+{
+   Tracer* pT = NULL;
+   ModuleManager::instance()->getService()->queryInterface("Tracer1", reinterpret_cast<void**>(&pT));
+   return pT;
+}
+
 template <>
 SessionManager* Service<SessionManager>::get() const
 {
@@ -0,0 +1,824 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "MultiThreadedAlgorithm.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "SignatureLibrary.h"
+#include "SpectralLibraryMatcher.h"
+#include "switchOnEncoding.h"
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPECTRAL_MATCHER_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+   // The number of pixels read from a raster element at a time
+   const unsigned int sPixelBlockSize = 4096;
+
+   // The maximum number of signatures used to estimate the principal components
+   const unsigned int sMaxPruningSamples = 2048;
+
+   // The number of subspace iterations used to find the principal components
+   const unsigned int sPruningIterations = 30;
+
+   // The number of signatures with the smallest bounds, per match, compared before any are skipped
+   const size_t sPruningSeedFactor = 4;
+
+   // Allows for the rounding of the single precision kernels when comparing against the pruning bounds
+   const double sPruningTolerance = 1e-5;
+
+#if defined(SPECTRAL_MATCHER_SSE)
+   inline float horizontalSum(__m128 value)
+   {
+      float values[4];
+      _mm_storeu_ps(values, value);
+      return (values[0] + values[1]) + (values[2] + values[3]);
+   }
+#endif
+
+   // Both kernels require count to be a multiple of four
+   inline double dotProduct(const float* pA, const float* pB, unsigned int count)
+   {
+#if defined(SPECTRAL_MATCHER_SSE)
+      __m128 sum = _mm_setzero_ps();
+      for (unsigned int i = 0; i < count; i += 4)
+      {
+         sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(pA + i), _mm_loadu_ps(pB + i)));
+      }
+      return horizontalSum(sum);
+#else
+      float sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+      for (unsigned int i = 0; i < count; i += 4)
+      {
+         sums[0] += pA[i] * pB[i];
+         sums[1] += pA[i + 1] * pB[i + 1];
+         sums[2] += pA[i + 2] * pB[i + 2];
+         sums[3] += pA[i + 3] * pB[i + 3];
+      }
+      return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#endif
+   }
+
+   inline double squaredDistance(const float* pA, const float* pB, unsigned int count)
+   {
+#if defined(SPECTRAL_MATCHER_SSE)
+      __m128 sum = _mm_setzero_ps();
+      for (unsigned int i = 0; i < count; i += 4)
+      {
+         __m128 difference = _mm_sub_ps(_mm_loadu_ps(pA + i), _mm_loadu_ps(pB + i));
+         sum = _mm_add_ps(sum, _mm_mul_ps(difference, difference));
+      }
+      return horizontalSum(sum);
+#else
+      float sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+      for (unsigned int i = 0; i < count; i += 4)
+      {
+         for (unsigned int j = 0; j < 4; ++j)
+         {
+            float difference = pA[i + j] - pB[i + j];
+            sums[j] += difference * difference;
+         }
+      }
+      return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#endif
+   }
+
+   template<typename T>
+   void copySpectrum(const T* pSource, unsigned int count, double* pDest)
+   {
+      for (unsigned int i = 0; i < count; ++i)
+      {
+         pDest[i] = static_cast<double>(pSource[i]);
+      }
+   }
+
+   bool compareMatches(const SpectralLibraryMatcher::Match& lhs, const SpectralLibraryMatcher::Match& rhs)
+   {
+      return lhs.mSignature < rhs.mSignature;
+   }
+}
+
+struct SpectralLibraryMatchInput
+{
+   const SpectralLibraryMatcher* mpMatcher;
+   const double* mpSpectra;
+   unsigned int mNumSpectra;
+   SpectralLibraryMatcher::MetricType mMetric;
+   unsigned int mCount;
+   std::vector<std::vector<SpectralLibraryMatcher::Match> >* mpMatches;
+};
+
+class SpectralLibraryMatchThread : public mta::AlgorithmThread
+{
+public:
+   SpectralLibraryMatchThread(const SpectralLibraryMatchInput& input, int threadCount, int threadIndex,
+      mta::ThreadReporter& reporter) :
+      mta::AlgorithmThread(threadIndex, reporter),
+      mInput(input),
+      mRange(getThreadRange(threadCount, input.mNumSpectra))
+   {}
+
+   void run()
+   {
+      std::vector<float> buffer;
+      unsigned int numBands = mInput.mpMatcher->getNumBands();
+      for (int i = mRange.mFirst; i <= mRange.mLast; ++i)
+      {
+         mInput.mpMatcher->matchSpectrum(mInput.mpSpectra + static_cast<size_t>(i) * numBands, mInput.mMetric,
+            mInput.mCount, (*mInput.mpMatches)[i], buffer);
+      }
+   }
+
+private:
+   SpectralLibraryMatchThread& operator=(const SpectralLibraryMatchThread& rhs);
+
+   const SpectralLibraryMatchInput& mInput;
+   mta::AlgorithmThread::Range mRange;
+};
+
+struct SpectralLibraryMatchOutput
+{
+   bool compileOverallResults(const std::vector<SpectralLibraryMatchThread*>& threads)
+   {
+      return true;
+   }
+};
+
+SpectralLibraryMatcher::SpectralLibraryMatcher() :
+   mNumSignatures(0),
+   mNumBands(0),
+   mStride(0),
+   mPruningComponents(0)
+{}
+
+SpectralLibraryMatcher::~SpectralLibraryMatcher()
+{}
+
+bool SpectralLibraryMatcher::setLibrary(const SignatureLibrary* pLibrary)
+{
+   mErrorText.clear();
+   setSignatures(NULL, 0, 0);
+   if (pLibrary == NULL)
+   {
+      mErrorText = "Invalid signature library.";
+      return false;
+   }
+
+   unsigned int numSignatures = pLibrary->getNumSignatures();
+   unsigned int numBands = static_cast<unsigned int>(pLibrary->getAbscissa().size());
+   std::vector<double> ordinates(static_cast<size_t>(numSignatures) * numBands);
+   for (unsigned int i = 0; i < numSignatures; ++i)
+   {
+      // The original ordinates are returned in a shared buffer so each signature is copied before the next is read
+      const double* pOrdinates = pLibrary->getOrdinateData(i);
+      if (pOrdinates == NULL)
+      {
+         mErrorText = "Unable to read the ordinates of signature " + pLibrary->getSignatureName(i) + ".";
+         return false;
+      }
+
+      std::copy(pOrdinates, pOrdinates + numBands, ordinates.begin() + static_cast<size_t>(i) * numBands);
+   }
+
+   setSignatures(ordinates.empty() ? NULL : &ordinates[0], numSignatures, numBands);
+   return true;
+}
+
+void SpectralLibraryMatcher::setSignatures(const double* pOrdinates, unsigned int numSignatures,
+                                           unsigned int numBands)
+{
+   if (pOrdinates == NULL)
+   {
+      numSignatures = 0;
+      numBands = 0;
+   }
+
+   mNumSignatures = numSignatures;
+   mNumBands = numBands;
+   mStride = (numBands + 3) / 4 * 4;
+   mOrdinates.assign(static_cast<size_t>(mNumSignatures) * mStride, 0.0f);
+   mSquaredNorms.assign(mNumSignatures, 0.0);
+   mSums.assign(mNumSignatures, 0.0);
+   for (unsigned int i = 0; i < mNumSignatures; ++i)
+   {
+      const double* pSource = pOrdinates + static_cast<size_t>(i) * mNumBands;
+      float* pDest = &mOrdinates[static_cast<size_t>(i) * mStride];
+      for (unsigned int band = 0; band < mNumBands; ++band)
+      {
+         // The norms and sums are computed from the rounded values so they match the kernels
+         pDest[band] = static_cast<float>(pSource[band]);
+         mSquaredNorms[i] += static_cast<double>(pDest[band]) * pDest[band];
+         mSums[i] += pDest[band];
+      }
+   }
+
+   for (unsigned int metric = 0; metric < 3; ++metric)
+   {
+      mPruning[metric] = Pruning();
+   }
+}
+
+unsigned int SpectralLibraryMatcher::getNumSignatures() const
+{
+   return mNumSignatures;
+}
+
+unsigned int SpectralLibraryMatcher::getNumBands() const
+{
+   return mNumBands;
+}
+
+void SpectralLibraryMatcher::setPruningComponents(unsigned int components)
+{
+   if (components != mPruningComponents)
+   {
+      mPruningComponents = components;
+      for (unsigned int metric = 0; metric < 3; ++metric)
+      {
+         mPruning[metric] = Pruning();
+      }
+   }
+}
+
+unsigned int SpectralLibraryMatcher::getPruningComponents() const
+{
+   return mPruningComponents;
+}
+
+bool SpectralLibraryMatcher::match(const double* pSpectrum, MetricType metric, unsigned int count,
+                                   std::vector<Match>& matches)
+{
+   matches.clear();
+   mErrorText.clear();
+   if (pSpectrum == NULL || mNumSignatures == 0)
+   {
+      mErrorText = "There is no spectrum or no signatures to match.";
+      return false;
+   }
+
+   preparePruning(metric);
+
+   std::vector<float> buffer;
+   matchSpectrum(pSpectrum, metric, count, matches, buffer);
+   return true;
+}
+
+bool SpectralLibraryMatcher::match(const double* pSpectra, unsigned int numSpectra, MetricType metric,
+                                   unsigned int count, std::vector<std::vector<Match> >& matches)
+{
+   matches.clear();
+   mErrorText.clear();
+   if (pSpectra == NULL || mNumSignatures == 0)
+   {
+      mErrorText = "There are no spectra or no signatures to match.";
+      return false;
+   }
+
+   // The pruning data is shared by the threads so it is built before they start
+   preparePruning(metric);
+
+   matches.resize(numSpectra);
+
+   SpectralLibraryMatchInput input;
+   input.mpMatcher = this;
+   input.mpSpectra = pSpectra;
+   input.mNumSpectra = numSpectra;
+   input.mMetric = metric;
+   input.mCount = count;
+   input.mpMatches = &matches;
+
+   SpectralLibraryMatchOutput output;
+   mta::MultiThreadedAlgorithm<SpectralLibraryMatchInput, SpectralLibraryMatchOutput, SpectralLibraryMatchThread>
+      alg(mta::getNumRequiredThreads(numSpectra), input, output, NULL);
+   if (alg.run() != mta::SUCCESS)
+   {
+      mErrorText = alg.getErrorText();
+      return false;
+   }
+
+   return true;
+}
+
+bool SpectralLibraryMatcher::match(const RasterElement* pRaster, const std::vector<Opticks::PixelLocation>& pixels,
+                                   MetricType metric, unsigned int count, std::vector<std::vector<Match> >& matches,
+                                   const bool* pAbort)
+{
+   matches.clear();
+   mErrorText.clear();
+   if (pRaster == NULL)
+   {
+      mErrorText = "Invalid raster element.";
+      return false;
+   }
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+   if (pDescriptor->getBandCount() != mNumBands)
+   {
+      mErrorText = "The number of bands in the raster element does not match the signatures.";
+      return false;
+   }
+
+   EncodingType encoding = pDescriptor->getDataType();
+   if (encoding == INT4SCOMPLEX || encoding == FLT8COMPLEX)
+   {
+      mErrorText = "Complex data can not be matched.";
+      return false;
+   }
+
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setInterleaveFormat(BIP);
+   DataAccessor accessor = pRaster->getDataAccessor(pRequest.release());
+   if (accessor.isValid() == false)
+   {
+      mErrorText = "Unable to access the raster element.";
+      return false;
+   }
+
+   matches.reserve(pixels.size());
+
+   std::vector<double> spectra;
+   std::vector<std::vector<Match> > blockMatches;
+   for (size_t first = 0; first < pixels.size(); first += sPixelBlockSize)
+   {
+      if (pAbort != NULL && *pAbort)
+      {
+         mErrorText = "Matching was aborted.";
+         matches.clear();
+         return false;
+      }
+
+      unsigned int blockSize = static_cast<unsigned int>(std::min<size_t>(sPixelBlockSize, pixels.size() - first));
+      spectra.resize(static_cast<size_t>(blockSize) * mNumBands);
+      for (unsigned int i = 0; i < blockSize; ++i)
+      {
+         const Opticks::PixelLocation& pixel = pixels[first + i];
+         if (pixel.mY < 0 || pixel.mX < 0 || static_cast<unsigned int>(pixel.mY) >= pDescriptor->getRowCount() ||
+            static_cast<unsigned int>(pixel.mX) >= pDescriptor->getColumnCount())
+         {
+            mErrorText = "A pixel is outside of the raster element.";
+            matches.clear();
+            return false;
+         }
+
+         accessor->toPixel(pixel.mY, pixel.mX);
+         VERIFY(accessor.isValid());
+         switchOnEncoding(encoding, copySpectrum, accessor->getColumn(), mNumBands,
+            &spectra[static_cast<size_t>(i) * mNumBands]);
+      }
+
+      if (match(&spectra[0], blockSize, metric, count, blockMatches) == false)
+      {
+         matches.clear();
+         return false;
+      }
+
+      matches.insert(matches.end(), blockMatches.begin(), blockMatches.end());
+   }
+
+   return true;
+}
+
+const std::string& SpectralLibraryMatcher::getErrorText() const
+{
+   return mErrorText;
+}
+
+void SpectralLibraryMatcher::preparePruning(MetricType metric)
+{
+   Pruning& pruning = mPruning[metric];
+   if (pruning.mBuilt || mPruningComponents == 0 || mPruningComponents >= mNumBands)
+   {
+      return;
+   }
+
+   pruning.mBuilt = true;
+
+   // Normalize the signatures the same way as the spectra, marking the signatures which can never match
+   std::vector<double> normalized(static_cast<size_t>(mNumSignatures) * mNumBands);
+   std::vector<unsigned char> valid(mNumSignatures, 0);
+   std::vector<double> signature(mNumBands);
+   for (unsigned int i = 0; i < mNumSignatures; ++i)
+   {
+      const float* pOrdinates = &mOrdinates[static_cast<size_t>(i) * mStride];
+      std::copy(pOrdinates, pOrdinates + mNumBands, signature.begin());
+
+      std::vector<double> values;
+      if (normalize(&signature[0], metric, values))
+      {
+         valid[i] = 1;
+         std::copy(values.begin(), values.end(), normalized.begin() + static_cast<size_t>(i) * mNumBands);
+      }
+   }
+
+   // Estimate the mean and covariance from an evenly spaced subset of the signatures. The bounds are
+   // valid for any orthonormal basis, so the estimate only affects how much of the library is pruned.
+   std::vector<unsigned int> samples;
+   for (unsigned int i = 0; i < mNumSignatures; ++i)
+   {
+      if (valid[i])
+      {
+         samples.push_back(i);
+      }
+   }
+
+   if (samples.empty())
+   {
+      return;
+   }
+
+   if (samples.size() > sMaxPruningSamples)
+   {
+      std::vector<unsigned int> subset;
+      for (unsigned int i = 0; i < sMaxPruningSamples; ++i)
+      {
+         subset.push_back(samples[static_cast<size_t>(i) * samples.size() / sMaxPruningSamples]);
+      }
+      samples.swap(subset);
+   }
+
+   pruning.mMean.assign(mNumBands, 0.0);
+   for (std::vector<unsigned int>::const_iterator sample = samples.begin(); sample != samples.end(); ++sample)
+   {
+      const double* pValues = &normalized[static_cast<size_t>(*sample) * mNumBands];
+      for (unsigned int band = 0; band < mNumBands; ++band)
+      {
+         pruning.mMean[band] += pValues[band] / samples.size();
+      }
+   }
+
+   std::vector<double> covariance(static_cast<size_t>(mNumBands) * mNumBands, 0.0);
+   std::vector<double> centered(mNumBands);
+   for (std::vector<unsigned int>::const_iterator sample = samples.begin(); sample != samples.end(); ++sample)
+   {
+      const double* pValues = &normalized[static_cast<size_t>(*sample) * mNumBands];
+      for (unsigned int band = 0; band < mNumBands; ++band)
+      {
+         centered[band] = pValues[band] - pruning.mMean[band];
+      }
+
+      for (unsigned int row = 0; row < mNumBands; ++row)
+      {
+         double* pRow = &covariance[static_cast<size_t>(row) * mNumBands];
+         for (unsigned int column = row; column < mNumBands; ++column)
+         {
+            pRow[column] += centered[row] * centered[column];
+         }
+      }
+   }
+
+   for (unsigned int row = 0; row < mNumBands; ++row)
+   {
+      for (unsigned int column = 0; column < row; ++column)
+      {
+         covariance[static_cast<size_t>(row) * mNumBands + column] =
+            covariance[static_cast<size_t>(column) * mNumBands + row];
+      }
+   }
+
+   // Find the leading eigenvectors with orthogonal subspace iteration
+   unsigned int numComponents = mPruningComponents;
+   std::vector<double> basis(static_cast<size_t>(numComponents) * mNumBands, 0.0);
+   for (unsigned int component = 0; component < numComponents; ++component)
+   {
+      for (unsigned int band = 0; band < mNumBands; ++band)
+      {
+         basis[static_cast<size_t>(component) * mNumBands + band] =
+            static_cast<double>((band * 7919 + component * 104729) % 1009) / 1009.0 - 0.5;
+      }
+   }
+
+   std::vector<double> product(basis.size());
+   for (unsigned int iteration = 0; iteration <= sPruningIterations; ++iteration)
+   {
+      if (iteration > 0)
+      {
+         for (unsigned int component = 0; component < numComponents; ++component)
+         {
+            const double* pVector = &basis[static_cast<size_t>(component) * mNumBands];
+            double* pProduct = &product[static_cast<size_t>(component) * mNumBands];
+            for (unsigned int row = 0; row < mNumBands; ++row)
+            {
+               const double* pRow = &covariance[static_cast<size_t>(row) * mNumBands];
+               double value = 0.0;
+               for (unsigned int column = 0; column < mNumBands; ++column)
+               {
+                  value += pRow[column] * pVector[column];
+               }
+               pProduct[row] = value;
+            }
+         }
+         basis.swap(product);
+      }
+
+      // Gram-Schmidt twice so the basis stays orthonormal to working precision, dropping degenerate vectors
+      unsigned int orthonormalCount = 0;
+      for (unsigned int component = 0; component < numComponents; ++component)
+      {
+         double* pVector = &basis[static_cast<size_t>(component) * mNumBands];
+         for (unsigned int pass = 0; pass < 2; ++pass)
+         {
+            for (unsigned int previous = 0; previous < orthonormalCount; ++previous)
+            {
+               const double* pPrevious = &basis[static_cast<size_t>(previous) * mNumBands];
+               double projection = 0.0;
+               for (unsigned int band = 0; band < mNumBands; ++band)
+               {
+                  projection += pVector[band] * pPrevious[band];
+               }
+               for (unsigned int band = 0; band < mNumBands; ++band)
+               {
+                  pVector[band] -= projection * pPrevious[band];
+               }
+            }
+         }
+
+         double norm = 0.0;
+         for (unsigned int band = 0; band < mNumBands; ++band)
+         {
+            norm += pVector[band] * pVector[band];
+         }
+         norm = sqrt(norm);
+         if (norm <= 1e-12)
+         {
+            continue;
+         }
+
+         double* pDest = &basis[static_cast<size_t>(orthonormalCount) * mNumBands];
+         for (unsigned int band = 0; band < mNumBands; ++band)
+         {
+            pDest[band] = pVector[band] / norm;
+         }
+         ++orthonormalCount;
+      }
+
+      numComponents = orthonormalCount;
+      basis.resize(static_cast<size_t>(numComponents) * mNumBands);
+      product.resize(basis.size());
+      if (numComponents == 0)
+      {
+         return;
+      }
+   }
+
+   pruning.mComponents = basis;
+
+   // Project every signature, using NaN for the signatures which can never match
+   const double invalid = std::numeric_limits<double>::quiet_NaN();
+   pruning.mProjections.assign(static_cast<size_t>(mNumSignatures) * numComponents, invalid);
+   for (unsigned int i = 0; i < mNumSignatures; ++i)
+   {
+      if (valid[i] == 0)
+      {
+         continue;
+      }
+
+      const double* pValues = &normalized[static_cast<size_t>(i) * mNumBands];
+      for (unsigned int component = 0; component < numComponents; ++component)
+      {
+         const double* pVector = &basis[static_cast<size_t>(component) * mNumBands];
+         double projection = 0.0;
+         for (unsigned int band = 0; band < mNumBands; ++band)
+         {
+            projection += (pValues[band] - pruning.mMean[band]) * pVector[band];
+         }
+         pruning.mProjections[static_cast<size_t>(i) * numComponents + component] = projection;
+      }
+   }
+}
+
+bool SpectralLibraryMatcher::normalize(const double* pSpectrum, MetricType metric,
+                                       std::vector<double>& normalized) const
+{
+   normalized.assign(pSpectrum, pSpectrum + mNumBands);
+   if (metric == EUCLIDEAN)
+   {
+      return true;
+   }
+
+   if (metric == CORRELATION && mNumBands > 0)
+   {
+      double mean = 0.0;
+      for (unsigned int band = 0; band < mNumBands; ++band)
+      {
+         mean += normalized[band];
+      }
+      mean /= mNumBands;
+
+      for (unsigned int band = 0; band < mNumBands; ++band)
+      {
+         normalized[band] -= mean;
+      }
+   }
+
+   double norm = 0.0;
+   for (unsigned int band = 0; band < mNumBands; ++band)
+   {
+      norm += normalized[band] * normalized[band];
+   }
+
+   norm = sqrt(norm);
+   if (norm <= 0.0 || norm != norm)
+   {
+      return false;
+   }
+
+   for (unsigned int band = 0; band < mNumBands; ++band)
+   {
+      normalized[band] /= norm;
+   }
+
+   return true;
+}
+
+void SpectralLibraryMatcher::matchSpectrum(const double* pSpectrum, MetricType metric, unsigned int count,
+                                           std::vector<Match>& matches, std::vector<float>& buffer) const
+{
+   matches.clear();
+   if (count == 0 || mNumSignatures == 0)
+   {
+      return;
+   }
+
+   buffer.assign(mStride, 0.0f);
+   double squaredNorm = 0.0;
+   double sum = 0.0;
+   for (unsigned int band = 0; band < mNumBands; ++band)
+   {
+      buffer[band] = static_cast<float>(pSpectrum[band]);
+      squaredNorm += static_cast<double>(buffer[band]) * buffer[band];
+      sum += buffer[band];
+   }
+
+   const double numBands = static_cast<double>(mNumBands);
+   const double variance = squaredNorm - sum * sum / numBands;
+   if ((metric == SPECTRAL_ANGLE && squaredNorm <= 0.0) || (metric == CORRELATION && variance <= 0.0) ||
+      squaredNorm != squaredNorm)
+   {
+      return;
+   }
+
+   // Every metric is ranked by the squared Euclidean distance between the normalized spectra. The
+   // results are kept in a max heap so the worst of the best matches is always at the front.
+   std::vector<std::pair<double, unsigned int> > best;
+   best.reserve(count + 1);
+
+   const Pruning& pruning = mPruning[metric];
+   const unsigned int numComponents =
+      (pruning.mComponents.empty() ? 0 : static_cast<unsigned int>(pruning.mComponents.size() / mNumBands));
+   std::vector<std::pair<double, unsigned int> > order;
+   std::vector<double> normalized;
+   double normalizedSquaredNorm = 1.0;
+   const bool prune = (numComponents > 0 && count < mNumSignatures);
+   if (prune)
+   {
+      if (normalize(pSpectrum, metric, normalized) == false)
+      {
+         return;
+      }
+
+      if (metric == EUCLIDEAN)
+      {
+         normalizedSquaredNorm = squaredNorm;
+      }
+
+      std::vector<double> projection(numComponents, 0.0);
+      for (unsigned int component = 0; component < numComponents; ++component)
+      {
+         const double* pVector = &pruning.mComponents[static_cast<size_t>(component) * mNumBands];
+         for (unsigned int band = 0; band < mNumBands; ++band)
+         {
+            projection[component] += (normalized[band] - pruning.mMean[band]) * pVector[band];
+         }
+      }
+
+      order.reserve(mNumSignatures);
+      for (unsigned int i = 0; i < mNumSignatures; ++i)
+      {
+         const double* pProjection = &pruning.mProjections[static_cast<size_t>(i) * numComponents];
+         double bound = 0.0;
+         for (unsigned int component = 0; component < numComponents; ++component)
+         {
+            double difference = projection[component] - pProjection[component];
+            bound += difference * difference;
+         }
+
+         if (bound == bound)
+         {
+            order.push_back(std::make_pair(bound, i));
+         }
+      }
+
+      // Compare the signatures with the smallest bounds first so the remaining signatures can be skipped.
+      // Partitioning is cheaper than sorting and the skipped signatures do not need to be visited in order.
+      size_t seedCount = std::min(order.size(), static_cast<size_t>(count) * sPruningSeedFactor);
+      std::nth_element(order.begin(), order.begin() + seedCount, order.end());
+   }
+
+   const unsigned int numCandidates = (prune ? static_cast<unsigned int>(order.size()) : mNumSignatures);
+   for (unsigned int candidate = 0; candidate < numCandidates; ++candidate)
+   {
+      unsigned int i = candidate;
+      if (prune)
+      {
+         const double worst = best.empty() ? 0.0 : best.front().first;
+         if (best.size() == count &&
+            order[candidate].first > worst + sPruningTolerance * (worst + normalizedSquaredNorm))
+         {
+            continue;
+         }
+
+         i = order[candidate].second;
+      }
+
+      const float* pSignature = &mOrdinates[static_cast<size_t>(i) * mStride];
+      double distance = 0.0;
+      if (metric == EUCLIDEAN)
+      {
+         distance = squaredDistance(&buffer[0], pSignature, mStride);
+      }
+      else
+      {
+         double dot = dotProduct(&buffer[0], pSignature, mStride);
+         double cosine = 0.0;
+         if (metric == SPECTRAL_ANGLE)
+         {
+            if (mSquaredNorms[i] <= 0.0)
+            {
+               continue;
+            }
+
+            cosine = dot / sqrt(squaredNorm * mSquaredNorms[i]);
+         }
+         else
+         {
+            double signatureVariance = mSquaredNorms[i] - mSums[i] * mSums[i] / numBands;
+            if (signatureVariance <= 0.0)
+            {
+               continue;
+            }
+
+            cosine = (dot - sum * mSums[i] / numBands) / sqrt(variance * signatureVariance);
+         }
+
+         distance = 2.0 - 2.0 * std::max(-1.0, std::min(1.0, cosine));
+      }
+
+      if (distance != distance)
+      {
+         continue;
+      }
+
+      if (best.size() < count)
+      {
+         best.push_back(std::make_pair(distance, i));
+         std::push_heap(best.begin(), best.end());
+      }
+      else if (std::make_pair(distance, i) < best.front())
+      {
+         std::pop_heap(best.begin(), best.end());
+         best.back() = std::make_pair(distance, i);
+         std::push_heap(best.begin(), best.end());
+      }
+   }
+
+   std::sort_heap(best.begin(), best.end());
+
+   matches.reserve(best.size());
+   for (std::vector<std::pair<double, unsigned int> >::const_iterator iter = best.begin(); iter != best.end(); ++iter)
+   {
+      Match match;
+      match.mSignature = iter->second;
+      switch (metric)
+      {
+      case SPECTRAL_ANGLE:
+         match.mScore = acos(std::max(-1.0, std::min(1.0, 1.0 - iter->first / 2.0)));
+         break;
+      case EUCLIDEAN:
+         match.mScore = sqrt(std::max(0.0, iter->first));
+         break;
+      default:
+         match.mScore = 1.0 - iter->first / 2.0;
+         break;
+      }
+      matches.push_back(match);
+   }
+}
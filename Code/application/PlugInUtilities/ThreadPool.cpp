@@ -0,0 +1,317 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "ConfigurationSettings.h"
+#include "MultiThreadedAlgorithm.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+#if defined(WIN_API)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedExchange, _InterlockedExchangeAdd)
+#endif
+
+using namespace mta;
+
+namespace
+{
+   pthread_once_t sPoolOnce = PTHREAD_ONCE_INIT;
+   ThreadPool* spPool = NULL;
+}
+
+//------------ AtomicCounter ---------------//
+
+AtomicCounter::AtomicCounter(int value) :
+   mValue(value)
+{}
+
+AtomicCounter::AtomicCounter(const AtomicCounter& rhs) :
+   mValue(rhs.get())
+{}
+
+AtomicCounter& AtomicCounter::operator=(const AtomicCounter& rhs)
+{
+   if (this != &rhs)
+   {
+      set(rhs.get());
+   }
+
+   return *this;
+}
+
+int AtomicCounter::get() const
+{
+#if defined(WIN_API)
+   return static_cast<int>(_InterlockedExchangeAdd(&mValue, 0));
+#else
+   return static_cast<int>(__sync_add_and_fetch(&mValue, 0));
+#endif
+}
+
+void AtomicCounter::set(int value)
+{
+#if defined(WIN_API)
+   _InterlockedExchange(&mValue, value);
+#else
+   __sync_lock_test_and_set(&mValue, value);
+   __sync_synchronize();
+#endif
+}
+
+int AtomicCounter::add(int amount)
+{
+#if defined(WIN_API)
+   return static_cast<int>(_InterlockedExchangeAdd(&mValue, amount) + amount);
+#else
+   return static_cast<int>(__sync_add_and_fetch(&mValue, amount));
+#endif
+}
+
+int AtomicCounter::increment()
+{
+   return add(1);
+}
+
+int AtomicCounter::decrement()
+{
+   return add(-1);
+}
+
+//------------ TaskGroup ---------------//
+
+TaskGroup::TaskGroup() :
+   mPendingTasks(0),
+   mNotified(false)
+{}
+
+TaskGroup::~TaskGroup()
+{
+   wait();
+}
+
+void TaskGroup::run(ThreadCommand& command)
+{
+   ThreadPool::instance().submit(command, *this);
+}
+
+void TaskGroup::wait()
+{
+   while (wait(100) == false)
+   {
+   }
+}
+
+bool TaskGroup::wait(unsigned int milliseconds)
+{
+   if (isComplete())
+   {
+      return true;
+   }
+
+   // A blocked worker would take a thread away from the pool, so help with this group's work instead
+   ThreadPool& pool = ThreadPool::instance();
+   if (pool.isWorkerThread() && pool.runPendingTask(this))
+   {
+      return isComplete();
+   }
+
+   MutexLock lock(mMutex);
+   if (mPendingTasks > 0 && mNotified == false)
+   {
+      mSignal.ThreadSignalTimedWait(&mMutex, milliseconds);
+   }
+
+   mNotified = false;
+   return mPendingTasks == 0;
+}
+
+void TaskGroup::notify()
+{
+   MutexLock lock(mMutex);
+   mNotified = true;
+   mSignal.ThreadSignalBroadcast();
+}
+
+bool TaskGroup::isComplete() const
+{
+   MutexLock lock(mMutex);
+   return mPendingTasks == 0;
+}
+
+void TaskGroup::addTask()
+{
+   MutexLock lock(mMutex);
+   ++mPendingTasks;
+}
+
+void TaskGroup::completeTask()
+{
+   // The signal is sent while the mutex is held so a waiter cannot destroy the group before it is sent
+   MutexLock lock(mMutex);
+   if (--mPendingTasks == 0)
+   {
+      mSignal.ThreadSignalBroadcast();
+   }
+}
+
+//------------ ThreadPool ---------------//
+
+ThreadPool& ThreadPool::instance()
+{
+   pthread_once(&sPoolOnce, &ThreadPool::createInstance);
+   return *spPool;
+}
+
+void ThreadPool::createInstance()
+{
+   spPool = new ThreadPool(std::max(ConfigurationSettings::getSettingThreadCount(), 1U));
+}
+
+ThreadPool::ThreadPool(unsigned int workerCount)
+{
+   pthread_key_create(&mWorkerKey, NULL);
+
+   mWorkers.reserve(workerCount);
+   for (unsigned int i = 0; i < workerCount; ++i)
+   {
+      Worker* pWorker = new Worker;
+      pWorker->mpPool = this;
+      pWorker->mIndex = i;
+      pWorker->mThread.ThreadSetThreadData(static_cast<void*>(pWorker));
+      pWorker->mThread.ThreadSetRunFunction(reinterpret_cast<void*>(ThreadPool::workerFunction));
+      mWorkers.push_back(pWorker);
+   }
+
+   // Start the workers after every queue exists since they steal from each other
+   for (std::vector<Worker*>::iterator iter = mWorkers.begin(); iter != mWorkers.end(); ++iter)
+   {
+      (*iter)->mThread.ThreadLaunch();
+      (*iter)->mThread.ThreadDetach();
+   }
+}
+
+ThreadPool::~ThreadPool()
+{
+   // The pool is never destroyed since the detached workers use it until the process exits
+}
+
+unsigned int ThreadPool::getWorkerCount() const
+{
+   return static_cast<unsigned int>(mWorkers.size());
+}
+
+bool ThreadPool::isWorkerThread() const
+{
+   return getWorkerIndex() >= 0;
+}
+
+int ThreadPool::getWorkerIndex() const
+{
+   // The key stores the index plus one since threads which are not workers have a NULL value
+   void* pValue = pthread_getspecific(mWorkerKey);
+   return static_cast<int>(reinterpret_cast<size_t>(pValue)) - 1;
+}
+
+void ThreadPool::submit(ThreadCommand& command, TaskGroup& group)
+{
+   group.addTask();
+
+   Task task;
+   task.mpCommand = &command;
+   task.mpGroup = &group;
+
+   int workerIndex = getWorkerIndex();
+   if (workerIndex < 0)
+   {
+      workerIndex = static_cast<int>(static_cast<unsigned int>(mNextWorker.increment()) % mWorkers.size());
+   }
+
+   Worker* pWorker = mWorkers[workerIndex];
+   {
+      MutexLock lock(pWorker->mMutex);
+      pWorker->mTasks.push_front(task);
+   }
+
+   mQueuedTasks.increment();
+
+   MutexLock lock(mIdleMutex);
+   mIdleSignal.ThreadSignalBroadcast();
+}
+
+bool ThreadPool::runPendingTask(TaskGroup* pGroup)
+{
+   int workerIndex = getWorkerIndex();
+   Task task;
+   if (popTask(workerIndex < 0 ? 0 : static_cast<unsigned int>(workerIndex), pGroup, task) == false)
+   {
+      return false;
+   }
+
+   execute(task);
+   return true;
+}
+
+bool ThreadPool::popTask(unsigned int firstWorker, TaskGroup* pGroup, Task& task)
+{
+   if (mQueuedTasks.get() <= 0)
+   {
+      return false;
+   }
+
+   // Take the newest command from the first worker's queue, then steal the oldest from the others
+   for (unsigned int offset = 0; offset < mWorkers.size(); ++offset)
+   {
+      Worker* pWorker = mWorkers[(firstWorker + offset) % mWorkers.size()];
+      MutexLock lock(pWorker->mMutex);
+      std::deque<Task>& tasks = pWorker->mTasks;
+      for (std::deque<Task>::size_type i = 0; i < tasks.size(); ++i)
+      {
+         std::deque<Task>::iterator iter = (offset == 0 ? tasks.begin() + i : tasks.end() - i - 1);
+         if (pGroup == NULL || iter->mpGroup == pGroup)
+         {
+            task = *iter;
+            tasks.erase(iter);
+            mQueuedTasks.decrement();
+            return true;
+         }
+      }
+   }
+
+   return false;
+}
+
+void ThreadPool::execute(const Task& task)
+{
+   task.mpCommand->run();
+   task.mpGroup->completeTask();
+}
+
+void ThreadPool::workerFunction(Worker* pWorker)
+{
+   ThreadPool* pPool = pWorker->mpPool;
+   pthread_setspecific(pPool->mWorkerKey, reinterpret_cast<void*>(static_cast<size_t>(pWorker->mIndex + 1)));
+
+   for (;;)
+   {
+      Task task;
+      if (pPool->popTask(pWorker->mIndex, NULL, task))
+      {
+         pPool->execute(task);
+         continue;
+      }
+
+      MutexLock lock(pPool->mIdleMutex);
+      while (pPool->mQueuedTasks.get() <= 0)
+      {
+         pPool->mIdleSignal.ThreadSignalWait(&pPool->mIdleMutex);
+      }
+   }
+}
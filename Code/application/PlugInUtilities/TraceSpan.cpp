@@ -0,0 +1,92 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "TraceSpan.h"
+#include "Tracer.h"
+
+using namespace std;
+
+TraceSpan::TraceSpan(const char* pCategory, const char* pName) :
+   mpTracer(getActiveTracer()),
+   mpCategory(pCategory),
+   mpName(pName),
+   mStartTime(0.0),
+   mBytes(0)
+{
+   if (mpTracer != NULL)
+   {
+      mStartTime = mpTracer->getTime();
+   }
+}
+
+TraceSpan::TraceSpan(const char* pCategory, const string& name) :
+   mpTracer(getActiveTracer()),
+   mpCategory(pCategory),
+   mpName(NULL),
+   mStartTime(0.0),
+   mBytes(0)
+{
+   if (mpTracer != NULL)
+   {
+      mName = name;
+      mStartTime = mpTracer->getTime();
+   }
+}
+
+TraceSpan::~TraceSpan()
+{
+   if (mpTracer != NULL)
+   {
+      mpTracer->addSpan(mpCategory, mpName == NULL ? mName : string(mpName), mStartTime, mpTracer->getTime(),
+         mBytes, mDetail);
+   }
+}
+
+bool TraceSpan::isActive() const
+{
+   return mpTracer != NULL;
+}
+
+void TraceSpan::setName(const string& name)
+{
+   if (mpTracer != NULL)
+   {
+      mName = name;
+      mpName = NULL;
+   }
+}
+
+void TraceSpan::setBytes(uint64_t bytes)
+{
+   mBytes = bytes;
+}
+
+void TraceSpan::setDetail(const string& detail)
+{
+   if (mpTracer != NULL)
+   {
+      mDetail = detail;
+   }
+}
+
+Tracer* TraceSpan::getActiveTracer()
+{
+   // The tracer lives for the life of the application so the lookup is only done once per module
+   static Tracer* spTracer = NULL;
+   if (spTracer == NULL)
+   {
+      spTracer = Service<Tracer>().get();
+      if (spTracer == NULL)
+      {
+         return NULL;
+      }
+   }
+
+   return spTracer->isEnabled() ? spTracer : NULL;
+}
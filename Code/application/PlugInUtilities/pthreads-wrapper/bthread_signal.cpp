@@ -10,8 +10,15 @@
 
 
 #include <assert.h>
+#include "AppConfig.h"
 #include "bthread_signal.h"
 
+#if defined(WIN_API)
+#include <sys/timeb.h>
+#else
+#include <sys/time.h>
+#endif
+
 BThreadSignal::BThreadSignal()
 {
    mThreadSignalID = NULL;
@@ -72,3 +79,41 @@ bool BThreadSignal::ThreadSignalWait(void *mutexData)
 
    return true;
 }
+
+bool BThreadSignal::ThreadSignalBroadcast()
+{
+   assert (mThreadSignalID != NULL);
+
+   pthread_cond_broadcast(mThreadSignalID);
+
+   return true;
+}
+
+bool BThreadSignal::ThreadSignalTimedWait(void *mutexData, unsigned int milliseconds)
+{
+   assert (mThreadSignalID != NULL);
+   assert (mutexData != NULL);
+
+   BMutex *data = (BMutex *) mutexData;
+
+   // pthread_cond_timedwait takes an absolute time
+   struct timespec deadline;
+#if defined(WIN_API)
+   struct _timeb now;
+   _ftime(&now);
+   deadline.tv_sec = now.time + milliseconds / 1000;
+   deadline.tv_nsec = (now.millitm + milliseconds % 1000) * 1000000L;
+#else
+   struct timeval now;
+   gettimeofday(&now, NULL);
+   deadline.tv_sec = now.tv_sec + milliseconds / 1000;
+   deadline.tv_nsec = now.tv_usec * 1000L + (milliseconds % 1000) * 1000000L;
+#endif
+   if (deadline.tv_nsec >= 1000000000L)
+   {
+      deadline.tv_sec += 1;
+      deadline.tv_nsec -= 1000000000L;
+   }
+
+   return pthread_cond_timedwait(mThreadSignalID, data->GetMutexID(), &deadline) == 0;
+}
@@ -23,6 +23,14 @@ class BThreadSignal : public ThreadSignal
       virtual bool ThreadSignalDestroy();
       virtual bool ThreadSignalWait(void *mutexData);
       virtual bool ThreadSignalActivate();
+      virtual bool ThreadSignalBroadcast();
+
+      /**
+       * Waits for the signal for at most the given time.
+       *
+       * @return true if the signal was received, false if the wait timed out
+       */
+      virtual bool ThreadSignalTimedWait(void *mutexData, unsigned int milliseconds);
 
    private:
       pthread_cond_t *mThreadSignalID;
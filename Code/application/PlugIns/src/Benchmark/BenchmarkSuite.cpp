@@ -0,0 +1,2190 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "ApplicationServices.h"
+#include "AppVerify.h"
+#include "AppVersion.h"
+#include "BenchmarkSuite.h"
+#include "ConfigurationSettings.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "DesktopServices.h"
+#include "DimensionDescriptor.h"
+#include "FileDescriptor.h"
+#include "Filename.h"
+#include "GraphicElement.h"
+#include "GraphicLayer.h"
+#include "GraphicObject.h"
+#include "ImportDescriptor.h"
+#include "MessageLog.h"
+#include "MessageLogMgr.h"
+#include "MessageLogResource.h"
+#include "ModelServices.h"
+#include "MultiThreadedAlgorithm.h"
+#include "ObjectResource.h"
+#include "PlugInArgList.h"
+#include "PlugInManagerServices.h"
+#include "PlugInRegistration.h"
+#include "PlugInResource.h"
+#include "Progress.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterUtilities.h"
+#include "SpatialDataView.h"
+#include "SpatialDataWindow.h"
+#include "SpectralLibraryMatcher.h"
+#include "Statistics.h"
+#include "StringUtilities.h"
+#include "SyntheticCube.h"
+#include "Undo.h"
+#include "View.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QEventLoop>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtGui/QImage>
+#include <QtNetwork/QHostAddress>
+#include <QtNetwork/QTcpSocket>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <math.h>
+#include <string.h>
+
+#if defined(WIN_API)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+using namespace std;
+
+REGISTER_PLUGIN_BASIC(OpticksBenchmark, BenchmarkSuite);
+
+namespace
+{
+   // Accumulates the bytes read by the accessor cases so the reads cannot be optimized away
+   volatile unsigned int sChecksum = 0;
+
+   // Number of hit tests in each run of the graphics.hit case
+   const unsigned int sHitTests = 1000;
+
+   // Number of rows in the descriptor used by the descriptor cases
+   const unsigned int sDescriptorRows = 1000000;
+
+   // Number of pixels, best signatures per pixel and pruning components in each run of the match cases
+   const unsigned int sMatchPixels = 16384;
+   const unsigned int sMatchCount = 5;
+   const unsigned int sMatchPruningComponents = 8;
+
+   // Number of items and square roots per item in each run of the threads cases. The nested case
+   // runs an algorithm over sNestedItems items inside each of sNestedItems items.
+   const unsigned int sThreadItems = 4096;
+   const unsigned int sThreadItemWork = 20000;
+   const unsigned int sNestedItems = 64;
+
+   // Number of messages logged in each run of the messagelog cases
+   const unsigned int sLogMessages = 10000;
+
+   // The datachannel cases start their own data channel on this port so the server's setting is not changed
+   const int sDataChannelPort = 18081;
+
+   // Opcodes and header layout of the XML-RPC data channel, see DataChannelServer.h
+   const unsigned short sDataChannelRead = 2;
+   const unsigned short sDataChannelWrite = 3;
+   const int sDataChannelHeaderSize = 48;
+   const int sDataChannelTimeout = 60000;
+
+   // Repeatable pseudo-random numbers in [0, 1) so every build places the same graphic objects
+   double nextRandom(unsigned int& state)
+   {
+      state = state * 1664525 + 1013904223;
+      return static_cast<double>(state >> 8) / static_cast<double>(1 << 24);
+   }
+
+   unsigned int checksum(const void* pData, size_t count)
+   {
+      const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(pData);
+      unsigned int sum = 0;
+      for (size_t i = 0; i < count; ++i)
+      {
+         sum += pBytes[i];
+      }
+
+      return sum;
+   }
+
+   double percentile(const vector<double>& sortedValues, double fraction)
+   {
+      if (sortedValues.empty())
+      {
+         return 0.0;
+      }
+
+      // Nearest rank so every reported value is an observed run time
+      size_t rank = static_cast<size_t>(ceil(fraction * sortedValues.size()));
+      return sortedValues[min(max(rank, static_cast<size_t>(1)), sortedValues.size()) - 1];
+   }
+
+   string escapeJson(const string& text)
+   {
+      string escaped;
+      for (string::const_iterator iter = text.begin(); iter != text.end(); ++iter)
+      {
+         switch (*iter)
+         {
+         case '"':
+            escaped += "\\\"";
+            break;
+         case '\\':
+            escaped += "\\\\";
+            break;
+         case '\n':
+            escaped += "\\n";
+            break;
+         case '\r':
+            escaped += "\\r";
+            break;
+         case '\t':
+            escaped += "\\t";
+            break;
+         default:
+            if (static_cast<unsigned char>(*iter) >= 0x20)
+            {
+               escaped += *iter;
+            }
+            break;
+         }
+      }
+
+      return escaped;
+   }
+
+   vector<DimensionDescriptor> centerHalf(const vector<DimensionDescriptor>& dims)
+   {
+      size_t start = dims.size() / 4;
+      size_t count = max(dims.size() / 2, static_cast<size_t>(1));
+      return vector<DimensionDescriptor>(dims.begin() + start, dims.begin() + start + count);
+   }
+
+   struct ScalingInput
+   {
+      unsigned int mItems;
+      bool mImbalanced;
+      bool mNested;
+      int mThreadCount;
+   };
+
+   class ScalingThread;
+
+   struct ScalingOutput
+   {
+      ScalingOutput() : mSum(0.0) {}
+
+      bool compileOverallResults(const vector<ScalingThread*>& threads);
+
+      double mSum;
+   };
+
+   class ScalingThread : public mta::AlgorithmThread
+   {
+   public:
+      ScalingThread(const ScalingInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mThreadCount(threadCount),
+         mSum(0.0)
+      {}
+
+      void run()
+      {
+         Range range;
+         while (getNextRange(mThreadCount, static_cast<int>(mInput.mItems), range))
+         {
+            for (int item = range.mFirst; item <= range.mLast; ++item)
+            {
+               mSum += (mInput.mNested ? runNested() : work(static_cast<unsigned int>(item)));
+            }
+         }
+      }
+
+      double getSum() const
+      {
+         return mSum;
+      }
+
+   private:
+      ScalingThread& operator=(const ScalingThread& rhs);
+
+      double work(unsigned int item) const
+      {
+         // The imbalanced work is all in the last quarter of the items, as when an AOI only covers part of a cube
+         unsigned int count = sThreadItemWork;
+         if (mInput.mImbalanced)
+         {
+            count = (item >= mInput.mItems - mInput.mItems / 4 ? 4 * sThreadItemWork : 0);
+         }
+
+         double sum = 0.0;
+         for (unsigned int i = 0; i < count; ++i)
+         {
+            sum += sqrt(static_cast<double>(i + item));
+         }
+
+         return sum;
+      }
+
+      double runNested() const
+      {
+         ScalingInput input;
+         input.mItems = sNestedItems;
+         input.mImbalanced = false;
+         input.mNested = false;
+         input.mThreadCount = mInput.mThreadCount;
+
+         ScalingOutput output;
+         mta::MultiThreadedAlgorithm<ScalingInput, ScalingOutput, ScalingThread>
+            alg(input.mThreadCount, input, output, NULL);
+         return (alg.run() == mta::SUCCESS ? output.mSum : 0.0);
+      }
+
+      const ScalingInput& mInput;
+      int mThreadCount;
+      double mSum;
+   };
+
+   bool ScalingOutput::compileOverallResults(const vector<ScalingThread*>& threads)
+   {
+      mSum = 0.0;
+      for (vector<ScalingThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+      {
+         mSum += (*iter)->getSum();
+      }
+
+      return true;
+   }
+
+   void appendBytes(QByteArray& data, uint64_t value, int count)
+   {
+      for (int i = 0; i < count; ++i)
+      {
+         data.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+      }
+   }
+
+   uint64_t readBytes(const QByteArray& data, int offset, int count)
+   {
+      uint64_t value = 0;
+      for (int i = 0; i < count; ++i)
+      {
+         value |= static_cast<uint64_t>(static_cast<unsigned char>(data[offset + i])) << (8 * i);
+      }
+
+      return value;
+   }
+
+   /**
+    *  Reads or writes an entire raster element through the data channel.
+    *
+    *  The data channel server handles its sockets in the main thread, so the blocking
+    *  client runs in its own thread while the main thread processes events.
+    */
+   class DataChannelClient : public QThread
+   {
+   public:
+      DataChannelClient(const string& elementName, unsigned short opcode, QByteArray& block) :
+         mName(QByteArray(elementName.c_str())),
+         mOpcode(opcode),
+         mBlock(block),
+         mSuccess(false)
+      {}
+
+      bool exchange(string& message)
+      {
+         QEventLoop loop;
+         VERIFY(QObject::connect(this, SIGNAL(finished()), &loop, SLOT(quit())));
+         start();
+         loop.exec();
+         wait();
+
+         if (!mSuccess)
+         {
+            message = mErrorText;
+         }
+
+         return mSuccess;
+      }
+
+   protected:
+      void run()
+      {
+         QTcpSocket socket;
+         socket.connectToHost(QHostAddress(QHostAddress::LocalHost), static_cast<quint16>(sDataChannelPort));
+         if (!socket.waitForConnected(sDataChannelTimeout))
+         {
+            mErrorText = "Unable to connect to the data channel.";
+            return;
+         }
+
+         // A count of zero selects the entire element
+         QByteArray request;
+         appendBytes(request, 0x4344504F, 4);
+         appendBytes(request, 1, 2);
+         appendBytes(request, mOpcode, 2);
+         appendBytes(request, 0, 28);
+         appendBytes(request, mName.size(), 4);
+         appendBytes(request, mOpcode == sDataChannelWrite ? mBlock.size() : 0, 8);
+         request.append(mName);
+         socket.write(request);
+         if (mOpcode == sDataChannelWrite)
+         {
+            socket.write(mBlock);
+         }
+
+         while (socket.bytesToWrite() > 0)
+         {
+            if (!socket.waitForBytesWritten(sDataChannelTimeout))
+            {
+               mErrorText = "Unable to send the request to the data channel.";
+               return;
+            }
+         }
+
+         QByteArray response;
+         uint64_t responseSize = sDataChannelHeaderSize;
+         while (static_cast<uint64_t>(response.size()) < responseSize)
+         {
+            if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(sDataChannelTimeout))
+            {
+               mErrorText = "The data channel did not respond.";
+               return;
+            }
+
+            response.append(socket.readAll());
+            if (response.size() >= sDataChannelHeaderSize)
+            {
+               responseSize = sDataChannelHeaderSize + readBytes(response, 40, 8);
+            }
+         }
+
+         QByteArray payload = response.mid(sDataChannelHeaderSize);
+         if (readBytes(response, 8, 4) != 0)
+         {
+            mErrorText = "The data channel failed: " + QString::fromUtf8(payload).toStdString();
+            return;
+         }
+
+         if (mOpcode == sDataChannelRead)
+         {
+            mBlock = payload;
+         }
+
+         mSuccess = true;
+      }
+
+   private:
+      DataChannelClient(const DataChannelClient& rhs);
+      DataChannelClient& operator=(const DataChannelClient& rhs);
+
+      QByteArray mName;
+      unsigned short mOpcode;
+      QByteArray& mBlock;
+      bool mSuccess;
+      string mErrorText;
+   };
+}
+
+BenchmarkSuite::BenchmarkSuite() :
+   mpProgress(NULL),
+   mRows(0),
+   mColumns(0),
+   mBands(0),
+   mIterations(0),
+   mFileBytes(0)
+{
+   setName("Benchmark Suite");
+   setDescription("Times data access and processing against generated cubes and writes the results as JSON.");
+   setDescriptorId("{6A0C3D2E-8F41-4B7A-9D35-1E2C7B4F90A6}");
+   setCreator("Ball Aerospace & Technologies Corp.");
+   setCopyright(APP_COPYRIGHT);
+   setVersion(APP_VERSION_NUMBER);
+   setProductionStatus(APP_IS_PRODUCTION_RELEASE);
+   setType("Benchmark");
+   setAbortSupported(true);
+   setWizardSupported(true);
+}
+
+BenchmarkSuite::~BenchmarkSuite()
+{}
+
+const vector<string>& BenchmarkSuite::getCaseNames()
+{
+   static vector<string> sNames;
+   if (sNames.empty())
+   {
+      sNames.push_back("generate");
+      sNames.push_back("accessor.rows");
+      sNames.push_back("accessor.columns");
+      sNames.push_back("accessor.tiles");
+      sNames.push_back("statistics");
+      sNames.push_back("statistics.batched");
+      sNames.push_back("bandmath");
+      sNames.push_back("pca");
+      sNames.push_back("covariance");
+      sNames.push_back("convolution");
+      sNames.push_back("chip");
+      sNames.push_back("export");
+      sNames.push_back("hdf5.deflate");
+      sNames.push_back("geotiff");
+      sNames.push_back("graphics.hit");
+      sNames.push_back("graphics.draw");
+      sNames.push_back("match.sam");
+      sNames.push_back("match.euclidean");
+      sNames.push_back("match.correlation");
+      sNames.push_back("descriptor.lookup");
+      sNames.push_back("descriptor.copy");
+      sNames.push_back("threads.balanced");
+      sNames.push_back("threads.imbalanced");
+      sNames.push_back("threads.nested");
+      sNames.push_back("messagelog.message");
+      sNames.push_back("messagelog.batch");
+      sNames.push_back("messagelog.periodic");
+      sNames.push_back("datachannel");
+      sNames.push_back("import.descriptors");
+   }
+
+   return sNames;
+}
+
+bool BenchmarkSuite::getInputSpecification(PlugInArgList*& pInArgList)
+{
+   Service<PlugInManagerServices> pManager;
+   pInArgList = pManager->getPlugInArgList();
+   VERIFY(pInArgList != NULL);
+
+   VERIFY(pInArgList->addArg<Progress>(Executable::ProgressArg(), NULL, Executable::ProgressArgDescription()));
+   VERIFY(pInArgList->addArg<Filename>("Output Filename", NULL, "The JSON file to write the results to."));
+   VERIFY(pInArgList->addArg<unsigned int>("Rows", 512, "The number of rows in each generated cube."));
+   VERIFY(pInArgList->addArg<unsigned int>("Columns", 512, "The number of columns in each generated cube."));
+   VERIFY(pInArgList->addArg<unsigned int>("Bands", 16, "The number of bands in each generated cube."));
+   VERIFY(pInArgList->addArg<unsigned int>("Iterations", 5, "The number of timed runs of each case. "
+      "Every case is run once more before timing starts."));
+   VERIFY(pInArgList->addArg<string>("Cases", string(), "A comma separated list of the cases to run. "
+      "If empty, all cases are run. Valid cases are generate, accessor.rows, accessor.columns, accessor.tiles, "
+      "statistics, statistics.batched, "
+      "bandmath, pca, covariance, convolution, chip, export, hdf5.deflate, geotiff, graphics.hit, graphics.draw, "
+      "match.sam, match.euclidean, match.correlation, descriptor.lookup, descriptor.copy, threads.balanced, "
+      "threads.imbalanced, threads.nested, messagelog.message, messagelog.batch, messagelog.periodic, "
+      "datachannel and import.descriptors."));
+   VERIFY(pInArgList->addArg<string>("Sample Files", string(), "A semicolon separated list of the files "
+      "used by the import cases. The import cases are not run if no files are given."));
+   return true;
+}
+
+bool BenchmarkSuite::getOutputSpecification(PlugInArgList*& pOutArgList)
+{
+   pOutArgList = NULL;
+   return true;
+}
+
+bool BenchmarkSuite::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
+{
+   VERIFY(pInArgList != NULL);
+   StepResource pStep("Execute " + getName(), "app", "7D1F5C82-3B6E-4E0A-A4C9-58E2D06B1F37");
+
+   mpProgress = pInArgList->getPlugInArgValue<Progress>(Executable::ProgressArg());
+   Filename* pOutputFilename = pInArgList->getPlugInArgValue<Filename>("Output Filename");
+   string casesText;
+   string sampleFilesText;
+   if (pOutputFilename == NULL ||
+      !pInArgList->getPlugInArgValue("Rows", mRows) ||
+      !pInArgList->getPlugInArgValue("Columns", mColumns) ||
+      !pInArgList->getPlugInArgValue("Bands", mBands) ||
+      !pInArgList->getPlugInArgValue("Iterations", mIterations) ||
+      !pInArgList->getPlugInArgValue("Cases", casesText) ||
+      !pInArgList->getPlugInArgValue("Sample Files", sampleFilesText))
+   {
+      string message = "Invalid input arguments.";
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress(message, 0, ERRORS);
+      }
+
+      pStep->finalize(Message::Failure, message);
+      return false;
+   }
+
+   mCases.clear();
+   QStringList caseNames = QString::fromStdString(casesText).split(",", QString::SkipEmptyParts);
+   for (QStringList::const_iterator iter = caseNames.begin(); iter != caseNames.end(); ++iter)
+   {
+      string name = iter->trimmed().toStdString();
+      if (find(getCaseNames().begin(), getCaseNames().end(), name) == getCaseNames().end())
+      {
+         string message = "Unknown benchmark case: " + name;
+         if (mpProgress != NULL)
+         {
+            mpProgress->updateProgress(message, 0, ERRORS);
+         }
+
+         pStep->finalize(Message::Failure, message);
+         return false;
+      }
+
+      mCases.insert(name);
+   }
+
+   if (mCases.empty())
+   {
+      mCases.insert(getCaseNames().begin(), getCaseNames().end());
+   }
+
+   mSampleFiles.clear();
+   QStringList sampleFiles = QString::fromStdString(sampleFilesText).split(";", QString::SkipEmptyParts);
+   for (QStringList::const_iterator iter = sampleFiles.begin(); iter != sampleFiles.end(); ++iter)
+   {
+      mSampleFiles.push_back(iter->trimmed().toStdString());
+   }
+
+   const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+   if (pTempPath != NULL)
+   {
+      mTempDirectory = pTempPath->getFullPathAndName();
+   }
+
+   mResults.clear();
+   pStep->addProperty("Rows", mRows);
+   pStep->addProperty("Columns", mColumns);
+   pStep->addProperty("Bands", mBands);
+   pStep->addProperty("Iterations", mIterations);
+
+   vector<EncodingType> encodings;
+   encodings.push_back(INT1UBYTE);
+   encodings.push_back(INT1SBYTE);
+   encodings.push_back(INT2UBYTES);
+   encodings.push_back(INT2SBYTES);
+   encodings.push_back(INT4UBYTES);
+   encodings.push_back(INT4SBYTES);
+   encodings.push_back(INT4SCOMPLEX);
+   encodings.push_back(FLT4BYTES);
+   encodings.push_back(FLT8COMPLEX);
+   encodings.push_back(FLT8BYTES);
+
+   vector<InterleaveFormatType> interleaves;
+   interleaves.push_back(BSQ);
+   interleaves.push_back(BIL);
+   interleaves.push_back(BIP);
+
+   const bool pagers[] = { true, false };
+   const unsigned int total = 2 * interleaves.size() * encodings.size();
+   unsigned int count = 0;
+   for (unsigned int pagerIndex = 0; pagerIndex < 2; ++pagerIndex)
+   {
+      bool inMemory = pagers[pagerIndex];
+      string pager = inMemory ? "memory" : "mapped";
+      for (vector<InterleaveFormatType>::const_iterator interleave = interleaves.begin();
+         interleave != interleaves.end(); ++interleave)
+      {
+         for (vector<EncodingType>::const_iterator encoding = encodings.begin();
+            encoding != encodings.end(); ++encoding, ++count)
+         {
+            string cubeName = "Benchmark " + StringUtilities::toXmlString(*encoding) + " " +
+               StringUtilities::toXmlString(*interleave) + " " + pager;
+            if (mpProgress != NULL)
+            {
+               mpProgress->updateProgress("Running " + cubeName, 100 * count / total, NORMAL);
+            }
+
+            double start = now();
+            ModelResource<RasterElement> pElement(SyntheticCube::create(cubeName, mRows, mColumns, mBands,
+               *encoding, *interleave, inMemory));
+            double generateSeconds = now() - start;
+
+            if (mCases.find("generate") != mCases.end())
+            {
+               Result result;
+               result.mCase = "generate";
+               result.mEncoding = *encoding;
+               result.mInterleave = *interleave;
+               result.mPager = pager;
+               result.mSuccess = (pElement.get() != NULL);
+               if (result.mSuccess)
+               {
+                  result.mSeconds.push_back(generateSeconds);
+               }
+               else
+               {
+                  result.mMessage = "The cube could not be created.";
+               }
+
+               addResult(result, pElement.get());
+            }
+
+            if (pElement.get() == NULL)
+            {
+               continue;
+            }
+
+            runCase("accessor.rows", &BenchmarkSuite::iterateRows, pElement.get(), pager);
+            runCase("accessor.columns", &BenchmarkSuite::iterateColumns, pElement.get(), pager);
+            runCase("accessor.tiles", &BenchmarkSuite::readTiledWindow, pElement.get(), pager + ".tiled");
+            runCase("accessor.tiles", &BenchmarkSuite::readRowWindow, pElement.get(), pager + ".rows");
+            if (*encoding == FLT4BYTES)
+            {
+               runCase("statistics", &BenchmarkSuite::calculateStatistics, pElement.get(), pager);
+               if (*interleave != BIL)
+               {
+                  runCase("statistics.batched", &BenchmarkSuite::calculateBatchedStatistics, pElement.get(), pager);
+               }
+               runCase("bandmath", &BenchmarkSuite::runBandMath, pElement.get(), pager);
+               runCase("pca", &BenchmarkSuite::runPca, pElement.get(), pager);
+               runCase("covariance", &BenchmarkSuite::runCovariance, pElement.get(), pager);
+               runCase("convolution", &BenchmarkSuite::runConvolution, pElement.get(), pager);
+               runCase("chip", &BenchmarkSuite::createChip, pElement.get(), pager);
+               runCase("export", &BenchmarkSuite::exportElement, pElement.get(), pager);
+               if (inMemory)
+               {
+                  runHdf5Cases(pElement.get());
+                  runGeoTiffCases(pElement.get());
+                  runTileCases(pElement.get());
+                  if (*interleave == BSQ)
+                  {
+                     runGraphicsCases(pElement.get());
+                  }
+                  else if (*interleave == BIP)
+                  {
+                     runMatchCases(pElement.get());
+                  }
+
+                  runDataChannelCases(pElement.get());
+               }
+            }
+
+            if (isAborted())
+            {
+               string message = "Benchmark Suite aborted.";
+               if (mpProgress != NULL)
+               {
+                  mpProgress->updateProgress(message, 0, ABORT);
+               }
+
+               pStep->finalize(Message::Abort, message);
+               return false;
+            }
+         }
+      }
+   }
+
+   runDescriptorCases();
+   runThreadCases();
+   runMessageLogCases();
+
+   for (vector<string>::const_iterator sampleFile = mSampleFiles.begin(); sampleFile != mSampleFiles.end();
+      ++sampleFile)
+   {
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress("Running " + *sampleFile, 100, NORMAL);
+      }
+
+      runFileCase("import.descriptors", &BenchmarkSuite::createImportDescriptors, *sampleFile);
+      if (isAborted())
+      {
+         string message = "Benchmark Suite aborted.";
+         if (mpProgress != NULL)
+         {
+            mpProgress->updateProgress(message, 0, ABORT);
+         }
+
+         pStep->finalize(Message::Abort, message);
+         return false;
+      }
+   }
+
+   string filename = pOutputFilename->getFullPathAndName();
+   ofstream output(filename.c_str());
+   writeResults(output);
+   output.close();
+   if (!output)
+   {
+      string message = "Unable to write the benchmark results to " + filename + ".";
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress(message, 0, ERRORS);
+      }
+
+      pStep->finalize(Message::Failure, message);
+      return false;
+   }
+
+   unsigned int failures = 0;
+   for (vector<Result>::const_iterator iter = mResults.begin(); iter != mResults.end(); ++iter)
+   {
+      if (!iter->mSuccess)
+      {
+         ++failures;
+      }
+   }
+
+   string message = "Benchmark results written to " + filename + ".";
+   if (mpProgress != NULL)
+   {
+      mpProgress->updateProgress(message, 100, failures == 0 ? NORMAL : WARNING);
+   }
+
+   pStep->addProperty("Failed Cases", failures);
+   pStep->finalize(Message::Success);
+   return true;
+}
+
+void BenchmarkSuite::runCase(const string& name, CaseMethod method, RasterElement* pElement, const string& pager)
+{
+   if (mCases.find(name) == mCases.end() || isAborted())
+   {
+      return;
+   }
+
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+
+   Result result;
+   result.mCase = name;
+   result.mEncoding = pDescriptor->getDataType();
+   result.mInterleave = pDescriptor->getInterleaveFormat();
+   result.mPager = pager;
+
+   // The untimed first run loads plug-ins and faults in pages so the timed runs measure steady state
+   mFileBytes = 0;
+   result.mSuccess = (this->*method)(pElement, result.mMessage);
+   destroyChildren(pElement);
+   for (unsigned int i = 0; i < mIterations && result.mSuccess; ++i)
+   {
+      double start = now();
+      result.mSuccess = (this->*method)(pElement, result.mMessage);
+      result.mSeconds.push_back(now() - start);
+      destroyChildren(pElement);
+   }
+
+   result.mFileBytes = mFileBytes;
+   addResult(result, pElement);
+}
+
+void BenchmarkSuite::runFileCase(const string& name, FileCaseMethod method, const string& filename)
+{
+   if (mCases.find(name) == mCases.end() || isAborted())
+   {
+      return;
+   }
+
+   Result result;
+   result.mCase = name;
+   result.mFile = filename;
+
+   // The untimed first run loads plug-ins and brings the file into the operating system cache
+   result.mSuccess = (this->*method)(filename, result.mMessage);
+   for (unsigned int i = 0; i < mIterations && result.mSuccess; ++i)
+   {
+      double start = now();
+      result.mSuccess = (this->*method)(filename, result.mMessage);
+      result.mSeconds.push_back(now() - start);
+   }
+
+   result.mBytes = static_cast<uint64_t>(QFileInfo(QString::fromStdString(filename)).size());
+   addResult(result, NULL);
+}
+
+void BenchmarkSuite::runHdf5Cases(RasterElement* pElement)
+{
+   if (mCases.find("hdf5.deflate") == mCases.end() || isAborted())
+   {
+      return;
+   }
+
+   // Write the cube as a shuffled and deflate compressed ICE file
+   Service<ConfigurationSettings> pSettings;
+   pSettings->setTemporarySetting("IceWriter/CompressionType", string("shuffle_gzip"));
+   pSettings->setTemporarySetting("IceWriter/GzipCompressionLevel", 6);
+
+   mHdf5Filename = mTempDirectory + SLASH + "OpticksBenchmark.ice.h5";
+   FactoryResource<FileDescriptor> pFileDescriptor(
+      RasterUtilities::generateFileDescriptorForExport(pElement->getDataDescriptor(), mHdf5Filename));
+   bool exported = false;
+   if (pFileDescriptor.get() != NULL)
+   {
+      ExporterResource exporter("Ice Exporter", pElement, pFileDescriptor.get(), NULL, true);
+      exported = (exporter->getPlugIn() != NULL && exporter->execute());
+   }
+
+   pSettings->deleteTemporarySetting("IceWriter/CompressionType");
+   pSettings->deleteTemporarySetting("IceWriter/GzipCompressionLevel");
+
+   if (exported)
+   {
+      runCase("hdf5.deflate", &BenchmarkSuite::readHdf5File, pElement, "hdf5.chunked");
+
+      pSettings->setTemporarySetting("Hdf5Pager/ChunkAlignedReads", false);
+      runCase("hdf5.deflate", &BenchmarkSuite::readHdf5File, pElement, "hdf5.library");
+      pSettings->deleteTemporarySetting("Hdf5Pager/ChunkAlignedReads");
+   }
+   else
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      VERIFYNRV(pDescriptor != NULL);
+
+      Result result;
+      result.mCase = "hdf5.deflate";
+      result.mEncoding = pDescriptor->getDataType();
+      result.mInterleave = pDescriptor->getInterleaveFormat();
+      result.mPager = "hdf5";
+      result.mMessage = "The Ice Exporter failed.";
+      addResult(result, pElement);
+   }
+
+   QFile::remove(QString::fromStdString(mHdf5Filename));
+}
+
+void BenchmarkSuite::runGeoTiffCases(RasterElement* pElement)
+{
+   if (mCases.find("geotiff") == mCases.end() || isAborted())
+   {
+      return;
+   }
+
+   // The strip layouts match the exporter before tiled output was added
+   struct Layout
+   {
+      const char* mpName;
+      bool mTiled;
+      bool mPackBits;
+      const char* mpCompression;
+      bool mOverviews;
+   };
+
+   static const Layout sLayouts[] =
+   {
+      { "strips.none", false, false, "None", false },
+      { "strips.packbits", false, true, "None", false },
+      { "tiled.none", true, false, "None", false },
+      { "tiled.lzw", true, false, "LZW", false },
+      { "tiled.deflate", true, false, "Deflate", false },
+      { "tiled.deflate.overviews", true, false, "Deflate", true }
+   };
+
+   Service<ConfigurationSettings> pSettings;
+   for (size_t i = 0; i < sizeof(sLayouts) / sizeof(sLayouts[0]); ++i)
+   {
+      const Layout& layout = sLayouts[i];
+      pSettings->setTemporarySetting("TiffExporter/TiledOutput", layout.mTiled);
+      pSettings->setTemporarySetting("TiffExporter/PackBitsCompression", layout.mPackBits);
+      pSettings->setTemporarySetting("TiffExporter/TileCompression", string(layout.mpCompression));
+      pSettings->setTemporarySetting("TiffExporter/Overviews", layout.mOverviews);
+      pSettings->setTemporarySetting("TiffExporter/RowsPerStrip", 1U);
+      pSettings->setTemporarySetting("TiffExporter/TileSize", 256U);
+
+      runCase("geotiff", &BenchmarkSuite::exportGeoTiff, pElement, layout.mpName);
+   }
+
+   pSettings->deleteTemporarySetting("TiffExporter/TiledOutput");
+   pSettings->deleteTemporarySetting("TiffExporter/PackBitsCompression");
+   pSettings->deleteTemporarySetting("TiffExporter/TileCompression");
+   pSettings->deleteTemporarySetting("TiffExporter/Overviews");
+   pSettings->deleteTemporarySetting("TiffExporter/RowsPerStrip");
+   pSettings->deleteTemporarySetting("TiffExporter/TileSize");
+}
+
+void BenchmarkSuite::runTileCases(RasterElement* pElement)
+{
+   if (mCases.find("accessor.tiles") == mCases.end() || isAborted())
+   {
+      return;
+   }
+
+   // Write the cube as an uncompressed tiled GeoTIFF so the GDAL pager can read single tile columns
+   Service<ConfigurationSettings> pSettings;
+   pSettings->setTemporarySetting("TiffExporter/TiledOutput", true);
+   pSettings->setTemporarySetting("TiffExporter/TileCompression", string("None"));
+   pSettings->setTemporarySetting("TiffExporter/Overviews", false);
+   pSettings->setTemporarySetting("TiffExporter/TileSize", 128U);
+
+   mTileFilename = mTempDirectory + SLASH + "OpticksBenchmarkTiles.tif";
+   FactoryResource<FileDescriptor> pFileDescriptor(
+      RasterUtilities::generateFileDescriptorForExport(pElement->getDataDescriptor(), mTileFilename));
+   bool exported = false;
+   if (pFileDescriptor.get() != NULL)
+   {
+      ExporterResource exporter("GeoTIFF Exporter", pElement, pFileDescriptor.get(), NULL, true);
+      exported = (exporter->getPlugIn() != NULL && exporter->execute());
+   }
+
+   pSettings->deleteTemporarySetting("TiffExporter/TiledOutput");
+   pSettings->deleteTemporarySetting("TiffExporter/TileCompression");
+   pSettings->deleteTemporarySetting("TiffExporter/Overviews");
+   pSettings->deleteTemporarySetting("TiffExporter/TileSize");
+
+   if (exported)
+   {
+      runCase("accessor.tiles", &BenchmarkSuite::readGdalTiledWindow, pElement, "gdal.tiled");
+      runCase("accessor.tiles", &BenchmarkSuite::readGdalRowWindow, pElement, "gdal.rows");
+   }
+   else
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      VERIFYNRV(pDescriptor != NULL);
+
+      Result result;
+      result.mCase = "accessor.tiles";
+      result.mEncoding = pDescriptor->getDataType();
+      result.mInterleave = pDescriptor->getInterleaveFormat();
+      result.mPager = "gdal";
+      result.mMessage = "The GeoTIFF Exporter failed.";
+      addResult(result, pElement);
+   }
+
+   QFile::remove(QString::fromStdString(mTileFilename));
+}
+
+void BenchmarkSuite::runDataChannelCases(RasterElement* pElement)
+{
+   if (mCases.find("datachannel") == mCases.end() || isAborted())
+   {
+      return;
+   }
+
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+
+   Result result;
+   result.mCase = "datachannel";
+   result.mEncoding = pDescriptor->getDataType();
+   result.mInterleave = pDescriptor->getInterleaveFormat();
+   result.mPager = "socket";
+
+   // The server reads its port from the settings when it is executed
+   Service<ConfigurationSettings> pSettings;
+   pSettings->setTemporarySetting("XmlRpc/XmlRpcDataChannelPort", sDataChannelPort);
+   ExecutableResource server("XML-RPC Data Channel", string(), NULL, true);
+   bool started = (server->getPlugIn() != NULL && server->execute());
+   pSettings->deleteTemporarySetting("XmlRpc/XmlRpcDataChannelPort");
+   if (!started)
+   {
+      result.mMessage = "The data channel could not be started.";
+      addResult(result, pElement);
+      return;
+   }
+
+   // Writing must go to the element's own interleave, so check that a written block reads back
+   // through an independent accessor before anything is timed
+   if (!verifyDataChannel(pElement, result.mMessage))
+   {
+      addResult(result, pElement);
+      return;
+   }
+
+   runCase("datachannel", &BenchmarkSuite::transferDataChannel, pElement, "socket");
+   runCase("datachannel", &BenchmarkSuite::exportAndImport, pElement, "export");
+}
+
+void BenchmarkSuite::runGraphicsCases(RasterElement* pElement)
+{
+   if ((mCases.find("graphics.hit") == mCases.end() && mCases.find("graphics.draw") == mCases.end()) ||
+      isAborted() || Service<ApplicationServices>()->isBatch())
+   {
+      return;
+   }
+
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+
+   // The window is deleted without asking the user to confirm
+   Service<ConfigurationSettings> pSettings;
+   pSettings->setTemporarySetting("WorkspaceWindow/ConfirmClose", false);
+
+   Service<DesktopServices> pDesktop;
+   SpatialDataWindow* pWindow =
+      dynamic_cast<SpatialDataWindow*>(pDesktop->createWindow("Benchmark Graphics", SPATIAL_DATA_WINDOW));
+   SpatialDataView* pView = (pWindow == NULL ? NULL : pWindow->getSpatialDataView());
+   if (pView == NULL || pView->setPrimaryRasterElement(pElement) == false ||
+      pView->createLayer(RASTER, pElement) == NULL)
+   {
+      Result result;
+      result.mCase = "graphics.draw";
+      result.mEncoding = pDescriptor->getDataType();
+      result.mInterleave = pDescriptor->getInterleaveFormat();
+      result.mPager = "memory";
+      result.mMessage = "The cube could not be displayed.";
+      addResult(result, NULL);
+      pDesktop->deleteWindow(pWindow);
+      pSettings->deleteTemporarySetting("WorkspaceWindow/ConfirmClose");
+      return;
+   }
+
+   // Zoom to a quarter of the width and height of the cube so most of the objects are outside of the view
+   double columns = pDescriptor->getColumnCount();
+   double rows = pDescriptor->getRowCount();
+   pView->zoomToBox(LocationType(columns * 0.375, rows * 0.375), LocationType(columns * 0.625, rows * 0.625));
+
+   const unsigned int objectCounts[] = { 1000, 10000, 100000 };
+   for (unsigned int i = 0; i < sizeof(objectCounts) / sizeof(objectCounts[0]) && !isAborted(); ++i)
+   {
+      GraphicLayer* pLayer = dynamic_cast<GraphicLayer*>(pView->createLayer(ANNOTATION, NULL,
+         "Benchmark Graphics " + StringUtilities::toDisplayString(objectCounts[i])));
+      GraphicElement* pGraphics = (pLayer == NULL ? NULL : dynamic_cast<GraphicElement*>(pLayer->getDataElement()));
+      if (pGraphics == NULL)
+      {
+         continue;
+      }
+
+      {
+         // Updating the extents of the layer after every object is added is quadratic, so it is done once
+         UndoLock lock(pView);
+         pGraphics->setInteractive(false);
+
+         unsigned int state = objectCounts[i];
+         for (unsigned int object = 0; object < objectCounts[i]; ++object)
+         {
+            GraphicObject* pObject = pLayer->addObject(RECTANGLE_OBJECT);
+            if (pObject == NULL)
+            {
+               break;
+            }
+
+            LocationType llCorner(nextRandom(state) * columns, nextRandom(state) * rows);
+            double size = 1.0 + 4.0 * nextRandom(state);
+            pObject->setBoundingBox(llCorner, LocationType(llCorner.mX + size, llCorner.mY + size));
+         }
+
+         pGraphics->setInteractive(true);
+      }
+
+      runGraphicsCase("graphics.hit", &BenchmarkSuite::hitObjects, pLayer, pElement, objectCounts[i], sHitTests);
+      runGraphicsCase("graphics.draw", &BenchmarkSuite::drawObjects, pLayer, pElement, objectCounts[i], 1);
+      pView->deleteLayer(pLayer);
+   }
+
+   pDesktop->deleteWindow(pWindow);
+   pSettings->deleteTemporarySetting("WorkspaceWindow/ConfirmClose");
+}
+
+void BenchmarkSuite::runGraphicsCase(const string& name, GraphicsCaseMethod method, GraphicLayer* pLayer,
+                                     RasterElement* pElement, unsigned int objectCount, unsigned int samples)
+{
+   if (mCases.find(name) == mCases.end() || isAborted())
+   {
+      return;
+   }
+
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+
+   Result result;
+   result.mCase = name;
+   result.mEncoding = pDescriptor->getDataType();
+   result.mInterleave = pDescriptor->getInterleaveFormat();
+   result.mPager = "memory";
+   result.mObjects = objectCount;
+   result.mSamples = samples;
+
+   // The untimed first run includes any one time work such as building the spatial index of the layer
+   result.mSuccess = (this->*method)(pLayer, result.mMessage);
+   for (unsigned int i = 0; i < mIterations && result.mSuccess; ++i)
+   {
+      double start = now();
+      result.mSuccess = (this->*method)(pLayer, result.mMessage);
+      result.mSeconds.push_back(now() - start);
+   }
+
+   addResult(result, NULL);
+}
+
+void BenchmarkSuite::runMatchCases(RasterElement* pElement)
+{
+   if ((mCases.find("match.sam") == mCases.end() && mCases.find("match.euclidean") == mCases.end() &&
+      mCases.find("match.correlation") == mCases.end()) || isAborted())
+   {
+      return;
+   }
+
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+
+   unsigned int rows = pDescriptor->getRowCount();
+   unsigned int columns = pDescriptor->getColumnCount();
+   unsigned int bands = pDescriptor->getBandCount();
+
+   vector<Opticks::PixelLocation> pixels;
+   for (unsigned int pixel = 0; pixel < sMatchPixels && pixel < rows * columns; ++pixel)
+   {
+      pixels.push_back(Opticks::PixelLocation(static_cast<int>(pixel % columns), static_cast<int>(pixel / columns)));
+   }
+
+   // Each signature is a random mixture of smooth spectra so the library is correlated like a real one
+   const unsigned int signatureCounts[] = { 1000, 10000, 100000 };
+   for (unsigned int i = 0; i < sizeof(signatureCounts) / sizeof(signatureCounts[0]) && !isAborted(); ++i)
+   {
+      unsigned int state = signatureCounts[i];
+      vector<double> ordinates(static_cast<size_t>(signatureCounts[i]) * bands);
+      for (unsigned int signature = 0; signature < signatureCounts[i]; ++signature)
+      {
+         double offset = nextRandom(state);
+         double slope = nextRandom(state);
+         double curvature = nextRandom(state);
+         for (unsigned int band = 0; band < bands; ++band)
+         {
+            double position = (bands > 1 ? static_cast<double>(band) / (bands - 1) : 0.0);
+            ordinates[static_cast<size_t>(signature) * bands + band] = 100.0 * (offset + slope * position +
+               curvature * sin(PI * position)) + nextRandom(state);
+         }
+      }
+
+      SpectralLibraryMatcher matcher;
+      matcher.setSignatures(&ordinates[0], signatureCounts[i], bands);
+      matcher.setPruningComponents(sMatchPruningComponents);
+      runMatchCase("match.sam", SpectralLibraryMatcher::SPECTRAL_ANGLE, matcher, pElement, pixels);
+      runMatchCase("match.euclidean", SpectralLibraryMatcher::EUCLIDEAN, matcher, pElement, pixels);
+      runMatchCase("match.correlation", SpectralLibraryMatcher::CORRELATION, matcher, pElement, pixels);
+   }
+}
+
+void BenchmarkSuite::runMatchCase(const string& name, SpectralLibraryMatcher::MetricType metric,
+                                  SpectralLibraryMatcher& matcher, RasterElement* pElement,
+                                  const vector<Opticks::PixelLocation>& pixels)
+{
+   if (mCases.find(name) == mCases.end() || isAborted())
+   {
+      return;
+   }
+
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+
+   Result result;
+   result.mCase = name;
+   result.mEncoding = pDescriptor->getDataType();
+   result.mInterleave = pDescriptor->getInterleaveFormat();
+   result.mPager = "memory";
+   result.mObjects = matcher.getNumSignatures();
+   result.mSamples = static_cast<uint64_t>(pixels.size()) * matcher.getNumSignatures();
+
+   // The untimed first run includes computing the principal components used for pruning
+   vector<vector<SpectralLibraryMatcher::Match> > matches;
+   result.mSuccess = matcher.match(pElement, pixels, metric, sMatchCount, matches);
+   for (unsigned int i = 0; i < mIterations && result.mSuccess; ++i)
+   {
+      double start = now();
+      result.mSuccess = matcher.match(pElement, pixels, metric, sMatchCount, matches);
+      result.mSeconds.push_back(now() - start);
+   }
+
+   if (!result.mSuccess)
+   {
+      result.mMessage = matcher.getErrorText();
+   }
+
+   addResult(result, NULL);
+}
+
+void BenchmarkSuite::runDescriptorCases()
+{
+   if ((mCases.find("descriptor.lookup") == mCases.end() && mCases.find("descriptor.copy") == mCases.end()) ||
+      isAborted())
+   {
+      return;
+   }
+
+   // Only the descriptor is created so the rows are not limited by the size of a cube which fits in memory
+   DataDescriptorResource<RasterDataDescriptor> pDescriptor(RasterUtilities::generateRasterDataDescriptor(
+      "Benchmark Descriptor", NULL, sDescriptorRows, 1, 1, BSQ, FLT4BYTES, IN_MEMORY));
+   if (pDescriptor.get() == NULL)
+   {
+      Result result;
+      result.mCase = "descriptor.lookup";
+      result.mEncoding = FLT4BYTES;
+      result.mInterleave = BSQ;
+      result.mPager = "memory";
+      result.mMessage = "The descriptor could not be created.";
+      addResult(result, NULL);
+      return;
+   }
+
+   RasterUtilities::generateAndSetFileDescriptor(pDescriptor.get(), "Benchmark Descriptor", string(),
+      LITTLE_ENDIAN_ORDER);
+
+   runDescriptorCase("descriptor.lookup", &BenchmarkSuite::lookupRows, pDescriptor.get(), 3 * sDescriptorRows);
+   runDescriptorCase("descriptor.copy", &BenchmarkSuite::copyDescriptor, pDescriptor.get(), sDescriptorRows);
+}
+
+void BenchmarkSuite::runDescriptorCase(const string& name, DescriptorCaseMethod method,
+                                       RasterDataDescriptor* pDescriptor, uint64_t samples)
+{
+   if (mCases.find(name) == mCases.end() || isAborted())
+   {
+      return;
+   }
+
+   Result result;
+   result.mCase = name;
+   result.mEncoding = pDescriptor->getDataType();
+   result.mInterleave = pDescriptor->getInterleaveFormat();
+   result.mPager = "memory";
+   result.mObjects = pDescriptor->getRowCount();
+   result.mSamples = samples;
+
+   result.mSuccess = (this->*method)(pDescriptor, result.mMessage);
+   for (unsigned int i = 0; i < mIterations && result.mSuccess; ++i)
+   {
+      double start = now();
+      result.mSuccess = (this->*method)(pDescriptor, result.mMessage);
+      result.mSeconds.push_back(now() - start);
+   }
+
+   addResult(result, NULL);
+}
+
+void BenchmarkSuite::runThreadCases()
+{
+   unsigned int maxThreads = max(ConfigurationSettings::getSettingThreadCount(), 1U);
+   for (unsigned int threadCount = 1; !isAborted(); threadCount = min(2 * threadCount, maxThreads))
+   {
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress("Running the threads cases with " +
+            StringUtilities::toDisplayString(threadCount) + " threads", 100, NORMAL);
+      }
+
+      runThreadCase("threads.balanced", false, false, threadCount);
+      runThreadCase("threads.imbalanced", true, false, threadCount);
+      runThreadCase("threads.nested", false, true, threadCount);
+      if (threadCount == maxThreads)
+      {
+         break;
+      }
+   }
+}
+
+void BenchmarkSuite::runThreadCase(const string& name, bool imbalanced, bool nested, unsigned int threadCount)
+{
+   if (mCases.find(name) == mCases.end() || isAborted())
+   {
+      return;
+   }
+
+   ScalingInput input;
+   input.mItems = (nested ? sNestedItems : sThreadItems);
+   input.mImbalanced = imbalanced;
+   input.mNested = nested;
+   input.mThreadCount = static_cast<int>(threadCount);
+
+   Result result;
+   result.mCase = name;
+   result.mEncoding = FLT8BYTES;
+   result.mInterleave = BSQ;
+   result.mPager = "memory";
+   result.mThreads = threadCount;
+   result.mSamples = static_cast<uint64_t>(input.mItems) * (nested ? sNestedItems : 1);
+
+   // The untimed first run starts the pool's workers
+   for (unsigned int i = 0; i <= mIterations; ++i)
+   {
+      ScalingOutput output;
+      double start = now();
+      mta::MultiThreadedAlgorithm<ScalingInput, ScalingOutput, ScalingThread>
+         alg(input.mThreadCount, input, output, NULL);
+      result.mSuccess = (alg.run() == mta::SUCCESS);
+      if (!result.mSuccess)
+      {
+         result.mMessage = alg.getErrorText();
+         break;
+      }
+
+      if (i > 0)
+      {
+         result.mSeconds.push_back(now() - start);
+      }
+
+      sChecksum += static_cast<unsigned int>(output.mSum);
+   }
+
+   addResult(result, NULL);
+}
+
+void BenchmarkSuite::runMessageLogCases()
+{
+   runMessageLogCase("messagelog.message", "Message");
+   runMessageLogCase("messagelog.batch", "Batch");
+   runMessageLogCase("messagelog.periodic", "Periodic");
+}
+
+void BenchmarkSuite::runMessageLogCase(const string& name, const string& durability)
+{
+   if (mCases.find(name) == mCases.end() || isAborted())
+   {
+      return;
+   }
+
+   if (mpProgress != NULL)
+   {
+      mpProgress->updateProgress("Running the " + name + " case", 100, NORMAL);
+   }
+
+   // A log is written through the journal for the durability setting when the log is created
+   Service<ConfigurationSettings> pSettings;
+   Service<MessageLogMgr> pLogMgr;
+   string logName = "Benchmark " + durability + " Log";
+   pSettings->setTemporarySetting("MessageLogMgr/JournalDurability", durability);
+   MessageLog* pLog = pLogMgr->getLog(logName);
+   if (pLog == NULL)
+   {
+      pLog = pLogMgr->createLog(logName);
+   }
+   pSettings->deleteTemporarySetting("MessageLogMgr/JournalDurability");
+
+   Result result;
+   result.mCase = name;
+   result.mEncoding = FLT8BYTES;
+   result.mInterleave = BSQ;
+   result.mPager = durability;
+   result.mSamples = sLogMessages;
+   if (pLog == NULL)
+   {
+      result.mMessage = "The message log could not be created.";
+      addResult(result, NULL);
+      return;
+   }
+
+   // The untimed first run starts the journal writer and grows the log to its steady state size
+   result.mSuccess = true;
+   for (unsigned int i = 0; i <= mIterations && result.mSuccess; ++i)
+   {
+      double start = now();
+      for (unsigned int message = 0; message < sLogMessages; ++message)
+      {
+         Message* pMessage = pLog->createMessage("Benchmark Message", "app",
+            "0B7E3C61-5A29-4F8D-9C14-6E2D8A1F4B57", false, false);
+         if (pMessage == NULL)
+         {
+            result.mSuccess = false;
+            result.mMessage = "The message could not be created.";
+            break;
+         }
+
+         pMessage->addProperty("Index", message);
+         pMessage->finalize();
+      }
+
+      if (i > 0 && result.mSuccess)
+      {
+         result.mSeconds.push_back(now() - start);
+      }
+   }
+
+   addResult(result, NULL);
+}
+
+void BenchmarkSuite::addResult(Result& result, const RasterElement* pElement)
+{
+   const RasterDataDescriptor* pDescriptor = NULL;
+   if (pElement != NULL)
+   {
+      pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   }
+
+   if (pDescriptor != NULL)
+   {
+      result.mSamples = static_cast<uint64_t>(pDescriptor->getRowCount()) * pDescriptor->getColumnCount() *
+         pDescriptor->getBandCount();
+      result.mBytes = result.mSamples * pDescriptor->getBytesPerElement();
+   }
+
+   if (!result.mSuccess && mpProgress != NULL)
+   {
+      mpProgress->updateProgress("The " + result.mCase + " case failed: " + result.mMessage, 0, WARNING);
+   }
+
+   sort(result.mSeconds.begin(), result.mSeconds.end());
+   mResults.push_back(result);
+}
+
+bool BenchmarkSuite::iterateRows(RasterElement* pElement, string& message)
+{
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   // Rows are read in the native interleave so this measures the pager rather than a conversion
+   InterleaveFormatType interleave = pDescriptor->getInterleaveFormat();
+   unsigned int passes = (interleave == BSQ ? pDescriptor->getBandCount() : 1);
+   unsigned int rows = pDescriptor->getRowCount();
+   unsigned int sum = 0;
+   for (unsigned int pass = 0; pass < passes; ++pass)
+   {
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(interleave);
+      if (interleave == BSQ)
+      {
+         DimensionDescriptor band = pDescriptor->getActiveBand(pass);
+         pRequest->setBands(band, band, 1);
+      }
+
+      DataAccessor accessor = pElement->getDataAccessor(pRequest.release());
+      for (unsigned int row = 0; row < rows; ++row)
+      {
+         if (!accessor.isValid())
+         {
+            message = "The data accessor is not valid.";
+            return false;
+         }
+
+         sum += checksum(accessor->getRow(), accessor->getRowSize());
+         accessor->nextRow();
+      }
+   }
+
+   sChecksum += sum;
+   return true;
+}
+
+bool BenchmarkSuite::iterateColumns(RasterElement* pElement, string& message)
+{
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   // Pixel by pixel BIP access is what most algorithms use, so this includes any interleave conversion
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setInterleaveFormat(BIP);
+   DataAccessor accessor = pElement->getDataAccessor(pRequest.release());
+
+   unsigned int rows = pDescriptor->getRowCount();
+   unsigned int columns = pDescriptor->getColumnCount();
+   size_t pixelSize = pDescriptor->getBandCount() * pDescriptor->getBytesPerElement();
+   unsigned int sum = 0;
+   for (unsigned int row = 0; row < rows; ++row)
+   {
+      for (unsigned int column = 0; column < columns; ++column)
+      {
+         if (!accessor.isValid())
+         {
+            message = "The data accessor is not valid.";
+            return false;
+         }
+
+         sum += checksum(accessor->getColumn(), pixelSize);
+         accessor->nextColumn();
+      }
+
+      accessor->nextRow();
+   }
+
+   sChecksum += sum;
+   return true;
+}
+
+bool BenchmarkSuite::readTiledWindow(RasterElement* pElement, string& message)
+{
+   return readWindow(pElement, true, message);
+}
+
+bool BenchmarkSuite::readRowWindow(RasterElement* pElement, string& message)
+{
+   return readWindow(pElement, false, message);
+}
+
+bool BenchmarkSuite::readGdalTiledWindow(RasterElement*, string& message)
+{
+   return readImportedWindow(true, message);
+}
+
+bool BenchmarkSuite::readGdalRowWindow(RasterElement*, string& message)
+{
+   return readImportedWindow(false, message);
+}
+
+bool BenchmarkSuite::readWindow(RasterElement* pElement, bool tiled, string& message)
+{
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   // The window is read in the native interleave, as the image tiles are, so the pager is not bypassed by a
+   // conversion. BIL requests and pagers without tiled support fall back to row strips.
+   InterleaveFormatType interleave = pDescriptor->getInterleaveFormat();
+   vector<DimensionDescriptor> columns = centerHalf(pDescriptor->getColumns());
+   if (columns.empty())
+   {
+      message = "The cube has no columns.";
+      return false;
+   }
+
+   unsigned int passes = (interleave == BSQ ? pDescriptor->getBandCount() : 1);
+   unsigned int rows = pDescriptor->getRowCount();
+   size_t rowBytes = columns.size() * pDescriptor->getBytesPerElement() *
+      (interleave == BSQ ? 1 : pDescriptor->getBandCount());
+   unsigned int sum = 0;
+   for (unsigned int pass = 0; pass < passes; ++pass)
+   {
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(interleave);
+      pRequest->setColumns(columns.front(), columns.back(), static_cast<unsigned int>(columns.size()));
+      pRequest->setTiled(tiled);
+      if (interleave == BSQ)
+      {
+         DimensionDescriptor band = pDescriptor->getActiveBand(pass);
+         pRequest->setBands(band, band, 1);
+      }
+
+      DataAccessor accessor = pElement->getDataAccessor(pRequest.release());
+      for (unsigned int row = 0; row < rows; ++row)
+      {
+         if (!accessor.isValid())
+         {
+            message = "The data accessor is not valid.";
+            return false;
+         }
+
+         sum += checksum(accessor->getRow(), rowBytes);
+         accessor->nextRow();
+      }
+   }
+
+   sChecksum += sum;
+   return true;
+}
+
+bool BenchmarkSuite::readImportedWindow(bool tiled, string& message)
+{
+   // Import the file on-disk each time so every run reads the file through an empty page cache
+   vector<DataElement*> elements;
+   RasterElement* pImported = importOnDisk("Generic GDAL Importer", mTileFilename, elements, message);
+   bool success = (pImported != NULL && readWindow(pImported, tiled, message));
+
+   Service<ModelServices> pModel;
+   for (vector<DataElement*>::iterator iter = elements.begin(); iter != elements.end(); ++iter)
+   {
+      pModel->destroyElement(*iter);
+   }
+
+   return success;
+}
+
+RasterElement* BenchmarkSuite::importOnDisk(const string& importerName, const string& filename,
+                                            vector<DataElement*>& elements, string& message)
+{
+   ImporterResource importer(importerName, filename, NULL, true);
+   vector<ImportDescriptor*> descriptors = importer->getImportDescriptors();
+   for (vector<ImportDescriptor*>::iterator iter = descriptors.begin(); iter != descriptors.end(); ++iter)
+   {
+      DataDescriptor* pDescriptor = (*iter)->getDataDescriptor();
+      (*iter)->setImported(iter == descriptors.begin());
+      if (pDescriptor != NULL)
+      {
+         pDescriptor->setProcessingLocation(ON_DISK_READ_ONLY);
+      }
+   }
+
+   if (descriptors.empty() || importer->execute() == false)
+   {
+      message = "The " + importerName + " failed.";
+      return NULL;
+   }
+
+   elements = importer->getImportedElements();
+   RasterElement* pImported = (elements.empty() ? NULL : dynamic_cast<RasterElement*>(elements.front()));
+   if (pImported == NULL)
+   {
+      message = "The " + importerName + " did not create a raster element.";
+   }
+
+   return pImported;
+}
+
+bool BenchmarkSuite::calculateStatistics(RasterElement* pElement, string& message)
+{
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   const vector<DimensionDescriptor>& bands = pDescriptor->getBands();
+   for (vector<DimensionDescriptor>::const_iterator band = bands.begin(); band != bands.end(); ++band)
+   {
+      Statistics* pStatistics = pElement->getStatistics(*band);
+      if (pStatistics == NULL)
+      {
+         message = "The statistics could not be obtained.";
+         return false;
+      }
+
+      // Setting the bad values discards the cached statistics so they are recalculated
+      pStatistics->setBadValues(pStatistics->getBadValues());
+      pStatistics->getAverage();
+      if (!pStatistics->areStatisticsCalculated())
+      {
+         message = "The statistics were not calculated.";
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool BenchmarkSuite::calculateBatchedStatistics(RasterElement* pElement, string& message)
+{
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   // Setting the bad values discards the cached statistics so they are recalculated
+   const vector<DimensionDescriptor>& bands = pDescriptor->getBands();
+   vector<Statistics*> statistics;
+   for (vector<DimensionDescriptor>::const_iterator band = bands.begin(); band != bands.end(); ++band)
+   {
+      Statistics* pStatistics = pElement->getStatistics(*band);
+      if (pStatistics == NULL)
+      {
+         message = "The statistics could not be obtained.";
+         return false;
+      }
+
+      pStatistics->setBadValues(pStatistics->getBadValues());
+      statistics.push_back(pStatistics);
+   }
+
+   pElement->calculateStatistics(bands);
+   for (vector<Statistics*>::const_iterator iter = statistics.begin(); iter != statistics.end(); ++iter)
+   {
+      if (!(*iter)->areStatisticsCalculated())
+      {
+         message = "The statistics were not calculated.";
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool BenchmarkSuite::runBandMath(RasterElement* pElement, string& message)
+{
+   ExecutableResource plugIn("Band Math", string(), NULL, true);
+   string expression = "b1 * b2 + sqrt(b1) - 2";
+   bool displayResults = false;
+   plugIn->getInArgList().setPlugInArgValue("Input Expression", &expression);
+   plugIn->getInArgList().setPlugInArgValue("Display Results", &displayResults);
+
+   return executeAlgorithm(plugIn, pElement, "Band Math Result", message);
+}
+
+bool BenchmarkSuite::runPca(RasterElement* pElement, string& message)
+{
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   ExecutableResource plugIn("Principal Component Analysis", string(), NULL, true);
+   bool useTransformFile = false;
+   string transformType = "Covariance";
+   int components = static_cast<int>(max(pDescriptor->getBandCount() / 2, 1U));
+   EncodingType outputEncoding = FLT4BYTES;
+   int maxScaleValue = 1000;
+   bool useAoi = false;
+   bool displayResults = false;
+   plugIn->getInArgList().setPlugInArgValue("Use Transform File", &useTransformFile);
+   plugIn->getInArgList().setPlugInArgValue("Transform Type", &transformType);
+   plugIn->getInArgList().setPlugInArgValue("Components", &components);
+   plugIn->getInArgList().setPlugInArgValue("Output Encoding Type", &outputEncoding);
+   plugIn->getInArgList().setPlugInArgValue("Max Scale Value", &maxScaleValue);
+   plugIn->getInArgList().setPlugInArgValue("Use AOI", &useAoi);
+   plugIn->getInArgList().setPlugInArgValue("Display Results", &displayResults);
+
+   return executeAlgorithm(plugIn, pElement, "Corrected Data Cube", message);
+}
+
+bool BenchmarkSuite::runCovariance(RasterElement* pElement, string& message)
+{
+   ExecutableResource plugIn("Covariance", string(), NULL, true);
+   bool recalculate = true;
+   bool computeInverse = false;
+   plugIn->getInArgList().setPlugInArgValue("Recalculate", &recalculate);
+   plugIn->getInArgList().setPlugInArgValue("ComputeInverse", &computeInverse);
+
+   return executeAlgorithm(plugIn, pElement, "Covariance Matrix", message);
+}
+
+bool BenchmarkSuite::runConvolution(RasterElement* pElement, string& message)
+{
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   ExecutableResource plugIn("Morphological Dilation", string(), NULL, true);
+   vector<unsigned int> bandNumbers;
+   for (unsigned int band = 0; band < pDescriptor->getBandCount(); ++band)
+   {
+      bandNumbers.push_back(band);
+   }
+
+   string resultName = pElement->getName() + " Dilation";
+   plugIn->getInArgList().setPlugInArgValue("Band Numbers", &bandNumbers);
+   plugIn->getInArgList().setPlugInArgValue("Result Name", &resultName);
+
+   return executeAlgorithm(plugIn, pElement, "Data Element", message);
+}
+
+bool BenchmarkSuite::createChip(RasterElement* pElement, string& message)
+{
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   RasterElement* pChip = pElement->createChip(pElement, " Chip", centerHalf(pDescriptor->getRows()),
+      centerHalf(pDescriptor->getColumns()));
+   if (pChip == NULL)
+   {
+      message = "The chip could not be created.";
+      return false;
+   }
+
+   return true;
+}
+
+bool BenchmarkSuite::exportElement(RasterElement* pElement, string& message)
+{
+   string filename = mTempDirectory + SLASH + "OpticksBenchmark.bsq";
+   FactoryResource<FileDescriptor> pFileDescriptor(
+      RasterUtilities::generateFileDescriptorForExport(pElement->getDataDescriptor(), filename));
+   if (pFileDescriptor.get() == NULL)
+   {
+      message = "The export file descriptor could not be created.";
+      return false;
+   }
+
+   bool success = false;
+   {
+      ExporterResource exporter("ENVI Exporter", pElement, pFileDescriptor.get(), NULL, true);
+      success = (exporter->getPlugIn() != NULL && exporter->execute());
+   }
+
+   QFile::remove(QString::fromStdString(filename));
+   QFile::remove(QString::fromStdString(filename + ".hdr"));
+   if (!success)
+   {
+      message = "The ENVI Exporter failed.";
+   }
+
+   return success;
+}
+
+bool BenchmarkSuite::exportGeoTiff(RasterElement* pElement, string& message)
+{
+   string filename = mTempDirectory + SLASH + "OpticksBenchmark.tif";
+   FactoryResource<FileDescriptor> pFileDescriptor(
+      RasterUtilities::generateFileDescriptorForExport(pElement->getDataDescriptor(), filename));
+   if (pFileDescriptor.get() == NULL)
+   {
+      message = "The export file descriptor could not be created.";
+      return false;
+   }
+
+   // The exporter reads its options from the settings when it is created
+   bool success = false;
+   {
+      ExporterResource exporter("GeoTIFF Exporter", pElement, pFileDescriptor.get(), NULL, true);
+      success = (exporter->getPlugIn() != NULL && exporter->execute());
+   }
+
+   mFileBytes = static_cast<uint64_t>(QFileInfo(QString::fromStdString(filename)).size());
+   QFile::remove(QString::fromStdString(filename));
+   if (!success)
+   {
+      message = "The GeoTIFF Exporter failed.";
+   }
+
+   return success;
+}
+
+bool BenchmarkSuite::readHdf5File(RasterElement*, string& message)
+{
+   // Import the file on-disk each time so every run decompresses the data
+   vector<DataElement*> elements;
+   RasterElement* pImported = importOnDisk("Ice Importer", mHdf5Filename, elements, message);
+   bool success = (pImported != NULL && iterateRows(pImported, message));
+
+   Service<ModelServices> pModel;
+   for (vector<DataElement*>::iterator iter = elements.begin(); iter != elements.end(); ++iter)
+   {
+      pModel->destroyElement(*iter);
+   }
+
+   return success;
+}
+
+bool BenchmarkSuite::transferDataChannel(RasterElement* pElement, string& message)
+{
+   // The element is read and then written back so it is unchanged by the case
+   QByteArray block;
+   DataChannelClient reader(pElement->getName(), sDataChannelRead, block);
+   if (!reader.exchange(message))
+   {
+      return false;
+   }
+
+   DataChannelClient writer(pElement->getName(), sDataChannelWrite, block);
+   return writer.exchange(message);
+}
+
+bool BenchmarkSuite::exportAndImport(RasterElement* pElement, string& message)
+{
+   // This is how a client moved data before the data channel, so the file is exported and read back
+   string filename = mTempDirectory + SLASH + "OpticksBenchmarkChannel.bsq";
+   FactoryResource<FileDescriptor> pFileDescriptor(
+      RasterUtilities::generateFileDescriptorForExport(pElement->getDataDescriptor(), filename));
+   if (pFileDescriptor.get() == NULL)
+   {
+      message = "The export file descriptor could not be created.";
+      return false;
+   }
+
+   bool success = false;
+   {
+      ExporterResource exporter("ENVI Exporter", pElement, pFileDescriptor.get(), NULL, true);
+      success = (exporter->getPlugIn() != NULL && exporter->execute());
+   }
+
+   if (success)
+   {
+      vector<DataElement*> elements;
+      RasterElement* pImported = importOnDisk("ENVI Importer", filename, elements, message);
+      success = (pImported != NULL && iterateRows(pImported, message));
+
+      Service<ModelServices> pModel;
+      for (vector<DataElement*>::iterator iter = elements.begin(); iter != elements.end(); ++iter)
+      {
+         pModel->destroyElement(*iter);
+      }
+   }
+   else
+   {
+      message = "The ENVI Exporter failed.";
+   }
+
+   QFile::remove(QString::fromStdString(filename));
+   QFile::remove(QString::fromStdString(filename + ".hdr"));
+   return success;
+}
+
+bool BenchmarkSuite::verifyDataChannel(RasterElement* pElement, string& message)
+{
+   QByteArray original;
+   DataChannelClient reader(pElement->getName(), sDataChannelRead, original);
+   if (!reader.exchange(message) || !compareBlock(pElement, original, message))
+   {
+      return false;
+   }
+
+   // Inverting every byte changes every sample regardless of the encoding
+   QByteArray inverted(original);
+   for (int i = 0; i < inverted.size(); ++i)
+   {
+      inverted[i] = static_cast<char>(~inverted[i]);
+   }
+
+   DataChannelClient writer(pElement->getName(), sDataChannelWrite, inverted);
+   bool success = writer.exchange(message) && compareBlock(pElement, inverted, message);
+
+   DataChannelClient restorer(pElement->getName(), sDataChannelWrite, original);
+   return restorer.exchange(message) && success;
+}
+
+bool BenchmarkSuite::compareBlock(RasterElement* pElement, const QByteArray& block, string& message)
+{
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   // The block is band sequential, so compare it pixel by pixel through a BIP accessor
+   unsigned int rows = pDescriptor->getRowCount();
+   unsigned int columns = pDescriptor->getColumnCount();
+   unsigned int bands = pDescriptor->getBandCount();
+   size_t bytesPerElement = pDescriptor->getBytesPerElement();
+   size_t bandBytes = static_cast<size_t>(rows) * columns * bytesPerElement;
+   if (static_cast<size_t>(block.size()) != bandBytes * bands)
+   {
+      message = "The data channel returned a block of the wrong size.";
+      return false;
+   }
+
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setInterleaveFormat(BIP);
+   DataAccessor accessor = pElement->getDataAccessor(pRequest.release());
+   for (unsigned int row = 0; row < rows; ++row)
+   {
+      for (unsigned int column = 0; column < columns; ++column)
+      {
+         if (!accessor.isValid())
+         {
+            message = "The data accessor is not valid.";
+            return false;
+         }
+
+         const char* pPixel = reinterpret_cast<const char*>(accessor->getColumn());
+         const char* pSample = block.constData() + (static_cast<size_t>(row) * columns + column) * bytesPerElement;
+         for (unsigned int band = 0; band < bands; ++band)
+         {
+            if (memcmp(pPixel + band * bytesPerElement, pSample + band * bandBytes, bytesPerElement) != 0)
+            {
+               message = "The data channel block does not match the " +
+                  StringUtilities::toXmlString(pDescriptor->getInterleaveFormat()) + " raster element.";
+               return false;
+            }
+         }
+
+         accessor->nextColumn();
+      }
+
+      accessor->nextRow();
+   }
+
+   return true;
+}
+
+bool BenchmarkSuite::createImportDescriptors(const string& filename, string& message)
+{
+   // The import descriptors are owned by the import agent and destroyed with it
+   ImporterResource importer("Auto Importer", filename, NULL, true);
+   if (importer->getImportDescriptors().empty())
+   {
+      message = "No import descriptors were created for " + filename + ".";
+      return false;
+   }
+
+   return true;
+}
+
+bool BenchmarkSuite::hitObjects(GraphicLayer* pLayer, string&)
+{
+   // Most of the points miss every object so the search cannot stop early
+   unsigned int state = 1;
+   unsigned int hits = 0;
+   for (unsigned int i = 0; i < sHitTests; ++i)
+   {
+      LocationType point(nextRandom(state) * mColumns, nextRandom(state) * mRows);
+      if (pLayer->hit(point) != NULL)
+      {
+         ++hits;
+      }
+   }
+
+   sChecksum += hits;
+   return true;
+}
+
+bool BenchmarkSuite::drawObjects(GraphicLayer* pLayer, string& message)
+{
+   // Rendering the current image draws a complete frame synchronously
+   QImage image;
+   View* pView = pLayer->getView();
+   if (pView == NULL || pView->getCurrentImage(image) == false)
+   {
+      message = "The view could not be drawn.";
+      return false;
+   }
+
+   return true;
+}
+
+bool BenchmarkSuite::lookupRows(RasterDataDescriptor* pDescriptor, string& message)
+{
+   unsigned int rows = pDescriptor->getRowCount();
+   unsigned int sum = 0;
+   for (unsigned int row = 0; row < rows; ++row)
+   {
+      DimensionDescriptor activeRow = pDescriptor->getActiveRow(row);
+      DimensionDescriptor originalRow = pDescriptor->getOriginalRow(activeRow.getOriginalNumber());
+      DimensionDescriptor onDiskRow = pDescriptor->getOnDiskRow(activeRow.getOnDiskNumber());
+      if (originalRow != activeRow || onDiskRow != activeRow)
+      {
+         message = "Row " + StringUtilities::toDisplayString(row) + " was not found.";
+         return false;
+      }
+
+      sum += onDiskRow.getActiveNumber();
+   }
+
+   sChecksum += sum;
+   return true;
+}
+
+bool BenchmarkSuite::copyDescriptor(RasterDataDescriptor* pDescriptor, string& message)
+{
+   DataDescriptorResource<RasterDataDescriptor> pCopy(
+      dynamic_cast<RasterDataDescriptor*>(pDescriptor->copy("Benchmark Descriptor Copy", NULL)));
+   if (pCopy.get() == NULL || pCopy->getRowCount() != pDescriptor->getRowCount())
+   {
+      message = "The descriptor could not be copied.";
+      return false;
+   }
+
+   return true;
+}
+
+bool BenchmarkSuite::executeAlgorithm(ExecutableResource& plugIn, RasterElement* pElement,
+                                      const string& outputArg, string& message)
+{
+   if (plugIn->getPlugIn() == NULL)
+   {
+      message = "The plug-in is not available.";
+      return false;
+   }
+
+   plugIn->getInArgList().setPlugInArgValue(Executable::DataElementArg(), pElement);
+   if (!plugIn->execute())
+   {
+      message = "The " + plugIn->getPlugIn()->getName() + " plug-in failed.";
+      return false;
+   }
+
+   // Results of the processing cases are parented to the input so destroyChildren() cleans them up,
+   // but some plug-ins create their result at the top level
+   RasterElement* pResult = plugIn->getOutArgList().getPlugInArgValue<RasterElement>(outputArg);
+   if (pResult == NULL)
+   {
+      message = "The " + plugIn->getPlugIn()->getName() + " plug-in did not create a result.";
+      return false;
+   }
+
+   if (pResult->getParent() != pElement)
+   {
+      Service<ModelServices>()->destroyElement(pResult);
+   }
+
+   return true;
+}
+
+void BenchmarkSuite::destroyChildren(RasterElement* pElement)
+{
+   Service<ModelServices> pModel;
+   vector<DataElement*> children = pModel->getElements(pElement, string());
+   for (vector<DataElement*>::iterator iter = children.begin(); iter != children.end(); ++iter)
+   {
+      pModel->destroyElement(*iter);
+   }
+}
+
+void BenchmarkSuite::writeResults(ostream& output) const
+{
+   output << setprecision(9);
+   output << "{" << endl;
+   output << "   \"version\": \"" << escapeJson(APP_VERSION_NUMBER) << "\"," << endl;
+   output << "   \"rows\": " << mRows << "," << endl;
+   output << "   \"columns\": " << mColumns << "," << endl;
+   output << "   \"bands\": " << mBands << "," << endl;
+   output << "   \"iterations\": " << mIterations << "," << endl;
+   output << "   \"results\": [";
+   for (vector<Result>::const_iterator iter = mResults.begin(); iter != mResults.end(); ++iter)
+   {
+      const Result& result = *iter;
+      output << (iter == mResults.begin() ? "" : ",") << endl;
+      output << "      {" << endl;
+      output << "         \"case\": \"" << escapeJson(result.mCase) << "\"," << endl;
+      if (result.mFile.empty())
+      {
+         output << "         \"encoding\": \"" << StringUtilities::toXmlString(result.mEncoding) << "\"," << endl;
+         output << "         \"interleave\": \"" << StringUtilities::toXmlString(result.mInterleave) << "\"," <<
+            endl;
+         output << "         \"pager\": \"" << escapeJson(result.mPager) << "\"," << endl;
+         if (result.mObjects > 0)
+         {
+            output << "         \"objects\": " << result.mObjects << "," << endl;
+         }
+
+         if (result.mThreads > 0)
+         {
+            output << "         \"threads\": " << result.mThreads << "," << endl;
+         }
+      }
+      else
+      {
+         output << "         \"file\": \"" << escapeJson(result.mFile) << "\"," << endl;
+      }
+
+      output << "         \"success\": " << (result.mSuccess ? "true" : "false") << "," << endl;
+      if (!result.mMessage.empty())
+      {
+         output << "         \"message\": \"" << escapeJson(result.mMessage) << "\"," << endl;
+      }
+
+      output << "         \"bytes\": " << result.mBytes << "," << endl;
+      if (result.mFileBytes > 0)
+      {
+         output << "         \"fileBytes\": " << result.mFileBytes << "," << endl;
+      }
+
+      output << "         \"samples\": " << result.mSamples << "," << endl;
+      output << "         \"runs\": " << result.mSeconds.size();
+      if (!result.mSeconds.empty())
+      {
+         double total = 0.0;
+         for (vector<double>::const_iterator seconds = result.mSeconds.begin();
+            seconds != result.mSeconds.end(); ++seconds)
+         {
+            total += *seconds;
+         }
+
+         double median = percentile(result.mSeconds, 0.5);
+         output << "," << endl;
+         output << "         \"seconds\": {" << endl;
+         output << "            \"min\": " << result.mSeconds.front() << "," << endl;
+         output << "            \"p50\": " << median << "," << endl;
+         output << "            \"p90\": " << percentile(result.mSeconds, 0.9) << "," << endl;
+         output << "            \"p99\": " << percentile(result.mSeconds, 0.99) << "," << endl;
+         output << "            \"max\": " << result.mSeconds.back() << "," << endl;
+         output << "            \"mean\": " << total / result.mSeconds.size() << endl;
+         output << "         }," << endl;
+
+         // Throughput uses the median so a single slow run does not skew comparisons
+         double megabytes = static_cast<double>(result.mBytes) / (1024.0 * 1024.0);
+         output << "         \"megabytesPerSecond\": " << (median > 0.0 ? megabytes / median : 0.0) << "," << endl;
+         output << "         \"samplesPerSecond\": " <<
+            (median > 0.0 ? static_cast<double>(result.mSamples) / median : 0.0);
+      }
+
+      output << endl << "      }";
+   }
+
+   output << endl << "   ]" << endl;
+   output << "}" << endl;
+}
+
+double BenchmarkSuite::now()
+{
+#if defined(WIN_API)
+   LARGE_INTEGER frequency;
+   LARGE_INTEGER counter;
+   QueryPerformanceFrequency(&frequency);
+   QueryPerformanceCounter(&counter);
+   return static_cast<double>(counter.QuadPart) / static_cast<double>(frequency.QuadPart);
+#else
+   timespec time;
+   clock_gettime(CLOCK_MONOTONIC, &time);
+   return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+#endif
+}
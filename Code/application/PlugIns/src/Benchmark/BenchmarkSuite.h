@@ -0,0 +1,189 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef BENCHMARKSUITE_H
+#define BENCHMARKSUITE_H
+
+#include "AppConfig.h"
+#include "ExecutableShell.h"
+#include "SpectralLibraryMatcher.h"
+#include "TypesFile.h"
+
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+class DataElement;
+class QByteArray;
+class ExecutableResource;
+class GraphicLayer;
+class Progress;
+class RasterDataDescriptor;
+class RasterElement;
+
+/**
+ *  Times common data access and processing paths against synthetic cubes.
+ *
+ *  A cube is generated for every combination of encoding, interleave and pager
+ *  and each selected case is run a fixed number of times against it. The results
+ *  are written as JSON with the distribution of the run times and the throughput
+ *  so runs from different builds can be compared. The suite is intended to be run
+ *  headless with the batch processor's benchmark option.
+ *
+ *  Cases which only depend on the pager (row and column iteration) run against every
+ *  encoding. The accessor.tiles case reads the center half of the columns of every row
+ *  with a tiled request and with a row strip request, against the generated cubes and
+ *  against the single precision floating point cube exported as a tiled GeoTIFF and
+ *  imported on-disk through the GDAL pager each run, so column windowed paging through
+ *  the memory mapped pager and the page cache can be compared with full row strips. The
+ *  processing cases run against a single precision floating point cube for each
+ *  interleave and pager. The statistics case calculates the statistics of each band in
+ *  turn and the statistics.batched case calculates all of the bands of the band
+ *  sequential and band interleaved by pixel cubes together. The hdf5.deflate case exports that cube to a deflate
+ *  compressed ICE file and reads it back through the HDF5 pager, with and without chunk
+ *  aligned reads. The geotiff case exports that cube with the GeoTIFF exporter in strips
+ *  and in compressed tiles with and without overviews, and reports the size of each file
+ *  so the write throughput and compression can be compared. The graphics cases display
+ *  the band sequential in-memory cube and time hit tests and rendering of annotation
+ *  layers with an increasing number of objects, so they are only run in interactive
+ *  mode. The match cases find the best signatures in synthetic spectral libraries of
+ *  increasing size for a block of pixels of the band interleaved by pixel in-memory
+ *  cube, and report the spectrum and signature pairs compared per second as the samples.
+ *  The descriptor cases look up every row of a one million row descriptor by its
+ *  original, on-disk and active numbers and copy the descriptor. The threads cases run a
+ *  synthetic multi-threaded algorithm with one thread and then doubling numbers of
+ *  threads up to the thread count setting, with evenly spread work, with all of the work
+ *  in the last quarter of the items as with a small AOI, and with an algorithm nested in
+ *  each item, so the scaling of the thread pool can be compared. The messagelog cases log
+ *  finalized messages to a log created with each journal durability setting and report
+ *  the messages logged per second, so the overhead of each policy on the logging thread
+ *  can be compared. The datachannel case starts an XML-RPC data channel and reads each
+ *  single precision floating point in-memory cube through it and writes it back, after
+ *  checking that a written block matches the cube, and compares that with exporting the
+ *  cube to an ENVI file and reading it back. The import cases run against each of the
+ *  sample files instead of the generated cubes.
+ */
+class BenchmarkSuite : public ExecutableShell
+{
+public:
+   BenchmarkSuite();
+   ~BenchmarkSuite();
+
+   bool getInputSpecification(PlugInArgList*& pInArgList);
+   bool getOutputSpecification(PlugInArgList*& pOutArgList);
+   bool execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList);
+
+   /**
+    *  Returns the names of all of the cases which can be selected with the "Cases" argument.
+    */
+   static const std::vector<std::string>& getCaseNames();
+
+private:
+   BenchmarkSuite(const BenchmarkSuite& rhs);
+   BenchmarkSuite& operator=(const BenchmarkSuite& rhs);
+
+   struct Result
+   {
+      Result() : mSuccess(false), mBytes(0), mSamples(0), mObjects(0), mThreads(0), mFileBytes(0) {}
+
+      std::string mCase;
+      EncodingType mEncoding;
+      InterleaveFormatType mInterleave;
+      std::string mPager;
+      std::string mFile;
+      bool mSuccess;
+      std::string mMessage;
+      uint64_t mBytes;
+      uint64_t mSamples;
+      unsigned int mObjects;
+      unsigned int mThreads;
+      uint64_t mFileBytes;
+      std::vector<double> mSeconds;
+   };
+
+   typedef bool (BenchmarkSuite::*CaseMethod)(RasterElement* pElement, std::string& message);
+   typedef bool (BenchmarkSuite::*FileCaseMethod)(const std::string& filename, std::string& message);
+   typedef bool (BenchmarkSuite::*GraphicsCaseMethod)(GraphicLayer* pLayer, std::string& message);
+   typedef bool (BenchmarkSuite::*DescriptorCaseMethod)(RasterDataDescriptor* pDescriptor, std::string& message);
+
+   void runCase(const std::string& name, CaseMethod method, RasterElement* pElement, const std::string& pager);
+   void runFileCase(const std::string& name, FileCaseMethod method, const std::string& filename);
+   void runHdf5Cases(RasterElement* pElement);
+   void runGeoTiffCases(RasterElement* pElement);
+   void runTileCases(RasterElement* pElement);
+   void runDataChannelCases(RasterElement* pElement);
+   void runGraphicsCases(RasterElement* pElement);
+   void runGraphicsCase(const std::string& name, GraphicsCaseMethod method, GraphicLayer* pLayer,
+      RasterElement* pElement, unsigned int objectCount, unsigned int samples);
+   void runMatchCases(RasterElement* pElement);
+   void runDescriptorCases();
+   void runDescriptorCase(const std::string& name, DescriptorCaseMethod method, RasterDataDescriptor* pDescriptor,
+      uint64_t samples);
+   void runThreadCases();
+   void runThreadCase(const std::string& name, bool imbalanced, bool nested, unsigned int threadCount);
+   void runMessageLogCases();
+   void runMessageLogCase(const std::string& name, const std::string& durability);
+   void runMatchCase(const std::string& name, SpectralLibraryMatcher::MetricType metric,
+      SpectralLibraryMatcher& matcher, RasterElement* pElement, const std::vector<Opticks::PixelLocation>& pixels);
+   void addResult(Result& result, const RasterElement* pElement);
+
+   bool iterateRows(RasterElement* pElement, std::string& message);
+   bool iterateColumns(RasterElement* pElement, std::string& message);
+   bool readTiledWindow(RasterElement* pElement, std::string& message);
+   bool readRowWindow(RasterElement* pElement, std::string& message);
+   bool readGdalTiledWindow(RasterElement* pElement, std::string& message);
+   bool readGdalRowWindow(RasterElement* pElement, std::string& message);
+   bool calculateStatistics(RasterElement* pElement, std::string& message);
+   bool calculateBatchedStatistics(RasterElement* pElement, std::string& message);
+   bool runBandMath(RasterElement* pElement, std::string& message);
+   bool runPca(RasterElement* pElement, std::string& message);
+   bool runCovariance(RasterElement* pElement, std::string& message);
+   bool runConvolution(RasterElement* pElement, std::string& message);
+   bool createChip(RasterElement* pElement, std::string& message);
+   bool exportElement(RasterElement* pElement, std::string& message);
+   bool readHdf5File(RasterElement* pElement, std::string& message);
+   bool transferDataChannel(RasterElement* pElement, std::string& message);
+   bool exportAndImport(RasterElement* pElement, std::string& message);
+   bool exportGeoTiff(RasterElement* pElement, std::string& message);
+   bool createImportDescriptors(const std::string& filename, std::string& message);
+   bool hitObjects(GraphicLayer* pLayer, std::string& message);
+   bool drawObjects(GraphicLayer* pLayer, std::string& message);
+   bool lookupRows(RasterDataDescriptor* pDescriptor, std::string& message);
+   bool copyDescriptor(RasterDataDescriptor* pDescriptor, std::string& message);
+
+   bool readWindow(RasterElement* pElement, bool tiled, std::string& message);
+   bool readImportedWindow(bool tiled, std::string& message);
+   bool verifyDataChannel(RasterElement* pElement, std::string& message);
+   bool compareBlock(RasterElement* pElement, const QByteArray& block, std::string& message);
+   RasterElement* importOnDisk(const std::string& importerName, const std::string& filename,
+      std::vector<DataElement*>& elements, std::string& message);
+   bool executeAlgorithm(ExecutableResource& plugIn, RasterElement* pElement, const std::string& outputArg,
+      std::string& message);
+   void destroyChildren(RasterElement* pElement);
+
+   void writeResults(std::ostream& output) const;
+
+   static double now();
+
+   Progress* mpProgress;
+   std::set<std::string> mCases;
+   unsigned int mRows;
+   unsigned int mColumns;
+   unsigned int mBands;
+   unsigned int mIterations;
+   std::string mTempDirectory;
+   std::string mHdf5Filename;
+   std::string mTileFilename;
+   uint64_t mFileBytes;
+   std::vector<std::string> mSampleFiles;
+   std::vector<Result> mResults;
+};
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "ComplexData.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "ModelServices.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterUtilities.h"
+#include "switchOnEncoding.h"
+#include "SyntheticCube.h"
+
+#include <limits>
+#include <math.h>
+
+using namespace std;
+
+namespace
+{
+   // Value ranges match the CubeCreator tool so generated cubes can be compared with files it writes
+   template<typename T>
+   double getMin(T)
+   {
+      return numeric_limits<T>::min();
+   }
+
+   template<typename T>
+   double getMax(T)
+   {
+      return numeric_limits<T>::max();
+   }
+
+   double getMin(float)
+   {
+      return 0.0;
+   }
+
+   double getMax(float)
+   {
+      return 10000.0;
+   }
+
+   double getMin(double)
+   {
+      return 0.0;
+   }
+
+   double getMax(double)
+   {
+      return 1.0;
+   }
+
+   template<typename T>
+   T getValue(unsigned int row, unsigned int column, unsigned int band, unsigned int totalRows,
+      unsigned int totalColumns, bool useSin = true)
+   {
+      // CubeCreator uses this approximation rather than PI, so keep it for identical data
+      static const double sPi = 3.1415927;
+      double x = static_cast<double>(band + 1) * sPi * static_cast<double>(column) / static_cast<double>(totalColumns);
+      double y = static_cast<double>((row * (band + 1)) % totalRows) / static_cast<double>(totalRows);
+      x = (useSin ? sin(x) : cos(x));
+      x *= x;
+
+      T defaultValue = 0;
+      return static_cast<T>(x * y * (getMax(defaultValue) - getMin(defaultValue)) + getMin(defaultValue));
+   }
+
+   template<>
+   IntegerComplex getValue<IntegerComplex>(unsigned int row, unsigned int column, unsigned int band,
+      unsigned int totalRows, unsigned int totalColumns, bool)
+   {
+      return IntegerComplex(getValue<short>(row, column, band, totalRows, totalColumns, true),
+         getValue<short>(row, column, band, totalRows, totalColumns, false));
+   }
+
+   template<>
+   FloatComplex getValue<FloatComplex>(unsigned int row, unsigned int column, unsigned int band,
+      unsigned int totalRows, unsigned int totalColumns, bool)
+   {
+      return FloatComplex(getValue<float>(row, column, band, totalRows, totalColumns, true),
+         getValue<float>(row, column, band, totalRows, totalColumns, false));
+   }
+
+   template<typename T>
+   bool fillCube(T*, RasterElement* pElement)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      VERIFY(pDescriptor != NULL);
+
+      unsigned int rows = pDescriptor->getRowCount();
+      unsigned int columns = pDescriptor->getColumnCount();
+      unsigned int bands = pDescriptor->getBandCount();
+      InterleaveFormatType interleave = pDescriptor->getInterleaveFormat();
+
+      // Write in the native interleave of the element so no conversion pager is involved
+      unsigned int passes = (interleave == BSQ ? bands : 1);
+      for (unsigned int pass = 0; pass < passes; ++pass)
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(interleave);
+         pRequest->setWritable(true);
+         if (interleave == BSQ)
+         {
+            DimensionDescriptor band = pDescriptor->getActiveBand(pass);
+            pRequest->setBands(band, band, 1);
+         }
+
+         DataAccessor accessor = pElement->getDataAccessor(pRequest.release());
+         for (unsigned int row = 0; row < rows; ++row)
+         {
+            VERIFY(accessor.isValid());
+            T* pRow = static_cast<T*>(accessor->getRow());
+            for (unsigned int column = 0; column < columns; ++column)
+            {
+               if (interleave == BSQ)
+               {
+                  pRow[column] = getValue<T>(row, column, pass, rows, columns);
+               }
+               else
+               {
+                  for (unsigned int band = 0; band < bands; ++band)
+                  {
+                     unsigned int offset = (interleave == BIP ? column * bands + band : band * columns + column);
+                     pRow[offset] = getValue<T>(row, column, band, rows, columns);
+                  }
+               }
+            }
+
+            accessor->nextRow();
+         }
+      }
+
+      pElement->updateData();
+      return true;
+   }
+}
+
+RasterElement* SyntheticCube::create(const string& name, unsigned int rows, unsigned int columns,
+                                     unsigned int bands, EncodingType encoding, InterleaveFormatType interleave,
+                                     bool inMemory, DataElement* pParent)
+{
+   if (rows == 0 || columns == 0 || bands == 0)
+   {
+      return NULL;
+   }
+
+   ModelResource<RasterElement> pElement(RasterUtilities::createRasterElement(name, rows, columns, bands,
+      encoding, interleave, inMemory, pParent));
+   if (pElement.get() == NULL)
+   {
+      return NULL;
+   }
+
+   bool success = false;
+   switchOnComplexEncoding(encoding, success = fillCube, NULL, pElement.get());
+   if (success == false)
+   {
+      return NULL;
+   }
+
+   return pElement.release();
+}
@@ -0,0 +1,53 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SYNTHETICCUBE_H
+#define SYNTHETICCUBE_H
+
+#include "TypesFile.h"
+
+#include <string>
+
+class DataElement;
+class RasterElement;
+
+namespace SyntheticCube
+{
+   /**
+    *  Creates a RasterElement filled with the same deterministic pattern as the CubeCreator tool.
+    *
+    *  Each band is a squared sinusoid across the columns scaled by a ramp down the rows,
+    *  so the band statistics differ and repeated runs produce identical data.
+    *
+    *  @param   name
+    *           The name of the new element.
+    *  @param   rows
+    *           The number of rows.
+    *  @param   columns
+    *           The number of columns.
+    *  @param   bands
+    *           The number of bands.
+    *  @param   encoding
+    *           The data type of the element.
+    *  @param   interleave
+    *           The interleave of the element.
+    *  @param   inMemory
+    *           If \c true, the data is held in memory. Otherwise it is paged
+    *           from a memory mapped temporary file.
+    *  @param   pParent
+    *           The parent of the new element.
+    *
+    *  @return  The new element or \c NULL if it could not be created and filled.
+    *           The caller takes ownership of the element.
+    */
+   RasterElement* create(const std::string& name, unsigned int rows, unsigned int columns, unsigned int bands,
+      EncodingType encoding, InterleaveFormatType interleave, bool inMemory, DataElement* pParent = NULL);
+}
+
+#endif
@@ -303,11 +303,12 @@ ConvolutionFilterShell::ConvolutionFilterThread::ConvolutionFilterThread(const C
                                                                          mta::ThreadReporter &reporter) :
                mta::AlgorithmThread(threadIndex, reporter),
                mInput(input),
-               mRowRange(getThreadRange(threadCount, input.mpIterCheck->getNumSelectedRows()))
+               mThreadCount(threadCount),
+               mRowCount(input.mpIterCheck->getNumSelectedRows())
 {
    if (input.mpIterCheck->useAllPixels())
    {
-      mRowRange = getThreadRange(threadCount, input.mpDescriptor->getRowCount());
+      mRowCount = static_cast<int>(input.mpDescriptor->getRowCount());
    }
 }
 
@@ -315,7 +316,17 @@ void ConvolutionFilterShell::ConvolutionFilterThread::run()
 {
    EncodingType encoding = static_cast<const RasterDataDescriptor*>(
          mInput.mpRaster->getDataDescriptor())->getDataType();
-   switchOnComplexEncoding(encoding, convolve, NULL);
+
+   // Rows outside an AOI are skipped, so the rows are taken in chunks to keep the threads balanced
+   while (getNextRange(mThreadCount, mRowCount, mRowRange))
+   {
+      if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
+      {
+         break;
+      }
+
+      switchOnComplexEncoding(encoding, convolve, NULL);
+   }
 }
 
 template<class T>
@@ -352,7 +363,6 @@ void ConvolutionFilterShell::ConvolutionFilterThread::convolve(const T*)
          return;
       }
 
-      int oldPercentDone = -1;
       int rowOffset = static_cast<int>(mInput.mpIterCheck->getOffset().mY);
       int startRow = mRowRange.mFirst + rowOffset;
       int stopRow = mRowRange.mLast + rowOffset;
@@ -378,15 +388,8 @@ void ConvolutionFilterShell::ConvolutionFilterThread::convolve(const T*)
       }
 
       Service<ModelServices> pModel;
-      int numRows = stopRow - startRow + 1;
       for (int row_index = startRow; row_index <= stopRow; ++row_index)
       {
-         int percentDone = 100 * ((bandNum * numRows) + (row_index - startRow)) / (numRows * bandCount); 
-         if (percentDone > oldPercentDone)
-         {
-            oldPercentDone = percentDone;
-            getReporter().reportProgress(getThreadIndex(), percentDone);
-         }
          if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
          {
             break;
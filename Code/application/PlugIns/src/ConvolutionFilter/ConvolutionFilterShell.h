@@ -80,6 +80,8 @@ protected:
 
       template<typename T> void convolve(const T*);
       const ConvolutionFilterThreadInput& mInput;
+      int mThreadCount;
+      int mRowCount;
       mta::AlgorithmThread::Range mRowRange;
    };
 
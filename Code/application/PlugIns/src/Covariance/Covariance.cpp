@@ -26,10 +26,10 @@
 #include "PlugInArgList.h"
 #include "PlugInRegistration.h"
 #include "RasterDataDescriptor.h"
+#include "RasterTileProcessor.h"
 #include "RasterUtilities.h"
 #include "Covariance.h"
 #include "CovarianceGui.h"
-#include "switchOnEncoding.h"
 #include "TypeConverter.h"
 
 #include <algorithm>
@@ -38,325 +38,212 @@
 using namespace std;
 
 const string CovarianceAlgorithm::mExpectedFileHeader = "Covariance Matrix File v1.1\n";
-static bool** CopySelectedPixels(const bool** pSelectedPixels, int xsize, int ysize);
-static void DeleteSelectedPixels(bool** pSelectedPixels);
-
-struct MaskInput
-{
-   double* pMatrix;
-   int numRows;
-   int numCols;
-   int numBands;
-   Progress* pProgress;
-   const bool* pAbortFlag;
-   const bool** pSelectedPixels;
-   int boundingBoxX1;
-   int boundingBoxY1;
-   int boundingBoxX2;
-   int boundingBoxY2;
-   const BitMask* mpMask;
-
-};
-
-template<class T>
-T* GetRowPtr(T* raw, int numCols, int numBands, int row, int col)
-{
-   return raw + numBands * (row *numCols + col);
-}
-
-template<class T>
-void ComputeFactoredCov(T* pData, RasterElement* pRaster, double* pMatrix,
-                        Progress* pProgress, const bool* pAbortFlag,
-                        int rowFactor, int columnFactor)
+namespace
 {
-   if (pRaster == NULL)
-   {
-      return;
-   }
-   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
-   if (pDescriptor == NULL)
+   /**
+    * Base class of the kernels which only process every rowFactor'th row and columnFactor'th column.
+    */
+   class FactoredKernel
    {
-      return;
-   }
+   public:
+      FactoredKernel(int rowFactor, int columnFactor) :
+         mRowFactor(static_cast<unsigned int>(max(rowFactor, 1))),
+         mColumnFactor(static_cast<unsigned int>(max(columnFactor, 1)))
+      {}
 
-   unsigned int numRows = pDescriptor->getRowCount();
-   unsigned int numCols = pDescriptor->getColumnCount();
-   unsigned int numBands = pDescriptor->getBandCount();
-   unsigned int row, col;
-   unsigned int band1, band2;
-   unsigned int lCount = 0;
+   protected:
+      template<typename T>
+      unsigned int getFirstRow(const RasterTileSet<T>& tiles) const
+      {
+         return (mRowFactor - tiles.getFirstRow() % mRowFactor) % mRowFactor;
+      }
 
-   T *pPixel = NULL;
-   vector<double> averages(numBands, 0);
-   double* pAverage = &averages.front();
+      unsigned int mRowFactor;
+      unsigned int mColumnFactor;
+   };
 
-   if (rowFactor < 1)
+   /**
+    * Sums the bands of the processed pixels.
+    */
+   class SumKernel : public FactoredKernel
    {
-      rowFactor = 1;
-   }
-   if (columnFactor < 1)
-   {
-      columnFactor = 1;
-   }
-
-   memset(pMatrix, 0, sizeof(double) * numBands * numBands);
+   public:
+      struct State
+      {
+         explicit State(unsigned int bandCount) :
+            mSums(bandCount, 0.0),
+            mCount(0)
+         {}
 
-   // calculate average spectrum
-   float progScale = 100.0f * static_cast<float>(rowFactor)/static_cast<float>(numRows);
-   FactoryResource<DataRequest> pRequest;
-   pRequest->setInterleaveFormat(BIP);
+         vector<double> mSums;
+         unsigned int mCount;
+      };
 
-   DataAccessor accessor = pRaster->getDataAccessor(pRequest.release());
+      SumKernel(int rowFactor, int columnFactor) :
+         FactoredKernel(rowFactor, columnFactor)
+      {}
 
-   for (row = 0; row < numRows; row += rowFactor)
-   {
-      if (pProgress != NULL)
+      template<typename T>
+      void operator()(const RasterTileSet<T>& tiles, State& state) const
       {
-         if ((pAbortFlag == NULL) || !(*pAbortFlag))
+         RasterTile<const T> pixels = tiles.getInput();
+         unsigned int bandCount = pixels.getBandCount();
+         for (unsigned int row = getFirstRow(tiles); row < tiles.getRowCount(); row += mRowFactor)
          {
-            pProgress->updateProgress ("Computing Average Signature...", int(progScale*row), NORMAL);
-         }
-         else
-         {
-            break;
+            for (unsigned int column = 0; column < tiles.getColumnCount(); column += mColumnFactor)
+            {
+               if (tiles.isSelected(row, column))
+               {
+                  for (unsigned int band = 0; band < bandCount; ++band)
+                  {
+                     state.mSums[band] += pixels(row, column, band);
+                  }
+
+                  ++state.mCount;
+               }
+            }
          }
       }
-      for (col = 0; col < numCols; col += columnFactor)
-      {
-         accessor->toPixel(row, col);
-         VERIFYNRV(accessor.isValid());
-         ++lCount;
-         pPixel = reinterpret_cast<T*>(accessor->getColumn());
 
-         for (band1 = 0; band1 < numBands; ++band1)
+      void merge(State& total, const State& state) const
+      {
+         for (vector<double>::size_type band = 0; band < total.mSums.size(); ++band)
          {
-            pAverage[band1] += *pPixel;
-            ++pPixel;
+            total.mSums[band] += state.mSums[band];
          }
-      }
-   }
 
+         total.mCount += state.mCount;
+      }
+   };
 
-   // check if aborted
-   if ((pAbortFlag == NULL) || !(*pAbortFlag))
+   /**
+    * Sums the products of the differences of the processed pixels from the average
+    * into the upper triangle of a band by band matrix.
+    */
+   class CovarianceKernel : public FactoredKernel
    {
-      for (band1 = 0; band1 < numBands; ++band1)
-      {
-         pAverage[band1] /= lCount;
-      }
+   public:
+      typedef vector<double> State;
 
-      // compute the covariance
-      FactoryResource<DataRequest> pRequest2;
-      pRequest2->setInterleaveFormat(BIP);
-      accessor = pRaster->getDataAccessor(pRequest2.release());
+      CovarianceKernel(int rowFactor, int columnFactor, const vector<double>& averages) :
+         FactoredKernel(rowFactor, columnFactor),
+         mAverages(averages)
+      {}
 
-      for (row = 0; row < numRows; row += rowFactor)
+      template<typename T>
+      void operator()(const RasterTileSet<T>& tiles, State& matrix) const
       {
-         if (pProgress != NULL)
+         RasterTile<const T> pixels = tiles.getInput();
+         unsigned int bandCount = pixels.getBandCount();
+         vector<double> differences(bandCount);
+         for (unsigned int row = getFirstRow(tiles); row < tiles.getRowCount(); row += mRowFactor)
          {
-            if ((pAbortFlag == NULL) || !(*pAbortFlag))
+            for (unsigned int column = 0; column < tiles.getColumnCount(); column += mColumnFactor)
             {
-               pProgress->updateProgress("Computing Covariance Matrix...", int(progScale * row), NORMAL);
-            }
-            else
-            {
-               break;
-            }
-         }
-         for (col = 0; col < numCols; col += columnFactor)
-         {
-            accessor->toPixel(row, col);
-            VERIFYNRV(accessor.isValid());
-            double* pMatrixRow = pMatrix;
-            double* pMatrixColumn = NULL;
-            pPixel = reinterpret_cast<T*>(accessor->getColumn());
+               if (tiles.isSelected(row, column) == false)
+               {
+                  continue;
+               }
 
-            for (band2 = 0; band2 < numBands; ++band2, pMatrixRow += (numBands + 1))
-            {
-               pData = pPixel;
-               pMatrixColumn = pMatrixRow;
-               for (band1 = band2; band1 < numBands; ++band1)
+               for (unsigned int band = 0; band < bandCount; ++band)
                {
-                  *pMatrixColumn += (*pData - pAverage[band1]) * (*pPixel - pAverage[band2]);
-                  ++pData;
-                  ++pMatrixColumn;
+                  differences[band] = pixels(row, column, band) - mAverages[band];
                }
-               ++pPixel;
-            }
-         }
-      }
-   }
 
-   // check if aborted
-   if ((pAbortFlag == NULL) || !(*pAbortFlag))
-   {
-      for (band2 = 0; band2 < numBands; ++band2)
-      {
-         for (band1 = band2; band1 < numBands; ++band1)
-         {
-            pMatrix[band2 * numBands + band1] /= lCount;
+               double* pMatrixRow = &matrix.front();
+               for (unsigned int band2 = 0; band2 < bandCount; ++band2, pMatrixRow += bandCount)
+               {
+                  double difference2 = differences[band2];
+                  for (unsigned int band1 = band2; band1 < bandCount; ++band1)
+                  {
+                     pMatrixRow[band1] += differences[band1] * difference2;
+                  }
+               }
+            }
          }
       }
 
-      for (band2 = 0; band2 < numBands; ++band2)
+      void merge(State& total, const State& matrix) const
       {
-         for (band1 = band2 + 1; band1 < numBands; ++band1)
+         for (State::size_type i = 0; i < total.size(); ++i)
          {
-            pMatrix[band1 * numBands + band2] = pMatrix[band2 * numBands + band1];
+            total[i] += matrix[i];
          }
       }
-   }
 
-   if (pProgress != NULL)
-   {
-      if ((pAbortFlag == NULL) || !(*pAbortFlag))
-      {
-         pProgress->updateProgress("Covariance Matrix Complete", 100, NORMAL);
-      }
-      else
-      {
-         pProgress->updateProgress("Aborted computing Covariance Matrix", 0, ABORT);
-      }
-   }
-}
+   private:
+      const vector<double>& mAverages;
+   };
 
-template<class T>
-void ComputeMaskedCvm(T* pData, MaskInput* pInput, RasterElement* pRaster)
-{
-   if (pRaster == NULL)
+   /**
+    * Computes the covariance matrix of the pixels of an element on the thread pool.
+    *
+    * @return mta::SUCCESS if the matrix was computed, mta::ABORT if the abort flag was set,
+    *         or mta::FAILURE with \c errorText describing why the matrix could not be computed.
+    */
+   mta::Result ComputeCovariance(const RasterElement* pRaster, const BitMask* pMask,
+                                 int rowFactor, int columnFactor, double* pMatrix,
+                                 Progress* pProgress, const bool* pAbortFlag, string& errorText)
    {
-      return;
-   }
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      VERIFYRV(pDescriptor != NULL, mta::FAILURE);
+      unsigned int numBands = pDescriptor->getBandCount();
 
-   const RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pRaster->getDataDescriptor());
-   if (pDescriptor == NULL)
-   {
-      return;
-   }
-   unsigned int numBands = pDescriptor->getBandCount();
-   int lCount = 0;
-   T* pPixel = NULL;
+      RasterTileProcessor processor;
+      processor.addInput(pRaster);
+      processor.setAoi(pMask);
+      processor.setAbortFlag(pAbortFlag);
 
-   vector<double> averages(numBands, 0);
-   double* pAverage = &averages.front();
-   memset(pInput->pMatrix, 0, sizeof(double) * pInput->numBands * pInput->numBands);
-   FactoryResource<DataRequest> pRequest;
-   pRequest->setInterleaveFormat(BIP);
-   DataAccessor accessor = pRaster->getDataAccessor(pRequest.release());
-   BitMaskIterator it(pInput->mpMask, pRaster);
-   int numPixels = it.getCount();
-   LocationType loc;
-   float progScale = 100.0f / numPixels;
-   int progSave = 0;
-   while (it != it.end())
-   {
-      it.getPixelLocation(loc);
-      accessor->toPixel(loc.mY, loc.mX);
-      VERIFYNRV(accessor.isValid());
-      if (pInput->pProgress != NULL &&
-          progSave != static_cast<int>(progScale * lCount))
-      {
-         if ((pInput->pAbortFlag == NULL) || !(*pInput->pAbortFlag))
-         {
-            progSave = static_cast<int>(progScale * lCount);
-            pInput->pProgress->updateProgress("Computing Covariance Matrix...",
-               progSave, NORMAL);
-         }
-         else
-         {
-            break;
-         }
-      }
-      pPixel = reinterpret_cast<T*>(accessor->getColumn());
-      ++lCount;
-      ++it;
-      for (unsigned int band1 = 0; band1 < numBands; ++band1)
+      // calculate average spectrum
+      mta::ProgressObjectReporter averageReporter("Computing Average Signature...", pProgress);
+      processor.setProgressReporter(&averageReporter);
+      SumKernel::State sums(numBands);
+      mta::Result result = processor.run(SumKernel(rowFactor, columnFactor), sums);
+      if (result != mta::SUCCESS)
       {
-         pAverage[band1] += *pPixel;
-         ++pPixel;
+         errorText = processor.getErrorText();
+         return result;
       }
-   }
-
-   for (unsigned int band1 = 0; band1 < numBands; ++band1)
-   {
-      pAverage[band1] /= lCount;
-   }
-
 
-   // calculate covariance matrix
-   accessor = pRaster->getDataAccessor(pRequest->copy());
-   it.firstPixel();
-   lCount = 0;
-   progSave = 0;
-   while (it != it.end())
-   {
-      if (pInput->pProgress != NULL &&
-          progSave != static_cast<int>(progScale * lCount))
+      if (sums.mCount == 0)
       {
-         if ((pInput->pAbortFlag == NULL) || !(*pInput->pAbortFlag))
-         {
-            progSave = static_cast<int>(progScale * lCount);
-            pInput->pProgress->updateProgress("Computing Covariance Matrix...",
-               progSave, NORMAL);
-         }
-         else
-         {
-            break;
-         }
+         errorText = "No pixels were selected to compute the Covariance Matrix";
+         return mta::FAILURE;
       }
-      it.getPixelLocation(loc);
-      accessor->toPixel(loc.mY, loc.mX);
-
-      VERIFYNRV(accessor.isValid());
-      double* pMatrixRow = pInput->pMatrix;
-      double* pMatrixColumn = NULL;
-      pPixel = reinterpret_cast<T*>(accessor->getColumn());
 
-      for (unsigned int band2 = 0; band2 < numBands; ++band2, pMatrixRow += (numBands + 1))
+      vector<double> averages(numBands);
+      for (unsigned int band = 0; band < numBands; ++band)
       {
-         pData = pPixel;
-         pMatrixColumn = pMatrixRow;
-         for (unsigned int band1 = band2; band1 < numBands; ++band1)
-         {
-            *pMatrixColumn += (*pData - pAverage[band1]) * (*pPixel - pAverage[band2]);
-            ++pData;
-            ++pMatrixColumn;
-         }
-         ++pPixel;
+         averages[band] = sums.mSums[band] / sums.mCount;
       }
-      ++lCount;
-      ++it;
-   }
 
-   // check if aborted
-   if ((pInput->pAbortFlag == NULL) || !(*pInput->pAbortFlag))
-   {
-      for (unsigned int band2 = 0; band2 < numBands; ++band2)
+      // compute the covariance
+      mta::ProgressObjectReporter covarianceReporter("Computing Covariance Matrix...", pProgress);
+      processor.setProgressReporter(&covarianceReporter);
+      vector<double> matrix(static_cast<vector<double>::size_type>(numBands) * numBands, 0.0);
+      result = processor.run(CovarianceKernel(rowFactor, columnFactor, averages), matrix);
+      if (result != mta::SUCCESS)
       {
-         for (unsigned int band1 = band2; band1 < numBands; ++band1)
-         {
-            pInput->pMatrix[band2 * numBands + band1] /= lCount;
-         }
+         errorText = processor.getErrorText();
+         return result;
       }
 
       for (unsigned int band2 = 0; band2 < numBands; ++band2)
       {
          for (unsigned int band1 = band2; band1 < numBands; ++band1)
          {
-            pInput->pMatrix[band1 * numBands + band2] = pInput->pMatrix[band2 * numBands + band1];
+            pMatrix[band2 * numBands + band1] = matrix[band2 * numBands + band1] / sums.mCount;
+            pMatrix[band1 * numBands + band2] = pMatrix[band2 * numBands + band1];
          }
       }
-   }
-   if (pInput->pProgress != NULL)
-   {
-      if ((pInput->pAbortFlag == NULL) || !(*pInput->pAbortFlag))
-      {
-         pInput->pProgress->updateProgress("Covariance Matrix Complete", 99, NORMAL);
-      }
-      else
+
+      if (pProgress != NULL)
       {
-         pInput->pProgress->updateProgress("Aborted computing Covariance Matrix", 0, ABORT);
+         pProgress->updateProgress("Covariance Matrix Complete", 100, NORMAL);
       }
+
+      return mta::SUCCESS;
    }
 }
 
@@ -596,11 +483,7 @@ bool CovarianceAlgorithm::processAll()
    mpStep = pStep.get();
 
    const RasterDataDescriptor* pDescriptor = NULL;
-   void* pData = NULL;
-   unsigned int numRows(0);
-   unsigned int numColumns(0);
    unsigned int numBands(0);
-   EncodingType eType;
 
    RasterElement* pRasterElement = getRasterElement();
    if (pRasterElement == NULL)
@@ -622,8 +505,6 @@ bool CovarianceAlgorithm::processAll()
       return false;
    }
 
-   numRows = pDescriptor->getRowCount();
-   numColumns = pDescriptor->getColumnCount();
    numBands = pDescriptor->getBandCount();
 
    { // scope the accessor
@@ -670,59 +551,35 @@ bool CovarianceAlgorithm::processAll()
 
       if (loadedFromFile == false)                        // need to compute cvm
       {
-         eType = pDescriptor->getDataType();
-
          // check that entire data block of element is in memory
          VERIFY(pCvmElement->getRawData() != NULL);
-         if (mInput.mpAoi == NULL)
-         {
-            switchOnEncoding(eType, ComputeFactoredCov, pData, pRasterElement, 
-               static_cast<double*>(pCvmElement->getRawData()), getProgress(), 
-               &mAbortFlag, mInput.mRowFactor, mInput.mColumnFactor);
-         }
-         else
+         const BitMask* pMask = NULL;
+         if (mInput.mpAoi != NULL)
          {
-            const BitMask* pMask = mInput.mpAoi->getSelectedPoints();
+            pMask = mInput.mpAoi->getSelectedPoints();
             if (pMask == NULL)
             {
                reportProgress(ERRORS, 0, "Error getting mask from AOI");
                return false;
             }
-            else // pMask != NULL
+
+            BitMaskIterator it(pMask, pRasterElement);
+            if (it.getCount() == 0)
             {
-               BitMaskIterator it(pMask, pRasterElement);
-               if (it.getCount() == 0)
-               {
-                  reportProgress(ERRORS, 0, "Error getting selected pixels from AOI");
-                  return false;
-               }
-               else
-               {
-                  int x1 = 0;
-                  int y1 = 0;
-                  int x2 = 0;
-                  int y2 = 0;
-                  pMask->getBoundingBox(x1, y1, x2, y2);
-                  const bool** pSelectedPixels = const_cast<BitMask*>(pMask)->getRegion(x1, y1, x2, y2);
-                  MaskInput input;
-                  input.pMatrix = static_cast<double*>(pCvmElement->getRawData());
-                  input.numRows = numRows;
-                  input.numCols = numColumns;
-                  input.numBands = numBands;
-                  input.pProgress = getProgress();
-                  input.pAbortFlag = &mAbortFlag;
-                  input.pSelectedPixels = pSelectedPixels;
-                  input.mpMask = pMask;
-                  input.boundingBoxX1 = x1;
-                  input.boundingBoxX2 = x2;
-                  input.boundingBoxY1 = y1;
-                  input.boundingBoxY2 = y2;
-
-                  switchOnEncoding(eType, ComputeMaskedCvm, pData, &input, pRasterElement);
-               }
+               reportProgress(ERRORS, 0, "Error getting selected pixels from AOI");
+               return false;
             }
          }
 
+         string errorText;
+         mta::Result result = ComputeCovariance(pRasterElement, pMask, mInput.mRowFactor, mInput.mColumnFactor,
+            static_cast<double*>(pCvmElement->getRawData()), getProgress(), &mAbortFlag, errorText);
+         if (result == mta::FAILURE)
+         {
+            reportProgress(ERRORS, 0, errorText);
+            return false;
+         }
+
          if (mAbortFlag)
          {
             reportProgress(ABORT, 0, "Aborted creation of Covariance Matrix");
@@ -24,6 +24,11 @@ public:
       return smbAbortFlag;
    }
 
+   static inline const bool* getAbortFlagAddress()
+   {
+      return &smbAbortFlag;
+   }
+
 private:
    static bool smbAbortFlag;
 };
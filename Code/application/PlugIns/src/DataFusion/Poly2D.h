@@ -20,12 +20,41 @@
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
 #include "RasterUtilities.h"
+#include "RasterWarper.h"
 #include "Statistics.h"
 #include "Vector.h"
 
 #include <math.h>
 #include <string>
 
+/**
+ * Forwards RasterWarper progress to the ProgressTracker used by the fusion dialog.
+ */
+class Poly2DProgressReporter : public mta::ProgressReporter
+{
+public:
+   Poly2DProgressReporter(const std::string& message, ProgressTracker& progressTracker) :
+      mMessage(message),
+      mProgressTracker(progressTracker)
+   {}
+
+   void reportProgress(int percent)
+   {
+      mProgressTracker.report(mMessage, percent, NORMAL);
+   }
+
+   void reportError(const std::string& text)
+   {
+      mProgressTracker.report(text, 0, ERRORS, true);
+   }
+
+private:
+   Poly2DProgressReporter& operator=(const Poly2DProgressReporter& rhs);
+
+   std::string mMessage;
+   ProgressTracker& mProgressTracker;
+};
+
 /**
  * Poly2D
  *
@@ -41,7 +70,8 @@
  * @throw AssertException
  *        An AssertException is thrown when a bug occurs and the code is attempting to recover.
  *
- * All out-of-bounds values are 0. Uses bilinear interpolation.
+ * All out-of-bounds values are 0. Uses bilinear interpolation. The warp is performed
+ * by a RasterWarper so the output is generated in parallel tiles.
  *
  * NOTE: Only the first 'band' of the secondary image is fused with the
  *       primary image!
@@ -89,15 +119,9 @@ RasterElement* poly_2D(T* pDummy, RasterElement* pRasterElement,
                      unsigned int xoff, unsigned int yoff, int zoomFactor,
                      ProgressTracker& progressTracker, bool inMemory = true)
 {
-   double x1 = 0, y1 = 0;
-   double x_prime = 0, y_prime = 0;
-   double u = 0, v = 0;
-
    const T BAD_VALUE = 0;
    const double THRESHOLD = 0.10; // if 10% of pixels are 'bad', throw up a warning later
 
-   double badValues = 0;
-
    REQUIRE(pRasterElement != NULL);
 
    const RasterDataDescriptor* pOrigDescriptor =
@@ -135,96 +159,35 @@ RasterElement* poly_2D(T* pDummy, RasterElement* pRasterElement,
 
    pNewDescriptor = NULL; // ModelResource deletes it
 
-   FactoryResource<DataRequest> pNewRequest;
-   pNewRequest->setWritable(true);
-   DataAccessor rmda = pNewRaster->getDataAccessor(pNewRequest.release());
-   REQUIRE(rmda.isValid() == true);
-
-   DataAccessor originalData = pRasterElement->getDataAccessor();
-   REQUIRE(originalData.isValid() == true);
-
-   unsigned int x2 = 0, y2 = 0;
-   float rowProgress = 100.0f/dimY;
-   for (unsigned int y = 0; y < dimY; y++)
+   /* Let xoff = offset of ROI in primary image
+      x2=x+xoff;
+      Let yoff = offset of ROI in primary
+      y2=y+yoff
+      x_prime = KX[0] + KX[1]*y2 + KX[2]*x2 + KX[3]*x2*y2
+      y_prime = KY[0] + KY[1]*y2 + KY[2]*x2 + KY[3]*x2*y2
+    */
+   PolynomialWarpMapping mapping(KX, KY, zoomFactor * static_cast<double>(xoff),
+      zoomFactor * static_cast<double>(yoff));
+   RasterWarper warper(pRasterElement, mapping);
+   warper.setInterpolation(RasterUtilities::BILINEAR);
+   warper.setBands(std::vector<unsigned int>(1, 0));
+   warper.setBadValue(BAD_VALUE);
+
+   // Keep the bounds test and integer conversion used before the warp was tiled
+   warper.setSourceBounds(RasterWarper::PIXEL_INDEX);
+   warper.setRoundValues(false);
+
+   Poly2DProgressReporter reporter(msg, progressTracker);
+   if (!warper.warp(pNewRaster.get(), &reporter, DataFusionTools::getAbortFlagAddress()))
    {
       if (DataFusionTools::getAbortFlag())
       {
          return NULL;
       }
-
-      T* results = (T*) rmda->getRow();
-      for (unsigned int x = 0; x < dimX; ++x) // for every column in s'
-      {
-         /* Let xoff = offset of ROI in primary image
-            x2=x+xoff;
-            Let yoff = offset of ROI in primary
-            y2=y+yoff
-            x_prime = KX[0] + KX[1]*y2 + KX[2]*x2 + KX[3]*x2*y2
-            y_prime = KY[0] + KY[1]*y2 + KY[2]*x2 + KY[3]*x2*y2
-          */
-
-         const int XNEW = x+(zoomFactor*xoff), YNEW = y+(zoomFactor*yoff);
-
-         x_prime = KX[0] + KX[1]*YNEW + KX[2]*XNEW + KX[3]*XNEW*YNEW;
-         y_prime = KY[0] + KY[1]*YNEW + KY[2]*XNEW + KY[3]*XNEW*YNEW;
-
-         x1 = floor(x_prime);
-         y1 = floor(y_prime);
-
-         // Handle out of bounds case
-         if ((x1 > (nx-1)) || (y1 > (ny-1)) || (x1 < 0) || (y1 < 0))
-         {
-            badValues++;
-            results[x] = BAD_VALUE;
-         }
-         else
-         {
-            // bilinear interpolation 
-            if ((x1+1) > (double(nx)-1))
-            {
-               x2 = nx-1;
-            }
-            else
-            {
-               x2 = static_cast<unsigned int>(x1+1);
-            }
-            if ((y1+1) > (double(ny)-1))
-            {
-               y2 = ny-1;
-            }
-            else
-            {
-               y2 = static_cast<unsigned int>(y1+1);
-            }
-            u = x_prime - x1;
-            v = y_prime - y1;
-
-            // the "out of bounds case" above guarnatees that the toPixel() operations will succeed
-
-            originalData->toPixel(static_cast<int>(y1), static_cast<int>(x1));
-            const T minXminY = *reinterpret_cast<T*>(originalData->getColumn());
-
-            originalData->toPixel(static_cast<int>(y1), static_cast<int>(x2));
-            const T maxXminY = *reinterpret_cast<T*>(originalData->getColumn());
-
-            originalData->toPixel(static_cast<int>(y2), static_cast<int>(x1));
-            const T minXmaxY = *reinterpret_cast<T*>(originalData->getColumn());
-            
-            originalData->toPixel(static_cast<int>(y2), static_cast<int>(x2));
-            const T maxXmaxY = *reinterpret_cast<T*>(originalData->getColumn());
-
-            results[x] = static_cast<T>((minXminY * ((1.0 - u) * (1.0 - v))
-                                       + maxXminY * (u * (1.0 - v))
-                                       + minXmaxY * ((1.0 - u) * v)
-                                       + maxXmaxY * (u * v)));
-         }
-      }
-      rmda->nextRow();
-      // report 1 row's worth of progress
-      int workDone = static_cast<int>(rowProgress * (y + 1));
-      progressTracker.report(msg.c_str(), workDone, NORMAL);
+      throw FusionException(warper.getErrorText(), __LINE__, __FILE__);
    }
 
+   double badValues = static_cast<double>(warper.getBadPixelCount());
    if ((badValues / (dimX * dimY)) > THRESHOLD) 
    {
       std::string txt = "Warning: Too many values in the primary data set are not in the secondary data set! "
@@ -212,9 +212,24 @@ std::vector<ImportDescriptor*> GdalImporter::getImportDescriptors(const std::str
       {
          mWarnings.push_back("64-bit Complex float not fully supported. Data will be loaded but may be truncated.");
       }
+      // the pager reads any interleave, so match the file's layout to read it sequentially
+      InterleaveFormatType interleave = BSQ;
+      const char* pInterleave = pDataset->GetMetadataItem("INTERLEAVE", "IMAGE_STRUCTURE");
+      if (pInterleave != NULL && pDataset->GetRasterCount() > 1)
+      {
+         if (std::string(pInterleave) == "PIXEL")
+         {
+            interleave = BIP;
+         }
+         else if (std::string(pInterleave) == "LINE")
+         {
+            interleave = BIL;
+         }
+      }
+
       pImportDescriptor->setDataDescriptor(RasterUtilities::generateRasterDataDescriptor(
          *dsname, NULL, pDataset->GetRasterYSize(), pDataset->GetRasterXSize(), pDataset->GetRasterCount(),
-         BSQ, encoding, IN_MEMORY));
+         interleave, encoding, IN_MEMORY));
       RasterFileDescriptor* pFileDesc = 
          dynamic_cast<RasterFileDescriptor*>(RasterUtilities::generateAndSetFileDescriptor(
          pImportDescriptor->getDataDescriptor(), filename, *dsname, Endian::getSystemEndian()));
@@ -355,8 +370,9 @@ int GdalImporter::getValidationTest(const DataDescriptor* pDescriptor) const
    {
       if (pDescriptor->getProcessingLocation() == ON_DISK_READ_ONLY)
       {
-         // Disabling these checks since the importer supports band subsets and skip factors for on-disk read-only
-         validationTest &= ~(NO_BAND_SUBSETS | NO_SKIP_FACTORS);
+         // Disabling these checks since the importer supports interleave conversions, band subsets
+         // and skip factors for on-disk read-only
+         validationTest &= ~(NO_INTERLEAVE_CONVERSIONS | NO_BAND_SUBSETS | NO_SKIP_FACTORS);
       }
    }
 
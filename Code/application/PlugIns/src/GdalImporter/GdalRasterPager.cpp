@@ -16,10 +16,9 @@
 #include "PlugInRegistration.h"
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
-#include "RasterUtilities.h"
-#include "switchOnEncoding.h"
 
 #include <gdal_priv.h>
+#include <string.h>
 #include <vector>
 
 REGISTER_PLUGIN_BASIC(OpticksGdalImporter, GdalRasterPager);
@@ -83,7 +82,9 @@ namespace
    }
 }
 
-GdalRasterPager::GdalRasterPager() : mpDataset(NULL)
+GdalRasterPager::GdalRasterPager() :
+   mpDataset(NULL),
+   mTileColumns(0)
 {
    setName("GDAL Raster Pager");
    setCopyright(APP_COPYRIGHT);
@@ -98,6 +99,10 @@ GdalRasterPager::GdalRasterPager() : mpDataset(NULL)
 
 GdalRasterPager::~GdalRasterPager()
 {
+   for (std::vector<GDALDataset*>::iterator iter = mDatasets.begin(); iter != mDatasets.end(); ++iter)
+   {
+      GDALClose(*iter);
+   }
 }
 
 bool GdalRasterPager::getInputSpecification(PlugInArgList*& pArgList)
@@ -131,100 +136,252 @@ bool GdalRasterPager::openFile(const std::string& filename)
       mDatasetName = filename;
    }
    mpDataset.reset(reinterpret_cast<GDALDataset*>(GDALOpen(mDatasetName.c_str(), GA_ReadOnly)));
-   return mpDataset.get() != NULL;
+   if (mpDataset.get() == NULL)
+   {
+      return false;
+   }
+   mAvailableDatasets.push_back(mpDataset.get());
+
+   // Read tiles instead of full rows for tiled requests if the blocks are narrower than the
+   // image and the active columns are contiguous and start on a block boundary
+   mTileColumns = 0;
+   const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(getRasterElement()->getDataDescriptor());
+   GDALRasterBand* pBand = mpDataset->GetRasterBand(1);
+   if (pDesc != NULL && pBand != NULL && pDesc->getColumnSkipFactor() == 0 && pDesc->getColumns().empty() == false)
+   {
+      int blockColumns = 0;
+      int blockRows = 0;
+      pBand->GetBlockSize(&blockColumns, &blockRows);
+      if (blockColumns > 0 && blockColumns < mpDataset->GetRasterXSize() &&
+         pDesc->getColumns().front().getOnDiskNumber() % blockColumns == 0)
+      {
+         mTileColumns = blockColumns;
+      }
+   }
+
+   return true;
+}
+
+unsigned int GdalRasterPager::getTileColumnCount() const
+{
+   return mTileColumns;
+}
+
+bool GdalRasterPager::isFetchUnitThreadSafe() const
+{
+   return true;
+}
+
+GDALDataset* GdalRasterPager::acquireDataset()
+{
+   {
+      mta::MutexLock lock(mDatasetMutex);
+      if (mAvailableDatasets.empty() == false)
+      {
+         GDALDataset* pDataset = mAvailableDatasets.back();
+         mAvailableDatasets.pop_back();
+         return pDataset;
+      }
+   }
+
+   // GDAL datasets may not be used by more than one thread at a time, so open another handle
+   GDALDataset* pDataset = reinterpret_cast<GDALDataset*>(GDALOpen(mDatasetName.c_str(), GA_ReadOnly));
+   if (pDataset != NULL)
+   {
+      mta::MutexLock lock(mDatasetMutex);
+      mDatasets.push_back(pDataset);
+   }
+
+   return pDataset;
+}
+
+void GdalRasterPager::releaseDataset(GDALDataset* pDataset)
+{
+   if (pDataset != NULL)
+   {
+      mta::MutexLock lock(mDatasetMutex);
+      mAvailableDatasets.push_back(pDataset);
+   }
 }
 
 CachedPage::UnitPtr GdalRasterPager::fetchUnit(DataRequest* pOriginalRequest)
 {
-   // load entire rows for the band in the request
-   // there will be only one band since GDAL is always BSQ.
-   // We'll load the rows requested and cache that block
+   // load the rows in the request for one band if the request is BSQ or for all of the
+   // active bands otherwise, with the bands interleaved as requested
    const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(getRasterElement()->getDataDescriptor());
+   InterleaveFormatType interleave = pOriginalRequest->getInterleaveFormat();
 
-   // calculate the rows we are loading
-   std::vector<DimensionDescriptor> rows = RasterUtilities::subsetDimensionVector(pDesc->getRows(), pOriginalRequest->getStartRow(),
-      pOriginalRequest->getStopRow());
-   unsigned int numRows = std::min<size_t>(pOriginalRequest->getConcurrentRows(), rows.size());
+   // calculate the rows we are loading, looking up only the rows in the page by their active numbers
+   // instead of copying and searching every row of the descriptor
+   unsigned int firstRow = pOriginalRequest->getStartRow().getActiveNumber();
+   unsigned int lastRow = pOriginalRequest->getStopRow().getActiveNumber();
+   unsigned int numRows = 0;
+   if (pOriginalRequest->getStartRow().isActiveNumberValid() && pOriginalRequest->getStopRow().isActiveNumberValid() &&
+      lastRow >= firstRow)
+   {
+      numRows = std::min(pOriginalRequest->getConcurrentRows(), lastRow - firstRow + 1);
+   }
 
-   // calculate to columns we a loading
+   std::vector<DimensionDescriptor> rows;
+   rows.reserve(numRows);
+   for (unsigned int rowIdx = 0; rowIdx < numRows; ++rowIdx)
+   {
+      rows.push_back(pDesc->getActiveRow(firstRow + rowIdx));
+   }
 
-//#pragma message(__FILE__ "(" STRING(__LINE__) ") : warning : fix this when cached pager properly handles column subsets (tclarke)")
-   /** this should work but CachedPager assumes fetchUnit() returns full rows **/
-   /*std::vector<DimensionDescriptor> cols = RasterUtilities::subsetDimensionVector(pDesc->getColumns(), pOriginalRequest->getStartColumn(),
-      pOriginalRequest->getStopColumn());
-   unsigned int numCols = std::min(pOriginalRequest->getConcurrentColumns(), cols.size());*/
+   // calculate the columns we are loading, tiled requests only load the requested tile columns
+   unsigned int firstCol = 0;
+   unsigned int numCols = pDesc->getColumnCount();
+   DimensionDescriptor startColumn;
+   if (pOriginalRequest->getTiled())
+   {
+      firstCol = pOriginalRequest->getStartColumn().getActiveNumber();
+      unsigned int lastCol = pOriginalRequest->getStopColumn().getActiveNumber();
+      numCols = (lastCol >= firstCol ? std::min(pOriginalRequest->getConcurrentColumns(), lastCol - firstCol + 1) : 0);
+      startColumn = pOriginalRequest->getStartColumn();
+   }
 
-   std::vector<DimensionDescriptor> cols = pDesc->getColumns();
-   unsigned int numCols = cols.size();
+   // calculate the bands we are loading as 1 based on-disk band numbers
+   std::vector<int> bandMap;
+   DimensionDescriptor unitBand = CachedPage::CacheUnit::ALL_BANDS;
+   if (interleave == BSQ)
+   {
+      unitBand = pOriginalRequest->getStartBand();
+      bandMap.push_back(unitBand.getOnDiskNumber() + 1);
+   }
+   else
+   {
+      for (unsigned int bandIdx = 0; bandIdx < pDesc->getBandCount(); ++bandIdx)
+      {
+         bandMap.push_back(pDesc->getActiveBand(bandIdx).getOnDiskNumber() + 1);
+      }
+   }
 
-   if (numRows == 0 || numCols == 0)
+   if (numRows == 0 || numCols == 0 || bandMap.empty())
    {
       return CachedPage::UnitPtr();
    }
 
-   size_t bufSize = numCols * numRows * pDesc->getBytesPerElement();
+   DimensionDescriptor firstColumn = pDesc->getActiveColumn(firstCol);
+   DimensionDescriptor lastColumn = pDesc->getActiveColumn(firstCol + numCols - 1);
+
+   // byte spacing of the buffer so RasterIO writes the requested interleave directly
+   int numBands = static_cast<int>(bandMap.size());
+   int bytesPerElement = static_cast<int>(pDesc->getBytesPerElement());
+   int pixelSpace = bytesPerElement;
+   int lineSpace = numCols * numBands * bytesPerElement;
+   int bandSpace = numCols * bytesPerElement;
+   if (interleave == BIP)
+   {
+      pixelSpace = numBands * bytesPerElement;
+      bandSpace = bytesPerElement;
+   }
+
+   size_t bufSize = static_cast<size_t>(lineSpace) * numRows;
    ArrayResource<char> pBuffer(bufSize, true);
    if (pBuffer.get() == NULL)
    {
       return CachedPage::UnitPtr();
    }
 
-   GDALRasterBand* pBand = mpDataset->GetRasterBand(pOriginalRequest->getStartBand().getOnDiskNumber() + 1); // 1 based band number
-   if (pBand == NULL)
+   GDALDataset* pDataset = acquireDataset();
+   if (pDataset == NULL)
    {
       return CachedPage::UnitPtr();
    }
+
    GDALDataType effectiveType = encodingTypeToGdalDataType(pDesc->getDataType());
+   unsigned int rowStep = pDesc->getRowSkipFactor() + 1;
+   unsigned int colStep = pDesc->getColumnSkipFactor() + 1;
+   int firstReadCol = firstColumn.getOnDiskNumber();
+   int numColsTotal = lastColumn.getOnDiskNumber() - firstReadCol + 1;
+   bool success = true;
 
-   if (pDesc->getRowSkipFactor() == 0 && pDesc->getColumnSkipFactor() == 0)
+   if (rowStep == 1 && colStep == 1)
    {
-      if (pBand->RasterIO(GF_Read, cols.front().getOnDiskNumber(), rows.front().getOnDiskNumber(),
-                                   numCols, numRows, pBuffer.get(), numCols, numRows, effectiveType, 0, 0) == CE_Failure)
+      success = pDataset->RasterIO(GF_Read, firstReadCol, rows.front().getOnDiskNumber(), numCols, numRows,
+         pBuffer.get(), numCols, numRows, effectiveType, numBands, &bandMap.front(),
+         pixelSpace, lineSpace, bandSpace) != CE_Failure;
+   }
+   else if (GdalRasterPager::getSettingUseOverviews())
+   {
+      // decimate the full resolution window, GDAL reads from an overview if there is a suitable one
+      int firstReadRow = rows.front().getOnDiskNumber();
+      int windowCols = std::min(static_cast<int>(numCols * colStep), pDataset->GetRasterXSize() - firstReadCol);
+      int windowRows = std::min(static_cast<int>(numRows * rowStep), pDataset->GetRasterYSize() - firstReadRow);
+
+      // A window clamped at the image edge is shrunk to whole skip steps so it is not stretched to fill the
+      // page.  The last row or column then falls in a partial step and is read separately at full resolution.
+      int fullCols = windowCols / static_cast<int>(colStep);
+      int fullRows = windowRows / static_cast<int>(rowStep);
+      int outCols[2] = { fullCols, static_cast<int>(numCols) - fullCols };
+      int outRows[2] = { fullRows, static_cast<int>(numRows) - fullRows };
+      int readCols[2] = { fullCols * static_cast<int>(colStep), outCols[1] };
+      int readRows[2] = { fullRows * static_cast<int>(rowStep), outRows[1] };
+      for (int rowPart = 0; rowPart < 2 && success; ++rowPart)
       {
-         return CachedPage::UnitPtr();
+         for (int colPart = 0; colPart < 2 && success; ++colPart)
+         {
+            if (outRows[rowPart] <= 0 || outCols[colPart] <= 0)
+            {
+               continue;
+            }
+
+            char* pDest = pBuffer.get() + rowPart * fullRows * lineSpace + colPart * fullCols * pixelSpace;
+            success = pDataset->RasterIO(GF_Read, firstReadCol + colPart * readCols[0],
+               firstReadRow + rowPart * readRows[0], readCols[colPart], readRows[rowPart],
+               pDest, outCols[colPart], outRows[rowPart], effectiveType, numBands, &bandMap.front(),
+               pixelSpace, lineSpace, bandSpace) != CE_Failure;
+         }
       }
    }
-   else if (pDesc->getColumnSkipFactor() == 0)
+   else if (colStep == 1)
    {
       // read each row
-      for (size_t rowIdx = 0; rowIdx < numRows; rowIdx++)
+      for (unsigned int rowIdx = 0; rowIdx < numRows && success; ++rowIdx)
       {
-         size_t bufOffset = rowIdx * numCols * pDesc->getBytesPerElement();
-         if (pBand->RasterIO(GF_Read, cols.front().getOnDiskNumber(), rows[rowIdx].getOnDiskNumber(),
-                                      numCols, 1, pBuffer.get() + bufOffset, numCols, 1, effectiveType, 0, 0) == CE_Failure)
-         {
-            return CachedPage::UnitPtr();
-         }
+         success = pDataset->RasterIO(GF_Read, firstReadCol, rows[rowIdx].getOnDiskNumber(), numCols, 1,
+            pBuffer.get() + rowIdx * lineSpace, numCols, 1, effectiveType, numBands, &bandMap.front(),
+            pixelSpace, lineSpace, bandSpace) != CE_Failure;
       }
    }
    else
    {
-      unsigned int firstReadCol = cols.front().getOnDiskNumber();
-      unsigned int numColsTotal = cols.back().getOnDiskNumber() - firstReadCol + 1;
-      unsigned int bytesPerElement = pDesc->getBytesPerElement();
-      std::vector<char> tmpBuf(numColsTotal * bytesPerElement);
-      // read each pixel
-      for (size_t rowIdx = 0; rowIdx < numRows; rowIdx++)
+      // read each row including the skipped columns into a temp buffer with the same layout
+      int tmpPixelSpace = pixelSpace;
+      int tmpBandSpace = (interleave == BIP ? bandSpace : numColsTotal * bytesPerElement);
+      int tmpLineSpace = numColsTotal * numBands * bytesPerElement;
+      std::vector<char> tmpBuf(tmpLineSpace);
+
+      // BIP pixels are copied with all of their bands at once
+      int copyBands = (interleave == BIP ? 1 : numBands);
+      int copyBytes = (interleave == BIP ? pixelSpace : bytesPerElement);
+      for (unsigned int rowIdx = 0; rowIdx < numRows && success; ++rowIdx)
       {
-         // read an entire row into a temp buffer
-         if (pBand->RasterIO(GF_Read, firstReadCol, rows[rowIdx].getOnDiskNumber(),
-                     numColsTotal, 1, &tmpBuf.front(), numColsTotal, 1, effectiveType, 0, 0) == CE_Failure)
-         {
-            return CachedPage::UnitPtr();
-         }
+         success = pDataset->RasterIO(GF_Read, firstReadCol, rows[rowIdx].getOnDiskNumber(), numColsTotal, 1,
+            &tmpBuf.front(), numColsTotal, 1, effectiveType, numBands, &bandMap.front(),
+            tmpPixelSpace, tmpLineSpace, tmpBandSpace) != CE_Failure;
 
          // copy the pixels needed
-         unsigned int bufCol = 0;
-         unsigned int colSkip = pDesc->getColumnSkipFactor();
-         for (unsigned int curCol = 0; curCol < numColsTotal; curCol += (colSkip + 1))
+         char* pRow = pBuffer.get() + rowIdx * lineSpace;
+         for (int band = 0; band < copyBands && success; ++band)
          {
-            size_t bufOffset = (rowIdx * numCols * bytesPerElement) + (bufCol++ * bytesPerElement);
-            size_t tmpOffset = curCol * bytesPerElement;
-            memcpy(pBuffer.get() + bufOffset, &tmpBuf[tmpOffset], bytesPerElement);
+            const char* pSrc = &tmpBuf.front() + band * tmpBandSpace;
+            char* pDest = pRow + band * bandSpace;
+            for (unsigned int col = 0; col < numCols; ++col)
+            {
+               memcpy(pDest + col * pixelSpace, pSrc + col * colStep * tmpPixelSpace, copyBytes);
+            }
          }
       }
    }
 
-   return CachedPage::UnitPtr(new CachedPage::CacheUnit(
-      pBuffer.release(), pOriginalRequest->getStartRow(), numRows, bufSize, pOriginalRequest->getStartBand()));
+   releaseDataset(pDataset);
+   if (success == false)
+   {
+      return CachedPage::UnitPtr();
+   }
+
+   return CachedPage::UnitPtr(new CachedPage::CacheUnit(pBuffer.release(), pOriginalRequest->getStartRow(), numRows,
+      bufSize, unitBand, 0, startColumn, numCols));
 }
@@ -11,24 +11,58 @@
 #define GDALRASTERPAGER_H__
 
 #include "CachedPager.h"
+#include "ConfigurationSettings.h"
+#include "DMutex.h"
+#include "TypesFile.h"
+
 #include <gdal_priv.h>
+#include <vector>
 
+/**
+ * Provides access to on-disk GDAL datasets.
+ *
+ * Pages are read with a single GDALDataset::RasterIO() call which writes the
+ * active bands directly in the interleave format of the request. Each thread
+ * which misses the page cache reads from its own dataset handle so reads run
+ * concurrently.
+ *
+ * If getSettingUseOverviews() is \c true, skip factored data is read by
+ * decimating the full resolution window, which lets GDAL read the dataset's
+ * overviews. Overview values are resampled by the method used to build them,
+ * so they only equal the skipped pixels for overviews built with nearest
+ * neighbour resampling.
+ */
 class GdalRasterPager : public CachedPager
 {
 public:
+   SETTING(UseOverviews, GdalRasterPager, bool, false)
+
    GdalRasterPager();
    virtual ~GdalRasterPager();
    virtual bool getInputSpecification(PlugInArgList*& pArgList);
    virtual bool parseInputArgs(PlugInArgList* pInputArgList);
 
+protected:
+   virtual unsigned int getTileColumnCount() const;
+   virtual bool isFetchUnitThreadSafe() const;
+
 private:
    GdalRasterPager& operator=(const GdalRasterPager& rhs);
 
    virtual bool openFile(const std::string& filename);
    virtual CachedPage::UnitPtr fetchUnit(DataRequest* pOriginalRequest);
 
+   GDALDataset* acquireDataset();
+   void releaseDataset(GDALDataset* pDataset);
+
    std::auto_ptr<GDALDataset> mpDataset;
    std::string mDatasetName;
+   unsigned int mTileColumns;
+
+   // Additional handles opened for concurrent reads, and the handles which are not in use
+   std::vector<GDALDataset*> mDatasets;
+   std::vector<GDALDataset*> mAvailableDatasets;
+   mta::DMutex mDatasetMutex;
 };
 
 #endif
@@ -41,6 +41,9 @@ GeoMosaicDlg::GeoMosaicDlg(Progress* pProgress, QWidget* pParent) :
    mpPrimaryList = new QListWidget(this);
    mpPrimaryList->setSelectionMode(QAbstractItemView::ExtendedSelection);
    mpCreateAnimationCheckBox = new QCheckBox("Create Animation", this);
+   mpResampleCheckBox = new QCheckBox("Resample to Primary Grid", this);
+   mpResampleCheckBox->setToolTip("Warp each data set into the pixel grid of the first data set "
+      "using its georeference instead of only offsetting it.");
    mpDlgBtns = new QDialogButtonBox(this);
    QPushButton* pOkButton = mpDlgBtns->addButton(QDialogButtonBox::Ok);
    pOkButton->setEnabled(false);
@@ -52,8 +55,9 @@ GeoMosaicDlg::GeoMosaicDlg(Progress* pProgress, QWidget* pParent) :
    pLayout->addWidget(mpPrimaryList, 1, 0, 1, 2);
    pLayout->addWidget(mpCreateAnimationCheckBox, 2, 0);
    pLayout->addWidget(pBrowser, 2, 1);
+   pLayout->addWidget(mpResampleCheckBox, 3, 0);
    pLayout->setColumnStretch(0, 10);
-   pLayout->addWidget(mpDlgBtns, 3, 0, 1, 2);
+   pLayout->addWidget(mpDlgBtns, 4, 0, 1, 2);
 
    // connections
    VERIFYNR(connect(pBrowser, SIGNAL(clicked()), this, SLOT(loadData())));
@@ -178,6 +182,7 @@ void GeoMosaicDlg::batchStitch()
    }
 
    pData->createAnimation = mpCreateAnimationCheckBox->isChecked();
+   pData->resample = mpResampleCheckBox->isChecked();
 
    if (!(pManager->geoStitch(pData, mProgressTracker.getCurrentProgress())))
    {
@@ -48,6 +48,7 @@ private:
    QDialogButtonBox* mpDlgBtns;
    QListWidget* mpPrimaryList;
    QCheckBox* mpCreateAnimationCheckBox;
+   QCheckBox* mpResampleCheckBox;
    ProgressTracker mProgressTracker;
 };
 
@@ -16,6 +16,8 @@
 #include "DateTime.h"
 #include "DesktopServices.h"
 #include "LayerList.h"
+#include "ModelServices.h"
+#include "MultiThreadedAlgorithm.h"
 #include "MosaicManager.h"
 #include "PlugInArgList.h"
 #include "PlugInRegistration.h"
@@ -24,12 +26,17 @@
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
 #include "RasterLayer.h"
+#include "RasterUtilities.h"
+#include "RasterWarper.h"
 #include "Slot.h"
 #include "SpatialDataView.h"
 #include "SpatialDataWindow.h"
 #include "SpecialMetadata.h"
+#include "Statistics.h"
 #include "UtilityServices.h"
 
+#include <algorithm>
+#include <math.h>
 #include <vector>
 
 REGISTER_PLUGIN_BASIC(OpticksGeoMosaic, MosaicManager);
@@ -271,18 +278,31 @@ bool MosaicManager::geoStitch(MosaicManager::MosaicData* pData, Progress* pProgr
       }
       else
       {
-         RasterLayer* pLayer = dynamic_cast<RasterLayer*>(mpView->createLayer(RASTER, pRaster));
-         if (pLayer != NULL)
+         // Resample the secondary image into the pixel grid of the primary image if requested, otherwise
+         // just offset the secondary image
+         LocationType offset;
+         RasterElement* pLayerRaster = NULL;
+         if (mpData->resample)
          {
-            mLayers.push_back(std::make_pair(pLayer, time));
+            pLayerRaster = resampleToPrimary(pPrimaryElement, pRaster, offset, pProgress);
+         }
+         if (pLayerRaster == NULL)
+         {
+            pLayerRaster = pRaster;
+
             // Calculate the pixel offsets for the secondary image by finding each corner's geolocation in it's own space
             // and determining which pixel that woold be in the space of the primary element
             int Sx1(0);
             int Sy1(0);
             LocationType secondaryLlc = pRaster->convertPixelToGeocoord(LocationType(Sx1, Sy1));
-            LocationType primarySecondaryLlc = pPrimaryElement->convertGeocoordToPixel(secondaryLlc);
-            pLayer->setXOffset(primarySecondaryLlc.mX);
-            pLayer->setYOffset(primarySecondaryLlc.mY);
+            offset = pPrimaryElement->convertGeocoordToPixel(secondaryLlc);
+         }
+         RasterLayer* pLayer = dynamic_cast<RasterLayer*>(mpView->createLayer(RASTER, pLayerRaster));
+         if (pLayer != NULL)
+         {
+            mLayers.push_back(std::make_pair(pLayer, time));
+            pLayer->setXOffset(offset.mX);
+            pLayer->setYOffset(offset.mY);
             if (mpData->createAnimation)
             {
                mpView->hideLayer(pLayer);
@@ -320,6 +340,95 @@ bool MosaicManager::geoStitch(MosaicManager::MosaicData* pData, Progress* pProgr
    return true;
 }
 
+RasterElement* MosaicManager::resampleToPrimary(RasterElement* pPrimary, RasterElement* pRaster,
+                                                LocationType& offset, Progress* pProgress)
+{
+   if (pPrimary == NULL || pRaster == NULL)
+   {
+      return NULL;
+   }
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   if (pDescriptor == NULL)
+   {
+      return NULL;
+   }
+
+   // Find the footprint of the secondary image in the primary pixel grid. The edges are sampled since
+   // the footprint is not necessarily a parallelogram.
+   const unsigned int edgeSamples = 8;
+   double rows = pDescriptor->getRowCount();
+   double columns = pDescriptor->getColumnCount();
+   std::vector<LocationType> edges;
+   for (unsigned int i = 0; i <= edgeSamples; ++i)
+   {
+      double x = columns * i / edgeSamples;
+      double y = rows * i / edgeSamples;
+      edges.push_back(LocationType(x, 0.0));
+      edges.push_back(LocationType(x, rows));
+      edges.push_back(LocationType(0.0, y));
+      edges.push_back(LocationType(columns, y));
+   }
+   std::vector<LocationType> footprint = pPrimary->convertGeocoordsToPixels(pRaster->convertPixelsToGeocoords(edges));
+   if (footprint.empty())
+   {
+      return NULL;
+   }
+   LocationType minPixel = footprint.front();
+   LocationType maxPixel = footprint.front();
+   for (std::vector<LocationType>::const_iterator pixel = footprint.begin(); pixel != footprint.end(); ++pixel)
+   {
+      minPixel.mX = std::min(minPixel.mX, pixel->mX);
+      minPixel.mY = std::min(minPixel.mY, pixel->mY);
+      maxPixel.mX = std::max(maxPixel.mX, pixel->mX);
+      maxPixel.mY = std::max(maxPixel.mY, pixel->mY);
+   }
+   offset = LocationType(floor(minPixel.mX), floor(minPixel.mY));
+   int warpedColumns = static_cast<int>(ceil(maxPixel.mX) - offset.mX);
+   int warpedRows = static_cast<int>(ceil(maxPixel.mY) - offset.mY);
+   if (warpedColumns <= 0 || warpedRows <= 0)
+   {
+      return NULL;
+   }
+
+   ModelResource<RasterElement> pWarped(RasterUtilities::createRasterElement(pRaster->getName() + " Mosaic",
+      warpedRows, warpedColumns, pDescriptor->getBandCount(), pDescriptor->getDataType(), BSQ,
+      pDescriptor->getProcessingLocation() == IN_MEMORY, pRaster));
+   if (pWarped.get() == NULL)
+   {
+      return NULL;
+   }
+   pWarped->copyClassification(pRaster);
+
+   GeoreferenceWarpMapping mapping(pPrimary, pRaster, offset.mX, offset.mY);
+   RasterWarper warper(pRaster, mapping);
+   warper.setInterpolation(RasterUtilities::BILINEAR);
+   mta::ProgressObjectReporter reporter("Resampling " + pRaster->getName(), pProgress);
+   if (!warper.warp(pWarped.get(), &reporter))
+   {
+      if (pProgress != NULL)
+      {
+         pProgress->updateProgress("Unable to resample " + pRaster->getName() + ": " + warper.getErrorText() +
+            " The image will be offset instead.", 0, WARNING);
+      }
+      return NULL;
+   }
+
+   // Pixels outside of the secondary image are bad values so they are not drawn over the other images
+   const RasterDataDescriptor* pWarpedDescriptor =
+      static_cast<const RasterDataDescriptor*>(pWarped->getDataDescriptor());
+   std::vector<int> badValues(1, 0);
+   for (unsigned int band = 0; band < pWarpedDescriptor->getBandCount(); ++band)
+   {
+      Statistics* pStatistics = pWarped->getStatistics(pWarpedDescriptor->getActiveBand(band));
+      if (pStatistics != NULL)
+      {
+         pStatistics->setBadValues(badValues);
+      }
+   }
+
+   return pWarped.release();
+}
+
 bool MosaicManager::createAnimation(bool haveTimes, Progress* pProgress)
 {
    if (mpData == NULL || mpView.get() == NULL)
@@ -12,6 +12,7 @@
 
 #include "AttachmentPtr.h"
 #include "ExecutableShell.h"
+#include "LocationType.h"
 #include "SpatialDataView.h"
 
 #include <vector>
@@ -27,9 +28,14 @@ class MosaicManager : public ExecutableShell
 public:
    struct MosaicData
    {
+      MosaicData() :
+         createAnimation(false),
+         resample(false)
+      {}
       virtual ~MosaicData() {}
 
       bool createAnimation;
+      bool resample;
       std::vector<RasterElement*> mpRasters;
    };
 
@@ -49,6 +55,8 @@ private:
    void layerDeleted(Subject& subject, const std::string& signal, const boost::any& value);
    void changeFrame(Subject& subject, const std::string& signalName, const boost::any& data);
    bool createAnimation(bool haveTimes, Progress* pProgress);
+   RasterElement* resampleToPrimary(RasterElement* pPrimary, RasterElement* pRaster, LocationType& offset,
+      Progress* pProgress);
 
    AttachmentPtr<SpatialDataView> mpView;
    MosaicData* mpData;
@@ -9,6 +9,7 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <geotiff.h>
 #include <geovalues.h>
@@ -24,6 +25,7 @@
 #include "GeoTIFFExporter.h"
 #include "MessageLogResource.h"
 #include "ModelServices.h"
+#include "MultiThreadedAlgorithm.h"
 #include "OptionsTiffExporter.h"
 #include "PlugInArg.h"
 #include "PlugInArgList.h"
@@ -33,9 +35,14 @@
 #include "RasterElement.h"
 #include "RasterDataDescriptor.h"
 #include "RasterFileDescriptor.h"
+#include "ThreadPool.h"
 
 #include <QtGui/QLayout>
 
+#include <algorithm>
+#include <deque>
+#include <vector>
+
 using namespace std;
 
 namespace
@@ -61,6 +68,389 @@ namespace
       return SAMPLEFORMAT_VOID;
    }
 
+   bool getTiffCompression(const string& name, uint16& compression)
+   {
+      if (name == "None")
+      {
+         compression = COMPRESSION_NONE;
+      }
+      else if (name == "PackBits")
+      {
+         compression = COMPRESSION_PACKBITS;
+      }
+      else if (name == "LZW")
+      {
+         compression = COMPRESSION_LZW;
+      }
+      else if (name == "Deflate")
+      {
+         compression = COMPRESSION_ADOBE_DEFLATE;
+      }
+#if defined(COMPRESSION_ZSTD)
+      else if (name == "ZSTD")
+      {
+         compression = COMPRESSION_ZSTD;
+      }
+#endif
+      else
+      {
+         return false;
+      }
+
+      return TIFFIsCODECConfigured(compression) != 0;
+   }
+
+   // The layout shared by every tile of the exported image
+   struct TileFormat
+   {
+      uint32 mWidth;
+      uint32 mHeight;
+      uint16 mBitsPerSample;
+      uint16 mSampleFormat;
+      uint16 mCompression;
+      uint16 mPredictor;
+      vector<unsigned int> mBands;
+
+      void setFields(TIFF* pTiff, uint32 imageWidth, uint32 imageHeight) const
+      {
+         TIFFSetField(pTiff, TIFFTAG_IMAGEWIDTH, imageWidth);
+         TIFFSetField(pTiff, TIFFTAG_IMAGELENGTH, imageHeight);
+         TIFFSetField(pTiff, TIFFTAG_TILEWIDTH, mWidth);
+         TIFFSetField(pTiff, TIFFTAG_TILELENGTH, mHeight);
+         TIFFSetField(pTiff, TIFFTAG_SAMPLESPERPIXEL, static_cast<uint16>(mBands.size()));
+         TIFFSetField(pTiff, TIFFTAG_BITSPERSAMPLE, mBitsPerSample);
+         TIFFSetField(pTiff, TIFFTAG_SAMPLEFORMAT, mSampleFormat);
+         TIFFSetField(pTiff, TIFFTAG_COMPRESSION, mCompression);
+         if (mPredictor != PREDICTOR_NONE)
+         {
+            TIFFSetField(pTiff, TIFFTAG_PREDICTOR, mPredictor);
+         }
+
+         TIFFSetField(pTiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
+         TIFFSetField(pTiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+         TIFFSetField(pTiff, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+      }
+   };
+
+   // The active rows and columns of the element which make up one resolution level
+   struct TileLevel
+   {
+      vector<unsigned int> mRows;
+      vector<unsigned int> mColumns;
+
+      unsigned int getTilesDown(const TileFormat& format) const
+      {
+         return static_cast<unsigned int>((mRows.size() + format.mHeight - 1) / format.mHeight);
+      }
+
+      unsigned int getTilesAcross(const TileFormat& format) const
+      {
+         return static_cast<unsigned int>((mColumns.size() + format.mWidth - 1) / format.mWidth);
+      }
+
+      TileLevel reduce() const
+      {
+         // Overviews are decimated by nearest neighbor so no new values are introduced into the data
+         TileLevel level;
+         for (vector<unsigned int>::size_type i = 0; i < mRows.size(); i += 2)
+         {
+            level.mRows.push_back(mRows[i]);
+         }
+
+         for (vector<unsigned int>::size_type i = 0; i < mColumns.size(); i += 2)
+         {
+            level.mColumns.push_back(mColumns[i]);
+         }
+
+         return level;
+      }
+   };
+
+   // A growable file in memory which libtiff encodes a single tile into
+   struct MemoryFile
+   {
+      vector<char> mData;
+      toff_t mOffset;
+
+      static tsize_t read(thandle_t pHandle, tdata_t pBuffer, tsize_t size)
+      {
+         MemoryFile* pFile = reinterpret_cast<MemoryFile*>(pHandle);
+         if (pFile->mOffset >= pFile->mData.size())
+         {
+            return 0;
+         }
+
+         size = min(size, static_cast<tsize_t>(pFile->mData.size() - pFile->mOffset));
+         memcpy(pBuffer, &pFile->mData[pFile->mOffset], size);
+         pFile->mOffset += size;
+         return size;
+      }
+
+      static tsize_t write(thandle_t pHandle, tdata_t pBuffer, tsize_t size)
+      {
+         MemoryFile* pFile = reinterpret_cast<MemoryFile*>(pHandle);
+         if (pFile->mOffset + size > pFile->mData.size())
+         {
+            pFile->mData.resize(pFile->mOffset + size);
+         }
+
+         if (size > 0)
+         {
+            memcpy(&pFile->mData[pFile->mOffset], pBuffer, size);
+         }
+
+         pFile->mOffset += size;
+         return size;
+      }
+
+      static toff_t seek(thandle_t pHandle, toff_t offset, int whence)
+      {
+         MemoryFile* pFile = reinterpret_cast<MemoryFile*>(pHandle);
+         switch (whence)
+         {
+         case SEEK_CUR:
+            pFile->mOffset += offset;
+            break;
+         case SEEK_END:
+            pFile->mOffset = pFile->mData.size() + offset;
+            break;
+         default:
+            pFile->mOffset = offset;
+            break;
+         }
+
+         return pFile->mOffset;
+      }
+
+      static int close(thandle_t)
+      {
+         return 0;
+      }
+
+      static toff_t size(thandle_t pHandle)
+      {
+         return reinterpret_cast<MemoryFile*>(pHandle)->mData.size();
+      }
+
+      static int map(thandle_t, tdata_t*, toff_t*)
+      {
+         return 0;
+      }
+
+      static void unmap(thandle_t, tdata_t, toff_t)
+      {}
+   };
+
+   // Reads one tile through native interleave accessors and compresses it on a pool thread
+   class TileTask : public mta::ThreadCommand
+   {
+   public:
+      TileTask(const RasterElement* pRaster, const TileFormat& format, const TileLevel& level, unsigned int tileRow,
+         unsigned int tileColumn, mta::TaskGroup& group) :
+         mpRaster(pRaster),
+         mFormat(format),
+         mLevel(level),
+         mTileRow(tileRow),
+         mTileColumn(tileColumn),
+         mGroup(group),
+         mComplete(0)
+      {}
+
+      void run()
+      {
+         vector<char> tile;
+         if (read(tile))
+         {
+            encode(tile);
+         }
+
+         // The group is copied first since the tile can be destroyed as soon as it is complete
+         mta::TaskGroup& group = mGroup;
+         mComplete.set(1);
+         group.notify();
+      }
+
+      bool isComplete() const
+      {
+         return mComplete.get() != 0;
+      }
+
+      unsigned int getTileRow() const
+      {
+         return mTileRow;
+      }
+
+      unsigned int getTileColumn() const
+      {
+         return mTileColumn;
+      }
+
+      vector<char>& getData()
+      {
+         return mData;
+      }
+
+      const string& getError() const
+      {
+         return mError;
+      }
+
+   private:
+      TileTask& operator=(const TileTask& rhs);
+
+      bool read(vector<char>& tile)
+      {
+         const RasterDataDescriptor* pDescriptor =
+            dynamic_cast<const RasterDataDescriptor*>(mpRaster->getDataDescriptor());
+         VERIFY(pDescriptor != NULL);
+
+         InterleaveFormatType interleave = pDescriptor->getInterleaveFormat();
+         unsigned int bytesPerElement = pDescriptor->getBytesPerElement();
+         unsigned int bandCount = pDescriptor->getBandCount();
+         unsigned int columnCount = pDescriptor->getColumnCount();
+         const vector<unsigned int>& bands = mFormat.mBands;
+         size_t pixelSize = bands.size() * bytesPerElement;
+
+         unsigned int firstRow = mTileRow * mFormat.mHeight;
+         unsigned int endRow = min(firstRow + mFormat.mHeight, static_cast<unsigned int>(mLevel.mRows.size()));
+         unsigned int firstColumn = mTileColumn * mFormat.mWidth;
+         unsigned int endColumn =
+            min(firstColumn + mFormat.mWidth, static_cast<unsigned int>(mLevel.mColumns.size()));
+
+         // BSQ bands are separate blocks of data, so each band has its own accessor
+         vector<DataAccessor> accessors;
+         unsigned int accessorCount = (interleave == BSQ ? static_cast<unsigned int>(bands.size()) : 1);
+         for (unsigned int i = 0; i < accessorCount; ++i)
+         {
+            FactoryResource<DataRequest> pRequest;
+            pRequest->setInterleaveFormat(interleave);
+            pRequest->setRows(pDescriptor->getActiveRow(mLevel.mRows[firstRow]),
+               pDescriptor->getActiveRow(mLevel.mRows[endRow - 1]), 1);
+            if (interleave == BSQ)
+            {
+               DimensionDescriptor band = pDescriptor->getActiveBand(bands[i]);
+               pRequest->setBands(band, band, 1);
+            }
+
+            DataAccessor accessor = mpRaster->getDataAccessor(pRequest.release());
+            if (accessor.isValid() == false)
+            {
+               mError = "Could not get a valid accessor for this dataset.";
+               return false;
+            }
+
+            accessors.push_back(accessor);
+         }
+
+         // Whole pixels can be copied from BIP data when every band is exported in order
+         bool copyPixels = (interleave == BIP && bands.size() == bandCount);
+         for (unsigned int i = 0; copyPixels && i < bands.size(); ++i)
+         {
+            copyPixels = (bands[i] == i);
+         }
+
+         // Edge tiles are padded with zeros to the full tile size
+         tile.resize(mFormat.mHeight * mFormat.mWidth * pixelSize, 0);
+         for (unsigned int row = firstRow; row < endRow; ++row)
+         {
+            vector<char*> pRows(accessors.size());
+            for (vector<DataAccessor>::size_type i = 0; i < accessors.size(); ++i)
+            {
+               accessors[i]->toPixel(static_cast<int>(mLevel.mRows[row]), 0);
+               if (accessors[i].isValid() == false)
+               {
+                  mError = "Unable to read the data to export.";
+                  return false;
+               }
+
+               pRows[i] = static_cast<char*>(accessors[i]->getRow());
+            }
+
+            char* pTile = &tile[(row - firstRow) * mFormat.mWidth * pixelSize];
+            for (unsigned int column = firstColumn; column < endColumn; ++column)
+            {
+               size_t sourceColumn = mLevel.mColumns[column];
+               if (copyPixels)
+               {
+                  memcpy(pTile, pRows.front() + sourceColumn * pixelSize, pixelSize);
+                  pTile += pixelSize;
+                  continue;
+               }
+
+               for (vector<unsigned int>::size_type band = 0; band < bands.size(); ++band)
+               {
+                  const char* pSource = NULL;
+                  switch (interleave)
+                  {
+                  case BIP:
+                     pSource = pRows.front() + (sourceColumn * bandCount + bands[band]) * bytesPerElement;
+                     break;
+                  case BIL:
+                     pSource = pRows.front() + (static_cast<size_t>(bands[band]) * columnCount + sourceColumn) *
+                        bytesPerElement;
+                     break;
+                  default:
+                     pSource = pRows[band] + sourceColumn * bytesPerElement;
+                     break;
+                  }
+
+                  memcpy(pTile, pSource, bytesPerElement);
+                  pTile += bytesPerElement;
+               }
+            }
+         }
+
+         return true;
+      }
+
+      bool encode(vector<char>& tile)
+      {
+         // libtiff only exposes its codecs through a file, so the tile is written to a file in memory
+         // and the compressed bytes are copied back out of it
+         MemoryFile file;
+         file.mOffset = 0;
+         TIFF* pTiff = TIFFClientOpen("tile", "w", reinterpret_cast<thandle_t>(&file), MemoryFile::read,
+            MemoryFile::write, MemoryFile::seek, MemoryFile::close, MemoryFile::size, MemoryFile::map,
+            MemoryFile::unmap);
+         if (pTiff == NULL)
+         {
+            mError = "Unable to create the tile encoder.";
+            return false;
+         }
+
+         mFormat.setFields(pTiff, mFormat.mWidth, mFormat.mHeight);
+
+         toff_t* pOffsets = NULL;
+         toff_t* pByteCounts = NULL;
+         bool success = TIFFWriteEncodedTile(pTiff, 0, &tile.front(), static_cast<tsize_t>(tile.size())) >= 0 &&
+            TIFFGetField(pTiff, TIFFTAG_TILEOFFSETS, &pOffsets) != 0 &&
+            TIFFGetField(pTiff, TIFFTAG_TILEBYTECOUNTS, &pByteCounts) != 0 &&
+            pOffsets != NULL && pByteCounts != NULL && pOffsets[0] + pByteCounts[0] <= file.mData.size();
+         if (success)
+         {
+            vector<char>::const_iterator first = file.mData.begin() + static_cast<ptrdiff_t>(pOffsets[0]);
+            mData.assign(first, first + static_cast<ptrdiff_t>(pByteCounts[0]));
+         }
+         else
+         {
+            mError = "Unable to compress a tile of the GeoTIFF file.";
+         }
+
+         TIFFClose(pTiff);
+         return success;
+      }
+
+      const RasterElement* mpRaster;
+      const TileFormat& mFormat;
+      const TileLevel& mLevel;
+      unsigned int mTileRow;
+      unsigned int mTileColumn;
+      mta::TaskGroup& mGroup;
+      mta::AtomicCounter mComplete;
+      vector<char> mData;
+      string mError;
+   };
+
 };
 
 REGISTER_PLUGIN_BASIC(OpticksPictures, GeoTIFFExporter);
@@ -71,7 +461,11 @@ GeoTIFFExporter::GeoTIFFExporter() :
    mpRaster(NULL),
    mpFileDescriptor(NULL),
    mAbortFlag(false),
-   mRowsPerStrip(OptionsTiffExporter::getSettingRowsPerStrip())
+   mRowsPerStrip(OptionsTiffExporter::getSettingRowsPerStrip()),
+   mTiled(OptionsTiffExporter::getSettingTiledOutput()),
+   mTileSize(OptionsTiffExporter::getSettingTileSize()),
+   mCompression(OptionsTiffExporter::getSettingTileCompression()),
+   mOverviews(OptionsTiffExporter::getSettingOverviews())
 {
    setName("GeoTIFF Exporter");
    setCreator("Ball Aerospace & Technologies Corp.");
@@ -113,6 +507,18 @@ bool GeoTIFFExporter::execute(PlugInArgList* pInParam, PlugInArgList* pOutParam)
    if (isBatch() == true)
    {
       pInParam->getPlugInArgValue("Rows Per Strip", mRowsPerStrip);
+      pInParam->getPlugInArgValue("Tiled Output", mTiled);
+      pInParam->getPlugInArgValue("Tile Size", mTileSize);
+      pInParam->getPlugInArgValue("Compression", mCompression);
+      pInParam->getPlugInArgValue("Overviews", mOverviews);
+   }
+   else if (mpOptionWidget.get() != NULL)
+   {
+      mpOptionWidget->applyChanges();
+      mTiled = mpOptionWidget->getTiledOutput();
+      mTileSize = mpOptionWidget->getTileSize();
+      mCompression = mpOptionWidget->getTileCompression();
+      mOverviews = mpOptionWidget->getOverviews();
    }
 
    // Check for complex data
@@ -181,7 +587,7 @@ bool GeoTIFFExporter::execute(PlugInArgList* pInParam, PlugInArgList* pOutParam)
       return false;
    }
 
-   bool success = writeCube(pOut);
+   bool success = (mTiled ? writeTiledCube(pOut) : writeCube(pOut));
    XTIFFClose(pOut);
 
    if (success)
@@ -228,6 +634,14 @@ bool GeoTIFFExporter::getInputSpecification(PlugInArgList*& pArgList)
    if (isBatch() == true)
    {
       VERIFY(pArgList->addArg<unsigned int>("Rows Per Strip", mRowsPerStrip, "Rows per strip for the TIFF file."));
+      VERIFY(pArgList->addArg<bool>("Tiled Output", mTiled, "Whether the TIFF file is written in tiles "
+         "instead of strips."));
+      VERIFY(pArgList->addArg<unsigned int>("Tile Size", mTileSize, "Width and height of each tile, rounded "
+         "up to a multiple of 16."));
+      VERIFY(pArgList->addArg<string>("Compression", mCompression, "Compression of the tiles: None, PackBits, "
+         "LZW, Deflate or ZSTD."));
+      VERIFY(pArgList->addArg<bool>("Overviews", mOverviews, "Whether reduced resolution images are written "
+         "after the tiled image."));
    }
 
    return true;
@@ -334,7 +748,6 @@ bool GeoTIFFExporter::writeCube(TIFF* pOut)
    bool packBits = OptionsTiffExporter::getSettingPackBitsCompression();
    if (mpOptionWidget.get() != NULL)
    {
-      mpOptionWidget->applyChanges();
       packBits = mpOptionWidget->getPackBitsCompression();
    }
    ttag_t compOpt = (packBits ? COMPRESSION_PACKBITS : COMPRESSION_NONE);
@@ -497,6 +910,12 @@ bool GeoTIFFExporter::writeCube(TIFF* pOut)
    }
 
    //assumed everything has been done correctly up to now
+   writeGeoreference(pOut, srows);
+   return true;
+}
+
+void GeoTIFFExporter::writeGeoreference(TIFF* pOut, int total)
+{
    //copy over Geo ref info if there are any, else
    //try to look for world file in same directory and apply
    if (!(applyWorldFile(pOut)))
@@ -505,15 +924,207 @@ bool GeoTIFFExporter::writeCube(TIFF* pOut)
       {
          //no geo info found, where is it located?
          mMessage = "Geo data is unavailable and will not be written to the output file!";
-         updateProgress(srows, srows, mMessage, WARNING);
+         updateProgress(total, total, mMessage, WARNING);
          if (mpStep != NULL)
          {
             mpStep->addMessage(mMessage, "app", "9C1E7ADE-ADC4-468c-B15E-FEB53D5FEF5B", true);
          }
       }
    }
+}
 
-   return true;
+bool GeoTIFFExporter::writeTiledCube(TIFF* pOut)
+{
+   if (pOut == NULL)
+   {
+      return false;
+   }
+
+   VERIFY(mpRaster != NULL);
+   VERIFY(mpFileDescriptor != NULL);
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(mpRaster->getDataDescriptor());
+   if (pDescriptor == NULL)
+   {
+      return false;
+   }
+
+   TileFormat format;
+   if (getTiffCompression(mCompression, format.mCompression) == false)
+   {
+      mMessage = "The " + mCompression + " compression is not available for GeoTIFF files.";
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress(mMessage, 0, ERRORS);
+      }
+
+      return false;
+   }
+
+   // The TIFF specification requires tile dimensions which are a multiple of 16
+   format.mWidth = max((mTileSize + 15) / 16 * 16, 16U);
+   format.mHeight = format.mWidth;
+   format.mBitsPerSample = static_cast<uint16>(pDescriptor->getBytesPerElement() * 8);
+   format.mSampleFormat = static_cast<uint16>(getTiffSampleFormat(pDescriptor->getDataType()));
+   format.mPredictor = PREDICTOR_NONE;
+   if (format.mSampleFormat != SAMPLEFORMAT_IEEEFP && format.mCompression != COMPRESSION_NONE &&
+      format.mCompression != COMPRESSION_PACKBITS)
+   {
+      format.mPredictor = PREDICTOR_HORIZONTAL;
+   }
+
+   // Only the rows, columns and bands in the file descriptor are exported
+   TileLevel level;
+   const vector<DimensionDescriptor>& rows = mpFileDescriptor->getRows();
+   for (vector<DimensionDescriptor>::const_iterator iter = rows.begin(); iter != rows.end(); ++iter)
+   {
+      if (iter->isActiveNumberValid())
+      {
+         level.mRows.push_back(iter->getActiveNumber());
+      }
+   }
+
+   const vector<DimensionDescriptor>& columns = mpFileDescriptor->getColumns();
+   for (vector<DimensionDescriptor>::const_iterator iter = columns.begin(); iter != columns.end(); ++iter)
+   {
+      if (iter->isActiveNumberValid())
+      {
+         level.mColumns.push_back(iter->getActiveNumber());
+      }
+   }
+
+   const vector<DimensionDescriptor>& bands = mpFileDescriptor->getBands();
+   for (vector<DimensionDescriptor>::const_iterator iter = bands.begin(); iter != bands.end(); ++iter)
+   {
+      if (iter->isActiveNumberValid())
+      {
+         format.mBands.push_back(iter->getActiveNumber());
+      }
+   }
+
+   if (level.mRows.empty() || level.mColumns.empty() || format.mBands.empty())
+   {
+      mMessage = "There is no data to export.";
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress(mMessage, 0, ERRORS);
+      }
+
+      return false;
+   }
+
+   // Each overview halves the previous level until the whole image fits in one tile
+   vector<TileLevel> levels(1, level);
+   while (mOverviews && (levels.back().getTilesDown(format) > 1 || levels.back().getTilesAcross(format) > 1))
+   {
+      levels.push_back(levels.back().reduce());
+   }
+
+   unsigned int tileCount = 0;
+   for (vector<TileLevel>::const_iterator iter = levels.begin(); iter != levels.end(); ++iter)
+   {
+      tileCount += iter->getTilesDown(format) * iter->getTilesAcross(format);
+   }
+
+   mMessage = "Writing out GeoTIFF file...";
+   if (mpProgress != NULL)
+   {
+      mpProgress->updateProgress(mMessage, 0, NORMAL);
+   }
+
+   // Tiles are compressed on the thread pool, but are written in order so the file is the same
+   // regardless of how many threads are used.  The number of tiles in flight is limited to bound
+   // the memory used by tiles which are waiting to be written.
+   size_t maxPendingTiles = 2 * max(mta::ThreadPool::instance().getWorkerCount(), 1U);
+   unsigned int tilesWritten = 0;
+   bool success = true;
+   for (vector<TileLevel>::size_type levelIndex = 0; success && levelIndex < levels.size(); ++levelIndex)
+   {
+      const TileLevel& currentLevel = levels[levelIndex];
+      if (levelIndex > 0)
+      {
+         if (TIFFWriteDirectory(pOut) == 0)
+         {
+            mMessage = "Unable to save GeoTIFF file, check folder permissions.";
+            success = false;
+            break;
+         }
+
+         TIFFSetField(pOut, TIFFTAG_SUBFILETYPE, FILETYPE_REDUCEDIMAGE);
+      }
+
+      format.setFields(pOut, static_cast<uint32>(currentLevel.mColumns.size()),
+         static_cast<uint32>(currentLevel.mRows.size()));
+      if (levelIndex == 0)
+      {
+         writeGeoreference(pOut, tileCount);
+      }
+
+      unsigned int tilesAcross = currentLevel.getTilesAcross(format);
+      unsigned int levelTileCount = currentLevel.getTilesDown(format) * tilesAcross;
+      unsigned int nextTile = 0;
+      deque<TileTask*> pendingTiles;
+      mta::TaskGroup tasks;
+      while (success && (nextTile < levelTileCount || pendingTiles.empty() == false))
+      {
+         while (nextTile < levelTileCount && pendingTiles.size() < maxPendingTiles)
+         {
+            TileTask* pTask = new TileTask(mpRaster, format, currentLevel, nextTile / tilesAcross,
+               nextTile % tilesAcross, tasks);
+            pendingTiles.push_back(pTask);
+            tasks.run(*pTask);
+            ++nextTile;
+         }
+
+         TileTask* pTask = pendingTiles.front();
+         while (pTask->isComplete() == false && mAbortFlag == false)
+         {
+            tasks.wait(100);
+         }
+
+         if (mAbortFlag)
+         {
+            mMessage = "GeoTIFF export aborted!";
+            success = false;
+            break;
+         }
+
+         vector<char>& data = pTask->getData();
+         if (data.empty())
+         {
+            mMessage = pTask->getError();
+            success = false;
+            break;
+         }
+
+         ttile_t tile = TIFFComputeTile(pOut, pTask->getTileColumn() * format.mWidth,
+            pTask->getTileRow() * format.mHeight, 0, 0);
+         if (TIFFWriteRawTile(pOut, tile, &data.front(), static_cast<tsize_t>(data.size())) < 0)
+         {
+            mMessage = "Unable to save GeoTIFF file, check folder permissions.";
+            success = false;
+            break;
+         }
+
+         pendingTiles.pop_front();
+         delete pTask;
+         updateProgress(++tilesWritten, tileCount, "Writing out GeoTIFF file...", NORMAL);
+      }
+
+      // Tiles which are still being compressed must finish before they are destroyed
+      tasks.wait();
+      for (deque<TileTask*>::iterator iter = pendingTiles.begin(); iter != pendingTiles.end(); ++iter)
+      {
+         delete *iter;
+      }
+   }
+
+   if (success == false && mpProgress != NULL)
+   {
+      mpProgress->updateProgress(mMessage, 0, ERRORS);
+   }
+
+   return success;
 }
 
 bool GeoTIFFExporter::CreateGeoTIFF(TIFF *pOut)
@@ -40,6 +40,8 @@ private:
    bool applyWorldFile(TIFF* pOut);
    void updateProgress(int current, int total, std::string progressString, ReportingLevel l = NORMAL);
    bool writeCube(TIFF* pOut);
+   bool writeTiledCube(TIFF* pOut);
+   void writeGeoreference(TIFF* pOut, int total);
 
    Step* mpStep;
    std::auto_ptr<OptionsTiffExporter> mpOptionWidget;
@@ -51,6 +53,10 @@ private:
    bool mAbortFlag;
    std::string mMessage;
    unsigned int mRowsPerStrip;
+   bool mTiled;
+   unsigned int mTileSize;
+   std::string mCompression;
+   bool mOverviews;
 };
 
 #endif
@@ -334,6 +334,13 @@ RasterPage* GeoTiffPager::getPage(DataRequest *pOriginalRequest,
       unsigned int colNumber = startColumn.getOnDiskNumber();
       unsigned int bandNumber = startBand.getOnDiskNumber();
 
+      // tiles at the bottom and right edges of the data may be smaller than requested
+      if (pOriginalRequest->getTiled() && rowNumber < mRowCount && colNumber < mColumnCount)
+      {
+         concurrentRows = min(concurrentRows, mRowCount - rowNumber);
+         concurrentColumns = min(concurrentColumns, mColumnCount - colNumber);
+      }
+
       // make sure the request is valid
       if ((rowNumber >= mRowCount) || ((rowNumber + concurrentRows) > mRowCount) ||
          (colNumber >= mColumnCount) || ((colNumber + concurrentColumns) > mColumnCount) ||
@@ -495,28 +502,33 @@ RasterPage* GeoTiffPager::getPage(DataRequest *pOriginalRequest,
          // This is stated in the TIFF 6.0 spec on page 68 (in the TileOffsets definition)
          const uint32 tileOffset(mInterleave == BIP ? 0 : bandNumber * tilesAcross * tilesDown);
 
-         // The 0-based index of the first desired tile
-         const ttile_t startTileIndex(rowNumber / tileLength);
+         // The 0-based indices of the first and last desired rows of tiles
+         const uint32 startTileRow(rowNumber / tileLength);
+         const uint32 endTileRow((rowNumber + concurrentRows - 1) / tileLength);
 
-         // The tile containing the first column of the first requested row
-         const ttile_t startTile(tileOffset + startTileIndex * tilesAcross);
-         if (startTile < 0)
+         // The 0-based indices of the first and last desired columns of tiles
+         // Tiled requests only load the tiles containing the requested columns,
+         // other requests load complete rows of tiles
+         uint32 startTileColumn(0);
+         uint32 endTileColumn(tilesAcross - 1);
+         if (pOriginalRequest->getTiled())
          {
-            throw string("Cannot determine startTile");
+            startTileColumn = colNumber / tileWidth;
+            endTileColumn = (colNumber + concurrentColumns - 1) / tileWidth;
          }
+         const uint32 numTileColumns(endTileColumn - startTileColumn + 1);
 
-         // The 0-based index of the last desired tile
-         const ttile_t endTileIndex((rowNumber + concurrentRows - 1) / tileLength);
-
-         // The tile containing the last column of the last requested row
-         const ttile_t endTile(tileOffset + endTileIndex * tilesAcross + tilesAcross - 1);
-         if (endTile < 0)
+         vector<unsigned int> tiles;
+         for (uint32 tileRow = startTileRow; tileRow <= endTileRow; ++tileRow)
          {
-            throw string("Cannot determine endTile");
+            for (uint32 tileColumn = startTileColumn; tileColumn <= endTileColumn; ++tileColumn)
+            {
+               tiles.push_back(tileOffset + tileRow * tilesAcross + tileColumn);
+            }
          }
 
          // Retrieve a block from the cache
-         GeoTiffOnDisk::CacheUnit* pCacheUnit(mBlockCache.getCacheUnit(startTile, endTile, tileSize));
+         GeoTiffOnDisk::CacheUnit* pCacheUnit(mBlockCache.getCacheUnit(tiles, tileSize));
          if (pCacheUnit == NULL)
          {
             throw string("Cannot create a cache unit");
@@ -525,25 +537,31 @@ RasterPage* GeoTiffPager::getPage(DataRequest *pOriginalRequest,
          // The number of bands in pPage
          const unsigned int bandSkip(mInterleave == BIP ? mBandCount : 1);
 
-         // The number of columns in pPage
-         const unsigned int columnSkip(mColumnCount);
+         // The number of bytes in each pixel and each row of a tile
+         const size_t pixelSize(bandSkip * mBytesPerElement);
+         const size_t tileRowSize(tileWidth * pixelSize);
+
+         // The number of columns in each row of the block, including the padding in partial tiles
+         const size_t blockColumns(numTileColumns * tileWidth);
 
          // The offset of the first requested data within pPage
-         const size_t offset(mBytesPerElement *
-            ((rowNumber % tileLength) * columnSkip * bandSkip + (mInterleave == BSQ ? 0 : bandNumber)));
+         const size_t offset(pixelSize * ((rowNumber - startTileRow * tileLength) * blockColumns +
+            (colNumber - startTileColumn * tileWidth)) + (mInterleave == BSQ ? 0 : bandNumber * mBytesPerElement));
 
-         // The number of rows in pPage
-         const unsigned int rowSkip(tileLength * ((endTile - startTile + 1) / tilesAcross));
+         // The number of rows and columns in pPage
+         const unsigned int rowSkip(min((endTileRow + 1) * tileLength, mRowCount) - rowNumber);
+         const unsigned int columnSkip(min((endTileColumn + 1) * tileWidth, mColumnCount) - colNumber);
 
          // Create a GeoTiffPage based on the computed values
-         pPage = new GeoTiffPage(pCacheUnit, offset, rowSkip, columnSkip, bandSkip);
+         pPage = new GeoTiffPage(pCacheUnit, offset, rowSkip, columnSkip, bandSkip,
+            (blockColumns - columnSkip) * pixelSize);
          if (pCacheUnit->isEmpty())
          {
             // Temporary storage for the working tile
             vector<unsigned char> tileData(tileSize);
-            for (ttile_t curTile = startTile, tileNum = 0; curTile <= endTile; ++curTile, ++tileNum)
+            for (size_t tileNum = 0; tileNum < tiles.size(); ++tileNum)
             {
-               if (TIFFReadEncodedTile(mpTiff, curTile, &tileData[0], tileSize) != tileSize)
+               if (TIFFReadEncodedTile(mpTiff, tiles[tileNum], &tileData[0], tileSize) != tileSize)
                {
                   throw string("Error reading TIFF data");
                }
@@ -552,24 +570,15 @@ RasterPage* GeoTiffPager::getPage(DataRequest *pOriginalRequest,
                char* pBlockPos(pCacheUnit->data());
 
                // Increment by one or more rows of tiles
-               pBlockPos += tileSize * tilesAcross * bandSkip * mBytesPerElement * (tileNum / tilesAcross);
+               pBlockPos += tileRowSize * numTileColumns * tileLength * (tileNum / numTileColumns);
 
                // Increment by one or more tiles within a row
-               pBlockPos += tileWidth * bandSkip * mBytesPerElement * (tileNum % tilesAcross);
-
-               // The number of bytes to copy - this might be different for partial tiles (e.g.: at the end of a row)
-               size_t numBytesToCopy = tileWidth;
-               if ((tileNum + 1) % tilesAcross == 0 && mColumnCount % tileWidth != 0)
-               {
-                  numBytesToCopy = mColumnCount % tileWidth;
-               }
+               pBlockPos += tileRowSize * (tileNum % numTileColumns);
 
-               numBytesToCopy *= bandSkip * mBytesPerElement;
+               // Partial tiles are padded to the full tile size so each tile row can be copied completely
                for (uint32 row = 0; row < tileLength; ++row)
                {
-                  const size_t rowOffset = row * mColumnCount * bandSkip * mBytesPerElement;
-                  const size_t tileOffset = row * tileWidth * bandSkip * mBytesPerElement;
-                  memcpy(pBlockPos + rowOffset, &tileData[tileOffset], numBytesToCopy);
+                  memcpy(pBlockPos + row * blockColumns * pixelSize, &tileData[row * tileRowSize], tileRowSize);
                }
             }
 
@@ -607,5 +616,5 @@ void GeoTiffPager::releasePage(RasterPage *pPage)
 
 int GeoTiffPager::getSupportedRequestVersion() const
 {
-   return 1;
+   return 2;
 }
@@ -8,6 +8,7 @@
  */
 
 #include <QtGui/QCheckBox>
+#include <QtGui/QComboBox>
 #include <QtGui/QLabel>
 #include <QtGui/QGridLayout>
 #include <QtGui/QSpinBox>
@@ -55,15 +56,70 @@ OptionsTiffExporter::OptionsTiffExporter() :
 
    LabeledSection* pPackBitsSection = new LabeledSection(pPackBitsLayoutWidget, "Compression Options", this);
 
+   // Tiles
+   QWidget* pTileLayoutWidget = new QWidget(this);
+
+   mpTiled = new QCheckBox("Write Tiles", pTileLayoutWidget);
+
+   QLabel* pTileSizeLabel = new QLabel("Tile Size: ", pTileLayoutWidget);
+   mpTileSize = new QSpinBox(pTileLayoutWidget);
+   mpTileSize->setRange(16, 4096);
+   mpTileSize->setSingleStep(16);
+
+   QLabel* pTileCompressionLabel = new QLabel("Compression: ", pTileLayoutWidget);
+   mpTileCompression = new QComboBox(pTileLayoutWidget);
+   mpTileCompression->setEditable(false);
+   mpTileCompression->addItem("None");
+   mpTileCompression->addItem("PackBits");
+   mpTileCompression->addItem("LZW");
+   mpTileCompression->addItem("Deflate");
+
+   mpOverviews = new QCheckBox("Internal Overviews", pTileLayoutWidget);
+
+   QGridLayout* pTileLayout = new QGridLayout(pTileLayoutWidget);
+   pTileLayout->setMargin(0);
+   pTileLayout->setSpacing(5);
+   pTileLayout->addWidget(mpTiled, 0, 0, 1, 2);
+   pTileLayout->addWidget(pTileSizeLabel, 1, 0);
+   pTileLayout->addWidget(mpTileSize, 1, 1);
+   pTileLayout->addWidget(pTileCompressionLabel, 2, 0);
+   pTileLayout->addWidget(mpTileCompression, 2, 1);
+   pTileLayout->addWidget(mpOverviews, 3, 1);
+   pTileLayout->setColumnStretch(2, 10);
+
+   LabeledSection* pTileSection = new LabeledSection(pTileLayoutWidget, "Tiled Output", this);
+
    // Initialization
    addSection(pResolutionSection);
    addSection(pPackBitsSection);
+   addSection(pTileSection);
    addStretch(10);
-   setSizeHint(350, 250);
+   setSizeHint(350, 350);
+
+   // Connections
+   connect(mpTiled, SIGNAL(toggled(bool)), mpTileSize, SLOT(setEnabled(bool)));
+   connect(mpTiled, SIGNAL(toggled(bool)), mpTileCompression, SLOT(setEnabled(bool)));
+   connect(mpTiled, SIGNAL(toggled(bool)), mpOverviews, SLOT(setEnabled(bool)));
+   connect(mpTiled, SIGNAL(toggled(bool)), mpRowsPerStrip, SLOT(setDisabled(bool)));
+   connect(mpTiled, SIGNAL(toggled(bool)), mpPackBits, SLOT(setDisabled(bool)));
 
    // Initialize From Settings
    mpPackBits->setChecked(OptionsTiffExporter::getSettingPackBitsCompression());
    mpRowsPerStrip->setValue(static_cast<int>(OptionsTiffExporter::getSettingRowsPerStrip()));
+   mpTiled->setChecked(OptionsTiffExporter::getSettingTiledOutput());
+   mpTileSize->setValue(static_cast<int>(OptionsTiffExporter::getSettingTileSize()));
+   mpOverviews->setChecked(OptionsTiffExporter::getSettingOverviews());
+
+   int compressionIndex =
+      mpTileCompression->findText(QString::fromStdString(OptionsTiffExporter::getSettingTileCompression()));
+   mpTileCompression->setCurrentIndex(compressionIndex < 0 ? 0 : compressionIndex);
+
+   bool tiled = mpTiled->isChecked();
+   mpTileSize->setEnabled(tiled);
+   mpTileCompression->setEnabled(tiled);
+   mpOverviews->setEnabled(tiled);
+   mpRowsPerStrip->setDisabled(tiled);
+   mpPackBits->setDisabled(tiled);
 }
 
 void OptionsTiffExporter::applyChanges()
@@ -78,6 +134,10 @@ void OptionsTiffExporter::applyChanges()
    OptionsTiffExporter::setSettingAspectRatioLock(mpResolutionWidget->getAspectRatioLock());
    OptionsTiffExporter::setSettingOutputWidth(outputWidth);
    OptionsTiffExporter::setSettingOutputHeight(outputHeight);
+   OptionsTiffExporter::setSettingTiledOutput(mpTiled->isChecked());
+   OptionsTiffExporter::setSettingTileSize(static_cast<unsigned int>(mpTileSize->value()));
+   OptionsTiffExporter::setSettingTileCompression(getTileCompression());
+   OptionsTiffExporter::setSettingOverviews(mpOverviews->isChecked());
 }
 
 OptionsTiffExporter::~OptionsTiffExporter()
@@ -88,3 +148,23 @@ bool OptionsTiffExporter::getPackBitsCompression()
 {
    return mpPackBits->isChecked();
 }
+
+bool OptionsTiffExporter::getTiledOutput()
+{
+   return mpTiled->isChecked();
+}
+
+unsigned int OptionsTiffExporter::getTileSize()
+{
+   return static_cast<unsigned int>(mpTileSize->value());
+}
+
+string OptionsTiffExporter::getTileCompression()
+{
+   return mpTileCompression->currentText().toStdString();
+}
+
+bool OptionsTiffExporter::getOverviews()
+{
+   return mpOverviews->isChecked();
+}
@@ -14,7 +14,10 @@
 #include "ConfigurationSettings.h"
 #include "LabeledSectionGroup.h"
 
+#include <string>
+
 class QCheckBox;
+class QComboBox;
 class QSpinBox;
 class ResolutionWidget;
 
@@ -32,8 +35,16 @@ public:
    SETTING(AspectRatioLock, TiffExporter, bool, false);
    SETTING(OutputWidth, TiffExporter, unsigned int, 0);
    SETTING(OutputHeight, TiffExporter, unsigned int, 0);
+   SETTING(TiledOutput, TiffExporter, bool, false);
+   SETTING(TileSize, TiffExporter, unsigned int, 256);
+   SETTING(TileCompression, TiffExporter, std::string, "Deflate");
+   SETTING(Overviews, TiffExporter, bool, true);
 
    bool getPackBitsCompression();
+   bool getTiledOutput();
+   unsigned int getTileSize();
+   std::string getTileCompression();
+   bool getOverviews();
    void applyChanges();
 
    static const std::string& getName()
@@ -95,6 +106,10 @@ private:
 
    QCheckBox* mpPackBits;
    QSpinBox* mpRowsPerStrip;
+   QCheckBox* mpTiled;
+   QSpinBox* mpTileSize;
+   QComboBox* mpTileCompression;
+   QCheckBox* mpOverviews;
    ResolutionWidget* mpResolutionWidget;
 };
 
@@ -13,7 +13,8 @@
 
 using namespace std;
 
-Feature::Feature(ShapefileTypes::ShapeType eShape)
+Feature::Feature(ShapefileTypes::ShapeType eShape) :
+   mShape(eShape)
 {}
 
 ShapefileTypes::ShapeType Feature::getShape() const
@@ -43,6 +44,16 @@ bool Feature::removeVertex(int iIndex)
       {
          FeatureVertex oldVertex = *iter;
          mVertices.erase(iter);
+
+         // Keep the following parts starting at the same vertices
+         for (vector<int>::iterator part = mParts.begin(); part != mParts.end(); ++part)
+         {
+            if (*part > iIndex)
+            {
+               --(*part);
+            }
+         }
+
          notify(SIGNAL_NAME(Feature, VertexRemoved), boost::any(oldVertex));
          return true;
       }
@@ -78,6 +89,7 @@ void Feature::clearVertices()
 {
    bool emit = !mVertices.empty();
    mVertices.clear();
+   mParts.clear();
    if (emit)
    {
       notify(SIGNAL_NAME(Feature, Cleared));
@@ -180,12 +192,27 @@ bool Feature::isKindOf(const string& className) const
    return SubjectAdapter::isKindOf(className);
 }
 
+void Feature::addPart()
+{
+   // The first part always starts at the first vertex
+   int iStart = static_cast<int>(mVertices.size());
+   if (iStart > 0 && (mParts.empty() || mParts.back() != iStart))
+   {
+      mParts.push_back(iStart);
+   }
+}
+
 int Feature::getPart(int iIndex) const
 {
-   return 0;
+   if (iIndex <= 0 || iIndex > static_cast<int>(mParts.size()))
+   {
+      return 0;
+   }
+
+   return mParts[iIndex - 1];
 }
 
 unsigned int Feature::getNumParts() const
 {
-   return 1;
+   return mParts.size() + 1;
 }
@@ -66,6 +66,13 @@ public:
     * @notify  signalVertexRemoved
     */
    void clearVertices();
+   /**
+    *  Starts a new part, such as a hole in a polygon, with the next vertex that is added.
+    */
+   void addPart();
+   /**
+    *  Returns the index of the first vertex in a part.
+    */
    int getPart(int iIndex) const;
    unsigned int getNumParts() const;
 
@@ -97,6 +104,7 @@ public:
 private:
    ShapefileTypes::ShapeType mShape;
    std::vector<FeatureVertex> mVertices;
+   std::vector<int> mParts;
    FactoryResource<DynamicObject> mpFields;
 };
 
@@ -0,0 +1,535 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "BitMask.h"
+#include "BitMaskIterator.h"
+#include "MaskPolygonizer.h"
+#include "RasterElement.h"
+
+#include <algorithm>
+#include <map>
+#include <math.h>
+
+using namespace std;
+
+namespace
+{
+   // The selected pixels of a row from mStart up to but not including mEnd
+   struct Run
+   {
+      Run(int start, int end, unsigned int label) : mStart(start), mEnd(end), mLabel(label) {}
+
+      int mStart;
+      int mEnd;
+      unsigned int mLabel;
+   };
+
+   // A boundary between pixel corners with the selected pixels on its right
+   struct Edge
+   {
+      Edge(int x1, int y1, int x2, int y2, unsigned int label) :
+         mX1(x1), mY1(y1), mX2(x2), mY2(y2), mLabel(label) {}
+
+      int mX1;
+      int mY1;
+      int mX2;
+      int mY2;
+      unsigned int mLabel;
+   };
+
+   struct Corner
+   {
+      Corner(int x, int y) : mX(x), mY(y) {}
+
+      bool operator==(const Corner& rhs) const
+      {
+         return mX == rhs.mX && mY == rhs.mY;
+      }
+
+      int mX;
+      int mY;
+   };
+
+   struct EdgeStartLess
+   {
+      bool operator()(const Edge& lhs, const Edge& rhs) const
+      {
+         return lhs.mY1 < rhs.mY1 || (lhs.mY1 == rhs.mY1 && lhs.mX1 < rhs.mX1);
+      }
+
+      bool operator()(const Edge& lhs, const Corner& rhs) const
+      {
+         return lhs.mY1 < rhs.mY || (lhs.mY1 == rhs.mY && lhs.mX1 < rhs.mX);
+      }
+
+      bool operator()(const Corner& lhs, const Edge& rhs) const
+      {
+         return lhs.mY < rhs.mY1 || (lhs.mY == rhs.mY1 && lhs.mX < rhs.mX1);
+      }
+   };
+
+   int sign(int value)
+   {
+      return (value > 0) - (value < 0);
+   }
+
+   unsigned int findLabel(vector<unsigned int>& parents, unsigned int label)
+   {
+      while (parents[label] != label)
+      {
+         parents[label] = parents[parents[label]];
+         label = parents[label];
+      }
+
+      return label;
+   }
+
+   void mergeLabels(vector<unsigned int>& parents, unsigned int lhs, unsigned int rhs)
+   {
+      lhs = findLabel(parents, lhs);
+      rhs = findLabel(parents, rhs);
+      if (lhs != rhs)
+      {
+         parents[max(lhs, rhs)] = min(lhs, rhs);
+      }
+   }
+
+   // Appends the parts of each run in lhs which are not covered by a run in rhs
+   void subtractRuns(const vector<Run>& lhs, const vector<Run>& rhs, vector<Run>& difference)
+   {
+      difference.clear();
+      vector<Run>::const_iterator first = rhs.begin();
+      for (vector<Run>::const_iterator run = lhs.begin(); run != lhs.end(); ++run)
+      {
+         while (first != rhs.end() && first->mEnd <= run->mStart)
+         {
+            ++first;
+         }
+
+         int start = run->mStart;
+         for (vector<Run>::const_iterator other = first; start < run->mEnd; ++other)
+         {
+            if (other == rhs.end() || other->mStart >= run->mEnd)
+            {
+               difference.push_back(Run(start, run->mEnd, run->mLabel));
+               break;
+            }
+
+            if (other->mStart > start)
+            {
+               difference.push_back(Run(start, other->mStart, run->mLabel));
+            }
+
+            start = max(start, other->mEnd);
+         }
+      }
+   }
+
+   double getArea(const MaskPolygonizer::Ring& ring)
+   {
+      double area = 0.0;
+      for (MaskPolygonizer::Ring::size_type i = 0; i < ring.size(); ++i)
+      {
+         const LocationType& current = ring[i];
+         const LocationType& next = ring[(i + 1) % ring.size()];
+         area += current.mX * next.mY - next.mX * current.mY;
+      }
+
+      return area / 2.0;
+   }
+
+   double getDistance(const LocationType& point, const LocationType& start, const LocationType& end)
+   {
+      LocationType segment = end - start;
+      LocationType offset = point - start;
+      double lengthSquared = segment.mX * segment.mX + segment.mY * segment.mY;
+      if (lengthSquared > 0.0)
+      {
+         double t = max(0.0, min(1.0, (offset.mX * segment.mX + offset.mY * segment.mY) / lengthSquared));
+         offset = point - (start + segment * t);
+      }
+
+      return sqrt(offset.mX * offset.mX + offset.mY * offset.mY);
+   }
+}
+
+MaskPolygonizer::MaskPolygonizer() :
+   mTolerance(0.0)
+{}
+
+void MaskPolygonizer::setTolerance(double tolerance)
+{
+   mTolerance = max(tolerance, 0.0);
+}
+
+double MaskPolygonizer::getTolerance() const
+{
+   return mTolerance;
+}
+
+vector<MaskPolygonizer::Polygon> MaskPolygonizer::polygonize(const BitMask* pMask,
+                                                             const RasterElement* pRaster) const
+{
+   vector<Polygon> polygons;
+   if (pMask == NULL)
+   {
+      return polygons;
+   }
+
+   // The BitMaskIterator does not support negative extents and
+   // the BitMask does not correctly handle the outside flag so
+   // the BitMaskIterator is used for cases when the outside flag is true and
+   // the BitMask is used for cases when the outside flag is false
+   bool outsideSelected = pMask->isOutsideSelected();
+   BitMaskIterator maskIt(pMask, pRaster);
+   int x1 = 0;
+   int y1 = 0;
+   int x2 = 0;
+   int y2 = 0;
+   if (outsideSelected)
+   {
+      if (maskIt.getCount() <= 0)
+      {
+         return polygons;
+      }
+
+      maskIt.getBoundingBox(x1, y1, x2, y2);
+   }
+   else
+   {
+      if (pMask->getCount() <= 0)
+      {
+         return polygons;
+      }
+
+      pMask->getBoundingBox(x1, y1, x2, y2);
+   }
+
+   int startColumn = min(x1, x2);
+   int endColumn = max(x1, x2);
+   int startRow = min(y1, y2);
+   int endRow = max(y1, y2);
+
+   // Collect the boundary edges in a single pass over the rows. The selected pixels of each row are
+   // grouped into runs, and runs which overlap a run in the previous row are given the same label so
+   // the edges of each four-connected group of pixels can be found after the rings are linked.
+   vector<Edge> edges;
+   vector<unsigned int> labels;
+   vector<Run> previousRuns;
+   vector<Run> currentRuns;
+   vector<Run> difference;
+   for (int row = startRow; row <= endRow + 1; ++row)
+   {
+      currentRuns.clear();
+      for (int column = startColumn; row <= endRow && column <= endColumn; ++column)
+      {
+         bool selected = (outsideSelected ? maskIt.getPixel(column, row) : pMask->getPixel(column, row));
+         if (selected == false)
+         {
+            continue;
+         }
+
+         if (currentRuns.empty() == false && currentRuns.back().mEnd == column)
+         {
+            currentRuns.back().mEnd = column + 1;
+         }
+         else
+         {
+            unsigned int label = static_cast<unsigned int>(labels.size());
+            labels.push_back(label);
+            currentRuns.push_back(Run(column, column + 1, label));
+         }
+      }
+
+      vector<Run>::const_iterator previous = previousRuns.begin();
+      for (vector<Run>::const_iterator run = currentRuns.begin(); run != currentRuns.end(); ++run)
+      {
+         while (previous != previousRuns.end() && previous->mEnd <= run->mStart)
+         {
+            ++previous;
+         }
+
+         for (vector<Run>::const_iterator other = previous;
+            other != previousRuns.end() && other->mStart < run->mEnd; ++other)
+         {
+            mergeLabels(labels, run->mLabel, other->mLabel);
+         }
+
+         edges.push_back(Edge(run->mStart, row + 1, run->mStart, row, run->mLabel));
+         edges.push_back(Edge(run->mEnd, row, run->mEnd, row + 1, run->mLabel));
+      }
+
+      // Horizontal edges lie between the rows, so each one spans all of the pixels
+      // which change from unselected to selected or from selected to unselected
+      subtractRuns(currentRuns, previousRuns, difference);
+      for (vector<Run>::const_iterator run = difference.begin(); run != difference.end(); ++run)
+      {
+         edges.push_back(Edge(run->mStart, row, run->mEnd, row, run->mLabel));
+      }
+
+      subtractRuns(previousRuns, currentRuns, difference);
+      for (vector<Run>::const_iterator run = difference.begin(); run != difference.end(); ++run)
+      {
+         edges.push_back(Edge(run->mEnd, row, run->mStart, row, run->mLabel));
+      }
+
+      previousRuns.swap(currentRuns);
+   }
+
+   // Link the edges into rings. Two rings meet at a corner which is shared by two diagonal pixels,
+   // so the edge which turns right is taken there to keep the selected pixel on the right.
+   sort(edges.begin(), edges.end(), EdgeStartLess());
+
+   vector<bool> used(edges.size(), false);
+   vector<Ring> rings;
+   vector<unsigned int> ringLabels;
+   vector<Corner> path;
+   vector<pair<Corner, vector<Corner>::size_type> > sharedCorners;
+   for (vector<Edge>::size_type firstEdge = 0; firstEdge < edges.size(); ++firstEdge)
+   {
+      if (used[firstEdge])
+      {
+         continue;
+      }
+
+      unsigned int label = findLabel(labels, edges[firstEdge].mLabel);
+      Corner start(edges[firstEdge].mX1, edges[firstEdge].mY1);
+      path.clear();
+      sharedCorners.clear();
+      pair<vector<Edge>::iterator, vector<Edge>::iterator> startEdges =
+         equal_range(edges.begin(), edges.end(), start, EdgeStartLess());
+      if (startEdges.second - startEdges.first > 1)
+      {
+         sharedCorners.push_back(make_pair(start, path.size()));
+      }
+
+      path.push_back(start);
+      used[firstEdge] = true;
+
+      vector<Edge>::size_type currentEdge = firstEdge;
+      for (;;)
+      {
+         const Edge& edge = edges[currentEdge];
+         Corner end(edge.mX2, edge.mY2);
+         pair<vector<Edge>::iterator, vector<Edge>::iterator> outgoing =
+            equal_range(edges.begin(), edges.end(), end, EdgeStartLess());
+         if (outgoing.first == outgoing.second)
+         {
+            // The edges always form closed rings, so this only happens if the mask changed while it was read
+            break;
+         }
+
+         vector<Edge>::iterator nextEdge = outgoing.first;
+         if (outgoing.second - outgoing.first > 1)
+         {
+            int rightX = -sign(edge.mY2 - edge.mY1);
+            int rightY = sign(edge.mX2 - edge.mX1);
+            for (vector<Edge>::iterator iter = outgoing.first; iter != outgoing.second; ++iter)
+            {
+               if (sign(iter->mX2 - iter->mX1) == rightX && sign(iter->mY2 - iter->mY1) == rightY)
+               {
+                  nextEdge = iter;
+                  break;
+               }
+            }
+         }
+
+         vector<Edge>::size_type nextIndex = static_cast<vector<Edge>::size_type>(nextEdge - edges.begin());
+         if (nextIndex == firstEdge || used[nextIndex])
+         {
+            break;
+         }
+
+         // When a ring passes through a shared corner a second time, the part of the ring after
+         // the first pass is split into its own ring so that no ring touches itself
+         if (outgoing.second - outgoing.first > 1)
+         {
+            for (vector<pair<Corner, vector<Corner>::size_type> >::iterator iter = sharedCorners.begin();
+               iter != sharedCorners.end(); ++iter)
+            {
+               if (iter->first == end)
+               {
+                  vector<Corner>::size_type position = iter->second;
+                  Ring loop;
+                  for (vector<Corner>::size_type i = position; i < path.size(); ++i)
+                  {
+                     loop.push_back(LocationType(path[i].mX, path[i].mY));
+                  }
+
+                  rings.push_back(loop);
+                  ringLabels.push_back(label);
+                  path.erase(path.begin() + position, path.end());
+                  sharedCorners.erase(iter, sharedCorners.end());
+                  break;
+               }
+            }
+
+            sharedCorners.push_back(make_pair(end, path.size()));
+         }
+
+         path.push_back(end);
+         used[nextIndex] = true;
+         currentEdge = nextIndex;
+      }
+
+      Ring ring;
+      for (vector<Corner>::const_iterator iter = path.begin(); iter != path.end(); ++iter)
+      {
+         ring.push_back(LocationType(iter->mX, iter->mY));
+      }
+
+      rings.push_back(ring);
+      ringLabels.push_back(label);
+   }
+
+   // Remove the corners where the ring continues in the same direction
+   for (vector<Ring>::iterator iter = rings.begin(); iter != rings.end(); ++iter)
+   {
+      Ring& ring = *iter;
+      Ring corners;
+      for (Ring::size_type i = 0; i < ring.size(); ++i)
+      {
+         const LocationType& previous = ring[(i + ring.size() - 1) % ring.size()];
+         const LocationType& current = ring[i];
+         const LocationType& next = ring[(i + 1) % ring.size()];
+         bool horizontal = (previous.mY == current.mY && current.mY == next.mY);
+         bool vertical = (previous.mX == current.mX && current.mX == next.mX);
+         if (horizontal == false && vertical == false)
+         {
+            corners.push_back(current);
+         }
+      }
+
+      ring.swap(corners);
+   }
+
+   // Shells wind in the opposite direction from holes since the selected pixels are always on the right.
+   // Every ring borders a single group of pixels, so each hole belongs to the shell with its label.
+   map<unsigned int, vector<Ring>::size_type> shells;
+   map<vector<Ring>::size_type, vector<Polygon>::size_type> polygonIndices;
+   vector<double> areas(rings.size());
+   for (vector<Ring>::size_type i = 0; i < rings.size(); ++i)
+   {
+      areas[i] = getArea(rings[i]);
+      if (areas[i] <= 0.0 || rings[i].size() < 3)
+      {
+         continue;
+      }
+
+      map<unsigned int, vector<Ring>::size_type>::iterator shell = shells.find(ringLabels[i]);
+      if (shell == shells.end() || areas[i] > areas[shell->second])
+      {
+         shells[ringLabels[i]] = i;
+      }
+
+      // A shell which is smaller than the tolerance is left as it is rather than dropped
+      polygonIndices[i] = polygons.size();
+      polygons.push_back(Polygon());
+      polygons.back().mShell.swap(rings[i]);
+      simplify(polygons.back().mShell);
+   }
+
+   for (vector<Ring>::size_type i = 0; i < rings.size(); ++i)
+   {
+      if (areas[i] >= 0.0 || rings[i].size() < 3)
+      {
+         continue;
+      }
+
+      // A hole which is smaller than the tolerance is dropped
+      map<unsigned int, vector<Ring>::size_type>::const_iterator shell = shells.find(ringLabels[i]);
+      if (shell != shells.end() && simplify(rings[i]))
+      {
+         Polygon& polygon = polygons[polygonIndices[shell->second]];
+         polygon.mHoles.push_back(Ring());
+         polygon.mHoles.back().swap(rings[i]);
+      }
+   }
+
+   return polygons;
+}
+
+bool MaskPolygonizer::simplify(Ring& ring) const
+{
+   if (mTolerance <= 0.0)
+   {
+      return true;
+   }
+
+   if (ring.size() <= 3)
+   {
+      return ring.size() == 3;
+   }
+
+   // A closed ring is split at the first vertex and the vertex farthest from it,
+   // and each half is simplified with the Douglas-Peucker algorithm
+   Ring::size_type farthest = 0;
+   double farthestDistance = -1.0;
+   for (Ring::size_type i = 1; i < ring.size(); ++i)
+   {
+      double distance = getDistance(ring[i], ring[0], ring[0]);
+      if (distance > farthestDistance)
+      {
+         farthest = i;
+         farthestDistance = distance;
+      }
+   }
+
+   vector<bool> keep(ring.size(), false);
+   keep[0] = true;
+   keep[farthest] = true;
+
+   vector<pair<Ring::size_type, Ring::size_type> > sections;
+   sections.push_back(make_pair(static_cast<Ring::size_type>(0), farthest));
+   sections.push_back(make_pair(farthest, ring.size()));
+   while (sections.empty() == false)
+   {
+      Ring::size_type first = sections.back().first;
+      Ring::size_type last = sections.back().second;
+      sections.pop_back();
+
+      const LocationType& start = ring[first];
+      const LocationType& end = ring[last % ring.size()];
+      Ring::size_type worst = first;
+      double worstDistance = mTolerance;
+      for (Ring::size_type i = first + 1; i < last; ++i)
+      {
+         double distance = getDistance(ring[i], start, end);
+         if (distance > worstDistance)
+         {
+            worst = i;
+            worstDistance = distance;
+         }
+      }
+
+      if (worst != first)
+      {
+         keep[worst] = true;
+         sections.push_back(make_pair(first, worst));
+         sections.push_back(make_pair(worst, last));
+      }
+   }
+
+   Ring simplified;
+   for (Ring::size_type i = 0; i < ring.size(); ++i)
+   {
+      if (keep[i])
+      {
+         simplified.push_back(ring[i]);
+      }
+   }
+
+   if (simplified.size() < 3)
+   {
+      return false;
+   }
+
+   ring.swap(simplified);
+   return true;
+}
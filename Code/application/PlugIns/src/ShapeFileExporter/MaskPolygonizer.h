@@ -0,0 +1,70 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef MASKPOLYGONIZER_H
+#define MASKPOLYGONIZER_H
+
+#include "LocationType.h"
+
+#include <vector>
+
+class BitMask;
+class RasterElement;
+
+/**
+ *  Converts the selected pixels of a BitMask into polygons.
+ *
+ *  The mask is read one row at a time and the boundaries between selected and
+ *  unselected pixels are collected as edges along the pixel corners. The edges
+ *  are then linked into rings so each four-connected group of selected pixels
+ *  becomes one polygon with a ring for each of its holes. The vertices are pixel
+ *  corner locations, so a single pixel at (0, 0) is the square from (0, 0) to (1, 1).
+ */
+class MaskPolygonizer
+{
+public:
+   /**
+    *  The vertices of a closed ring. The first vertex is not repeated at the end.
+    */
+   typedef std::vector<LocationType> Ring;
+
+   struct Polygon
+   {
+      Ring mShell;
+      std::vector<Ring> mHoles;
+   };
+
+   MaskPolygonizer();
+
+   /**
+    *  Sets the maximum distance in pixels that a simplified ring may be from the
+    *  pixel boundary. Rings are not simplified if the tolerance is zero.
+    */
+   void setTolerance(double tolerance);
+   double getTolerance() const;
+
+   /**
+    *  Traces the selected pixels of a mask.
+    *
+    *  @param   pMask
+    *           The mask to trace.
+    *  @param   pRaster
+    *           The element which limits the pixels traced when the outside of the mask is selected.
+    *
+    *  @return  The polygons in the order of the first row of each polygon.
+    */
+   std::vector<Polygon> polygonize(const BitMask* pMask, const RasterElement* pRaster) const;
+
+private:
+   bool simplify(Ring& ring) const;
+
+   double mTolerance;
+};
+
+#endif
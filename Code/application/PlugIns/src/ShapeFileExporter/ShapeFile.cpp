@@ -15,6 +15,7 @@
 #include "DesktopServices.h"
 #include "Feature.h"
 #include "GraphicGroup.h"
+#include "MaskPolygonizer.h"
 #include "MessageLogResource.h"
 #include "ModelServices.h"
 #include "PolygonObject.h"
@@ -40,12 +41,62 @@ namespace
    const string prjFileContents = "GEOGCS[\"GCS_WGS_1984\",DATUM["
       "\"D_WGS_1984\",SPHEROID[\"WGS_1984\",6378137.0,298.257223563]],"
       "PRIMEM[\"Greenwich\",0.0],UNIT[\"Degree\",0.0174532925199433]]";
+
+   // The BitMaskIterator does not support negative extents and
+   // the BitMask does not correctly handle the outside flag so
+   // the BitMaskIterator is used for cases when the outside flag is true and
+   // the BitMask is used for cases when the outside flag is false
+   vector<LocationType> getSelectedPixels(const BitMask* pMask, const RasterElement* pGeoref)
+   {
+      vector<LocationType> pixels;
+      if (pMask == NULL)
+      {
+         return pixels;
+      }
+
+      BitMaskIterator maskIt(pMask, pGeoref);
+      bool outsideSelected = pMask->isOutsideSelected();
+      if ((outsideSelected == true && maskIt.getCount() <= 0) ||
+         (outsideSelected == false && pMask->getCount() <= 0))
+      {
+         return pixels;
+      }
+
+      int startColumn = 0;
+      int endColumn = 0;
+      int startRow = 0;
+      int endRow = 0;
+      if (outsideSelected == true)
+      {
+         maskIt.getBoundingBox(startColumn, startRow, endColumn, endRow);
+      }
+      else
+      {
+         pMask->getBoundingBox(startColumn, startRow, endColumn, endRow);
+      }
+
+      // The pixel centers are collected one row at a time so the mask is read in the order it is stored
+      for (int j = startRow; j <= endRow; j++)
+      {
+         for (int i = startColumn; i <= endColumn; i++)
+         {
+            if ((outsideSelected == true && maskIt.getPixel(i, j)) ||
+               (outsideSelected == false && pMask->getPixel(i, j)))
+            {
+               pixels.push_back(LocationType(i + 0.5, j + 0.5));
+            }
+         }
+      }
+
+      return pixels;
+   }
 };
 
 ShapeFile::ShapeFile() :
    mpAttributeFile(NULL),
    mpShapeFile(NULL),
-   mShape(ShapefileTypes::MULTIPOINT_SHAPE)
+   mShape(ShapefileTypes::MULTIPOINT_SHAPE),
+   mSimplifyTolerance(0.0)
 {}
 
 ShapeFile::~ShapeFile()
@@ -118,6 +169,16 @@ ShapefileTypes::ShapeType ShapeFile::getShape() const
    return mShape;
 }
 
+void ShapeFile::setSimplifyTolerance(double tolerance)
+{
+   mSimplifyTolerance = max(tolerance, 0.0);
+}
+
+double ShapeFile::getSimplifyTolerance() const
+{
+   return mSimplifyTolerance;
+}
+
 vector<Feature*> ShapeFile::addFeatures(DataElement* pElement, RasterElement* pGeoref, string& message)
 {
    vector<Feature*> features;
@@ -145,71 +206,43 @@ vector<Feature*> ShapeFile::addFeatures(DataElement* pElement, RasterElement* pG
       {
       case ShapefileTypes::POINT_SHAPE:
          {
-            // The BitMaskIterator does not support negative extents and
-            // the BitMask does not correctly handle the outside flag so
-            // the BitMaskIterator is used for cases when the outside flag is true and
-            // the BitMask is used for cases when the outside flag is false
-            const BitMask* pMask = pAoi->getSelectedPoints();
-            if (pMask != NULL)
+            // Georeference all of the selected pixels at once instead of one at a time
+            vector<LocationType> pixels = getSelectedPixels(pAoi->getSelectedPoints(), pGeoref);
+            vector<LocationType> geocoords = pGeoref->convertPixelsToGeocoords(pixels);
+            if (geocoords.size() != pixels.size())
             {
-               BitMaskIterator maskIt(pMask, pGeoref);
-               if ((maskIt.getCount() > 0 && pMask->isOutsideSelected() == true) ||
-                  (pMask->getCount() > 0 && pMask->isOutsideSelected() == false))
+               message = "The selected pixels could not be georeferenced.";
+               return features;
+            }
+
+            // Add features for each selected pixel
+            for (vector<LocationType>::const_iterator iter = geocoords.begin(); iter != geocoords.end(); ++iter)
+            {
+               // Add the feature
+               Feature* pFeature = new Feature(mShape);
+               if (pFeature != NULL)
                {
-                  // Add features for each selected pixel
-                  int startColumn = 0;
-                  int endColumn = 0;
-                  int startRow = 0;
-                  int endRow = 0;
-                  if (pMask->isOutsideSelected() == true)
-                  {
-                     maskIt.getBoundingBox(startColumn, startRow, endColumn, endRow);
-                  }
-                  else
+                  features.push_back(pFeature);
+                  mFeatures.push_back(pFeature);
+                  pFeature->attach(SIGNAL_NAME(Subject, Modified), Slot(this, &ShapeFile::shapeModified));
+
+                  // Fields
+                  pFeature->addField("Name", string());
+                  pFeature->addField("Pixel", string());
+
+                  if (!elementName.empty())
                   {
-                     pMask->getBoundingBox(startColumn, startRow, endColumn, endRow);
+                     pFeature->setFieldValue("Name", elementName);
                   }
-                  LocationType pixel;
-                  for (int i = startColumn; i <= endColumn; i++)
+
+                  string pixelName = "";
+                  if (!pixelName.empty())
                   {
-                     for (int j = startRow; j <= endRow; j++)
-                     {
-                        if ((maskIt.getPixel(i, j) && pMask->isOutsideSelected() == true) ||
-                              (pMask->getPixel(i, j) && pMask->isOutsideSelected() == false))
-                        {
-                           // Add the feature
-                           Feature* pFeature = new Feature(mShape);
-                           if (pFeature != NULL)
-                           {
-                              features.push_back(pFeature);
-                              mFeatures.push_back(pFeature);
-                              pFeature->attach(SIGNAL_NAME(Subject, Modified), Slot(this, &ShapeFile::shapeModified));
-
-                              pixel.mX = i + 0.5;
-                              pixel.mY = j + 0.5;
-
-                              // Fields
-                              pFeature->addField("Name", string());
-                              pFeature->addField("Pixel", string());
-
-                              if (!elementName.empty())
-                              {
-                                 pFeature->setFieldValue("Name", elementName);
-                              }
-
-                              string pixelName = "";
-                              if (!pixelName.empty())
-                              {
-                                 pFeature->setFieldValue("Pixel", pixelName);
-                              }
-
-                              // Vertex
-                              pixel = pGeoref->convertPixelToGeocoord(pixel);
-                              pFeature->addVertex(pixel.mY, pixel.mX);    // Longitude as x-coord
-                           }
-                        }
-                     }
+                     pFeature->setFieldValue("Pixel", pixelName);
                   }
+
+                  // Vertex
+                  pFeature->addVertex(iter->mY, iter->mX);    // Longitude as x-coord
                }
             }
          }
@@ -261,30 +294,39 @@ vector<Feature*> ShapeFile::addFeatures(DataElement* pElement, RasterElement* pG
       case ShapefileTypes::POLYGON_SHAPE:
          {
             GraphicGroup* pGroup = pAoi->getGroup();
-            if (pGroup != NULL)
+            const BitMask* pMask = pAoi->getSelectedPoints();
+            if (pGroup == NULL || pMask == NULL)
             {
-               const list<GraphicObject*>& objects = pGroup->getObjects();
-               if (objects.empty())
+               break;
+            }
+
+            const list<GraphicObject*>& objects = pGroup->getObjects();
+            if (objects.empty() && pMask->isOutsideSelected() == false)
+            {
+               message = "Error Shape File 101: Cannot create a shape file from an empty AOI.";
+               return features;
+            }
+
+            // Polygon objects which only add pixels are exported with their own vertices, but any
+            // other object or draw mode is exported by tracing the boundaries of the selected pixels
+            bool traceMask = objects.empty();
+            for (list<GraphicObject*>::const_iterator it = objects.begin(); it != objects.end(); ++it)
+            {
+               const PolygonObject* pObj = dynamic_cast<const PolygonObject*>(*it);
+               if (pObj == NULL || pObj->getDrawMode() != DRAW)
                {
-                  message = "Error Shape File 101: Cannot create a shape file from an empty AOI.";
-                  return features;
+                  traceMask = true;
+                  break;
                }
+            }
 
-               for (std::list<GraphicObject*>::const_iterator it = objects.begin(); it != objects.end(); ++it)
+            if (traceMask == false)
+            {
+               for (list<GraphicObject*>::const_iterator it = objects.begin(); it != objects.end(); ++it)
                {
-                  const PolygonObject* pObj = dynamic_cast<const PolygonObject*>(*it);
-                  if (pObj == NULL)
-                  {
-                     continue;
-                  }
-                  if (pObj->getDrawMode() == ERASE)
-                  {
-                     // currently the exporter can't handle holes, so skip.
-                     message = elementName + " contains polygons with holes. Currently this exporter only "
-                        "exports the outer polygons.";
-                     continue;
-                  }
-                  const std::vector<LocationType>& vertices = pObj->getVertices();
+                  const PolygonObject* pObj = static_cast<const PolygonObject*>(*it);
+                  vector<LocationType> geocoords = pGeoref->convertPixelsToGeocoords(pObj->getVertices());
+
                   Feature* pFeature = new Feature(mShape);
                   if (pFeature != NULL)
                   {
@@ -298,75 +340,112 @@ vector<Feature*> ShapeFile::addFeatures(DataElement* pElement, RasterElement* pG
                         pFeature->setFieldValue("Name", elementName + ": " + pObj->getName());
                      }
 
-                     for (vector<LocationType>::const_iterator iter = vertices.begin(); iter != vertices.end(); ++iter)
+                     for (vector<LocationType>::const_iterator iter = geocoords.begin();
+                        iter != geocoords.end(); ++iter)
                      {
-                        LocationType geo = pGeoref->convertPixelToGeocoord(*iter);
-                        pFeature->addVertex(geo.mY, geo.mX);
+                        pFeature->addVertex(iter->mY, iter->mX);
                      }
                   }
                }
+
+               break;
             }
-         }
 
+            MaskPolygonizer polygonizer;
+            polygonizer.setTolerance(mSimplifyTolerance);
+            vector<MaskPolygonizer::Polygon> polygons = polygonizer.polygonize(pMask, pGeoref);
+
+            // Georeference the vertices of every ring at once instead of one at a time
+            vector<LocationType> pixels;
+            for (vector<MaskPolygonizer::Polygon>::const_iterator polygon = polygons.begin();
+               polygon != polygons.end(); ++polygon)
+            {
+               pixels.insert(pixels.end(), polygon->mShell.begin(), polygon->mShell.end());
+               for (vector<MaskPolygonizer::Ring>::const_iterator hole = polygon->mHoles.begin();
+                  hole != polygon->mHoles.end(); ++hole)
+               {
+                  pixels.insert(pixels.end(), hole->begin(), hole->end());
+               }
+            }
+
+            vector<LocationType> geocoords = pGeoref->convertPixelsToGeocoords(pixels);
+            if (geocoords.size() != pixels.size())
+            {
+               message = "The polygon vertices could not be georeferenced.";
+               return features;
+            }
+
+            vector<LocationType>::const_iterator geocoord = geocoords.begin();
+            for (vector<MaskPolygonizer::Polygon>::const_iterator polygon = polygons.begin();
+               polygon != polygons.end(); ++polygon)
+            {
+               Feature* pFeature = new Feature(mShape);
+               if (pFeature == NULL)
+               {
+                  break;
+               }
+
+               features.push_back(pFeature);
+               mFeatures.push_back(pFeature);
+               pFeature->attach(SIGNAL_NAME(Subject, Modified), Slot(this, &ShapeFile::shapeModified));
+
+               pFeature->addField("Name", string());
+               if (!elementName.empty())
+               {
+                  pFeature->setFieldValue("Name", elementName);
+               }
+
+               // The outer ring is the first part and each hole is another part
+               for (MaskPolygonizer::Ring::size_type i = 0; i < polygon->mShell.size(); ++i, ++geocoord)
+               {
+                  pFeature->addVertex(geocoord->mY, geocoord->mX);    // Longitude as x-coord
+               }
+
+               for (vector<MaskPolygonizer::Ring>::const_iterator hole = polygon->mHoles.begin();
+                  hole != polygon->mHoles.end(); ++hole)
+               {
+                  pFeature->addPart();
+                  for (MaskPolygonizer::Ring::size_type i = 0; i < hole->size(); ++i, ++geocoord)
+                  {
+                     pFeature->addVertex(geocoord->mY, geocoord->mX);
+                  }
+               }
+            }
+         }
          break;
 
       case ShapefileTypes::MULTIPOINT_SHAPE:
          {
-            // The BitMaskIterator does not support negative extents and
-            // the BitMask does not correctly handle the outside flag so
-            // the BitMaskIterator is used for cases when the outside flag is true and
-            // the BitMask is used for cases when the outside flag is false
-            const BitMask* pMask = pAoi->getSelectedPoints();
-            if (pMask != NULL)
+            // Georeference all of the selected pixels at once instead of one at a time
+            vector<LocationType> pixels = getSelectedPixels(pAoi->getSelectedPoints(), pGeoref);
+            vector<LocationType> geocoords = pGeoref->convertPixelsToGeocoords(pixels);
+            if (geocoords.size() != pixels.size())
             {
-               BitMaskIterator maskIt(pMask, pGeoref);
-               if ((maskIt.getCount() > 0 && pMask->isOutsideSelected() == true) ||
-                  (pMask->getCount() > 0 && pMask->isOutsideSelected() == false))
+               message = "The selected pixels could not be georeferenced.";
+               return features;
+            }
+
+            if (geocoords.empty() == false)
+            {
+               // Add the feature
+               Feature* pFeature = new Feature(mShape);
+               if (pFeature != NULL)
                {
-                  // Add the feature
-                  Feature* pFeature = new Feature(mShape);
-                  if (pFeature != NULL)
-                  {
-                     features.push_back(pFeature);
-                     mFeatures.push_back(pFeature);
-                     pFeature->attach(SIGNAL_NAME(Subject, Modified), Slot(this, &ShapeFile::shapeModified));
+                  features.push_back(pFeature);
+                  mFeatures.push_back(pFeature);
+                  pFeature->attach(SIGNAL_NAME(Subject, Modified), Slot(this, &ShapeFile::shapeModified));
 
-                     // Fields
-                     pFeature->addField("Name", string());
-                     if (!elementName.empty())
-                     {
-                        pFeature->setFieldValue("Name", elementName);
-                     }
+                  // Fields
+                  pFeature->addField("Name", string());
+                  if (!elementName.empty())
+                  {
+                     pFeature->setFieldValue("Name", elementName);
+                  }
 
-                     // Vertices
-                     int startColumn = 0;
-                     int endColumn = 0;
-                     int startRow = 0;
-                     int endRow = 0;
-                     if (pMask->isOutsideSelected() == true)
-                     {
-                        maskIt.getBoundingBox(startColumn, startRow, endColumn, endRow);
-                     }
-                     else
-                     {
-                        pMask->getBoundingBox(startColumn, startRow, endColumn, endRow);
-                     }
-                     LocationType pixel;
-                     for (int i = startColumn; i <= endColumn; i++)
-                     {
-                        for (int j = startRow; j <= endRow; j++)
-                        {
-                           if ((maskIt.getPixel(i, j) && pMask->isOutsideSelected() == true) ||
-                              (pMask->getPixel(i, j) && pMask->isOutsideSelected() == false))
-                           {
-                              pixel.mX = i + 0.5;
-                              pixel.mY = j + 0.5;
-                              pixel = pGeoref->convertPixelToGeocoord(pixel);
-
-                              pFeature->addVertex(pixel.mY, pixel.mX);    // Longitude as x-coord
-                           }
-                        }
-                     }
+                  // Vertices
+                  for (vector<LocationType>::const_iterator iter = geocoords.begin(); iter != geocoords.end(); ++iter)
+                  {
+                     pFeature->addVertex(iter->mY, iter->mX);    // Longitude as x-coord
                   }
                }
             }
@@ -668,44 +747,64 @@ bool ShapeFile::save(Progress* pProgress, string& errorMessage)
       {
          // Features
          const vector<Feature::FeatureVertex>& vertices = pFeature->getVertices();
-         int iVertices = vertices.size();
+         int iParts = static_cast<int>(pFeature->getNumParts());
 
-         vector<double> dX(iVertices);
-         vector<double> dY(iVertices);
-         vector<double> dZ(iVertices);
+         vector<double> dX;
+         vector<double> dY;
+         vector<double> dZ;
+         vector<int> partStarts;
+         dX.reserve(vertices.size() + iParts);
+         dY.reserve(vertices.size() + iParts);
+         dZ.reserve(vertices.size() + iParts);
 
-         for (int j = 0; j < iVertices; j++)
+         for (int part = 0; part < iParts; part++)
          {
-            Feature::FeatureVertex vertex = vertices[j];
-            dX[j] = vertex.mX;
-            dY[j] = vertex.mY;
-            dZ[j] = vertex.mZ;
-         }
+            int iFirst = static_cast<int>(dX.size());
+            int iStart = pFeature->getPart(part);
+            int iEnd = (part + 1 < iParts ? pFeature->getPart(part + 1) : static_cast<int>(vertices.size()));
+            partStarts.push_back(iFirst);
 
-         if (mShape == ShapefileTypes::POLYGON_SHAPE)
-         {
-            // make sure there are no collinear segments by calculating
-            // the area of the triangle defined by each point triplet
-            // if the area is 0, the points are collinear so we remove the
-            // middle point and continue
-            for (int a = 0; a < (iVertices - 2); a++)
+            for (int j = iStart; j < iEnd; j++)
             {
-               int b = a + 1;
-               int c = a + 2;
-               double area = dX[a] * (dY[b] - dY[c]) + dX[b] * (dY[c] - dY[a]) + dX[c] * (dY[a] - dY[b]);
-               if (fabs(area) < 1e-15) // equals zero
+               const Feature::FeatureVertex& vertex = vertices[j];
+               dX.push_back(vertex.mX);
+               dY.push_back(vertex.mY);
+               dZ.push_back(vertex.mZ);
+            }
+
+            if (mShape == ShapefileTypes::POLYGON_SHAPE)
+            {
+               // make sure there are no collinear segments by calculating
+               // the area of the triangle defined by each point triplet
+               // if the area is 0, the points are collinear so we remove the
+               // middle point and continue
+               for (int a = iFirst; a < (static_cast<int>(dX.size()) - 2); a++)
+               {
+                  int b = a + 1;
+                  int c = a + 2;
+                  double area = dX[a] * (dY[b] - dY[c]) + dX[b] * (dY[c] - dY[a]) + dX[c] * (dY[a] - dY[b]);
+                  if (fabs(area) < 1e-15) // equals zero
+                  {
+                     dX.erase(dX.begin() + b);
+                     dY.erase(dY.begin() + b);
+                     dZ.erase(dZ.begin() + b);
+                     a--;
+                  }
+               }
+
+               // Each ring of a polygon must end with its first vertex
+               if (static_cast<int>(dX.size()) > iFirst && (dX[iFirst] != dX.back() || dY[iFirst] != dY.back()))
                {
-                  dX.erase(dX.begin() + b);
-                  dY.erase(dY.begin() + b);
-                  dZ.erase(dZ.begin() + b);
-                  a--;
-                  iVertices--;
+                  dX.push_back(dX[iFirst]);
+                  dY.push_back(dY[iFirst]);
+                  dZ.push_back(dZ[iFirst]);
                }
             }
          }
 
-         SHPObject* pObject = SHPCreateObject(iType, i, 0, NULL, NULL, iVertices, &dX.front(), &dY.front(),
-            &dZ.front(), NULL);
+         int iVertices = static_cast<int>(dX.size());
+         SHPObject* pObject = SHPCreateObject(iType, i, iParts, &partStarts.front(), NULL, iVertices, &dX.front(),
+            &dY.front(), &dZ.front(), NULL);
          if (pObject != NULL)
          {
             SHPRewindObject(pShapeFile, pObject);
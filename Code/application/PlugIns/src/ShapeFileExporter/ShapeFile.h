@@ -41,6 +41,14 @@ public:
    void setShape(ShapefileTypes::ShapeType eShape);
    ShapefileTypes::ShapeType getShape() const;
 
+   /**
+    *  Sets the maximum distance in pixels that an exported polygon may be from
+    *  the boundary of the selected pixels. Polygons are not simplified if the
+    *  tolerance is zero.
+    */
+   void setSimplifyTolerance(double tolerance);
+   double getSimplifyTolerance() const;
+
    std::vector<Feature*> addFeatures(DataElement* pElement, RasterElement* pGeoref, std::string& message);
    bool removeFeature(Feature* pFeature);
    const std::vector<Feature*>& getFeatures() const;
@@ -63,6 +71,7 @@ private:
    SHPHandle mpShapeFile;
    std::string mFilename;
    ShapefileTypes::ShapeType mShape;
+   double mSimplifyTolerance;
    std::vector<Feature*> mFeatures;
    std::map<std::string, std::string> mFields;
 };
@@ -27,6 +27,7 @@
 #include "ShapeFileExporter.h"
 #include "ShapeFileOptionsWidget.h"
 #include "SpatialDataView.h"
+#include "StringUtilities.h"
 #include "UtilityServices.h"
 
 #include <QtCore/QString>
@@ -66,6 +67,13 @@ bool ShapeFileExporter::getInputSpecification(PlugInArgList*& pArgList)
       VERIFY(pArgList->addArg<AoiElement>("AoiElement", NULL, "The AOI to be exported"));
       VERIFY(pArgList->addArg<RasterElement>("RasterElement", NULL, 
          "Source of georeference for the AOI being exported"));
+      VERIFY(pArgList->addArg<string>("Shape", StringUtilities::toDisplayString(
+         ShapefileTypes::ShapeType(ShapefileTypes::MULTIPOINT_SHAPE)), "The shape of the exported features: "
+         "\"Point\", \"Polyline\", \"Polygon\" or \"Multi-Point\". Polygons are traced around the selected "
+         "pixels unless the AOI only contains polygon objects."));
+      VERIFY(pArgList->addArg<double>("Simplification Tolerance", 0.0, "The maximum distance in pixels that a "
+         "traced polygon may be from the boundary of the selected pixels. Polygons are not simplified if this "
+         "is zero."));
    }
    else
    {
@@ -234,8 +242,28 @@ bool ShapeFileExporter::extractInputs(const PlugInArgList* pInArgList, string& m
       return false;
    }
 
+   ShapefileTypes::ShapeType eShape = ShapefileTypes::MULTIPOINT_SHAPE;
+   double tolerance = 0.0;
+   if (isBatch())
+   {
+      string shapeText;
+      if (pInArgList->getPlugInArgValue("Shape", shapeText) && shapeText.empty() == false)
+      {
+         bool error = false;
+         eShape = StringUtilities::fromDisplayString<ShapefileTypes::ShapeType>(shapeText, &error);
+         if (error || eShape.isValid() == false)
+         {
+            message = "The shape \"" + shapeText + "\" is not a valid shape file shape.";
+            return false;
+         }
+      }
+
+      pInArgList->getPlugInArgValue("Simplification Tolerance", tolerance);
+   }
+
    //add aoi to shape file
-   mShapefile.setShape(ShapefileTypes::MULTIPOINT_SHAPE);
+   mShapefile.setShape(eShape);
+   mShapefile.setSimplifyTolerance(tolerance);
    string err;
    mShapefile.addFeatures(mpAoi, mpGeoref, err);
 
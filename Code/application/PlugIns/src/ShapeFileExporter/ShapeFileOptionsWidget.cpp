@@ -80,6 +80,18 @@ ShapeFileOptionsWidget::ShapeFileOptionsWidget(ShapeFile* pShapefile, const vect
       mpShapeCombo->addItem(QString::fromStdString(*it));
    }
 
+   // Polygon simplification
+   QLabel* pToleranceLabel = new QLabel("Simplify:", this);
+   pToleranceLabel->setFont(ftBold);
+
+   mpToleranceSpin = new QDoubleSpinBox(this);
+   mpToleranceSpin->setRange(0.0, 100.0);
+   mpToleranceSpin->setSingleStep(0.25);
+   mpToleranceSpin->setDecimals(2);
+   mpToleranceSpin->setSuffix(" pixels");
+   mpToleranceSpin->setToolTip("The maximum distance that a polygon traced around the selected pixels "
+      "may be from the pixel boundaries");
+
    // Feature list
    QLabel* pFeatureLabel = new QLabel("Features:", this);
 
@@ -124,6 +136,9 @@ ShapeFileOptionsWidget::ShapeFileOptionsWidget(ShapeFile* pShapefile, const vect
    pNameShapeLayout->addSpacing(20);
    pNameShapeLayout->addWidget(pShapeLabel);
    pNameShapeLayout->addWidget(mpShapeCombo);
+   pNameShapeLayout->addSpacing(20);
+   pNameShapeLayout->addWidget(pToleranceLabel);
+   pNameShapeLayout->addWidget(mpToleranceSpin);
    pNameShapeLayout->addStretch();
 
    QVBoxLayout* pButtonLayout = new QVBoxLayout();
@@ -180,6 +195,8 @@ ShapeFileOptionsWidget::ShapeFileOptionsWidget(ShapeFile* pShapefile, const vect
          index = 0;
       }
       mpShapeCombo->setCurrentIndex(index);
+      mpToleranceSpin->setValue(mpShapeFile->getSimplifyTolerance());
+      mpToleranceSpin->setEnabled(mpShapeFile->getShape() == ShapefileTypes::POLYGON_SHAPE);
 
       // Features
       const vector<Feature*>& features = mpShapeFile->getFeatures();
@@ -206,6 +223,7 @@ ShapeFileOptionsWidget::ShapeFileOptionsWidget(ShapeFile* pShapefile, const vect
    connect(pBrowseButton, SIGNAL(clicked()), this, SLOT(browse()));
    connect(mpBaseNameEdit, SIGNAL(textChanged(const QString&)), this, SLOT(updateFilenames()));
    connect(mpShapeCombo, SIGNAL(activated(const QString&)), this, SLOT(setShape(const QString&)));
+   connect(mpToleranceSpin, SIGNAL(valueChanged(double)), this, SLOT(setTolerance(double)));
    connect(pAddFeatureButton, SIGNAL(clicked()), this, SLOT(addFeature()));
    connect(pRemoveFeatureButton, SIGNAL(clicked()), this, SLOT(removeFeature()));
    connect(pClearFeatureButton, SIGNAL(clicked()), this, SLOT(clearFeatures()));
@@ -313,6 +331,15 @@ void ShapeFileOptionsWidget::setShape(const QString& strShape)
    }
 
    mpShapeFile->setShape(eShape);
+   mpToleranceSpin->setEnabled(eShape == ShapefileTypes::POLYGON_SHAPE);
+}
+
+void ShapeFileOptionsWidget::setTolerance(double tolerance)
+{
+   if (mpShapeFile != NULL)
+   {
+      mpShapeFile->setSimplifyTolerance(tolerance);
+   }
 }
 
 void ShapeFileOptionsWidget::addFeature()
@@ -13,6 +13,7 @@
 #include <QtCore/QMap>
 #include <QtGui/QDialog>
 #include <QtGui/QComboBox>
+#include <QtGui/QDoubleSpinBox>
 #include <QtGui/QLabel>
 #include <QtGui/QLineEdit>
 #include <QtGui/QTreeWidgetItem>
@@ -41,6 +42,7 @@ protected slots:
    void updateFilenames();
    void browse();
    void setShape(const QString& strShape);
+   void setTolerance(double tolerance);
    void addFeature();
    void removeFeature();
    void clearFeatures();
@@ -63,6 +65,7 @@ private:
    QLabel* mpShxFileLabel;
    QLabel* mpDbfFileLabel;
    QComboBox* mpShapeCombo;
+   QDoubleSpinBox* mpToleranceSpin;
    CustomTreeWidget* mpFeatureTree;
    QMap<QTreeWidgetItem*, Feature*> mFeatures;
 };
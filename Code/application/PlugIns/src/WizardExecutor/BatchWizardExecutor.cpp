@@ -14,6 +14,7 @@
 #include "AppAssert.h"
 #include "AppVerify.h"
 #include "DateTime.h"
+#include "FilePrefetcher.h"
 #include "Filename.h"
 #include "MessageLogResource.h"
 #include "ModelServices.h"
@@ -30,6 +31,8 @@
 #include "WizardObject.h"
 #include "xmlreader.h"
 
+#include <memory>
+
 using namespace std;
 
 REGISTER_PLUGIN_BASIC(OpticksWizardExecutor, BatchWizardExecutor);
@@ -118,12 +121,37 @@ bool BatchWizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOut
       return false;
    }
 
+   // Read the files for the next iterations in the background so their I/O overlaps the processing.
+   // Only the reads are overlapped. The iterations and their wizard items still run one at a time on
+   // this thread, since the importers, the model and the session items they create are not thread-safe.
+   unsigned int prefetchCount = getSettingPrefetchFileCount();
+   unsigned int prefetchSize = getSettingPrefetchSize();
+   auto_ptr<FilePrefetcher> pPrefetcher;
+   if (prefetchCount > 0 && prefetchSize > 0)
+   {
+      pPrefetcher.reset(new FilePrefetcher(static_cast<uint64_t>(prefetchSize) * 1024 * 1024));
+   }
+
    BatchWizard* pBatchWizard = fileParser.read();
    while (pBatchWizard != NULL)
    {
       // Initialize the filesets
       pBatchWizard->initializeFilesets(mpObjFact.get());
 
+      // Parse the wizard file once and create a new wizard from the document for each iteration
+      string wizardFilename = pBatchWizard->getWizardFilename();
+
+      FactoryResource<Filename> pWizardFilename;
+      pWizardFilename->setFullPathAndName(wizardFilename);
+
+      XmlReader xml;
+      XERCES_CPP_NAMESPACE_QUALIFIER DOMElement* pRootElement = NULL;
+      XERCES_CPP_NAMESPACE_QUALIFIER DOMDocument* pDocument = xml.parse(pWizardFilename.get());
+      if (pDocument != NULL)
+      {
+         pRootElement = pDocument->getDocumentElement();
+      }
+
       // Repeat until done
       string tmp;
       bool bRepeatWizard = pBatchWizard->isRepeating(tmp);
@@ -131,25 +159,20 @@ bool BatchWizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOut
       bool bExecutedOnce = false;
       while ((!bRepeatWizard && !bExecutedOnce) || !pBatchWizard->isComplete())
       {
-         // Load the wizard
-         string wizardFilename = pBatchWizard->getWizardFilename();
+         if (pPrefetcher.get() != NULL)
+         {
+            vector<string> upcomingFiles;
+            pBatchWizard->getUpcomingFiles(prefetchCount, upcomingFiles);
+            pPrefetcher->prefetch(upcomingFiles);
+         }
 
+         // Load the wizard
          bool bSuccess = false;
          FactoryResource<WizardObject> pWizard;
-
-         FactoryResource<Filename> pWizardFilename;
-         pWizardFilename->setFullPathAndName(wizardFilename);
-
-         XmlReader xml;
-         XERCES_CPP_NAMESPACE_QUALIFIER DOMDocument* pDocument = xml.parse(pWizardFilename.get());
-         if (pDocument != NULL)
+         if (pRootElement != NULL)
          {
-            XERCES_CPP_NAMESPACE_QUALIFIER DOMElement* pRootElement = pDocument->getDocumentElement();
-            if (pRootElement != NULL)
-            {
-               unsigned int version = atoi(A(pRootElement->getAttribute(X("version"))));
-               bSuccess = pWizard->fromXml(pRootElement, version);
-            }
+            unsigned int version = atoi(A(pRootElement->getAttribute(X("version"))));
+            bSuccess = pWizard->fromXml(pRootElement, version);
          }
 
          if (bSuccess == false)
@@ -246,6 +269,7 @@ bool BatchWizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOut
             return false;
          }
 
+         // Advancing the file sets resumes from their current file, so this does not rescan them
          bExecutedOnce = true;
          pBatchWizard->updateFilesets();
       }
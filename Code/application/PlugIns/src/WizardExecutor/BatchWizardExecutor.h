@@ -10,6 +10,7 @@
 #ifndef BATCHWIZARDEXECUTOR_H
 #define BATCHWIZARDEXECUTOR_H
 
+#include "ConfigurationSettings.h"
 #include "ObjectFactory.h"
 #include "PlugInManagerServices.h"
 #include "WizardShell.h"
@@ -27,6 +28,9 @@ class WizardObject;
 class BatchWizardExecutor : public WizardShell
 {
 public:
+   SETTING(PrefetchFileCount, BatchWizardExecutor, unsigned int, 0)
+   SETTING(PrefetchSize, BatchWizardExecutor, unsigned int, 0)
+
    BatchWizardExecutor();
    ~BatchWizardExecutor();
 
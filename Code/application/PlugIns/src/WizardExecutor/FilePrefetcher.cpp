@@ -0,0 +1,104 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "FilePrefetcher.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMutexLocker>
+
+using namespace std;
+
+namespace
+{
+   const qint64 sReadSize = 1024 * 1024;
+}
+
+FilePrefetcher::FilePrefetcher(uint64_t maxBytes) :
+   mMaxBytes(maxBytes),
+   mStop(0)
+{
+   start(QThread::LowPriority);
+}
+
+FilePrefetcher::~FilePrefetcher()
+{
+   {
+      QMutexLocker lock(&mMutex);
+      mStop.fetchAndStoreOrdered(1);
+      mPending.clear();
+      mFilesAvailable.wakeAll();
+   }
+
+   wait();
+}
+
+void FilePrefetcher::prefetch(const vector<string>& filenames)
+{
+   QMutexLocker lock(&mMutex);
+   mPending.clear();
+   for (vector<string>::const_iterator iter = filenames.begin(); iter != filenames.end(); ++iter)
+   {
+      if (iter->empty() == false && mQueued.insert(*iter).second)
+      {
+         mPending.push_back(*iter);
+      }
+   }
+
+   if (mPending.empty() == false)
+   {
+      mFilesAvailable.wakeOne();
+   }
+}
+
+void FilePrefetcher::run()
+{
+   while (mStop == 0)
+   {
+      string filename;
+      {
+         QMutexLocker lock(&mMutex);
+         while (mPending.empty() && mStop == 0)
+         {
+            mFilesAvailable.wait(&mMutex);
+         }
+
+         if (mStop != 0)
+         {
+            return;
+         }
+
+         filename = mPending.front();
+         mPending.pop_front();
+      }
+
+      readFile(filename);
+   }
+}
+
+void FilePrefetcher::readFile(const string& filename)
+{
+   QFile file(QString::fromStdString(filename));
+   if (file.open(QIODevice::ReadOnly) == false)
+   {
+      return;
+   }
+
+   vector<char> buffer(static_cast<vector<char>::size_type>(sReadSize));
+   uint64_t bytesRead = 0;
+   while (bytesRead < mMaxBytes && mStop == 0)
+   {
+      qint64 readSize = file.read(&buffer.front(), sReadSize);
+      if (readSize <= 0)
+      {
+         break;
+      }
+
+      bytesRead += static_cast<uint64_t>(readSize);
+   }
+}
@@ -0,0 +1,77 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef FILEPREFETCHER_H
+#define FILEPREFETCHER_H
+
+#include "AppConfig.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * Reads files on a background thread so they are in the operating system's file
+ * cache before they are imported.
+ *
+ * The data is read through a single fixed size buffer and discarded, so the
+ * memory used does not depend on the size of the files. Only the beginning of
+ * each file up to the maximum size is read so a large file does not evict the
+ * file which is currently being processed from the cache.
+ */
+class FilePrefetcher : public QThread
+{
+public:
+   /**
+    * Creates and starts a prefetcher.
+    *
+    * @param maxBytes
+    *        The maximum number of bytes to read from each file.
+    */
+   FilePrefetcher(uint64_t maxBytes);
+
+   /**
+    * Stops reading and waits for the thread to finish.
+    */
+   ~FilePrefetcher();
+
+   /**
+    * Replaces the files waiting to be read.
+    *
+    * Files which have already been read or queued are not read again.
+    *
+    * @param filenames
+    *        The full paths of the files, in the order in which they will be used.
+    */
+   void prefetch(const std::vector<std::string>& filenames);
+
+protected:
+   void run();
+
+private:
+   FilePrefetcher(const FilePrefetcher& rhs);
+   FilePrefetcher& operator=(const FilePrefetcher& rhs);
+
+   void readFile(const std::string& filename);
+
+   uint64_t mMaxBytes;
+   QAtomicInt mStop;
+   QMutex mMutex;
+   QWaitCondition mFilesAvailable;
+   std::deque<std::string> mPending;
+   std::set<std::string> mQueued;
+};
+
+#endif
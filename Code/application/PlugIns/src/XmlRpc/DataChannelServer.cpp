@@ -0,0 +1,569 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVersion.h"
+#include "AppVerify.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataChannelServer.h"
+#include "DataRequest.h"
+#include "MessageLogResource.h"
+#include "ModelServices.h"
+#include "ObjectResource.h"
+#include "PlugInRegistration.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "TypeConverter.h"
+
+#include <QtNetwork/QHostAddress>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+#include <string.h>
+#include <vector>
+
+#if !defined(WIN_API)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+REGISTER_PLUGIN_BASIC(OpticksXmlRpc, DataChannelServer);
+
+namespace
+{
+   const unsigned int sMagic = 0x4344504F;
+   const unsigned short sProtocolVersion = 1;
+   const int sHeaderSize = 48;
+
+   // Payloads larger than this must use the shared memory transport
+   const uint64_t sMaxSocketPayload = 0x40000000;
+
+   // Element names are usually the full path of the imported file, so allow the longest path
+   const unsigned int sMaxNameLength = 4096;
+
+   void putBytes(uint64_t value, int count, char*& pData)
+   {
+      for (int i = 0; i < count; ++i)
+      {
+         *pData++ = static_cast<char>((value >> (8 * i)) & 0xFF);
+      }
+   }
+
+   uint64_t getBytes(int count, const char*& pData)
+   {
+      uint64_t value = 0;
+      for (int i = 0; i < count; ++i)
+      {
+         value |= static_cast<uint64_t>(static_cast<unsigned char>(*pData++)) << (8 * i);
+      }
+      return value;
+   }
+}
+
+DataChannelServer::DataChannelServer() :
+   mpServer(NULL)
+{
+   PlugInShell::setName("XML-RPC Data Channel");
+   setDescriptorId("{6C1D2A4E-53B7-4F0A-9E8C-2B7D41F6A935}");
+   setVersion(APP_VERSION_NUMBER);
+   setProductionStatus(APP_IS_PRODUCTION_RELEASE);
+   setDescription("This is a binary companion to the XML-RPC server which reads and writes raster data.");
+   setCreator("Ball Aerospace & Technologies Corp.");
+   setCopyright(APP_COPYRIGHT_MSG);
+   destroyAfterExecute(false);
+   executeOnStartup(true);
+   setWizardSupported(false);
+}
+
+DataChannelServer::~DataChannelServer()
+{
+   for (QMap<QTcpSocket*, QByteArray>::iterator iter = mPendingData.begin(); iter != mPendingData.end(); ++iter)
+   {
+      iter.key()->disconnect(this);
+      iter.key()->abort();
+   }
+}
+
+bool DataChannelServer::getInputSpecification(PlugInArgList*& pInArgList)
+{
+   pInArgList = NULL;
+   return true;
+}
+
+bool DataChannelServer::getOutputSpecification(PlugInArgList*& pOutArgList)
+{
+   pOutArgList = NULL;
+   return true;
+}
+
+bool DataChannelServer::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
+{
+   int port = getSettingXmlRpcDataChannelPort();
+   if (port <= 0)
+   {
+      // The data channel is disabled
+      return true;
+   }
+
+   mpServer = new QTcpServer(this);
+   if (!mpServer->listen(QHostAddress::LocalHost, static_cast<quint16>(port)))
+   {
+      MessageResource msg("XML-RPC Warning", "app", "4B0E7C53-2D6A-4F39-A1C8-9E5B3D72F014");
+      msg->addProperty("message", "Unable to start the data channel: " + mpServer->errorString().toStdString());
+      return false;
+   }
+
+   VERIFY(connect(mpServer, SIGNAL(newConnection()), this, SLOT(acceptConnection())));
+   return true;
+}
+
+void DataChannelServer::acceptConnection()
+{
+   QTcpSocket* pSocket = mpServer->nextPendingConnection();
+   while (pSocket != NULL)
+   {
+      mPendingData[pSocket] = QByteArray();
+      VERIFYNR(connect(pSocket, SIGNAL(readyRead()), this, SLOT(readMessages())));
+      VERIFYNR(connect(pSocket, SIGNAL(disconnected()), this, SLOT(closeConnection())));
+      pSocket = mpServer->nextPendingConnection();
+   }
+}
+
+void DataChannelServer::closeConnection()
+{
+   QTcpSocket* pSocket = dynamic_cast<QTcpSocket*>(sender());
+   if (pSocket != NULL)
+   {
+      mPendingData.remove(pSocket);
+      pSocket->deleteLater();
+   }
+}
+
+void DataChannelServer::readMessages()
+{
+   QTcpSocket* pSocket = dynamic_cast<QTcpSocket*>(sender());
+   if (pSocket == NULL || !mPendingData.contains(pSocket))
+   {
+      return;
+   }
+
+   QByteArray& data = mPendingData[pSocket];
+   data.append(pSocket->readAll());
+   while (data.size() >= sHeaderSize)
+   {
+      Header header = readHeader(data.constData());
+      if (header.mMagic != sMagic || header.mVersion != sProtocolVersion ||
+         header.mNameLength > sMaxNameLength || header.mPayloadLength > sMaxSocketPayload)
+      {
+         // The stream can not be resynchronized so drop the client
+         sendError(pSocket, header, INVALID_REQUEST, "Invalid message header.");
+         pSocket->disconnectFromHost();
+         data.clear();
+         return;
+      }
+
+      // The limits above keep the whole message within the size of a QByteArray
+      int nameLength = static_cast<int>(header.mNameLength);
+      int payloadLength = static_cast<int>(header.mPayloadLength);
+      int payloadOffset = sHeaderSize + nameLength;
+      int messageSize = payloadOffset + payloadLength;
+      if (data.size() < messageSize)
+      {
+         return;
+      }
+
+      QString name = QString::fromUtf8(data.constData() + sHeaderSize, nameLength);
+      QByteArray payload = data.mid(payloadOffset, payloadLength);
+      data.remove(0, messageSize);
+      processMessage(pSocket, header, name, payload);
+   }
+}
+
+DataChannelServer::Header DataChannelServer::readHeader(const char* pData)
+{
+   Header header;
+   header.mMagic = static_cast<unsigned int>(getBytes(4, pData));
+   header.mVersion = static_cast<unsigned short>(getBytes(2, pData));
+   header.mOpcode = static_cast<unsigned short>(getBytes(2, pData));
+   header.mFlags = static_cast<unsigned int>(getBytes(4, pData));
+   header.mStartRow = static_cast<unsigned int>(getBytes(4, pData));
+   header.mRowCount = static_cast<unsigned int>(getBytes(4, pData));
+   header.mStartColumn = static_cast<unsigned int>(getBytes(4, pData));
+   header.mColumnCount = static_cast<unsigned int>(getBytes(4, pData));
+   header.mStartBand = static_cast<unsigned int>(getBytes(4, pData));
+   header.mBandCount = static_cast<unsigned int>(getBytes(4, pData));
+   header.mNameLength = static_cast<unsigned int>(getBytes(4, pData));
+   header.mPayloadLength = getBytes(8, pData);
+   return header;
+}
+
+void DataChannelServer::writeHeader(const Header& header, char* pData)
+{
+   putBytes(header.mMagic, 4, pData);
+   putBytes(header.mVersion, 2, pData);
+   putBytes(header.mOpcode, 2, pData);
+   putBytes(header.mFlags, 4, pData);
+   putBytes(header.mStartRow, 4, pData);
+   putBytes(header.mRowCount, 4, pData);
+   putBytes(header.mStartColumn, 4, pData);
+   putBytes(header.mColumnCount, 4, pData);
+   putBytes(header.mStartBand, 4, pData);
+   putBytes(header.mBandCount, 4, pData);
+   putBytes(header.mNameLength, 4, pData);
+   putBytes(header.mPayloadLength, 8, pData);
+}
+
+void DataChannelServer::processMessage(QTcpSocket* pSocket, Header& header, const QString& name,
+                                       const QByteArray& payload)
+{
+   RasterElement* pElement = findElement(name);
+   if (pElement == NULL)
+   {
+      sendError(pSocket, header, UNKNOWN_ELEMENT, "Unknown raster element: " + name);
+      return;
+   }
+
+   const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFYNRV(pDesc != NULL);
+
+   if (header.mOpcode == INFO)
+   {
+      header.mStartRow = 0;
+      header.mRowCount = pDesc->getRowCount();
+      header.mStartColumn = 0;
+      header.mColumnCount = pDesc->getColumnCount();
+      header.mStartBand = 0;
+      header.mBandCount = pDesc->getBandCount();
+
+      char info[12];
+      char* pInfo = info;
+      putBytes(static_cast<EncodingType::EnumType>(pDesc->getDataType()), 4, pInfo);
+      putBytes(pDesc->getBytesPerElement(), 4, pInfo);
+      putBytes(static_cast<InterleaveFormatType::EnumType>(pDesc->getInterleaveFormat()), 4, pInfo);
+      sendResponse(pSocket, header, info, sizeof(info));
+      return;
+   }
+
+   if (header.mOpcode != READ && header.mOpcode != WRITE)
+   {
+      sendError(pSocket, header, INVALID_REQUEST, QString("Unknown opcode: %1").arg(header.mOpcode));
+      return;
+   }
+
+   if (!resolveBlock(pElement, header))
+   {
+      sendError(pSocket, header, INVALID_BLOCK, "The requested block is outside of the raster element.");
+      return;
+   }
+
+   bool write = (header.mOpcode == WRITE);
+   uint64_t blockSize = static_cast<uint64_t>(header.mRowCount) * header.mColumnCount *
+      header.mBandCount * pDesc->getBytesPerElement();
+
+   if ((header.mFlags & SHARED_MEMORY) != 0)
+   {
+      QString errorText;
+      StatusType status = transferSharedMemory(pElement, header, payload, write, errorText);
+      if (status != SUCCESS)
+      {
+         sendError(pSocket, header, status, errorText);
+         return;
+      }
+
+      sendResponse(pSocket, header, NULL, 0);
+      return;
+   }
+
+   if (write)
+   {
+      if (static_cast<uint64_t>(payload.size()) != blockSize)
+      {
+         sendError(pSocket, header, INVALID_BLOCK, "The payload size does not match the block size.");
+         return;
+      }
+
+      // transferBlock() only reads from the buffer when writing
+      if (!transferBlock(pElement, header, const_cast<char*>(payload.constData()), true))
+      {
+         sendError(pSocket, header, ACCESS_FAILED, "Unable to write the block.");
+         return;
+      }
+
+      sendResponse(pSocket, header, NULL, 0);
+      return;
+   }
+
+   if (blockSize > sMaxSocketPayload)
+   {
+      sendError(pSocket, header, INVALID_BLOCK, "The block is too large for the socket, use shared memory.");
+      return;
+   }
+
+   std::vector<char> block(static_cast<size_t>(blockSize));
+   if (blockSize == 0 || !transferBlock(pElement, header, &block.front(), false))
+   {
+      sendError(pSocket, header, ACCESS_FAILED, "Unable to read the block.");
+      return;
+   }
+
+   sendResponse(pSocket, header, &block.front(), blockSize);
+}
+
+void DataChannelServer::sendResponse(QTcpSocket* pSocket, Header header, const char* pPayload,
+                                     uint64_t payloadLength)
+{
+   header.mFlags = SUCCESS;
+   header.mNameLength = 0;
+   header.mPayloadLength = payloadLength;
+
+   char headerData[sHeaderSize];
+   writeHeader(header, headerData);
+   pSocket->write(headerData, sHeaderSize);
+   if (pPayload != NULL && payloadLength > 0)
+   {
+      pSocket->write(pPayload, static_cast<qint64>(payloadLength));
+   }
+}
+
+void DataChannelServer::sendError(QTcpSocket* pSocket, Header header, StatusType status, const QString& message)
+{
+   QByteArray text = message.toUtf8();
+   header.mMagic = sMagic;
+   header.mVersion = sProtocolVersion;
+   header.mFlags = status;
+   header.mNameLength = 0;
+   header.mPayloadLength = text.size();
+
+   char headerData[sHeaderSize];
+   writeHeader(header, headerData);
+   pSocket->write(headerData, sHeaderSize);
+   pSocket->write(text);
+}
+
+RasterElement* DataChannelServer::findElement(const QString& name) const
+{
+   std::string elementName = name.toStdString();
+   std::vector<DataElement*> elements =
+      Service<ModelServices>()->getElements(TypeConverter::toString<RasterElement>());
+   for (std::vector<DataElement*>::const_iterator iter = elements.begin(); iter != elements.end(); ++iter)
+   {
+      if (*iter != NULL && (*iter)->getName() == elementName)
+      {
+         return static_cast<RasterElement*>(*iter);
+      }
+   }
+
+   return NULL;
+}
+
+bool DataChannelServer::resolveBlock(const RasterElement* pElement, Header& header) const
+{
+   const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDesc != NULL);
+
+   unsigned int rows = pDesc->getRowCount();
+   unsigned int columns = pDesc->getColumnCount();
+   unsigned int bands = pDesc->getBandCount();
+   if (header.mStartRow >= rows || header.mStartColumn >= columns || header.mStartBand >= bands)
+   {
+      return false;
+   }
+
+   if (header.mRowCount == 0)
+   {
+      header.mRowCount = rows - header.mStartRow;
+   }
+   if (header.mColumnCount == 0)
+   {
+      header.mColumnCount = columns - header.mStartColumn;
+   }
+   if (header.mBandCount == 0)
+   {
+      header.mBandCount = bands - header.mStartBand;
+   }
+
+   return header.mRowCount <= rows - header.mStartRow &&
+      header.mColumnCount <= columns - header.mStartColumn &&
+      header.mBandCount <= bands - header.mStartBand;
+}
+
+bool DataChannelServer::transferBlock(RasterElement* pElement, const Header& header, char* pData, bool write) const
+{
+   const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDesc != NULL);
+
+   // Requests use the native interleave since a converted accessor can not be written
+   InterleaveFormatType interleave = pDesc->getInterleaveFormat();
+   unsigned int bytesPerElement = pDesc->getBytesPerElement();
+   size_t rowBytes = static_cast<size_t>(header.mColumnCount) * bytesPerElement;
+   size_t bandBytes = rowBytes * header.mRowCount;
+   unsigned int endRow = header.mStartRow + header.mRowCount - 1;
+   unsigned int endColumn = header.mStartColumn + header.mColumnCount - 1;
+   if (interleave == BSQ)
+   {
+      for (unsigned int band = header.mStartBand; band < header.mStartBand + header.mBandCount; ++band)
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(BSQ);
+         pRequest->setRows(pDesc->getActiveRow(header.mStartRow), pDesc->getActiveRow(endRow));
+         pRequest->setColumns(pDesc->getActiveColumn(header.mStartColumn), pDesc->getActiveColumn(endColumn),
+            header.mColumnCount);
+         pRequest->setBands(pDesc->getActiveBand(band), pDesc->getActiveBand(band), 1);
+         pRequest->setWritable(write);
+         DataAccessor da = pElement->getDataAccessor(pRequest.release());
+         if (!da.isValid())
+         {
+            return false;
+         }
+
+         for (unsigned int row = header.mStartRow; row <= endRow; ++row)
+         {
+            da->toPixel(row, header.mStartColumn);
+            if (!da.isValid())
+            {
+               return false;
+            }
+
+            if (write)
+            {
+               memcpy(da->getColumn(), pData, rowBytes);
+            }
+            else
+            {
+               memcpy(pData, da->getColumn(), rowBytes);
+            }
+            pData += rowBytes;
+         }
+      }
+   }
+   else
+   {
+      // A BIP or BIL accessor holds every band, so scatter or gather each band of the block
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(interleave);
+      pRequest->setRows(pDesc->getActiveRow(header.mStartRow), pDesc->getActiveRow(endRow));
+      pRequest->setColumns(pDesc->getActiveColumn(header.mStartColumn), pDesc->getActiveColumn(endColumn),
+         header.mColumnCount);
+      pRequest->setWritable(write);
+      DataAccessor da = pElement->getDataAccessor(pRequest.release());
+      if (!da.isValid())
+      {
+         return false;
+      }
+
+      unsigned int bandCount = pDesc->getBandCount();
+      for (unsigned int row = header.mStartRow; row <= endRow; ++row)
+      {
+         da->toPixel(row, header.mStartColumn);
+         if (!da.isValid())
+         {
+            return false;
+         }
+
+         char* pRow = static_cast<char*>(da->getColumn());
+         char* pBlockRow = pData + (row - header.mStartRow) * rowBytes;
+         for (unsigned int band = 0; band < header.mBandCount; ++band)
+         {
+            char* pBlock = pBlockRow + band * bandBytes;
+            if (interleave == BIL)
+            {
+               char* pBand = pRow + (da->getRowSize() / bandCount) * (header.mStartBand + band);
+               if (write)
+               {
+                  memcpy(pBand, pBlock, rowBytes);
+               }
+               else
+               {
+                  memcpy(pBlock, pBand, rowBytes);
+               }
+               continue;
+            }
+
+            char* pPixel = pRow + (header.mStartBand + band) * bytesPerElement;
+            for (unsigned int column = 0; column < header.mColumnCount; ++column)
+            {
+               if (write)
+               {
+                  memcpy(pPixel, pBlock, bytesPerElement);
+               }
+               else
+               {
+                  memcpy(pBlock, pPixel, bytesPerElement);
+               }
+               pPixel += da->getColumnStride();
+               pBlock += bytesPerElement;
+            }
+         }
+      }
+   }
+
+   if (write)
+   {
+      pElement->updateData();
+   }
+
+   return true;
+}
+
+DataChannelServer::StatusType DataChannelServer::transferSharedMemory(RasterElement* pElement,
+   const Header& header, const QByteArray& objectName, bool write, QString& errorText) const
+{
+#if defined(WIN_API)
+   errorText = "The shared memory transport is not supported on this platform.";
+   return UNSUPPORTED;
+#else
+   const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFYRV(pDesc != NULL, ACCESS_FAILED);
+
+   uint64_t blockSize = static_cast<uint64_t>(header.mRowCount) * header.mColumnCount *
+      header.mBandCount * pDesc->getBytesPerElement();
+   std::string name(objectName.constData(), objectName.size());
+   if (name.empty() || blockSize == 0)
+   {
+      errorText = "A shared memory object name is required.";
+      return INVALID_REQUEST;
+   }
+
+   int fd = shm_open(name.c_str(), O_RDWR, 0);
+   if (fd < 0)
+   {
+      errorText = "Unable to open the shared memory object: " + QString::fromStdString(name);
+      return ACCESS_FAILED;
+   }
+
+   struct stat status;
+   if (fstat(fd, &status) != 0 || static_cast<uint64_t>(status.st_size) < blockSize)
+   {
+      close(fd);
+      errorText = "The shared memory object is smaller than the block.";
+      return INVALID_BLOCK;
+   }
+
+   void* pMapping = mmap(NULL, static_cast<size_t>(blockSize), write ? PROT_READ : PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd, 0);
+   close(fd);
+   if (pMapping == MAP_FAILED)
+   {
+      errorText = "Unable to map the shared memory object.";
+      return ACCESS_FAILED;
+   }
+
+   bool success = transferBlock(pElement, header, static_cast<char*>(pMapping), write);
+   munmap(pMapping, static_cast<size_t>(blockSize));
+   if (!success)
+   {
+      errorText = write ? "Unable to write the block." : "Unable to read the block.";
+      return ACCESS_FAILED;
+   }
+
+   return SUCCESS;
+#endif
+}
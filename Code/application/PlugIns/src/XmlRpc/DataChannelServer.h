@@ -0,0 +1,160 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef DATACHANNELSERVER_H
+#define DATACHANNELSERVER_H
+
+#include "AlgorithmShell.h"
+#include "AppConfig.h"
+#include "ConfigurationSettings.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QMap>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+class QTcpServer;
+class QTcpSocket;
+class RasterElement;
+
+/**
+ *  A binary companion to the XML-RPC server which moves raster data.
+ *
+ *  The XML-RPC methods control views but every value passes through XML text,
+ *  so pixel data can only be retrieved by exporting a file. The data channel
+ *  listens on a localhost TCP port and exchanges framed binary messages which
+ *  read and write blocks of a RasterElement directly.
+ *
+ *  Every message starts with a fixed 48 byte little endian header:
+ *  <pre>
+ *  offset  size  field
+ *       0     4  magic, 0x4344504F ("OPDC")
+ *       4     2  protocol version, currently 1
+ *       6     2  opcode
+ *       8     4  flags in a request, status in a response (0 is success)
+ *      12     4  start row
+ *      16     4  row count
+ *      20     4  start column
+ *      24     4  column count
+ *      28     4  start band
+ *      32     4  band count
+ *      36     4  name length in bytes
+ *      40     8  payload length in bytes
+ *  </pre>
+ *  The header is followed by the UTF-8 name of the RasterElement and then the payload.
+ *  Rows, columns and bands are zero-based active numbers. A count of zero selects
+ *  everything from the start value to the end of the dimension.
+ *
+ *  Pixel data is always sent band sequential with the encoding of the element, i.e.
+ *  all of the requested rows and columns of the first requested band followed by
+ *  the next band. Valid opcodes are as follows.
+ *
+ *  INFO (1)
+ *        The response header contains the number of rows, columns and bands in the element.
+ *        The response payload contains three 32 bit values: the EncodingType, the number of
+ *        bytes per element and the InterleaveFormatType of the element.
+ *  READ (2)
+ *        The response header echoes the resolved block and the payload contains the data.
+ *  WRITE (3)
+ *        The request payload contains the data for the block. The response has no payload.
+ *        The element is updated once the entire block has been written.
+ *
+ *  If the SHARED_MEMORY flag (1) is set in a READ or WRITE request, the request payload
+ *  is instead the name of a POSIX shared memory object created by the client which is
+ *  at least as large as the block. The data is copied into or out of the shared memory
+ *  object and does not pass through the socket. This transport is only available on
+ *  platforms with shm_open().
+ *
+ *  If the status of a response is not zero, the payload contains an error message.
+ */
+class DataChannelServer : public QObject, public AlgorithmShell
+{
+   Q_OBJECT
+
+public:
+   SETTING(XmlRpcDataChannelPort, XmlRpc, int, 0);
+
+   enum OpcodeType
+   {
+      INFO = 1,
+      READ = 2,
+      WRITE = 3
+   };
+
+   enum FlagType
+   {
+      SHARED_MEMORY = 1
+   };
+
+   enum StatusType
+   {
+      SUCCESS = 0,
+      INVALID_REQUEST = 1,
+      UNKNOWN_ELEMENT = 2,
+      INVALID_BLOCK = 3,
+      ACCESS_FAILED = 4,
+      UNSUPPORTED = 5
+   };
+
+   DataChannelServer();
+   ~DataChannelServer();
+
+   bool setBatch()
+   {
+      AlgorithmShell::setBatch();
+      return false;
+   }
+
+   bool getInputSpecification(PlugInArgList*& pInArgList);
+   bool getOutputSpecification(PlugInArgList*& pOutArgList);
+   bool execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList);
+
+protected slots:
+   void acceptConnection();
+   void readMessages();
+   void closeConnection();
+
+private:
+   DataChannelServer(const DataChannelServer& rhs);
+   DataChannelServer& operator=(const DataChannelServer& rhs);
+
+   struct Header
+   {
+      unsigned int mMagic;
+      unsigned short mVersion;
+      unsigned short mOpcode;
+      unsigned int mFlags;
+      unsigned int mStartRow;
+      unsigned int mRowCount;
+      unsigned int mStartColumn;
+      unsigned int mColumnCount;
+      unsigned int mStartBand;
+      unsigned int mBandCount;
+      unsigned int mNameLength;
+      uint64_t mPayloadLength;
+   };
+
+   static Header readHeader(const char* pData);
+   static void writeHeader(const Header& header, char* pData);
+
+   void processMessage(QTcpSocket* pSocket, Header& header, const QString& name, const QByteArray& payload);
+   void sendResponse(QTcpSocket* pSocket, Header header, const char* pPayload, uint64_t payloadLength);
+   void sendError(QTcpSocket* pSocket, Header header, StatusType status, const QString& message);
+
+   RasterElement* findElement(const QString& name) const;
+   bool resolveBlock(const RasterElement* pElement, Header& header) const;
+   bool transferBlock(RasterElement* pElement, const Header& header, char* pData, bool write) const;
+   StatusType transferSharedMemory(RasterElement* pElement, const Header& header, const QByteArray& objectName,
+      bool write, QString& errorText) const;
+
+   QTcpServer* mpServer;
+   QMap<QTcpSocket*, QByteArray> mPendingData;
+};
+
+#endif
@@ -23,6 +23,10 @@
 #include "switchOnEncoding.h"
 #include "TypeConverter.h"
 
+#include <QtCore/QAtomicInt>
+
+#include <algorithm>
+#include <new>
 #include <vector>
 
 namespace
@@ -183,6 +187,94 @@ namespace
          }
       }
    }
+
+   class DataBufferViewImp : public DataBufferView
+   {
+   public:
+      DataBufferViewImp(RasterElement* pRaster, const DataAccessor& accessor) :
+         mpRaster(pRaster),
+         mAccessor(accessor),
+         mRefCount(1)
+      {
+      }
+
+      RasterElement* mpRaster;
+      DataAccessor mAccessor;
+      std::vector<char> mCopy;
+
+      // Views may be retained and released from different threads
+      QAtomicInt mRefCount;
+   };
+
+   // the default size of a chunk of on-disk data
+   const size_t sDefaultChunkBytes = 16 * 1024 * 1024;
+
+   bool getDataBufferArgs(RasterElement* pRaster, const DataBufferArgs* pArgs, DataBufferArgs& args)
+   {
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      if (pDesc == NULL || pDesc->getRowCount() == 0 || pDesc->getColumnCount() == 0 || pDesc->getBandCount() == 0)
+      {
+         return false;
+      }
+      if (pArgs == NULL)
+      {
+         DataBufferArgs defaultArgs = {
+            0, pDesc->getRowCount() - 1,
+            0, pDesc->getColumnCount() - 1,
+            0, pDesc->getBandCount() - 1,
+            0, 0 };
+         args = defaultArgs;
+      }
+      else
+      {
+         args = *pArgs;
+      }
+      if (args.rowStart > args.rowEnd || args.rowEnd >= pDesc->getRowCount() ||
+         args.columnStart > args.columnEnd || args.columnEnd >= pDesc->getColumnCount() ||
+         args.bandStart > args.bandEnd || args.bandEnd >= pDesc->getBandCount())
+      {
+         return false;
+      }
+      if (args.chunkRows == 0)
+      {
+         size_t rowBytes = (args.columnEnd - args.columnStart + 1) * pDesc->getBytesPerElement();
+         if (pDesc->getInterleaveFormat() != BSQ)
+         {
+            rowBytes *= args.bandEnd - args.bandStart + 1;
+         }
+         args.chunkRows = static_cast<uint32_t>(std::max<size_t>(1, sDefaultChunkBytes / rowBytes));
+      }
+      return true;
+   }
+
+   uint32_t getRowChunkCount(const DataBufferArgs& args)
+   {
+      return (args.rowEnd - args.rowStart + args.chunkRows) / args.chunkRows;
+   }
+
+   void setContiguousStrides(DataBufferView& view, InterleaveFormatType interleave,
+                             uint32_t numRows, uint32_t numColumns, uint32_t numBands)
+   {
+      int64_t bytesPerElement = view.encodingTypeSize;
+      switch (interleave)
+      {
+      case BSQ:
+         view.columnStride = bytesPerElement;
+         view.rowStride = view.columnStride * numColumns;
+         view.bandStride = view.rowStride * numRows;
+         break;
+      case BIP:
+         view.bandStride = bytesPerElement;
+         view.columnStride = view.bandStride * numBands;
+         view.rowStride = view.columnStride * numColumns;
+         break;
+      case BIL:
+         view.columnStride = bytesPerElement;
+         view.bandStride = view.columnStride * numColumns;
+         view.rowStride = view.bandStride * numBands;
+         break;
+      }
+   }
 }
 
 extern "C"
@@ -446,6 +538,206 @@ extern "C"
       setLastError(SIMPLE_NO_ERROR);
    }
 
+   uint32_t getDataBufferChunkCount(DataElement* pElement, DataBufferArgs* pArgs)
+   {
+      RasterElement* pRaster = dynamic_cast<RasterElement*>(pElement);
+      DataBufferArgs args;
+      if (pRaster == NULL || !getDataBufferArgs(pRaster, pArgs, args))
+      {
+         setLastError(SIMPLE_BAD_PARAMS);
+         return 0;
+      }
+
+      setLastError(SIMPLE_NO_ERROR);
+      if (pRaster->getRawData() != NULL)
+      {
+         return 1;
+      }
+
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      uint32_t count = getRowChunkCount(args);
+      if (pDesc->getInterleaveFormat() == BSQ)
+      {
+         count *= args.bandEnd - args.bandStart + 1;
+      }
+      return count;
+   }
+
+   DataBufferView* createDataBufferView(DataElement* pElement, DataBufferArgs* pArgs, uint32_t chunk)
+   {
+      RasterElement* pRaster = dynamic_cast<RasterElement*>(pElement);
+      DataBufferArgs args;
+      if (pRaster == NULL || !getDataBufferArgs(pRaster, pArgs, args))
+      {
+         setLastError(SIMPLE_BAD_PARAMS);
+         return NULL;
+      }
+
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      InterleaveFormatType interleave = pDesc->getInterleaveFormat();
+
+      DataBufferView view;
+      view.interleaveFormat = static_cast<uint32_t>(interleave);
+      view.encodingType = static_cast<uint32_t>(pDesc->getDataType());
+      view.encodingTypeSize = pDesc->getBytesPerElement();
+      view.columnStart = args.columnStart;
+      view.numColumns = args.columnEnd - args.columnStart + 1;
+      view.copied = 0;
+
+      // the entire cube is in memory so view the subcube directly
+      char* pRawData = reinterpret_cast<char*>(pRaster->getRawData());
+      if (pRawData != NULL)
+      {
+         if (chunk != 0)
+         {
+            setLastError(SIMPLE_BAD_PARAMS);
+            return NULL;
+         }
+         view.rowStart = args.rowStart;
+         view.numRows = args.rowEnd - args.rowStart + 1;
+         view.bandStart = args.bandStart;
+         view.numBands = args.bandEnd - args.bandStart + 1;
+         view.writable = args.writable != 0 ? 1 : 0;
+         setContiguousStrides(view, interleave, pDesc->getRowCount(), pDesc->getColumnCount(), pDesc->getBandCount());
+         view.pData = pRawData + view.rowStart * view.rowStride + view.columnStart * view.columnStride +
+            view.bandStart * view.bandStride;
+
+         DataBufferViewImp* pView = new DataBufferViewImp(pRaster, DataAccessor(NULL, NULL));
+         static_cast<DataBufferView&>(*pView) = view;
+         setLastError(SIMPLE_NO_ERROR);
+         return pView;
+      }
+
+      // on-disk data is viewed one chunk of rows (and one band for BSQ) at a time
+      uint32_t rowChunks = getRowChunkCount(args);
+      uint32_t rowChunk = chunk;
+      view.bandStart = args.bandStart;
+      view.numBands = args.bandEnd - args.bandStart + 1;
+      if (interleave == BSQ)
+      {
+         view.bandStart += chunk / rowChunks;
+         view.numBands = 1;
+         rowChunk = chunk % rowChunks;
+      }
+      view.rowStart = args.rowStart + rowChunk * args.chunkRows;
+      if (view.bandStart > args.bandEnd || rowChunk >= rowChunks)
+      {
+         setLastError(SIMPLE_BAD_PARAMS);
+         return NULL;
+      }
+      view.numRows = std::min(args.chunkRows, args.rowEnd - view.rowStart + 1);
+      view.writable = args.writable != 0 ? 1 : 0;
+
+      uint32_t rowEnd = view.rowStart + view.numRows - 1;
+      uint32_t bandEnd = view.bandStart + view.numBands - 1;
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(interleave);
+      pRequest->setRows(pDesc->getActiveRow(view.rowStart), pDesc->getActiveRow(rowEnd), view.numRows);
+      pRequest->setColumns(pDesc->getActiveColumn(view.columnStart), pDesc->getActiveColumn(args.columnEnd),
+         view.numColumns);
+      pRequest->setBands(pDesc->getActiveBand(view.bandStart), pDesc->getActiveBand(bandEnd), view.numBands);
+      pRequest->setWritable(view.writable != 0);
+      DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+      if (!da.isValid())
+      {
+         setLastError(SIMPLE_OTHER_FAILURE);
+         return NULL;
+      }
+
+      // if the pager provided the entire chunk in one page, lease the page for the life of the view
+      if (da->getConcurrentRows() >= view.numRows && da->getConcurrentColumns() >= view.numColumns)
+      {
+         view.pData = da->getColumn();
+         view.rowStride = da->getRowStride();
+         view.columnStride = da->getColumnStride();
+         view.bandStride = view.encodingTypeSize;
+         if (interleave == BIL)
+         {
+            view.bandStride *= da->getConcurrentColumns();
+         }
+
+         DataBufferViewImp* pView = new DataBufferViewImp(pRaster, da);
+         static_cast<DataBufferView&>(*pView) = view;
+         setLastError(SIMPLE_NO_ERROR);
+         return pView;
+      }
+
+      // otherwise copy the chunk
+      da = DataAccessor(NULL, NULL);
+      DataBufferViewImp* pView = new DataBufferViewImp(pRaster, da);
+      try
+      {
+         pView->mCopy.resize(static_cast<size_t>(view.numRows) * view.numColumns * view.numBands *
+            view.encodingTypeSize);
+      }
+      catch (const std::bad_alloc&)
+      {
+         delete pView;
+         setLastError(SIMPLE_NO_MEM);
+         return NULL;
+      }
+      bool success = true;
+      switchOnComplexEncoding(pDesc->getDataType(), copySubcube, &pView->mCopy.front(), pRaster,
+         view.rowStart, rowEnd,
+         view.columnStart, args.columnEnd,
+         view.bandStart, bandEnd, false, success);
+      if (!success)
+      {
+         delete pView;
+         setLastError(SIMPLE_OTHER_FAILURE);
+         return NULL;
+      }
+      view.pData = &pView->mCopy.front();
+      view.copied = 1;
+      setContiguousStrides(view, interleave, view.numRows, view.numColumns, view.numBands);
+      static_cast<DataBufferView&>(*pView) = view;
+      setLastError(SIMPLE_NO_ERROR);
+      return pView;
+   }
+
+   void retainDataBufferView(DataBufferView* pView)
+   {
+      if (pView == NULL)
+      {
+         setLastError(SIMPLE_BAD_PARAMS);
+         return;
+      }
+      static_cast<DataBufferViewImp*>(pView)->mRefCount.ref();
+      setLastError(SIMPLE_NO_ERROR);
+   }
+
+   void destroyDataBufferView(DataBufferView* pView)
+   {
+      DataBufferViewImp* pViewImp = static_cast<DataBufferViewImp*>(pView);
+      if (pViewImp == NULL)
+      {
+         setLastError(SIMPLE_BAD_PARAMS);
+         return;
+      }
+
+      setLastError(SIMPLE_NO_ERROR);
+      if (pViewImp->mRefCount.deref())
+      {
+         return;
+      }
+
+      if (pViewImp->copied != 0 && pViewImp->writable != 0)
+      {
+         const RasterDataDescriptor* pDesc =
+            static_cast<const RasterDataDescriptor*>(pViewImp->mpRaster->getDataDescriptor());
+         bool success = true;
+         switchOnComplexEncoding(pDesc->getDataType(), copySubcube, &pViewImp->mCopy.front(), pViewImp->mpRaster,
+            pViewImp->rowStart, pViewImp->rowStart + pViewImp->numRows - 1,
+            pViewImp->columnStart, pViewImp->columnStart + pViewImp->numColumns - 1,
+            pViewImp->bandStart, pViewImp->bandStart + pViewImp->numBands - 1, true, success);
+         if (!success)
+         {
+            setLastError(SIMPLE_OTHER_FAILURE);
+         }
+      }
+      delete pViewImp;
+   }
+
    DataAccessorImpl* createDataAccessor(DataElement* pElement, DataAccessorArgs* pArgs)
    {
       RasterElement* pRasterElement = dynamic_cast<RasterElement*>(pElement);
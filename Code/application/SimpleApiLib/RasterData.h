@@ -191,6 +191,136 @@ extern "C"
     */
    EXPORT_SYMBOL void updateRasterElement(DataElement* pElement);
 
+   /**
+    * Descriptor for buffer view access.
+    * Rows, columns, and bands are all 0-based and reflect active numbers.
+    *
+    * @see createDataBufferView()
+    */
+   struct DataBufferArgs
+   {
+      uint32_t rowStart;         /**< The first row to access. */
+      uint32_t rowEnd;           /**< The last row to access. */
+
+      uint32_t columnStart;      /**< The first column to access. */
+      uint32_t columnEnd;        /**< The last column to access. */
+
+      uint32_t bandStart;        /**< The first band to access. */
+      uint32_t bandEnd;          /**< The last band to access. */
+
+      uint32_t chunkRows;        /**< The maximum number of rows in each chunk of an on-disk
+                                      RasterElement or 0 to use the default. */
+      uint32_t writable;         /**< 0 -> Do not request write access, Any other value -> Request write access. */
+   };
+
+   /**
+    * A strided view of a chunk of raster data.
+    *
+    * The element at (row, column, band) of the chunk is located at
+    * <tt>pData + row * rowStride + column * columnStride + band * bandStride</tt>
+    * where row, column, and band are relative to rowStart, columnStart, and bandStart.
+    * The strides are in bytes and describe the native layout of the data so the
+    * view can be wrapped by external array types (e.g. numpy) without copying.
+    *
+    * @see createDataBufferView()
+    */
+   struct DataBufferView
+   {
+      void* pData;               /**< The first element in the chunk. */
+
+      uint32_t rowStart;         /**< The first row in the chunk. */
+      uint32_t numRows;          /**< The number of rows in the chunk. */
+      uint32_t columnStart;      /**< The first column in the chunk. */
+      uint32_t numColumns;       /**< The number of columns in the chunk. */
+      uint32_t bandStart;        /**< The first band in the chunk. */
+      uint32_t numBands;         /**< The number of bands in the chunk. */
+
+      int64_t rowStride;         /**< The number of bytes between consecutive rows. */
+      int64_t columnStride;      /**< The number of bytes between consecutive columns. */
+      int64_t bandStride;        /**< The number of bytes between consecutive bands. */
+
+      uint32_t interleaveFormat; /**< 0 -> BSQ, 1 -> BIP, 2 -> BIL.  @see InterleaveFormatType */
+      uint32_t encodingType;     /**< 0 -> char, 1 -> unsigned char, 2 -> short, 3 -> unsigned short,
+                                      4 -> complex short, 5 -> int, 6 -> unsigned int, 7 -> float,
+                                      8 -> complex float, 9 -> double.  @see EncodingType */
+      uint32_t encodingTypeSize; /**< The number of bytes per element.  @see RasterUtilities::bytesInEncoding() */
+
+      uint32_t writable;         /**< 0 -> The data must not be modified, Any other value -> The data may be
+                                      modified in place. */
+      uint32_t copied;           /**< 0 -> pData refers to the RasterElement's memory or pages,
+                                      Any other value -> pData refers to a copy of the data. Writable copies
+                                      are written back to the RasterElement when the view is destroyed. */
+   };
+
+   /**
+    * Get the number of chunks needed to view a subcube with createDataBufferView().
+    *
+    * A RasterElement whose entire cube is in memory is always viewed as a single chunk.
+    * On-disk RasterElements are divided into chunks of at most DataBufferArgs::chunkRows
+    * rows.  BSQ on-disk RasterElements are also divided into one chunk for each band.
+    *
+    * @param pElement
+    *        The RasterElement to access.
+    * @param pArgs
+    *        The structure containing information to process the request or \c NULL to access the entire cube.
+    * @return The number of chunks.
+    *         On failure, 0 is returned and getLastError() may be queried for information on the error.
+    *
+    * @see createDataBufferView()
+    */
+   EXPORT_SYMBOL uint32_t getDataBufferChunkCount(DataElement* pElement, DataBufferArgs* pArgs);
+
+   /**
+    * Obtain a strided view of a chunk of raster data which must be destroyed by calling destroyDataBufferView().
+    *
+    * If the RasterElement is in memory or its pager provides the entire chunk in a single page,
+    * the view refers directly to the RasterElement's data and the page remains leased until the
+    * view is destroyed.  Otherwise the chunk is copied into a contiguous buffer in the native
+    * interleave of the RasterElement.
+    *
+    * @param pElement
+    *        The RasterElement to access.
+    * @param pArgs
+    *        The structure containing information to process the request or \c NULL to access the entire cube.
+    *        \c NULL requests read-only access unless the entire cube is in memory.
+    * @param chunk
+    *        The 0-based chunk to view.  This must be less than the value returned by getDataBufferChunkCount().
+    * @return A view of the chunk with a reference count of one.
+    *         On failure, \c NULL is returned and getLastError() may be queried for information on the error.
+    *
+    * @see getDataBufferChunkCount(), retainDataBufferView(), destroyDataBufferView(), createDataPointer()
+    */
+   EXPORT_SYMBOL DataBufferView* createDataBufferView(DataElement* pElement, DataBufferArgs* pArgs, uint32_t chunk);
+
+   /**
+    * Add a reference to a view obtained by calling createDataBufferView().
+    *
+    * Each reference must be released by calling destroyDataBufferView().  References may be
+    * added and released from different threads.
+    *
+    * @param pView
+    *        The view to reference.
+    *
+    * @see destroyDataBufferView()
+    */
+   EXPORT_SYMBOL void retainDataBufferView(DataBufferView* pView);
+
+   /**
+    * Release a reference to a view obtained by calling createDataBufferView().
+    *
+    * When the last reference is released, the page is released and any writable copy is written
+    * back to the RasterElement.  The caller should call updateRasterElement() to redisplay the data.
+    *
+    * Suitable for use as a cleanup callback.  If \p pView is \c NULL or the copy can not be
+    * written back, getLastError() may be queried for information on the error.
+    *
+    * @param pView
+    *        The view to release.
+    *
+    * @see createDataBufferView(), retainDataBufferView()
+    */
+   EXPORT_SYMBOL void destroyDataBufferView(DataBufferView* pView);
+
    /**
     * Descriptor for data access.
     * Rows, columns, and bands are all 0-based and reflect active numbers.
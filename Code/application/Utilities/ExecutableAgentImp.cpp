@@ -22,6 +22,7 @@
 #include "SessionResource.h"
 #include "SpatialDataView.h"
 #include "Testable.h"
+#include "TraceSpan.h"
 #include "WorkspaceWindow.h"
 
 #include <string>
@@ -240,7 +241,12 @@ bool ExecutableAgentImp::executePlugIn()
             pProgressImp->setPlugIn(pPlugIn);
          }
 
+         TraceSpan span("plugin", pPlugIn->getName());
          bSuccess = pExecutable->execute(&inArgList, &outArgList);
+         if (span.isActive())
+         {
+            span.setDetail(string(mBatch ? "batch" : "interactive") + (bSuccess ? ", succeeded" : ", failed"));
+         }
 
          if (pProgressImp != NULL)
          {
@@ -0,0 +1,255 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "MessageJournal.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QTime>
+
+using namespace std;
+
+namespace
+{
+   // The number of entries the writer drains before checking the flush policy
+   const int sBatchSize = 256;
+
+   // Positions are free running counters so compare them with wrap around
+   int distance(int from, int to)
+   {
+      return static_cast<int>(static_cast<unsigned int>(to) - static_cast<unsigned int>(from));
+   }
+}
+
+MessageJournal::MessageJournal(DurabilityType durability, unsigned int capacity, unsigned int flushInterval) :
+   mDurability(durability),
+   mFlushInterval(flushInterval == 0 ? 1 : flushInterval),
+   mMask(0),
+   mEnqueuePosition(0),
+   mDequeuePosition(0),
+   mWriterIdle(0),
+   mFlushRequested(0),
+   mFlushedPosition(0),
+   mStopping(false)
+{
+   unsigned int size = 2;
+   while (size < capacity && size < 0x100000)
+   {
+      size <<= 1;
+   }
+
+   mEntries.resize(size);
+   mMask = static_cast<int>(size - 1);
+   for (unsigned int i = 0; i < size; ++i)
+   {
+      mEntries[i].mSequence = static_cast<int>(i);
+   }
+
+   if (mDurability != FLUSH_EACH_MESSAGE)
+   {
+      start(QThread::LowPriority);
+   }
+}
+
+MessageJournal::~MessageJournal()
+{
+   if (isRunning())
+   {
+      {
+         QMutexLocker lock(&mMutex);
+         mStopping = true;
+         mWorkAvailable.wakeOne();
+      }
+      wait();
+   }
+}
+
+MessageJournal::DurabilityType MessageJournal::getDurability() const
+{
+   return mDurability;
+}
+
+MessageJournal::DurabilityType MessageJournal::durabilityFromString(const string& name)
+{
+   if (name == "Message")
+   {
+      return FLUSH_EACH_MESSAGE;
+   }
+   else if (name == "Periodic")
+   {
+      return FLUSH_PERIODICALLY;
+   }
+
+   return FLUSH_EACH_BATCH;
+}
+
+void MessageJournal::append(QFile* pDevice, const string& text)
+{
+   if (pDevice == NULL || text.empty())
+   {
+      return;
+   }
+
+   if (mDurability == FLUSH_EACH_MESSAGE)
+   {
+      QMutexLocker lock(&mMutex);
+      pDevice->write(text.data(), text.size());
+      pDevice->flush();
+      return;
+   }
+
+   // Claim a slot by advancing the enqueue position. A slot is free when its
+   // sequence equals the position, so a smaller sequence means the ring is full.
+   int position = mEnqueuePosition;
+   Entry* pEntry = NULL;
+   for (;;)
+   {
+      pEntry = &mEntries[position & mMask];
+      int diff = distance(position, pEntry->mSequence.fetchAndAddAcquire(0));
+      if (diff == 0)
+      {
+         if (mEnqueuePosition.testAndSetOrdered(position, position + 1))
+         {
+            break;
+         }
+      }
+      else if (diff < 0)
+      {
+         wakeWriter();
+         QThread::yieldCurrentThread();
+      }
+
+      position = mEnqueuePosition;
+   }
+
+   pEntry->mpDevice = pDevice;
+   pEntry->mText = text;
+   pEntry->mSequence.fetchAndStoreOrdered(position + 1);
+
+   if (mWriterIdle.fetchAndAddOrdered(0) != 0)
+   {
+      wakeWriter();
+   }
+}
+
+void MessageJournal::flush()
+{
+   if (!isRunning())
+   {
+      return;
+   }
+
+   int target = mEnqueuePosition;
+   mFlushRequested.fetchAndStoreOrdered(1);
+
+   QMutexLocker lock(&mMutex);
+   while (distance(mFlushedPosition, target) > 0)
+   {
+      mWorkAvailable.wakeOne();
+      mWorkDone.wait(&mMutex, mFlushInterval);
+      mFlushRequested.fetchAndStoreOrdered(1);
+   }
+}
+
+bool MessageJournal::hasQueuedText() const
+{
+   const Entry& entry = mEntries[mDequeuePosition & mMask];
+   return const_cast<QAtomicInt&>(entry.mSequence).fetchAndAddAcquire(0) == mDequeuePosition + 1;
+}
+
+bool MessageJournal::dequeue(QFile*& pDevice, string& text)
+{
+   if (!hasQueuedText())
+   {
+      return false;
+   }
+
+   Entry& entry = mEntries[mDequeuePosition & mMask];
+   pDevice = entry.mpDevice;
+   text.swap(entry.mText);
+   entry.mText.clear();
+   entry.mSequence.fetchAndStoreRelease(mDequeuePosition + mMask + 1);
+   ++mDequeuePosition;
+   return true;
+}
+
+void MessageJournal::wakeWriter()
+{
+   QMutexLocker lock(&mMutex);
+   mWorkAvailable.wakeOne();
+}
+
+void MessageJournal::flushDevices()
+{
+   for (set<QFile*>::iterator iter = mDirtyDevices.begin(); iter != mDirtyDevices.end(); ++iter)
+   {
+      (*iter)->flush();
+   }
+   mDirtyDevices.clear();
+}
+
+void MessageJournal::run()
+{
+   QTime lastFlush;
+   lastFlush.start();
+
+   QFile* pDevice = NULL;
+   string text;
+   for (;;)
+   {
+      int count = 0;
+      while (count < sBatchSize && dequeue(pDevice, text))
+      {
+         pDevice->write(text.data(), text.size());
+         mDirtyDevices.insert(pDevice);
+         ++count;
+      }
+
+      bool flushRequested = (mFlushRequested.fetchAndStoreOrdered(0) != 0);
+      bool flushNow = flushRequested ||
+         (mDurability == FLUSH_EACH_BATCH && count > 0) ||
+         (mDurability == FLUSH_PERIODICALLY && lastFlush.elapsed() >= static_cast<int>(mFlushInterval));
+      if (flushNow)
+      {
+         flushDevices();
+         lastFlush.restart();
+      }
+
+      QMutexLocker lock(&mMutex);
+      if (flushNow)
+      {
+         mFlushedPosition = mDequeuePosition;
+         mWorkDone.wakeAll();
+      }
+
+      if (count == sBatchSize || hasQueuedText())
+      {
+         continue;
+      }
+
+      if (mStopping)
+      {
+         break;
+      }
+
+      // Producers only signal the condition while the writer is idle so check
+      // for text which was queued before the flag was set
+      mWriterIdle.fetchAndStoreOrdered(1);
+      if (!hasQueuedText())
+      {
+         mWorkAvailable.wait(&mMutex, mFlushInterval);
+      }
+      mWriterIdle.fetchAndStoreOrdered(0);
+   }
+
+   flushDevices();
+   QMutexLocker lock(&mMutex);
+   mFlushedPosition = mDequeuePosition;
+   mWorkDone.wakeAll();
+}
@@ -0,0 +1,128 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef MESSAGEJOURNAL_H
+#define MESSAGEJOURNAL_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <set>
+#include <string>
+#include <vector>
+
+class QFile;
+
+/**
+ *  Writes message log text to disk from a background thread.
+ *
+ *  Text is queued in a bounded ring buffer which any number of threads may
+ *  append to without taking a lock. A single writer thread drains the buffer
+ *  in batches and flushes the devices according to the durability policy.
+ *  If the buffer is full, append() waits for the writer to make room so no
+ *  text is ever dropped.
+ */
+class MessageJournal : public QThread
+{
+public:
+   enum DurabilityType
+   {
+      FLUSH_EACH_MESSAGE,  /**< Text is written and flushed on the calling thread before append() returns. */
+      FLUSH_EACH_BATCH,    /**< Devices are flushed after every batch the writer drains. */
+      FLUSH_PERIODICALLY   /**< Devices are flushed when the flush interval elapses. */
+   };
+
+   /**
+    *  Creates and starts a journal.
+    *
+    *  @param   durability
+    *           When written text is flushed to the devices.
+    *  @param   capacity
+    *           The number of entries in the ring buffer. This is rounded up to a power of two.
+    *  @param   flushInterval
+    *           The maximum number of milliseconds the writer sleeps when idle. In
+    *           FLUSH_PERIODICALLY mode this is also the interval between flushes.
+    */
+   MessageJournal(DurabilityType durability, unsigned int capacity, unsigned int flushInterval);
+
+   /**
+    *  Writes all queued text and stops the writer thread.
+    */
+   ~MessageJournal();
+
+   /**
+    *  Queues text to be written.
+    *
+    *  @param   pDevice
+    *           The open device to write to.
+    *  @param   text
+    *           The text to write.
+    */
+   void append(QFile* pDevice, const std::string& text);
+
+   /**
+    *  Blocks until all text queued before the call has been written and flushed.
+    *
+    *  This must be called before closing a device which has been passed to append().
+    */
+   void flush();
+
+   DurabilityType getDurability() const;
+
+   /**
+    *  Parses a durability policy name.
+    *
+    *  @param   name
+    *           "Message", "Batch" or "Periodic".
+    *
+    *  @return  The policy or FLUSH_EACH_BATCH if the name is not recognized.
+    */
+   static DurabilityType durabilityFromString(const std::string& name);
+
+protected:
+   void run();
+
+private:
+   MessageJournal(const MessageJournal& rhs);
+   MessageJournal& operator=(const MessageJournal& rhs);
+
+   struct Entry
+   {
+      Entry() : mpDevice(NULL) {}
+
+      QAtomicInt mSequence;
+      QFile* mpDevice;
+      std::string mText;
+   };
+
+   bool hasQueuedText() const;
+   bool dequeue(QFile*& pDevice, std::string& text);
+   void wakeWriter();
+   void flushDevices();
+
+   DurabilityType mDurability;
+   unsigned int mFlushInterval;
+   std::vector<Entry> mEntries;
+   int mMask;
+   QAtomicInt mEnqueuePosition;
+   int mDequeuePosition;
+
+   QMutex mMutex;
+   QWaitCondition mWorkAvailable;
+   QWaitCondition mWorkDone;
+   QAtomicInt mWriterIdle;
+   QAtomicInt mFlushRequested;
+   int mFlushedPosition;
+   bool mStopping;
+   std::set<QFile*> mDirtyDevices;
+};
+
+#endif
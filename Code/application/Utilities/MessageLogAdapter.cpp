@@ -11,8 +11,9 @@
 
 using namespace std;
 
-MessageLogAdapter::MessageLogAdapter(const char* name, const char* path, QFile *journal) :
-   MessageLogImp(name, path, journal)
+MessageLogAdapter::MessageLogAdapter(const char* name, const char* path, QFile *journal,
+                                     MessageJournal* pJournalWriter, unsigned int maxMessages) :
+   MessageLogImp(name, path, journal, pJournalWriter, maxMessages)
 {}
 
 MessageLogAdapter::~MessageLogAdapter()
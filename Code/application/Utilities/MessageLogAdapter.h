@@ -18,7 +18,8 @@
 class MessageLogAdapter : public MessageLog, public MessageLogImp MESSAGELOGADAPTEREXTENSION_CLASSES
 {
 public:
-   MessageLogAdapter(const char* name, const char* path, QFile *journal);
+   MessageLogAdapter(const char* name, const char* path, QFile *journal, MessageJournal* pJournalWriter,
+      unsigned int maxMessages);
    virtual ~MessageLogAdapter();
 
    // TypeAwareObject
@@ -14,6 +14,7 @@
 #include "DynamicObjectAdapter.h"
 #include "FilenameImp.h"
 #include "Int64.h"
+#include "MessageJournal.h"
 #include "MessageLogAdapter.h"
 #include "UInt64.h"
 #include "xmlwriter.h"
@@ -28,11 +29,14 @@
 using namespace std;
 XERCES_CPP_NAMESPACE_USE
 
-MessageLogImp::MessageLogImp(const char* name, const char* path, QFile* journal) :
+MessageLogImp::MessageLogImp(const char* name, const char* path, QFile* journal, MessageJournal* pJournalWriter,
+                             unsigned int maxMessages) :
          mpLogName(name),
+         mMaxMessages(maxMessages),
+         mMessageCount(0),
          mpCurrentStep(NULL),
          mpJournal(journal),
-         mpWriter(NULL)
+         mpJournalWriter(pJournalWriter)
 {
    mpFilename = new FilenameImp(path);
    //determine the path + filename of the log
@@ -68,8 +72,6 @@ MessageLogImp::MessageLogImp(const char* name, const char* path, QFile* journal)
    {
       fname = (string)path + fname + extension;
    }
-   mpJournalWriter = new QTextStream(mpJournal);
-
    QTemporaryFile* pTempFile = new QTemporaryFile(QString::fromStdString(fname));
    if (pTempFile != NULL)
    {
@@ -93,7 +95,12 @@ MessageLogImp::MessageLogImp(const char* name, const char* path, QFile* journal)
       mpLogFile = NULL;
    }
 
-   mpWriter = new XMLWriter("messagelog");
+   if (mpLogFile != NULL && mpJournalWriter != NULL)
+   {
+      mpJournalWriter->append(mpLogFile, string("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\" ?>\n"
+         "<messagelog xmlns=\"") + XmlBase::sNamespaceId + "\">\n");
+   }
+
    Message* pOpen(createMessage("Log Opened", "app", "EC355E3E-03CA-4081-9006-5F45D6A488B3"));
    pOpen->finalize();
 }
@@ -102,17 +109,22 @@ MessageLogImp::~MessageLogImp()
 {
    MessageAdapter* pClosed(new MessageAdapter("Log Closed", "app", "3620CAD7-3535-4716-9686-E024E201481F"));
    pClosed->finalize();
-   pClosed->getId()(size()+1);
-   if ((mpWriter != NULL) && (mpLogFile != NULL))
+   pClosed->getId()(mMessageCount + 1);
+   if (mpLogFile != NULL && mpJournalWriter != NULL)
    {
-      QTextStream stream(mpLogFile);
-      stream << serialize().c_str();
-   }
-   if (mpWriter != NULL)
-   {
-      delete mpWriter;
-      mpWriter = NULL;
+      // Write the messages which were not finalized before the log closed
+      for (vector<Message*>::const_iterator iter = mMessageList.begin(); iter != mMessageList.end(); ++iter)
+      {
+         if (mWrittenMessages.find(*iter) == mWrittenMessages.end())
+         {
+            writeLogFile(dynamic_cast<MessageImp*>(*iter));
+         }
+      }
+      writeLogFile(pClosed);
+      mpJournalWriter->append(mpLogFile, "</messagelog>\n");
+      mpJournalWriter->flush();
    }
+   delete pClosed;
 
    if (mpLogFile != NULL)
    {
@@ -120,11 +132,6 @@ MessageLogImp::~MessageLogImp()
       delete mpLogFile;
       mpLogFile = NULL;
    }
-   if (mpJournalWriter != NULL)
-   {
-      delete mpJournalWriter;
-      mpJournalWriter = NULL;
-   }
 
    if (mpFilename != NULL)
    {
@@ -174,7 +181,7 @@ Message* MessageLogImp::createMessage(const string& action, const string& compon
       }
 
       mMessageList.push_back(msg);
-      pMsgAdapter->getId()(size());
+      pMsgAdapter->getId()(++mMessageCount);
       pMsgAdapter->attach(SIGNAL_NAME(Message, MessageModified), Slot(this, &MessageLogImp::messageModified));
       pMsgAdapter->attach(SIGNAL_NAME(Message, Hidden), Slot(this, &MessageLogImp::messageHidden));
       // The next line of code must be as it is. It cannot be dynamic_cast<Subject*>(this) because
@@ -204,7 +211,7 @@ Step* MessageLogImp::createStep(const string& action, const string& component, c
       stp = pStpAdapter;
       mMessageList.push_back(static_cast<Message*>(stp));
       mpCurrentStep = stp;
-      pStpAdapter->getId()(size());
+      pStpAdapter->getId()(++mMessageCount);
       pStpAdapter->attach(SIGNAL_NAME(Message, MessageModified), Slot(this, &MessageLogImp::messageModified));
       pStpAdapter->attach(SIGNAL_NAME(Message, Hidden), Slot(this, &MessageLogImp::messageHidden));
       pStpAdapter->attach(SIGNAL_NAME(Step, MessageAdded), Slot(this, &MessageLogImp::messageAdded));
@@ -275,6 +282,68 @@ const string& MessageLogImp::getLogName() const
    return mpLogName;
 }
 
+void MessageLogImp::writeJournal(const string& event, Message* pMsg, const string& details)
+{
+   StepImp* pStpImp(dynamic_cast<StepImp*>(pMsg));
+   MessageImp* pMsgImp(dynamic_cast<MessageImp*>(pMsg));
+   string line = mpLogName + " - " + event + ((pStpImp != NULL) ? " Step[" : " Message[") +
+      ((pStpImp != NULL) ? pStpImp : pMsgImp)->getStringId() + details + "\n";
+   mpJournalWriter->append(mpJournal, line);
+}
+
+void MessageLogImp::writeLogFile(const MessageImp* pMsg)
+{
+   if (pMsg == NULL || mpLogFile == NULL || mpJournalWriter == NULL)
+   {
+      return;
+   }
+
+   // Serialize the message in its own document and append only the message element
+   XMLWriter writer("messagelog");
+   pMsg->toXml(&writer);
+   string xml = writer.writeToString();
+   string::size_type start = xml.find("<messagelog");
+   string::size_type stop = xml.rfind("</messagelog>");
+   if (start == string::npos || stop == string::npos)
+   {
+      return;
+   }
+
+   start = xml.find('>', start);
+   if (start == string::npos || start > stop)
+   {
+      return;
+   }
+
+   mpJournalWriter->append(mpLogFile, xml.substr(start + 1, stop - start - 1));
+}
+
+void MessageLogImp::evictMessages()
+{
+   if (mMaxMessages == 0 || mMessageList.size() <= mMaxMessages)
+   {
+      return;
+   }
+
+   // Remove a quarter of the limit at a time so observers are not notified for every new message
+   MessageLog::size_t target = mMaxMessages - mMaxMessages / 4;
+   vector<Message*>::iterator iter = mMessageList.begin();
+   while (iter != mMessageList.end() && mMessageList.size() > target)
+   {
+      Message* pMsg = *iter;
+      if (pMsg == mpCurrentStep || mWrittenMessages.find(pMsg) == mWrittenMessages.end())
+      {
+         ++iter;
+         continue;
+      }
+
+      iter = mMessageList.erase(iter);
+      mWrittenMessages.erase(pMsg);
+      notify(SIGNAL_NAME(MessageLog, MessageDeleted), boost::any(pMsg));
+      delete dynamic_cast<MessageImp*>(pMsg);
+   }
+}
+
 void MessageLogImp::messageAdded(Subject& subject, const string& signal, const boost::any& v)
 {
    Message* pMsg(boost::any_cast<Message*>(v));
@@ -283,13 +352,7 @@ void MessageLogImp::messageAdded(Subject& subject, const string& signal, const b
       return;
    }
 
-   Step* pStp(dynamic_cast<Step*>(pMsg));
-   StepImp* pStpImp(dynamic_cast<StepImp*>(pStp));
-   MessageImp* pMsgImp(dynamic_cast<MessageImp*>(pMsg));
-   *mpJournalWriter << mpLogName.c_str() << " - ADDED "
-      << ((pStpImp != NULL) ? "Step" : "Message")
-      << "[" << ((pStpImp != NULL) ? pStpImp : pMsgImp)->getStringId().c_str() << "] "
-      << pMsg->getAction().c_str() << endl << flush;
+   writeJournal("ADDED", pMsg, "] " + pMsg->getAction());
    notify(SIGNAL_NAME(MessageLog, MessageAdded), v);
 }
 
@@ -301,14 +364,8 @@ void MessageLogImp::messageModified(Subject& subject, const string& signal, cons
       return;
    }
 
-   Step* pStp(dynamic_cast<Step*>(pMsg));
-   StepImp* pStpImp(dynamic_cast<StepImp*>(pStp));
-   MessageImp* pMsgImp(dynamic_cast<MessageImp*>(pMsg));
-   *mpJournalWriter << mpLogName.c_str() << " - PROPERTY ADDED "
-      << ((pStpImp != NULL) ? "Step" : "Message")
-      << "[" << ((pStpImp != NULL) ? pStpImp : pMsgImp)->getStringId().c_str() << "."
-      << pMsg->getProperties()->getNumAttributes() << "] "
-      << endl << flush;
+   writeJournal("PROPERTY ADDED", pMsg,
+      "." + QString::number(pMsg->getProperties()->getNumAttributes()).toStdString() + "] ");
    notify(SIGNAL_NAME(MessageLog, MessageModified), v);
 }
 
@@ -320,31 +377,37 @@ void MessageLogImp::messageHidden(Subject& subject, const string& signal, const
       return;
    }
 
+   string details = "] ";
    Step* pStp(dynamic_cast<Step*>(pMsg));
-   StepImp* pStpImp(dynamic_cast<StepImp*>(pStp));
-   MessageImp* pMsgImp(dynamic_cast<MessageImp*>(pMsg));
-   *mpJournalWriter << mpLogName.c_str() << " - FINALIZED "
-      << ((pStpImp != NULL) ? "Step" : "Message")
-      << "[" << ((pStpImp != NULL) ? pStpImp : pMsgImp)->getStringId().c_str() << "] ";
    if (pStp != NULL)
    {
       switch (pStp->getResult())
       {
       case Message::Success:
-         *mpJournalWriter << "Success";
+         details += "Success";
          break;
       case Message::Failure:
-         *mpJournalWriter << "Failure[" << pStp->getFailureMessage().c_str() << "]";
+         details += "Failure[" + pStp->getFailureMessage() + "]";
          break;
       case Message::Abort:
-         *mpJournalWriter << "Abort";
+         details += "Abort";
          break;
       default:
          break;
       }
    }
-   *mpJournalWriter << endl << flush;
+   writeJournal("FINALIZED", pMsg, details);
    notify(SIGNAL_NAME(MessageLog, MessageHidden), v);
+
+   // Top level messages can no longer change so stream them to the log file
+   MessageImp* pMsgImp(dynamic_cast<MessageImp*>(pMsg));
+   if (pMsgImp != NULL && pMsgImp->getParent() == NULL && mpLogFile != NULL &&
+      mWrittenMessages.find(pMsg) == mWrittenMessages.end())
+   {
+      writeLogFile(pMsgImp);
+      mWrittenMessages.insert(pMsg);
+      evictMessages();
+   }
 }
 
 void MessageLogImp::messageDetached(Subject& subject, const string& signal, const boost::any& v)
@@ -359,14 +422,15 @@ void MessageLogImp::messageDeleted(Subject& subject, const string& signal, const
 
 string MessageLogImp::serialize()
 {
-   mpWriter->pushAddPoint(); // add messages as children
+   XMLWriter writer("messagelog");
+   writer.pushAddPoint(); // add messages as children
    for (vector<Message*>::const_iterator it = mMessageList.begin(); it != mMessageList.end(); ++it)
    {
       MessageImp* pMessage(dynamic_cast<MessageImp*>(*it));
-      pMessage->toXml(mpWriter);
+      pMessage->toXml(&writer);
    }
-   mpWriter->popAddPoint();
-   return mpWriter->writeToString();
+   writer.popAddPoint();
+   return writer.writeToString();
 }
 
 /////////// MessageImp
@@ -12,7 +12,6 @@
 
 #include <QtCore/QFile>
 #include <QtCore/QString>
-#include <QtCore/QTextStream>
 
 #include "MessageLog.h"
 #include "SerializableImp.h"
@@ -24,11 +23,13 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <iostream>
 
 #include "XercesIncludes.h"
 
 class MessageImp;
+class MessageJournal;
 class StepImp;
 
 class NumChain
@@ -101,8 +102,15 @@ class MessageLogImp : public SubjectImp
 public:
    /**
     *  Construct a new message log
+    *
+    *  Journal entries and the XML log are queued on \em pJournalWriter. Top level
+    *  messages are appended to the XML log file as soon as they are finalized.
+    *  Once more than \em maxMessages top level messages are in memory, the oldest
+    *  ones which have been written to the log file are deleted. A value of
+    *  zero keeps every message.
     */
-   MessageLogImp(const char* name, const char* path, QFile *journal);
+   MessageLogImp(const char* name, const char* path, QFile *journal, MessageJournal* pJournalWriter,
+      unsigned int maxMessages);
    virtual ~MessageLogImp();
 
    virtual Message *createMessage(const std::string &action,
@@ -142,13 +150,19 @@ protected: // Observer
    void messageAdded(Subject &subject, const std::string &signal, const boost::any &v);
 
 private:
+   void writeJournal(const std::string& event, Message* pMsg, const std::string& details);
+   void writeLogFile(const MessageImp* pMsg);
+   void evictMessages();
+
    std::string mpLogName;
    Filename* mpFilename;
    std::vector<Message*> mMessageList;
+   std::set<const Message*> mWrittenMessages;
+   unsigned int mMaxMessages;
+   int mMessageCount;
    Step* mpCurrentStep;
    QFile* mpJournal;
-   QTextStream* mpJournalWriter;
-   XMLWriter* mpWriter;
+   MessageJournal* mpJournalWriter;
 };
 
 #define MESSAGELOGADAPTEREXTENSION_CLASSES \
@@ -9,6 +9,7 @@
 
 #include "ConfigurationSettings.h"
 #include "Filename.h"
+#include "MessageJournal.h"
 #include "MessageLogAdapter.h"
 #include "MessageLogMgrImp.h"
 #include "SessionManager.h"
@@ -20,8 +21,7 @@ using namespace std;
 MessageLogMgrImp* MessageLogMgrImp::spInstance = NULL;
 bool MessageLogMgrImp::mDestroyed = false;
 
-MessageLogMgrImp::MessageLogMgrImp() :
-   mpJournal(NULL)
+MessageLogMgrImp::MessageLogMgrImp()
 {
    const Filename* pMessageLogPath = ConfigurationSettings::getSettingMessageLogPath();
    if (pMessageLogPath != NULL)
@@ -38,10 +38,6 @@ MessageLogMgrImp::MessageLogMgrImp() :
       }
    }
 
-   mpJournal = new QTemporaryFile(QString::fromStdString(mLogPath) + "/journ");
-   mpJournal->open(QIODevice::WriteOnly);
-   mpJournal->setPermissions(QFile::WriteOwner);
-
    // Create a default session log
    createLog(Service<SessionManager>()->getName());
 }
@@ -51,10 +47,16 @@ MessageLogMgrImp::~MessageLogMgrImp()
    notify(SIGNAL_NAME(Subject, Deleted));
    clear();
 
-   mpJournal->close();
-   mpJournal->remove();
-   delete mpJournal;
-   mpJournal = NULL;
+   // Stop the writers before closing the journals so all queued text is written
+   for (map<MessageJournal::DurabilityType, Journal>::iterator iter = mJournals.begin(); iter != mJournals.end();
+      ++iter)
+   {
+      delete iter->second.mpWriter;
+      iter->second.mpFile->close();
+      iter->second.mpFile->remove();
+      delete iter->second.mpFile;
+   }
+   mJournals.clear();
 }
 
 MessageLogMgrImp* MessageLogMgrImp::instance()
@@ -100,7 +102,9 @@ MessageLog* MessageLogMgrImp::createLog(const string& logName)
       return NULL;
    }
 
-   MessageLog* pLog = new MessageLogAdapter(logName.c_str(), mLogPath.c_str(), mpJournal);
+   const Journal& journal = getJournal();
+   MessageLog* pLog = new MessageLogAdapter(logName.c_str(), mLogPath.c_str(), journal.mpFile, journal.mpWriter,
+      getSettingMaxMessages());
    mLogMap.insert(pair<string, MessageLog*>(logName, pLog));
    notify(SIGNAL_NAME(MessageLogMgr, LogAdded), pLog);
 
@@ -155,6 +159,24 @@ vector<MessageLog*> MessageLogMgrImp::getLogs() const
    return logs;
 }
 
+const MessageLogMgrImp::Journal& MessageLogMgrImp::getJournal()
+{
+   MessageJournal::DurabilityType durability = MessageJournal::durabilityFromString(getSettingJournalDurability());
+   map<MessageJournal::DurabilityType, Journal>::iterator iter = mJournals.find(durability);
+   if (iter != mJournals.end())
+   {
+      return iter->second;
+   }
+
+   Journal journal;
+   journal.mpFile = new QTemporaryFile(QString::fromStdString(mLogPath) + "/journ");
+   journal.mpFile->open(QIODevice::WriteOnly);
+   journal.mpFile->setPermissions(QFile::WriteOwner);
+   journal.mpWriter = new MessageJournal(durability, getSettingJournalCapacity(), getSettingJournalFlushInterval());
+
+   return mJournals.insert(make_pair(durability, journal)).first->second;
+}
+
 const string& MessageLogMgrImp::getObjectType() const
 {
    static string sType("MessageLogMgrImp");
@@ -10,6 +10,8 @@
 #ifndef MESSAGELOGMGRIMP_H
 #define MESSAGELOGMGRIMP_H
 
+#include "ConfigurationSettings.h"
+#include "MessageJournal.h"
 #include "MessageLogMgr.h"
 #include "SubjectImp.h"
 
@@ -23,6 +25,11 @@ class QFile;
 class MessageLogMgrImp : public MessageLogMgr, public SubjectImp
 {
 public:
+   SETTING(JournalDurability, MessageLogMgr, std::string, "Batch")
+   SETTING(JournalCapacity, MessageLogMgr, unsigned int, 4096)
+   SETTING(JournalFlushInterval, MessageLogMgr, unsigned int, 1000)
+   SETTING(MaxMessages, MessageLogMgr, unsigned int, 100000)
+
    static MessageLogMgrImp* instance();
    static void destroy();
 
@@ -49,7 +56,17 @@ private:
 
    std::map<std::string, MessageLog*> mLogMap;
    std::string mLogPath;
-   QFile* mpJournal;
+
+   // Each log is written through the journal for the durability setting when the log was created,
+   // so a change to the setting applies to new logs. Every journal has its own file and writer thread.
+   struct Journal
+   {
+      QFile* mpFile;
+      MessageJournal* mpWriter;
+   };
+
+   const Journal& getJournal();
+   std::map<MessageJournal::DurabilityType, Journal> mJournals;
 };
 
 #endif
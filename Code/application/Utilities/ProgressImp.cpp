@@ -8,13 +8,16 @@
  */
 
 #include "ProgressImp.h"
+#include "TraceSpan.h"
+#include "Tracer.h"
 
 using namespace std;
 
 ProgressImp::ProgressImp() :
    mPercentComplete(-1),
    mGranularity(NORMAL),
-   mpPlugIn(NULL)
+   mpPlugIn(NULL),
+   mPhaseStartTime(0.0)
 {
 }
 
@@ -22,7 +25,8 @@ ProgressImp::ProgressImp(string amProgressText, int amPercentComplete, Reporting
    mProgressText(amProgressText),
    mPercentComplete(amPercentComplete),
    mGranularity(amGranularity),
-   mpPlugIn(NULL)
+   mpPlugIn(NULL),
+   mPhaseStartTime(0.0)
 {
    if (mPercentComplete > 100)
    {
@@ -32,6 +36,9 @@ ProgressImp::ProgressImp(string amProgressText, int amPercentComplete, Reporting
 
 ProgressImp::~ProgressImp()
 {
+   // The plug-in may already be destroyed so end the last phase without it
+   mpPlugIn = NULL;
+   tracePhase(string(), 100, NORMAL);
 }
 
 const string& ProgressImp::getObjectType() const
@@ -52,6 +59,8 @@ bool ProgressImp::isKindOf(const string& className) const
 
 void ProgressImp::updateProgress(const string& text, int percent, ReportingLevel gran)
 {
+   tracePhase(text, percent, gran);
+
    mProgressText = text;
    mPercentComplete = percent;
    mGranularity = gran;
@@ -75,3 +84,28 @@ PlugIn* ProgressImp::getPlugIn() const
 {
    return mpPlugIn;
 }
+
+void ProgressImp::tracePhase(const string& text, int percent, ReportingLevel gran)
+{
+   Tracer* pTracer = TraceSpan::getActiveTracer();
+   if (pTracer == NULL)
+   {
+      mPhaseText.clear();
+      return;
+   }
+
+   // A phase lasts from the first update with a message until the message changes or the work finishes
+   bool finished = (percent >= 100 || gran == ERRORS || gran == ABORT);
+   if (mPhaseText.empty() == false && (text != mPhaseText || finished == true))
+   {
+      pTracer->addSpan("progress", mPhaseText, mPhaseStartTime, pTracer->getTime(), 0,
+         mpPlugIn == NULL ? string() : mpPlugIn->getName());
+      mPhaseText.clear();
+   }
+
+   if (finished == false && mPhaseText.empty() == true && text.empty() == false)
+   {
+      mPhaseText = text;
+      mPhaseStartTime = pTracer->getTime();
+   }
+}
@@ -67,10 +67,14 @@ public:
    PlugIn* getPlugIn() const;
 
 private:
+   void tracePhase(const std::string& text, int percent, ReportingLevel gran);
+
    std::string mProgressText;
    int mPercentComplete;
    ReportingLevel mGranularity;
    PlugIn* mpPlugIn;
+   std::string mPhaseText;
+   double mPhaseStartTime;
 };
 
 #define PROGRESSADAPTEREXTENSION_CLASSES \
@@ -0,0 +1,349 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "TracerImp.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(WIN_API)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+   // Limits the memory used when tracing is left enabled, later spans are counted but dropped
+   const size_t sMaxSpansPerThread = 1000000;
+
+   double getClockTime()
+   {
+#if defined(WIN_API)
+      LARGE_INTEGER frequency;
+      LARGE_INTEGER counter;
+      QueryPerformanceFrequency(&frequency);
+      QueryPerformanceCounter(&counter);
+      return static_cast<double>(counter.QuadPart) / static_cast<double>(frequency.QuadPart);
+#else
+      timespec time;
+      clock_gettime(CLOCK_MONOTONIC, &time);
+      return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+#endif
+   }
+
+   string escapeJson(const string& text)
+   {
+      string escaped;
+      for (string::const_iterator iter = text.begin(); iter != text.end(); ++iter)
+      {
+         switch (*iter)
+         {
+         case '"':
+            escaped += "\\\"";
+            break;
+         case '\\':
+            escaped += "\\\\";
+            break;
+         case '\n':
+            escaped += "\\n";
+            break;
+         case '\r':
+            escaped += "\\r";
+            break;
+         case '\t':
+            escaped += "\\t";
+            break;
+         default:
+            if (static_cast<unsigned char>(*iter) >= 0x20)
+            {
+               escaped += *iter;
+            }
+            break;
+         }
+      }
+
+      return escaped;
+   }
+
+   struct SummaryEntry
+   {
+      SummaryEntry() : mCount(0), mTotalTime(0.0), mMaxTime(0.0), mBytes(0) {}
+
+      string mCategory;
+      string mName;
+      unsigned int mCount;
+      double mTotalTime;
+      double mMaxTime;
+      uint64_t mBytes;
+   };
+
+   bool compareTotalTime(const SummaryEntry& lhs, const SummaryEntry& rhs)
+   {
+      return lhs.mTotalTime > rhs.mTotalTime;
+   }
+}
+
+TracerImp* TracerImp::spInstance = NULL;
+bool TracerImp::mDestroyed = false;
+
+TracerImp* TracerImp::instance()
+{
+   if (spInstance == NULL)
+   {
+      if (mDestroyed)
+      {
+         throw std::logic_error("Attempting to use Tracer after destroying it.");
+      }
+      spInstance = new TracerImp;
+   }
+
+   return spInstance;
+}
+
+void TracerImp::destroy()
+{
+   if (mDestroyed)
+   {
+      throw std::logic_error("Attempting to destroy Tracer after destroying it.");
+   }
+   delete spInstance;
+   spInstance = NULL;
+   mDestroyed = true;
+}
+
+TracerImp::TracerImp() :
+   mEnabled(0),
+   mStartTime(getClockTime())
+{}
+
+TracerImp::~TracerImp()
+{
+   for (vector<ThreadBuffer*>::iterator iter = mBuffers.begin(); iter != mBuffers.end(); ++iter)
+   {
+      delete *iter;
+   }
+}
+
+void TracerImp::setEnabled(bool enabled)
+{
+   mEnabled.fetchAndStoreOrdered(enabled ? 1 : 0);
+}
+
+bool TracerImp::isEnabled() const
+{
+   return mEnabled != 0;
+}
+
+double TracerImp::getTime() const
+{
+   return getClockTime() - mStartTime;
+}
+
+void TracerImp::addSpan(const string& category, const string& name, double startTime, double endTime,
+                        uint64_t bytes, const string& detail)
+{
+   if (isEnabled() == false)
+   {
+      return;
+   }
+
+   ThreadBuffer* pBuffer = getThreadBuffer();
+   QMutexLocker lock(&pBuffer->mMutex);
+   if (pBuffer->mSpans.size() >= sMaxSpansPerThread)
+   {
+      ++pBuffer->mDroppedSpans;
+      return;
+   }
+
+   pBuffer->mSpans.push_back(Span());
+   Span& span = pBuffer->mSpans.back();
+   span.mCategory = category;
+   span.mName = name;
+   span.mStartTime = startTime;
+   span.mEndTime = endTime;
+   span.mBytes = bytes;
+   span.mDetail = detail;
+}
+
+void TracerImp::clear()
+{
+   QMutexLocker lock(&mMutex);
+   for (vector<ThreadBuffer*>::iterator iter = mBuffers.begin(); iter != mBuffers.end(); ++iter)
+   {
+      QMutexLocker bufferLock(&(*iter)->mMutex);
+      (*iter)->mSpans.clear();
+      (*iter)->mDroppedSpans = 0;
+   }
+}
+
+bool TracerImp::writeChromeTrace(const string& filename) const
+{
+   ofstream output(filename.c_str());
+   if (!output)
+   {
+      return false;
+   }
+
+   // Chrome trace times are in microseconds
+   output << fixed << setprecision(3);
+   output << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+   bool first = true;
+   QMutexLocker lock(&mMutex);
+   for (vector<ThreadBuffer*>::const_iterator iter = mBuffers.begin(); iter != mBuffers.end(); ++iter)
+   {
+      const ThreadBuffer* pBuffer = *iter;
+      QMutexLocker bufferLock(&pBuffer->mMutex);
+
+      output << (first ? "" : ",") << endl;
+      output << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << pBuffer->mThreadId <<
+         ", \"args\": {\"name\": \"" << escapeJson(pBuffer->mThreadName) << "\"}}";
+      first = false;
+
+      for (vector<Span>::const_iterator span = pBuffer->mSpans.begin(); span != pBuffer->mSpans.end(); ++span)
+      {
+         output << "," << endl;
+         output << "{\"name\": \"" << escapeJson(span->mName) << "\", \"cat\": \"" << escapeJson(span->mCategory) <<
+            "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << pBuffer->mThreadId <<
+            ", \"ts\": " << span->mStartTime * 1e6 <<
+            ", \"dur\": " << (span->mEndTime - span->mStartTime) * 1e6 << ", \"args\": {";
+         if (span->mBytes > 0)
+         {
+            output << "\"bytes\": " << span->mBytes << (span->mDetail.empty() ? "" : ", ");
+         }
+
+         if (span->mDetail.empty() == false)
+         {
+            output << "\"detail\": \"" << escapeJson(span->mDetail) << "\"";
+         }
+
+         output << "}}";
+      }
+
+      if (pBuffer->mDroppedSpans > 0)
+      {
+         output << "," << endl;
+         output << "{\"name\": \"Dropped " << pBuffer->mDroppedSpans << " spans\", \"ph\": \"i\", \"s\": \"t\", "
+            "\"pid\": 1, \"tid\": " << pBuffer->mThreadId << ", \"ts\": " <<
+            (pBuffer->mSpans.empty() ? 0.0 : pBuffer->mSpans.back().mEndTime * 1e6) << "}";
+      }
+   }
+
+   output << endl << "]}" << endl;
+   return output.good();
+}
+
+string TracerImp::getSummary() const
+{
+   map<pair<string, string>, SummaryEntry> entries;
+   unsigned int droppedSpans = 0;
+   {
+      QMutexLocker lock(&mMutex);
+      for (vector<ThreadBuffer*>::const_iterator iter = mBuffers.begin(); iter != mBuffers.end(); ++iter)
+      {
+         const ThreadBuffer* pBuffer = *iter;
+         QMutexLocker bufferLock(&pBuffer->mMutex);
+         droppedSpans += pBuffer->mDroppedSpans;
+         for (vector<Span>::const_iterator span = pBuffer->mSpans.begin(); span != pBuffer->mSpans.end(); ++span)
+         {
+            SummaryEntry& entry = entries[make_pair(span->mCategory, span->mName)];
+            double duration = span->mEndTime - span->mStartTime;
+            entry.mCategory = span->mCategory;
+            entry.mName = span->mName;
+            ++entry.mCount;
+            entry.mTotalTime += duration;
+            entry.mMaxTime = max(entry.mMaxTime, duration);
+            entry.mBytes += span->mBytes;
+         }
+      }
+   }
+
+   vector<SummaryEntry> sortedEntries;
+   for (map<pair<string, string>, SummaryEntry>::const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
+   {
+      sortedEntries.push_back(iter->second);
+   }
+   stable_sort(sortedEntries.begin(), sortedEntries.end(), compareTotalTime);
+
+   ostringstream summary;
+   summary << left << setw(12) << "Category" << setw(40) << "Name" << right << setw(10) << "Count" <<
+      setw(14) << "Total (ms)" << setw(12) << "Mean (ms)" << setw(12) << "Max (ms)" << setw(16) << "Bytes" << endl;
+   summary << fixed << setprecision(3);
+   for (vector<SummaryEntry>::const_iterator iter = sortedEntries.begin(); iter != sortedEntries.end(); ++iter)
+   {
+      string name = iter->mName;
+      if (name.size() > 39)
+      {
+         name = name.substr(0, 36) + "...";
+      }
+
+      summary << left << setw(12) << iter->mCategory << setw(40) << name << right << setw(10) << iter->mCount <<
+         setw(14) << iter->mTotalTime * 1000.0 << setw(12) << iter->mTotalTime * 1000.0 / iter->mCount <<
+         setw(12) << iter->mMaxTime * 1000.0 << setw(16) << iter->mBytes << endl;
+   }
+
+   if (droppedSpans > 0)
+   {
+      summary << droppedSpans << " spans were dropped because a thread buffer was full." << endl;
+   }
+
+   return summary.str();
+}
+
+TracerImp::ThreadBuffer* TracerImp::getThreadBuffer()
+{
+   ThreadBufferHandle* pHandle = mThreadBuffers.localData();
+   if (pHandle != NULL)
+   {
+      return pHandle->mpBuffer;
+   }
+
+   ThreadBuffer* pBuffer = new ThreadBuffer;
+   pBuffer->mDroppedSpans = 0;
+
+   QThread* pThread = QThread::currentThread();
+   QCoreApplication* pApp = QCoreApplication::instance();
+   if (pApp != NULL && pThread == pApp->thread())
+   {
+      pBuffer->mThreadName = "Main";
+   }
+   else if (pThread != NULL && pThread->objectName().isEmpty() == false)
+   {
+      pBuffer->mThreadName = pThread->objectName().toStdString();
+   }
+
+   {
+      QMutexLocker lock(&mMutex);
+      pBuffer->mThreadId = static_cast<unsigned int>(mBuffers.size()) + 1;
+      mBuffers.push_back(pBuffer);
+   }
+
+   if (pBuffer->mThreadName.empty())
+   {
+      ostringstream threadName;
+      threadName << "Thread " << pBuffer->mThreadId;
+      pBuffer->mThreadName = threadName.str();
+   }
+
+   pHandle = new ThreadBufferHandle;
+   pHandle->mpBuffer = pBuffer;
+   mThreadBuffers.setLocalData(pHandle);
+   return pBuffer;
+}
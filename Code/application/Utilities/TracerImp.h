@@ -0,0 +1,82 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2012 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef TRACERIMP_H
+#define TRACERIMP_H
+
+#include "Tracer.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadStorage>
+
+#include <string>
+#include <vector>
+
+class TracerImp : public Tracer
+{
+public:
+   static TracerImp* instance();
+   static void destroy();
+
+   void setEnabled(bool enabled);
+   bool isEnabled() const;
+   double getTime() const;
+   void addSpan(const std::string& category, const std::string& name, double startTime, double endTime,
+      uint64_t bytes = 0, const std::string& detail = std::string());
+   void clear();
+   bool writeChromeTrace(const std::string& filename) const;
+   std::string getSummary() const;
+
+protected:
+   TracerImp();
+   ~TracerImp();
+
+private:
+   TracerImp(const TracerImp& rhs);
+   TracerImp& operator=(const TracerImp& rhs);
+
+   struct Span
+   {
+      std::string mCategory;
+      std::string mName;
+      double mStartTime;
+      double mEndTime;
+      uint64_t mBytes;
+      std::string mDetail;
+   };
+
+   // Buffers are owned by the tracer so the spans of threads which have exited can still be written
+   struct ThreadBuffer
+   {
+      unsigned int mThreadId;
+      std::string mThreadName;
+      mutable QMutex mMutex;
+      std::vector<Span> mSpans;
+      unsigned int mDroppedSpans;
+   };
+
+   struct ThreadBufferHandle
+   {
+      ThreadBuffer* mpBuffer;
+   };
+
+   ThreadBuffer* getThreadBuffer();
+
+   static TracerImp* spInstance;
+   static bool mDestroyed;
+
+   QAtomicInt mEnabled;
+   double mStartTime;
+   mutable QMutex mMutex;
+   std::vector<ThreadBuffer*> mBuffers;
+   QThreadStorage<ThreadBufferHandle*> mThreadBuffers;
+};
+
+#endif
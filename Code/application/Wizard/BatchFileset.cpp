@@ -14,7 +14,8 @@
 using namespace std;
 
 BatchFileset::BatchFileset() :
-   mpCurrentFile(NULL)
+   mpCurrentFile(NULL),
+   mCurrentIndex(0)
 {
 }
 
@@ -22,7 +23,8 @@ BatchFileset::BatchFileset(const string& name, const string& directory, const ve
    mName(name),
    mDirectory(directory),
    mFiles(fileset),
-   mpCurrentFile(NULL)
+   mpCurrentFile(NULL),
+   mCurrentIndex(0)
 {
 }
 
@@ -242,6 +244,7 @@ void BatchFileset::updateFileset(ObjectFactory* pObjFact)
 
 string BatchFileset::getFirstFile() 
 {
+   mCurrentIndex = 0;
    if (mFiles.empty() == true)
    {
       mpCurrentFile = NULL;
@@ -269,18 +272,19 @@ string BatchFileset::getNextFile()
 {
    if (mpCurrentFile != NULL)
    {
+      vector<BatchFile*>::size_type index = getSearchStart();
       mpCurrentFile->setUsed(true);
       mpCurrentFile = NULL;
 
       // Go through the list and set the next current file.
-      vector<BatchFile*>::iterator iter;
-      for (iter = mFiles.begin(); iter != mFiles.end(); iter++)
+      for (; index < mFiles.size(); ++index)
       {
          BatchFile* pFile = NULL;
-         pFile = *iter;
+         pFile = mFiles[index];
          if ((pFile != NULL) && (pFile->isUsed() == false))
          {
             mpCurrentFile = pFile;
+            mCurrentIndex = index;
             break;
          }
       }
@@ -289,6 +293,34 @@ string BatchFileset::getNextFile()
    return getCurrentFile();
 }
 
+void BatchFileset::getUpcomingFiles(unsigned int count, vector<string>& files) const
+{
+   files.clear();
+
+   for (vector<BatchFile*>::size_type index = getSearchStart(); index < mFiles.size() && files.size() < count;
+      ++index)
+   {
+      BatchFile* pFile = mFiles[index];
+      if ((pFile != NULL) && (pFile != mpCurrentFile) && (pFile->isUsed() == false))
+      {
+         files.push_back(pFile->getFileName());
+      }
+   }
+}
+
+vector<BatchFile*>::size_type BatchFileset::getSearchStart() const
+{
+   // The files are used in order, so every file before the current file has been used and a
+   // batch of thousands of files does not have to be searched from the beginning each iteration.
+   // Search the whole list if the files were replaced after the current file was set.
+   if ((mpCurrentFile != NULL) && (mCurrentIndex < mFiles.size()) && (mFiles[mCurrentIndex] == mpCurrentFile))
+   {
+      return mCurrentIndex;
+   }
+
+   return 0;
+}
+
 bool BatchFileset::isComplete() const
 {
    bool bComplete = true;
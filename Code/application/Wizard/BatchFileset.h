@@ -211,6 +211,19 @@ public:
     */
    std::string getNextFile();
 
+   /**
+    *  Returns the files which will be used after the current file.
+    *
+    *  The file set is not modified, so this can be used to prepare files before
+    *  getNextFile() is called.
+    *
+    *  @param   count
+    *           The maximum number of files to return.
+    *  @param   files
+    *           Populated with the filenames in the order in which they will be used.
+    */
+   void getUpcomingFiles(unsigned int count, std::vector<std::string>& files) const;
+
    /**
     *  Queries whether all files in the file set have been processed.
     *
@@ -219,11 +232,14 @@ public:
    bool isComplete() const;
 
 private:
+   std::vector<BatchFile*>::size_type getSearchStart() const;
+
    std::string mName;
    std::string mDirectory; 
    std::vector<BatchFile*> mFiles;
    std::multimap<std::string, std::string> mFilesetReq;
    BatchFile* mpCurrentFile;
+   std::vector<BatchFile*>::size_type mCurrentIndex;   // position of mpCurrentFile in mFiles
 };
 
 #endif
@@ -263,6 +263,38 @@ void BatchWizard::getCurrentFilesetFile(const string& filesetName, string& curre
    }
 }
 
+void BatchWizard::getUpcomingFiles(unsigned int iterations, vector<string>& files) const
+{
+   files.clear();
+
+   // Every file set advances after each iteration, so the files for the next iterations
+   // are the upcoming files of each file set in turn
+   vector<vector<string> > filesetFiles;
+   vector<BatchFileset*>::const_iterator iter;
+   for (iter = mFilesets.begin(); iter != mFilesets.end(); iter++)
+   {
+      BatchFileset* pFileset = *iter;
+      if (pFileset != NULL)
+      {
+         filesetFiles.push_back(vector<string>());
+         pFileset->getUpcomingFiles(iterations, filesetFiles.back());
+      }
+   }
+
+   for (unsigned int i = 0; i < iterations; ++i)
+   {
+      for (vector<vector<string> >::const_iterator fileIter = filesetFiles.begin();
+         fileIter != filesetFiles.end();
+         ++fileIter)
+      {
+         if (i < fileIter->size())
+         {
+            files.push_back((*fileIter)[i]);
+         }
+      }
+   }
+}
+
 bool BatchWizard::isComplete() const
 {
    bool bComplete = true;
@@ -52,6 +52,7 @@ public:
    void updateFilesets();
    void getCurrentRepeatFile(std::string& currentFile) const;
    void getCurrentFilesetFile(const std::string& filesetName, std::string& currentFile) const;
+   void getUpcomingFiles(unsigned int iterations, std::vector<std::string>& files) const;
    bool isComplete() const;
 
    virtual bool toXml(XMLWriter* pXml) const;